@@ -5,8 +5,10 @@
 #include "pocketos/core/resource_manager.h"
 #include "pocketos/core/endpoint_registry.h"
 #include "pocketos/core/device_registry.h"
+#include "pocketos/core/interrupt_manager.h"
 #include "pocketos/core/persistence.h"
 #include "pocketos/core/device_identifier.h"
+#include "pocketos/core/auto_binder.h"
 #include "pocketos/core/pcf1_config.h"
 #include "pocketos/core/service_manager.h"
 #include "pocketos/platform/platform_pack.h"
@@ -16,6 +18,8 @@
 PocketOS::HealthService g_healthService;
 PocketOS::TelemetryService g_telemetryService;
 PocketOS::PersistenceService g_persistenceService;
+PocketOS::TimeSeriesService g_timeSeriesService;
+PocketOS::ClockService g_clockService;
 
 void setup() {
     Serial.begin(115200);
@@ -40,6 +44,7 @@ void setup() {
     PocketOS::HAL::init();
     PocketOS::IntentAPI::init();
     PocketOS::ResourceManager::init();
+    PocketOS::InterruptManager::init();
     PocketOS::EndpointRegistry::init();
     PocketOS::DeviceRegistry::init();
     PocketOS::DeviceIdentifier::init();
@@ -53,14 +58,24 @@ void setup() {
     PocketOS::ServiceManager::registerService(&g_healthService);
     PocketOS::ServiceManager::registerService(&g_telemetryService);
     PocketOS::ServiceManager::registerService(&g_persistenceService);
+    PocketOS::ServiceManager::registerService(&g_timeSeriesService);
+    PocketOS::ServiceManager::registerService(&g_clockService);
     
     PocketOS::ServiceManager::startService("health");
     PocketOS::ServiceManager::startService("telemetry");
     PocketOS::ServiceManager::startService("persistence");
+    PocketOS::ServiceManager::startService("timeseries");
+    PocketOS::ServiceManager::startService("clock");
     
     // Load saved configuration
     PocketOS::Persistence::loadAll();
     
+#ifdef POCKETOS_AUTOBIND_AT_BOOT
+    // Optional boot stage: start I2C bus 0 if nothing has, then bind every
+    // identifiable I2C device not restored above
+    PocketOS::AutoBinder::runBootStage();
+#endif
+    
     // Initialize CLI last
     PocketOS::CLI::init();
     
@@ -70,6 +85,7 @@ void setup() {
 
 void loop() {
     PocketOS::CLI::process();
+    PocketOS::InterruptManager::dispatch();  // Deferred interrupt handlers, before the reads they trigger
     PocketOS::DeviceRegistry::updateAll();
     PocketOS::ServiceManager::tick();  // Run services on deterministic schedule
     delay(10);
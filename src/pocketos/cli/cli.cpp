@@ -124,6 +124,13 @@ void CLI::parseCommand(const String& cmdLine, IntentRequest& request) {
         request.args[0] = tokens[1];
         request.args[1] = tokens[2];
         request.argCount = 2;
+    } else if (cmd == "autobind") {
+        // autobind [bus]
+        request.intent = "dev.autobind";
+        if (tokenCount > 1) {
+            request.args[0] = tokens[1];
+            request.argCount = 1;
+        }
     } else if (cmd == "unbind" && tokenCount > 1) {
         request.intent = "dev.unbind";
         request.args[0] = tokens[1];
@@ -149,6 +156,100 @@ void CLI::parseCommand(const String& cmdLine, IntentRequest& request) {
         request.intent = "dev.status";
         request.args[0] = tokens[1];
         request.argCount = 1;
+    } else if (cmd == "ts" && tokenCount > 1) {
+        if (tokens[1] == "query" && tokenCount > 5) {
+            // ts query <device_id> <signal> <from> <to> [agg]
+            request.intent = "ts.query";
+            for (int i = 2; i < tokenCount && i < 7; i++) {
+                request.args[request.argCount++] = tokens[i];
+            }
+        } else if (tokens[1] == "list") {
+            request.intent = "ts.list";
+        } else if (tokens[1] == "flush") {
+            request.intent = "ts.flush";
+        }
+    } else if (cmd == "clock") {
+        if (tokenCount == 1 || tokens[1] == "status") {
+            request.intent = "clock.status";
+        } else if (tokens[1] == "set" && tokenCount > 2) {
+            // clock set <YYYY-MM-DD HH:MM:SS|unix_seconds>
+            request.intent = "clock.set";
+            request.args[0] = tokens[2];
+            if (tokenCount > 3) {
+                request.args[0] += " " + tokens[3];
+            }
+            request.argCount = 1;
+        } else if (tokens[1] == "source" && tokenCount > 2) {
+            request.intent = "clock.source";
+            request.args[0] = tokens[2];
+            request.argCount = 1;
+        } else if (tokens[1] == "pulse" && tokenCount > 2) {
+            // clock pulse <pin|off> [rising|falling]
+            request.intent = "clock.pulse";
+            for (int i = 2; i < tokenCount && i < 4; i++) {
+                request.args[request.argCount++] = tokens[i];
+            }
+        } else if (tokens[1] == "sync") {
+            request.intent = "clock.sync";
+        }
+    } else if (cmd == "irq") {
+        request.intent = "irq.list";
+    } else if (cmd == "can") {
+        if (tokenCount > 2 && tokens[1] == "dump") {
+            // can dump <device_id> [max] [text|bin]
+            request.intent = "can.dump";
+            for (int i = 2; i < tokenCount && i < 5; i++) {
+                request.args[request.argCount++] = tokens[i];
+            }
+        }
+    } else if (cmd == "lora") {
+        if (tokenCount > 3 && tokens[1] == "send") {
+            // lora send <device_id> <hex>
+            request.intent = "lora.send";
+            request.args[0] = tokens[2];
+            request.args[1] = tokens[3];
+            request.argCount = 2;
+        } else if (tokenCount > 2 && tokens[1] == "recv") {
+            // lora recv <device_id> [max]
+            request.intent = "lora.recv";
+            for (int i = 2; i < tokenCount && i < 4; i++) {
+                request.args[request.argCount++] = tokens[i];
+            }
+        }
+    } else if (cmd == "nrf") {
+        if (tokenCount > 3 && tokens[1] == "send") {
+            // nrf send <device_id> <hex>
+            request.intent = "nrf.send";
+            request.args[0] = tokens[2];
+            request.args[1] = tokens[3];
+            request.argCount = 2;
+        } else if (tokenCount > 4 && tokens[1] == "ack") {
+            // nrf ack <device_id> <pipe> <hex>
+            request.intent = "nrf.ack";
+            request.args[0] = tokens[2];
+            request.args[1] = tokens[3];
+            request.args[2] = tokens[4];
+            request.argCount = 3;
+        } else if (tokenCount > 2 && tokens[1] == "recv") {
+            // nrf recv <device_id> [max]
+            request.intent = "nrf.recv";
+            for (int i = 2; i < tokenCount && i < 4; i++) {
+                request.args[request.argCount++] = tokens[i];
+            }
+        } else if (tokenCount > 2 && tokens[1] == "bench") {
+            // nrf bench <device_id> [packets] [len]
+            request.intent = "nrf.bench";
+            for (int i = 2; i < tokenCount && i < 5; i++) {
+                request.args[request.argCount++] = tokens[i];
+            }
+        }
+    } else if (cmd == "signals") {
+        // signals [device_id]
+        request.intent = "dev.signals";
+        if (tokenCount > 1) {
+            request.args[0] = tokens[1];
+            request.argCount = 1;
+        }
     } else if (cmd == "log") {
         if (tokenCount > 1 && tokens[1] == "tail") {
             request.intent = "log.tail";
@@ -273,27 +374,61 @@ void CLI::printHelp() {
     Serial.println();
     Serial.println("Device Identification:");
     Serial.println("  identify <endpoint>            - Identify device at endpoint (e.g., identify i2c0:0x76)");
+    Serial.println("  identify <bus>                 - Identify all devices on a bus (e.g., identify i2c0)");
     Serial.println();
     Serial.println("Device Management:");
     Serial.println("  dev list                       - List devices");
     Serial.println("  bind <driver> <endpoint>       - Bind device (e.g., bind bme280 i2c0:0x76)");
+    Serial.println("  autobind [bus]                 - Scan, identify and bind all devices (e.g., autobind i2c0)");
     Serial.println("  unbind <device_id>             - Unbind device");
     Serial.println("  status <device_id>             - Device status and health");
     Serial.println();
     Serial.println("Device Operations:");
     Serial.println("  read <device_id>               - Read current sensor data");
     Serial.println("  stream <device_id> <interval_ms> <count> - Stream sensor data");
+    Serial.println("  signals [device_id]            - Filtered signals (no id: only changed since last call)");
     Serial.println();
     Serial.println("Device Configuration:");
     Serial.println("  schema <device_id>             - Show device schema");
     Serial.println("  param get <dev_id> <param>     - Get parameter");
     Serial.println("  param set <dev_id> <param> <val> - Set parameter");
+    Serial.println("  param set <dev_id> filter.<signal> <spec> - Filter a signal (e.g. filter.temp ema:0.2)");
+    Serial.println("  param set <dev_id> record.<signal> on|off - Store a signal's history");
     Serial.println();
     Serial.println("Register Access (Tier 2 drivers only):");
     Serial.println("  reg list <device_id>           - List all registers");
     Serial.println("  reg read <dev_id> <reg|name> [len] - Read register (0xF4 or CTRL_MEAS)");
     Serial.println("  reg write <dev_id> <reg|name> <val> [len] - Write register");
     Serial.println();
+    Serial.println("Time Series:");
+    Serial.println("  ts query <dev_id> <signal> <from> <to> [agg] - Stored history (e.g. ts query 1 temp -3600 0 avg:60)");
+    Serial.println("  ts list                        - Open series and write stats");
+    Serial.println("  ts flush                       - Write all buffered samples now");
+    Serial.println();
+    Serial.println("Clock:");
+    Serial.println("  clock                          - Time, sync state and drift");
+    Serial.println("  clock set <YYYY-MM-DD HH:MM:SS> - Set the RTC (UTC) and resync");
+    Serial.println("  clock source <dev_id|auto>     - RTC to discipline against");
+    Serial.println("  clock pulse <pin|off> [rising|falling] - Use the RTC's 1 Hz output on a pin");
+    Serial.println("  clock sync                     - Resync from the RTC now");
+    Serial.println();
+    Serial.println("CAN:");
+    Serial.println("  can dump <id> [max] [text|bin] - Received frames (candump log format)");
+    Serial.println();
+    Serial.println("LoRa:");
+    Serial.println("  lora send <id> <hex>           - Queue a packet (airtime, duty-cycle wait)");
+    Serial.println("  lora recv <id> [max]           - Received packets with RSSI/SNR");
+    Serial.println();
+    Serial.println("nRF24L01:");
+    Serial.println("  nrf send <id> <hex>            - Queue a packet (streamed, auto-ack)");
+    Serial.println("  nrf ack <id> <pipe> <hex>      - Preload the reply to the next packet on a pipe");
+    Serial.println("  nrf recv <id> [max]            - Received packets and ACK payloads");
+    Serial.println("  nrf bench <id> [packets] [len] - Stream packets, report throughput and retries");
+    Serial.println();
+    Serial.println("Interrupts:");
+    Serial.println("  irq                            - Interrupt lines and event counts");
+    Serial.println("  param set <id> irq <pin>[:edge] - Read the device on its interrupt line");
+    Serial.println();
     Serial.println("Persistence & Config:");
     Serial.println("  persist save                   - Save configuration");
     Serial.println("  persist load                   - Load configuration");
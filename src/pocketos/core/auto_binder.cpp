@@ -0,0 +1,102 @@
+#include "auto_binder.h"
+#include "device_identifier.h"
+#include "device_registry.h"
+#include "driver_catalog.h"
+#include "hal.h"
+#include "logger.h"
+
+namespace PocketOS {
+
+int AutoBinder::bindBus(int busNum, AutoBindResult* results, int maxResults) {
+    uint8_t found[128];
+    int foundCount = 0;
+    if (!HAL::i2cScan(busNum, found, &foundCount, 128)) {
+        return 0;
+    }
+
+    int count = 0;
+    for (int i = 0; i < foundCount && count < maxResults; i++) {
+        results[count].address = found[i];
+        bindAddress(busNum, found[i], results[count]);
+        count++;
+    }
+    return count;
+}
+
+void AutoBinder::bindAddress(int busNum, uint8_t address, AutoBindResult& result) {
+    String endpoint = "i2c" + String(busNum) + ":0x" + String(address, HEX);
+
+    // Bound devices (e.g., restored from persistence) keep their driver;
+    // no identification reads are spent on them
+    int existing = DeviceRegistry::findDeviceByEndpoint(endpoint);
+    if (existing >= 0) {
+        result.status = AutoBindStatus::ALREADY_BOUND;
+        result.deviceId = existing;
+        return;
+    }
+
+    DeviceIdentification id = DeviceIdentifier::identifyPresent(address);
+    result.deviceClass = id.deviceClass;
+    result.confidence = id.confidence;
+    if (!id.identified) {
+        result.status = AutoBindStatus::UNIDENTIFIED;
+        return;
+    }
+
+    const DriverCatalogEntry* entry = DriverCatalog::find(id.deviceClass);
+    if (!entry) {
+        result.status = AutoBindStatus::NO_DRIVER;
+        return;
+    }
+
+    int deviceId = DeviceRegistry::bindDevice(id.deviceClass, endpoint);
+    if (deviceId < 0) {
+        result.status = AutoBindStatus::BIND_FAILED;
+        return;
+    }
+
+    result.status = AutoBindStatus::BOUND;
+    result.deviceId = deviceId;
+    result.pollMs = entry->defaultPollMs;
+}
+
+void AutoBinder::runBootStage() {
+    // Nothing starts the default bus before the boot stage; bring it up on
+    // its default pins so the scan does not probe an uninitialised bus
+    if (!HAL::i2cReady(0) && !HAL::i2cInit(0)) {
+        Logger::warning("Autobind: I2C bus 0 could not be initialized");
+    }
+
+    // Every HAL I2C call goes through Wire, so only buses HAL has started
+    // are scanned; any other bus number would rescan bus 0's devices
+    int busCount = HAL::getI2CCount();
+    for (int bus = 0; bus < busCount; bus++) {
+        if (!HAL::i2cReady(bus)) {
+            continue;
+        }
+        AutoBindResult results[MAX_AUTOBIND_RESULTS];
+        int count = bindBus(bus, results, MAX_AUTOBIND_RESULTS);
+
+        int bound = 0;
+        for (int i = 0; i < count; i++) {
+            if (results[i].status == AutoBindStatus::BOUND) {
+                bound++;
+            }
+        }
+        Logger::info(("Autobind i2c" + String(bus) + ": " + String(bound) + " of " +
+                      String(count) + " devices bound").c_str());
+    }
+}
+
+const char* AutoBinder::statusToString(AutoBindStatus status) {
+    switch (status) {
+        case AutoBindStatus::BOUND: return "bound";
+        case AutoBindStatus::ALREADY_BOUND: return "already_bound";
+        case AutoBindStatus::UNIDENTIFIED: return "unidentified";
+        case AutoBindStatus::NO_DRIVER: return "no_driver";
+        case AutoBindStatus::BIND_FAILED: return "bind_failed";
+        default: return "unknown";
+    }
+}
+
+} // namespace PocketOS
@@ -0,0 +1,57 @@
+#ifndef POCKETOS_AUTO_BINDER_H
+#define POCKETOS_AUTO_BINDER_H
+
+#include <Arduino.h>
+
+namespace PocketOS {
+
+// Upper bound on devices reported by one auto-bind pass
+#define MAX_AUTOBIND_RESULTS 32
+
+// Outcome of auto-binding one address
+enum class AutoBindStatus {
+    BOUND,          // Identified and bound with its default driver
+    ALREADY_BOUND,  // Endpoint already has a device; left untouched
+    UNIDENTIFIED,   // Responded but no signature matched
+    NO_DRIVER,      // Identified but no I2C driver in the catalog
+    BIND_FAILED     // Driver init failed or registry full
+};
+
+struct AutoBindResult {
+    uint8_t address;
+    String deviceClass;
+    String confidence;
+    AutoBindStatus status;
+    int deviceId;       // -1 unless BOUND / ALREADY_BOUND
+    uint32_t pollMs;    // Applied poll interval (BOUND only)
+
+    AutoBindResult() : address(0), deviceClass("unknown"), confidence("unknown"),
+                       status(AutoBindStatus::UNIDENTIFIED), deviceId(-1), pollMs(0) {}
+};
+
+/**
+ * Auto Binder - scan, identify, bind and configure in one pass
+ *
+ * The bus is scanned once. Each responding address then runs through
+ * identify -> catalog lookup -> bind -> default poll rate before the next
+ * address is touched, so no address is probed twice.
+ */
+class AutoBinder {
+public:
+    // Auto-bind every device on an I2C bus
+    // Returns the number of results written (at most maxResults)
+    static int bindBus(int busNum, AutoBindResult* results, int maxResults);
+
+    // Boot stage: start the default I2C bus if needed, auto-bind every
+    // started bus and log the outcome
+    static void runBootStage();
+
+    static const char* statusToString(AutoBindStatus status);
+
+private:
+    static void bindAddress(int busNum, uint8_t address, AutoBindResult& result);
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_AUTO_BINDER_H
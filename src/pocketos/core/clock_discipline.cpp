@@ -0,0 +1,128 @@
+#include "clock_discipline.h"
+
+namespace PocketOS {
+
+namespace {
+
+// Frequency estimate (scalar Kalman filter, ppm): initial uncertainty
+// of an uncalibrated crystal, and how fast the drift itself wanders
+// (temperature) per second between captures
+const float DRIFT_VAR_INITIAL = 100.0f * 100.0f;
+const float DRIFT_VAR_PER_S = 0.0005f;
+
+float clampf(float v, float limit) {
+    return v > limit ? limit : (v < -limit ? -limit : v);
+}
+
+} // namespace
+
+void ClockDiscipline::reset() {
+    locked = false;
+    haveFreqRef = false;
+    baseMono = 0;
+    baseUnix = 0;
+    rateQ32 = 0;
+    drift = 0.0f;
+    driftVar = DRIFT_VAR_INITIAL;
+    offsetUs = 0;
+    interval = CLOCK_SYNC_MIN_S;
+    freqEdge = 0;
+    freqSec = 0;
+    captureCount = 0;
+    stepCount = 0;
+}
+
+void ClockDiscipline::relock() {
+    locked = false;
+    haveFreqRef = false;
+    interval = CLOCK_SYNC_MIN_S;
+}
+
+void ClockDiscipline::capture(uint64_t edgeUs, uint32_t halfWidthUs, uint32_t refSec) {
+    uint64_t truth = (uint64_t)refSec * 1000000ULL;
+    bool precise = halfWidthUs <= CLOCK_PRECISE_US;
+    captureCount++;
+
+    if (precise && haveFreqRef && refSec > freqSec && edgeUs > freqEdge) {
+        // Local microseconds per reference microsecond since the last
+        // precise capture; the capture error is spread over the baseline
+        float baseline = (float)(refSec - freqSec);
+        float refUs = baseline * 1e6f;
+        float ppm = ((float)(edgeUs - freqEdge) - refUs) / refUs * 1e6f;
+        float noise = 2.0f * (float)halfWidthUs / baseline;  // ppm
+        driftVar += DRIFT_VAR_PER_S * baseline;
+        if (ppm <= CLOCK_DRIFT_MAX_PPM && ppm >= -CLOCK_DRIFT_MAX_PPM) {
+            float gain = driftVar / (driftVar + noise * noise / 3.0f);
+            drift += gain * (ppm - drift);
+            driftVar *= 1.0f - gain;
+        }
+    }
+    if (precise) {
+        freqEdge = edgeUs;
+        freqSec = refSec;
+        haveFreqRef = true;
+    }
+
+    float slew = 0.0f;
+    if (!locked) {
+        baseMono = edgeUs;
+        baseUnix = truth;
+        offsetUs = 0;
+        locked = true;
+    } else {
+        int64_t offset = (int64_t)(toUnixUs(edgeUs) - truth);
+        offsetUs = (int32_t)(offset > INT32_MAX ? INT32_MAX : (offset < INT32_MIN ? INT32_MIN : offset));
+
+        if (!precise || offset > 4 * CLOCK_TIGHT_US || offset < -4 * CLOCK_TIGHT_US) {
+            interval = CLOCK_SYNC_MIN_S;
+        } else if (offset <= CLOCK_TIGHT_US && offset >= -CLOCK_TIGHT_US && interval < CLOCK_SYNC_MAX_S) {
+            interval *= 2;
+        }
+
+        if (offset > CLOCK_STEP_US || offset < -CLOCK_STEP_US) {
+            baseMono = edgeUs;
+            baseUnix = truth;
+            stepCount++;
+        } else {
+            // Continue from where the clock is and steer the error out
+            baseUnix = toUnixUs(edgeUs);
+            baseMono = edgeUs;
+            slew = clampf(-(float)offset / (float)interval, CLOCK_SLEW_MAX_PPM);
+        }
+    }
+
+    rateQ32 = (int64_t)((slew - drift) * 4294.967296f);  // ppm * 2^32 / 1e6
+}
+
+// Days since 1970-01-01 (H. Hinnant's days_from_civil)
+uint32_t ClockDiscipline::civilToUnix(const CivilTime& t) {
+    int32_t y = (int32_t)t.year - (t.month <= 2 ? 1 : 0);
+    int32_t era = y / 400;
+    uint32_t yoe = (uint32_t)(y - era * 400);
+    uint32_t mp = (t.month + 9) % 12;
+    uint32_t doy = (153 * mp + 2) / 5 + t.day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int32_t days = era * 146097 + (int32_t)doe - 719468;
+    return (uint32_t)days * 86400UL + t.hour * 3600UL + t.minute * 60UL + t.second;
+}
+
+void ClockDiscipline::unixToCivil(uint32_t seconds, CivilTime& t) {
+    uint32_t days = seconds / 86400UL;
+    uint32_t rem = seconds % 86400UL;
+    t.hour = (uint8_t)(rem / 3600);
+    t.minute = (uint8_t)(rem / 60 % 60);
+    t.second = (uint8_t)(rem % 60);
+    t.weekday = (uint8_t)((days + 4) % 7);  // 1970-01-01 was a Thursday
+
+    uint32_t z = days + 719468;
+    uint32_t era = z / 146097;
+    uint32_t doe = z - era * 146097;
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    t.day = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+    t.month = (uint8_t)(mp < 10 ? mp + 3 : mp - 9);
+    t.year = (uint16_t)(yoe + era * 400 + (t.month <= 2 ? 1 : 0));
+}
+
+} // namespace PocketOS
@@ -0,0 +1,115 @@
+#ifndef POCKETOS_CLOCK_DISCIPLINE_H
+#define POCKETOS_CLOCK_DISCIPLINE_H
+
+#include <stdint.h>
+
+namespace PocketOS {
+
+/**
+ * Clock discipline
+ *
+ * Maps the local monotonic microsecond counter to Unix time, steered by
+ * captures of a reference clock (an RTC): "reference second `refSec`
+ * began at local time `edgeUs`, give or take `halfWidthUs`".
+ *
+ *   unix(mono) = baseUnix + (mono - baseMono) * (1 + rate)
+ *
+ * rate is a Q32 fraction, so a conversion is one 64-bit multiply and a
+ * shift. Each capture:
+ *
+ * - measures the local oscillator's frequency error against the
+ *   reference over the time since the last precise capture, weighting
+ *   it by how long that baseline is (driftPpm());
+ * - rebases at the capture edge without a jump and slews the remaining
+ *   phase error out over the next sync interval (at most
+ *   CLOCK_SLEW_MAX_PPM), so time stays monotonic. Errors above
+ *   CLOCK_STEP_US are stepped instead.
+ *
+ * Only captures with halfWidthUs <= CLOCK_PRECISE_US measure frequency;
+ * coarse ones correct phase. The sync interval doubles from
+ * CLOCK_SYNC_MIN_S to CLOCK_SYNC_MAX_S while captures stay within
+ * CLOCK_TIGHT_US, and drops back to the minimum otherwise.
+ *
+ * Before the first capture the mapping is the identity (uptime).
+ *
+ * No Arduino dependency: exercised on the host (tools/clockbench).
+ */
+
+#ifndef CLOCK_SYNC_MIN_S
+#define CLOCK_SYNC_MIN_S 16
+#endif
+
+#ifndef CLOCK_SYNC_MAX_S
+#define CLOCK_SYNC_MAX_S 1024
+#endif
+
+#define CLOCK_PRECISE_US 2000       // Widest capture used for frequency
+#define CLOCK_TIGHT_US 1000         // Offset that lengthens the interval
+#define CLOCK_STEP_US 100000        // Larger offsets are stepped
+#define CLOCK_SLEW_MAX_PPM 500
+#define CLOCK_DRIFT_MAX_PPM 1000    // Larger measurements are rejected
+
+// Broken-down UTC time
+struct CivilTime {
+    uint16_t year;      // 1970..2105
+    uint8_t month;      // 1..12
+    uint8_t day;        // 1..31
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t weekday;    // 0 = Sunday (ignored by civilToUnix)
+};
+
+class ClockDiscipline {
+public:
+    ClockDiscipline() { reset(); }
+
+    void reset();
+
+    // Next capture sets the phase again (reference was set); keeps the
+    // drift estimate
+    void relock();
+
+    void capture(uint64_t edgeUs, uint32_t halfWidthUs, uint32_t refSec);
+
+    uint64_t toUnixUs(uint64_t monoUs) const {
+        int64_t dt = (int64_t)(monoUs - baseMono);
+        return baseUnix + dt + ((dt * rateQ32) >> 32);
+    }
+
+    // Inverse (first order), for scheduling the next capture
+    uint64_t toMonoUs(uint64_t unixUs) const {
+        int64_t dt = (int64_t)(unixUs - baseUnix);
+        return baseMono + dt - ((dt * rateQ32) >> 32);
+    }
+
+    bool isLocked() const { return locked; }
+    float driftPpm() const { return drift; }           // + = local clock fast
+    int32_t lastOffsetUs() const { return offsetUs; }  // + = was ahead of reference
+    uint32_t intervalSeconds() const { return interval; }
+    uint32_t captures() const { return captureCount; }
+    uint32_t steps() const { return stepCount; }
+
+    // Civil time conversion (proleptic Gregorian, UTC)
+    static uint32_t civilToUnix(const CivilTime& t);
+    static void unixToCivil(uint32_t seconds, CivilTime& t);
+
+private:
+    bool locked;
+    bool haveFreqRef;
+    uint64_t baseMono;
+    uint64_t baseUnix;
+    int64_t rateQ32;
+    float drift;
+    float driftVar;         // ppm^2
+    int32_t offsetUs;
+    uint32_t interval;
+    uint64_t freqEdge;      // Last precise capture
+    uint32_t freqSec;
+    uint32_t captureCount;
+    uint32_t stepCount;
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_CLOCK_DISCIPLINE_H
@@ -0,0 +1,159 @@
+#include "crc.h"
+
+namespace PocketOS {
+
+namespace {
+
+// Compile-time table generation (C++11 constexpr: recursion, no loops)
+
+template <size_t... I> struct Seq {};
+template <size_t N, size_t... I> struct MakeSeq : MakeSeq<N - 1, N - 1, I...> {};
+template <size_t... I> struct MakeSeq<0, I...> { typedef Seq<I...> type; };
+
+template <typename T, size_t N> struct Table {
+    T v[N];
+};
+
+// `bits` shift steps of an MSB-first register whose top bit is `top`
+constexpr uint32_t msbSteps(uint32_t v, uint32_t poly, uint32_t top, int bits) {
+    return bits == 0 ? v : msbSteps((v & top) ? ((v << 1) ^ poly) : (v << 1), poly, top, bits - 1);
+}
+
+// `bits` shift steps of a reflected register (poly bit-reversed)
+constexpr uint32_t lsbSteps(uint32_t v, uint32_t poly, int bits) {
+    return bits == 0 ? v : lsbSteps((v & 1) ? ((v >> 1) ^ poly) : (v >> 1), poly, bits - 1);
+}
+
+// Entry i of a table indexed by `Bits` input bits (8 = byte, 4 = nibble)
+template <typename T, int Width, uint32_t Poly, int Bits, size_t... I>
+constexpr Table<T, sizeof...(I)> msbTable(Seq<I...>) {
+    return {{ (T)(msbSteps((uint32_t)I << (Width - Bits), Poly, 1UL << (Width - 1), Bits) &
+                  ((1UL << Width) - 1))... }};
+}
+
+template <typename T, uint32_t ReflectedPoly, int Bits, size_t... I>
+constexpr Table<T, sizeof...(I)> lsbTable(Seq<I...>) {
+    return {{ (T)lsbSteps((uint32_t)I, ReflectedPoly, Bits)... }};
+}
+
+#if POCKETOS_CRC_NIBBLE_TABLES
+
+#define CRC_TABLE_BITS 4
+typedef MakeSeq<16>::type TableSeq;
+
+#else
+
+#define CRC_TABLE_BITS 8
+typedef MakeSeq<256>::type TableSeq;
+
+#endif
+
+constexpr Table<uint8_t, (1 << CRC_TABLE_BITS)> CRC8_31 =
+    msbTable<uint8_t, 8, 0x31, CRC_TABLE_BITS>(TableSeq());
+constexpr Table<uint8_t, (1 << CRC_TABLE_BITS)> CRC8_07 =
+    msbTable<uint8_t, 8, 0x07, CRC_TABLE_BITS>(TableSeq());
+constexpr Table<uint8_t, (1 << CRC_TABLE_BITS)> CRC8_MAXIM =
+    lsbTable<uint8_t, 0x8C, CRC_TABLE_BITS>(TableSeq());
+constexpr Table<uint16_t, (1 << CRC_TABLE_BITS)> CRC16_1021 =
+    msbTable<uint16_t, 16, 0x1021, CRC_TABLE_BITS>(TableSeq());
+constexpr Table<uint16_t, (1 << CRC_TABLE_BITS)> CRC16_MODBUS =
+    lsbTable<uint16_t, 0xA001, CRC_TABLE_BITS>(TableSeq());
+
+static_assert(CRC8_31.v[1] == 0x31 && CRC8_07.v[1] == 0x07, "CRC-8 table generation");
+static_assert(CRC16_1021.v[1] == 0x1021, "CRC-16 table generation");
+
+// One byte through each register layout
+
+inline uint8_t msb8(const uint8_t* t, uint8_t crc, uint8_t b) {
+#if POCKETOS_CRC_NIBBLE_TABLES
+    crc = (uint8_t)((crc << 4) ^ t[(crc ^ b) >> 4]);
+    return (uint8_t)((crc << 4) ^ t[(crc >> 4) ^ (b & 0x0F)]);
+#else
+    return t[crc ^ b];
+#endif
+}
+
+inline uint8_t lsb8(const uint8_t* t, uint8_t crc, uint8_t b) {
+#if POCKETOS_CRC_NIBBLE_TABLES
+    crc = (uint8_t)((crc >> 4) ^ t[(crc ^ b) & 0x0F]);
+    return (uint8_t)((crc >> 4) ^ t[(crc ^ (b >> 4)) & 0x0F]);
+#else
+    return t[crc ^ b];
+#endif
+}
+
+inline uint16_t msb16(const uint16_t* t, uint16_t crc, uint8_t b) {
+#if POCKETOS_CRC_NIBBLE_TABLES
+    crc = (uint16_t)((crc << 4) ^ t[((crc >> 12) ^ (b >> 4)) & 0x0F]);
+    return (uint16_t)((crc << 4) ^ t[((crc >> 12) ^ b) & 0x0F]);
+#else
+    return (uint16_t)((crc << 8) ^ t[(uint8_t)((crc >> 8) ^ b)]);
+#endif
+}
+
+inline uint16_t lsb16(const uint16_t* t, uint16_t crc, uint8_t b) {
+#if POCKETOS_CRC_NIBBLE_TABLES
+    crc = (uint16_t)((crc >> 4) ^ t[(crc ^ b) & 0x0F]);
+    return (uint16_t)((crc >> 4) ^ t[(crc ^ (b >> 4)) & 0x0F]);
+#else
+    return (uint16_t)((crc >> 8) ^ t[(uint8_t)(crc ^ b)]);
+#endif
+}
+
+} // namespace
+
+uint8_t Crc::crc8(const uint8_t* data, size_t len, uint8_t init) {
+    uint8_t crc = init;
+    for (size_t i = 0; i < len; i++) {
+        crc = msb8(CRC8_31.v, crc, data[i]);
+    }
+    return crc;
+}
+
+uint8_t Crc::crc8Smbus(const uint8_t* data, size_t len, uint8_t init) {
+    uint8_t crc = init;
+    for (size_t i = 0; i < len; i++) {
+        crc = msb8(CRC8_07.v, crc, data[i]);
+    }
+    return crc;
+}
+
+uint8_t Crc::crc8Maxim(const uint8_t* data, size_t len, uint8_t init) {
+    uint8_t crc = init;
+    for (size_t i = 0; i < len; i++) {
+        crc = lsb8(CRC8_MAXIM.v, crc, data[i]);
+    }
+    return crc;
+}
+
+uint16_t Crc::crc16Ccitt(const uint8_t* data, size_t len, uint16_t init) {
+    uint16_t crc = init;
+    for (size_t i = 0; i < len; i++) {
+        crc = msb16(CRC16_1021.v, crc, data[i]);
+    }
+    return crc;
+}
+
+uint16_t Crc::crc16Modbus(const uint8_t* data, size_t len, uint16_t init) {
+    uint16_t crc = init;
+    for (size_t i = 0; i < len; i++) {
+        crc = lsb16(CRC16_MODBUS.v, crc, data[i]);
+    }
+    return crc;
+}
+
+uint8_t Crc::sensirionWord(uint16_t word) {
+    return msb8(CRC8_31.v, msb8(CRC8_31.v, 0xFF, (uint8_t)(word >> 8)), (uint8_t)word);
+}
+
+bool Crc::checkSensirionFrame(const uint8_t* frame, size_t words) {
+    // Accumulate mismatches: no early exit, one pass over the frame
+    uint8_t bad = 0;
+    for (size_t i = 0; i < words; i++, frame += 3) {
+        uint8_t crc = msb8(CRC8_31.v, msb8(CRC8_31.v, 0xFF, frame[0]), frame[1]);
+        bad |= (uint8_t)(crc ^ frame[2]);
+    }
+    return bad == 0;
+}
+
+} // namespace PocketOS
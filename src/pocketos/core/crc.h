@@ -0,0 +1,62 @@
+#ifndef POCKETOS_CRC_H
+#define POCKETOS_CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../driver_config.h"
+
+namespace PocketOS {
+
+/**
+ * Table-driven CRCs shared by the drivers
+ *
+ *   crc8        CRC-8, poly 0x31, MSB first   Sensirion (init 0xFF), AHT20,
+ *                                             Si7021 (init 0x00)
+ *   crc8Smbus   CRC-8, poly 0x07, MSB first   SMBus PEC (MLX90614)
+ *   crc8Maxim   CRC-8, poly 0x31, reflected   1-Wire ROM and scratchpad
+ *   crc16Ccitt  CRC-16, poly 0x1021, MSB first, init 0xFFFF (CCITT-FALSE)
+ *   crc16Modbus CRC-16, poly 0x8005, reflected, init 0xFFFF (AM2315)
+ *
+ * None has a final XOR, so a CRC over several buffers is computed by
+ * passing the previous result as `init`.
+ *
+ * Tables are generated at compile time. By default they have 256 entries
+ * (one lookup per byte, 1.8 KB for all five). Tier 0 builds use 16-entry
+ * nibble tables instead (two lookups per byte, 112 bytes); override with
+ * -DPOCKETOS_CRC_NIBBLE_TABLES=0/1. Unused tables are dropped by the linker.
+ *
+ * No Arduino dependency: benchmarked on the host (tools/crcbench).
+ */
+
+#ifndef POCKETOS_CRC_NIBBLE_TABLES
+#if POCKETOS_DRIVER_TIER == POCKETOS_TIER_0
+#define POCKETOS_CRC_NIBBLE_TABLES 1
+#else
+#define POCKETOS_CRC_NIBBLE_TABLES 0
+#endif
+#endif
+
+class Crc {
+public:
+    static uint8_t crc8(const uint8_t* data, size_t len, uint8_t init = 0xFF);
+    static uint8_t crc8Smbus(const uint8_t* data, size_t len, uint8_t init = 0x00);
+    static uint8_t crc8Maxim(const uint8_t* data, size_t len, uint8_t init = 0x00);
+    static uint16_t crc16Ccitt(const uint8_t* data, size_t len, uint16_t init = 0xFFFF);
+    static uint16_t crc16Modbus(const uint8_t* data, size_t len, uint16_t init = 0xFFFF);
+
+    // Sensirion framing: each 16-bit word is sent MSB first followed by
+    // its crc8 (init 0xFF)
+    static uint8_t sensirionWord(uint16_t word);
+
+    // Check a frame of `words` [MSB, LSB, CRC] triplets in one pass
+    static bool checkSensirionFrame(const uint8_t* frame, size_t words);
+
+    // Word `index` of a frame (no check)
+    static uint16_t sensirionValue(const uint8_t* frame, size_t index) {
+        return (uint16_t)((frame[index * 3] << 8) | frame[index * 3 + 1]);
+    }
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_CRC_H
@@ -0,0 +1,288 @@
+#include "device_id_db.h"
+
+// Driver headers provide the authoritative address tables
+#include "../drivers/aht10_driver.h"
+#include "../drivers/aht20_driver.h"
+#include "../drivers/am2315_driver.h"
+#include "../drivers/apds9960_driver.h"
+#include "../drivers/as5600_driver.h"
+#include "../drivers/as6212_driver.h"
+#include "../drivers/as7262_driver.h"
+#include "../drivers/as7263_driver.h"
+#include "../drivers/as7341_driver.h"
+#include "../drivers/at24cxx_driver.h"
+#include "../drivers/aw9523_driver.h"
+#include "../drivers/bh1750_driver.h"
+#include "../drivers/bme280_driver.h"
+#include "../drivers/bme680_driver.h"
+#include "../drivers/bme688_driver.h"
+#include "../drivers/bmp085_driver.h"
+#include "../drivers/bmp180_driver.h"
+#include "../drivers/bmp280_driver.h"
+#include "../drivers/bmp388_driver.h"
+#include "../drivers/bno055_driver.h"
+#include "../drivers/ccs811_driver.h"
+#include "../drivers/dps310_driver.h"
+#include "../drivers/drv2605_driver.h"
+#include "../drivers/ds1307_driver.h"
+#include "../drivers/ds3231_driver.h"
+#include "../drivers/ens160_driver.h"
+#include "../drivers/fdc1004_driver.h"
+#include "../drivers/ft6206_driver.h"
+#include "../drivers/fxas21002c_driver.h"
+#include "../drivers/fxos8700cq_driver.h"
+#include "../drivers/hmc5883l_driver.h"
+#include "../drivers/ht16k33_driver.h"
+#include "../drivers/icm20948_driver.h"
+#include "../drivers/ina219_driver.h"
+#include "../drivers/ina226_driver.h"
+#include "../drivers/ina228_driver.h"
+#include "../drivers/ina260_driver.h"
+#include "../drivers/ina3221_driver.h"
+#include "../drivers/is31fl3731_driver.h"
+#include "../drivers/ism330dhcx_driver.h"
+#include "../drivers/lc709203f_driver.h"
+#include "../drivers/lis2dh12_driver.h"
+#include "../drivers/lis3mdl_driver.h"
+#include "../drivers/lps22hb_driver.h"
+#include "../drivers/lps25h_driver.h"
+#include "../drivers/lsm6ds33_driver.h"
+#include "../drivers/lsm6dsox_driver.h"
+#include "../drivers/mag3110_driver.h"
+#include "../drivers/max30101_driver.h"
+#include "../drivers/mcp23008_driver.h"
+#include "../drivers/mcp23017_driver.h"
+#include "../drivers/mcp3421_driver.h"
+#include "../drivers/mcp4725_driver.h"
+#include "../drivers/mcp4728_driver.h"
+#include "../drivers/mcp79410_driver.h"
+#include "../drivers/mcp9808_driver.h"
+#include "../drivers/mlx90614_driver.h"
+#include "../drivers/mlx90640_driver.h"
+#include "../drivers/mpr121_driver.h"
+#include "../drivers/ms5611_driver.h"
+#include "../drivers/ms8607_driver.h"
+#include "../drivers/nau7802_driver.h"
+#include "../drivers/pca9536_driver.h"
+#include "../drivers/pca9555_driver.h"
+#include "../drivers/pca9685_driver.h"
+#include "../drivers/pcal6416a_driver.h"
+#include "../drivers/pcf2129_driver.h"
+#include "../drivers/pcf8523_driver.h"
+#include "../drivers/pcf8574_driver.h"
+#include "../drivers/pcf8575_driver.h"
+#include "../drivers/pn532_driver.h"
+#include "../drivers/qmc5883l_driver.h"
+#include "../drivers/rv3028_driver.h"
+#include "../drivers/sc16is750_driver.h"
+#include "../drivers/scd30_driver.h"
+#include "../drivers/scd40_driver.h"
+#include "../drivers/scd41_driver.h"
+#include "../drivers/sgp30_driver.h"
+#include "../drivers/sgp40_driver.h"
+#include "../drivers/sht31_driver.h"
+#include "../drivers/sht35_driver.h"
+#include "../drivers/sht40_driver.h"
+#include "../drivers/sht45_driver.h"
+#include "../drivers/shtc3_driver.h"
+#include "../drivers/si1145_driver.h"
+#include "../drivers/si7021_driver.h"
+#include "../drivers/ssd1306_driver.h"
+#include "../drivers/ssd1309_driver.h"
+#include "../drivers/st25dvxx_driver.h"
+#include "../drivers/stts751_driver.h"
+#include "../drivers/tca9546a_driver.h"
+#include "../drivers/tca9548a_driver.h"
+#include "../drivers/tcs34725_driver.h"
+#include "../drivers/tmp102_driver.h"
+#include "../drivers/tmp117_driver.h"
+#include "../drivers/tsl2561_driver.h"
+#include "../drivers/tsl2591_driver.h"
+#include "../drivers/vcnl4010_driver.h"
+#include "../drivers/vcnl4040_driver.h"
+#include "../drivers/veml6070_driver.h"
+#include "../drivers/veml6075_driver.h"
+#include "../drivers/veml7700_driver.h"
+#include "../drivers/vl53l0x_driver.h"
+#include "../drivers/vl53l1x_driver.h"
+#include "../drivers/vl53l4cd_driver.h"
+#include "../drivers/vl53l5cx_driver.h"
+#include "../drivers/vl6180x_driver.h"
+#include "../drivers/wm8960_driver.h"
+
+namespace PocketOS {
+
+// Table helpers
+#define ID_ADDRS(NAME)                  NAME##_VALID_ADDRESSES, NAME##_ADDR_COUNT
+#define ID_BYTE(reg, val)               { reg, 0, 0xFF, val }
+#define ID_BYTE_MASKED(reg, mask, val)  { reg, 0, mask, val }
+#define ID_WORD(reg, mask, val)         { reg, ID_CHECK_WORD, mask, val }
+#define ID_WORD_LE(reg, mask, val)      { reg, ID_CHECK_WORD | ID_CHECK_LE, mask, val }
+#define ID_BYTE_ADDR16(reg, val)        { reg, ID_CHECK_ADDR16, 0xFF, val }
+#define ID_NONE                         { 0, 0, 0, 0 }
+
+// Multi-die parts: each die answers with its own signature, so the
+// entries below are split per die instead of using the driver's full table
+static const uint8_t LSM9DS1_AG_ADDRESSES[] = { 0x6A, 0x6B };
+static const uint8_t LSM9DS1_M_ADDRESSES[] = { 0x1C, 0x1E };
+static const uint8_t LSM303AGR_A_ADDRESSES[] = { 0x19 };
+static const uint8_t LSM303AGR_M_ADDRESSES[] = { 0x1E };
+
+// Entries are ordered so that, among parts sharing an identical signature,
+// the more common one comes first (e.g., BMP180 before BMP085).
+static const DeviceIdEntry DEVICE_ID_TABLE[] = {
+    // Bosch environmental / pressure (0x76/0x77 share CHIP_ID at 0xD0)
+    { "bme280",     ID_ADDRS(BME280),     1, { ID_BYTE(0xD0, 0x60), ID_NONE } },
+    { "bmp280",     ID_ADDRS(BMP280),     1, { ID_BYTE(0xD0, 0x58), ID_NONE } },
+    { "bme680",     ID_ADDRS(BME680),     2, { ID_BYTE(0xD0, 0x61), ID_BYTE(0xF0, 0x00) } },
+    { "bme688",     ID_ADDRS(BME688),     2, { ID_BYTE(0xD0, 0x61), ID_BYTE(0xF0, 0x01) } },
+    { "bmp180",     ID_ADDRS(BMP180),     1, { ID_BYTE(0xD0, 0x55), ID_NONE } },
+    { "bmp085",     ID_ADDRS(BMP085),     1, { ID_BYTE(0xD0, 0x55), ID_NONE } },
+    { "bmp388",     ID_ADDRS(BMP388),     1, { ID_BYTE(0x00, 0x50), ID_NONE } },
+    { "dps310",     ID_ADDRS(DPS310),     1, { ID_BYTE_MASKED(0x0D, 0xF0, 0x10), ID_NONE } },
+    { "bno055",     ID_ADDRS(BNO055),     1, { ID_BYTE(0x00, 0xA0), ID_NONE } },
+
+    // ST MEMS (WHO_AM_I at 0x0F)
+    { "lsm6dsox",   ID_ADDRS(LSM6DSOX),   1, { ID_BYTE(0x0F, 0x6C), ID_NONE } },
+    { "lsm6ds33",   ID_ADDRS(LSM6DS33),   1, { ID_BYTE(0x0F, 0x69), ID_NONE } },
+    { "ism330dhcx", ID_ADDRS(ISM330DHCX), 1, { ID_BYTE(0x0F, 0x6B), ID_NONE } },
+    { "lsm9ds1",    LSM9DS1_AG_ADDRESSES, 2, 1, { ID_BYTE(0x0F, 0x68), ID_NONE } },
+    { "lis2dh12",   ID_ADDRS(LIS2DH12),   1, { ID_BYTE(0x0F, 0x33), ID_NONE } },
+    { "lis3mdl",    ID_ADDRS(LIS3MDL),    1, { ID_BYTE(0x0F, 0x3D), ID_NONE } },
+    { "lsm9ds1",    LSM9DS1_M_ADDRESSES,  2, 1, { ID_BYTE(0x0F, 0x3D), ID_NONE } },
+    { "lsm303agr",  LSM303AGR_A_ADDRESSES, 1, 1, { ID_BYTE(0x0F, 0x33), ID_NONE } },
+    { "lsm303agr",  LSM303AGR_M_ADDRESSES, 1, 1, { ID_BYTE(0x4F, 0x40), ID_NONE } },
+    { "lps22hb",    ID_ADDRS(LPS22HB),    1, { ID_BYTE(0x0F, 0xB1), ID_NONE } },
+    { "lps25h",     ID_ADDRS(LPS25H),     1, { ID_BYTE(0x0F, 0xBD), ID_NONE } },
+    { "stts751",    ID_ADDRS(STTS751),    1, { ID_BYTE(0xFE, 0x53), ID_NONE } },
+
+    // Other IMU / magnetometers
+    { "icm20948",   ID_ADDRS(ICM20948),   1, { ID_BYTE(0x00, 0xEA), ID_NONE } },
+    { "fxos8700cq", ID_ADDRS(FXOS8700CQ), 1, { ID_BYTE(0x0D, 0xC7), ID_NONE } },
+    { "fxas21002c", ID_ADDRS(FXAS21002C), 1, { ID_BYTE(0x0C, 0xD7), ID_NONE } },
+    { "hmc5883l",   ID_ADDRS(HMC5883L),   2, { ID_BYTE(0x0A, 0x48), ID_BYTE(0x0B, 0x34) } },
+    { "qmc5883l",   ID_ADDRS(QMC5883L),   1, { ID_BYTE(0x0D, 0xFF), ID_NONE } },
+    { "mag3110",    ID_ADDRS(MAG3110),    1, { ID_BYTE(0x07, 0xC4), ID_NONE } },
+
+    // TI power monitors / sensors (16-bit big-endian registers)
+    { "ina226",     ID_ADDRS(INA226),     2, { ID_WORD(0xFE, 0xFFFF, 0x5449), ID_WORD(0xFF, 0xFFFF, 0x2260) } },
+    { "ina260",     ID_ADDRS(INA260),     2, { ID_WORD(0xFE, 0xFFFF, 0x5449), ID_WORD(0xFF, 0xFFFF, 0x2270) } },
+    { "ina3221",    ID_ADDRS(INA3221),    2, { ID_WORD(0xFE, 0xFFFF, 0x5449), ID_WORD(0xFF, 0xFFFF, 0x3220) } },
+    { "ina228",     ID_ADDRS(INA228),     2, { ID_WORD(0x3E, 0xFFFF, 0x5449), ID_WORD(0x3F, 0xFFF0, 0x2280) } },
+    { "fdc1004",    ID_ADDRS(FDC1004),    2, { ID_WORD(0xFE, 0xFFFF, 0x5449), ID_WORD(0xFF, 0xFFFF, 0x1004) } },
+    { "tmp117",     ID_ADDRS(TMP117),     1, { ID_WORD(0x0F, 0x0FFF, 0x0117), ID_NONE } },
+    { "mcp9808",    ID_ADDRS(MCP9808),    2, { ID_WORD(0x06, 0xFFFF, 0x0054), ID_WORD(0x07, 0xFF00, 0x0400) } },
+
+    // Light / colour / proximity
+    { "apds9960",   ID_ADDRS(APDS9960),   1, { ID_BYTE(0x92, 0xAB), ID_NONE } },
+    { "as7341",     ID_ADDRS(AS7341),     1, { ID_BYTE_MASKED(0x92, 0xFC, 0x24), ID_NONE } },
+    { "tcs34725",   ID_ADDRS(TCS34725),   1, { ID_BYTE(0x92, 0x44), ID_NONE } },      // CMD | ID
+    { "tsl2591",    ID_ADDRS(TSL2591),    1, { ID_BYTE(0xB2, 0x50), ID_NONE } },      // CMD | NORMAL | ID
+    { "tsl2561",    ID_ADDRS(TSL2561),    1, { ID_BYTE_MASKED(0x8A, 0xF0, 0x50), ID_NONE } },
+    { "si1145",     ID_ADDRS(SI1145),     1, { ID_BYTE(0x00, 0x45), ID_NONE } },
+    { "vcnl4010",   ID_ADDRS(VCNL4010),   1, { ID_BYTE_MASKED(0x81, 0xF0, 0x20), ID_NONE } },
+    { "vcnl4040",   ID_ADDRS(VCNL4040),   1, { ID_WORD_LE(0x0C, 0x0FFF, 0x0186), ID_NONE } },
+    { "veml6075",   ID_ADDRS(VEML6075),   1, { ID_WORD_LE(0x0C, 0x00FF, 0x0026), ID_NONE } },
+
+    // Time-of-flight (VL53L1X/L4CD/6180X use 16-bit register indices)
+    { "vl53l0x",    ID_ADDRS(VL53L0X),    1, { ID_BYTE(0xC0, 0xEE), ID_NONE } },
+    { "vl53l1x",    ID_ADDRS(VL53L1X),    1, { ID_BYTE_ADDR16(0x010F, 0xEA), ID_NONE } },
+    { "vl53l4cd",   ID_ADDRS(VL53L4CD),   1, { ID_BYTE_ADDR16(0x010F, 0xEB), ID_NONE } },
+    { "vl6180x",    ID_ADDRS(VL6180X),    1, { ID_BYTE_ADDR16(0x0000, 0xB4), ID_NONE } },
+
+    // Gas / biometric / misc with ID registers
+    { "ccs811",     ID_ADDRS(CCS811),     1, { ID_BYTE(0x20, 0x81), ID_NONE } },
+    { "ens160",     ID_ADDRS(ENS160),     1, { ID_WORD_LE(0x00, 0xFFFF, 0x0160), ID_NONE } },
+    { "max30101",   ID_ADDRS(MAX30101),   1, { ID_BYTE(0xFF, 0x15), ID_NONE } },
+    { "drv2605",    ID_ADDRS(DRV2605),    1, { ID_BYTE_MASKED(0x00, 0x60, 0x60), ID_NONE } },
+    { "ft6206",     ID_ADDRS(FT6206),     1, { ID_BYTE(0xA3, 0x06), ID_NONE } },
+    { "aw9523",     ID_ADDRS(AW9523),     1, { ID_BYTE(0x10, 0x23), ID_NONE } },
+    { "nau7802",    ID_ADDRS(NAU7802),    1, { ID_BYTE_MASKED(0x1F, 0x0F, 0x0F), ID_NONE } },
+    { "rv3028",     ID_ADDRS(RV3028),     1, { ID_BYTE_MASKED(0x28, 0xF0, 0x30), ID_NONE } },
+
+    // Address-only parts (command-based protocols or no ID register)
+    { "sht31",      ID_ADDRS(SHT31),      0, { ID_NONE, ID_NONE } },
+    { "sht35",      ID_ADDRS(SHT35),      0, { ID_NONE, ID_NONE } },
+    { "sht40",      ID_ADDRS(SHT40),      0, { ID_NONE, ID_NONE } },
+    { "sht45",      ID_ADDRS(SHT45),      0, { ID_NONE, ID_NONE } },
+    { "shtc3",      ID_ADDRS(SHTC3),      0, { ID_NONE, ID_NONE } },
+    { "aht20",      ID_ADDRS(AHT20),      0, { ID_NONE, ID_NONE } },
+    { "aht10",      ID_ADDRS(AHT10),      0, { ID_NONE, ID_NONE } },
+    { "am2315",     ID_ADDRS(AM2315),     0, { ID_NONE, ID_NONE } },
+    { "si7021",     ID_ADDRS(SI7021),     0, { ID_NONE, ID_NONE } },
+    { "scd30",      ID_ADDRS(SCD30),      0, { ID_NONE, ID_NONE } },
+    { "scd41",      ID_ADDRS(SCD41),      0, { ID_NONE, ID_NONE } },
+    { "scd40",      ID_ADDRS(SCD40),      0, { ID_NONE, ID_NONE } },
+    { "sgp30",      ID_ADDRS(SGP30),      0, { ID_NONE, ID_NONE } },
+    { "sgp40",      ID_ADDRS(SGP40),      0, { ID_NONE, ID_NONE } },
+    { "ms5611",     ID_ADDRS(MS5611),     0, { ID_NONE, ID_NONE } },
+    { "ms8607",     ID_ADDRS(MS8607),     0, { ID_NONE, ID_NONE } },
+    { "mlx90614",   ID_ADDRS(MLX90614),   0, { ID_NONE, ID_NONE } },
+    { "mlx90640",   ID_ADDRS(MLX90640),   0, { ID_NONE, ID_NONE } },
+    { "vl53l5cx",   ID_ADDRS(VL53L5CX),   0, { ID_NONE, ID_NONE } },
+    { "bh1750",     ID_ADDRS(BH1750),     0, { ID_NONE, ID_NONE } },
+    { "veml7700",   ID_ADDRS(VEML7700),   0, { ID_NONE, ID_NONE } },
+    { "veml6070",   ID_ADDRS(VEML6070),   0, { ID_NONE, ID_NONE } },
+    { "as7262",     ID_ADDRS(AS7262),     0, { ID_NONE, ID_NONE } },
+    { "as7263",     ID_ADDRS(AS7263),     0, { ID_NONE, ID_NONE } },
+    { "as5600",     ID_ADDRS(AS5600),     0, { ID_NONE, ID_NONE } },
+    { "as6212",     ID_ADDRS(AS6212),     0, { ID_NONE, ID_NONE } },
+    { "tmp102",     ID_ADDRS(TMP102),     0, { ID_NONE, ID_NONE } },
+    { "ina219",     ID_ADDRS(INA219),     0, { ID_NONE, ID_NONE } },
+    { "lc709203f",  ID_ADDRS(LC709203F),  0, { ID_NONE, ID_NONE } },
+    { "mpr121",     ID_ADDRS(MPR121),     0, { ID_NONE, ID_NONE } },
+    { "ds3231",     ID_ADDRS(DS3231),     0, { ID_NONE, ID_NONE } },
+    { "ds1307",     ID_ADDRS(DS1307),     0, { ID_NONE, ID_NONE } },
+    { "pcf8523",    ID_ADDRS(PCF8523),    0, { ID_NONE, ID_NONE } },
+    { "pcf2129",    ID_ADDRS(PCF2129),    0, { ID_NONE, ID_NONE } },
+    { "mcp79410",   ID_ADDRS(MCP79410),   0, { ID_NONE, ID_NONE } },
+    { "mcp3421",    ID_ADDRS(MCP3421),    0, { ID_NONE, ID_NONE } },
+    { "mcp4725",    ID_ADDRS(MCP4725),    0, { ID_NONE, ID_NONE } },
+    { "mcp4728",    ID_ADDRS(MCP4728),    0, { ID_NONE, ID_NONE } },
+    { "at24cxx",    ID_ADDRS(AT24CXX),    0, { ID_NONE, ID_NONE } },
+    { "st25dvxx",   ID_ADDRS(ST25DVXX),   0, { ID_NONE, ID_NONE } },
+    { "pn532",      ID_ADDRS(PN532),      0, { ID_NONE, ID_NONE } },
+    { "sc16is750",  ID_ADDRS(SC16IS750),  0, { ID_NONE, ID_NONE } },
+    { "wm8960",     ID_ADDRS(WM8960),     0, { ID_NONE, ID_NONE } },
+    { "ssd1306",    ID_ADDRS(SSD1306),    0, { ID_NONE, ID_NONE } },
+    { "ssd1309",    ID_ADDRS(SSD1309),    0, { ID_NONE, ID_NONE } },
+    { "ht16k33",    ID_ADDRS(HT16K33),    0, { ID_NONE, ID_NONE } },
+    { "is31fl3731", ID_ADDRS(IS31FL3731), 0, { ID_NONE, ID_NONE } },
+    { "tca9548a",   ID_ADDRS(TCA9548A),   0, { ID_NONE, ID_NONE } },
+    { "tca9546a",   ID_ADDRS(TCA9546A),   0, { ID_NONE, ID_NONE } },
+    { "mcp23017",   ID_ADDRS(MCP23017),   0, { ID_NONE, ID_NONE } },
+    { "mcp23008",   ID_ADDRS(MCP23008),   0, { ID_NONE, ID_NONE } },
+    { "pcal6416a",  ID_ADDRS(PCAL6416A),  0, { ID_NONE, ID_NONE } },
+    { "pca9555",    ID_ADDRS(PCA9555),    0, { ID_NONE, ID_NONE } },
+    { "pca9536",    ID_ADDRS(PCA9536),    0, { ID_NONE, ID_NONE } },
+    { "pcf8574",    ID_ADDRS(PCF8574),    0, { ID_NONE, ID_NONE } },
+    { "pcf8575",    ID_ADDRS(PCF8575),    0, { ID_NONE, ID_NONE } },
+    { "pca9685",    ID_ADDRS(PCA9685),    0, { ID_NONE, ID_NONE } },
+};
+
+#define DEVICE_ID_TABLE_COUNT (sizeof(DEVICE_ID_TABLE) / sizeof(DeviceIdEntry))
+
+const DeviceIdEntry* DeviceIdDatabase::entries(size_t& count) {
+    count = DEVICE_ID_TABLE_COUNT;
+    return DEVICE_ID_TABLE;
+}
+
+bool DeviceIdDatabase::entrySupportsAddress(const DeviceIdEntry& entry, uint8_t address) {
+    for (uint8_t i = 0; i < entry.addressCount; i++) {
+        if (entry.addresses[i] == address) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const DeviceIdEntry* DeviceIdDatabase::findByClass(const String& deviceClass) {
+    for (size_t i = 0; i < DEVICE_ID_TABLE_COUNT; i++) {
+        if (deviceClass == DEVICE_ID_TABLE[i].deviceClass) {
+            return &DEVICE_ID_TABLE[i];
+        }
+    }
+    return nullptr;
+}
+
+} // namespace PocketOS
@@ -0,0 +1,56 @@
+#ifndef POCKETOS_DEVICE_ID_DB_H
+#define POCKETOS_DEVICE_ID_DB_H
+
+#include <Arduino.h>
+
+namespace PocketOS {
+
+/**
+ * Device Identification Database
+ *
+ * One entry per driver: the I2C addresses the part can answer on (taken
+ * from the driver's validAddresses() table) plus up to two register
+ * signatures of the form (register, mask, expected value).
+ *
+ * Entries without signatures are command-based parts (Sensirion, AHT,
+ * DAC/RTC parts without an ID register) and can only be matched by
+ * address. DeviceIdentifier builds its probe decision tree from this table.
+ */
+
+#define DEVICE_ID_MAX_CHECKS 2
+
+// Signature check flags
+#define ID_CHECK_WORD    0x01  // Register value is 16 bits wide
+#define ID_CHECK_LE      0x02  // 16-bit value is little-endian (LSB first)
+#define ID_CHECK_ADDR16  0x04  // Register index is 16 bits (sent MSB first)
+
+struct DeviceIdCheck {
+    uint16_t reg;     // Register index
+    uint8_t flags;    // ID_CHECK_* flags
+    uint16_t mask;    // Mask applied to the value read
+    uint16_t value;   // Expected value after masking
+};
+
+struct DeviceIdEntry {
+    const char* deviceClass;     // Driver ID (e.g., "bme280")
+    const uint8_t* addresses;    // Candidate I2C addresses
+    uint8_t addressCount;
+    uint8_t checkCount;          // 0 = address-only match
+    DeviceIdCheck checks[DEVICE_ID_MAX_CHECKS];
+};
+
+class DeviceIdDatabase {
+public:
+    // All entries, in preference order (earlier wins on identical signatures)
+    static const DeviceIdEntry* entries(size_t& count);
+
+    // Check if an entry can answer on the given address
+    static bool entrySupportsAddress(const DeviceIdEntry& entry, uint8_t address);
+
+    // Find entry by driver ID
+    static const DeviceIdEntry* findByClass(const String& deviceClass);
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_DEVICE_ID_DB_H
@@ -1,12 +1,20 @@
 #include "device_identifier.h"
+#include "device_id_db.h"
 #include "hal.h"
 #include "logger.h"
 #include <Wire.h>
 
 namespace PocketOS {
 
+// Probe key: same register with the same access flags is read only once
+static bool sameProbe(const DeviceIdCheck& a, const DeviceIdCheck& b) {
+    return a.reg == b.reg && a.flags == b.flags;
+}
+
 void DeviceIdentifier::init() {
-    Logger::info("DeviceIdentifier initialized");
+    size_t count;
+    DeviceIdDatabase::entries(count);
+    Logger::info(("DeviceIdentifier initialized (" + String((int)count) + " signatures)").c_str());
 }
 
 DeviceIdentification DeviceIdentifier::identifyEndpoint(const String& endpoint) {
@@ -25,7 +33,7 @@ DeviceIdentification DeviceIdentifier::identifyEndpoint(const String& endpoint)
             return identifyI2C(address);
         }
     }
-    
+
     DeviceIdentification result;
     result.deviceClass = "unknown";
     result.confidence = "unknown";
@@ -35,71 +43,274 @@ DeviceIdentification DeviceIdentifier::identifyEndpoint(const String& endpoint)
 }
 
 DeviceIdentification DeviceIdentifier::identifyI2C(uint8_t address) {
-    Logger::info("Identifying I2C device at address 0x" + String(address, HEX));
-    
-    // Try BME280 first
-    DeviceIdentification result = identifyBME280(address);
-    if (result.identified) {
+    Logger::info(("Identifying I2C device at address 0x" + String(address, HEX)).c_str());
+
+    if (!HAL::i2cProbe(0, address)) {
+        DeviceIdentification result;
+        result.address = address;
+        result.details = "No device responded at 0x" + String(address, HEX);
         return result;
     }
-    
-    // Future: Add more device identifications here
-    // result = identifyBME680(address);
-    // result = identifySHT31(address);
-    // etc.
-    
-    // Device responded but not identified
-    result.deviceClass = "unknown";
-    result.confidence = "low";
-    result.details = "Device present but not in identification database";
-    result.identified = false;
-    return result;
+
+    return identifyPresent(address);
 }
 
-DeviceIdentification DeviceIdentifier::identifyBME280(uint8_t address) {
+int DeviceIdentifier::identifyBus(int busNum, DeviceIdentification* results, int maxResults) {
+    // Signature reads go through Wire (bus 0); scanning another bus would
+    // match its addresses against bus 0's registers
+    if (busNum != 0) {
+        return 0;
+    }
+
+    uint8_t found[128];
+    int foundCount = 0;
+    if (!HAL::i2cScan(busNum, found, &foundCount, 128)) {
+        return 0;
+    }
+
+    int count = 0;
+    for (int i = 0; i < foundCount && count < maxResults; i++) {
+        results[count++] = identifyPresent(found[i]);
+    }
+    return count;
+}
+
+DeviceIdentification DeviceIdentifier::identifyPresent(uint8_t address) {
     DeviceIdentification result;
-    
-    // BME280 has chip ID 0x60 at register 0xD0
-    // Valid addresses: 0x76 or 0x77
-    if (address != 0x76 && address != 0x77) {
-        result.identified = false;
+    result.address = address;
+
+    // Gather candidates for this address
+    size_t entryCount;
+    const DeviceIdEntry* table = DeviceIdDatabase::entries(entryCount);
+
+    const DeviceIdEntry* cand[MAX_ID_CANDIDATES];
+    bool alive[MAX_ID_CANDIDATES];
+    uint8_t passed[MAX_ID_CANDIDATES];
+    int candCount = 0;
+
+    for (size_t i = 0; i < entryCount && candCount < MAX_ID_CANDIDATES; i++) {
+        if (DeviceIdDatabase::entrySupportsAddress(table[i], address)) {
+            cand[candCount] = &table[i];
+            alive[candCount] = true;
+            passed[candCount] = 0;
+            candCount++;
+        }
+    }
+
+    if (candCount == 0) {
+        result.confidence = "low";
+        result.details = "Device present but not in identification database";
         return result;
     }
-    
-    uint8_t chipId = 0;
-    if (!readI2CRegister(address, 0xD0, &chipId)) {
-        result.identified = false;
-        result.details = "Failed to read chip ID register";
+
+    // Probes already issued (never read the same register twice)
+    DeviceIdCheck done[MAX_ID_PROBES];
+    int doneCount = 0;
+
+    while (doneCount < MAX_ID_PROBES) {
+        // Stop as soon as one candidate has every signature check satisfied
+        bool verified = false;
+        for (int c = 0; c < candCount; c++) {
+            if (alive[c] && cand[c]->checkCount > 0 && passed[c] == cand[c]->checkCount) {
+                verified = true;
+                break;
+            }
+        }
+        if (verified) {
+            break;
+        }
+
+        // Pick the probe that splits the live candidates into the most
+        // distinct expected outcomes. 8-bit register indices are preferred
+        // because a 16-bit index write can land as a data write on 8-bit parts.
+        const DeviceIdCheck* best = nullptr;
+        int bestOutcomes = 0;
+        int bestCovered = 0;
+        bool bestAddr16 = true;
+
+        for (int c = 0; c < candCount; c++) {
+            if (!alive[c]) continue;
+            for (uint8_t k = 0; k < cand[c]->checkCount; k++) {
+                const DeviceIdCheck& probe = cand[c]->checks[k];
+
+                bool issued = false;
+                for (int d = 0; d < doneCount; d++) {
+                    if (sameProbe(done[d], probe)) { issued = true; break; }
+                }
+                if (issued) continue;
+
+                // Count candidates using this probe and their distinct outcomes
+                int covered = 0;
+                int outcomes = 0;
+                for (int o = 0; o < candCount; o++) {
+                    if (!alive[o]) continue;
+                    for (uint8_t j = 0; j < cand[o]->checkCount; j++) {
+                        const DeviceIdCheck& other = cand[o]->checks[j];
+                        if (!sameProbe(other, probe)) continue;
+                        covered++;
+
+                        bool seen = false;
+                        for (int p = 0; p < o && !seen; p++) {
+                            if (!alive[p]) continue;
+                            for (uint8_t q = 0; q < cand[p]->checkCount; q++) {
+                                const DeviceIdCheck& prev = cand[p]->checks[q];
+                                if (sameProbe(prev, probe) && prev.mask == other.mask &&
+                                    prev.value == other.value) {
+                                    seen = true;
+                                    break;
+                                }
+                            }
+                        }
+                        if (!seen) outcomes++;
+                    }
+                }
+
+                bool addr16 = (probe.flags & ID_CHECK_ADDR16) != 0;
+                bool better = false;
+                if (!best) {
+                    better = true;
+                } else if (addr16 != bestAddr16) {
+                    better = !addr16;
+                } else if (outcomes != bestOutcomes) {
+                    better = outcomes > bestOutcomes;
+                } else {
+                    better = covered > bestCovered;
+                }
+
+                if (better) {
+                    best = &probe;
+                    bestOutcomes = outcomes;
+                    bestCovered = covered;
+                    bestAddr16 = addr16;
+                }
+            }
+        }
+
+        if (!best) {
+            break;  // No discriminating reads left
+        }
+
+        DeviceIdCheck probe = *best;
+        done[doneCount++] = probe;
+
+        uint16_t value = 0;
+        bool ok = readCheckValue(address, probe, &value);
+        result.probeReads++;
+
+        for (int c = 0; c < candCount; c++) {
+            if (!alive[c]) continue;
+            for (uint8_t k = 0; k < cand[c]->checkCount; k++) {
+                const DeviceIdCheck& check = cand[c]->checks[k];
+                if (!sameProbe(check, probe)) continue;
+                if (ok && (value & check.mask) == check.value) {
+                    passed[c]++;
+                } else {
+                    alive[c] = false;
+                }
+            }
+        }
+    }
+
+    // Collect verified signatures first, then address-only survivors
+    int verifiedIdx = -1;
+    String alsoMatches = "";
+    for (int c = 0; c < candCount; c++) {
+        if (alive[c] && cand[c]->checkCount > 0 && passed[c] == cand[c]->checkCount) {
+            if (verifiedIdx < 0) {
+                verifiedIdx = c;
+            } else if (String(cand[c]->deviceClass) != cand[verifiedIdx]->deviceClass) {
+                if (alsoMatches.length() > 0) alsoMatches += ",";
+                alsoMatches += cand[c]->deviceClass;
+            }
+        }
+    }
+
+    if (verifiedIdx >= 0) {
+        const DeviceIdEntry* e = cand[verifiedIdx];
+        result.deviceClass = e->deviceClass;
+        result.identified = true;
+        result.confidence = alsoMatches.length() > 0 ? "medium" : "high";
+        result.details = "Address: 0x" + String(address, HEX) + ", signature reads: " + String((int)result.probeReads);
+        for (uint8_t k = 0; k < e->checkCount; k++) {
+            result.details += ", reg 0x" + String(e->checks[k].reg, HEX) + "=0x" + String(e->checks[k].value, HEX);
+        }
+        if (alsoMatches.length() > 0) {
+            result.details += ", also matches: " + alsoMatches;
+        }
+        Logger::info((result.deviceClass + " identified at 0x" + String(address, HEX)).c_str());
         return result;
     }
-    
-    if (chipId == 0x60) {
-        result.deviceClass = "bme280";
-        result.confidence = "high";
-        result.details = "Chip ID: 0x60, Address: 0x" + String(address, HEX);
+
+    int addressOnly = 0;
+    int firstAddressOnly = -1;
+    String candidates = "";
+    for (int c = 0; c < candCount; c++) {
+        if (alive[c] && cand[c]->checkCount == 0) {
+            if (firstAddressOnly < 0) firstAddressOnly = c;
+            if (addressOnly > 0) candidates += ",";
+            candidates += cand[c]->deviceClass;
+            addressOnly++;
+        }
+    }
+
+    if (addressOnly == 1) {
+        // Only one driver can live here and it has no ID register
+        result.deviceClass = cand[firstAddressOnly]->deviceClass;
         result.identified = true;
-        Logger::info("BME280 identified at 0x" + String(address, HEX));
+        result.confidence = "low";
+        result.details = "Address-only match (no ID register), signature reads: " + String((int)result.probeReads);
+        return result;
+    }
+
+    // Device responded but not identified
+    result.deviceClass = "unknown";
+    result.confidence = "low";
+    result.identified = false;
+    if (addressOnly > 1) {
+        result.details = "Ambiguous address-only candidates: " + candidates;
     } else {
-        result.identified = false;
-        result.details = "Chip ID mismatch: expected 0x60, got 0x" + String(chipId, HEX);
+        result.details = "Device present but no signature matched";
     }
-    
     return result;
 }
 
+bool DeviceIdentifier::readCheckValue(uint8_t address, const DeviceIdCheck& check, uint16_t* value) {
+    uint8_t buf[2] = {0, 0};
+    size_t len = (check.flags & ID_CHECK_WORD) ? 2 : 1;
+
+    bool ok;
+    if (check.flags & ID_CHECK_ADDR16) {
+        ok = readI2CRegisters16(address, check.reg, buf, len);
+    } else {
+        ok = readI2CRegisters(address, (uint8_t)check.reg, buf, len);
+    }
+    if (!ok) {
+        return false;
+    }
+
+    if (len == 1) {
+        *value = buf[0];
+    } else if (check.flags & ID_CHECK_LE) {
+        *value = (uint16_t)buf[0] | ((uint16_t)buf[1] << 8);
+    } else {
+        *value = ((uint16_t)buf[0] << 8) | buf[1];
+    }
+    return true;
+}
+
 bool DeviceIdentifier::readI2CRegister(uint8_t address, uint8_t reg, uint8_t* value) {
     Wire.beginTransmission(address);
     Wire.write(reg);
     if (Wire.endTransmission() != 0) {
         return false;
     }
-    
+
     Wire.requestFrom(address, (uint8_t)1);
     if (Wire.available()) {
         *value = Wire.read();
         return true;
     }
-    
+
     return false;
 }
 
@@ -109,13 +320,30 @@ bool DeviceIdentifier::readI2CRegisters(uint8_t address, uint8_t reg, uint8_t* b
     if (Wire.endTransmission() != 0) {
         return false;
     }
-    
+
     Wire.requestFrom(address, (uint8_t)len);
     size_t count = 0;
     while (Wire.available() && count < len) {
         buffer[count++] = Wire.read();
     }
-    
+
+    return (count == len);
+}
+
+bool DeviceIdentifier::readI2CRegisters16(uint8_t address, uint16_t reg, uint8_t* buffer, size_t len) {
+    Wire.beginTransmission(address);
+    Wire.write((uint8_t)(reg >> 8));
+    Wire.write((uint8_t)(reg & 0xFF));
+    if (Wire.endTransmission() != 0) {
+        return false;
+    }
+
+    Wire.requestFrom(address, (uint8_t)len);
+    size_t count = 0;
+    while (Wire.available() && count < len) {
+        buffer[count++] = Wire.read();
+    }
+
     return (count == len);
 }
 
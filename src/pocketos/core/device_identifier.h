@@ -5,34 +5,60 @@
 
 namespace PocketOS {
 
+struct DeviceIdCheck;
+
+// Upper bound on drivers sharing one I2C address (0x77 is the worst case)
+#define MAX_ID_CANDIDATES 24
+
+// Upper bound on distinct signature registers read for one address
+#define MAX_ID_PROBES 8
+
 // Device identification result
 struct DeviceIdentification {
     String deviceClass;      // e.g., "bme280", "bme680", "sht31"
     String confidence;       // "high", "medium", "low", "unknown"
     String details;          // Additional info
     bool identified;
-    
-    DeviceIdentification() : deviceClass("unknown"), confidence("unknown"), details(""), identified(false) {}
+    uint8_t address;         // I2C address that was identified
+    uint8_t probeReads;      // Register reads spent on identification
+
+    DeviceIdentification() : deviceClass("unknown"), confidence("unknown"), details(""), identified(false),
+                             address(0), probeReads(0) {}
 };
 
-// Device Identifier - Extensible identification engine
+// Device Identifier - Table-driven identification engine
+//
+// Candidates for an address come from DeviceIdDatabase. Identification runs
+// as a decision tree: each step reads the signature register that splits
+// the remaining candidates into the most distinct outcomes, then drops the
+// candidates whose (mask, value) does not match.
 class DeviceIdentifier {
 public:
     static void init();
-    
+
     // Identify device at I2C address
     static DeviceIdentification identifyI2C(uint8_t address);
-    
+
     // Identify device at endpoint
     static DeviceIdentification identifyEndpoint(const String& endpoint);
-    
+
+    // Scan a bus and identify every responding address (bus 0 only)
+    // Returns the number of results written (at most maxResults)
+    static int identifyBus(int busNum, DeviceIdentification* results, int maxResults);
+
+    // Decision-tree identification of an address already seen in a scan
+    // (skips the presence probe)
+    static DeviceIdentification identifyPresent(uint8_t address);
+
 private:
-    // Specific device identification functions
-    static DeviceIdentification identifyBME280(uint8_t address);
-    
+
+    // Read one signature register (8/16-bit value, 8/16-bit index)
+    static bool readCheckValue(uint8_t address, const DeviceIdCheck& check, uint16_t* value);
+
     // Helper: Read I2C register
     static bool readI2CRegister(uint8_t address, uint8_t reg, uint8_t* value);
     static bool readI2CRegisters(uint8_t address, uint8_t reg, uint8_t* buffer, size_t len);
+    static bool readI2CRegisters16(uint8_t address, uint16_t reg, uint8_t* buffer, size_t len);
 };
 
 } // namespace PocketOS
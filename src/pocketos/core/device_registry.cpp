@@ -2,16 +2,23 @@
 #include "logger.h"
 #include "resource_manager.h"
 #include "endpoint_registry.h"
+#include "driver_catalog.h"
+#include "timeseries_store.h"
 #include "../drivers/gpio_dout_driver.h"
 #include "../drivers/bme280_driver.h"
+#include "../drivers/i2c_driver_adapter.h"
 #include "../drivers/register_types.h"
 #include "../driver_config.h"
 
 namespace PocketOS {
 
 Device DeviceRegistry::devices[MAX_DEVICES];
+SignalFilterSlot DeviceRegistry::filters[MAX_SIGNAL_FILTERS];
 int DeviceRegistry::deviceCount = 0;
 int DeviceRegistry::nextDeviceId = 1;
+uint32_t DeviceRegistry::updateLastUs = 0;
+uint32_t DeviceRegistry::updateAvgUs = 0;
+uint32_t DeviceRegistry::updateMaxUs = 0;
 
 void DeviceRegistry::init() {
     deviceCount = 0;
@@ -20,6 +27,9 @@ void DeviceRegistry::init() {
         devices[i].active = false;
         devices[i].driver = nullptr;
     }
+    for (int i = 0; i < MAX_SIGNAL_FILTERS; i++) {
+        filters[i].active = false;
+    }
     Logger::info("Device Registry initialized");
 }
 
@@ -30,6 +40,14 @@ int DeviceRegistry::bindDevice(const String& driverId, const String& endpoint) {
         if (endpoint.startsWith("gpio.dout.")) {
             int pin = endpoint.substring(10).toInt();
             EndpointRegistry::registerEndpoint(endpoint, EndpointType::GPIO_DOUT, pin);
+        } else if (endpoint.startsWith("i2c") && endpoint.indexOf(':') > 0) {
+            // I2C device endpoint (e.g., i2c0:0x76); driver init verifies presence
+            int address = (int)strtol(endpoint.substring(endpoint.indexOf(':') + 1).c_str(), nullptr, 16);
+            EndpointRegistry::registerEndpoint(endpoint, EndpointType::I2C_ADDR, address);
+        } else if (endpoint.startsWith("spi") && endpoint.indexOf("cs=") > 0) {
+            // SPI device endpoint (e.g., spi0:cs=5,irq=4); the driver claims its pins
+            int cs = endpoint.substring(endpoint.indexOf("cs=") + 3).toInt();
+            EndpointRegistry::registerEndpoint(endpoint, EndpointType::SPI_DEVICE, cs);
         } else {
             Logger::error("Endpoint not found");
             return -1;
@@ -67,6 +85,9 @@ int DeviceRegistry::bindDevice(const String& driverId, const String& endpoint) {
     devices[slot].state = DeviceState::READY;
     devices[slot].driver = driver;
     devices[slot].lastOkMs = millis();
+    devices[slot].updateMaxUs = 0;
+    devices[slot].sampleSeq = driver->sampleSequence();
+    devices[slot].irqLine = -1;
     deviceCount++;
     
     Logger::info(("Device " + String(deviceId) + " bound to " + endpoint).c_str());
@@ -80,10 +101,12 @@ bool DeviceRegistry::unbindDevice(int deviceId) {
     }
     
     // Clean up driver
+    releaseIrq(devices[idx]);
     if (devices[idx].driver) {
         delete devices[idx].driver;
         devices[idx].driver = nullptr;
     }
+    releaseFilters(deviceId);
     
     devices[idx].active = false;
     deviceCount--;
@@ -96,6 +119,7 @@ bool DeviceRegistry::unbindAll() {
     int unbound = 0;
     for (int i = 0; i < MAX_DEVICES; i++) {
         if (devices[i].active) {
+            releaseIrq(devices[i]);
             if (devices[i].driver) {
                 delete devices[i].driver;
                 devices[i].driver = nullptr;
@@ -104,6 +128,9 @@ bool DeviceRegistry::unbindAll() {
             unbound++;
         }
     }
+    for (int i = 0; i < MAX_SIGNAL_FILTERS; i++) {
+        filters[i].active = false;
+    }
     deviceCount = 0;
     Logger::info(String("Unbound " + String(unbound) + " devices").c_str());
     return true;
@@ -140,6 +167,15 @@ String DeviceRegistry::listDevices() {
     return result;
 }
 
+int DeviceRegistry::findDeviceByEndpoint(const String& endpoint) {
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        if (devices[i].active && devices[i].endpoint == endpoint) {
+            return devices[i].deviceId;
+        }
+    }
+    return -1;
+}
+
 bool DeviceRegistry::deviceExists(int deviceId) {
     return findDevice(deviceId) >= 0;
 }
@@ -152,12 +188,33 @@ DeviceState DeviceRegistry::getDeviceState(int deviceId) {
     return DeviceState::FAULT;
 }
 
+IDriver* DeviceRegistry::getDriver(int deviceId) {
+    int idx = findDevice(deviceId);
+    return idx >= 0 ? devices[idx].driver : nullptr;
+}
+
+String DeviceRegistry::getDeviceEndpoint(int deviceId) {
+    int idx = findDevice(deviceId);
+    return idx >= 0 ? devices[idx].endpoint : String("");
+}
+
 bool DeviceRegistry::setDeviceParam(int deviceId, const String& paramName, const String& value) {
     int idx = findDevice(deviceId);
     if (idx < 0 || !devices[idx].driver) {
         return false;
     }
     
+    // Signal filter stage (handled here, not by the driver)
+    if (paramName.startsWith("filter.")) {
+        return setSignalFilter(devices[idx], paramName.substring(7), value);
+    }
+    if (paramName.startsWith("record.")) {
+        return setSignalRecord(devices[idx], paramName.substring(7), value);
+    }
+    if (paramName == "irq") {
+        return setDeviceIrq(devices[idx], value);
+    }
+    
     return devices[idx].driver->setParam(paramName, value);
 }
 
@@ -167,9 +224,260 @@ String DeviceRegistry::getDeviceParam(int deviceId, const String& paramName) {
         return "";
     }
     
+    if (paramName.startsWith("filter.")) {
+        int f = findFilter(deviceId, paramName.substring(7));
+        return f >= 0 ? String(filters[f].spec) : String("none");
+    }
+    if (paramName.startsWith("record.")) {
+        int f = findFilter(deviceId, paramName.substring(7));
+        return (f >= 0 && filters[f].record) ? String("on") : String("off");
+    }
+    if (paramName == "irq") {
+        const IrqLine* line = InterruptManager::getLine(devices[idx].irqLine);
+        return line ? String(line->pin) + ":" + InterruptManager::edgeToString(line->edge) : String("none");
+    }
+    if (paramName.startsWith("signal.")) {
+        // Filtered value if a filter is set, else the raw last sample
+        String signal = paramName.substring(7);
+        int f = findFilter(deviceId, signal);
+        if (f >= 0) {
+            return filters[f].hasValue ? String(filters[f].value, 3) : String("");
+        }
+        float value;
+        if (devices[idx].driver->sampleSequence() != 0 &&
+            devices[idx].driver->readSignal(signal.c_str(), value)) {
+            return String(value, 3);
+        }
+        return "";
+    }
+    
     return devices[idx].driver->getParam(paramName);
 }
 
+int DeviceRegistry::findFilter(int deviceId, const String& signal) {
+    for (int i = 0; i < MAX_SIGNAL_FILTERS; i++) {
+        if (filters[i].active && filters[i].deviceId == deviceId && signal == filters[i].signal) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int DeviceRegistry::acquireFilter(Device& dev, const String& signal) {
+    int f = findFilter(dev.deviceId, signal);
+    if (f >= 0) {
+        return f;
+    }
+    
+    float probe;
+    if (signal.length() >= SIGNAL_NAME_MAX || !dev.driver->readSignal(signal.c_str(), probe)) {
+        return -1;
+    }
+    
+    for (int i = 0; i < MAX_SIGNAL_FILTERS; i++) {
+        if (!filters[i].active) {
+            SignalFilterSlot& slot = filters[i];
+            slot.active = true;
+            slot.deviceId = dev.deviceId;
+            strncpy(slot.signal, signal.c_str(), SIGNAL_NAME_MAX);
+            strcpy(slot.spec, "none");
+            slot.filter.configure("none");
+            slot.record = false;
+            slot.hasValue = false;
+            slot.pending = false;
+            slot.samplesIn = 0;
+            slot.samplesOut = 0;
+            return i;
+        }
+    }
+    Logger::error("No free signal filter slots");
+    return -1;
+}
+
+bool DeviceRegistry::setSignalFilter(Device& dev, const String& signal, const String& spec) {
+    // "none" detaches the filter (the slot stays while the signal is recorded)
+    if (spec == "none") {
+        int f = findFilter(dev.deviceId, signal);
+        if (f >= 0) {
+            filters[f].filter.configure("none");
+            strcpy(filters[f].spec, "none");
+            filters[f].active = filters[f].record;
+        }
+        return true;
+    }
+    
+    if (spec.length() >= SIGNAL_SPEC_MAX || !SignalFilter::validate(spec.c_str())) {
+        return false;
+    }
+    int f = acquireFilter(dev, signal);
+    if (f < 0) {
+        return false;
+    }
+    
+    SignalFilterSlot& slot = filters[f];
+    slot.filter.configure(spec.c_str());
+    slot.filter.reset();
+    strncpy(slot.spec, spec.c_str(), SIGNAL_SPEC_MAX);
+    slot.hasValue = false;
+    slot.pending = false;
+    slot.samplesIn = 0;
+    slot.samplesOut = 0;
+    return true;
+}
+
+bool DeviceRegistry::setSignalRecord(Device& dev, const String& signal, const String& value) {
+    if (value == "off" || value == "0") {
+        int f = findFilter(dev.deviceId, signal);
+        if (f >= 0) {
+            filters[f].record = false;
+            filters[f].active = strcmp(filters[f].spec, "none") != 0;
+        }
+        return true;
+    }
+    if (value != "on" && value != "1") {
+        return false;
+    }
+    
+    // Series "<endpoint>_<signal>" survives rebinding under another device id
+    char series[TS_SERIES_NAME_MAX];
+    if (!TimeSeriesStore::isReady() ||
+        !TimeSeriesStore::seriesName(dev.endpoint.c_str(), signal.c_str(), series, sizeof(series))) {
+        return false;
+    }
+    int f = acquireFilter(dev, signal);
+    if (f < 0) {
+        return false;
+    }
+    strcpy(filters[f].series, series);
+    filters[f].record = true;
+    return true;
+}
+
+void DeviceRegistry::releaseFilters(int deviceId) {
+    for (int i = 0; i < MAX_SIGNAL_FILTERS; i++) {
+        if (filters[i].deviceId == deviceId) {
+            filters[i].active = false;
+        }
+    }
+}
+
+void DeviceRegistry::runFilters(Device& dev) {
+    for (int i = 0; i < MAX_SIGNAL_FILTERS; i++) {
+        SignalFilterSlot& slot = filters[i];
+        if (!slot.active || slot.deviceId != dev.deviceId) {
+            continue;
+        }
+        float raw;
+        if (!dev.driver->readSignal(slot.signal, raw)) {
+            continue;
+        }
+        slot.samplesIn++;
+        if (slot.filter.process(raw, slot.value)) {
+            slot.hasValue = true;
+            slot.pending = true;
+            slot.samplesOut++;
+            if (slot.record) {
+                TimeSeriesStore::append(slot.series, slot.value);
+            }
+        }
+    }
+}
+
+// "<pin>[:rising|falling|change]" (default falling) or "none"
+bool DeviceRegistry::setDeviceIrq(Device& dev, const String& value) {
+    if (value == "none" || value == "off") {
+        releaseIrq(dev);
+        return true;
+    }
+    
+    // Validate before touching the current line: a bad value keeps it
+    int colon = value.indexOf(':');
+    String pinText = colon >= 0 ? value.substring(0, colon) : value;
+    IrqEdge edge = IrqEdge::FALLING_EDGE;
+    if (pinText.length() == 0) {
+        return false;
+    }
+    for (unsigned int i = 0; i < pinText.length(); i++) {
+        if (!isdigit((unsigned char)pinText.charAt(i))) {
+            return false;
+        }
+    }
+    if (colon >= 0 && !InterruptManager::parseEdge(value.substring(colon + 1), edge)) {
+        return false;
+    }
+    int pin = pinText.toInt();
+    
+    // The old line holds its pin, so it is released before the attach and
+    // restored if the new one cannot be attached
+    int oldPin = -1;
+    IrqEdge oldEdge = IrqEdge::FALLING_EDGE;
+    const IrqLine* old = dev.irqLine >= 0 ? InterruptManager::getLine(dev.irqLine) : nullptr;
+    if (old) {
+        if (old->pin == pin && old->edge == edge) {
+            return true;
+        }
+        oldPin = old->pin;
+        oldEdge = old->edge;
+    }
+    releaseIrq(dev);
+    
+    if (attachIrq(dev, pin, edge)) {
+        return true;
+    }
+    if (oldPin >= 0 && !attachIrq(dev, oldPin, oldEdge)) {
+        Logger::error(("Device " + String(dev.deviceId) + ": irq pin " + String(oldPin) +
+                       " detached and could not be restored, polling").c_str());
+    }
+    return false;
+}
+
+bool DeviceRegistry::attachIrq(Device& dev, int pin, IrqEdge edge) {
+    String owner = "dev" + String(dev.deviceId);
+    int line = InterruptManager::attach(pin, edge, onDeviceInterrupt, &dev, owner.c_str(), dev.deviceId);
+    if (line < 0) {
+        return false;
+    }
+    dev.irqLine = line;
+    dev.driver->setInterruptPin(pin);
+    return true;
+}
+
+void DeviceRegistry::releaseIrq(Device& dev) {
+    if (dev.irqLine < 0) {
+        return;
+    }
+    InterruptManager::detach(dev.irqLine);
+    dev.irqLine = -1;
+    if (dev.driver) {
+        dev.driver->setInterruptPin(-1);
+    }
+}
+
+void DeviceRegistry::onDeviceInterrupt(void* context, const IrqEvent& event) {
+    // The slot may have been rebound since the edge: match the device id
+    Device* dev = static_cast<Device*>(context);
+    if (dev->active && dev->deviceId == event.deviceId && dev->driver &&
+        dev->state == DeviceState::READY) {
+        dev->driver->onInterrupt(event.timestampUs);
+    }
+}
+
+String DeviceRegistry::getSignalReport(int deviceId, bool changedOnly) {
+    String report = "";
+    for (int i = 0; i < MAX_SIGNAL_FILTERS; i++) {
+        SignalFilterSlot& slot = filters[i];
+        if (!slot.active || !slot.hasValue || (deviceId >= 0 && slot.deviceId != deviceId)) {
+            continue;
+        }
+        if (changedOnly && !slot.pending) {
+            continue;
+        }
+        slot.pending = false;
+        report += "dev" + String(slot.deviceId) + "." + String(slot.signal) + "=" + String(slot.value, 3) + "\n";
+    }
+    return report;
+}
+
 String DeviceRegistry::getDeviceSchema(int deviceId) {
     int idx = findDevice(deviceId);
     if (idx < 0 || !devices[idx].driver) {
@@ -181,12 +489,35 @@ String DeviceRegistry::getDeviceSchema(int deviceId) {
 }
 
 void DeviceRegistry::updateAll() {
+    unsigned long start = micros();
     for (int i = 0; i < MAX_DEVICES; i++) {
         if (devices[i].active && devices[i].driver && 
             devices[i].state == DeviceState::READY) {
+            unsigned long t0 = micros();
             devices[i].driver->update();
+            uint32_t seq = devices[i].driver->sampleSequence();
+            if (seq != devices[i].sampleSeq) {
+                devices[i].sampleSeq = seq;
+                runFilters(devices[i]);
+            }
+            uint32_t us = (uint32_t)(micros() - t0);
+            if (us > devices[i].updateMaxUs) {
+                devices[i].updateMaxUs = us;
+            }
         }
     }
+    
+    updateLastUs = (uint32_t)(micros() - start);
+    updateAvgUs += ((int32_t)updateLastUs - (int32_t)updateAvgUs) / 16;
+    if (updateLastUs > updateMaxUs) {
+        updateMaxUs = updateLastUs;
+    }
+}
+
+void DeviceRegistry::getUpdateStats(uint32_t& lastUs, uint32_t& avgUs, uint32_t& maxUs) {
+    lastUs = updateLastUs;
+    avgUs = updateAvgUs;
+    maxUs = updateMaxUs;
 }
 
 int DeviceRegistry::findDevice(int deviceId) {
@@ -211,6 +542,13 @@ IDriver* DeviceRegistry::createDriver(const String& driverId, const String& endp
     if (driverId == "gpio.dout") {
         return new GPIODoutDriver(endpoint);
     }
+    if (endpoint.startsWith("i2c") && endpoint.indexOf(':') > 0) {
+        uint8_t address = (uint8_t)strtol(endpoint.substring(endpoint.indexOf(':') + 1).c_str(), nullptr, 16);
+        return DriverCatalog::createI2C(driverId, address);
+    }
+    if (endpoint.startsWith("spi") && endpoint.indexOf(':') > 0) {
+        return DriverCatalog::createSPI(driverId, endpoint);
+    }
     // Add more drivers here as needed
     return nullptr;
 }
@@ -239,11 +577,64 @@ String DeviceRegistry::getDeviceStatus(int deviceId) {
     status += "init_failures=" + String(dev.initFailCount) + "\n";
     status += "io_failures=" + String(dev.ioFailCount) + "\n";
     status += "last_ok_ms=" + String(dev.lastOkMs) + "\n";
+    status += "update_max_us=" + String(dev.updateMaxUs) + "\n";
     status += "uptime_ms=" + String(millis() - dev.lastOkMs) + "\n";
+    for (int i = 0; i < MAX_SIGNAL_FILTERS; i++) {
+        const SignalFilterSlot& slot = filters[i];
+        if (slot.active && slot.deviceId == dev.deviceId) {
+            status += "filter." + String(slot.signal) + "=" + String(slot.spec);
+            status += " in=" + String(slot.samplesIn) + " out=" + String(slot.samplesOut);
+            if (slot.record) {
+                status += " series=" + String(slot.series);
+            }
+            status += "\n";
+        }
+    }
+    const IrqLine* line = InterruptManager::getLine(dev.irqLine);
+    if (line) {
+        status += "irq=" + String(line->pin) + ":" + InterruptManager::edgeToString(line->edge);
+        status += " line=" + String(dev.irqLine) + " fired=" + String(line->fired);
+        status += " dropped=" + String(line->dropped) + "\n";
+    }
     
     return status;
 }
 
+int DeviceRegistry::findClockDevice() {
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        uint32_t seconds;
+        if (devices[i].active && devices[i].driver && devices[i].state == DeviceState::READY &&
+            devices[i].driver->readClock(seconds)) {
+            return devices[i].deviceId;
+        }
+    }
+    return -1;
+}
+
+bool DeviceRegistry::readDeviceClock(int deviceId, uint32_t& unixSeconds) {
+    int idx = findDevice(deviceId);
+    if (idx < 0 || !devices[idx].driver || devices[idx].state != DeviceState::READY) {
+        return false;
+    }
+    return devices[idx].driver->readClock(unixSeconds);
+}
+
+bool DeviceRegistry::writeDeviceClock(int deviceId, uint32_t unixSeconds) {
+    int idx = findDevice(deviceId);
+    if (idx < 0 || !devices[idx].driver || devices[idx].state != DeviceState::READY) {
+        return false;
+    }
+    return devices[idx].driver->writeClock(unixSeconds);
+}
+
+bool DeviceRegistry::enableDevicePulse(int deviceId) {
+    int idx = findDevice(deviceId);
+    if (idx < 0 || !devices[idx].driver || devices[idx].state != DeviceState::READY) {
+        return false;
+    }
+    return devices[idx].driver->enableSecondPulse();
+}
+
 String DeviceRegistry::exportConfig() {
     String config = "";
     
@@ -255,6 +646,25 @@ String DeviceRegistry::exportConfig() {
             if (devices[i].state == DeviceState::DISABLED) {
                 config += "# dev.disable " + String(devices[i].deviceId) + "\n";
             }
+            
+            // Signal filters travel with the binding
+            for (int f = 0; f < MAX_SIGNAL_FILTERS; f++) {
+                if (!filters[f].active || filters[f].deviceId != devices[i].deviceId) {
+                    continue;
+                }
+                String prefix = "param set " + String(devices[i].deviceId) + " ";
+                if (strcmp(filters[f].spec, "none") != 0) {
+                    config += prefix + "filter." + String(filters[f].signal) + " " + String(filters[f].spec) + "\n";
+                }
+                if (filters[f].record) {
+                    config += prefix + "record." + String(filters[f].signal) + " on\n";
+                }
+            }
+            const IrqLine* line = InterruptManager::getLine(devices[i].irqLine);
+            if (line) {
+                config += "param set " + String(devices[i].deviceId) + " irq " + String(line->pin) + ":" +
+                          InterruptManager::edgeToString(line->edge) + "\n";
+            }
         }
     }
     
@@ -291,11 +701,11 @@ String DeviceRegistry::getDeviceRegisters(int deviceId) {
     
     // Legacy: Check if this is a BME280 driver (for backward compatibility)
     if (dev.driverId == "bme280") {
-        BME280Driver* bme = static_cast<BME280Driver*>(dev.driver);
+        I2CDriverAdapter<BME280Driver>* bme = static_cast<I2CDriverAdapter<BME280Driver>*>(dev.driver);
         if (bme) {
 #if POCKETOS_BME280_ENABLE_REGISTER_ACCESS
             size_t count;
-            const RegisterDesc* regs = bme->registers(count);
+            const RegisterDesc* regs = bme->getDriver().registers(count);
             
             String result = "";
             for (size_t i = 0; i < count; i++) {
@@ -329,10 +739,10 @@ bool DeviceRegistry::deviceRegRead(int deviceId, uint16_t reg, uint8_t* buf, siz
     
     // Legacy: Check if this is a BME280 driver (for backward compatibility)
     if (dev.driverId == "bme280") {
-        BME280Driver* bme = static_cast<BME280Driver*>(dev.driver);
+        I2CDriverAdapter<BME280Driver>* bme = static_cast<I2CDriverAdapter<BME280Driver>*>(dev.driver);
         if (bme) {
 #if POCKETOS_BME280_ENABLE_REGISTER_ACCESS
-            return bme->regRead(reg, buf, len);
+            return bme->getDriver().regRead(reg, buf, len);
 #endif
         }
     }
@@ -356,10 +766,10 @@ bool DeviceRegistry::deviceRegWrite(int deviceId, uint16_t reg, const uint8_t* b
     
     // Legacy: Check if this is a BME280 driver (for backward compatibility)
     if (dev.driverId == "bme280") {
-        BME280Driver* bme = static_cast<BME280Driver*>(dev.driver);
+        I2CDriverAdapter<BME280Driver>* bme = static_cast<I2CDriverAdapter<BME280Driver>*>(dev.driver);
         if (bme) {
 #if POCKETOS_BME280_ENABLE_REGISTER_ACCESS
-            return bme->regWrite(reg, buf, len);
+            return bme->getDriver().regWrite(reg, buf, len);
 #endif
         }
     }
@@ -3,10 +3,18 @@
 
 #include <Arduino.h>
 #include "capability_schema.h"
+#include "signal_filter.h"
+#include "timeseries_store.h"
+#include "interrupt_manager.h"
 
 namespace PocketOS {
 
 #define MAX_DEVICES 16
+#ifndef MAX_SIGNAL_FILTERS
+#define MAX_SIGNAL_FILTERS 16   // Filter slots shared by all devices
+#endif
+#define SIGNAL_NAME_MAX 16
+#define SIGNAL_SPEC_MAX 40
 
 enum class DeviceState {
     READY,
@@ -27,6 +35,22 @@ public:
     virtual String getParam(const String& name) = 0;
     virtual CapabilitySchema getSchema() = 0;
     virtual void update() = 0;
+    
+    // Signals: incremented on every new valid sample (0 = no samples)
+    virtual uint32_t sampleSequence() const { return 0; }
+    // Numeric field of the last sample; false if the driver has no such signal
+    virtual bool readSignal(const char* name, float& value) { return false; }
+    
+    // Wall clock (RTC drivers), Unix seconds; false if the driver has none
+    virtual bool readClock(uint32_t& unixSeconds) { return false; }
+    virtual bool writeClock(uint32_t unixSeconds) { return false; }
+    // Start the RTC's 1 Hz output for SystemClock's pulse input
+    virtual bool enableSecondPulse() { return false; }
+    
+    // Interrupt line (param irq): the pin now attached, -1 when detached;
+    // then each edge, delivered from the main loop (InterruptManager)
+    virtual void setInterruptPin(int pin) {}
+    virtual void onInterrupt(uint32_t timestampUs) {}
 };
 
 // Interface for drivers that support register access (Tier 2)
@@ -51,10 +75,38 @@ struct Device {
     int initFailCount;
     int ioFailCount;
     unsigned long lastOkMs;
+    uint32_t updateMaxUs;   // Longest update() call
+    uint32_t sampleSeq;     // Last driver sample run through the filters
+    int irqLine;            // InterruptManager line, -1 = polled only
     
     Device() : active(false), deviceId(-1), endpoint(""), driverId(""), 
                state(DeviceState::DISABLED), driver(nullptr),
-               initFailCount(0), ioFailCount(0), lastOkMs(0) {}
+               initFailCount(0), ioFailCount(0), lastOkMs(0), updateMaxUs(0),
+               sampleSeq(0), irqLine(-1) {}
+};
+
+// Filter and recording attached to one signal of one device
+// (params filter.<signal> and record.<signal>)
+struct SignalFilterSlot {
+    bool active;
+    int deviceId;
+    char signal[SIGNAL_NAME_MAX];
+    char spec[SIGNAL_SPEC_MAX];     // "none" when only recorded
+    SignalFilter filter;
+    bool record;                    // Append outputs to the time-series store
+    char series[TS_SERIES_NAME_MAX];
+    float value;            // Last filter output
+    bool hasValue;
+    bool pending;           // Output not yet reported
+    uint32_t samplesIn;
+    uint32_t samplesOut;
+    
+    SignalFilterSlot() : active(false), deviceId(-1), record(false), value(0), hasValue(false),
+                         pending(false), samplesIn(0), samplesOut(0) {
+        signal[0] = '\0';
+        spec[0] = '\0';
+        series[0] = '\0';
+    }
 };
 
 class DeviceRegistry {
@@ -70,12 +122,20 @@ public:
     // Device queries
     static String listDevices();
     static bool deviceExists(int deviceId);
+    static int findDeviceByEndpoint(const String& endpoint);  // Device ID or -1
     static DeviceState getDeviceState(int deviceId);
+    static String getDeviceEndpoint(int deviceId);  // "" if not bound
+    static IDriver* getDriver(int deviceId);        // nullptr if not bound
     
     // Device parameters
     static bool setDeviceParam(int deviceId, const String& paramName, const String& value);
     static String getDeviceParam(int deviceId, const String& paramName);
     
+    // Filtered signals: "dev<id>.<signal>=<value>" lines. With changedOnly,
+    // only outputs produced since the last report (deadband/decimate
+    // suppressed samples produce none); deviceId -1 = all devices
+    static String getSignalReport(int deviceId, bool changedOnly);
+    
     // Schema query
     static String getDeviceSchema(int deviceId);
     
@@ -88,24 +148,48 @@ public:
     static bool deviceRegWrite(int deviceId, uint16_t reg, const uint8_t* buf, size_t len);
     static bool deviceSupportsRegisters(int deviceId);
     
+    // RTC devices (SystemClock source)
+    static int findClockDevice();   // First ready device with a clock, or -1
+    static bool readDeviceClock(int deviceId, uint32_t& unixSeconds);
+    static bool writeDeviceClock(int deviceId, uint32_t unixSeconds);
+    static bool enableDevicePulse(int deviceId);
+    
     // Config export
     static String exportConfig();
     
     // Update all devices
     static void updateAll();
     
+    // Time spent in updateAll() per main loop pass (µs): last, average
+    // (1/16 EMA) and maximum since boot
+    static void getUpdateStats(uint32_t& lastUs, uint32_t& avgUs, uint32_t& maxUs);
+    
     // Device count
     static int getDeviceCount() { return deviceCount; }
     
 private:
     static Device devices[MAX_DEVICES];
+    static SignalFilterSlot filters[MAX_SIGNAL_FILTERS];
     static int deviceCount;
     static int nextDeviceId;
+    static uint32_t updateLastUs;
+    static uint32_t updateAvgUs;
+    static uint32_t updateMaxUs;
     
     static int findDevice(int deviceId);
     static int findFreeSlot();
     static IDriver* createDriver(const String& driverId, const String& endpoint);
     static const char* deviceStateToString(DeviceState state);
+    static int findFilter(int deviceId, const String& signal);
+    static int acquireFilter(Device& dev, const String& signal);
+    static bool setSignalFilter(Device& dev, const String& signal, const String& spec);
+    static bool setSignalRecord(Device& dev, const String& signal, const String& value);
+    static void releaseFilters(int deviceId);
+    static void runFilters(Device& dev);
+    static bool setDeviceIrq(Device& dev, const String& value);
+    static bool attachIrq(Device& dev, int pin, IrqEdge edge);
+    static void releaseIrq(Device& dev);
+    static void onDeviceInterrupt(void* context, const IrqEvent& event);
 };
 
 } // namespace PocketOS
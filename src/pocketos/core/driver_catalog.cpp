@@ -0,0 +1,298 @@
+#include "driver_catalog.h"
+#include "../drivers/i2c_driver_adapter.h"
+#include "../drivers/spi_driver_adapter.h"
+#include "../drivers/aht10_driver.h"
+#include "../drivers/aht20_driver.h"
+#include "../drivers/am2315_driver.h"
+#include "../drivers/apds9960_driver.h"
+#include "../drivers/as5600_driver.h"
+#include "../drivers/as6212_driver.h"
+#include "../drivers/as7262_driver.h"
+#include "../drivers/as7263_driver.h"
+#include "../drivers/as7341_driver.h"
+#include "../drivers/at24cxx_driver.h"
+#include "../drivers/aw9523_driver.h"
+#include "../drivers/bh1750_driver.h"
+#include "../drivers/bme280_driver.h"
+#include "../drivers/bme680_driver.h"
+#include "../drivers/bme688_driver.h"
+#include "../drivers/bmp085_driver.h"
+#include "../drivers/bmp180_driver.h"
+#include "../drivers/bmp280_driver.h"
+#include "../drivers/bmp388_driver.h"
+#include "../drivers/bno055_driver.h"
+#include "../drivers/ccs811_driver.h"
+#include "../drivers/dps310_driver.h"
+#include "../drivers/drv2605_driver.h"
+#include "../drivers/ds1307_driver.h"
+#include "../drivers/ds3231_driver.h"
+#include "../drivers/ens160_driver.h"
+#include "../drivers/fdc1004_driver.h"
+#include "../drivers/ft6206_driver.h"
+#include "../drivers/fxas21002c_driver.h"
+#include "../drivers/fxos8700cq_driver.h"
+#include "../drivers/hmc5883l_driver.h"
+#include "../drivers/ht16k33_driver.h"
+#include "../drivers/icm20948_driver.h"
+#include "../drivers/ina219_driver.h"
+#include "../drivers/ina226_driver.h"
+#include "../drivers/ina228_driver.h"
+#include "../drivers/ina260_driver.h"
+#include "../drivers/ina3221_driver.h"
+#include "../drivers/is31fl3731_driver.h"
+#include "../drivers/ism330dhcx_driver.h"
+#include "../drivers/lc709203f_driver.h"
+#include "../drivers/lis2dh12_driver.h"
+#include "../drivers/lis3mdl_driver.h"
+#include "../drivers/lps22hb_driver.h"
+#include "../drivers/lps25h_driver.h"
+#include "../drivers/lsm303agr_driver.h"
+#include "../drivers/lsm6ds33_driver.h"
+#include "../drivers/lsm6dsox_driver.h"
+#include "../drivers/lsm9ds1_driver.h"
+#include "../drivers/mag3110_driver.h"
+#include "../drivers/max30101_driver.h"
+#include "../drivers/mcp23008_driver.h"
+#include "../drivers/mcp23017_driver.h"
+#include "../drivers/mcp2515_driver.h"
+#include "../drivers/mcp3421_driver.h"
+#include "../drivers/mcp4725_driver.h"
+#include "../drivers/mcp4728_driver.h"
+#include "../drivers/mcp79410_driver.h"
+#include "../drivers/mcp9808_driver.h"
+#include "../drivers/mlx90614_driver.h"
+#include "../drivers/mlx90640_driver.h"
+#include "../drivers/mpr121_driver.h"
+#include "../drivers/ms5611_driver.h"
+#include "../drivers/ms8607_driver.h"
+#include "../drivers/nau7802_driver.h"
+#include "../drivers/nrf24l01_driver.h"
+#include "../drivers/pca9536_driver.h"
+#include "../drivers/pca9555_driver.h"
+#include "../drivers/pca9685_driver.h"
+#include "../drivers/pcal6416a_driver.h"
+#include "../drivers/pcf2129_driver.h"
+#include "../drivers/pcf8523_driver.h"
+#include "../drivers/pcf8574_driver.h"
+#include "../drivers/pcf8575_driver.h"
+#include "../drivers/pn532_driver.h"
+#include "../drivers/qmc5883l_driver.h"
+#include "../drivers/rv3028_driver.h"
+#include "../drivers/sc16is750_driver.h"
+#include "../drivers/scd30_driver.h"
+#include "../drivers/scd40_driver.h"
+#include "../drivers/scd41_driver.h"
+#include "../drivers/sgp30_driver.h"
+#include "../drivers/sgp40_driver.h"
+#include "../drivers/sht31_driver.h"
+#include "../drivers/sht35_driver.h"
+#include "../drivers/sht40_driver.h"
+#include "../drivers/sht45_driver.h"
+#include "../drivers/shtc3_driver.h"
+#include "../drivers/si1145_driver.h"
+#include "../drivers/si7021_driver.h"
+#include "../drivers/ssd1306_driver.h"
+#include "../drivers/ssd1309_driver.h"
+#include "../drivers/st25dvxx_driver.h"
+#include "../drivers/stts751_driver.h"
+#include "../drivers/sx127x_driver.h"
+#include "../drivers/tca9546a_driver.h"
+#include "../drivers/tca9548a_driver.h"
+#include "../drivers/tcs34725_driver.h"
+#include "../drivers/tmp102_driver.h"
+#include "../drivers/tmp117_driver.h"
+#include "../drivers/tsl2561_driver.h"
+#include "../drivers/tsl2591_driver.h"
+#include "../drivers/vcnl4010_driver.h"
+#include "../drivers/vcnl4040_driver.h"
+#include "../drivers/veml6070_driver.h"
+#include "../drivers/veml6075_driver.h"
+#include "../drivers/veml7700_driver.h"
+#include "../drivers/vl53l0x_driver.h"
+#include "../drivers/vl53l1x_driver.h"
+#include "../drivers/vl53l4cd_driver.h"
+#include "../drivers/vl53l5cx_driver.h"
+#include "../drivers/vl6180x_driver.h"
+#include "../drivers/wm8960_driver.h"
+
+namespace PocketOS {
+
+// Default poll intervals (ms) by sensor class
+#define POLL_NONE         0      // Actuators, expanders, RTCs, memories
+#define POLL_FRAME        10     // Frame sensors (thermal array, multizone ToF)
+#define POLL_MOTION       20     // IMUs, magnetometers, touch, pulse
+#define POLL_RANGE        100    // Time-of-flight, proximity, load cells
+#define POLL_POWER        250    // Current/voltage monitors, ADCs
+#define POLL_LIGHT        500    // Light, color, spectral
+#define POLL_ENVIRONMENT  1000   // Temperature, humidity, pressure, VOC
+#define POLL_SLOW         5000   // CO2 and gas-heater sensors
+
+template <typename TDriver>
+static IDriver* createAdapter(uint8_t address, uint32_t pollMs) {
+    return new I2CDriverAdapter<TDriver>(address, pollMs);
+}
+
+#define I2C_FACTORY(CLASS) &createAdapter<CLASS>
+
+static const DriverCatalogEntry DRIVER_CATALOG[] = {
+    { "aht10",       I2C_FACTORY(AHT10Driver),       POLL_ENVIRONMENT },
+    { "aht20",       I2C_FACTORY(AHT20Driver),       POLL_ENVIRONMENT },
+    { "am2315",      I2C_FACTORY(AM2315Driver),      POLL_SLOW },
+    { "apds9960",    I2C_FACTORY(APDS9960Driver),    POLL_NONE },
+    { "as5600",      I2C_FACTORY(AS5600Driver),      POLL_MOTION },
+    { "as6212",      I2C_FACTORY(AS6212Driver),      POLL_ENVIRONMENT },
+    { "as7262",      I2C_FACTORY(AS7262Driver),      POLL_LIGHT },
+    { "as7263",      I2C_FACTORY(AS7263Driver),      POLL_LIGHT },
+    { "as7341",      I2C_FACTORY(AS7341Driver),      POLL_LIGHT },
+    { "at24cxx",     I2C_FACTORY(AT24CxxDriver),     POLL_NONE },
+    { "aw9523",      I2C_FACTORY(AW9523Driver),      POLL_NONE },
+    { "bh1750",      I2C_FACTORY(BH1750Driver),      POLL_LIGHT },
+    { "bme280",      I2C_FACTORY(BME280Driver),      POLL_ENVIRONMENT },
+    { "bme680",      I2C_FACTORY(BME680Driver),      POLL_SLOW },
+    { "bme688",      I2C_FACTORY(BME688Driver),      POLL_SLOW },
+    { "bmp085",      I2C_FACTORY(BMP085Driver),      POLL_ENVIRONMENT },
+    { "bmp180",      I2C_FACTORY(BMP180Driver),      POLL_ENVIRONMENT },
+    { "bmp280",      I2C_FACTORY(BMP280Driver),      POLL_ENVIRONMENT },
+    { "bmp388",      I2C_FACTORY(BMP388Driver),      POLL_ENVIRONMENT },
+    { "bno055",      I2C_FACTORY(BNO055Driver),      POLL_MOTION },
+    { "ccs811",      I2C_FACTORY(CCS811Driver),      POLL_ENVIRONMENT },
+    { "dps310",      I2C_FACTORY(DPS310Driver),      POLL_ENVIRONMENT },
+    { "drv2605",     I2C_FACTORY(DRV2605Driver),     POLL_NONE },
+    { "ds1307",      I2C_FACTORY(DS1307Driver),      POLL_NONE },
+    { "ds3231",      I2C_FACTORY(DS3231Driver),      POLL_NONE },
+    { "ens160",      I2C_FACTORY(ENS160Driver),      POLL_ENVIRONMENT },
+    { "fdc1004",     I2C_FACTORY(FDC1004Driver),     POLL_POWER },
+    { "ft6206",      I2C_FACTORY(FT6206Driver),      POLL_MOTION },
+    { "fxas21002c",  I2C_FACTORY(FXAS21002CDriver),  POLL_MOTION },
+    { "fxos8700cq",  I2C_FACTORY(FXOS8700CQDriver),  POLL_MOTION },
+    { "hmc5883l",    I2C_FACTORY(HMC5883LDriver),    POLL_MOTION },
+    { "ht16k33",     I2C_FACTORY(HT16K33Driver),     POLL_NONE },
+    { "icm20948",    I2C_FACTORY(ICM20948Driver),    POLL_MOTION },
+    { "ina219",      I2C_FACTORY(INA219Driver),      POLL_POWER },
+    { "ina226",      I2C_FACTORY(INA226Driver),      POLL_POWER },
+    { "ina228",      I2C_FACTORY(INA228Driver),      POLL_POWER },
+    { "ina260",      I2C_FACTORY(INA260Driver),      POLL_POWER },
+    { "ina3221",     I2C_FACTORY(INA3221Driver),     POLL_POWER },
+    { "is31fl3731",  I2C_FACTORY(IS31FL3731Driver),  POLL_NONE },
+    { "ism330dhcx",  I2C_FACTORY(ISM330DHCXDriver),  POLL_MOTION },
+    { "lc709203f",   I2C_FACTORY(LC709203FDriver),   POLL_ENVIRONMENT },
+    { "lis2dh12",    I2C_FACTORY(LIS2DH12Driver),    POLL_MOTION },
+    { "lis3mdl",     I2C_FACTORY(LIS3MDLDriver),     POLL_MOTION },
+    { "lps22hb",     I2C_FACTORY(LPS22HBDriver),     POLL_ENVIRONMENT },
+    { "lps25h",      I2C_FACTORY(LPS25HDriver),      POLL_ENVIRONMENT },
+    { "lsm303agr",   I2C_FACTORY(LSM303AGRDriver),   POLL_MOTION },
+    { "lsm6ds33",    I2C_FACTORY(LSM6DS33Driver),    POLL_MOTION },
+    { "lsm6dsox",    I2C_FACTORY(LSM6DSOXDriver),    POLL_MOTION },
+    { "lsm9ds1",     I2C_FACTORY(LSM9DS1Driver),     POLL_MOTION },
+    { "mag3110",     I2C_FACTORY(MAG3110Driver),     POLL_MOTION },
+    { "max30101",    I2C_FACTORY(MAX30101Driver),    POLL_MOTION },
+    { "mcp23008",    I2C_FACTORY(MCP23008Driver),    POLL_NONE },
+    { "mcp23017",    I2C_FACTORY(MCP23017Driver),    POLL_NONE },
+    { "mcp3421",     I2C_FACTORY(MCP3421Driver),     POLL_POWER },
+    { "mcp4725",     I2C_FACTORY(MCP4725Driver),     POLL_NONE },
+    { "mcp4728",     I2C_FACTORY(MCP4728Driver),     POLL_NONE },
+    { "mcp79410",    I2C_FACTORY(MCP79410Driver),    POLL_NONE },
+    { "mcp9808",     I2C_FACTORY(MCP9808Driver),     POLL_ENVIRONMENT },
+    { "mlx90614",    I2C_FACTORY(MLX90614Driver),    POLL_ENVIRONMENT },
+    { "mlx90640",    I2C_FACTORY(MLX90640Driver),    POLL_FRAME },
+    { "mpr121",      I2C_FACTORY(MPR121Driver),      POLL_MOTION },
+    { "ms5611",      I2C_FACTORY(MS5611Driver),      POLL_ENVIRONMENT },
+    { "ms8607",      I2C_FACTORY(MS8607Driver),      POLL_ENVIRONMENT },
+    { "nau7802",     I2C_FACTORY(NAU7802Driver),     POLL_RANGE },
+    { "pca9536",     I2C_FACTORY(PCA9536Driver),     POLL_NONE },
+    { "pca9555",     I2C_FACTORY(PCA9555Driver),     POLL_NONE },
+    { "pca9685",     I2C_FACTORY(PCA9685Driver),     POLL_NONE },
+    { "pcal6416a",   I2C_FACTORY(PCAL6416ADriver),   POLL_NONE },
+    { "pcf2129",     I2C_FACTORY(PCF2129Driver),     POLL_NONE },
+    { "pcf8523",     I2C_FACTORY(PCF8523Driver),     POLL_NONE },
+    { "pcf8574",     I2C_FACTORY(PCF8574Driver),     POLL_NONE },
+    { "pcf8575",     I2C_FACTORY(PCF8575Driver),     POLL_NONE },
+    { "pn532",       I2C_FACTORY(PN532Driver),       POLL_NONE },
+    { "qmc5883l",    I2C_FACTORY(QMC5883LDriver),    POLL_MOTION },
+    { "rv3028",      I2C_FACTORY(RV3028Driver),      POLL_NONE },
+    { "sc16is750",   I2C_FACTORY(SC16IS750Driver),   POLL_NONE },
+    { "scd30",       I2C_FACTORY(SCD30Driver),       POLL_SLOW },
+    { "scd40",       I2C_FACTORY(SCD40Driver),       POLL_SLOW },
+    { "scd41",       I2C_FACTORY(SCD41Driver),       POLL_SLOW },
+    { "sgp30",       I2C_FACTORY(SGP30Driver),       POLL_ENVIRONMENT },
+    { "sgp40",       I2C_FACTORY(SGP40Driver),       POLL_ENVIRONMENT },
+    { "sht31",       I2C_FACTORY(SHT31Driver),       POLL_ENVIRONMENT },
+    { "sht35",       I2C_FACTORY(SHT35Driver),       POLL_ENVIRONMENT },
+    { "sht40",       I2C_FACTORY(SHT40Driver),       POLL_ENVIRONMENT },
+    { "sht45",       I2C_FACTORY(SHT45Driver),       POLL_ENVIRONMENT },
+    { "shtc3",       I2C_FACTORY(SHTC3Driver),       POLL_ENVIRONMENT },
+    { "si1145",      I2C_FACTORY(SI1145Driver),      POLL_LIGHT },
+    { "si7021",      I2C_FACTORY(SI7021Driver),      POLL_ENVIRONMENT },
+    { "ssd1306",     I2C_FACTORY(SSD1306Driver),     POLL_NONE },
+    { "ssd1309",     I2C_FACTORY(SSD1309Driver),     POLL_NONE },
+    { "st25dvxx",    I2C_FACTORY(ST25DVxxDriver),    POLL_NONE },
+    { "stts751",     I2C_FACTORY(STTS751Driver),     POLL_ENVIRONMENT },
+    { "tca9546a",    I2C_FACTORY(TCA9546ADriver),    POLL_NONE },
+    { "tca9548a",    I2C_FACTORY(TCA9548ADriver),    POLL_NONE },
+    { "tcs34725",    I2C_FACTORY(TCS34725Driver),    POLL_LIGHT },
+    { "tmp102",      I2C_FACTORY(TMP102Driver),      POLL_ENVIRONMENT },
+    { "tmp117",      I2C_FACTORY(TMP117Driver),      POLL_ENVIRONMENT },
+    { "tsl2561",     I2C_FACTORY(TSL2561Driver),     POLL_LIGHT },
+    { "tsl2591",     I2C_FACTORY(TSL2591Driver),     POLL_LIGHT },
+    { "vcnl4010",    I2C_FACTORY(VCNL4010Driver),    POLL_RANGE },
+    { "vcnl4040",    I2C_FACTORY(VCNL4040Driver),    POLL_RANGE },
+    { "veml6070",    I2C_FACTORY(VEML6070Driver),    POLL_LIGHT },
+    { "veml6075",    I2C_FACTORY(VEML6075Driver),    POLL_LIGHT },
+    { "veml7700",    I2C_FACTORY(VEML7700Driver),    POLL_LIGHT },
+    { "vl53l0x",     I2C_FACTORY(VL53L0XDriver),     POLL_RANGE },
+    { "vl53l1x",     I2C_FACTORY(VL53L1XDriver),     POLL_RANGE },
+    { "vl53l4cd",    I2C_FACTORY(VL53L4CDDriver),    POLL_RANGE },
+    { "vl53l5cx",    I2C_FACTORY(VL53L5CXDriver),    POLL_FRAME },
+    { "vl6180x",     I2C_FACTORY(VL6180XDriver),     POLL_RANGE },
+    { "wm8960",      I2C_FACTORY(WM8960Driver),      POLL_NONE },
+};
+
+#define DRIVER_CATALOG_COUNT (sizeof(DRIVER_CATALOG) / sizeof(DRIVER_CATALOG[0]))
+
+template <typename TDriver>
+static IDriver* createSPIAdapter(const String& endpoint) {
+    return new SPIDriverAdapter<TDriver>(endpoint);
+}
+
+#define SPI_FACTORY(CLASS) &createSPIAdapter<CLASS>
+
+static const SPIDriverCatalogEntry SPI_DRIVER_CATALOG[] = {
+    { "mcp2515",     SPI_FACTORY(MCP2515Driver) },
+    { "nrf24l01",    SPI_FACTORY(NRF24L01Driver) },
+    { "sx127x",      SPI_FACTORY(SX127xDriver) },
+};
+
+#define SPI_DRIVER_CATALOG_COUNT (sizeof(SPI_DRIVER_CATALOG) / sizeof(SPI_DRIVER_CATALOG[0]))
+
+const DriverCatalogEntry* DriverCatalog::entries(size_t& count) {
+    count = DRIVER_CATALOG_COUNT;
+    return DRIVER_CATALOG;
+}
+
+const DriverCatalogEntry* DriverCatalog::find(const String& driverId) {
+    for (size_t i = 0; i < DRIVER_CATALOG_COUNT; i++) {
+        if (driverId == DRIVER_CATALOG[i].driverId) {
+            return &DRIVER_CATALOG[i];
+        }
+    }
+    return nullptr;
+}
+
+IDriver* DriverCatalog::createI2C(const String& driverId, uint8_t address) {
+    const DriverCatalogEntry* entry = find(driverId);
+    if (!entry) {
+        return nullptr;
+    }
+    return entry->create(address, entry->defaultPollMs);
+}
+
+IDriver* DriverCatalog::createSPI(const String& driverId, const String& endpoint) {
+    for (size_t i = 0; i < SPI_DRIVER_CATALOG_COUNT; i++) {
+        if (driverId == SPI_DRIVER_CATALOG[i].driverId) {
+            return SPI_DRIVER_CATALOG[i].create(endpoint);
+        }
+    }
+    return nullptr;
+}
+
+} // namespace PocketOS
@@ -0,0 +1,48 @@
+#ifndef POCKETOS_DRIVER_CATALOG_H
+#define POCKETOS_DRIVER_CATALOG_H
+
+#include <Arduino.h>
+#include "device_registry.h"
+
+namespace PocketOS {
+
+/**
+ * Driver Catalog
+ *
+ * Maps driver IDs (as reported by DeviceIdentifier) to a factory for the
+ * I2C driver and the default poll interval used when it is bound.
+ */
+
+typedef IDriver* (*I2CDriverFactory)(uint8_t address, uint32_t pollMs);
+typedef IDriver* (*SPIDriverFactory)(const String& endpoint);
+
+struct DriverCatalogEntry {
+    const char* driverId;        // e.g., "bme280"
+    I2CDriverFactory create;     // Builds an IDriver for an I2C address
+    uint32_t defaultPollMs;      // 0 = not polled
+};
+
+// SPI drivers bound to "spi<bus>:cs=<pin>[,irq=<pin>...]" endpoints
+struct SPIDriverCatalogEntry {
+    const char* driverId;
+    SPIDriverFactory create;
+};
+
+class DriverCatalog {
+public:
+    // All entries
+    static const DriverCatalogEntry* entries(size_t& count);
+
+    // Find entry by driver ID (nullptr if unknown)
+    static const DriverCatalogEntry* find(const String& driverId);
+
+    // Create an I2C driver with its default poll interval (nullptr if unknown)
+    static IDriver* createI2C(const String& driverId, uint8_t address);
+
+    // Create an SPI driver for an endpoint (nullptr if unknown)
+    static IDriver* createSPI(const String& driverId, const String& endpoint);
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_DRIVER_CATALOG_H
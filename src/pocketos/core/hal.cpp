@@ -8,6 +8,7 @@
 namespace PocketOS {
 
 bool HAL::initialized = false;
+uint8_t HAL::i2cStarted = 0;
 
 void HAL::init() {
     if (!initialized) {
@@ -263,6 +264,7 @@ bool HAL::i2cInit(int busNum, int sda, int scl, uint32_t speedHz) {
         if (scl < 0) scl = 22;
         Wire.begin(sda, scl, speedHz);
         Logger::info("I2C initialized: SDA=" + String(sda) + ", SCL=" + String(scl) + ", Speed=" + String(speedHz) + "Hz");
+        i2cStarted |= 1 << busNum;
         return true;
     }
     #elif defined(ESP8266)
@@ -271,6 +273,7 @@ bool HAL::i2cInit(int busNum, int sda, int scl, uint32_t speedHz) {
     Wire.begin(sda, scl);
     Wire.setClock(speedHz);
     Logger::info("I2C initialized: SDA=" + String(sda) + ", SCL=" + String(scl) + ", Speed=" + String(speedHz) + "Hz");
+    i2cStarted |= 1 << busNum;
     return true;
     #endif
     #endif
@@ -324,4 +327,8 @@ bool HAL::i2cScan(int busNum, uint8_t* addresses, int* count, int maxCount) {
     #endif
 }
 
+bool HAL::i2cReady(int busNum) {
+    return busNum >= 0 && busNum < 8 && (i2cStarted & (1 << busNum)) != 0;
+}
+
 } // namespace PocketOS
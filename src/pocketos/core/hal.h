@@ -53,9 +53,11 @@ public:
     static bool i2cWrite(int busNum, uint8_t address, uint8_t* data, size_t len);
     static bool i2cRead(int busNum, uint8_t address, uint8_t* data, size_t len);
     static bool i2cScan(int busNum, uint8_t* addresses, int* count, int maxCount = 128);
+    static bool i2cReady(int busNum);  // True once i2cInit() has started the bus
     
 private:
     static bool initialized;
+    static uint8_t i2cStarted;  // Bit n set = bus n started
 };
 
 } // namespace PocketOS
@@ -6,7 +6,15 @@
 #include "device_registry.h"
 #include "persistence.h"
 #include "device_identifier.h"
+#include "auto_binder.h"
+#include "timeseries_store.h"
+#include "system_clock.h"
+#include "interrupt_manager.h"
 #include "../drivers/bme280_driver.h"
+#include "../drivers/mcp2515_driver.h"
+#include "../drivers/nrf24l01_driver.h"
+#include "../drivers/sx127x_driver.h"
+#include "../drivers/spi_driver_adapter.h"
 
 namespace PocketOS {
 
@@ -32,6 +40,8 @@ IntentResponse IntentAPI::dispatch(const IntentRequest& request) {
         return handleDevList(request);
     } else if (request.intent == "dev.bind") {
         return handleDevBind(request);
+    } else if (request.intent == "dev.autobind") {
+        return handleDevAutobind(request);
     } else if (request.intent == "dev.unbind") {
         return handleDevUnbind(request);
     } else if (request.intent == "dev.enable") {
@@ -40,6 +50,40 @@ IntentResponse IntentAPI::dispatch(const IntentRequest& request) {
         return handleDevDisable(request);
     } else if (request.intent == "dev.status") {
         return handleDevStatus(request);
+    } else if (request.intent == "dev.signals") {
+        return handleDevSignals(request);
+    } else if (request.intent == "ts.query") {
+        return handleTsQuery(request);
+    } else if (request.intent == "ts.list") {
+        return handleTsList(request);
+    } else if (request.intent == "ts.flush") {
+        return handleTsFlush(request);
+    } else if (request.intent == "clock.status") {
+        return handleClockStatus(request);
+    } else if (request.intent == "clock.set") {
+        return handleClockSet(request);
+    } else if (request.intent == "clock.source") {
+        return handleClockSource(request);
+    } else if (request.intent == "clock.pulse") {
+        return handleClockPulse(request);
+    } else if (request.intent == "clock.sync") {
+        return handleClockSync(request);
+    } else if (request.intent == "irq.list") {
+        return handleIrqList(request);
+    } else if (request.intent == "can.dump") {
+        return handleCanDump(request);
+    } else if (request.intent == "lora.send") {
+        return handleLoraSend(request);
+    } else if (request.intent == "lora.recv") {
+        return handleLoraRecv(request);
+    } else if (request.intent == "nrf.send") {
+        return handleNrfSend(request);
+    } else if (request.intent == "nrf.ack") {
+        return handleNrfAck(request);
+    } else if (request.intent == "nrf.recv") {
+        return handleNrfRecv(request);
+    } else if (request.intent == "nrf.bench") {
+        return handleNrfBench(request);
     } else if (request.intent == "param.get") {
         return handleParamGet(request);
     } else if (request.intent == "param.set") {
@@ -93,6 +137,11 @@ IntentResponse IntentAPI::handleSysInfo(const IntentRequest& req) {
     resp.data += "flash_size=" + String(HAL::getFlashSize()) + "\n";
     resp.data += "heap_size=" + String(HAL::getHeapSize()) + "\n";
     resp.data += "free_heap=" + String(HAL::getFreeHeap()) + "\n";
+    
+    uint32_t lastUs, avgUs, maxUs;
+    DeviceRegistry::getUpdateStats(lastUs, avgUs, maxUs);
+    resp.data += "device_update_us=" + String(avgUs) + "\n";
+    resp.data += "device_update_max_us=" + String(maxUs) + "\n";
     return resp;
 }
 
@@ -147,6 +196,57 @@ IntentResponse IntentAPI::handleDevBind(const IntentRequest& req) {
     return IntentResponse(IntentError::ERR_CONFLICT, "Failed to bind device");
 }
 
+IntentResponse IntentAPI::handleDevAutobind(const IntentRequest& req) {
+    // Bus argument: "i2c0", "0", or omitted (defaults to i2c0)
+    int busNum = 0;
+    if (req.argCount >= 1) {
+        String bus = req.args[0];
+        if (bus.startsWith("i2c")) {
+            bus = bus.substring(3);
+        }
+        busNum = bus.toInt();
+    }
+    if (busNum < 0 || busNum >= HAL::getI2CCount()) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "I2C bus not found");
+    }
+    // HAL drives every bus number through Wire; a second bus would rescan
+    // bus 0 and bind its devices again under i2c1 endpoints
+    if (busNum != 0) {
+        return IntentResponse(IntentError::ERR_UNSUPPORTED, "Only i2c0 is supported");
+    }
+    if (!HAL::i2cReady(busNum)) {
+        return IntentResponse(IntentError::ERR_IO, "I2C bus not initialized");
+    }
+
+    AutoBindResult results[MAX_AUTOBIND_RESULTS];
+    int count = AutoBinder::bindBus(busNum, results, MAX_AUTOBIND_RESULTS);
+
+    int bound = 0;
+    String lines = "";
+    for (int i = 0; i < count; i++) {
+        const AutoBindResult& r = results[i];
+        if (r.status == AutoBindStatus::BOUND) {
+            bound++;
+        }
+        lines += "0x" + String(r.address, HEX) + " " + r.deviceClass + " " + r.confidence;
+        lines += " " + String(AutoBinder::statusToString(r.status));
+        if (r.deviceId >= 0) {
+            lines += " dev=" + String(r.deviceId);
+        }
+        if (r.status == AutoBindStatus::BOUND) {
+            lines += " poll_ms=" + String(r.pollMs);
+        }
+        lines += "\n";
+    }
+
+    IntentResponse resp;
+    resp.data = "bus=i2c" + String(busNum) + "\n";
+    resp.data += "devices=" + String(count) + "\n";
+    resp.data += "bound=" + String(bound) + "\n";
+    resp.data += lines;
+    return resp;
+}
+
 IntentResponse IntentAPI::handleDevUnbind(const IntentRequest& req) {
     if (req.argCount < 1) {
         return IntentResponse(IntentError::ERR_BAD_ARGS, "Usage: dev.unbind <device_id>");
@@ -270,6 +370,494 @@ IntentResponse IntentAPI::handleDevStatus(const IntentRequest& req) {
     return IntentResponse(IntentError::ERR_NOT_FOUND, "Device not found");
 }
 
+IntentResponse IntentAPI::handleDevSignals(const IntentRequest& req) {
+    // No device: signals that produced a new filtered value since the last
+    // report (telemetry polling); with a device: all of its current values
+    IntentResponse resp;
+    if (req.argCount < 1) {
+        resp.data = DeviceRegistry::getSignalReport(-1, true);
+        return resp;
+    }
+    
+    int deviceId = req.args[0].toInt();
+    if (!DeviceRegistry::deviceExists(deviceId)) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "Device not found");
+    }
+    resp.data = DeviceRegistry::getSignalReport(deviceId, false);
+    return resp;
+}
+
+// Time-series output: one "<seconds>.<ms> <value>" line per point/bucket
+#define TS_QUERY_MAX_LINES 200
+
+struct TsQueryOutput {
+    String* data;
+    uint32_t lines;
+};
+
+static void tsQueryLine(void* ctx, uint64_t t, float value) {
+    TsQueryOutput* out = static_cast<TsQueryOutput*>(ctx);
+    if (out->lines++ >= TS_QUERY_MAX_LINES) {
+        return;
+    }
+    char stamp[24];
+    snprintf(stamp, sizeof(stamp), "%lu.%03u ", (unsigned long)(t / 1000), (unsigned)(t % 1000));
+    *out->data += String(stamp) + String(value, 3) + "\n";
+}
+
+static void tsListLine(void* ctx, const char* text) {
+    *static_cast<String*>(ctx) += String(text) + "\n";
+}
+
+// Seconds of store time; 0 or negative = relative to now
+static uint64_t tsQueryTime(const String& arg) {
+    long seconds = arg.toInt();
+    uint64_t now = TimeSeriesStore::now();
+    if (seconds > 0) {
+        return (uint64_t)seconds * 1000;
+    }
+    uint64_t back = (uint64_t)(-(int64_t)seconds) * 1000;
+    return back < now ? now - back : 0;
+}
+
+IntentResponse IntentAPI::handleTsQuery(const IntentRequest& req) {
+    if (req.argCount < 4) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS,
+                              "Usage: ts.query <device_id> <signal> <from> <to> [agg[:bucket_s]]");
+    }
+    if (!TimeSeriesStore::isReady()) {
+        return IntentResponse(IntentError::ERR_UNSUPPORTED, "Time-series store not available");
+    }
+    
+    String endpoint = DeviceRegistry::getDeviceEndpoint(req.args[0].toInt());
+    char series[TS_SERIES_NAME_MAX];
+    if (endpoint.length() == 0 ||
+        !TimeSeriesStore::seriesName(endpoint.c_str(), req.args[1].c_str(), series, sizeof(series))) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "Device not found");
+    }
+    
+    TsQuery q;
+    q.fromMs = tsQueryTime(req.args[2]);
+    q.toMs = tsQueryTime(req.args[3]);
+    if (req.argCount > 4 && !TimeSeriesStore::parseAggregate(req.args[4].c_str(), q.agg, q.bucketMs)) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "agg: raw|avg|min|max|sum|count|last[:bucket_s]");
+    }
+    
+    IntentResponse resp;
+    TsQueryOutput out = { &resp.data, 0 };
+    int32_t points = TimeSeriesStore::query(series, q, tsQueryLine, &out);
+    if (points < 0) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "No stored series for this signal");
+    }
+    resp.data += "points=" + String(points) + "\n";
+    if (out.lines > TS_QUERY_MAX_LINES) {
+        resp.data += "truncated=" + String(out.lines - TS_QUERY_MAX_LINES) + "\n";
+    }
+    return resp;
+}
+
+IntentResponse IntentAPI::handleTsList(const IntentRequest& req) {
+    if (!TimeSeriesStore::isReady()) {
+        return IntentResponse(IntentError::ERR_UNSUPPORTED, "Time-series store not available");
+    }
+    
+    IntentResponse resp;
+    TimeSeriesStore::list(tsListLine, &resp.data);
+    const TsStats& stats = TimeSeriesStore::getStats();
+    resp.data += "samples=" + String(stats.samples) + "\n";
+    resp.data += "blocks_written=" + String(stats.blocksWritten) + "\n";
+    resp.data += "bytes_written=" + String(stats.bytesWritten) + "\n";
+    resp.data += "forced_writes=" + String(stats.forcedWrites) + "\n";
+    resp.data += "write_errors=" + String(stats.writeErrors) + "\n";
+    return resp;
+}
+
+IntentResponse IntentAPI::handleTsFlush(const IntentRequest& req) {
+    if (!TimeSeriesStore::isReady()) {
+        return IntentResponse(IntentError::ERR_UNSUPPORTED, "Time-series store not available");
+    }
+    TimeSeriesStore::flush(true);
+    return IntentResponse();
+}
+
+IntentResponse IntentAPI::handleClockStatus(const IntentRequest& req) {
+    IntentResponse resp;
+    resp.data = SystemClock::getStatus();
+    return resp;
+}
+
+// "YYYY-MM-DD HH:MM:SS" (UTC) or Unix seconds
+static bool parseClockTime(const String& text, uint32_t& seconds) {
+    if (text.length() >= 19 && text.charAt(4) == '-') {
+        CivilTime t;
+        t.year = (uint16_t)text.substring(0, 4).toInt();
+        t.month = (uint8_t)text.substring(5, 7).toInt();
+        t.day = (uint8_t)text.substring(8, 10).toInt();
+        t.hour = (uint8_t)text.substring(11, 13).toInt();
+        t.minute = (uint8_t)text.substring(14, 16).toInt();
+        t.second = (uint8_t)text.substring(17, 19).toInt();
+        t.weekday = 0;
+        if (t.year < 2000 || t.year > 2099 || t.month < 1 || t.month > 12 || t.day < 1 || t.day > 31 ||
+            t.hour > 23 || t.minute > 59 || t.second > 59) {
+            return false;
+        }
+        seconds = ClockDiscipline::civilToUnix(t);
+        return true;
+    }
+    long value = text.toInt();
+    if (value < 946684800L) {   // Before 2000-01-01
+        return false;
+    }
+    seconds = (uint32_t)value;
+    return true;
+}
+
+IntentResponse IntentAPI::handleClockSet(const IntentRequest& req) {
+    uint32_t seconds;
+    if (req.argCount < 1 || !parseClockTime(req.args[0], seconds)) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Usage: clock.set <YYYY-MM-DD HH:MM:SS|unix_seconds>");
+    }
+    if (!SystemClock::setTime(seconds)) {
+        return IntentResponse(IntentError::ERR_IO, "RTC write failed");
+    }
+    return IntentResponse();
+}
+
+IntentResponse IntentAPI::handleClockSource(const IntentRequest& req) {
+    if (req.argCount < 1) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Usage: clock.source <device_id|auto>");
+    }
+    int deviceId = req.args[0] == "auto" ? -1 : req.args[0].toInt();
+    if (!SystemClock::setSource(deviceId)) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "Device has no readable clock");
+    }
+    return IntentResponse();
+}
+
+IntentResponse IntentAPI::handleClockPulse(const IntentRequest& req) {
+    if (req.argCount < 1) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Usage: clock.pulse <pin|off> [rising|falling]");
+    }
+    int pin = req.args[0] == "off" ? -1 : req.args[0].toInt();
+    bool rising = req.argCount > 1 && req.args[1] == "rising";
+    if (!SystemClock::setPulsePin(pin, rising)) {
+        return IntentResponse(IntentError::ERR_CONFLICT, "Pin not available");
+    }
+    return IntentResponse();
+}
+
+IntentResponse IntentAPI::handleClockSync(const IntentRequest& req) {
+    if (SystemClock::getSource() < 0) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "No clock source");
+    }
+    SystemClock::resync();
+    return IntentResponse();
+}
+
+IntentResponse IntentAPI::handleIrqList(const IntentRequest& req) {
+    IntentResponse resp;
+    resp.data = InterruptManager::getReport();
+    return resp;
+}
+
+// Pops frames from the receive ring: candump log lines ("text") or one
+// hex line per packed 24-byte record ("bin"), then a "# " summary line
+IntentResponse IntentAPI::handleCanDump(const IntentRequest& req) {
+    if (req.argCount < 1) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Usage: can.dump <device_id> [max] [text|bin]");
+    }
+    int deviceId = req.args[0].toInt();
+    SPIDriverAdapter<MCP2515Driver>* adapter =
+        dynamic_cast<SPIDriverAdapter<MCP2515Driver>*>(DeviceRegistry::getDriver(deviceId));
+    if (!adapter) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "No CAN controller with that ID");
+    }
+    int maxFrames = req.argCount > 1 ? req.args[1].toInt() : CAN_DUMP_DEFAULT_FRAMES;
+    if (maxFrames < 1 || maxFrames > CAN_DUMP_MAX_FRAMES) {
+        maxFrames = CAN_DUMP_MAX_FRAMES;
+    }
+    bool binary = req.argCount > 2 && req.args[2] == "bin";
+    if (req.argCount > 2 && !binary && req.args[2] != "text") {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Format must be text or bin");
+    }
+    
+    MCP2515Driver& can = adapter->getDriver();
+    String iface = "dev" + String(deviceId);
+    IntentResponse resp;
+    resp.data.reserve(maxFrames * (binary ? 2 * CAN_PACKED_FRAME_SIZE + 1 : 40));
+    
+    CanFrame frame;
+    int count = 0;
+    while (count < maxFrames && can.popFrame(frame)) {
+        if (binary) {
+            static const char HEX_DIGITS[] = "0123456789ABCDEF";
+            uint8_t record[CAN_PACKED_FRAME_SIZE];
+            char hex[2 * CAN_PACKED_FRAME_SIZE + 1];
+            MCP2515Driver::packFrame(frame, record);
+            for (int i = 0; i < CAN_PACKED_FRAME_SIZE; i++) {
+                hex[2 * i] = HEX_DIGITS[record[i] >> 4];
+                hex[2 * i + 1] = HEX_DIGITS[record[i] & 0x0F];
+            }
+            hex[2 * CAN_PACKED_FRAME_SIZE] = '\0';
+            resp.data += hex;
+        } else {
+            char line[CAN_CANDUMP_LINE_MAX];
+            MCP2515Driver::formatCandump(frame, iface.c_str(), line, sizeof(line));
+            resp.data += line;
+        }
+        resp.data += "\n";
+        count++;
+    }
+    
+    const MCP2515Stats& stats = can.getStats();
+    resp.data += "# frames=" + String(count) + " remaining=" + String(can.framesQueued());
+    resp.data += " ring_drops=" + String(stats.ringDrops) + " rx_overflows=" + String(stats.hwOverflows) + "\n";
+    return resp;
+}
+
+// Payload arguments: hex digits, optional 0x prefix
+static bool parseHexPayload(const String& text, uint8_t* out, size_t maxLen, size_t& len) {
+    String hex = text;
+    if (hex.startsWith("0x") || hex.startsWith("0X")) {
+        hex = hex.substring(2);
+    }
+    len = hex.length() / 2;
+    if (hex.length() % 2 != 0 || len == 0 || len > maxLen) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        char pair[3] = { hex.charAt(2 * i), hex.charAt(2 * i + 1), '\0' };
+        if (!isxdigit((unsigned char)pair[0]) || !isxdigit((unsigned char)pair[1])) {
+            return false;
+        }
+        out[i] = (uint8_t)strtol(pair, nullptr, 16);
+    }
+    return true;
+}
+
+static void appendHex(String& out, const uint8_t* data, size_t len) {
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    char hex[2 * LORA_MAX_PAYLOAD + 1];
+    if (len > LORA_MAX_PAYLOAD) {
+        len = LORA_MAX_PAYLOAD;
+    }
+    for (size_t i = 0; i < len; i++) {
+        hex[2 * i] = HEX_DIGITS[data[i] >> 4];
+        hex[2 * i + 1] = HEX_DIGITS[data[i] & 0x0F];
+    }
+    hex[2 * len] = '\0';
+    out += hex;
+}
+
+static SX127xDriver* findLoRaRadio(int deviceId) {
+    SPIDriverAdapter<SX127xDriver>* adapter =
+        dynamic_cast<SPIDriverAdapter<SX127xDriver>*>(DeviceRegistry::getDriver(deviceId));
+    return adapter ? &adapter->getDriver() : nullptr;
+}
+
+IntentResponse IntentAPI::handleLoraSend(const IntentRequest& req) {
+    if (req.argCount < 2) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Usage: lora.send <device_id> <hex payload>");
+    }
+    SX127xDriver* radio = findLoRaRadio(req.args[0].toInt());
+    if (!radio) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "No LoRa radio with that ID");
+    }
+    
+    uint8_t payload[LORA_MAX_PAYLOAD];
+    size_t len = 0;
+    if (!parseHexPayload(req.args[1], payload, LORA_MAX_PAYLOAD, len)) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Payload must be 1-255 bytes of hex");
+    }
+    
+    uint32_t airtime = radio->airtimeUs((uint8_t)len);
+    uint32_t wait = radio->txWaitMs((uint8_t)len);
+    if (wait == 0xFFFFFFFFUL) {
+        return IntentResponse(IntentError::ERR_CONFLICT, "Packet airtime exceeds the duty-cycle budget");
+    }
+    if (!radio->transmit(payload, (uint8_t)len)) {
+        return IntentResponse(IntentError::ERR_CONFLICT, "TX queue full");
+    }
+    
+    IntentResponse resp;
+    resp.data = "airtime_us=" + String(airtime) + "\n";
+    resp.data += "wait_ms=" + String(wait) + "\n";
+    resp.data += "tx_queued=" + String(radio->txQueued()) + "\n";
+    return resp;
+}
+
+IntentResponse IntentAPI::handleLoraRecv(const IntentRequest& req) {
+    if (req.argCount < 1) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Usage: lora.recv <device_id> [max]");
+    }
+    SX127xDriver* radio = findLoRaRadio(req.args[0].toInt());
+    if (!radio) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "No LoRa radio with that ID");
+    }
+    int maxPackets = req.argCount > 1 ? req.args[1].toInt() : LORA_RECV_MAX_PACKETS;
+    if (maxPackets < 1 || maxPackets > LORA_RECV_MAX_PACKETS) {
+        maxPackets = LORA_RECV_MAX_PACKETS;
+    }
+    
+    // One line per packet: <sec>.<usec> rssi=<dBm> snr=<dB> <hex payload>
+    IntentResponse resp;
+    LoRaPacket packet;
+    int count = 0;
+    while (count < maxPackets && radio->popPacket(packet)) {
+        char meta[64];
+        snprintf(meta, sizeof(meta), "%lu.%06lu rssi=%d snr=%.2f ", (unsigned long)(packet.timestampUs / 1000000ULL),
+                 (unsigned long)(packet.timestampUs % 1000000ULL), packet.rssi, packet.snrQuarterDb / 4.0f);
+        resp.data += meta;
+        appendHex(resp.data, packet.data, packet.len);
+        resp.data += "\n";
+        count++;
+    }
+    
+    const SX127xStats& stats = radio->getStats();
+    resp.data += "# packets=" + String(count) + " remaining=" + String(radio->rxQueued());
+    resp.data += " rx_drops=" + String(stats.rxDrops) + " crc_errors=" + String(stats.rxCrcErrors) + "\n";
+    return resp;
+}
+
+static NRF24L01Driver* findNrfRadio(int deviceId) {
+    SPIDriverAdapter<NRF24L01Driver>* adapter =
+        dynamic_cast<SPIDriverAdapter<NRF24L01Driver>*>(DeviceRegistry::getDriver(deviceId));
+    return adapter ? &adapter->getDriver() : nullptr;
+}
+
+IntentResponse IntentAPI::handleNrfSend(const IntentRequest& req) {
+    if (req.argCount < 2) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Usage: nrf.send <device_id> <hex payload>");
+    }
+    NRF24L01Driver* radio = findNrfRadio(req.args[0].toInt());
+    if (!radio) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "No nRF24L01 with that ID");
+    }
+    uint8_t payload[NRF24_MAX_PAYLOAD];
+    size_t len = 0;
+    if (!parseHexPayload(req.args[1], payload, NRF24_MAX_PAYLOAD, len)) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Payload must be 1-32 bytes of hex");
+    }
+    if (!radio->transmit(payload, (uint8_t)len)) {
+        return IntentResponse(IntentError::ERR_CONFLICT, "TX queue full");
+    }
+    
+    IntentResponse resp;
+    resp.data = "tx_queued=" + String(radio->txQueued()) + "\n";
+    return resp;
+}
+
+IntentResponse IntentAPI::handleNrfAck(const IntentRequest& req) {
+    if (req.argCount < 3) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Usage: nrf.ack <device_id> <pipe> <hex payload>");
+    }
+    NRF24L01Driver* radio = findNrfRadio(req.args[0].toInt());
+    if (!radio) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "No nRF24L01 with that ID");
+    }
+    int pipe = req.args[1].toInt();
+    uint8_t payload[NRF24_MAX_PAYLOAD];
+    size_t len = 0;
+    if (pipe < 0 || pipe > 5 || !parseHexPayload(req.args[2], payload, NRF24_MAX_PAYLOAD, len)) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Pipe 0-5 and 1-32 bytes of hex");
+    }
+    if (!radio->writeAckPayload((uint8_t)pipe, payload, (uint8_t)len)) {
+        return IntentResponse(IntentError::ERR_CONFLICT, "Not listening or ACK payload FIFO full");
+    }
+    return IntentResponse();
+}
+
+IntentResponse IntentAPI::handleNrfRecv(const IntentRequest& req) {
+    if (req.argCount < 1) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Usage: nrf.recv <device_id> [max]");
+    }
+    NRF24L01Driver* radio = findNrfRadio(req.args[0].toInt());
+    if (!radio) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "No nRF24L01 with that ID");
+    }
+    int maxPackets = req.argCount > 1 ? req.args[1].toInt() : NRF_RECV_MAX_PACKETS;
+    if (maxPackets < 1 || maxPackets > NRF_RECV_MAX_PACKETS) {
+        maxPackets = NRF_RECV_MAX_PACKETS;
+    }
+    
+    // One line per packet: <sec>.<usec> pipe=<n> [ack] <hex payload>
+    IntentResponse resp;
+    NRF24Packet packet;
+    int count = 0;
+    while (count < maxPackets && radio->popPacket(packet)) {
+        char meta[48];
+        snprintf(meta, sizeof(meta), "%lu.%06lu pipe=%u %s", (unsigned long)(packet.timestampUs / 1000000ULL),
+                 (unsigned long)(packet.timestampUs % 1000000ULL), packet.pipe, packet.ackPayload ? "ack " : "");
+        resp.data += meta;
+        appendHex(resp.data, packet.data, packet.len);
+        resp.data += "\n";
+        count++;
+    }
+    
+    const NRF24Stats& stats = radio->getStats();
+    resp.data += "# packets=" + String(count) + " remaining=" + String(radio->rxQueued());
+    resp.data += " rx_drops=" + String(stats.rxDrops) + "\n";
+    return resp;
+}
+
+IntentResponse IntentAPI::handleNrfBench(const IntentRequest& req) {
+    if (req.argCount < 1) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "Usage: nrf.bench <device_id> [packets] [len]");
+    }
+    NRF24L01Driver* radio = findNrfRadio(req.args[0].toInt());
+    if (!radio) {
+        return IntentResponse(IntentError::ERR_NOT_FOUND, "No nRF24L01 with that ID");
+    }
+    long packets = req.argCount > 1 ? req.args[1].toInt() : NRF_BENCH_DEFAULT_PACKETS;
+    long len = req.argCount > 2 ? req.args[2].toInt() : NRF24_MAX_PAYLOAD;
+    if (packets < 1 || packets > NRF_BENCH_MAX_PACKETS || len < 1 || len > NRF24_MAX_PAYLOAD) {
+        return IntentResponse(IntentError::ERR_BAD_ARGS, "packets 1-100000, len 1-32");
+    }
+    if (radio->getRole() == NRF24Role::STANDBY || radio->txQueued() > 0) {
+        return IntentResponse(IntentError::ERR_CONFLICT, "Radio powered down or already sending");
+    }
+    
+    // Drive the radio directly until every packet is acked or failed;
+    // the first byte carries a sequence number
+    uint8_t payload[NRF24_MAX_PAYLOAD];
+    memset(payload, 0xA5, sizeof(payload));
+    radio->resetStats();
+    uint32_t startUs = micros();
+    uint32_t startMs = millis();
+    long queued = 0;
+    bool timedOut = false;
+    while (queued < packets || radio->txQueued() > 0) {
+        while (queued < packets) {
+            payload[0] = (uint8_t)queued;
+            if (!radio->transmit(payload, (uint8_t)len)) {
+                break;
+            }
+            queued++;
+        }
+        radio->update();
+        if ((uint32_t)(millis() - startMs) > NRF_BENCH_TIMEOUT_MS) {
+            timedOut = true;
+            break;
+        }
+        yield();
+    }
+    uint32_t elapsedUs = micros() - startUs;
+    
+    const NRF24Stats& stats = radio->getStats();
+    IntentResponse resp;
+    resp.data = "packets=" + String(queued) + " len=" + String(len) + "\n";
+    resp.data += "acked=" + String(stats.txPackets) + " failed=" + String(stats.txFailed) + "\n";
+    resp.data += "elapsed_us=" + String(elapsedUs) + "\n";
+    resp.data += "throughput_kbps=" + String(elapsedUs ? stats.txBytes * 8000.0f / elapsedUs : 0.0f, 1) + "\n";
+    resp.data += "retransmit_avg=" + radio->getParameter("retransmit_avg");
+    resp.data += " retransmit_max=" + String(stats.arcMax) + "\n";
+    resp.data += "ack_payloads=" + String(stats.ackPayloads) + "\n";
+    if (timedOut) {
+        resp.data += "# timed out with " + String(radio->txQueued()) + " still queued\n";
+    }
+    return resp;
+}
+
 IntentResponse IntentAPI::handleConfigExport(const IntentRequest& req) {
     // Export configuration in text format
     String config = "# PocketOS Configuration Export\n";
@@ -414,8 +1002,33 @@ IntentResponse IntentAPI::handleIdentify(const IntentRequest& req) {
     }
     
     String endpoint = req.args[0];
+
+    // Bare bus name: identify every responding address in one pass
+    if (endpoint.startsWith("i2c") && endpoint.indexOf(':') < 0) {
+        int busNum = endpoint.substring(3).toInt();
+        if (busNum != 0) {
+            return IntentResponse(IntentError::ERR_UNSUPPORTED, "Only i2c0 is supported");
+        }
+        DeviceIdentification results[32];
+        int count = DeviceIdentifier::identifyBus(busNum, results, 32);
+
+        IntentResponse resp;
+        resp.data = "bus=" + endpoint + "\n";
+        resp.data += "devices=" + String(count) + "\n";
+        int totalReads = 0;
+        for (int i = 0; i < count; i++) {
+            resp.data += "0x" + String(results[i].address, HEX) + " ";
+            resp.data += results[i].deviceClass + " ";
+            resp.data += results[i].confidence;
+            resp.data += " reads=" + String((int)results[i].probeReads) + "\n";
+            totalReads += results[i].probeReads;
+        }
+        resp.data += "signature_reads=" + String(totalReads) + "\n";
+        return resp;
+    }
+
     DeviceIdentification id = DeviceIdentifier::identifyEndpoint(endpoint);
-    
+
     IntentResponse resp;
     resp.data = "endpoint=" + endpoint + "\n";
     resp.data += "identified=" + String(id.identified ? "true" : "false") + "\n";
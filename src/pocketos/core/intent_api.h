@@ -8,6 +8,19 @@ namespace PocketOS {
 // Intent API version
 #define INTENT_API_VERSION "1.0.0"
 
+// can.dump: frames per call (default, limit)
+#define CAN_DUMP_DEFAULT_FRAMES 64
+#define CAN_DUMP_MAX_FRAMES 256
+
+// lora.recv: packets per call (limit)
+#define LORA_RECV_MAX_PACKETS 32
+
+// nrf.recv: packets per call (limit); nrf.bench: packets (default, limit), time limit
+#define NRF_RECV_MAX_PACKETS 32
+#define NRF_BENCH_DEFAULT_PACKETS 1000
+#define NRF_BENCH_MAX_PACKETS 100000
+#define NRF_BENCH_TIMEOUT_MS 10000
+
 // Error codes - stable v1 error model
 enum class IntentError {
     OK = 0,
@@ -77,10 +90,28 @@ public:
     static IntentResponse handleEpProbe(const IntentRequest& req);
     static IntentResponse handleDevList(const IntentRequest& req);
     static IntentResponse handleDevBind(const IntentRequest& req);
+    static IntentResponse handleDevAutobind(const IntentRequest& req);
     static IntentResponse handleDevUnbind(const IntentRequest& req);
     static IntentResponse handleDevEnable(const IntentRequest& req);
     static IntentResponse handleDevDisable(const IntentRequest& req);
     static IntentResponse handleDevStatus(const IntentRequest& req);
+    static IntentResponse handleDevSignals(const IntentRequest& req);
+    static IntentResponse handleTsQuery(const IntentRequest& req);
+    static IntentResponse handleTsList(const IntentRequest& req);
+    static IntentResponse handleTsFlush(const IntentRequest& req);
+    static IntentResponse handleClockStatus(const IntentRequest& req);
+    static IntentResponse handleClockSet(const IntentRequest& req);
+    static IntentResponse handleClockSource(const IntentRequest& req);
+    static IntentResponse handleClockPulse(const IntentRequest& req);
+    static IntentResponse handleClockSync(const IntentRequest& req);
+    static IntentResponse handleIrqList(const IntentRequest& req);
+    static IntentResponse handleCanDump(const IntentRequest& req);
+    static IntentResponse handleLoraSend(const IntentRequest& req);
+    static IntentResponse handleLoraRecv(const IntentRequest& req);
+    static IntentResponse handleNrfSend(const IntentRequest& req);
+    static IntentResponse handleNrfAck(const IntentRequest& req);
+    static IntentResponse handleNrfRecv(const IntentRequest& req);
+    static IntentResponse handleNrfBench(const IntentRequest& req);
     static IntentResponse handleParamGet(const IntentRequest& req);
     static IntentResponse handleParamSet(const IntentRequest& req);
     static IntentResponse handleSchemaGet(const IntentRequest& req);
@@ -0,0 +1,223 @@
+#include "interrupt_manager.h"
+#include "resource_manager.h"
+#include "hal.h"
+#include "logger.h"
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+namespace PocketOS {
+
+static_assert((IRQ_QUEUE_SIZE & (IRQ_QUEUE_SIZE - 1)) == 0, "IRQ_QUEUE_SIZE must be a power of two");
+static_assert(IRQ_QUEUE_SIZE <= 32768, "IRQ_QUEUE_SIZE too large");
+static_assert(IRQ_MAX_LINES <= 16, "IRQ_MAX_LINES above the ISR table size");
+
+IrqLine InterruptManager::lines[IRQ_MAX_LINES];
+IrqEvent InterruptManager::ring[IRQ_QUEUE_SIZE];
+volatile uint16_t InterruptManager::head = 0;
+volatile uint16_t InterruptManager::tail = 0;
+uint32_t InterruptManager::queueHighWater = 0;
+
+void InterruptManager::init() {
+    for (int i = 0; i < IRQ_MAX_LINES; i++) {
+        lines[i].active = false;
+        lines[i].pin = -1;
+    }
+    head = 0;
+    tail = 0;
+    queueHighWater = 0;
+}
+
+void IRAM_ATTR InterruptManager::onEdge(uint8_t line) {
+    uint32_t now = micros();
+    IrqLine& l = lines[line];
+    l.fired++;
+
+    uint16_t h = head;
+    uint16_t next = (uint16_t)((h + 1) & (IRQ_QUEUE_SIZE - 1));
+    if (next == tail) {
+        l.dropped++;
+        return;
+    }
+    ring[h].line = line;
+    ring[h].deviceId = l.deviceId;
+    ring[h].timestampUs = now;
+    __sync_synchronize();   // Event visible before the index that publishes it
+    head = next;
+}
+
+// Arduino ISRs take no argument: one trampoline per line
+template <uint8_t N>
+void IRAM_ATTR InterruptManager::isr() {
+    onEdge(N);
+}
+
+typedef void (*IsrFn)();
+
+int InterruptManager::attach(int pin, IrqEdge edge, IrqHandler handler, void* context,
+                             const char* owner, int deviceId) {
+    static const IsrFn table[16] = {
+        isr<0>, isr<1>, isr<2>, isr<3>, isr<4>, isr<5>, isr<6>, isr<7>,
+        isr<8>, isr<9>, isr<10>, isr<11>, isr<12>, isr<13>, isr<14>, isr<15>
+    };
+
+    if (!handler || findLine(pin) >= 0 || !HAL::isPinSafe(pin)) {
+        return -1;
+    }
+    int line = -1;
+    for (int i = 0; i < IRQ_MAX_LINES; i++) {
+        if (!lines[i].active) {
+            line = i;
+            break;
+        }
+    }
+    if (line < 0) {
+        Logger::error("No free interrupt lines");
+        return -1;
+    }
+
+    // SPI drivers claim their irq= pin themselves; keep that claim
+    bool claimedBefore = ResourceManager::isClaimed(ResourceType::GPIO_PIN, pin);
+    if (!ResourceManager::claim(ResourceType::GPIO_PIN, pin, owner)) {
+        return -1;
+    }
+
+    IrqLine& l = lines[line];
+    l.pin = pin;
+    l.edge = edge;
+    l.deviceId = (int16_t)deviceId;
+    strncpy(l.owner, owner, IRQ_OWNER_MAX - 1);
+    l.owner[IRQ_OWNER_MAX - 1] = '\0';
+    l.handler = handler;
+    l.context = context;
+    l.claimedPin = !claimedBefore;
+    l.fired = 0;
+    l.dropped = 0;
+    l.dispatched = 0;
+    l.lastUs = 0;
+    l.latencyMaxUs = 0;
+    l.active = true;
+
+    // Alert outputs are mostly open drain, active low
+    pinMode(pin, edge == IrqEdge::RISING_EDGE ? INPUT : INPUT_PULLUP);
+    int mode = edge == IrqEdge::RISING_EDGE ? RISING : (edge == IrqEdge::FALLING_EDGE ? FALLING : CHANGE);
+    attachInterrupt(digitalPinToInterrupt(pin), table[line], mode);
+
+    Logger::info((String("IRQ line ") + String(line) + " on GPIO" + String(pin) + " for " + owner).c_str());
+    return line;
+}
+
+bool InterruptManager::detach(int line) {
+    if (line < 0 || line >= IRQ_MAX_LINES || !lines[line].active) {
+        return false;
+    }
+    IrqLine& l = lines[line];
+    detachInterrupt(digitalPinToInterrupt(l.pin));
+
+    // The line's ISR is gone; other ISRs only write at head, past the
+    // snapshot, so queued events for this line can be voided in place
+    uint16_t h = head;
+    __sync_synchronize();
+    for (uint16_t i = tail; i != h; i = (uint16_t)((i + 1) & (IRQ_QUEUE_SIZE - 1))) {
+        if (ring[i].line == line) {
+            ring[i].line = IRQ_LINE_NONE;
+        }
+    }
+
+    if (l.claimedPin) {
+        ResourceManager::release(ResourceType::GPIO_PIN, l.pin, l.owner);
+    }
+    l.active = false;
+    l.pin = -1;
+    return true;
+}
+
+int InterruptManager::findLine(int pin) {
+    for (int i = 0; i < IRQ_MAX_LINES; i++) {
+        if (lines[i].active && lines[i].pin == pin) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void InterruptManager::dispatch() {
+    uint16_t h = head;
+    __sync_synchronize();   // Read events only after the index
+    uint16_t t = tail;
+
+    uint32_t depth = (uint32_t)((h - t) & (IRQ_QUEUE_SIZE - 1));
+    if (depth > queueHighWater) {
+        queueHighWater = depth;
+    }
+
+    while (t != h) {
+        IrqEvent event = ring[t];
+        t = (uint16_t)((t + 1) & (IRQ_QUEUE_SIZE - 1));
+        tail = t;   // Free the slot before the handler runs
+
+        if (event.line >= IRQ_MAX_LINES || !lines[event.line].active) {
+            continue;
+        }
+        IrqLine& l = lines[event.line];
+        uint32_t latency = micros() - event.timestampUs;
+        if (latency > l.latencyMaxUs) {
+            l.latencyMaxUs = latency;
+        }
+        l.lastUs = event.timestampUs;
+        l.dispatched++;
+        l.handler(l.context, event);
+    }
+}
+
+const IrqLine* InterruptManager::getLine(int line) {
+    if (line < 0 || line >= IRQ_MAX_LINES || !lines[line].active) {
+        return nullptr;
+    }
+    return &lines[line];
+}
+
+String InterruptManager::getReport() {
+    String report = "";
+    for (int i = 0; i < IRQ_MAX_LINES; i++) {
+        const IrqLine& l = lines[i];
+        if (!l.active) {
+            continue;
+        }
+        report += "line" + String(i) + ": gpio" + String(l.pin) + " " + edgeToString(l.edge);
+        report += " owner=" + String(l.owner);
+        report += " fired=" + String(l.fired) + " dispatched=" + String(l.dispatched);
+        report += " dropped=" + String(l.dropped) + " latency_max_us=" + String(l.latencyMaxUs);
+        report += "\n";
+    }
+    if (report.length() == 0) {
+        report = "No interrupt lines\n";
+    }
+    report += "queue=" + String(IRQ_QUEUE_SIZE) + " high_water=" + String(queueHighWater) + "\n";
+    return report;
+}
+
+bool InterruptManager::parseEdge(const String& text, IrqEdge& edge) {
+    if (text == "rising") {
+        edge = IrqEdge::RISING_EDGE;
+    } else if (text == "falling") {
+        edge = IrqEdge::FALLING_EDGE;
+    } else if (text == "change") {
+        edge = IrqEdge::CHANGE_EDGE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* InterruptManager::edgeToString(IrqEdge edge) {
+    switch (edge) {
+        case IrqEdge::RISING_EDGE: return "rising";
+        case IrqEdge::FALLING_EDGE: return "falling";
+        case IrqEdge::CHANGE_EDGE: return "change";
+        default: return "unknown";
+    }
+}
+
+} // namespace PocketOS
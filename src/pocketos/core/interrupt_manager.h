@@ -0,0 +1,107 @@
+#ifndef POCKETOS_INTERRUPT_MANAGER_H
+#define POCKETOS_INTERRUPT_MANAGER_H
+
+#include <Arduino.h>
+
+namespace PocketOS {
+
+/**
+ * Interrupt manager
+ *
+ * GPIO edge interrupts for device alert and data-ready lines. The ISR
+ * only stamps the edge and pushes (line, device, micros) into a
+ * single-producer/single-consumer ring; dispatch(), called from the main
+ * loop before DeviceRegistry::updateAll(), pops the events and runs each
+ * line's handler outside interrupt context, where bus access is allowed.
+ *
+ * All GPIO interrupts are serviced by the core that attached them and do
+ * not nest, so the ISRs together are the single producer; the main loop
+ * is the single consumer. A full ring drops the new event and counts it
+ * against its line.
+ *
+ * Bound devices take a line with `param set <id> irq <pin>[:edge]`
+ * (DeviceRegistry); their handler is IDriver::onInterrupt(). Other
+ * modules (SPI drivers, services) can attach() directly.
+ */
+
+#ifndef IRQ_MAX_LINES
+#define IRQ_MAX_LINES 8
+#endif
+#ifndef IRQ_QUEUE_SIZE
+#define IRQ_QUEUE_SIZE 32      // Events; power of two
+#endif
+#define IRQ_OWNER_MAX 12
+#define IRQ_LINE_NONE 0xFF    // Event discarded by detach()
+
+enum class IrqEdge : uint8_t {
+    RISING_EDGE,
+    FALLING_EDGE,
+    CHANGE_EDGE
+};
+
+struct IrqEvent {
+    uint8_t line;
+    int16_t deviceId;        // -1 if the line is not owned by a device
+    uint32_t timestampUs;    // micros() in the ISR
+};
+
+// Runs in the main loop from dispatch()
+typedef void (*IrqHandler)(void* context, const IrqEvent& event);
+
+struct IrqLine {
+    bool active;
+    int pin;
+    IrqEdge edge;
+    int16_t deviceId;
+    char owner[IRQ_OWNER_MAX];
+    IrqHandler handler;
+    void* context;
+    bool claimedPin;         // Claimed here (released on detach)
+
+    // Written by the ISR
+    volatile uint32_t fired;
+    volatile uint32_t dropped;
+
+    uint32_t dispatched;
+    uint32_t lastUs;         // Timestamp of the last dispatched edge
+    uint32_t latencyMaxUs;   // Edge to handler, worst case
+};
+
+class InterruptManager {
+public:
+    static void init();
+
+    // Attach an edge handler to a pin. The pin is claimed for `owner`.
+    // Returns the line number, or -1 (no free line, pin unsafe or taken)
+    static int attach(int pin, IrqEdge edge, IrqHandler handler, void* context,
+                      const char* owner, int deviceId = -1);
+    // Events still queued for the line are discarded
+    static bool detach(int line);
+    static int findLine(int pin);   // Line attached to a pin, or -1
+
+    // Main loop: run handlers for queued events (at most one ring's worth
+    // per call, so an interrupt storm cannot stall the loop)
+    static void dispatch();
+
+    static const IrqLine* getLine(int line);
+    static uint32_t getQueueHighWater() { return queueHighWater; }
+    static String getReport();
+
+    // "rising", "falling", "change"
+    static bool parseEdge(const String& text, IrqEdge& edge);
+    static const char* edgeToString(IrqEdge edge);
+
+private:
+    static IrqLine lines[IRQ_MAX_LINES];
+    static IrqEvent ring[IRQ_QUEUE_SIZE];
+    static volatile uint16_t head;   // Next slot to write (ISR)
+    static volatile uint16_t tail;   // Next slot to read (loop)
+    static uint32_t queueHighWater;
+
+    static void onEdge(uint8_t line);
+    template <uint8_t N> static void isr();
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_INTERRUPT_MANAGER_H
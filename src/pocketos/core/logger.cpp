@@ -1,4 +1,5 @@
 #include "logger.h"
+#include "system_clock.h"
 #include <Arduino.h>
 
 namespace PocketOS {
@@ -76,9 +77,11 @@ void Logger::clear() {
 }
 
 void Logger::addToBuffer(LogLevel level, const char* message) {
-    // Format: [LEVEL] message
-    snprintf(logBuffer[logHead], LOG_LINE_LENGTH, "[%s] %s", 
-             levelToString(level), message);
+    // Format: <time> [LEVEL] message (wall clock once SystemClock is synced)
+    char stamp[32];
+    SystemClock::format(SystemClock::nowUs(), stamp, sizeof(stamp));
+    snprintf(logBuffer[logHead], LOG_LINE_LENGTH, "%s [%s] %s", 
+             stamp, levelToString(level), message);
     
     logHead = (logHead + 1) % LOG_BUFFER_LINES;
     if (logCount < LOG_BUFFER_LINES) {
@@ -6,7 +6,7 @@
 namespace PocketOS {
 
 #define LOG_BUFFER_LINES 128
-#define LOG_LINE_LENGTH 96
+#define LOG_LINE_LENGTH 120   // Includes the timestamp
 
 enum class LogLevel {
     INFO,
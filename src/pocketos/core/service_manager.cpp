@@ -3,6 +3,9 @@
 #include "hal.h"
 #include "device_registry.h"
 #include "persistence.h"
+#include "timeseries_store.h"
+#include "ts_littlefs.h"
+#include "system_clock.h"
 
 namespace PocketOS {
 
@@ -24,7 +27,7 @@ bool ServiceManager::registerService(Service* service) {
     }
     
     _services[_serviceCount++] = service;
-    Logger::info(String("Service registered: ") + service->getName());
+    Logger::info((String("Service registered: ") + service->getName()).c_str());
     return true;
 }
 
@@ -36,7 +39,7 @@ bool ServiceManager::unregisterService(const char* name) {
                 _services[j] = _services[j + 1];
             }
             _serviceCount--;
-            Logger::info(String("Service unregistered: ") + name);
+            Logger::info((String("Service unregistered: ") + name).c_str());
             return true;
         }
     }
@@ -53,12 +56,12 @@ bool ServiceManager::startService(const char* name) {
     
     if (service->init()) {
         service->setState(ServiceState::RUNNING);
-        Logger::info(String("Service started: ") + name);
+        Logger::info((String("Service started: ") + name).c_str());
         return true;
     }
     
     service->setState(ServiceState::FAULT);
-    Logger::error(String("Service start failed: ") + name);
+    Logger::error((String("Service start failed: ") + name).c_str());
     return false;
 }
 
@@ -68,7 +71,7 @@ bool ServiceManager::stopService(const char* name) {
     
     service->shutdown();
     service->setState(ServiceState::STOPPED);
-    Logger::info(String("Service stopped: ") + name);
+    Logger::info((String("Service stopped: ") + name).c_str());
     return true;
 }
 
@@ -147,7 +150,7 @@ void HealthService::tick() {
     // Log health metrics periodically
     static int healthCounter = 0;
     if (++healthCounter >= 10) {  // Every 10 ticks = ~10 seconds
-        Logger::info("Health: heap=" + String(freeHeap) + " devices=" + String(deviceCount));
+        Logger::info(("Health: heap=" + String(freeHeap) + " devices=" + String(deviceCount)).c_str());
         healthCounter = 0;
     }
 }
@@ -189,7 +192,7 @@ void TelemetryService::recordGauge(const char* name, int value) {
 String TelemetryService::getTelemetryReport() {
     String report = "=== Telemetry Report ===\n";
     report += "System uptime: " + String(millis() / 1000) + "s\n";
-    report += "Tick count: " + String(ServiceManager::_tickCounter) + "\n";
+    report += "Tick count: " + String(ServiceManager::getTickCount()) + "\n";
     return report;
 }
 
@@ -210,4 +213,44 @@ void PersistenceService::shutdown() {
     Persistence::saveAll();
 }
 
+// TimeSeriesService implementation
+bool TimeSeriesService::init() {
+    static LittleFsTsFileSystem fs;
+    if (!fs.begin()) {
+        Logger::warning("TimeSeries: LittleFS not available");
+        return false;
+    }
+    if (!TimeSeriesStore::init(&fs, LittleFsTsFileSystem::uptimeMs)) {
+        return false;
+    }
+    if (SystemClock::isSynced()) {
+        TimeSeriesStore::setClock(SystemClock::nowMs);
+    }
+    return true;
+}
+
+void TimeSeriesService::tick() {
+    // Batched writer: sealed blocks (and open blocks past TS_FLUSH_AGE_MS)
+    TimeSeriesStore::flush(false);
+}
+
+void TimeSeriesService::shutdown() {
+    TimeSeriesStore::flush(true);
+}
+
+// ClockService implementation
+bool ClockService::init() {
+    SystemClock::init();
+    return true;
+}
+
+void ClockService::tick() {
+    // Finds an RTC, then disciplines the system clock against it
+    SystemClock::service();
+}
+
+void ClockService::shutdown() {
+    SystemClock::setPulsePin(-1, false);
+}
+
 } // namespace PocketOS
@@ -60,6 +60,7 @@ public:
     static int getServiceCount();
     static String getServiceList();
     static ServiceState getServiceState(const char* name);
+    static uint32_t getTickCount() { return _tickCounter; }
     
 private:
     static constexpr int MAX_SERVICES = 8;
@@ -110,6 +111,24 @@ private:
     bool _saveRequested = false;
 };
 
+class TimeSeriesService : public Service {
+public:
+    bool init() override;
+    void tick() override;
+    void shutdown() override;
+    const char* getName() const override { return "timeseries"; }
+    uint32_t getTickInterval() const override { return 1000; }  // Every 1000 ticks (~10 s)
+};
+
+class ClockService : public Service {
+public:
+    bool init() override;
+    void tick() override;
+    void shutdown() override;
+    const char* getName() const override { return "clock"; }
+    uint32_t getTickInterval() const override { return 1; }  // Every tick (RTC reads are scheduled inside)
+};
+
 } // namespace PocketOS
 
 #endif // POCKETOS_SERVICE_MANAGER_H
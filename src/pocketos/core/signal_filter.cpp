@@ -0,0 +1,214 @@
+#include "signal_filter.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace PocketOS {
+
+bool FilterStage::step(float& x) {
+    switch (kind) {
+        case FilterKind::AVERAGE: {
+            if (count < size) {
+                ring[count++] = x;
+                acc += x;
+            } else {
+                acc += x - ring[head];
+                ring[head] = x;
+                if (++head == size) {
+                    // Once per window: re-sum so rounding errors do not accumulate
+                    head = 0;
+                    acc = 0;
+                    for (uint8_t i = 0; i < size; i++) {
+                        acc += ring[i];
+                    }
+                }
+            }
+            x = acc / count;
+            return true;
+        }
+
+        case FilterKind::MEDIAN: {
+            float* sorted = median.sorted;
+            uint8_t n = count;
+            if (count < size) {
+                median.window[count++] = x;
+            } else {
+                // Remove the oldest sample from the sorted window
+                float oldest = median.window[head];
+                uint8_t i = 0;
+                while (i < n - 1 && sorted[i] != oldest) {
+                    i++;
+                }
+                for (; i < n - 1; i++) {
+                    sorted[i] = sorted[i + 1];
+                }
+                n--;
+                median.window[head] = x;
+                if (++head == size) {
+                    head = 0;
+                }
+            }
+            // Insert the new one
+            uint8_t j = n;
+            while (j > 0 && sorted[j - 1] > x) {
+                sorted[j] = sorted[j - 1];
+                j--;
+            }
+            sorted[j] = x;
+            x = (count & 1) ? sorted[count / 2]
+                            : 0.5f * (sorted[count / 2 - 1] + sorted[count / 2]);
+            return true;
+        }
+
+        case FilterKind::EMA:
+            if (count == 0) {
+                acc = x;
+                count = 1;
+            } else {
+                acc += param * (x - acc);
+            }
+            x = acc;
+            return true;
+
+        case FilterKind::DECIMATE:
+            acc += x;
+            if (++count < size) {
+                return false;
+            }
+            x = acc / size;
+            acc = 0;
+            count = 0;
+            return true;
+
+        case FilterKind::DEADBAND:
+            if (count != 0 && fabsf(x - acc) < param) {
+                return false;
+            }
+            acc = x;
+            count = 1;
+            return true;
+
+        case FilterKind::NONE:
+        default:
+            return true;
+    }
+}
+
+bool SignalFilter::parseStage(const char* text, size_t len, FilterStage& out) {
+    char buf[24];
+    if (len == 0 || len >= sizeof(buf)) {
+        return false;
+    }
+    memcpy(buf, text, len);
+    buf[len] = '\0';
+
+    char* colon = strchr(buf, ':');
+    if (!colon) {
+        return false;
+    }
+    *colon = '\0';
+    const char* name = buf;
+    const char* arg = colon + 1;
+    char* end = nullptr;
+
+    out = FilterStage();
+    if (strcmp(name, "avg") == 0 || strcmp(name, "median") == 0 || strcmp(name, "decimate") == 0) {
+        long n = strtol(arg, &end, 10);
+        if (end == arg || *end != '\0' || n < 1) {
+            return false;
+        }
+        if (name[0] == 'a') {
+            out.kind = FilterKind::AVERAGE;
+            if (n > SIGNAL_FILTER_MAX_WINDOW) return false;
+        } else if (name[0] == 'm') {
+            out.kind = FilterKind::MEDIAN;
+            if (n > SIGNAL_FILTER_MAX_MEDIAN) return false;
+        } else {
+            out.kind = FilterKind::DECIMATE;
+            if (n > 255) return false;
+        }
+        out.size = (uint8_t)n;
+        return true;
+    }
+
+    if (strcmp(name, "ema") == 0 || strcmp(name, "deadband") == 0) {
+        float v = strtof(arg, &end);
+        if (end == arg || *end != '\0' || !(v >= 0.0f) || isinf(v)) {
+            return false;
+        }
+        if (name[0] == 'e') {
+            if (v <= 0.0f || v > 1.0f) return false;
+            out.kind = FilterKind::EMA;
+        } else {
+            out.kind = FilterKind::DEADBAND;
+        }
+        out.param = v;
+        return true;
+    }
+
+    return false;
+}
+
+bool SignalFilter::parse(const char* spec, FilterStage* out, uint8_t& count) {
+    count = 0;
+    if (!spec) {
+        return false;
+    }
+    if (strcmp(spec, "none") == 0) {
+        return true;
+    }
+
+    const char* p = spec;
+    while (true) {
+        const char* comma = strchr(p, ',');
+        size_t len = comma ? (size_t)(comma - p) : strlen(p);
+        if (count == SIGNAL_FILTER_MAX_STAGES || !parseStage(p, len, out[count])) {
+            return false;
+        }
+        count++;
+        if (!comma) {
+            return true;
+        }
+        p = comma + 1;
+    }
+}
+
+bool SignalFilter::configure(const char* spec) {
+    FilterStage parsed[SIGNAL_FILTER_MAX_STAGES];
+    uint8_t count;
+    if (!parse(spec, parsed, count)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        stage[i] = parsed[i];
+    }
+    stages = count;
+    return true;
+}
+
+bool SignalFilter::validate(const char* spec) {
+    FilterStage parsed[SIGNAL_FILTER_MAX_STAGES];
+    uint8_t count;
+    return parse(spec, parsed, count);
+}
+
+void SignalFilter::reset() {
+    for (uint8_t i = 0; i < stages; i++) {
+        stage[i].reset();
+    }
+}
+
+bool SignalFilter::process(float in, float& out) {
+    if (!isfinite(in)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < stages; i++) {
+        if (!stage[i].step(in)) {
+            return false;
+        }
+    }
+    out = in;
+    return true;
+}
+
+} // namespace PocketOS
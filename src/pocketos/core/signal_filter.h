@@ -0,0 +1,101 @@
+#ifndef POCKETOS_SIGNAL_FILTER_H
+#define POCKETOS_SIGNAL_FILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PocketOS {
+
+/**
+ * Per-signal filter chain
+ *
+ * A chain of up to SIGNAL_FILTER_MAX_STAGES stages, configured from a spec
+ * string of comma-separated stages:
+ *
+ *   avg:N        moving average over the last N samples (N <= 16)
+ *   median:N     median of the last N samples (N <= 9)
+ *   ema:A        exponential moving average, y += A * (x - y), 0 < A <= 1
+ *   decimate:N   mean of each block of N samples, one output per block
+ *   deadband:D   output only when the value moved >= D since the last output
+ *   none         no stages (pass-through)
+ *
+ * e.g. "median:5,ema:0.2,deadband:0.05". Stages run in order; a stage that
+ * suppresses the sample (decimate, deadband) ends the chain for it.
+ *
+ * State is fixed-size and work per sample is O(1): the moving average
+ * keeps a running sum (re-summed once per window to cancel float drift),
+ * the median keeps its window sorted by insertion (at most 9 elements).
+ *
+ * No Arduino dependency: exercised on the host (tools/filterbench).
+ */
+
+#define SIGNAL_FILTER_MAX_STAGES 3
+#define SIGNAL_FILTER_MAX_WINDOW 16
+#define SIGNAL_FILTER_MAX_MEDIAN 9
+
+enum class FilterKind : uint8_t {
+    NONE,
+    AVERAGE,
+    MEDIAN,
+    EMA,
+    DECIMATE,
+    DEADBAND
+};
+
+struct FilterStage {
+    FilterKind kind;
+    uint8_t size;       // Window (avg, median) or block length (decimate)
+    uint8_t count;      // Samples held
+    uint8_t head;       // Oldest sample in the ring
+    float param;        // EMA alpha or deadband width
+    float acc;          // Running sum, EMA state, block sum or last output
+    union {
+        float ring[SIGNAL_FILTER_MAX_WINDOW];
+        struct {
+            float window[SIGNAL_FILTER_MAX_MEDIAN];  // Arrival order
+            float sorted[SIGNAL_FILTER_MAX_MEDIAN];
+        } median;
+    };
+
+    FilterStage() : kind(FilterKind::NONE), size(0), count(0), head(0), param(0), acc(0) {}
+
+    void reset() {
+        count = 0;
+        head = 0;
+        acc = 0;
+    }
+
+    // Filter x in place; false if the sample is suppressed
+    bool step(float& x);
+};
+
+class SignalFilter {
+public:
+    SignalFilter() : stages(0) {}
+
+    // Parse a spec; on error the current chain is left unchanged
+    bool configure(const char* spec);
+
+    // Check a spec without applying it
+    static bool validate(const char* spec);
+
+    // Drop all history (keeps the configuration)
+    void reset();
+
+    // Feed one sample; true with `out` set when the chain emits a value.
+    // Non-finite samples are dropped.
+    bool process(float in, float& out);
+
+    uint8_t stageCount() const { return stages; }
+
+private:
+    FilterStage stage[SIGNAL_FILTER_MAX_STAGES];
+    uint8_t stages;
+
+    static bool parse(const char* spec, FilterStage* out, uint8_t& count);
+    static bool parseStage(const char* text, size_t len, FilterStage& out);
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_SIGNAL_FILTER_H
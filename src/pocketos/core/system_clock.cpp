@@ -0,0 +1,313 @@
+#include "system_clock.h"
+#include "device_registry.h"
+#include "resource_manager.h"
+#include "timeseries_store.h"
+#include "hal.h"
+#include "logger.h"
+
+#ifdef ESP32
+#include <esp_timer.h>
+#endif
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+namespace PocketOS {
+
+ClockDiscipline SystemClock::discipline;
+ClockState SystemClock::state = ClockState::NO_SOURCE;
+int SystemClock::sourceId = -1;
+bool SystemClock::autoSource = true;
+ClockStats SystemClock::stats = {};
+uint64_t SystemClock::nextScanUs = 0;
+bool SystemClock::prevValid = false;
+uint32_t SystemClock::prevSec = 0;
+uint64_t SystemClock::prevReadUs = 0;
+uint32_t SystemClock::nextSec = 0;
+uint64_t SystemClock::nextEdgeUs = 0;
+int SystemClock::pulsePin = -1;
+volatile uint32_t SystemClock::pulseMicros = 0;
+volatile uint32_t SystemClock::pulseCount = 0;
+uint32_t SystemClock::pulseSeen = 0;
+uint64_t SystemClock::lastPulseUs = 0;
+
+void SystemClock::init() {
+    discipline.reset();
+    state = ClockState::NO_SOURCE;
+    sourceId = -1;
+    autoSource = true;
+    stats = ClockStats();
+    nextScanUs = 0;
+    prevValid = false;
+}
+
+uint64_t SystemClock::monoUs() {
+#ifdef ESP32
+    return (uint64_t)esp_timer_get_time();
+#else
+    // micros() extended to 64 bits; called at least every tick by service()
+    static uint32_t last = 0;
+    static uint32_t wraps = 0;
+    uint32_t now = micros();
+    if (now < last) {
+        wraps++;
+    }
+    last = now;
+    return ((uint64_t)wraps << 32) | now;
+#endif
+}
+
+void SystemClock::format(uint64_t unixUs, char* out, size_t len) {
+    unsigned ms = (unsigned)(unixUs / 1000 % 1000);
+    if (!isSynced()) {
+        snprintf(out, len, "+%lu.%03u", (unsigned long)(unixUs / 1000000), ms);
+        return;
+    }
+    CivilTime t;
+    ClockDiscipline::unixToCivil((uint32_t)(unixUs / 1000000), t);
+    snprintf(out, len, "%04u-%02u-%02u %02u:%02u:%02u.%03u", t.year, t.month, t.day,
+             t.hour, t.minute, t.second, ms);
+}
+
+bool SystemClock::setSource(int deviceId) {
+    if (deviceId >= 0) {
+        uint32_t sec;
+        if (!DeviceRegistry::readDeviceClock(deviceId, sec)) {
+            return false;
+        }
+    }
+    autoSource = deviceId < 0;
+    sourceId = deviceId;
+    nextScanUs = 0;
+    resync();
+    return true;
+}
+
+void IRAM_ATTR SystemClock::onPulse() {
+    pulseMicros = micros();
+    pulseCount++;
+}
+
+bool SystemClock::setPulsePin(int pin, bool rising) {
+    if (pulsePin >= 0) {
+        detachInterrupt(digitalPinToInterrupt(pulsePin));
+        ResourceManager::release(ResourceType::GPIO_PIN, pulsePin, "clock");
+        pulsePin = -1;
+    }
+    if (pin < 0) {
+        return true;
+    }
+    if (!HAL::isPinSafe(pin) || !ResourceManager::claim(ResourceType::GPIO_PIN, pin, "clock")) {
+        return false;
+    }
+    if (sourceId >= 0 && !DeviceRegistry::enableDevicePulse(sourceId)) {
+        Logger::warning("Clock: source has no 1 Hz output control; configure it manually");
+    }
+    pinMode(pin, INPUT_PULLUP);     // RTC square-wave outputs are open drain
+    pulseSeen = pulseCount;
+    lastPulseUs = 0;
+    attachInterrupt(digitalPinToInterrupt(pin), onPulse, rising ? RISING : FALLING);
+    pulsePin = pin;
+    return true;
+}
+
+bool SystemClock::setTime(uint32_t unixSeconds) {
+    if (sourceId >= 0) {
+        if (!DeviceRegistry::writeDeviceClock(sourceId, unixSeconds)) {
+            return false;
+        }
+        resync();
+        return true;
+    }
+    // No RTC: set the clock directly (coarse, never refined)
+    discipline.relock();
+    discipline.capture(monoUs(), CLOCK_PRECISE_US + 1, unixSeconds);
+    return true;
+}
+
+void SystemClock::resync() {
+    discipline.relock();
+    state = sourceId >= 0 ? ClockState::HUNT : ClockState::NO_SOURCE;
+    prevValid = false;
+}
+
+bool SystemClock::readSource(uint32_t& sec, uint64_t& startUs, uint64_t& endUs) {
+    startUs = monoUs();
+    bool ok = DeviceRegistry::readDeviceClock(sourceId, sec);
+    endUs = monoUs();
+    stats.rtcReads++;
+    if (!ok) {
+        stats.readFailures++;
+    }
+    return ok;
+}
+
+void SystemClock::captured(uint64_t edgeUs, uint32_t halfWidthUs, uint32_t sec) {
+    bool first = !discipline.isLocked();
+    uint32_t steps = discipline.steps();
+    discipline.capture(edgeUs, halfWidthUs, sec);
+
+    nextSec = sec + discipline.intervalSeconds();
+    nextEdgeUs = discipline.toMonoUs((uint64_t)nextSec * 1000000ULL);
+    state = ClockState::TRACK;
+
+    if (first || discipline.steps() != steps) {
+        char stamp[32];
+        format((uint64_t)sec * 1000000ULL, stamp, sizeof(stamp));
+        Logger::info((String(first ? "Clock: synced to dev" : "Clock: stepped to dev") +
+                      String(sourceId) + " " + stamp).c_str());
+        if (TimeSeriesStore::isReady()) {
+            TimeSeriesStore::setClock(nowMs);
+        }
+    }
+}
+
+void SystemClock::hunt() {
+    // One read per tick; the edge lies between two reads that differ
+    uint32_t sec;
+    uint64_t startUs, endUs;
+    if (!readSource(sec, startUs, endUs)) {
+        prevValid = false;
+        return;
+    }
+    if (prevValid && sec == prevSec + 1) {
+        captured((prevReadUs + endUs) / 2, (uint32_t)((endUs - prevReadUs) / 2), sec);
+        return;
+    }
+    prevValid = true;
+    prevSec = sec;
+    prevReadUs = startUs;
+}
+
+void SystemClock::readBack() {
+    // Blocking: back-to-back reads around the expected edge
+    uint64_t begin = monoUs();
+    uint64_t deadline = nextEdgeUs + CLOCK_WINDOW_TAIL_US;
+    uint32_t sec;
+    uint64_t startUs, endUs;
+    bool have = false;
+    uint32_t last = 0;
+    uint64_t lastStartUs = 0;
+
+    while (monoUs() < deadline) {
+        if (!readSource(sec, startUs, endUs)) {
+            break;
+        }
+        if (!have) {
+            if (sec >= nextSec) {
+                break;  // Edge already passed: cannot bracket it
+            }
+        } else if (sec != last) {
+            uint32_t windowUs = (uint32_t)(endUs - begin);
+            if (windowUs > stats.windowMaxUs) {
+                stats.windowMaxUs = windowUs;
+            }
+            if (sec == nextSec) {
+                captured((lastStartUs + endUs) / 2, (uint32_t)((endUs - lastStartUs) / 2), sec);
+                return;
+            }
+            break;
+        }
+        have = true;
+        last = sec;
+        lastStartUs = startUs;
+    }
+
+    stats.misses++;
+    state = ClockState::HUNT;
+    prevValid = false;
+}
+
+void SystemClock::takePulse() {
+    uint32_t count, raw;
+    noInterrupts();
+    count = pulseCount;
+    raw = pulseMicros;
+    interrupts();
+    if (count == pulseSeen) {
+        return;
+    }
+    pulseSeen = count;
+    stats.pulses++;
+
+    uint64_t edgeUs = monoFromMicros(raw);
+    uint64_t now = monoUs();
+    lastPulseUs = edgeUs;
+    if (now - edgeUs > CLOCK_PULSE_LABEL_US) {
+        return;  // Seen too late to read its label
+    }
+    if (state == ClockState::TRACK && discipline.toUnixUs(edgeUs) + 500000ULL < (uint64_t)nextSec * 1000000ULL) {
+        return;  // Not due yet
+    }
+
+    uint32_t sec;
+    uint64_t startUs, endUs;
+    if (readSource(sec, startUs, endUs)) {
+        captured(edgeUs, CLOCK_PULSE_HALF_WIDTH_US, sec);
+    }
+}
+
+void SystemClock::service() {
+    uint64_t now = monoUs();
+
+    if (sourceId >= 0 && !DeviceRegistry::deviceExists(sourceId)) {
+        Logger::warning("Clock: source device unbound");
+        sourceId = -1;
+        state = ClockState::NO_SOURCE;
+    }
+    if (sourceId < 0) {
+        if (!autoSource || now < nextScanUs) {
+            return;
+        }
+        nextScanUs = now + CLOCK_SCAN_INTERVAL_US;
+        sourceId = DeviceRegistry::findClockDevice();
+        if (sourceId < 0) {
+            return;
+        }
+        if (pulsePin >= 0) {
+            DeviceRegistry::enableDevicePulse(sourceId);
+        }
+        resync();
+    }
+
+    if (pulsePin >= 0) {
+        takePulse();
+        if (lastPulseUs != 0 && monoUs() - lastPulseUs < CLOCK_PULSE_TIMEOUT_US) {
+            return;  // Pulses keep the clock; reads only label them
+        }
+    }
+
+    if (state == ClockState::HUNT) {
+        hunt();
+    } else if (state == ClockState::TRACK && now + CLOCK_WINDOW_LEAD_US >= nextEdgeUs) {
+        readBack();
+    }
+}
+
+String SystemClock::getStatus() {
+    char stamp[32];
+    format(nowUs(), stamp, sizeof(stamp));
+    const char* stateName = state == ClockState::TRACK ? "track" :
+                            (state == ClockState::HUNT ? "hunt" : "no_source");
+
+    String s = "time=" + String(stamp) + "\n";
+    s += "synced=" + String(isSynced() ? "yes" : "no") + "\n";
+    s += "state=" + String(stateName) + "\n";
+    s += "source=" + (sourceId >= 0 ? "dev" + String(sourceId) : String("none")) +
+         (autoSource ? " (auto)" : "") + "\n";
+    s += "pulse_pin=" + String(pulsePin) + "\n";
+    s += "drift_ppm=" + String(discipline.driftPpm(), 2) + "\n";
+    s += "last_offset_us=" + String(discipline.lastOffsetUs()) + "\n";
+    s += "sync_interval_s=" + String(discipline.intervalSeconds()) + "\n";
+    s += "captures=" + String(discipline.captures()) + "\n";
+    s += "steps=" + String(discipline.steps()) + "\n";
+    s += "misses=" + String(stats.misses) + "\n";
+    s += "pulses=" + String(stats.pulses) + "\n";
+    s += "rtc_reads=" + String(stats.rtcReads) + "\n";
+    s += "read_failures=" + String(stats.readFailures) + "\n";
+    s += "window_max_us=" + String(stats.windowMaxUs) + "\n";
+    return s;
+}
+
+} // namespace PocketOS
@@ -0,0 +1,131 @@
+#ifndef POCKETOS_SYSTEM_CLOCK_H
+#define POCKETOS_SYSTEM_CLOCK_H
+
+#include <Arduino.h>
+#include "clock_discipline.h"
+
+namespace PocketOS {
+
+/**
+ * System clock
+ *
+ * Wall-clock time for samples, log lines and the time-series store,
+ * without bus access on the read path. nowUs() reads the local
+ * microsecond counter and converts it through the discipline
+ * (clock_discipline.h): one multiply and a shift.
+ *
+ * The discipline is steered by a bound RTC (any driver with
+ * readDateTime(), see IDriver::readClock()). ClockService calls service()
+ * every main loop tick:
+ *
+ * - Hunt: read the RTC every tick until its seconds change. The edge
+ *   lies between the two reads (+-1 loop period); this first capture
+ *   sets the time.
+ * - Track: shortly before the RTC second the discipline asks for next
+ *   (CLOCK_SYNC_MIN_S..CLOCK_SYNC_MAX_S apart), read the RTC back to back
+ *   until it ticks over. That brackets the edge to about one I2C read
+ *   and blocks the loop for at most CLOCK_WINDOW_LEAD_US +
+ *   CLOCK_WINDOW_TAIL_US. A missed window goes back to hunting.
+ * - Pulse (`clock pulse <pin>`): the RTC's 1 Hz output drives an
+ *   interrupt that timestamps each edge to a few microseconds; the RTC
+ *   is read once after the edge for its label. The edge must be the one
+ *   on which the RTC's seconds advance. If pulses stop for
+ *   CLOCK_PULSE_TIMEOUT_US, tracking falls back to reads.
+ *
+ * Without a source the first clock device bound is used (`clock source`
+ * picks one). Until the first capture, nowUs() is uptime.
+ */
+
+#define CLOCK_WINDOW_LEAD_US 15000      // Read-back window before the expected edge
+#define CLOCK_WINDOW_TAIL_US 10000      // ...and after it
+#define CLOCK_SCAN_INTERVAL_US 2000000  // Looking for a clock device
+#define CLOCK_PULSE_HALF_WIDTH_US 20    // Interrupt latency
+#define CLOCK_PULSE_LABEL_US 300000     // RTC read must follow the edge within this
+#define CLOCK_PULSE_TIMEOUT_US 3000000
+
+enum class ClockState : uint8_t {
+    NO_SOURCE,
+    HUNT,
+    TRACK
+};
+
+struct ClockStats {
+    uint32_t rtcReads;
+    uint32_t readFailures;
+    uint32_t misses;        // Read-back windows that did not see the edge
+    uint32_t pulses;
+    uint32_t windowMaxUs;   // Longest read-back window
+};
+
+class SystemClock {
+public:
+    static void init();
+
+    // Local microseconds since boot (64-bit, never wraps)
+    static uint64_t monoUs();
+
+    // Monotonic time of a recent micros() stamp (e.g. taken in an ISR)
+    static uint64_t monoFromMicros(uint32_t stampUs) {
+        return monoUs() - (uint32_t)((uint32_t)micros() - stampUs);
+    }
+
+    // Unix time once synced; uptime before
+    static uint64_t nowUs() { return discipline.toUnixUs(monoUs()); }
+    static uint64_t nowMs() { return nowUs() / 1000; }
+    static uint64_t toUnixUs(uint64_t mono) { return discipline.toUnixUs(mono); }
+    static bool isSynced() { return discipline.isLocked(); }
+
+    // "YYYY-MM-DD HH:MM:SS.mmm" (synced) or "+<seconds>.mmm" (uptime)
+    static void format(uint64_t unixUs, char* out, size_t len);
+
+    // Clock device; -1 = first one bound
+    static bool setSource(int deviceId);
+    static int getSource() { return sourceId; }
+
+    // 1 Hz input pin (-1 = none); rising or falling edge
+    static bool setPulsePin(int pin, bool rising);
+
+    // Set the RTC (or, without one, the clock itself) and resync
+    static bool setTime(uint32_t unixSeconds);
+    static void resync();
+
+    static void service();
+
+    static String getStatus();
+    static const ClockStats& getStats() { return stats; }
+
+private:
+    static ClockDiscipline discipline;
+    static ClockState state;
+    static int sourceId;
+    static bool autoSource;
+    static ClockStats stats;
+    static uint64_t nextScanUs;
+
+    // Hunt bracket
+    static bool prevValid;
+    static uint32_t prevSec;
+    static uint64_t prevReadUs;
+
+    // Track
+    static uint32_t nextSec;
+    static uint64_t nextEdgeUs;
+
+    // Pulse input
+    static int pulsePin;
+    static volatile uint32_t pulseMicros;
+    static volatile uint32_t pulseCount;
+    static uint32_t pulseSeen;
+    static uint64_t lastPulseUs;
+
+    static void onPulse();
+    static bool readSource(uint32_t& sec, uint64_t& startUs, uint64_t& endUs);
+    static void hunt();
+    static void readBack();
+    static void takePulse();
+    static void captured(uint64_t edgeUs, uint32_t halfWidthUs, uint32_t sec);
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_SYSTEM_CLOCK_H
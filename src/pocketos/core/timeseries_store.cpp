@@ -0,0 +1,471 @@
+#include "timeseries_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace PocketOS {
+
+TsFileSystem* TimeSeriesStore::fs = nullptr;
+uint64_t (*TimeSeriesStore::clock)() = nullptr;
+uint64_t TimeSeriesStore::offsetMs = 0;
+TsSeries TimeSeriesStore::series[TS_MAX_SERIES];
+TsStats TimeSeriesStore::stats;
+
+namespace {
+
+// Running aggregate over one bucket (or the whole range)
+struct Accumulator {
+    uint32_t count;
+    float min;
+    float max;
+    double sum;
+    float last;
+
+    Accumulator() : count(0), min(0), max(0), sum(0), last(0) {}
+
+    void add(float v) {
+        if (count == 0 || v < min) min = v;
+        if (count == 0 || v > max) max = v;
+        sum += v;
+        last = v;
+        count++;
+    }
+
+    void addBlock(const TsBlockHeader& h) {
+        if (count == 0 || h.vMin < min) min = h.vMin;
+        if (count == 0 || h.vMax > max) max = h.vMax;
+        sum += h.vSum;
+        count += h.count;
+    }
+
+    float result(TsAggregate agg) const {
+        switch (agg) {
+            case TsAggregate::AVG: return (float)(sum / count);
+            case TsAggregate::MIN: return min;
+            case TsAggregate::MAX: return max;
+            case TsAggregate::SUM: return (float)sum;
+            case TsAggregate::COUNT: return (float)count;
+            case TsAggregate::LAST:
+            default: return last;
+        }
+    }
+};
+
+struct QueryState {
+    const TsQuery* q;
+    TsSink sink;
+    void* ctx;
+    int32_t points;
+    Accumulator acc;
+    uint64_t bucket;
+
+    void emit() {
+        if (acc.count > 0) {
+            sink(ctx, bucket, acc.result(q->agg));
+        }
+        acc = Accumulator();
+    }
+
+    void point(uint64_t t, float v) {
+        points++;
+        if (q->agg == TsAggregate::NONE) {
+            sink(ctx, t, v);
+            return;
+        }
+        if (q->bucketMs > 0) {
+            uint64_t b = q->fromMs + (t - q->fromMs) / q->bucketMs * q->bucketMs;
+            if (b != bucket) {
+                emit();
+                bucket = b;
+            }
+        }
+        acc.add(v);
+    }
+
+    void scan(const uint8_t* block) {
+        TsBlockReader reader;
+        if (!reader.open(block)) {
+            return;  // Torn or corrupt block
+        }
+        uint64_t t;
+        float v;
+        while (reader.next(t, v)) {
+            if (t < q->fromMs) continue;
+            if (t > q->toMs) break;
+            point(t, v);
+        }
+    }
+};
+
+} // namespace
+
+bool TimeSeriesStore::init(TsFileSystem* fileSystem, uint64_t (*clockMs)()) {
+    fs = fileSystem;
+    clock = clockMs;
+    offsetMs = 0;
+    memset(&stats, 0, sizeof(stats));
+    for (int i = 0; i < TS_MAX_SERIES; i++) {
+        series[i].active = false;
+    }
+    return fs != nullptr;
+}
+
+uint64_t TimeSeriesStore::now() {
+    return (clock ? clock() : 0) + offsetMs;
+}
+
+void TimeSeriesStore::setTime(uint64_t nowMs) {
+    // Never backwards: stored series must stay in time order
+    uint64_t current = now();
+    if (nowMs > current) {
+        offsetMs += nowMs - current;
+    }
+}
+
+void TimeSeriesStore::setClock(uint64_t (*clockMs)()) {
+    // Switch time source without going backwards
+    uint64_t current = now();
+    clock = clockMs;
+    offsetMs = 0;
+    uint64_t next = clock();
+    if (next < current) {
+        offsetMs = current - next;
+    }
+}
+
+bool TimeSeriesStore::seriesName(const char* endpoint, const char* signal, char* out, size_t len) {
+    size_t need = strlen(endpoint) + 1 + strlen(signal) + 1;
+    if (need > len || need > TS_SERIES_NAME_MAX) {
+        return false;
+    }
+    size_t n = 0;
+    for (const char* p = endpoint; *p; p++) {
+        out[n++] = (*p == ':' || *p == '/' || *p == '.') ? '_' : *p;
+    }
+    out[n++] = '_';
+    strcpy(out + n, signal);
+    return true;
+}
+
+void TimeSeriesStore::segmentPath(const TsSeries& s, int segment, char* out, size_t len) {
+    snprintf(out, len, "/ts/%s.%d", s.name, segment);
+}
+
+TsSeries* TimeSeriesStore::find(const char* name, bool create) {
+    if (!fs || strlen(name) >= TS_SERIES_NAME_MAX) {
+        return nullptr;
+    }
+    TsSeries* freeSlot = nullptr;
+    for (int i = 0; i < TS_MAX_SERIES; i++) {
+        if (series[i].active && strcmp(series[i].name, name) == 0) {
+            return &series[i];
+        }
+        if (!series[i].active && !freeSlot) {
+            freeSlot = &series[i];
+        }
+    }
+    if (!freeSlot) {
+        return nullptr;
+    }
+
+    TsSeries& s = *freeSlot;
+    strcpy(s.name, name);
+    if (!create) {
+        char path[40];
+        segmentPath(s, 0, path, sizeof(path));
+        uint32_t old = fs->size(path);
+        segmentPath(s, 1, path, sizeof(path));
+        if (old == 0 && fs->size(path) == 0) {
+            return nullptr;  // Nothing stored under this name
+        }
+    }
+    s.active = true;
+    s.writer.begin(s.open);
+    s.sealedCount = 0;
+    s.torn = false;
+    loadIndex(s);
+    return &s;
+}
+
+void TimeSeriesStore::indexBlock(TsSeries& s, const uint8_t* block) {
+    int i = s.oldBlocks + s.curBlocks;
+    TsBlockHeader h;
+    if (h.parse(block, false) && h.count > 0) {
+        s.indexFirst[i] = (uint32_t)(h.tFirst / 1000);
+        s.indexLast[i] = (uint32_t)((h.tLast + 999) / 1000);
+    } else {
+        s.indexFirst[i] = UINT32_MAX;  // Never matches a range
+        s.indexLast[i] = 0;
+    }
+}
+
+void TimeSeriesStore::loadIndex(TsSeries& s) {
+    s.oldBlocks = 0;
+    s.curBlocks = 0;
+    uint64_t newest = 0;
+    uint8_t header[TS_BLOCK_HEADER];
+
+    for (int seg = 0; seg < 2; seg++) {
+        char path[40];
+        segmentPath(s, seg, path, sizeof(path));
+        uint32_t size = fs->size(path);
+        uint32_t blocks = size / TS_BLOCK_SIZE;
+        if (blocks > TS_SEGMENT_BLOCKS) {
+            blocks = TS_SEGMENT_BLOCKS;
+        }
+        if (seg == 1 && size % TS_BLOCK_SIZE != 0) {
+            s.torn = true;  // Interrupted write: pad before appending
+        }
+        for (uint32_t b = 0; b < blocks; b++) {
+            memset(header, 0, sizeof(header));
+            fs->read(path, b * TS_BLOCK_SIZE, header, sizeof(header));
+            // Index from the header alone; the CRC is checked when read
+            indexBlock(s, header);
+            TsBlockHeader h;
+            if (h.parse(header, false) && h.tLast > newest) {
+                newest = h.tLast;
+            }
+            if (seg == 0) {
+                s.oldBlocks++;
+            } else {
+                s.curBlocks++;
+            }
+        }
+    }
+
+    // Resume store time after the newest stored sample
+    uint64_t current = now();
+    if (newest >= current) {
+        offsetMs += newest - current + 1000;
+    }
+}
+
+bool TimeSeriesStore::writeSealed(TsSeries& s) {
+    char path0[40];
+    char path1[40];
+    segmentPath(s, 0, path0, sizeof(path0));
+    segmentPath(s, 1, path1, sizeof(path1));
+
+    if (s.torn) {
+        // Pad a partial trailing block so later blocks stay aligned; the
+        // padded block fails its CRC and is skipped by queries
+        uint32_t tail = fs->size(path1) % TS_BLOCK_SIZE;
+        if (tail != 0 && s.curBlocks < TS_SEGMENT_BLOCKS) {
+            uint8_t pad[TS_BLOCK_SIZE];
+            memset(pad, 0, sizeof(pad));
+            if (!fs->append(path1, pad, TS_BLOCK_SIZE - tail)) {
+                stats.writeErrors++;
+                return false;
+            }
+            indexBlock(s, pad);
+            s.curBlocks++;
+        }
+        s.torn = false;
+    }
+
+    uint8_t done = 0;
+    while (done < s.sealedCount) {
+        if (s.curBlocks >= TS_SEGMENT_BLOCKS) {
+            // Current segment full: it becomes the old one
+            fs->remove(path0);
+            if (!fs->rename(path1, path0)) {
+                fs->remove(path1);
+            }
+            for (uint8_t i = 0; i < s.curBlocks; i++) {
+                s.indexFirst[i] = s.indexFirst[s.oldBlocks + i];
+                s.indexLast[i] = s.indexLast[s.oldBlocks + i];
+            }
+            s.oldBlocks = s.curBlocks;
+            s.curBlocks = 0;
+        }
+
+        uint8_t n = (uint8_t)(s.sealedCount - done);
+        if (n > TS_SEGMENT_BLOCKS - s.curBlocks) {
+            n = (uint8_t)(TS_SEGMENT_BLOCKS - s.curBlocks);
+        }
+        if (!fs->append(path1, s.sealed[done], (size_t)n * TS_BLOCK_SIZE)) {
+            stats.writeErrors++;
+            s.torn = true;  // May have written part of it
+            break;
+        }
+        for (uint8_t i = 0; i < n; i++) {
+            indexBlock(s, s.sealed[done + i]);
+            s.curBlocks++;
+        }
+        stats.blocksWritten += n;
+        stats.bytesWritten += (uint32_t)n * TS_BLOCK_SIZE;
+        done += n;
+    }
+
+    // Keep what could not be written at the front
+    if (done > 0 && done < s.sealedCount) {
+        memmove(s.sealed[0], s.sealed[done], (size_t)(s.sealedCount - done) * TS_BLOCK_SIZE);
+    }
+    s.sealedCount = (uint8_t)(s.sealedCount - done);
+    return s.sealedCount == 0;
+}
+
+void TimeSeriesStore::seal(TsSeries& s) {
+    if (s.writer.pointCount() == 0) {
+        return;
+    }
+    s.writer.finish();
+    if (s.sealedCount == TS_SERIES_PENDING) {
+        stats.forcedWrites++;
+        if (!writeSealed(s)) {
+            // Still failing: drop the oldest block rather than the newest
+            memmove(s.sealed[0], s.sealed[1], (size_t)(TS_SERIES_PENDING - 1) * TS_BLOCK_SIZE);
+            s.sealedCount--;
+        }
+    }
+    memcpy(s.sealed[s.sealedCount++], s.open, TS_BLOCK_SIZE);
+    s.writer.begin(s.open);
+}
+
+bool TimeSeriesStore::append(const char* name, float value) {
+    // Open the series first: loading its index may move store time forward
+    if (!find(name, true)) {
+        return false;
+    }
+    return appendAt(name, now(), value);
+}
+
+bool TimeSeriesStore::appendAt(const char* name, uint64_t tMs, float value) {
+    TsSeries* s = find(name, true);
+    if (!s) {
+        return false;
+    }
+    if (!s->writer.append(tMs, value)) {
+        // Block full (or time jumped): seal it and start the next one
+        seal(*s);
+        if (!s->writer.append(tMs, value)) {
+            return false;
+        }
+    }
+    if (s->writer.pointCount() == 1) {
+        s->openedMs = now();
+    }
+    stats.samples++;
+    return true;
+}
+
+int32_t TimeSeriesStore::query(const char* name, const TsQuery& q, TsSink sink, void* ctx) {
+    TsSeries* s = find(name, false);
+    if (!s || q.toMs < q.fromMs) {
+        return -1;
+    }
+
+    QueryState state;
+    state.q = &q;
+    state.sink = sink;
+    state.ctx = ctx;
+    state.points = 0;
+    state.bucket = q.fromMs;
+
+    // Whole-range aggregates (except last) can use block headers
+    bool headerStats = q.agg != TsAggregate::NONE && q.agg != TsAggregate::LAST && q.bucketMs == 0;
+
+    uint8_t block[TS_BLOCK_SIZE];
+    char path[40];
+    int blocks = s->oldBlocks + s->curBlocks;
+    for (int i = 0; i < blocks; i++) {
+        if ((uint64_t)s->indexLast[i] * 1000 < q.fromMs || (uint64_t)s->indexFirst[i] * 1000 > q.toMs) {
+            continue;
+        }
+        int seg = i < s->oldBlocks ? 0 : 1;
+        uint32_t offset = (uint32_t)(seg == 0 ? i : i - s->oldBlocks) * TS_BLOCK_SIZE;
+        segmentPath(*s, seg, path, sizeof(path));
+
+        if (headerStats) {
+            TsBlockHeader h;
+            if (fs->read(path, offset, block, TS_BLOCK_HEADER) && h.parse(block, false) &&
+                h.tFirst >= q.fromMs && h.tLast <= q.toMs) {
+                state.acc.addBlock(h);
+                state.points += h.count;
+                continue;
+            }
+        }
+        if (fs->read(path, offset, block, TS_BLOCK_SIZE)) {
+            state.scan(block);
+        }
+    }
+
+    // Not yet on flash: sealed blocks, then the open one
+    for (uint8_t i = 0; i < s->sealedCount; i++) {
+        state.scan(s->sealed[i]);
+    }
+    if (s->writer.pointCount() > 0) {
+        s->writer.finish();  // Header only; appending continues afterwards
+        state.scan(s->open);
+    }
+
+    if (q.agg != TsAggregate::NONE) {
+        state.emit();
+    }
+    return state.points;
+}
+
+void TimeSeriesStore::flush(bool all) {
+    if (!fs) {
+        return;
+    }
+    uint64_t t = now();
+    for (int i = 0; i < TS_MAX_SERIES; i++) {
+        TsSeries& s = series[i];
+        if (!s.active) {
+            continue;
+        }
+        if (s.writer.pointCount() > 0 && (all || t - s.openedMs >= TS_FLUSH_AGE_MS)) {
+            seal(s);
+        }
+        if (s.sealedCount > 0) {
+            writeSealed(s);
+        }
+    }
+}
+
+void TimeSeriesStore::list(void (*line)(void* ctx, const char* text), void* ctx) {
+    char text[96];
+    for (int i = 0; i < TS_MAX_SERIES; i++) {
+        const TsSeries& s = series[i];
+        if (s.active) {
+            snprintf(text, sizeof(text), "%s blocks=%u open=%u pending=%u", s.name,
+                     (unsigned)(s.oldBlocks + s.curBlocks), (unsigned)s.writer.pointCount(),
+                     (unsigned)s.sealedCount);
+            line(ctx, text);
+        }
+    }
+}
+
+bool TimeSeriesStore::parseAggregate(const char* text, TsAggregate& agg, uint32_t& bucketMs) {
+    static const struct {
+        const char* name;
+        TsAggregate agg;
+    } names[] = {
+        { "raw", TsAggregate::NONE }, { "avg", TsAggregate::AVG }, { "min", TsAggregate::MIN },
+        { "max", TsAggregate::MAX }, { "sum", TsAggregate::SUM }, { "count", TsAggregate::COUNT },
+        { "last", TsAggregate::LAST },
+    };
+
+    // <agg>[:<bucket seconds>]
+    const char* colon = strchr(text, ':');
+    size_t len = colon ? (size_t)(colon - text) : strlen(text);
+    bucketMs = 0;
+    if (colon) {
+        char* end = nullptr;
+        long seconds = strtol(colon + 1, &end, 10);
+        if (end == colon + 1 || *end != '\0' || seconds <= 0) {
+            return false;
+        }
+        bucketMs = (uint32_t)seconds * 1000;
+    }
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strlen(names[i].name) == len && strncmp(text, names[i].name, len) == 0) {
+            agg = names[i].agg;
+            return agg != TsAggregate::NONE || bucketMs == 0;
+        }
+    }
+    return false;
+}
+
+} // namespace PocketOS
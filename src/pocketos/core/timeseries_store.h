@@ -0,0 +1,179 @@
+#ifndef POCKETOS_TIMESERIES_STORE_H
+#define POCKETOS_TIMESERIES_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ts_codec.h"
+#include "../driver_config.h"
+
+namespace PocketOS {
+
+/**
+ * On-flash time-series store
+ *
+ * Append-only and log-structured. Each series ("<endpoint>_<signal>", e.g.
+ * i2c0_0x76_temperature) is two segment files of TS_BLOCK_SIZE blocks
+ * (ts_codec.h):
+ *
+ *   /ts/<series>.0   older segment
+ *   /ts/<series>.1   current segment, blocks appended at the end
+ *
+ * When the current segment holds TS_SEGMENT_BLOCKS blocks it replaces the
+ * older one, so each series keeps between one and two segments of history
+ * on flash.
+ *
+ * Samples go into an open block in RAM. A full block is sealed into the
+ * series' pending area. The writer (TimeSeriesService calling flush()) then
+ * appends all sealed blocks of a series in one write. Open blocks older
+ * than TS_FLUSH_AGE_MS are sealed too, which bounds what a power loss can
+ * lose. Flash is written once per block, not once per sample.
+ *
+ * Each open series keeps a RAM index of the first/last second of every
+ * block on flash. Queries read only the blocks that overlap the range.
+ * Aggregates over blocks that lie wholly inside the range use the block
+ * header (count/min/max/sum) without decoding.
+ *
+ * Time is store time in ms, which is monotonic across reboots. At boot it
+ * resumes after the newest stored sample. Once SystemClock is synced it
+ * switches to Unix time (setClock()).
+ *
+ * The file system is abstract (TsFileSystem). On the device it is LittleFS
+ * (ts_littlefs.h). tools/tsbench backs it with a directory on the host.
+ */
+
+#ifndef TS_MAX_SERIES
+#if POCKETOS_DRIVER_TIER == POCKETOS_TIER_0
+#define TS_MAX_SERIES 4
+#else
+#define TS_MAX_SERIES 8
+#endif
+#endif
+
+#ifndef TS_SEGMENT_BLOCKS
+#define TS_SEGMENT_BLOCKS 16        // 4 KB segments
+#endif
+
+#ifndef TS_SERIES_PENDING
+#define TS_SERIES_PENDING 2         // Sealed blocks held per series before a forced write
+#endif
+
+#ifndef TS_FLUSH_AGE_MS
+#define TS_FLUSH_AGE_MS 600000UL    // Seal open blocks after 10 min
+#endif
+
+#define TS_SERIES_NAME_MAX 28       // Fits the LittleFS name limit with ".N"
+
+// Minimal file access used by the store
+class TsFileSystem {
+public:
+    virtual ~TsFileSystem() {}
+    virtual uint32_t size(const char* path) = 0;    // 0 if missing
+    virtual bool read(const char* path, uint32_t offset, uint8_t* buf, size_t len) = 0;
+    virtual bool append(const char* path, const uint8_t* buf, size_t len) = 0;
+    virtual bool remove(const char* path) = 0;
+    virtual bool rename(const char* from, const char* to) = 0;
+};
+
+enum class TsAggregate : uint8_t {
+    NONE,       // Raw points
+    AVG,
+    MIN,
+    MAX,
+    SUM,
+    COUNT,
+    LAST
+};
+
+struct TsQuery {
+    uint64_t fromMs;
+    uint64_t toMs;          // Inclusive
+    TsAggregate agg;
+    uint32_t bucketMs;      // Aggregate per bucket; 0 = one result for the range
+
+    TsQuery() : fromMs(0), toMs(UINT64_MAX), agg(TsAggregate::NONE), bucketMs(0) {}
+};
+
+// Receives raw points, or (bucket start, aggregate) results
+typedef void (*TsSink)(void* ctx, uint64_t t, float value);
+
+struct TsStats {
+    uint32_t samples;           // Appended since boot
+    uint32_t blocksWritten;
+    uint32_t forcedWrites;      // Written outside flush() (pending area full)
+    uint32_t writeErrors;
+    uint32_t bytesWritten;
+};
+
+struct TsSeries {
+    bool active;
+    char name[TS_SERIES_NAME_MAX];
+    uint8_t open[TS_BLOCK_SIZE];
+    TsBlockWriter writer;
+    uint64_t openedMs;          // Store time of the open block's first sample
+    uint8_t sealed[TS_SERIES_PENDING][TS_BLOCK_SIZE];
+    uint8_t sealedCount;
+    uint8_t oldBlocks;          // Blocks in segment .0
+    uint8_t curBlocks;          // Blocks in segment .1
+    bool torn;                  // Segment .1 ends in a partial write
+    uint32_t indexFirst[2 * TS_SEGMENT_BLOCKS];  // Seconds, floor
+    uint32_t indexLast[2 * TS_SEGMENT_BLOCKS];   // Seconds, ceil
+
+    TsSeries() : active(false), openedMs(0), sealedCount(0), oldBlocks(0), curBlocks(0), torn(false) {
+        name[0] = '\0';
+    }
+};
+
+class TimeSeriesStore {
+public:
+    // `clockMs` is a monotonic millisecond counter (millis() on the device)
+    static bool init(TsFileSystem* fs, uint64_t (*clockMs)());
+    static bool isReady() { return fs != nullptr; }
+
+    // Store time (ms)
+    static uint64_t now();
+    static void setTime(uint64_t nowMs);
+    // New time source (SystemClock once synced); store time continues
+    // from max(current, new source)
+    static void setClock(uint64_t (*clockMs)());
+
+    // Series name from endpoint and signal ("i2c0:0x76", "temperature");
+    // false if it does not fit TS_SERIES_NAME_MAX
+    static bool seriesName(const char* endpoint, const char* signal, char* out, size_t len);
+
+    // Append one sample at store time now()
+    static bool append(const char* series, float value);
+    static bool appendAt(const char* series, uint64_t tMs, float value);
+
+    // Points or aggregates in [fromMs, toMs], oldest first. Returns the
+    // number of points read, or -1 for an unknown series.
+    static int32_t query(const char* series, const TsQuery& q, TsSink sink, void* ctx);
+
+    // Writer: store sealed blocks (and seal old open blocks). all = true
+    // seals every open block first (ts flush, shutdown).
+    static void flush(bool all);
+
+    // "<series> blocks=<n> open=<points> pending=<n>" lines
+    static void list(void (*line)(void* ctx, const char* text), void* ctx);
+
+    static const TsStats& getStats() { return stats; }
+
+    static bool parseAggregate(const char* text, TsAggregate& agg, uint32_t& bucketMs);
+
+private:
+    static TsFileSystem* fs;
+    static uint64_t (*clock)();
+    static uint64_t offsetMs;
+    static TsSeries series[TS_MAX_SERIES];
+    static TsStats stats;
+
+    static TsSeries* find(const char* name, bool create);
+    static void loadIndex(TsSeries& s);
+    static void seal(TsSeries& s);
+    static bool writeSealed(TsSeries& s);
+    static void indexBlock(TsSeries& s, const uint8_t* block);
+    static void segmentPath(const TsSeries& s, int segment, char* out, size_t len);
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_TIMESERIES_STORE_H
@@ -0,0 +1,296 @@
+#include "ts_codec.h"
+#include "crc.h"
+#include <string.h>
+
+namespace PocketOS {
+
+namespace {
+
+const uint32_t PAYLOAD_BITS = (TS_BLOCK_SIZE - TS_BLOCK_HEADER) * 8;
+const uint8_t NO_WINDOW = 0xFF;
+
+void putU16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+void putU32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+void putU64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+uint16_t getU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint64_t getU64(const uint8_t* p) {
+    return (uint64_t)getU32(p) | ((uint64_t)getU32(p + 4) << 32);
+}
+
+uint32_t floatBits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+float bitsFloat(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+uint8_t leadingZeros(uint32_t x) {
+    uint8_t n = 0;
+    while (!(x & 0x80000000UL)) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+}
+
+uint8_t trailingZeros(uint32_t x) {
+    uint8_t n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+}
+
+uint16_t blockCrc(const uint8_t* block) {
+    return Crc::crc16Ccitt(block + 8, TS_BLOCK_SIZE - 8);
+}
+
+} // namespace
+
+bool TsBlockHeader::parse(const uint8_t* block, bool checkCrc) {
+    if (getU16(block) != TS_BLOCK_MAGIC) {
+        return false;
+    }
+    if (checkCrc && getU16(block + 6) != blockCrc(block)) {
+        return false;
+    }
+    count = getU16(block + 2);
+    bits = getU16(block + 4);
+    tFirst = getU64(block + 8);
+    tLast = getU64(block + 16);
+    vMin = bitsFloat(getU32(block + 24));
+    vMax = bitsFloat(getU32(block + 28));
+    vSum = bitsFloat(getU32(block + 32));
+    return bits <= PAYLOAD_BITS;
+}
+
+// TsBlockWriter
+
+void TsBlockWriter::begin(uint8_t* buffer) {
+    block = buffer;
+    memset(block, 0, TS_BLOCK_SIZE);
+    bitPos = 0;
+    count = 0;
+}
+
+bool TsBlockWriter::put(uint32_t value, uint8_t bits) {
+    if (bitPos + bits > PAYLOAD_BITS) {
+        return false;
+    }
+    uint8_t* payload = block + TS_BLOCK_HEADER;
+    while (bits--) {
+        uint8_t mask = (uint8_t)(0x80 >> (bitPos & 7));
+        if ((value >> bits) & 1) {
+            payload[bitPos >> 3] |= mask;
+        } else {
+            payload[bitPos >> 3] &= (uint8_t)~mask;
+        }
+        bitPos++;
+    }
+    return true;
+}
+
+bool TsBlockWriter::append(uint64_t t, float v) {
+    uint32_t bits = floatBits(v);
+
+    if (count == 0) {
+        put(bits, 32);
+        tFirst = t;
+        tPrev = t;
+        deltaPrev = 0;
+        vPrev = bits;
+        leadPrev = NO_WINDOW;
+        trailPrev = 0;
+        vMin = v;
+        vMax = v;
+        vSum = v;
+        count = 1;
+        return true;
+    }
+
+    if (t < tPrev || count == 0xFFFF) {
+        return false;
+    }
+    int64_t delta = (int64_t)(t - tPrev);
+    int64_t dod = delta - deltaPrev;
+    if (dod < INT32_MIN || dod > INT32_MAX) {
+        return false;
+    }
+
+    uint32_t start = bitPos;
+    bool ok;
+    if (dod == 0) {
+        ok = put(0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        ok = put(0x2, 2) && put((uint32_t)(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        ok = put(0x6, 3) && put((uint32_t)(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        ok = put(0xE, 4) && put((uint32_t)(dod + 2047), 12);
+    } else {
+        ok = put(0xF, 4) && put((uint32_t)(int32_t)dod, 32);
+    }
+
+    uint32_t x = bits ^ vPrev;
+    uint8_t lead = leadPrev;
+    uint8_t trail = trailPrev;
+    if (ok) {
+        if (x == 0) {
+            ok = put(0, 1);
+        } else {
+            uint8_t lz = leadingZeros(x);
+            uint8_t tz = trailingZeros(x);
+            if (leadPrev != NO_WINDOW && lz >= leadPrev && tz >= trailPrev) {
+                ok = put(0x2, 2) && put(x >> trailPrev, (uint8_t)(32 - leadPrev - trailPrev));
+            } else {
+                uint8_t len = (uint8_t)(32 - lz - tz);
+                ok = put(0x3, 2) && put(lz, 5) && put(len - 1, 5) && put(x >> tz, len);
+                lead = lz;
+                trail = tz;
+            }
+        }
+    }
+
+    if (!ok) {
+        bitPos = start;  // Block full: leave it as it was
+        return false;
+    }
+
+    tPrev = t;
+    deltaPrev = delta;
+    vPrev = bits;
+    leadPrev = lead;
+    trailPrev = trail;
+    if (v < vMin) vMin = v;
+    if (v > vMax) vMax = v;
+    vSum += v;
+    count++;
+    return true;
+}
+
+void TsBlockWriter::finish() {
+    putU16(block, TS_BLOCK_MAGIC);
+    putU16(block + 2, count);
+    putU16(block + 4, (uint16_t)bitPos);
+    putU64(block + 8, count ? tFirst : 0);
+    putU64(block + 16, count ? tPrev : 0);
+    putU32(block + 24, floatBits(count ? vMin : 0.0f));
+    putU32(block + 28, floatBits(count ? vMax : 0.0f));
+    putU32(block + 32, floatBits(count ? vSum : 0.0f));
+    putU16(block + 6, blockCrc(block));
+}
+
+// TsBlockReader
+
+bool TsBlockReader::open(const uint8_t* buffer) {
+    block = buffer;
+    bitPos = 0;
+    remaining = 0;
+    if (!hdr.parse(buffer, true)) {
+        return false;
+    }
+    remaining = hdr.count;
+    first = true;
+    return true;
+}
+
+uint32_t TsBlockReader::get(uint8_t bits) {
+    const uint8_t* payload = block + TS_BLOCK_HEADER;
+    uint32_t value = 0;
+    while (bits--) {
+        if (bitPos >= hdr.bits) {
+            return value;  // Corrupt stream: stop at the end of written data
+        }
+        value = (value << 1) | ((payload[bitPos >> 3] >> (7 - (bitPos & 7))) & 1);
+        bitPos++;
+    }
+    return value;
+}
+
+bool TsBlockReader::next(uint64_t& t, float& v) {
+    if (remaining == 0) {
+        return false;
+    }
+    remaining--;
+
+    if (first) {
+        first = false;
+        vPrev = get(32);
+        tPrev = hdr.tFirst;
+        deltaPrev = 0;
+        leadPrev = NO_WINDOW;
+        trailPrev = 0;
+        t = tPrev;
+        v = bitsFloat(vPrev);
+        return true;
+    }
+
+    int64_t dod;
+    if (get(1) == 0) {
+        dod = 0;
+    } else if (get(1) == 0) {
+        dod = (int64_t)get(7) - 63;
+    } else if (get(1) == 0) {
+        dod = (int64_t)get(9) - 255;
+    } else if (get(1) == 0) {
+        dod = (int64_t)get(12) - 2047;
+    } else {
+        dod = (int32_t)get(32);
+    }
+    deltaPrev += dod;
+    tPrev += (uint64_t)deltaPrev;
+
+    if (get(1) != 0) {
+        uint32_t x;
+        if (get(1) == 0) {
+            if (leadPrev == NO_WINDOW) {
+                remaining = 0;  // Corrupt: no window to reuse
+                return false;
+            }
+            x = get((uint8_t)(32 - leadPrev - trailPrev)) << trailPrev;
+        } else {
+            leadPrev = (uint8_t)get(5);
+            uint8_t len = (uint8_t)(get(5) + 1);
+            if (leadPrev + len > 32) {
+                remaining = 0;
+                return false;
+            }
+            trailPrev = (uint8_t)(32 - leadPrev - len);
+            x = get(len) << trailPrev;
+        }
+        vPrev ^= x;
+    }
+
+    t = tPrev;
+    v = bitsFloat(vPrev);
+    return true;
+}
+
+} // namespace PocketOS
@@ -0,0 +1,130 @@
+#ifndef POCKETOS_TS_CODEC_H
+#define POCKETOS_TS_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PocketOS {
+
+/**
+ * Time-series block codec (Gorilla-style)
+ *
+ * A block is TS_BLOCK_SIZE bytes: a fixed header followed by a bit stream
+ * of (timestamp, float) points.
+ *
+ *   0  u16 magic 'TS'      8 u64 first timestamp (ms)   24 f32 min
+ *   2  u16 point count    16 u64 last timestamp (ms)    28 f32 max
+ *   4  u16 bits used                                    32 f32 sum
+ *   6  u16 CRC-16/CCITT over bytes 8..end               36 bit stream
+ *
+ * Timestamps are delta-of-delta coded (first point: delta 0), MSB first:
+ *
+ *   0                      dod == 0
+ *   10   + 7 bits          -63..64
+ *   110  + 9 bits          -255..256
+ *   1110 + 12 bits         -2047..2048
+ *   1111 + 32 bits         anything else in int32
+ *
+ * Values are XORed with the previous one (the first is stored raw):
+ *
+ *   0                      same value
+ *   10 + meaningful bits   fits the previous leading/trailing-zero window
+ *   11 + 5 bits leading zeros + 5 bits (length - 1) + meaningful bits
+ *
+ * Bits per point at 1 Hz, block header included, against 96 raw (all
+ * measured by tools/tsbench):
+ *
+ *   steady value, exact clock                    2.5
+ *   steady value, +/-3 ms timestamp jitter      10.7
+ *   smooth 0.01 degC signal, exact clock         3.5  (store run)
+ *   random-walk temperature, +/-3 ms jitter     27.4  (0.01 degC)
+ *                                               32.8  (raw float)
+ *
+ * The header's min/max/sum let range aggregates skip decoding blocks that
+ * lie entirely inside the range.
+ *
+ * No Arduino dependency: exercised on the host (tools/tsbench).
+ */
+
+#define TS_BLOCK_SIZE 256
+#define TS_BLOCK_HEADER 36
+#define TS_BLOCK_MAGIC 0x5354
+
+struct TsBlockHeader {
+    uint16_t count;
+    uint16_t bits;
+    uint64_t tFirst;
+    uint64_t tLast;
+    float vMin;
+    float vMax;
+    float vSum;
+
+    // False if the magic or CRC does not match (checkCrc = false: magic only)
+    bool parse(const uint8_t* block, bool checkCrc);
+};
+
+// Appends points to a block buffer owned by the caller
+class TsBlockWriter {
+public:
+    TsBlockWriter() : block(nullptr), bitPos(0), count(0) {}
+
+    void begin(uint8_t* buffer);
+
+    // False (point not added) when the block is full or the timestamp
+    // goes backwards or jumps by more than the 32-bit delta-of-delta range
+    bool append(uint64_t t, float v);
+
+    // Write the header and CRC; the block can be stored after this
+    void finish();
+
+    uint16_t pointCount() const { return count; }
+    uint64_t firstTime() const { return tFirst; }
+    uint64_t lastTime() const { return tPrev; }
+
+private:
+    uint8_t* block;
+    uint32_t bitPos;
+    uint16_t count;
+    uint64_t tFirst;
+    uint64_t tPrev;
+    int64_t deltaPrev;
+    uint32_t vPrev;
+    uint8_t leadPrev;
+    uint8_t trailPrev;
+    float vMin;
+    float vMax;
+    float vSum;
+
+    bool put(uint32_t value, uint8_t bits);
+};
+
+// Iterates the points of a stored block
+class TsBlockReader {
+public:
+    TsBlockReader() : block(nullptr), bitPos(0), remaining(0) {}
+
+    // False if the block fails the header/CRC check
+    bool open(const uint8_t* buffer);
+
+    bool next(uint64_t& t, float& v);
+
+    const TsBlockHeader& header() const { return hdr; }
+
+private:
+    const uint8_t* block;
+    uint32_t bitPos;
+    uint16_t remaining;
+    bool first;
+    TsBlockHeader hdr;
+    uint64_t tPrev;
+    int64_t deltaPrev;
+    uint32_t vPrev;
+    uint8_t leadPrev;
+    uint8_t trailPrev;
+
+    uint32_t get(uint8_t bits);
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_TS_CODEC_H
@@ -0,0 +1,96 @@
+#include "ts_littlefs.h"
+
+#if defined(ESP32) || defined(ESP8266) || defined(ARDUINO_ARCH_RP2040)
+#include <LittleFS.h>
+#define POCKETOS_TS_HAS_LITTLEFS 1
+#else
+#define POCKETOS_TS_HAS_LITTLEFS 0
+#endif
+
+namespace PocketOS {
+
+uint64_t LittleFsTsFileSystem::uptimeMs() {
+    static uint32_t last = 0;
+    static uint32_t wraps = 0;
+    uint32_t now = millis();
+    if (now < last) {
+        wraps++;
+    }
+    last = now;
+    return ((uint64_t)wraps << 32) | now;
+}
+
+#if POCKETOS_TS_HAS_LITTLEFS
+
+bool LittleFsTsFileSystem::begin() {
+#ifdef ESP32
+    bool mounted = LittleFS.begin(true);  // Format on mount failure
+#else
+    bool mounted = LittleFS.begin();
+    if (!mounted) {
+        LittleFS.format();
+        mounted = LittleFS.begin();
+    }
+#endif
+    if (!mounted) {
+        return false;
+    }
+    if (!LittleFS.exists("/ts")) {
+        LittleFS.mkdir("/ts");
+    }
+    return true;
+}
+
+uint32_t LittleFsTsFileSystem::size(const char* path) {
+    if (!LittleFS.exists(path)) {
+        return 0;
+    }
+    File f = LittleFS.open(path, "r");
+    if (!f) {
+        return 0;
+    }
+    uint32_t n = f.size();
+    f.close();
+    return n;
+}
+
+bool LittleFsTsFileSystem::read(const char* path, uint32_t offset, uint8_t* buf, size_t len) {
+    File f = LittleFS.open(path, "r");
+    if (!f) {
+        return false;
+    }
+    bool ok = f.seek(offset) && f.read(buf, len) == len;
+    f.close();
+    return ok;
+}
+
+bool LittleFsTsFileSystem::append(const char* path, const uint8_t* buf, size_t len) {
+    File f = LittleFS.open(path, "a");
+    if (!f) {
+        return false;
+    }
+    bool ok = f.write(buf, len) == len;
+    f.close();
+    return ok;
+}
+
+bool LittleFsTsFileSystem::remove(const char* path) {
+    return LittleFS.remove(path);
+}
+
+bool LittleFsTsFileSystem::rename(const char* from, const char* to) {
+    return LittleFS.rename(from, to);
+}
+
+#else
+
+bool LittleFsTsFileSystem::begin() { return false; }
+uint32_t LittleFsTsFileSystem::size(const char*) { return 0; }
+bool LittleFsTsFileSystem::read(const char*, uint32_t, uint8_t*, size_t) { return false; }
+bool LittleFsTsFileSystem::append(const char*, const uint8_t*, size_t) { return false; }
+bool LittleFsTsFileSystem::remove(const char*) { return false; }
+bool LittleFsTsFileSystem::rename(const char*, const char*) { return false; }
+
+#endif
+
+} // namespace PocketOS
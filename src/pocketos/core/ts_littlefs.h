@@ -0,0 +1,32 @@
+#ifndef POCKETOS_TS_LITTLEFS_H
+#define POCKETOS_TS_LITTLEFS_H
+
+#include <Arduino.h>
+#include "timeseries_store.h"
+
+namespace PocketOS {
+
+/**
+ * LittleFS backend for TimeSeriesStore
+ *
+ * Mounts LittleFS (formatting it if the mount fails, as the ESP8266
+ * platform pack does) and creates /ts. Available on ESP32 (core 2.x),
+ * ESP8266 and RP2040; begin() fails elsewhere.
+ */
+class LittleFsTsFileSystem : public TsFileSystem {
+public:
+    bool begin();
+
+    uint32_t size(const char* path) override;
+    bool read(const char* path, uint32_t offset, uint8_t* buf, size_t len) override;
+    bool append(const char* path, const uint8_t* buf, size_t len) override;
+    bool remove(const char* path) override;
+    bool rename(const char* from, const char* to) override;
+
+    // millis() extended to 64 bits (call at least once per 49 days)
+    static uint64_t uptimeMs();
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_TS_LITTLEFS_H
@@ -461,6 +461,11 @@
 #define POCKETOS_DRIVER_TIER_QMC5883L POCKETOS_DRIVER_TIER
 #endif
 
+// HMC5883L Driver Tier (Magnetometer)
+#ifndef POCKETOS_DRIVER_TIER_HMC5883L
+#define POCKETOS_DRIVER_TIER_HMC5883L POCKETOS_DRIVER_TIER
+#endif
+
 // AS5600 Driver Tier (Magnetic rotary position sensor)
 #ifndef POCKETOS_DRIVER_TIER_AS5600
 #define POCKETOS_DRIVER_TIER_AS5600 POCKETOS_DRIVER_TIER
@@ -2451,6 +2456,29 @@
 #define POCKETOS_QMC5883L_ENABLE_REGISTER_ACCESS 0
 #endif
 
+// HMC5883L Feature Flags (Magnetometer)
+#if POCKETOS_DRIVER_TIER_HMC5883L >= POCKETOS_TIER_0
+#define POCKETOS_HMC5883L_ENABLE_BASIC_READ 1
+#else
+#define POCKETOS_HMC5883L_ENABLE_BASIC_READ 0
+#endif
+
+#if POCKETOS_DRIVER_TIER_HMC5883L >= POCKETOS_TIER_1
+#define POCKETOS_HMC5883L_ENABLE_ERROR_HANDLING 1
+#define POCKETOS_HMC5883L_ENABLE_LOGGING 1
+#define POCKETOS_HMC5883L_ENABLE_CONFIGURATION 1
+#else
+#define POCKETOS_HMC5883L_ENABLE_ERROR_HANDLING 0
+#define POCKETOS_HMC5883L_ENABLE_LOGGING 0
+#define POCKETOS_HMC5883L_ENABLE_CONFIGURATION 0
+#endif
+
+#if POCKETOS_DRIVER_TIER_HMC5883L >= POCKETOS_TIER_2
+#define POCKETOS_HMC5883L_ENABLE_REGISTER_ACCESS 1
+#else
+#define POCKETOS_HMC5883L_ENABLE_REGISTER_ACCESS 0
+#endif
+
 // AS5600 Feature Flags (Magnetic rotary position sensor)
 #if POCKETOS_DRIVER_TIER_AS5600 >= POCKETOS_TIER_0
 #define POCKETOS_AS5600_ENABLE_BASIC_READ 1
@@ -3396,6 +3424,7 @@
 #define POCKETOS_FT6206_TIER_NAME POCKETOS_TIER_NAME(POCKETOS_DRIVER_TIER_FT6206)
 #define POCKETOS_MAG3110_TIER_NAME POCKETOS_TIER_NAME(POCKETOS_DRIVER_TIER_MAG3110)
 #define POCKETOS_QMC5883L_TIER_NAME POCKETOS_TIER_NAME(POCKETOS_DRIVER_TIER_QMC5883L)
+#define POCKETOS_HMC5883L_TIER_NAME POCKETOS_TIER_NAME(POCKETOS_DRIVER_TIER_HMC5883L)
 #define POCKETOS_AS5600_TIER_NAME POCKETOS_TIER_NAME(POCKETOS_DRIVER_TIER_AS5600)
 #define POCKETOS_AS7262_TIER_NAME POCKETOS_TIER_NAME(POCKETOS_DRIVER_TIER_AS7262)
 #define POCKETOS_AS7263_TIER_NAME POCKETOS_TIER_NAME(POCKETOS_DRIVER_TIER_AS7263)
@@ -3720,6 +3749,10 @@
 #error "POCKETOS_DRIVER_TIER_QMC5883L must be 0, 1, or 2"
 #endif
 
+#if POCKETOS_DRIVER_TIER_HMC5883L < 0 || POCKETOS_DRIVER_TIER_HMC5883L > 2
+#error "POCKETOS_DRIVER_TIER_HMC5883L must be 0, 1, or 2"
+#endif
+
 #if POCKETOS_DRIVER_TIER_AS5600 < 0 || POCKETOS_DRIVER_TIER_AS5600 > 2
 #error "POCKETOS_DRIVER_TIER_AS5600 must be 0, 1, or 2"
 #endif
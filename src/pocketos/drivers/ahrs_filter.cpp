@@ -0,0 +1,450 @@
+#include "ahrs_filter.h"
+
+#include <math.h>
+
+namespace PocketOS {
+
+// ---------------------------------------------------------------------------
+// Q24 arithmetic
+// ---------------------------------------------------------------------------
+
+#define AHRS_Q24_ONE (1L << 24)
+
+static inline AhrsQ24 q24(int32_t raw) {
+    AhrsQ24 r;
+    r.v = raw;
+    return r;
+}
+
+static inline AhrsQ24 operator+(AhrsQ24 a, AhrsQ24 b) { return q24(a.v + b.v); }
+static inline AhrsQ24 operator-(AhrsQ24 a, AhrsQ24 b) { return q24(a.v - b.v); }
+static inline AhrsQ24 operator-(AhrsQ24 a) { return q24(-a.v); }
+static inline AhrsQ24 operator*(AhrsQ24 a, AhrsQ24 b) {
+    return q24((int32_t)(((int64_t)a.v * b.v + (1 << 23)) >> 24));
+}
+static inline AhrsQ24 operator*(int32_t k, AhrsQ24 a) { return q24(k * a.v); }
+static inline AhrsQ24 operator/(AhrsQ24 a, int32_t k) { return q24(a.v / k); }
+static inline AhrsQ24& operator+=(AhrsQ24& a, AhrsQ24 b) { a.v += b.v; return a; }
+static inline AhrsQ24& operator-=(AhrsQ24& a, AhrsQ24 b) { a.v -= b.v; return a; }
+
+// 1/sqrt(x) for x > 0: x = xn * 2^t with xn in [2^30, 2^32) and t even;
+// returns y (Q30, in (0.5, 1]) with 1/sqrt(x) = y * 2^(-30 - 15 - t/2)
+static uint32_t rsqrtQ30(uint64_t x, uint32_t& xn, int& t) {
+    static const uint32_t GUESS[12] = {
+        1012333500, 915690104, 842312387, 784150157, 736580814, 696735698,
+        662727842, 633258380, 607400100, 584471019, 563956835, 545461392
+    };
+
+    t = (63 - __builtin_clzll(x)) - 30;
+    if (t & 1) {
+        t--;
+    }
+    xn = (uint32_t)(t >= 0 ? x >> t : x << -t);
+
+    uint32_t y = GUESS[(xn >> 28) - 4];
+    for (uint8_t i = 0; i < 3; i++) {
+        uint64_t xy = ((uint64_t)xn * y) >> 30;
+        uint64_t xyy = (xy * y) >> 30;
+        y = (uint32_t)(((uint64_t)y * ((3ULL << 30) - xyy)) >> 31);
+    }
+    return y;
+}
+
+// in[0..n) (n <= 4, any scale) to unit length in Q24; false for zero
+static bool unitQ24(const int32_t* in, int32_t* out, uint8_t n) {
+    uint32_t peak = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        uint32_t mag = in[i] < 0 ? 0u - (uint32_t)in[i] : (uint32_t)in[i];
+        if (mag > peak) {
+            peak = mag;
+        }
+    }
+    if (peak == 0) {
+        return false;
+    }
+
+    // Keep the sum of squares below 2^58
+    uint8_t shift = 0;
+    while ((peak >> shift) >= (1UL << 28)) {
+        shift++;
+    }
+    int32_t x[4];
+    uint64_t sum = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        x[i] = in[i] >> shift;
+        sum += (uint64_t)((int64_t)x[i] * x[i]);
+    }
+    if (sum == 0) {
+        return false;
+    }
+
+    uint32_t xn;
+    int t;
+    uint32_t y = rsqrtQ30(sum, xn, t);
+    int rshift = 6 + 15 + t / 2;
+    for (uint8_t i = 0; i < n; i++) {
+        out[i] = (int32_t)(((int64_t)x[i] * y) >> rshift);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Numeric variants
+// ---------------------------------------------------------------------------
+
+template <typename T>
+struct AhrsNum;
+
+template <>
+struct AhrsNum<float> {
+    static const bool FIXED = false;
+
+    static float fromInt(int32_t i) { return (float)i; }
+    static float fromFloat(float f) { return f; }
+    static float toFloat(float x) { return x; }
+    static float sqrt(float x) { return x > 0 ? sqrtf(x) : 0.0f; }
+    static float gyro(int32_t raw, float scale, int64_t) { return raw * scale; }
+    static float dt(uint32_t us) { return us * 1e-6f; }
+
+    static bool unit(const int32_t in[3], float out[3]) {
+        if (in[0] == 0 && in[1] == 0 && in[2] == 0) {
+            return false;
+        }
+        float x = (float)in[0], y = (float)in[1], z = (float)in[2];
+        float r = 1.0f / sqrtf(x * x + y * y + z * z);
+        out[0] = x * r;
+        out[1] = y * r;
+        out[2] = z * r;
+        return true;
+    }
+
+    static bool normalise(float* v, uint8_t n) {
+        float sum = 0;
+        for (uint8_t i = 0; i < n; i++) {
+            sum += v[i] * v[i];
+        }
+        if (sum <= 0) {
+            return false;
+        }
+        float r = 1.0f / sqrtf(sum);
+        for (uint8_t i = 0; i < n; i++) {
+            v[i] *= r;
+        }
+        return true;
+    }
+};
+
+template <>
+struct AhrsNum<AhrsQ24> {
+    static const bool FIXED = true;
+
+    static AhrsQ24 fromInt(int32_t i) { return q24(i * AHRS_Q24_ONE); }
+    static AhrsQ24 fromFloat(float f) { return q24((int32_t)(f * 16777216.0f + (f < 0 ? -0.5f : 0.5f))); }
+    static float toFloat(AhrsQ24 x) { return x.v * (1.0f / 16777216.0f); }
+
+    static AhrsQ24 sqrt(AhrsQ24 x) {
+        if (x.v <= 0) {
+            return q24(0);
+        }
+        // sqrt(v) in Q24 = sqrt(raw * 2^24)
+        uint32_t xn;
+        int t;
+        uint32_t y = rsqrtQ30((uint64_t)x.v << 24, xn, t);
+        uint32_t root = (uint32_t)(((uint64_t)xn * y) >> 30);    // sqrt(xn / 2^30), Q30
+        return q24((int32_t)(root >> (15 - t / 2)));
+    }
+
+    static AhrsQ24 gyro(int32_t raw, float, int64_t scaleQ32) {
+        return q24((int32_t)((raw * scaleQ32 + (1 << 7)) >> 8));
+    }
+
+    // µs to seconds: 2^24 / 10^6 = 70368744 / 2^22
+    static AhrsQ24 dt(uint32_t us) {
+        return q24((int32_t)(((uint64_t)us * 70368744ULL + (1 << 21)) >> 22));
+    }
+
+    static bool unit(const int32_t in[3], AhrsQ24 out[3]) {
+        int32_t raw[3];
+        if (!unitQ24(in, raw, 3)) {
+            return false;
+        }
+        for (uint8_t i = 0; i < 3; i++) {
+            out[i].v = raw[i];
+        }
+        return true;
+    }
+
+    static bool normalise(AhrsQ24* v, uint8_t n) {
+        int32_t raw[4];
+        for (uint8_t i = 0; i < n; i++) {
+            raw[i] = v[i].v;
+        }
+        if (!unitQ24(raw, raw, n)) {
+            return false;
+        }
+        for (uint8_t i = 0; i < n; i++) {
+            v[i].v = raw[i];
+        }
+        return true;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// AhrsEngine
+// ---------------------------------------------------------------------------
+
+template <typename T, AhrsAlgorithm ALGORITHM>
+AhrsEngine<T, ALGORITHM>::AhrsEngine()
+    : useIntegral(false), gyroScaleF(0), gyroScaleQ32(0), startupUs(0), elapsedUs(0) {
+    configure(0.0f, AhrsGains());
+    reset();
+}
+
+template <typename T, AhrsAlgorithm ALGORITHM>
+bool AhrsEngine<T, ALGORITHM>::fixedPoint() const {
+    return AhrsNum<T>::FIXED;
+}
+
+template <typename T, AhrsAlgorithm ALGORITHM>
+const char* AhrsEngine<T, ALGORITHM>::name() const {
+    if (ALGORITHM == AhrsAlgorithm::MADGWICK) {
+        return fixedPoint() ? "madgwick_q" : "madgwick";
+    }
+    return fixedPoint() ? "mahony_q" : "mahony";
+}
+
+template <typename T, AhrsAlgorithm ALGORITHM>
+void AhrsEngine<T, ALGORITHM>::configure(float gyroScale, const AhrsGains& gains) {
+    typedef AhrsNum<T> N;
+
+    gyroScaleF = gyroScale;
+    gyroScaleQ32 = (int64_t)(gyroScale * 4294967296.0f + 0.5f);
+
+    float g = ALGORITHM == AhrsAlgorithm::MADGWICK ? gains.beta : 2.0f * gains.kp;
+    gain = N::fromFloat(g);
+    gainStartup = N::fromFloat(10.0f * g);
+    integralGain = N::fromFloat(2.0f * gains.ki);
+    useIntegral = ALGORITHM == AhrsAlgorithm::MAHONY && gains.ki > 0;
+    startupUs = gains.startupUs;
+}
+
+template <typename T, AhrsAlgorithm ALGORITHM>
+void AhrsEngine<T, ALGORITHM>::reset() {
+    typedef AhrsNum<T> N;
+
+    q0 = N::fromInt(1);
+    q1 = q2 = q3 = N::fromInt(0);
+    integral[0] = integral[1] = integral[2] = N::fromInt(0);
+    elapsedUs = 0;
+}
+
+template <typename T, AhrsAlgorithm ALGORITHM>
+void AhrsEngine<T, ALGORITHM>::update(const AhrsSample& sample, uint32_t dtUs) {
+    typedef AhrsNum<T> N;
+
+    T g[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        g[i] = N::gyro(sample.gyro[i], gyroScaleF, gyroScaleQ32);
+    }
+
+    T a[3];
+    T m[3];
+    bool haveAccel = N::unit(sample.accel, a);
+    bool haveMag = haveAccel && N::unit(sample.mag, m);
+
+    bool startup = elapsedUs < startupUs;
+    if (startup) {
+        elapsedUs += dtUs;
+    }
+
+    T dt = N::dt(dtUs);
+    if (ALGORITHM == AhrsAlgorithm::MADGWICK) {
+        madgwick(g, haveAccel ? a : nullptr, haveMag ? m : nullptr, dt, startup ? gainStartup : gain);
+    } else {
+        // The bias integral only runs once the startup transient is over
+        mahony(g, haveAccel ? a : nullptr, haveMag ? m : nullptr, dt, startup ? gainStartup : gain,
+               useIntegral && !startup);
+    }
+}
+
+// Madgwick, "An efficient orientation filter for inertial and
+// inertial/magnetic sensor arrays" (2010): gyroscope rate plus one
+// normalised gradient descent step towards the measured directions
+template <typename T, AhrsAlgorithm ALGORITHM>
+void AhrsEngine<T, ALGORITHM>::madgwick(const T g[3], const T* a, const T* m, T dt, T beta) {
+    typedef AhrsNum<T> N;
+    const T one = N::fromInt(1);
+    const T half = one / 2;
+
+    T qDot0 = (-(q1 * g[0]) - q2 * g[1] - q3 * g[2]) / 2;
+    T qDot1 = (q0 * g[0] + q2 * g[2] - q3 * g[1]) / 2;
+    T qDot2 = (q0 * g[1] - q1 * g[2] + q3 * g[0]) / 2;
+    T qDot3 = (q0 * g[2] + q1 * g[1] - q2 * g[0]) / 2;
+
+    if (a) {
+        const T ax = a[0], ay = a[1], az = a[2];
+        const T q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+        const T _2q0 = 2 * q0, _2q1 = 2 * q1, _2q2 = 2 * q2, _2q3 = 2 * q3;
+        T s[4];
+
+        if (m) {
+            const T mx = m[0], my = m[1], mz = m[2];
+            const T q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+            const T q1q2 = q1 * q2, q1q3 = q1 * q3, q2q3 = q2 * q3;
+            const T _2q0mx = _2q0 * mx, _2q0my = _2q0 * my, _2q0mz = _2q0 * mz, _2q1mx = _2q1 * mx;
+            const T _2q0q2 = _2q0 * q2, _2q2q3 = _2q2 * q3;
+
+            // Earth field direction: horizontal (bx) and vertical (bz) parts
+            T hx = mx * q0q0 - _2q0my * q3 + _2q0mz * q2 + mx * q1q1 + _2q1 * my * q2 + _2q1 * mz * q3 -
+                   mx * q2q2 - mx * q3q3;
+            T hy = _2q0mx * q3 + my * q0q0 - _2q0mz * q1 + _2q1mx * q2 - my * q1q1 + my * q2q2 +
+                   _2q2 * mz * q3 - my * q3q3;
+            const T _2bx = N::sqrt(hx * hx + hy * hy);
+            const T _2bz = -(_2q0mx * q2) + _2q0my * q1 + mz * q0q0 + _2q1mx * q3 - mz * q1q1 +
+                           _2q2 * my * q3 - mz * q2q2 + mz * q3q3;
+            const T _4bx = 2 * _2bx, _4bz = 2 * _2bz;
+
+            // Objective function residuals
+            const T fax = 2 * q1q3 - _2q0q2 - ax;
+            const T fay = 2 * q0q1 + _2q2q3 - ay;
+            const T faz = one - 2 * q1q1 - 2 * q2q2 - az;
+            const T fmx = _2bx * (half - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx;
+            const T fmy = _2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my;
+            const T fmz = _2bx * (q0q2 + q1q3) + _2bz * (half - q1q1 - q2q2) - mz;
+
+            s[0] = -(_2q2 * fax) + _2q1 * fay - _2bz * q2 * fmx + (_2bz * q1 - _2bx * q3) * fmy +
+                   _2bx * q2 * fmz;
+            s[1] = _2q3 * fax + _2q0 * fay - 4 * q1 * faz + _2bz * q3 * fmx + (_2bx * q2 + _2bz * q0) * fmy +
+                   (_2bx * q3 - _4bz * q1) * fmz;
+            s[2] = -(_2q0 * fax) + _2q3 * fay - 4 * q2 * faz + (-(_4bx * q2) - _2bz * q0) * fmx +
+                   (_2bx * q1 + _2bz * q3) * fmy + (_2bx * q0 - _4bz * q2) * fmz;
+            s[3] = _2q1 * fax + _2q2 * fay + (_2bz * q1 - _4bx * q3) * fmx + (_2bz * q2 - _2bx * q0) * fmy +
+                   _2bx * q1 * fmz;
+        } else {
+            const T _4q0 = 4 * q0, _4q1 = 4 * q1, _4q2 = 4 * q2;
+            const T _8q1 = 8 * q1, _8q2 = 8 * q2;
+
+            s[0] = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+            s[1] = _4q1 * q3q3 - _2q3 * ax + 4 * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 +
+                   _4q1 * az;
+            s[2] = 4 * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 +
+                   _4q2 * az;
+            s[3] = 4 * q1q1 * q3 - _2q1 * ax + 4 * q2q2 * q3 - _2q2 * ay;
+        }
+
+        if (N::normalise(s, 4)) {
+            qDot0 -= beta * s[0];
+            qDot1 -= beta * s[1];
+            qDot2 -= beta * s[2];
+            qDot3 -= beta * s[3];
+        }
+    }
+
+    T q[4] = { q0 + qDot0 * dt, q1 + qDot1 * dt, q2 + qDot2 * dt, q3 + qDot3 * dt };
+    if (N::normalise(q, 4)) {
+        q0 = q[0];
+        q1 = q[1];
+        q2 = q[2];
+        q3 = q[3];
+    }
+}
+
+// Mahony, "Nonlinear complementary filters on the special orthogonal
+// group" (2008): the cross product of measured and estimated directions
+// feeds back into the gyroscope rate through a PI controller
+template <typename T, AhrsAlgorithm ALGORITHM>
+void AhrsEngine<T, ALGORITHM>::mahony(T g[3], const T* a, const T* m, T dt, T kp, bool integrate) {
+    typedef AhrsNum<T> N;
+    const T half = N::fromInt(1) / 2;
+
+    const T q0q0 = q0 * q0, q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+    const T q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3;
+    const T q2q2 = q2 * q2, q2q3 = q2 * q3, q3q3 = q3 * q3;
+
+    if (a) {
+        const T ax = a[0], ay = a[1], az = a[2];
+
+        // Estimated gravity (half), error = measured x estimated
+        const T vx = q1q3 - q0q2;
+        const T vy = q0q1 + q2q3;
+        const T vz = q0q0 - half + q3q3;
+        T ex = ay * vz - az * vy;
+        T ey = az * vx - ax * vz;
+        T ez = ax * vy - ay * vx;
+
+        if (m) {
+            const T mx = m[0], my = m[1], mz = m[2];
+
+            // Field in the earth frame, then its estimated direction (half)
+            T hx = 2 * (mx * (half - q2q2 - q3q3) + my * (q1q2 - q0q3) + mz * (q1q3 + q0q2));
+            T hy = 2 * (mx * (q1q2 + q0q3) + my * (half - q1q1 - q3q3) + mz * (q2q3 - q0q1));
+            T bx = N::sqrt(hx * hx + hy * hy);
+            T bz = 2 * (mx * (q1q3 - q0q2) + my * (q2q3 + q0q1) + mz * (half - q1q1 - q2q2));
+            T wx = bx * (half - q2q2 - q3q3) + bz * (q1q3 - q0q2);
+            T wy = bx * (q1q2 - q0q3) + bz * (q0q1 + q2q3);
+            T wz = bx * (q0q2 + q1q3) + bz * (half - q1q1 - q2q2);
+
+            ex += my * wz - mz * wy;
+            ey += mz * wx - mx * wz;
+            ez += mx * wy - my * wx;
+        }
+
+        if (integrate) {
+            integral[0] += integralGain * ex * dt;
+            integral[1] += integralGain * ey * dt;
+            integral[2] += integralGain * ez * dt;
+        }
+        g[0] += kp * ex;
+        g[1] += kp * ey;
+        g[2] += kp * ez;
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        g[i] = (g[i] + integral[i]) * dt / 2;
+    }
+
+    T q[4] = {
+        q0 + (-(q1 * g[0]) - q2 * g[1] - q3 * g[2]),
+        q1 + (q0 * g[0] + q2 * g[2] - q3 * g[1]),
+        q2 + (q0 * g[1] - q1 * g[2] + q3 * g[0]),
+        q3 + (q0 * g[2] + q1 * g[1] - q2 * g[0])
+    };
+    if (N::normalise(q, 4)) {
+        q0 = q[0];
+        q1 = q[1];
+        q2 = q[2];
+        q3 = q[3];
+    }
+}
+
+template <typename T, AhrsAlgorithm ALGORITHM>
+void AhrsEngine<T, ALGORITHM>::quaternion(float q[4]) const {
+    typedef AhrsNum<T> N;
+
+    q[0] = N::toFloat(q0);
+    q[1] = N::toFloat(q1);
+    q[2] = N::toFloat(q2);
+    q[3] = N::toFloat(q3);
+}
+
+template class AhrsEngine<float, AhrsAlgorithm::MADGWICK>;
+template class AhrsEngine<float, AhrsAlgorithm::MAHONY>;
+template class AhrsEngine<AhrsQ24, AhrsAlgorithm::MADGWICK>;
+template class AhrsEngine<AhrsQ24, AhrsAlgorithm::MAHONY>;
+
+void ahrsEuler(const float q[4], float& roll, float& pitch, float& yaw) {
+    const float RAD_TO_DEG_F = 57.29577951f;
+
+    float sinp = 2.0f * (q[0] * q[2] - q[3] * q[1]);
+    if (sinp > 1.0f) {
+        sinp = 1.0f;
+    } else if (sinp < -1.0f) {
+        sinp = -1.0f;
+    }
+
+    roll = atan2f(q[0] * q[1] + q[2] * q[3], 0.5f - q[1] * q[1] - q[2] * q[2]) * RAD_TO_DEG_F;
+    pitch = asinf(sinp) * RAD_TO_DEG_F;
+    yaw = atan2f(q[1] * q[2] + q[0] * q[3], 0.5f - q[2] * q[2] - q[3] * q[3]) * RAD_TO_DEG_F;
+}
+
+} // namespace PocketOS
@@ -0,0 +1,125 @@
+#ifndef POCKETOS_AHRS_FILTER_H
+#define POCKETOS_AHRS_FILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PocketOS {
+
+/**
+ * AHRS Filters
+ *
+ * Orientation estimation from accelerometer, gyroscope and (optionally)
+ * magnetometer samples: Madgwick (gradient descent) and Mahony
+ * (complementary PI), each in two numeric variants sharing one
+ * implementation:
+ *
+ *   MadgwickAhrs / MahonyAhrs    - float
+ *   MadgwickAhrsQ / MahonyAhrsQ  - Q24 fixed point (int32, 64-bit
+ *                                  products, integer inverse square root)
+ *                                  for cores without an FPU (ESP8266)
+ *
+ * Samples are raw integer counts: accelerometer and magnetometer only
+ * need a direction, so any scale works; the gyroscope scale (rad/s per
+ * count) is set once by configure(). The fixed-point variants use no
+ * float arithmetic per update.
+ *
+ * Frame: x = magnetic north, z = up (a level, stationary sensor measures
+ * +1 g on z). The quaternion (w, x, y, z) rotates sensor axes into that
+ * frame; yaw is counter-clockwise from north. Without a magnetometer,
+ * yaw is the integrated gyroscope heading.
+ *
+ * No Arduino dependency: exercised on the host (tools/ahrsbench).
+ */
+
+enum class AhrsAlgorithm : uint8_t {
+    MADGWICK = 0,
+    MAHONY
+};
+
+struct AhrsSample {
+    int32_t accel[3];       // Any scale; all zero = no accelerometer update
+    int32_t gyro[3];        // Counts; rad/s = gyro * gyroScale
+    int32_t mag[3];         // Any scale, in the accel/gyro axes; all zero = none
+    uint32_t timestampUs;
+};
+
+struct AhrsGains {
+    float beta;             // Madgwick gradient step (rad/s)
+    float kp;               // Mahony proportional gain
+    float ki;               // Mahony integral gain (gyro bias), 0 = off
+    uint32_t startupUs;     // Gains are x10 for this long after reset()
+
+    AhrsGains() : beta(0.1f), kp(0.5f), ki(0.0f), startupUs(3000000) {}
+};
+
+class AhrsFilter {
+public:
+    virtual ~AhrsFilter() {}
+
+    virtual AhrsAlgorithm algorithm() const = 0;
+    virtual bool fixedPoint() const = 0;
+    virtual const char* name() const = 0;   // "madgwick", "mahony_q", ...
+
+    // Gyroscope scale and gains (float maths here only)
+    virtual void configure(float gyroScale, const AhrsGains& gains) = 0;
+    // Identity orientation, integral terms cleared, startup gains
+    virtual void reset() = 0;
+    // One sample dtUs after the previous one
+    virtual void update(const AhrsSample& sample, uint32_t dtUs) = 0;
+
+    virtual void quaternion(float q[4]) const = 0;
+};
+
+// Q8.24: range ±128, resolution 6e-8
+struct AhrsQ24 {
+    int32_t v;
+};
+
+template <typename T, AhrsAlgorithm ALGORITHM>
+class AhrsEngine : public AhrsFilter {
+public:
+    AhrsEngine();
+
+    AhrsAlgorithm algorithm() const override { return ALGORITHM; }
+    bool fixedPoint() const override;
+    const char* name() const override;
+
+    void configure(float gyroScale, const AhrsGains& gains) override;
+    void reset() override;
+    void update(const AhrsSample& sample, uint32_t dtUs) override;
+
+    void quaternion(float q[4]) const override;
+
+private:
+    T q0, q1, q2, q3;
+    T integral[3];          // Mahony gyro bias estimate (rad/s)
+    T gain;                 // beta, or 2 Kp
+    T gainStartup;
+    T integralGain;         // 2 Ki
+    bool useIntegral;
+    float gyroScaleF;
+    int64_t gyroScaleQ32;   // rad/s per count, Q32 (fixed point)
+    uint32_t startupUs;
+    uint32_t elapsedUs;
+
+    void madgwick(const T g[3], const T* a, const T* m, T dt, T beta);
+    void mahony(T g[3], const T* a, const T* m, T dt, T kp, bool integrate);
+};
+
+typedef AhrsEngine<float, AhrsAlgorithm::MADGWICK> MadgwickAhrs;
+typedef AhrsEngine<float, AhrsAlgorithm::MAHONY> MahonyAhrs;
+typedef AhrsEngine<AhrsQ24, AhrsAlgorithm::MADGWICK> MadgwickAhrsQ;
+typedef AhrsEngine<AhrsQ24, AhrsAlgorithm::MAHONY> MahonyAhrsQ;
+
+extern template class AhrsEngine<float, AhrsAlgorithm::MADGWICK>;
+extern template class AhrsEngine<float, AhrsAlgorithm::MAHONY>;
+extern template class AhrsEngine<AhrsQ24, AhrsAlgorithm::MADGWICK>;
+extern template class AhrsEngine<AhrsQ24, AhrsAlgorithm::MAHONY>;
+
+// Roll, pitch and yaw in degrees (ZYX) from a quaternion (w, x, y, z)
+void ahrsEuler(const float q[4], float& roll, float& pitch, float& yaw);
+
+} // namespace PocketOS
+
+#endif // POCKETOS_AHRS_FILTER_H
@@ -0,0 +1,347 @@
+#include "ahrs_service.h"
+#include "../core/logger.h"
+
+namespace PocketOS {
+
+// ---------------------------------------------------------------------------
+// AhrsSource
+// ---------------------------------------------------------------------------
+
+AhrsSource::AhrsSource() {
+    magAxes[0] = 1;
+    magAxes[1] = 2;
+    magAxes[2] = 3;
+}
+
+bool AhrsSource::setMagAxes(int8_t x, int8_t y, int8_t z) {
+    const int8_t axes[3] = { x, y, z };
+    uint8_t seen = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        int8_t a = axes[i] < 0 ? -axes[i] : axes[i];
+        if (a < 1 || a > 3 || (seen & (1 << a))) {
+            return false;
+        }
+        seen |= 1 << a;
+    }
+    magAxes[0] = x;
+    magAxes[1] = y;
+    magAxes[2] = z;
+    return true;
+}
+
+void AhrsSource::fromSI(AhrsSample& sample, float ax, float ay, float az, float gx, float gy, float gz,
+                        float mx, float my, float mz) const {
+    sample.accel[0] = (int32_t)(ax * AHRS_SI_ACCEL_COUNTS);
+    sample.accel[1] = (int32_t)(ay * AHRS_SI_ACCEL_COUNTS);
+    sample.accel[2] = (int32_t)(az * AHRS_SI_ACCEL_COUNTS);
+    sample.gyro[0] = (int32_t)(gx * AHRS_SI_GYRO_COUNTS);
+    sample.gyro[1] = (int32_t)(gy * AHRS_SI_GYRO_COUNTS);
+    sample.gyro[2] = (int32_t)(gz * AHRS_SI_GYRO_COUNTS);
+
+    const float m[3] = { mx, my, mz };
+    for (uint8_t i = 0; i < 3; i++) {
+        int8_t a = magAxes[i];
+        float v = m[(a < 0 ? -a : a) - 1];
+        sample.mag[i] = (int32_t)((a < 0 ? -v : v) * AHRS_SI_MAG_COUNTS);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// AhrsService
+// ---------------------------------------------------------------------------
+
+AhrsService::AhrsService(AhrsSource& source)
+    : source_(source), active_(&madgwick_), useMag_(true), pollUs_(POCKETOS_AHRS_POLL_US),
+      lastPollUs_(0), lastSampleUs_(0), haveSample_(false), pollFailures_(0),
+      roll_(0), pitch_(0), yaw_(0), updates_(0),
+      windowStart_(0), windowUpdates_(0), windowFuseUs_(0), rateHz_(0), usPerUpdate_(0) {
+    AhrsFilter* initial = findFilter(POCKETOS_AHRS_DEFAULT_FILTER);
+    if (initial) {
+        active_ = initial;
+    }
+    q_[0] = 1;
+    q_[1] = q_[2] = q_[3] = 0;
+}
+
+bool AhrsService::init() {
+    if (source_.gyroScale() <= 0) {
+        Logger::error("AHRS: Source not ready (no gyro scale)");
+        return false;
+    }
+    configureAll();
+    reset();
+    Logger::info((String("AHRS: ") + active_->name() + ", poll " + String(pollUs_) + " us").c_str());
+    return true;
+}
+
+void AhrsService::tick() {
+    unsigned long now = micros();
+    if (now - lastPollUs_ < pollUs_) {
+        return;
+    }
+    lastPollUs_ = now;
+
+    if (!source_.poll()) {
+        pollFailures_++;
+        return;
+    }
+
+    AhrsSample sample;
+    uint32_t fused = 0;
+    unsigned long start = micros();
+    while (source_.next(sample)) {
+        if (!useMag_) {
+            sample.mag[0] = sample.mag[1] = sample.mag[2] = 0;
+        }
+        uint32_t dt = 0;
+        if (haveSample_) {
+            dt = sample.timestampUs - lastSampleUs_;
+            if (dt > POCKETOS_AHRS_MAX_DT_US) {
+                dt = 0;
+            }
+        }
+        lastSampleUs_ = sample.timestampUs;
+        haveSample_ = true;
+
+        active_->update(sample, dt);
+        fused++;
+    }
+    if (fused == 0) {
+        return;
+    }
+    windowFuseUs_ += (uint32_t)(micros() - start);
+    updates_ += fused;
+    windowUpdates_ += fused;
+
+    active_->quaternion(q_);
+    ahrsEuler(q_, roll_, pitch_, yaw_);
+
+    unsigned long nowMs = millis();
+    if (nowMs - windowStart_ >= 1000) {
+        rateHz_ = windowUpdates_ * 1000.0f / (float)(nowMs - windowStart_);
+        usPerUpdate_ = (float)windowFuseUs_ / (float)windowUpdates_;
+        windowStart_ = nowMs;
+        windowUpdates_ = 0;
+        windowFuseUs_ = 0;
+    }
+}
+
+void AhrsService::shutdown() {
+    haveSample_ = false;
+}
+
+AhrsFilter* AhrsService::findFilter(const String& name) {
+    AhrsFilter* filters[4] = { &madgwick_, &mahony_, &madgwickQ_, &mahonyQ_ };
+    for (uint8_t i = 0; i < 4; i++) {
+        if (name == filters[i]->name()) {
+            return filters[i];
+        }
+    }
+    return nullptr;
+}
+
+void AhrsService::configureAll() {
+    float scale = source_.gyroScale();
+    madgwick_.configure(scale, gains_);
+    mahony_.configure(scale, gains_);
+    madgwickQ_.configure(scale, gains_);
+    mahonyQ_.configure(scale, gains_);
+}
+
+bool AhrsService::setFilter(const String& name) {
+    AhrsFilter* filter = findFilter(name);
+    if (!filter) {
+        return false;
+    }
+    active_ = filter;
+    active_->configure(source_.gyroScale(), gains_);
+    reset();
+    return true;
+}
+
+void AhrsService::setGains(const AhrsGains& gains) {
+    gains_ = gains;
+    // Keeps the estimate; the startup boost only applies after reset()
+    active_->configure(source_.gyroScale(), gains_);
+}
+
+bool AhrsService::setPollInterval(uint32_t us) {
+    if (us < 1000 || us > 1000000) {
+        return false;
+    }
+    pollUs_ = us;
+    return true;
+}
+
+void AhrsService::reset() {
+    active_->reset();
+    active_->quaternion(q_);
+    ahrsEuler(q_, roll_, pitch_, yaw_);
+    haveSample_ = false;
+    windowStart_ = millis();
+    windowUpdates_ = 0;
+    windowFuseUs_ = 0;
+}
+
+void AhrsService::quaternion(float q[4]) const {
+    for (uint8_t i = 0; i < 4; i++) {
+        q[i] = q_[i];
+    }
+}
+
+CapabilitySchema AhrsService::getSchema() const {
+    CapabilitySchema schema;
+
+    schema.addSignal("qw", ParamType::FLOAT, false, "");
+    schema.addSignal("qx", ParamType::FLOAT, false, "");
+    schema.addSignal("qy", ParamType::FLOAT, false, "");
+    schema.addSignal("qz", ParamType::FLOAT, false, "");
+    schema.addSignal("roll", ParamType::FLOAT, false, "deg");
+    schema.addSignal("pitch", ParamType::FLOAT, false, "deg");
+    schema.addSignal("yaw", ParamType::FLOAT, false, "deg");
+    schema.addSignal("updates", ParamType::COUNTER, false, "");
+    schema.addSignal("rate_hz", ParamType::FLOAT, false, "Hz");
+    schema.addSignal("us_per_update", ParamType::FLOAT, false, "us");
+    schema.addSignal("poll_failures", ParamType::COUNTER, false, "");
+
+    schema.addSetting("filter", ParamType::ENUM, true, 0, 0, 0, "madgwick,mahony,madgwick_q,mahony_q");
+    schema.addSetting("beta", ParamType::FLOAT, true, 0, 2, 0.01f, "rad/s");
+    schema.addSetting("kp", ParamType::FLOAT, true, 0, 10, 0.05f, "");
+    schema.addSetting("ki", ParamType::FLOAT, true, 0, 1, 0.01f, "");
+    schema.addSetting("use_mag", ParamType::BOOL, true, 0, 1, 1, "");
+    schema.addSetting("poll_us", ParamType::INT, true, 1000, 1000000, 1000, "us");
+
+    schema.addCommand("reset", "");
+
+    return schema;
+}
+
+String AhrsService::getParameter(const String& name) {
+    if (name == "qw") {
+        return String(q_[0], 5);
+    } else if (name == "qx") {
+        return String(q_[1], 5);
+    } else if (name == "qy") {
+        return String(q_[2], 5);
+    } else if (name == "qz") {
+        return String(q_[3], 5);
+    } else if (name == "roll") {
+        return String(roll_, 2);
+    } else if (name == "pitch") {
+        return String(pitch_, 2);
+    } else if (name == "yaw") {
+        return String(yaw_, 2);
+    } else if (name == "updates") {
+        return String(updates_);
+    } else if (name == "rate_hz") {
+        return String(rateHz_, 1);
+    } else if (name == "us_per_update") {
+        return String(usPerUpdate_, 1);
+    } else if (name == "poll_failures") {
+        return String(pollFailures_);
+    } else if (name == "filter") {
+        return active_->name();
+    } else if (name == "beta") {
+        return String(gains_.beta, 3);
+    } else if (name == "kp") {
+        return String(gains_.kp, 3);
+    } else if (name == "ki") {
+        return String(gains_.ki, 3);
+    } else if (name == "use_mag") {
+        return useMag_ ? "1" : "0";
+    } else if (name == "poll_us") {
+        return String(pollUs_);
+    }
+    return "";
+}
+
+bool AhrsService::setParameter(const String& name, const String& value) {
+    if (name == "filter") {
+        return setFilter(value);
+    } else if (name == "beta" || name == "kp" || name == "ki") {
+        float v = value.toFloat();
+        if (v < 0 || v > (name == "kp" ? 10.0f : 2.0f)) {
+            return false;
+        }
+        AhrsGains gains = gains_;
+        if (name == "beta") {
+            gains.beta = v;
+        } else if (name == "kp") {
+            gains.kp = v;
+        } else {
+            gains.ki = v;
+        }
+        setGains(gains);
+        return true;
+    } else if (name == "use_mag") {
+        setUseMagnetometer(value == "1" || value == "true" || value == "on");
+        return true;
+    } else if (name == "poll_us") {
+        long us = value.toInt();
+        return us > 0 && setPollInterval((uint32_t)us);
+    } else if (name == "reset") {
+        reset();
+        return true;
+    }
+    return false;
+}
+
+float AhrsService::benchmark(uint32_t updates) {
+    if (updates == 0) {
+        return 0;
+    }
+
+    // A slowly tumbling sensor at 200 Hz: gravity and a 60° dipping field
+    // in the sensor frame, plus a constant rate (counts as fromSI() makes)
+    const uint8_t SAMPLES = 64;
+    AhrsSample* samples = (AhrsSample*)malloc(SAMPLES * sizeof(AhrsSample));
+    if (!samples) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        float a = i * 0.05f;
+        float s = sinf(a), c = cosf(a);
+        samples[i].accel[0] = (int32_t)(9.81f * s * AHRS_SI_ACCEL_COUNTS);
+        samples[i].accel[1] = 0;
+        samples[i].accel[2] = (int32_t)(9.81f * c * AHRS_SI_ACCEL_COUNTS);
+        samples[i].gyro[0] = (int32_t)(0.02f * AHRS_SI_GYRO_COUNTS);
+        samples[i].gyro[1] = (int32_t)(0.25f * AHRS_SI_GYRO_COUNTS);
+        samples[i].gyro[2] = (int32_t)(-0.01f * AHRS_SI_GYRO_COUNTS);
+        samples[i].mag[0] = (int32_t)((25.0f * c + 43.3f * s) * AHRS_SI_MAG_COUNTS);
+        samples[i].mag[1] = (int32_t)(2.0f * AHRS_SI_MAG_COUNTS);
+        samples[i].mag[2] = (int32_t)((-43.3f * c + 25.0f * s) * AHRS_SI_MAG_COUNTS);
+        samples[i].timestampUs = i * 5000;
+    }
+
+    AhrsFilter* filters[4] = { &madgwick_, &mahony_, &madgwickQ_, &mahonyQ_ };
+    float selected = 0;
+    for (uint8_t f = 0; f < 4; f++) {
+        AhrsFilter* filter = filters[f];
+        filter->configure(1.0f / AHRS_SI_GYRO_COUNTS, gains_);
+        filter->reset();
+
+        unsigned long start = micros();
+        for (uint32_t n = 0; n < updates; n++) {
+            filter->update(samples[n % SAMPLES], 5000);
+            if ((n & 1023) == 1023) {
+                yield();
+            }
+        }
+        unsigned long elapsed = micros() - start;
+
+        float rate = elapsed > 0 ? updates * 1000000.0f / (float)elapsed : 0;
+        Logger::info((String("AHRS: ") + filter->name() + " " + String(rate, 0) + " updates/s (" +
+                      String((float)elapsed / (float)updates, 1) + " us/update)").c_str());
+        if (filter == active_) {
+            selected = rate;
+        }
+    }
+    free(samples);
+
+    // The benchmark disturbed every filter
+    configureAll();
+    reset();
+    return selected;
+}
+
+} // namespace PocketOS
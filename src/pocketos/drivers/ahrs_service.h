@@ -0,0 +1,268 @@
+#ifndef POCKETOS_AHRS_SERVICE_H
+#define POCKETOS_AHRS_SERVICE_H
+
+#include <Arduino.h>
+#include "../core/service_manager.h"
+#include "../core/capability_schema.h"
+#include "ahrs_filter.h"
+#include "imu_fifo.h"
+
+namespace PocketOS {
+
+// Filter selected by init(): fixed point where there is no FPU
+// Can be overridden via build flags: -DPOCKETOS_AHRS_DEFAULT_FILTER=\"mahony\"
+#ifndef POCKETOS_AHRS_DEFAULT_FILTER
+#if defined(ESP8266)
+#define POCKETOS_AHRS_DEFAULT_FILTER "madgwick_q"
+#else
+#define POCKETOS_AHRS_DEFAULT_FILTER "madgwick"
+#endif
+#endif
+
+// Source poll interval (FIFO sources deliver every batched sample)
+#ifndef POCKETOS_AHRS_POLL_US
+#define POCKETOS_AHRS_POLL_US 10000
+#endif
+
+// Longer gaps between samples are not integrated (stalled source)
+#ifndef POCKETOS_AHRS_MAX_DT_US
+#define POCKETOS_AHRS_MAX_DT_US 100000
+#endif
+
+/**
+ * AHRS Sample Source
+ *
+ * Feeds AhrsService from one or two sensor drivers. poll() reads the
+ * device(s) once per service poll; next() then hands out the pending
+ * samples, oldest first. Drivers that report SI units are converted to
+ * fixed scales (AHRS_SI_*); FIFO drivers hand over raw ring counts.
+ */
+
+// Counts per unit for sources built on readData() (m/s², rad/s, µT)
+#define AHRS_SI_ACCEL_COUNTS 1024.0f
+#define AHRS_SI_GYRO_COUNTS 65536.0f
+#define AHRS_SI_MAG_COUNTS 1024.0f
+
+class AhrsSource {
+public:
+    AhrsSource();
+    virtual ~AhrsSource() {}
+
+    virtual bool poll() = 0;
+    virtual bool next(AhrsSample& sample) = 0;
+    virtual float gyroScale() const = 0;    // rad/s per gyro count
+
+    // Magnetometer axes in accel/gyro terms: 1..3 = x, y, z, negative
+    // = reversed. Identity by default; the LSM9DS1 needs (-1, 2, 3).
+    bool setMagAxes(int8_t x, int8_t y, int8_t z);
+
+protected:
+    int8_t magAxes[3];
+
+    void fromSI(AhrsSample& sample, float ax, float ay, float az, float gx, float gy, float gz,
+                float mx, float my, float mz) const;
+};
+
+// One 9-axis driver with SI readData() (LSM9DS1, ICM20948)
+template <typename TDriver>
+class AhrsDriverSource : public AhrsSource {
+public:
+    explicit AhrsDriverSource(TDriver& driver) : driver_(driver), pending_(false) {}
+
+    bool poll() override {
+        auto data = driver_.readData();
+        if (!data.valid) {
+            return false;
+        }
+        fromSI(sample_, data.accel_x, data.accel_y, data.accel_z, data.gyro_x, data.gyro_y, data.gyro_z,
+               data.mag_x, data.mag_y, data.mag_z);
+        sample_.timestampUs = micros();
+        pending_ = true;
+        return true;
+    }
+
+    bool next(AhrsSample& sample) override {
+        if (!pending_) {
+            return false;
+        }
+        sample = sample_;
+        pending_ = false;
+        return true;
+    }
+
+    float gyroScale() const override { return 1.0f / AHRS_SI_GYRO_COUNTS; }
+
+private:
+    TDriver& driver_;
+    AhrsSample sample_;
+    bool pending_;
+};
+
+// Accel + mag and gyro on separate chips (FXOS8700CQ + FXAS21002C)
+template <typename TAccelMag, typename TGyro>
+class AhrsPairSource : public AhrsSource {
+public:
+    AhrsPairSource(TAccelMag& accelMag, TGyro& gyro)
+        : accelMag_(accelMag), gyro_(gyro), pending_(false) {}
+
+    bool poll() override {
+        auto am = accelMag_.readData();
+        auto g = gyro_.readData();
+        if (!am.valid || !g.valid) {
+            return false;
+        }
+        fromSI(sample_, am.accel_x, am.accel_y, am.accel_z, g.gyro_x, g.gyro_y, g.gyro_z,
+               am.mag_x, am.mag_y, am.mag_z);
+        sample_.timestampUs = micros();
+        pending_ = true;
+        return true;
+    }
+
+    bool next(AhrsSample& sample) override {
+        if (!pending_) {
+            return false;
+        }
+        sample = sample_;
+        pending_ = false;
+        return true;
+    }
+
+    float gyroScale() const override { return 1.0f / AHRS_SI_GYRO_COUNTS; }
+
+private:
+    TAccelMag& accelMag_;
+    TGyro& gyro_;
+    AhrsSample sample_;
+    bool pending_;
+};
+
+// FIFO-batched IMU (LSM6DSOX, ISM330DHCX, LSM6DS33, ICM20948): every
+// sample in the driver's ring with its sensor timestamp, no magnetometer.
+// The device may stay bound: registry polls also land in the ring.
+template <typename TDriver>
+class AhrsFifoSource : public AhrsSource {
+public:
+    explicit AhrsFifoSource(TDriver& driver) : driver_(driver) {}
+
+    bool poll() override {
+        if (!driver_.isInitialized()) {
+            return false;
+        }
+        driver_.pollFifo();
+        return true;
+    }
+
+    bool next(AhrsSample& sample) override {
+        ImuSampleRing& ring = driver_.samples();
+        if (ring.available() == 0) {
+            return false;
+        }
+        for (uint8_t i = 0; i < 3; i++) {
+            sample.accel[i] = ring.channel((ImuAxis)(IMU_ACCEL_X + i))[0];
+            sample.gyro[i] = ring.channel((ImuAxis)(IMU_GYRO_X + i))[0];
+            sample.mag[i] = 0;
+        }
+        sample.timestampUs = ring.timestamps()[0];
+        ring.consume(1);
+        return true;
+    }
+
+    float gyroScale() const override { return driver_.gyroScale(); }
+
+private:
+    TDriver& driver_;
+};
+
+/**
+ * AHRS Service
+ *
+ * Sensor fusion stage: every POCKETOS_AHRS_POLL_US it polls the source,
+ * runs each pending sample through the selected filter (timestamps give
+ * the integration step), and publishes the quaternion and Euler angles
+ * as signals (getParameter()). Filters: madgwick, mahony, and the Q24
+ * fixed-point madgwick_q and mahony_q.
+ *
+ *   LSM9DS1Driver imu;
+ *   AhrsDriverSource<LSM9DS1Driver> source(imu);
+ *   AhrsService ahrs(source);
+ *
+ *   imu.init(0x6B);
+ *   source.setMagAxes(-1, 2, 3);
+ *   ServiceManager::registerService(&ahrs);
+ *   ServiceManager::startService("ahrs");
+ *   ahrs.getParameter("yaw");
+ */
+class AhrsService : public Service {
+public:
+    explicit AhrsService(AhrsSource& source);
+
+    bool init() override;
+    void tick() override;
+    void shutdown() override;
+    const char* getName() const override { return "ahrs"; }
+    uint32_t getTickInterval() const override { return 1; }  // Polls on its own interval
+
+    // "madgwick", "mahony", "madgwick_q", "mahony_q"; resets the estimate
+    bool setFilter(const String& name);
+    AhrsFilter& filter() { return *active_; }
+
+    void setGains(const AhrsGains& gains);
+    const AhrsGains& gains() const { return gains_; }
+    void setUseMagnetometer(bool use) { useMag_ = use; }
+    bool setPollInterval(uint32_t us);
+    void reset();
+
+    // Newest estimate
+    void quaternion(float q[4]) const;
+    float roll() const { return roll_; }      // Degrees
+    float pitch() const { return pitch_; }
+    float yaw() const { return yaw_; }
+
+    // Samples fused, fused samples per second, filter cost per sample
+    uint32_t updates() const { return updates_; }
+    float rateHz() const { return rateHz_; }
+    float microsPerUpdate() const { return usPerUpdate_; }
+
+    // Published signals and settings
+    CapabilitySchema getSchema() const;
+    String getParameter(const String& name);
+    bool setParameter(const String& name, const String& value);
+
+    // Run `updates` synthetic samples through each filter and log updates
+    // per second (blocking); returns the rate of the selected filter
+    float benchmark(uint32_t updates);
+
+private:
+    AhrsSource& source_;
+    MadgwickAhrs madgwick_;
+    MahonyAhrs mahony_;
+    MadgwickAhrsQ madgwickQ_;
+    MahonyAhrsQ mahonyQ_;
+    AhrsFilter* active_;
+    AhrsGains gains_;
+    bool useMag_;
+    uint32_t pollUs_;
+
+    unsigned long lastPollUs_;
+    uint32_t lastSampleUs_;
+    bool haveSample_;
+    uint32_t pollFailures_;
+
+    float q_[4];
+    float roll_, pitch_, yaw_;
+    uint32_t updates_;
+
+    // Rate and cost over a one second window
+    unsigned long windowStart_;
+    uint32_t windowUpdates_;
+    uint32_t windowFuseUs_;
+    float rateHz_;
+    float usPerUpdate_;
+
+    AhrsFilter* findFilter(const String& name);
+    void configureAll();
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_AHRS_SERVICE_H
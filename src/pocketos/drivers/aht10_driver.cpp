@@ -14,7 +14,7 @@ namespace PocketOS {
 #define AHT10_CMD_TRIGGER       0xAC  // Trigger measurement
 #define AHT10_CMD_SOFT_RESET    0xBA  // Soft reset
 
-AHT10Driver::AHT10Driver() : address(0), initialized(false) {
+AHT10Driver::AHT10Driver() : address(0), initialized(false), pending(false) {
 #if POCKETOS_AHT10_ENABLE_LOGGING
     readCount = 0;
     errorCount = 0;
@@ -25,7 +25,7 @@ bool AHT10Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
     
 #if POCKETOS_AHT10_ENABLE_LOGGING
-    Logger::info("AHT10: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("AHT10: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
     
 #if POCKETOS_AHT10_ENABLE_CONFIGURATION
@@ -50,6 +50,8 @@ bool AHT10Driver::init(uint8_t i2cAddress) {
     delay(40); // Wait for sensor to be ready
 #endif
     
+    pending = false;
+    last = AHT10Data();
     initialized = true;
 #if POCKETOS_AHT10_ENABLE_LOGGING
     Logger::info("AHT10: Initialized successfully");
@@ -62,10 +64,13 @@ void AHT10Driver::deinit() {
 }
 
 AHT10Data AHT10Driver::readData() {
-    AHT10Data data;
-    
+    return measureBlocking(*this);
+}
+
+uint32_t AHT10Driver::startMeasurement() {
+    pending = false;
     if (!initialized) {
-        return data;
+        return measurementDeadline(0);
     }
     
     // Trigger measurement
@@ -74,11 +79,20 @@ AHT10Data AHT10Driver::readData() {
         errorCount++;
         Logger::error("AHT10: Failed to trigger measurement");
 #endif
-        return data;
+        return measurementDeadline(0);
     }
     
-    // Wait for measurement to complete
-    delay(80); // AHT10 measurement takes ~75ms
+    pending = true;
+    return measurementDeadline(80); // AHT10 measurement takes ~75ms
+}
+
+AHT10Data AHT10Driver::collect() {
+    AHT10Data data;
+    
+    if (!pending) {
+        return data;
+    }
+    pending = false;
     
     // Read 6 bytes: status, humidity[19:12], humidity[11:4], humidity[3:0]+temp[19:16], temp[15:8], temp[7:0]
     uint8_t buffer[6];
@@ -120,6 +134,7 @@ AHT10Data AHT10Driver::readData() {
     if (data.humidity < 0.0f) data.humidity = 0.0f;
     
     data.valid = true;
+    last = data;
     
 #if POCKETOS_AHT10_ENABLE_LOGGING
     readCount++;
@@ -161,6 +176,10 @@ String AHT10Driver::getParameter(const String& name) {
         return POCKETOS_AHT10_TIER_NAME;
     } else if (name == "initialized") {
         return initialized ? "true" : "false";
+    } else if (name == "temperature") {
+        return last.valid ? String(last.temperature, 2) : "";
+    } else if (name == "humidity") {
+        return last.valid ? String(last.humidity, 2) : "";
     }
 #if POCKETOS_AHT10_ENABLE_LOGGING
     else if (name == "read_count") {
@@ -195,22 +214,4 @@ bool AHT10Driver::readData(uint8_t* buffer, size_t len) {
     return (bytesRead == len);
 }
 
-uint8_t AHT10Driver::calculateCRC(const uint8_t* data, size_t len) {
-    // CRC-8 with polynomial 0x31 (x^8 + x^5 + x^4 + 1)
-    uint8_t crc = 0xFF;
-    
-    for (size_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t bit = 8; bit > 0; bit--) {
-            if (crc & 0x80) {
-                crc = (crc << 1) ^ 0x31;
-            } else {
-                crc = (crc << 1);
-            }
-        }
-    }
-    
-    return crc;
-}
-
 } // namespace PocketOS
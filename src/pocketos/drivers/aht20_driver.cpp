@@ -1,4 +1,5 @@
 #include "aht20_driver.h"
+#include "../core/crc.h"
 #include "../driver_config.h"
 
 #if POCKETOS_AHT20_ENABLE_LOGGING
@@ -14,7 +15,7 @@ namespace PocketOS {
 #define AHT20_CMD_TRIGGER       0xAC  // Trigger measurement
 #define AHT20_CMD_SOFT_RESET    0xBA  // Soft reset
 
-AHT20Driver::AHT20Driver() : address(0), initialized(false) {
+AHT20Driver::AHT20Driver() : address(0), initialized(false), pending(false) {
 #if POCKETOS_AHT20_ENABLE_LOGGING
     readCount = 0;
     errorCount = 0;
@@ -25,7 +26,7 @@ bool AHT20Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
     
 #if POCKETOS_AHT20_ENABLE_LOGGING
-    Logger::info("AHT20: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("AHT20: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
     
 #if POCKETOS_AHT20_ENABLE_CONFIGURATION
@@ -54,6 +55,8 @@ bool AHT20Driver::init(uint8_t i2cAddress) {
     delay(40); // Wait for sensor to be ready
 #endif
     
+    pending = false;
+    last = AHT20Data();
     initialized = true;
 #if POCKETOS_AHT20_ENABLE_LOGGING
     Logger::info("AHT20: Initialized successfully");
@@ -66,10 +69,13 @@ void AHT20Driver::deinit() {
 }
 
 AHT20Data AHT20Driver::readData() {
-    AHT20Data data;
-    
+    return measureBlocking(*this);
+}
+
+uint32_t AHT20Driver::startMeasurement() {
+    pending = false;
     if (!initialized) {
-        return data;
+        return measurementDeadline(0);
     }
     
     // Trigger measurement
@@ -78,11 +84,20 @@ AHT20Data AHT20Driver::readData() {
         errorCount++;
         Logger::error("AHT20: Failed to trigger measurement");
 #endif
-        return data;
+        return measurementDeadline(0);
     }
     
-    // Wait for measurement to complete
-    delay(80); // AHT20 measurement takes ~75ms
+    pending = true;
+    return measurementDeadline(80); // AHT20 measurement takes ~75ms
+}
+
+AHT20Data AHT20Driver::collect() {
+    AHT20Data data;
+    
+    if (!pending) {
+        return data;
+    }
+    pending = false;
     
     // Read 7 bytes: status, humidity[19:12], humidity[11:4], humidity[3:0]+temp[19:16], temp[15:8], temp[7:0], CRC
     uint8_t buffer[7];
@@ -105,7 +120,7 @@ AHT20Data AHT20Driver::readData() {
     
 #if POCKETOS_AHT20_ENABLE_ERROR_HANDLING
     // Verify CRC
-    if (calculateCRC(buffer, 6) != buffer[6]) {
+    if (Crc::crc8(buffer, 6) != buffer[6]) {
 #if POCKETOS_AHT20_ENABLE_LOGGING
         errorCount++;
         Logger::error("AHT20: CRC mismatch");
@@ -130,6 +145,7 @@ AHT20Data AHT20Driver::readData() {
     if (data.humidity < 0.0f) data.humidity = 0.0f;
     
     data.valid = true;
+    last = data;
     
 #if POCKETOS_AHT20_ENABLE_LOGGING
     readCount++;
@@ -171,6 +187,10 @@ String AHT20Driver::getParameter(const String& name) {
         return POCKETOS_AHT20_TIER_NAME;
     } else if (name == "initialized") {
         return initialized ? "true" : "false";
+    } else if (name == "temperature") {
+        return last.valid ? String(last.temperature, 2) : "";
+    } else if (name == "humidity") {
+        return last.valid ? String(last.humidity, 2) : "";
     }
 #if POCKETOS_AHT20_ENABLE_LOGGING
     else if (name == "read_count") {
@@ -205,22 +225,4 @@ bool AHT20Driver::readData(uint8_t* buffer, size_t len) {
     return (bytesRead == len);
 }
 
-uint8_t AHT20Driver::calculateCRC(const uint8_t* data, size_t len) {
-    // CRC-8 with polynomial 0x31 (x^8 + x^5 + x^4 + 1)
-    uint8_t crc = 0xFF;
-    
-    for (size_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t bit = 8; bit > 0; bit--) {
-            if (crc & 0x80) {
-                crc = (crc << 1) ^ 0x31;
-            } else {
-                crc = (crc << 1);
-            }
-        }
-    }
-    
-    return crc;
-}
-
 } // namespace PocketOS
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "measurement.h"
 
 namespace PocketOS {
 
@@ -30,9 +31,13 @@ public:
     void deinit();
     bool isInitialized() const { return initialized; }
     
-    // Read measurements
+    // Read measurements (blocking)
     AHT20Data readData();
     
+    // Non-blocking measurement (measurement.h)
+    uint32_t startMeasurement();
+    AHT20Data collect();
+    
     // Get capability schema
     CapabilitySchema getSchema() const;
     
@@ -63,6 +68,8 @@ public:
 private:
     uint8_t address;
     bool initialized;
+    bool pending;
+    AHT20Data last;         // Latest valid measurement
     
 #if POCKETOS_AHT20_ENABLE_LOGGING
     uint32_t readCount;
@@ -72,9 +79,6 @@ private:
     // I2C communication
     bool sendCommand(uint8_t cmd, uint8_t param1, uint8_t param2);
     bool readData(uint8_t* buffer, size_t len);
-    
-    // CRC calculation
-    uint8_t calculateCRC(const uint8_t* data, size_t len);
 };
 
 } // namespace PocketOS
@@ -1,4 +1,5 @@
 #include "am2315_driver.h"
+#include "../core/crc.h"
 #include "../driver_config.h"
 
 #if POCKETOS_AM2315_ENABLE_LOGGING
@@ -26,7 +27,7 @@ bool AM2315Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
     
 #if POCKETOS_AM2315_ENABLE_LOGGING
-    Logger::info("AM2315: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("AM2315: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
     
     // Wake up sensor
@@ -76,9 +77,9 @@ AM2315Data AM2315Driver::readData() {
     }
     
 #if POCKETOS_AM2315_ENABLE_ERROR_HANDLING
-    // Verify CRC (last 2 bytes, little-endian)
-    uint16_t receivedCRC = buffer[7] | (buffer[6] << 8);
-    uint16_t calculatedCRC = calculateCRC(buffer, 6);
+    // Verify CRC (last 2 bytes, low byte first)
+    uint16_t receivedCRC = buffer[6] | (buffer[7] << 8);
+    uint16_t calculatedCRC = Crc::crc16Modbus(buffer, 6);
     
     if (receivedCRC != calculatedCRC) {
 #if POCKETOS_AM2315_ENABLE_LOGGING
@@ -194,23 +195,4 @@ bool AM2315Driver::readRegisters(uint8_t reg, uint8_t count, uint8_t* buffer) {
     return (bytesRead == responseLen);
 }
 
-uint16_t AM2315Driver::calculateCRC(const uint8_t* data, size_t len) {
-    // CRC-16 Modbus
-    uint16_t crc = 0xFFFF;
-    
-    for (size_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t bit = 0; bit < 8; bit++) {
-            if (crc & 0x0001) {
-                crc >>= 1;
-                crc ^= 0xA001;
-            } else {
-                crc >>= 1;
-            }
-        }
-    }
-    
-    return crc;
-}
-
 } // namespace PocketOS
@@ -73,8 +73,6 @@ private:
     bool wakeup();
     bool readRegisters(uint8_t reg, uint8_t count, uint8_t* buffer);
     
-    // CRC calculation
-    uint16_t calculateCRC(const uint8_t* data, size_t len);
 };
 
 } // namespace PocketOS
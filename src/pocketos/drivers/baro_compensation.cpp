@@ -0,0 +1,330 @@
+#include "baro_compensation.h"
+
+namespace PocketOS {
+
+// Left shifts of negative intermediates are written as multiplications:
+// same result in two's complement, without the undefined behaviour.
+
+// ---------------------------------------------------------------------------
+// BMP280 / BME280
+// ---------------------------------------------------------------------------
+
+int32_t BaroCompensation::boschTFine(const BMP280CalibrationData& cal, int32_t adcT) {
+    int32_t var1 = (((adcT >> 3) - ((int32_t)cal.dig_T1 * 2)) * (int32_t)cal.dig_T2) >> 11;
+    int32_t var2 = (((((adcT >> 4) - (int32_t)cal.dig_T1) * ((adcT >> 4) - (int32_t)cal.dig_T1)) >> 12) *
+                    (int32_t)cal.dig_T3) >> 14;
+    return var1 + var2;
+}
+
+uint32_t BaroCompensation::boschPressure(const BMP280CalibrationData& cal, int32_t tFine, int32_t adcP) {
+    int64_t var1 = (int64_t)tFine - 128000;
+    int64_t var2 = var1 * var1 * (int64_t)cal.dig_P6;
+    var2 = var2 + var1 * (int64_t)cal.dig_P5 * 131072;
+    var2 = var2 + (int64_t)cal.dig_P4 * 34359738368LL;
+    var1 = ((var1 * var1 * (int64_t)cal.dig_P3) >> 8) + var1 * (int64_t)cal.dig_P2 * 4096;
+    var1 = ((140737488355328LL + var1) * (int64_t)cal.dig_P1) >> 33;
+    if (var1 == 0) {
+        return 0;  // Avoid division by zero
+    }
+    int64_t p = 1048576 - adcP;
+    p = ((p * 2147483648LL - var2) * 3125) / var1;
+    var1 = ((int64_t)cal.dig_P9 * (p >> 13) * (p >> 13)) >> 25;
+    var2 = ((int64_t)cal.dig_P8 * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + (int64_t)cal.dig_P7 * 16;
+    return (uint32_t)p;
+}
+
+uint32_t BaroCompensation::bme280Humidity(const BME280CalibrationData& cal, int32_t tFine, int32_t adcH) {
+    int32_t v = tFine - 76800;
+    v = ((((adcH << 14) - ((int32_t)cal.dig_H4 * 1048576) - ((int32_t)cal.dig_H5 * v)) + 16384) >> 15) *
+        (((((((v * (int32_t)cal.dig_H6) >> 10) * (((v * (int32_t)cal.dig_H3) >> 11) + 32768)) >> 10) + 2097152) *
+          (int32_t)cal.dig_H2 + 8192) >> 14);
+    v = v - (((((v >> 15) * (v >> 15)) >> 7) * (int32_t)cal.dig_H1) >> 4);
+    v = v < 0 ? 0 : v;
+    v = v > 419430400 ? 419430400 : v;
+    return (uint32_t)(v >> 12);
+}
+
+float BaroCompensation::boschTFineFloat(const BMP280CalibrationData& cal, int32_t adcT) {
+    float var1 = (adcT / 16384.0f - cal.dig_T1 / 1024.0f) * cal.dig_T2;
+    float dt = adcT / 131072.0f - cal.dig_T1 / 8192.0f;
+    float var2 = dt * dt * cal.dig_T3;
+    return var1 + var2;
+}
+
+float BaroCompensation::boschPressureFloat(const BMP280CalibrationData& cal, float tFine, int32_t adcP) {
+    float var1 = tFine / 2.0f - 64000.0f;
+    float var2 = var1 * var1 * cal.dig_P6 / 32768.0f;
+    var2 = var2 + var1 * cal.dig_P5 * 2.0f;
+    var2 = var2 / 4.0f + cal.dig_P4 * 65536.0f;
+    var1 = (cal.dig_P3 * var1 * var1 / 524288.0f + cal.dig_P2 * var1) / 524288.0f;
+    var1 = (1.0f + var1 / 32768.0f) * cal.dig_P1;
+    if (var1 == 0.0f) {
+        return 0.0f;
+    }
+    float p = 1048576.0f - adcP;
+    p = (p - var2 / 4096.0f) * 6250.0f / var1;
+    var1 = cal.dig_P9 * p * p / 2147483648.0f;
+    var2 = p * cal.dig_P8 / 32768.0f;
+    return p + (var1 + var2 + cal.dig_P7) / 16.0f;
+}
+
+float BaroCompensation::bme280HumidityFloat(const BME280CalibrationData& cal, float tFine, int32_t adcH) {
+    float h = tFine - 76800.0f;
+    h = (adcH - (cal.dig_H4 * 64.0f + cal.dig_H5 / 16384.0f * h)) *
+        (cal.dig_H2 / 65536.0f * (1.0f + cal.dig_H6 / 67108864.0f * h * (1.0f + cal.dig_H3 / 67108864.0f * h)));
+    h = h * (1.0f - cal.dig_H1 * h / 524288.0f);
+    if (h > 100.0f) return 100.0f;
+    if (h < 0.0f) return 0.0f;
+    return h;
+}
+
+// ---------------------------------------------------------------------------
+// BMP388
+// ---------------------------------------------------------------------------
+
+int64_t BaroCompensation::bmp388TLin(const BMP388CalibrationData& cal, uint32_t adcT) {
+    int64_t pd1 = (int64_t)adcT - (int64_t)256 * cal.par_t1;
+    int64_t pd2 = (int64_t)cal.par_t2 * pd1;
+    int64_t pd3 = pd1 * pd1;
+    int64_t pd4 = pd3 * cal.par_t3;
+    int64_t pd5 = pd2 * 262144 + pd4;
+    return pd5 / 4294967296LL;
+}
+
+uint32_t BaroCompensation::bmp388Pressure(const BMP388CalibrationData& cal, int64_t tLin, uint32_t adcP) {
+    int64_t p = adcP;
+    int64_t pd1 = tLin * tLin;
+    int64_t pd2 = pd1 / 64;
+    int64_t pd3 = (pd2 * tLin) / 256;
+    int64_t pd4 = (cal.par_p8 * pd3) / 32;
+    int64_t pd5 = (cal.par_p7 * pd1) * 16;
+    int64_t pd6 = (cal.par_p6 * tLin) * 4194304;
+    int64_t offset = (int64_t)cal.par_p5 * 140737488355328LL + pd4 + pd5 + pd6;
+
+    pd2 = ((int64_t)cal.par_p4 * pd3) / 32;
+    pd4 = (cal.par_p3 * pd1) * 4;
+    pd5 = ((int64_t)cal.par_p2 - 16384) * tLin * 2097152;
+    int64_t sensitivity = ((int64_t)cal.par_p1 - 16384) * 70368744177664LL + pd2 + pd4 + pd5;
+
+    pd1 = (sensitivity / 16777216) * p;
+    pd2 = cal.par_p10 * tLin;
+    pd3 = pd2 + (int64_t)65536 * cal.par_p9;
+    pd4 = (pd3 * p) / 8192;
+    // Divide by 10 first and scale back to keep p * pd4 in range
+    pd5 = (p * (pd4 / 10)) / 512;
+    pd5 = pd5 * 10;
+    pd6 = p * p;
+    pd2 = (cal.par_p11 * pd6) / 65536;
+    pd3 = (pd2 * p) / 128;
+    pd4 = offset / 4 + pd1 + pd5 + pd3;
+    return (uint32_t)(((uint64_t)pd4 * 25) / 1099511627776ULL);
+}
+
+void BaroCompensation::bmp388Quantize(const BMP388CalibrationData& cal, BMP388FloatCalibration& out) {
+    out.par_t1 = cal.par_t1 * 256.0f;                         // / 2^-8
+    out.par_t2 = cal.par_t2 / 1073741824.0f;                  // / 2^30
+    out.par_t3 = cal.par_t3 / 281474976710656.0f;             // / 2^48
+    out.par_p1 = (cal.par_p1 - 16384) / 1048576.0f;           // / 2^20
+    out.par_p2 = (cal.par_p2 - 16384) / 536870912.0f;         // / 2^29
+    out.par_p3 = cal.par_p3 / 4294967296.0f;                  // / 2^32
+    out.par_p4 = cal.par_p4 / 137438953472.0f;                // / 2^37
+    out.par_p5 = cal.par_p5 * 8.0f;                           // / 2^-3
+    out.par_p6 = cal.par_p6 / 64.0f;                          // / 2^6
+    out.par_p7 = cal.par_p7 / 256.0f;                         // / 2^8
+    out.par_p8 = cal.par_p8 / 32768.0f;                       // / 2^15
+    out.par_p9 = cal.par_p9 / 281474976710656.0f;             // / 2^48
+    out.par_p10 = cal.par_p10 / 281474976710656.0f;           // / 2^48
+    out.par_p11 = cal.par_p11 / 36893488147419103232.0f;      // / 2^65
+}
+
+float BaroCompensation::bmp388TemperatureFloat(const BMP388FloatCalibration& cal, uint32_t adcT) {
+    float pd1 = (float)adcT - cal.par_t1;
+    float pd2 = pd1 * cal.par_t2;
+    return pd2 + pd1 * pd1 * cal.par_t3;
+}
+
+float BaroCompensation::bmp388PressureFloat(const BMP388FloatCalibration& cal, float temperature, uint32_t adcP) {
+    float t = temperature;
+    float t2 = t * t;
+    float t3 = t2 * t;
+    float p = (float)adcP;
+    float out1 = cal.par_p5 + cal.par_p6 * t + cal.par_p7 * t2 + cal.par_p8 * t3;
+    float out2 = p * (cal.par_p1 + cal.par_p2 * t + cal.par_p3 * t2 + cal.par_p4 * t3);
+    float p2 = p * p;
+    float out3 = p2 * (cal.par_p9 + cal.par_p10 * t) + p2 * p * cal.par_p11;
+    return out1 + out2 + out3;
+}
+
+// ---------------------------------------------------------------------------
+// DPS310
+// ---------------------------------------------------------------------------
+
+int32_t BaroCompensation::dps310Temperature(const DPS310CalibrationData& cal, int32_t rawT) {
+    // 100 * (c0 / 2 + c1 * rawT / 2^19)
+    return 50 * cal.c0 + (int32_t)(((int64_t)100 * cal.c1 * rawT) >> DPS310_SCALE_SHIFT);
+}
+
+int32_t BaroCompensation::dps310Pressure(const DPS310CalibrationData& cal, int32_t rawP, int32_t rawT) {
+    // Horner form of the datasheet polynomial, 8 fractional bits throughout
+    const int64_t p = rawP;
+    const int64_t t = rawT;
+    int64_t acc = ((int64_t)cal.c30 * 256 * p) >> DPS310_SCALE_SHIFT;
+    acc = (((int64_t)cal.c20 * 256 + acc) * p) >> DPS310_SCALE_SHIFT;
+    acc = (((int64_t)cal.c10 * 256 + acc) * p) >> DPS310_SCALE_SHIFT;
+    int64_t pressure = (int64_t)cal.c00 * 256 + acc;
+
+    int64_t tc = ((int64_t)cal.c21 * 256 * p) >> DPS310_SCALE_SHIFT;
+    tc = (((int64_t)cal.c11 * 256 + tc) * p) >> DPS310_SCALE_SHIFT;
+    pressure += (((int64_t)cal.c01 * 256 + tc) * t) >> DPS310_SCALE_SHIFT;
+    return (int32_t)pressure;
+}
+
+float BaroCompensation::dps310TemperatureFloat(const DPS310CalibrationData& cal, int32_t rawT) {
+    float t = rawT / (float)(1UL << DPS310_SCALE_SHIFT);
+    return cal.c0 * 0.5f + cal.c1 * t;
+}
+
+float BaroCompensation::dps310PressureFloat(const DPS310CalibrationData& cal, int32_t rawP, int32_t rawT) {
+    float p = rawP / (float)(1UL << DPS310_SCALE_SHIFT);
+    float t = rawT / (float)(1UL << DPS310_SCALE_SHIFT);
+    return cal.c00 + p * (cal.c10 + p * (cal.c20 + p * cal.c30)) +
+           t * (cal.c01 + p * (cal.c11 + p * cal.c21));
+}
+
+// ---------------------------------------------------------------------------
+// MS5611 / MS8607
+// ---------------------------------------------------------------------------
+
+void BaroCompensation::ms5611(const MS5611CalibrationData& cal, uint32_t d1, uint32_t d2,
+                              int32_t& temperature, int32_t& pressure) {
+    int32_t dT = (int32_t)d2 - (int32_t)cal.c5 * 256;
+    int32_t temp = 2000 + (int32_t)(((int64_t)dT * cal.c6) >> 23);
+    int64_t off = (int64_t)cal.c2 * 65536 + (((int64_t)cal.c4 * dT) >> 7);
+    int64_t sens = (int64_t)cal.c1 * 32768 + (((int64_t)cal.c3 * dT) >> 8);
+
+    if (temp < 2000) {
+        int64_t low = (int64_t)(temp - 2000) * (temp - 2000);
+        int32_t t2 = (int32_t)(((int64_t)dT * dT) >> 31);
+        int64_t off2 = 5 * low / 2;
+        int64_t sens2 = 5 * low / 4;
+        if (temp < -1500) {
+            int64_t veryLow = (int64_t)(temp + 1500) * (temp + 1500);
+            off2 += 7 * veryLow;
+            sens2 += 11 * veryLow / 2;
+        }
+        temp -= t2;
+        off -= off2;
+        sens -= sens2;
+    }
+
+    temperature = temp;
+    pressure = (int32_t)((((int64_t)d1 * sens >> 21) - off) >> 15);
+}
+
+void BaroCompensation::ms8607(const MS8607CalibrationData& cal, uint32_t d1, uint32_t d2,
+                              int32_t& temperature, int32_t& pressure) {
+    int32_t dT = (int32_t)d2 - (int32_t)cal.c5 * 256;
+    int32_t temp = 2000 + (int32_t)(((int64_t)dT * cal.c6) >> 23);
+    int64_t off = (int64_t)cal.c2 * 131072 + (((int64_t)cal.c4 * dT) >> 6);
+    int64_t sens = (int64_t)cal.c1 * 65536 + (((int64_t)cal.c3 * dT) >> 7);
+
+    int32_t t2;
+    int64_t off2 = 0;
+    int64_t sens2 = 0;
+    if (temp < 2000) {
+        int64_t low = (int64_t)(temp - 2000) * (temp - 2000);
+        t2 = (int32_t)((3 * (int64_t)dT * dT) >> 33);
+        off2 = 61 * low / 16;
+        sens2 = 29 * low / 16;
+        if (temp < -1500) {
+            int64_t veryLow = (int64_t)(temp + 1500) * (temp + 1500);
+            off2 += 17 * veryLow;
+            sens2 += 9 * veryLow;
+        }
+    } else {
+        t2 = (int32_t)((5 * (int64_t)dT * dT) >> 38);
+    }
+    temp -= t2;
+    off -= off2;
+    sens -= sens2;
+
+    temperature = temp;
+    pressure = (int32_t)((((int64_t)d1 * sens >> 21) - off) >> 15);
+}
+
+void BaroCompensation::ms5611Float(const MS5611CalibrationData& cal, uint32_t d1, uint32_t d2,
+                                   float& temperature, float& pressure) {
+    float dT = (float)d2 - cal.c5 * 256.0f;
+    float temp = 2000.0f + dT * cal.c6 / 8388608.0f;
+    float off = cal.c2 * 65536.0f + cal.c4 * dT / 128.0f;
+    float sens = cal.c1 * 32768.0f + cal.c3 * dT / 256.0f;
+
+    if (temp < 2000.0f) {
+        float low = (temp - 2000.0f) * (temp - 2000.0f);
+        float t2 = dT * dT / 2147483648.0f;
+        float off2 = 2.5f * low;
+        float sens2 = 1.25f * low;
+        if (temp < -1500.0f) {
+            float veryLow = (temp + 1500.0f) * (temp + 1500.0f);
+            off2 += 7.0f * veryLow;
+            sens2 += 5.5f * veryLow;
+        }
+        temp -= t2;
+        off -= off2;
+        sens -= sens2;
+    }
+
+    temperature = temp / 100.0f;
+    pressure = ((float)d1 * sens / 2097152.0f - off) / 32768.0f;
+}
+
+void BaroCompensation::ms8607Float(const MS8607CalibrationData& cal, uint32_t d1, uint32_t d2,
+                                   float& temperature, float& pressure) {
+    float dT = (float)d2 - cal.c5 * 256.0f;
+    float temp = 2000.0f + dT * cal.c6 / 8388608.0f;
+    float off = cal.c2 * 131072.0f + cal.c4 * dT / 64.0f;
+    float sens = cal.c1 * 65536.0f + cal.c3 * dT / 128.0f;
+
+    float t2;
+    float off2 = 0.0f;
+    float sens2 = 0.0f;
+    if (temp < 2000.0f) {
+        float low = (temp - 2000.0f) * (temp - 2000.0f);
+        t2 = 3.0f * dT * dT / 8589934592.0f;
+        off2 = 61.0f * low / 16.0f;
+        sens2 = 29.0f * low / 16.0f;
+        if (temp < -1500.0f) {
+            float veryLow = (temp + 1500.0f) * (temp + 1500.0f);
+            off2 += 17.0f * veryLow;
+            sens2 += 9.0f * veryLow;
+        }
+    } else {
+        t2 = 5.0f * dT * dT / 274877906944.0f;
+    }
+    temp -= t2;
+    off -= off2;
+    sens -= sens2;
+
+    temperature = temp / 100.0f;
+    pressure = ((float)d1 * sens / 2097152.0f - off) / 32768.0f;
+}
+
+int32_t BaroCompensation::ms8607Humidity(uint16_t d3, int32_t temperature) {
+    // RH = -6 + 125 * D3 / 2^16, then + (T - 20) * 0.18 %RH/degC
+    int32_t rh = -600 + (int32_t)((12500 * (int64_t)(d3 & 0xFFFC)) >> 16);
+    rh += (temperature - 2000) * 18 / 100;
+    if (rh < 0) return 0;
+    if (rh > 10000) return 10000;
+    return rh;
+}
+
+float BaroCompensation::ms8607HumidityFloat(uint16_t d3, float temperature) {
+    float rh = -6.0f + 125.0f * (d3 & 0xFFFC) / 65536.0f;
+    rh += (temperature - 20.0f) * 0.18f;
+    if (rh < 0.0f) return 0.0f;
+    if (rh > 100.0f) return 100.0f;
+    return rh;
+}
+
+} // namespace PocketOS
@@ -0,0 +1,197 @@
+#ifndef POCKETOS_BARO_COMPENSATION_H
+#define POCKETOS_BARO_COMPENSATION_H
+
+#include <stdint.h>
+
+namespace PocketOS {
+
+/**
+ * Shared compensation for the barometric and environmental drivers
+ *
+ * Each sensor has an integer path that follows the manufacturer's
+ * reference code bit for bit, and a float path that follows the
+ * datasheet's floating-point formulas. Integer results keep the
+ * datasheet's fixed-point units:
+ *
+ *   sensor          temperature        pressure              humidity
+ *   BMP280/BME280   0.01 degC          Pa, Q24.8             %RH, Q22.10
+ *   BMP388          0.01 degC          0.01 Pa               -
+ *   DPS310          0.01 degC          Pa, Q24.8             -
+ *   MS5611/MS8607   0.01 degC          Pa (0.01 mbar)        0.01 %RH
+ *   LPS25H          0.01 degC          (raw is 1/4096 hPa)   -
+ *
+ * Float results are in degC, Pa and %RH.
+ *
+ * Drivers select a path at compile time. Integer is the default: the
+ * ESP8266 has no FPU, and the integer forms are the reference results.
+ * Set POCKETOS_BARO_FLOAT_COMPENSATION=1 to switch every driver to float
+ * (cheaper on the ESP32's single-precision FPU), or override one driver
+ * with POCKETOS_<DRIVER>_FLOAT_COMPENSATION=0/1.
+ *
+ * No Arduino dependency: checked against datasheet vectors and
+ * benchmarked on the host (tools/barobench).
+ */
+
+#ifndef POCKETOS_BARO_FLOAT_COMPENSATION
+#define POCKETOS_BARO_FLOAT_COMPENSATION 0
+#endif
+
+#ifndef POCKETOS_BME280_FLOAT_COMPENSATION
+#define POCKETOS_BME280_FLOAT_COMPENSATION POCKETOS_BARO_FLOAT_COMPENSATION
+#endif
+#ifndef POCKETOS_BMP280_FLOAT_COMPENSATION
+#define POCKETOS_BMP280_FLOAT_COMPENSATION POCKETOS_BARO_FLOAT_COMPENSATION
+#endif
+#ifndef POCKETOS_BMP388_FLOAT_COMPENSATION
+#define POCKETOS_BMP388_FLOAT_COMPENSATION POCKETOS_BARO_FLOAT_COMPENSATION
+#endif
+#ifndef POCKETOS_DPS310_FLOAT_COMPENSATION
+#define POCKETOS_DPS310_FLOAT_COMPENSATION POCKETOS_BARO_FLOAT_COMPENSATION
+#endif
+#ifndef POCKETOS_MS5611_FLOAT_COMPENSATION
+#define POCKETOS_MS5611_FLOAT_COMPENSATION POCKETOS_BARO_FLOAT_COMPENSATION
+#endif
+#ifndef POCKETOS_MS8607_FLOAT_COMPENSATION
+#define POCKETOS_MS8607_FLOAT_COMPENSATION POCKETOS_BARO_FLOAT_COMPENSATION
+#endif
+#ifndef POCKETOS_LPS25H_FLOAT_COMPENSATION
+#define POCKETOS_LPS25H_FLOAT_COMPENSATION POCKETOS_BARO_FLOAT_COMPENSATION
+#endif
+
+// BMP280 calibration (NVM 0x88-0x9F)
+struct BMP280CalibrationData {
+    uint16_t dig_T1;
+    int16_t  dig_T2;
+    int16_t  dig_T3;
+    uint16_t dig_P1;
+    int16_t  dig_P2;
+    int16_t  dig_P3;
+    int16_t  dig_P4;
+    int16_t  dig_P5;
+    int16_t  dig_P6;
+    int16_t  dig_P7;
+    int16_t  dig_P8;
+    int16_t  dig_P9;
+};
+
+// BME280 calibration: BMP280 temperature/pressure plus humidity
+struct BME280CalibrationData : BMP280CalibrationData {
+    uint8_t  dig_H1;
+    int16_t  dig_H2;
+    uint8_t  dig_H3;
+    int16_t  dig_H4;
+    int16_t  dig_H5;
+    int8_t   dig_H6;
+};
+
+// BMP388 calibration as stored in NVM (0x31-0x45)
+struct BMP388CalibrationData {
+    uint16_t par_t1;
+    uint16_t par_t2;
+    int8_t   par_t3;
+    int16_t  par_p1;
+    int16_t  par_p2;
+    int8_t   par_p3;
+    int8_t   par_p4;
+    uint16_t par_p5;
+    uint16_t par_p6;
+    int8_t   par_p7;
+    int8_t   par_p8;
+    int16_t  par_p9;
+    int8_t   par_p10;
+    int8_t   par_p11;
+};
+
+// BMP388 calibration scaled for the float formulas (bmp388Quantize)
+struct BMP388FloatCalibration {
+    float par_t1, par_t2, par_t3;
+    float par_p1, par_p2, par_p3, par_p4, par_p5, par_p6;
+    float par_p7, par_p8, par_p9, par_p10, par_p11;
+};
+
+// DPS310 coefficients (0x10-0x21), sign-extended
+struct DPS310CalibrationData {
+    int32_t c0;
+    int32_t c1;
+    int32_t c00;
+    int32_t c10;
+    int32_t c01;
+    int32_t c11;
+    int32_t c20;
+    int32_t c21;
+    int32_t c30;
+};
+
+// Scale factor of a DPS310 result at single oversampling (the drivers'
+// configuration); 2^19, so the integer path shifts instead of dividing
+#define DPS310_SCALE_SHIFT 19
+
+// MS5611 and MS8607 PROM coefficients C1-C6
+struct MS5611CalibrationData {
+    uint16_t c1;  // Pressure sensitivity
+    uint16_t c2;  // Pressure offset
+    uint16_t c3;  // Temperature coefficient of pressure sensitivity
+    uint16_t c4;  // Temperature coefficient of pressure offset
+    uint16_t c5;  // Reference temperature
+    uint16_t c6;  // Temperature coefficient of the temperature
+};
+
+typedef MS5611CalibrationData MS8607CalibrationData;
+
+class BaroCompensation {
+public:
+    // BMP280/BME280 (Bosch datasheet compensation code). t_fine carries
+    // temperature into the pressure and humidity formulas.
+    static int32_t boschTFine(const BMP280CalibrationData& cal, int32_t adcT);
+    static int32_t boschTemperature(int32_t tFine) { return (tFine * 5 + 128) >> 8; }
+    static uint32_t boschPressure(const BMP280CalibrationData& cal, int32_t tFine, int32_t adcP);
+    static uint32_t bme280Humidity(const BME280CalibrationData& cal, int32_t tFine, int32_t adcH);
+
+    static float boschTFineFloat(const BMP280CalibrationData& cal, int32_t adcT);
+    static float boschTemperatureFloat(float tFine) { return tFine / 5120.0f; }
+    static float boschPressureFloat(const BMP280CalibrationData& cal, float tFine, int32_t adcP);
+    static float bme280HumidityFloat(const BME280CalibrationData& cal, float tFine, int32_t adcH);
+
+    // BMP388 (Bosch BMP3 API integer code; datasheet float formulas).
+    // t_lin carries temperature into the pressure formula.
+    static int64_t bmp388TLin(const BMP388CalibrationData& cal, uint32_t adcT);
+    static int32_t bmp388Temperature(int64_t tLin) { return (int32_t)((tLin * 25) / 16384); }
+    static uint32_t bmp388Pressure(const BMP388CalibrationData& cal, int64_t tLin, uint32_t adcP);
+
+    static void bmp388Quantize(const BMP388CalibrationData& cal, BMP388FloatCalibration& out);
+    static float bmp388TemperatureFloat(const BMP388FloatCalibration& cal, uint32_t adcT);
+    static float bmp388PressureFloat(const BMP388FloatCalibration& cal, float temperature, uint32_t adcP);
+
+    // DPS310 (datasheet section 4.9, single oversampling). Pressure uses
+    // the raw temperature, not the compensated one.
+    static int32_t dps310Temperature(const DPS310CalibrationData& cal, int32_t rawT);
+    static int32_t dps310Pressure(const DPS310CalibrationData& cal, int32_t rawP, int32_t rawT);
+
+    static float dps310TemperatureFloat(const DPS310CalibrationData& cal, int32_t rawT);
+    static float dps310PressureFloat(const DPS310CalibrationData& cal, int32_t rawP, int32_t rawT);
+
+    // MS5611 and MS8607 pressure/temperature, including the second-order
+    // low-temperature correction (each datasheet's own coefficients)
+    static void ms5611(const MS5611CalibrationData& cal, uint32_t d1, uint32_t d2,
+                       int32_t& temperature, int32_t& pressure);
+    static void ms8607(const MS8607CalibrationData& cal, uint32_t d1, uint32_t d2,
+                       int32_t& temperature, int32_t& pressure);
+    static void ms5611Float(const MS5611CalibrationData& cal, uint32_t d1, uint32_t d2,
+                            float& temperature, float& pressure);
+    static void ms8607Float(const MS8607CalibrationData& cal, uint32_t d1, uint32_t d2,
+                            float& temperature, float& pressure);
+
+    // MS8607 relative humidity, temperature compensated and clamped to
+    // 0-100 %RH (temperature in the matching path's units)
+    static int32_t ms8607Humidity(uint16_t d3, int32_t temperature);
+    static float ms8607HumidityFloat(uint16_t d3, float temperature);
+
+    // LPS25H temperature (42.5 degC + raw / 480). LPS22HB temperature is
+    // already 0.01 degC and both pressures 1/4096 hPa: no arithmetic.
+    static int32_t lps25hTemperature(int16_t raw) { return 4250 + (raw * 5) / 24; }
+    static float lps25hTemperatureFloat(int16_t raw) { return 42.5f + raw / 480.0f; }
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_BARO_COMPENSATION_H
@@ -37,7 +37,7 @@ bool BME280Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
     
 #if POCKETOS_BME280_ENABLE_LOGGING
-    Logger::info("BME280: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("BME280: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
     
     // Check chip ID
@@ -51,7 +51,7 @@ bool BME280Driver::init(uint8_t i2cAddress) {
     
     if (chipId != BME280_CHIP_ID) {
 #if POCKETOS_BME280_ENABLE_LOGGING
-        Logger::error("BME280: Invalid chip ID: 0x" + String(chipId, HEX));
+        Logger::error(("BME280: Invalid chip ID: 0x" + String(chipId, HEX)).c_str());
 #endif
         return false;
     }
@@ -135,17 +135,18 @@ BME280Data BME280Driver::readData() {
     int32_t adc_T = ((uint32_t)buffer[3] << 12) | ((uint32_t)buffer[4] << 4) | ((buffer[5] >> 4) & 0x0F);
     int32_t adc_H = ((uint32_t)buffer[6] << 8) | buffer[7];
     
-    // Compensate temperature (must be first)
-    int32_t temp = compensateTemperature(adc_T);
-    data.temperature = temp / 100.0f;
-    
-    // Compensate pressure
-    uint32_t press = compensatePressure(adc_P);
-    data.pressure = press / 25600.0f;  // Convert to hPa
-    
-    // Compensate humidity
-    uint32_t hum = compensateHumidity(adc_H);
-    data.humidity = hum / 1024.0f;
+    // Temperature first: t_fine feeds the pressure and humidity formulas
+#if POCKETOS_BME280_FLOAT_COMPENSATION
+    float tFine = BaroCompensation::boschTFineFloat(calibration, adc_T);
+    data.temperature = BaroCompensation::boschTemperatureFloat(tFine);
+    data.pressure = BaroCompensation::boschPressureFloat(calibration, tFine, adc_P) * 0.01f;  // Pa -> hPa
+    data.humidity = BaroCompensation::bme280HumidityFloat(calibration, tFine, adc_H);
+#else
+    int32_t tFine = BaroCompensation::boschTFine(calibration, adc_T);
+    data.temperature = BaroCompensation::boschTemperature(tFine) * 0.01f;
+    data.pressure = BaroCompensation::boschPressure(calibration, tFine, adc_P) * (1.0f / 25600.0f);  // Q24.8 Pa -> hPa
+    data.humidity = BaroCompensation::bme280Humidity(calibration, tFine, adc_H) * (1.0f / 1024.0f);
+#endif
     
     data.valid = true;
     
@@ -233,7 +234,7 @@ bool BME280Driver::setParameter(const String& name, const String& value) {
     // BME280 settings are mostly read-only in this simple implementation
     // Future: Add support for changing oversampling, mode, filter
 #if POCKETOS_BME280_ENABLE_LOGGING
-    Logger::warn("BME280: Parameter '" + name + "' is read-only");
+    Logger::warning(("BME280: Parameter '" + name + "' is read-only").c_str());
 #endif
 #endif
     return false;
@@ -313,63 +314,14 @@ bool BME280Driver::readCalibrationData() {
     
     calibration.dig_H2 = (hum_calib[1] << 8) | hum_calib[0];
     calibration.dig_H3 = hum_calib[2];
-    calibration.dig_H4 = (hum_calib[3] << 4) | (hum_calib[4] & 0x0F);
-    calibration.dig_H5 = (hum_calib[5] << 4) | (hum_calib[4] >> 4);
+    // H4/H5 are signed 12-bit: the MSB byte carries the sign
+    calibration.dig_H4 = (int16_t)((int8_t)hum_calib[3] * 16) | (hum_calib[4] & 0x0F);
+    calibration.dig_H5 = (int16_t)((int8_t)hum_calib[5] * 16) | (hum_calib[4] >> 4);
     calibration.dig_H6 = hum_calib[6];
     
     return true;
 }
 
-int32_t BME280Driver::compensateTemperature(int32_t adc_T) {
-    int32_t var1, var2, T;
-    
-    var1 = ((((adc_T >> 3) - ((int32_t)calibration.dig_T1 << 1))) * ((int32_t)calibration.dig_T2)) >> 11;
-    var2 = (((((adc_T >> 4) - ((int32_t)calibration.dig_T1)) * ((adc_T >> 4) - ((int32_t)calibration.dig_T1))) >> 12) * ((int32_t)calibration.dig_T3)) >> 14;
-    
-    calibration.t_fine = var1 + var2;
-    T = (calibration.t_fine * 5 + 128) >> 8;
-    
-    return T;
-}
-
-uint32_t BME280Driver::compensatePressure(int32_t adc_P) {
-    int64_t var1, var2, p;
-    
-    var1 = ((int64_t)calibration.t_fine) - 128000;
-    var2 = var1 * var1 * (int64_t)calibration.dig_P6;
-    var2 = var2 + ((var1 * (int64_t)calibration.dig_P5) << 17);
-    var2 = var2 + (((int64_t)calibration.dig_P4) << 35);
-    var1 = ((var1 * var1 * (int64_t)calibration.dig_P3) >> 8) + ((var1 * (int64_t)calibration.dig_P2) << 12);
-    var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)calibration.dig_P1) >> 33;
-    
-    if (var1 == 0) {
-        return 0;
-    }
-    
-    p = 1048576 - adc_P;
-    p = (((p << 31) - var2) * 3125) / var1;
-    var1 = (((int64_t)calibration.dig_P9) * (p >> 13) * (p >> 13)) >> 25;
-    var2 = (((int64_t)calibration.dig_P8) * p) >> 19;
-    p = ((p + var1 + var2) >> 8) + (((int64_t)calibration.dig_P7) << 4);
-    
-    return (uint32_t)p;
-}
-
-uint32_t BME280Driver::compensateHumidity(int32_t adc_H) {
-    int32_t v_x1_u32r;
-    
-    v_x1_u32r = (calibration.t_fine - ((int32_t)76800));
-    v_x1_u32r = (((((adc_H << 14) - (((int32_t)calibration.dig_H4) << 20) - (((int32_t)calibration.dig_H5) * v_x1_u32r)) +
-                   ((int32_t)16384)) >> 15) * (((((((v_x1_u32r * ((int32_t)calibration.dig_H6)) >> 10) *
-                   (((v_x1_u32r * ((int32_t)calibration.dig_H3)) >> 11) + ((int32_t)32768))) >> 10) + ((int32_t)2097152)) *
-                   ((int32_t)calibration.dig_H2) + 8192) >> 14));
-    v_x1_u32r = (v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) * ((int32_t)calibration.dig_H1)) >> 4));
-    v_x1_u32r = (v_x1_u32r < 0 ? 0 : v_x1_u32r);
-    v_x1_u32r = (v_x1_u32r > 419430400 ? 419430400 : v_x1_u32r);
-    
-    return (uint32_t)(v_x1_u32r >> 12);
-}
-
 #if POCKETOS_BME280_ENABLE_ADVANCED_DIAGNOSTICS
 String BME280Driver::getDiagnostics() {
     String diag = "BME280 Diagnostics:\n";
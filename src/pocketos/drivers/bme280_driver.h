@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "baro_compensation.h"
 #include "register_types.h"
 
 namespace PocketOS {
@@ -12,32 +13,6 @@ namespace PocketOS {
 #define BME280_ADDR_COUNT 2
 const uint8_t BME280_VALID_ADDRESSES[BME280_ADDR_COUNT] = { 0x76, 0x77 };
 
-// BME280 calibration data structure
-struct BME280CalibrationData {
-    uint16_t dig_T1;
-    int16_t  dig_T2;
-    int16_t  dig_T3;
-    
-    uint16_t dig_P1;
-    int16_t  dig_P2;
-    int16_t  dig_P3;
-    int16_t  dig_P4;
-    int16_t  dig_P5;
-    int16_t  dig_P6;
-    int16_t  dig_P7;
-    int16_t  dig_P8;
-    int16_t  dig_P9;
-    
-    uint8_t  dig_H1;
-    int16_t  dig_H2;
-    uint8_t  dig_H3;
-    int16_t  dig_H4;
-    int16_t  dig_H5;
-    int8_t   dig_H6;
-    
-    int32_t  t_fine;  // Temperature fine value for compensation
-};
-
 // BME280 measurement data
 struct BME280Data {
     float temperature;  // Celsius
@@ -121,11 +96,6 @@ private:
     
     // Calibration
     bool readCalibrationData();
-    
-    // Compensation formulas
-    int32_t compensateTemperature(int32_t adc_T);
-    uint32_t compensatePressure(int32_t adc_P);
-    uint32_t compensateHumidity(int32_t adc_H);
 };
 
 } // namespace PocketOS
@@ -10,16 +10,38 @@ namespace PocketOS {
 #define BME680_REG_CHIP_ID      0xD0
 #define BME680_REG_VARIANT_ID   0xF0
 #define BME680_REG_RESET        0xE0
+#define BME680_REG_RES_HEAT_VAL 0x00
+#define BME680_REG_RES_HEAT_RNG 0x02
+#define BME680_REG_RANGE_SW_ERR 0x04
+#define BME680_REG_FIELD0       0x1D
+#define BME680_REG_RES_HEAT_0   0x5A
+#define BME680_REG_GAS_WAIT_0   0x64
 #define BME680_REG_CTRL_GAS_1   0x71
 #define BME680_REG_CTRL_HUM     0x72
 #define BME680_REG_STATUS       0x73
 #define BME680_REG_CTRL_MEAS    0x74
 #define BME680_REG_CONFIG       0x75
-#define BME680_REG_PRESS_MSB    0x1F
-#define BME680_REG_GAS_R_MSB    0x2A
+#define BME680_REG_COEFF1       0x89
+#define BME680_REG_COEFF2       0xE1
 #define BME680_CHIP_ID          0x61
 
-BME680Driver::BME680Driver() : address(0), initialized(false) {
+#define BME680_COEFF1_LEN       25
+#define BME680_COEFF2_LEN       16
+
+// Oversampling codes: T x2, P x4, H x1
+#define BME680_OSRS_T           2
+#define BME680_OSRS_P           3
+#define BME680_OSRS_H           1
+#define BME680_MODE_FORCED      0x01
+#define BME680_RUN_GAS          0x10
+
+#define BME680_NEW_DATA         0x80
+#define BME680_GAS_VALID        0x20
+#define BME680_HEAT_STAB        0x10
+
+BME680Driver::BME680Driver()
+    : address(0), initialized(false), pending(false), heaterTemp(320), heaterMs(150) {
+    memset(&calib, 0, sizeof(calib));
 }
 
 bool BME680Driver::init(uint8_t i2cAddress) {
@@ -43,11 +65,14 @@ bool BME680Driver::init(uint8_t i2cAddress) {
         return false;
     }
     
-    writeRegister(BME680_REG_CTRL_HUM, 0x01);
-    writeRegister(BME680_REG_CTRL_MEAS, 0x25);
+    // Sleep mode; each startMeasurement() triggers one forced cycle
+    writeRegister(BME680_REG_CTRL_HUM, BME680_OSRS_H);
+    writeRegister(BME680_REG_CTRL_MEAS, (BME680_OSRS_T << 5) | (BME680_OSRS_P << 2));
     writeRegister(BME680_REG_CONFIG, 0x00);
-    writeRegister(BME680_REG_CTRL_GAS_1, 0x10);
+    writeRegister(BME680_REG_CTRL_GAS_1, BME680_RUN_GAS);
     
+    pending = false;
+    last = BME680Data();
     initialized = true;
 #if POCKETOS_BME680_ENABLE_LOGGING
     Logger::info("BME680: Initialized");
@@ -60,26 +85,74 @@ void BME680Driver::deinit() {
         writeRegister(BME680_REG_CTRL_MEAS, 0x00);
     }
     initialized = false;
+    pending = false;
 }
 
 BME680Data BME680Driver::readData() {
+    return measureBlocking(*this);
+}
+
+uint32_t BME680Driver::measurementTimeMs() const {
+    static const uint8_t cycles[6] = { 0, 1, 2, 4, 8, 16 };
+    
+    // Bosch's TPH duration estimate, us
+    uint32_t us = (uint32_t)(cycles[BME680_OSRS_T] + cycles[BME680_OSRS_P] + cycles[BME680_OSRS_H]) * 1963;
+    us += 477 * 4;      // TPH switching
+    us += 477 * 5;      // Gas measurement
+    us += 500;          // Wake up
+    return us / 1000 + 1 + heaterMs;
+}
+
+uint32_t BME680Driver::startMeasurement() {
+    pending = false;
+    if (!initialized) return measurementDeadline(0);
+    
+    // The heater target depends on ambient temperature: refresh it each cycle
+    if (!writeRegister(BME680_REG_RES_HEAT_0, heaterResistance(heaterTemp)) ||
+        !writeRegister(BME680_REG_GAS_WAIT_0, heaterDuration(heaterMs)) ||
+        !writeRegister(BME680_REG_CTRL_MEAS, (BME680_OSRS_T << 5) | (BME680_OSRS_P << 2) | BME680_MODE_FORCED)) {
+#if POCKETOS_BME680_ENABLE_LOGGING
+        Logger::error("BME680: Failed to start measurement");
+#endif
+        return measurementDeadline(0);
+    }
+    
+    pending = true;
+    return measurementDeadline(measurementTimeMs());
+}
+
+BME680Data BME680Driver::collect() {
     BME680Data data;
-    if (!initialized) return data;
+    if (!pending) return data;
+    pending = false;
     
     uint8_t buffer[15];
-    if (!readRegisters(BME680_REG_PRESS_MSB, buffer, 15)) return data;
+    if (!readRegisters(BME680_REG_FIELD0, buffer, 15)) return data;
+    if (!(buffer[0] & BME680_NEW_DATA)) {
+#if POCKETOS_BME680_ENABLE_LOGGING
+        Logger::error("BME680: Measurement not complete");
+#endif
+        return data;
+    }
     
-    uint32_t adc_P = ((uint32_t)buffer[0] << 12) | ((uint32_t)buffer[1] << 4) | ((buffer[2] >> 4) & 0x0F);
-    uint32_t adc_T = ((uint32_t)buffer[3] << 12) | ((uint32_t)buffer[4] << 4) | ((buffer[5] >> 4) & 0x0F);
-    uint32_t adc_H = ((uint32_t)buffer[6] << 8) | buffer[7];
-    uint32_t adc_G = ((uint32_t)buffer[11] << 2) | ((buffer[12] >> 6) & 0x03);
+    uint32_t adc_P = ((uint32_t)buffer[2] << 12) | ((uint32_t)buffer[3] << 4) | (buffer[4] >> 4);
+    uint32_t adc_T = ((uint32_t)buffer[5] << 12) | ((uint32_t)buffer[6] << 4) | (buffer[7] >> 4);
+    uint16_t adc_H = ((uint16_t)buffer[8] << 8) | buffer[9];
+    uint16_t adc_G = ((uint16_t)buffer[13] << 2) | (buffer[14] >> 6);
+    uint8_t gasRange = buffer[14] & 0x0F;
     
-    data.temperature = adc_T / 5120.0f;
-    data.pressure = adc_P / 100.0f;
-    data.humidity = adc_H / 512.0f;
-    data.gas = adc_G / 10.0f;
-    data.valid = true;
+    // Temperature first: it sets t_fine for the others
+    data.temperature = compensateTemperature(adc_T) / 100.0f;
+    data.pressure = compensatePressure(adc_P) / 100.0f;
+    data.humidity = compensateHumidity(adc_H) / 1000.0f;
     
+    // Gas is only meaningful once the heater reached its set-point
+    if ((buffer[14] & BME680_GAS_VALID) && (buffer[14] & BME680_HEAT_STAB)) {
+        data.gas = compensateGas(adc_G, gasRange) / 1000.0f;
+    }
+    
+    data.valid = true;
+    last = data;
     return data;
 }
 
@@ -92,6 +165,10 @@ CapabilitySchema BME680Driver::getSchema() const {
     schema.addSignal("humidity", ParamType::FLOAT, true, "%RH");
     schema.addSignal("pressure", ParamType::FLOAT, true, "hPa");
     schema.addSignal("gas", ParamType::FLOAT, true, "kOhms");
+#if POCKETOS_BME680_ENABLE_CONFIGURATION
+    schema.addSetting("heater_temp", ParamType::INT, true, 200, 400, 1, "C");
+    schema.addSetting("heater_ms", ParamType::INT, true, 1, 4032, 1, "ms");
+#endif
     schema.addCommand("read", "");
     return schema;
 }
@@ -100,13 +177,34 @@ String BME680Driver::getParameter(const String& name) {
     if (name == "address") return "0x" + String(address, HEX);
     if (name == "driver") return "bme680";
     if (name == "tier") return POCKETOS_BME680_TIER_NAME;
+    if (name == "initialized") return initialized ? "true" : "false";
+    if (name == "temperature") return last.valid ? String(last.temperature, 2) : "";
+    if (name == "humidity") return last.valid ? String(last.humidity, 2) : "";
+    if (name == "pressure") return last.valid ? String(last.pressure, 2) : "";
+    if (name == "gas") return last.valid ? String(last.gas, 2) : "";
+    if (name == "heater_temp") return String(heaterTemp);
+    if (name == "heater_ms") return String(heaterMs);
+    if (name == "measurement_ms") return String(measurementTimeMs());
     return "";
 }
 
 bool BME680Driver::setParameter(const String& name, const String& value) {
+#if POCKETOS_BME680_ENABLE_CONFIGURATION
+    if (name == "heater_temp") return setHeaterProfile((uint16_t)value.toInt(), heaterMs);
+    if (name == "heater_ms") return setHeaterProfile(heaterTemp, (uint16_t)value.toInt());
+#endif
     return false;
 }
 
+#if POCKETOS_BME680_ENABLE_CONFIGURATION
+bool BME680Driver::setHeaterProfile(uint16_t tempC, uint16_t durationMs) {
+    if (tempC < 200 || tempC > 400 || durationMs < 1 || durationMs > 4032) return false;
+    heaterTemp = tempC;
+    heaterMs = durationMs;
+    return true;
+}
+#endif
+
 bool BME680Driver::writeRegister(uint8_t reg, uint8_t value) {
     Wire.beginTransmission(address);
     Wire.write(reg);
@@ -139,9 +237,157 @@ bool BME680Driver::readRegisters(uint8_t reg, uint8_t* buffer, size_t len) {
 }
 
 bool BME680Driver::readCalibrationData() {
+    uint8_t c1[BME680_COEFF1_LEN];
+    uint8_t c2[BME680_COEFF2_LEN];
+    uint8_t heatVal, heatRange, swErr;
+    
+    if (!readRegisters(BME680_REG_COEFF1, c1, BME680_COEFF1_LEN) ||
+        !readRegisters(BME680_REG_COEFF2, c2, BME680_COEFF2_LEN) ||
+        !readRegister(BME680_REG_RES_HEAT_VAL, &heatVal) ||
+        !readRegister(BME680_REG_RES_HEAT_RNG, &heatRange) ||
+        !readRegister(BME680_REG_RANGE_SW_ERR, &swErr)) {
+        return false;
+    }
+    
+    calib.par_t1 = (uint16_t)((c2[9] << 8) | c2[8]);
+    calib.par_t2 = (int16_t)((c1[2] << 8) | c1[1]);
+    calib.par_t3 = (int8_t)c1[3];
+    
+    calib.par_p1 = (uint16_t)((c1[6] << 8) | c1[5]);
+    calib.par_p2 = (int16_t)((c1[8] << 8) | c1[7]);
+    calib.par_p3 = (int8_t)c1[9];
+    calib.par_p4 = (int16_t)((c1[12] << 8) | c1[11]);
+    calib.par_p5 = (int16_t)((c1[14] << 8) | c1[13]);
+    calib.par_p6 = (int8_t)c1[16];
+    calib.par_p7 = (int8_t)c1[15];
+    calib.par_p8 = (int16_t)((c1[20] << 8) | c1[19]);
+    calib.par_p9 = (int16_t)((c1[22] << 8) | c1[21]);
+    calib.par_p10 = c1[23];
+    
+    // H1 and H2 share the nibbles of c2[1]
+    calib.par_h1 = (uint16_t)((c2[2] << 4) | (c2[1] & 0x0F));
+    calib.par_h2 = (uint16_t)((c2[0] << 4) | (c2[1] >> 4));
+    calib.par_h3 = (int8_t)c2[3];
+    calib.par_h4 = (int8_t)c2[4];
+    calib.par_h5 = (int8_t)c2[5];
+    calib.par_h6 = c2[6];
+    calib.par_h7 = (int8_t)c2[7];
+    
+    calib.par_gh1 = (int8_t)c2[12];
+    calib.par_gh2 = (int16_t)((c2[11] << 8) | c2[10]);
+    calib.par_gh3 = (int8_t)c2[13];
+    
+    calib.res_heat_val = (int8_t)heatVal;
+    calib.res_heat_range = (heatRange & 0x30) >> 4;
+    calib.range_sw_err = (int8_t)((int8_t)swErr & (int8_t)0xF0) / 16;
+    calib.t_fine = 0;
     return true;
 }
 
+// Compensation: Bosch BME680 reference integer formulas
+
+int16_t BME680Driver::compensateTemperature(uint32_t adc_T) {
+    int64_t var1 = ((int32_t)adc_T >> 3) - ((int32_t)calib.par_t1 << 1);
+    int64_t var2 = (var1 * (int32_t)calib.par_t2) >> 11;
+    int64_t var3 = ((var1 >> 1) * (var1 >> 1)) >> 12;
+    var3 = (var3 * ((int32_t)calib.par_t3 << 4)) >> 14;
+    calib.t_fine = (int32_t)(var2 + var3);
+    return (int16_t)(((calib.t_fine * 5) + 128) >> 8);
+}
+
+uint32_t BME680Driver::compensatePressure(uint32_t adc_P) {
+    int32_t var1 = (calib.t_fine >> 1) - 64000;
+    int32_t var2 = ((((var1 >> 2) * (var1 >> 2)) >> 11) * (int32_t)calib.par_p6) >> 2;
+    var2 = var2 + ((var1 * (int32_t)calib.par_p5) * 2);
+    var2 = (var2 >> 2) + ((int32_t)calib.par_p4 << 16);
+    var1 = (((((var1 >> 2) * (var1 >> 2)) >> 13) * ((int32_t)calib.par_p3 << 5)) >> 3) +
+           (((int32_t)calib.par_p2 * var1) >> 1);
+    var1 = var1 >> 18;
+    var1 = ((32768 + var1) * (int32_t)calib.par_p1) >> 15;
+    if (var1 == 0) return 0;
+    
+    // 64-bit where the reference code wraps above ~1050 hPa
+    int64_t x = (int64_t)(1048576 - (int32_t)adc_P - (var2 >> 12)) * 3125;
+    if (x >= 0x40000000) {
+        x = (x / var1) * 2;
+    } else {
+        x = (x * 2) / var1;
+    }
+    int32_t p = (int32_t)x;
+    var1 = ((int32_t)calib.par_p9 * (int32_t)(((p >> 3) * (p >> 3)) >> 13)) >> 12;
+    var2 = ((int32_t)(p >> 2) * (int32_t)calib.par_p8) >> 13;
+    int32_t var3 = (int32_t)(((int64_t)(p >> 8) * (p >> 8) * (p >> 8) * calib.par_p10) >> 17);
+    p = p + ((var1 + var2 + var3 + ((int32_t)calib.par_p7 << 7)) >> 4);
+    return (uint32_t)p;
+}
+
+uint32_t BME680Driver::compensateHumidity(uint16_t adc_H) {
+    int32_t temp = ((calib.t_fine * 5) + 128) >> 8;
+    int32_t var1 = (int32_t)(adc_H - ((int32_t)calib.par_h1 * 16)) -
+                   (((temp * (int32_t)calib.par_h3) / 100) >> 1);
+    int32_t var2 = ((int32_t)calib.par_h2 *
+                    (((temp * (int32_t)calib.par_h4) / 100) +
+                     (((temp * ((temp * (int32_t)calib.par_h5) / 100)) >> 6) / 100) +
+                     (int32_t)(1 << 14))) >> 10;
+    int32_t var3 = var1 * var2;
+    int32_t var4 = (int32_t)calib.par_h6 << 7;
+    var4 = (var4 + ((temp * (int32_t)calib.par_h7) / 100)) >> 4;
+    int32_t var5 = ((var3 >> 14) * (var3 >> 14)) >> 10;
+    int32_t var6 = (var4 * var5) >> 1;
+    int32_t h = (((var3 + var6) >> 10) * 1000) >> 12;
+    
+    if (h > 100000) h = 100000;
+    if (h < 0) h = 0;
+    return (uint32_t)h;
+}
+
+uint32_t BME680Driver::compensateGas(uint16_t adc_G, uint8_t range) {
+    static const uint32_t lookup1[16] = {
+        2147483647UL, 2147483647UL, 2147483647UL, 2147483647UL,
+        2147483647UL, 2126008810UL, 2147483647UL, 2130303777UL,
+        2147483647UL, 2147483647UL, 2143188679UL, 2136746228UL,
+        2147483647UL, 2126008810UL, 2147483647UL, 2147483647UL
+    };
+    static const uint32_t lookup2[16] = {
+        4096000000UL, 2048000000UL, 1024000000UL, 512000000UL,
+        255744255UL, 127110228UL, 64000000UL, 32258064UL,
+        16016016UL, 8000000UL, 4000000UL, 2000000UL,
+        1000000UL, 500000UL, 250000UL, 125000UL
+    };
+    
+    int64_t var1 = ((int64_t)(1340 + (5 * (int64_t)calib.range_sw_err)) * (int64_t)lookup1[range]) >> 16;
+    int64_t var2 = ((int64_t)adc_G << 15) - (int64_t)16777216 + var1;
+    int64_t var3 = ((int64_t)lookup2[range] * var1) >> 9;
+    if (var2 == 0) return 0;
+    return (uint32_t)((var3 + (var2 >> 1)) / var2);
+}
+
+// Heater set-point register value for `tempC`, against the last ambient reading
+uint8_t BME680Driver::heaterResistance(uint16_t tempC) const {
+    if (tempC > 400) tempC = 400;
+    int32_t ambient = last.valid ? (int32_t)last.temperature : 25;
+    
+    int32_t var1 = ((ambient * calib.par_gh3) / 1000) * 256;
+    int32_t var2 = (calib.par_gh1 + 784) *
+                   (((((calib.par_gh2 + 154009) * (int32_t)tempC * 5) / 100) + 3276800) / 10);
+    int32_t var3 = var1 + (var2 / 2);
+    int32_t var4 = var3 / (calib.res_heat_range + 4);
+    int32_t var5 = (131 * calib.res_heat_val) + 65536;
+    int32_t res_x100 = ((var4 / var5) - 250) * 34;
+    return (uint8_t)((res_x100 + 50) / 100);
+}
+
+// gas_wait encoding: 6-bit value times a 1/4/16/64 multiplier
+uint8_t BME680Driver::heaterDuration(uint16_t ms) {
+    if (ms >= 0xFC0) return 0xFF;
+    uint8_t factor = 0;
+    while (ms > 0x3F) {
+        ms /= 4;
+        factor++;
+    }
+    return (uint8_t)(ms + factor * 64);
+}
+
 #if POCKETOS_BME680_ENABLE_REGISTER_ACCESS
 const RegisterDesc* BME680Driver::registers(size_t& count) const {
     static const RegisterDesc BME680_REGISTERS[] = {
@@ -150,7 +396,10 @@ const RegisterDesc* BME680Driver::registers(size_t& count) const {
         RegisterDesc(0x71, "CTRL_GAS_1", 1, RegisterAccess::RW, 0x00),
         RegisterDesc(0x72, "CTRL_HUM", 1, RegisterAccess::RW, 0x00),
         RegisterDesc(0x74, "CTRL_MEAS", 1, RegisterAccess::RW, 0x00),
+        RegisterDesc(0x1D, "MEAS_STATUS_0", 1, RegisterAccess::RO, 0x00),
         RegisterDesc(0x1F, "PRESS_MSB", 1, RegisterAccess::RO, 0x80),
+        RegisterDesc(0x5A, "RES_HEAT_0", 1, RegisterAccess::RW, 0x00),
+        RegisterDesc(0x64, "GAS_WAIT_0", 1, RegisterAccess::RW, 0x00),
     };
     count = sizeof(BME680_REGISTERS) / sizeof(RegisterDesc);
     return BME680_REGISTERS;
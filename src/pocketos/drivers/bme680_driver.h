@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "measurement.h"
 
 #if POCKETOS_BME680_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
@@ -26,7 +27,45 @@ struct BME680Data {
     BME680Data() : temperature(0), humidity(0), pressure(0), gas(0), valid(false) {}
 };
 
-// BME680 Device Driver (Environmental Multi-Sensor)
+// BME680 factory calibration (Bosch naming)
+struct BME680Calibration {
+    uint16_t par_t1;
+    int16_t par_t2;
+    int8_t par_t3;
+    uint16_t par_p1;
+    int16_t par_p2;
+    int8_t par_p3;
+    int16_t par_p4;
+    int16_t par_p5;
+    int8_t par_p6;
+    int8_t par_p7;
+    int16_t par_p8;
+    int16_t par_p9;
+    uint8_t par_p10;
+    uint16_t par_h1;
+    uint16_t par_h2;
+    int8_t par_h3;
+    int8_t par_h4;
+    int8_t par_h5;
+    uint8_t par_h6;
+    int8_t par_h7;
+    int8_t par_gh1;
+    int16_t par_gh2;
+    int8_t par_gh3;
+    uint8_t res_heat_range;
+    int8_t res_heat_val;
+    int8_t range_sw_err;
+    int32_t t_fine;
+};
+
+/**
+ * BME680 Device Driver (Environmental Multi-Sensor)
+ *
+ * Runs forced-mode conversions: startMeasurement() writes the heater
+ * set-point and triggers one T/P/H + gas cycle, returning when it will be
+ * done (~170 ms with the default 320 °C / 150 ms heater profile).
+ * collect() reads the data block and applies Bosch's integer compensation.
+ */
 class BME680Driver {
 public:
     BME680Driver();
@@ -36,9 +75,16 @@ public:
     void deinit();
     bool isInitialized() const { return initialized; }
     
-    // Read measurements
+    // Read measurements (blocking)
     BME680Data readData();
     
+    // Non-blocking measurement (measurement.h)
+    uint32_t startMeasurement();
+    BME680Data collect();
+    
+    // Conversion time of one forced cycle, ms
+    uint32_t measurementTimeMs() const;
+    
     // Get capability schema
     CapabilitySchema getSchema() const;
     
@@ -74,17 +120,34 @@ public:
     const RegisterDesc* findRegisterByName(const String& name) const;
 #endif
     
+#if POCKETOS_BME680_ENABLE_CONFIGURATION
+    // Tier 1: Gas heater profile
+    bool setHeaterProfile(uint16_t tempC, uint16_t durationMs);  // 200-400 °C, 1-4032 ms
+#endif
+    
 private:
     uint8_t address;
     bool initialized;
+    bool pending;
+    
+    BME680Calibration calib;
+    uint16_t heaterTemp;    // °C
+    uint16_t heaterMs;
+    BME680Data last;
     
     // I2C communication
     bool writeRegister(uint8_t reg, uint8_t value);
     bool readRegister(uint8_t reg, uint8_t* value);
     bool readRegisters(uint8_t reg, uint8_t* buffer, size_t len);
     
-    // Calibration
+    // Calibration and compensation
     bool readCalibrationData();
+    int16_t compensateTemperature(uint32_t adc_T);     // 0.01 °C
+    uint32_t compensatePressure(uint32_t adc_P);       // Pa
+    uint32_t compensateHumidity(uint16_t adc_H);       // 0.001 %RH
+    uint32_t compensateGas(uint16_t adc_G, uint8_t range);  // Ohms
+    uint8_t heaterResistance(uint16_t tempC) const;
+    static uint8_t heaterDuration(uint16_t ms);
 };
 
 } // namespace PocketOS
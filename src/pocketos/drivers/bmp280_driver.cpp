@@ -42,8 +42,15 @@ BMP280Data BMP280Driver::readData() {
     int32_t adc_P = ((uint32_t)buffer[0] << 12) | ((uint32_t)buffer[1] << 4) | ((buffer[2] >> 4) & 0x0F);
     int32_t adc_T = ((uint32_t)buffer[3] << 12) | ((uint32_t)buffer[4] << 4) | ((buffer[5] >> 4) & 0x0F);
     
-    data.temperature = compensateTemperature(adc_T) / 100.0f;
-    data.pressure = compensatePressure(adc_P) / 25600.0f;
+#if POCKETOS_BMP280_FLOAT_COMPENSATION
+    float tFine = BaroCompensation::boschTFineFloat(calibration, adc_T);
+    data.temperature = BaroCompensation::boschTemperatureFloat(tFine);
+    data.pressure = BaroCompensation::boschPressureFloat(calibration, tFine, adc_P) * 0.01f;  // Pa -> hPa
+#else
+    int32_t tFine = BaroCompensation::boschTFine(calibration, adc_T);
+    data.temperature = BaroCompensation::boschTemperature(tFine) * 0.01f;
+    data.pressure = BaroCompensation::boschPressure(calibration, tFine, adc_P) * (1.0f / 25600.0f);  // Q24.8 Pa -> hPa
+#endif
     data.valid = true;
     
     return data;
@@ -122,32 +129,6 @@ bool BMP280Driver::readCalibrationData() {
     return true;
 }
 
-int32_t BMP280Driver::compensateTemperature(int32_t adc_T) {
-    int32_t var1 = ((((adc_T >> 3) - ((int32_t)calibration.dig_T1 << 1))) * ((int32_t)calibration.dig_T2)) >> 11;
-    int32_t var2 = (((((adc_T >> 4) - ((int32_t)calibration.dig_T1)) * ((adc_T >> 4) - ((int32_t)calibration.dig_T1))) >> 12) * ((int32_t)calibration.dig_T3)) >> 14;
-    calibration.t_fine = var1 + var2;
-    return (calibration.t_fine * 5 + 128) >> 8;
-}
-
-uint32_t BMP280Driver::compensatePressure(int32_t adc_P) {
-    int64_t var1 = ((int64_t)calibration.t_fine) - 128000;
-    int64_t var2 = var1 * var1 * (int64_t)calibration.dig_P6;
-    var2 = var2 + ((var1 * (int64_t)calibration.dig_P5) << 17);
-    var2 = var2 + (((int64_t)calibration.dig_P4) << 35);
-    var1 = ((var1 * var1 * (int64_t)calibration.dig_P3) >> 8) + ((var1 * (int64_t)calibration.dig_P2) << 12);
-    var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)calibration.dig_P1) >> 33;
-    
-    if (var1 == 0) return 0;
-    
-    int64_t p = 1048576 - adc_P;
-    p = (((p << 31) - var2) * 3125) / var1;
-    var1 = (((int64_t)calibration.dig_P9) * (p >> 13) * (p >> 13)) >> 25;
-    var2 = (((int64_t)calibration.dig_P8) * p) >> 19;
-    p = ((p + var1 + var2) >> 8) + (((int64_t)calibration.dig_P7) << 4);
-    
-    return (uint32_t)p;
-}
-
 #if POCKETOS_BMP280_ENABLE_REGISTER_ACCESS
 const RegisterDesc* BMP280Driver::registers(size_t& count) const {
     static const RegisterDesc BMP280_REGISTERS[] = {
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "baro_compensation.h"
 
 #if POCKETOS_BMP280_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
@@ -15,23 +16,6 @@ namespace PocketOS {
 #define BMP280_ADDR_COUNT 2
 const uint8_t BMP280_VALID_ADDRESSES[BMP280_ADDR_COUNT] = { 0x76, 0x77 };
 
-// BMP280 calibration data structure
-struct BMP280CalibrationData {
-    uint16_t dig_T1;
-    int16_t  dig_T2;
-    int16_t  dig_T3;
-    uint16_t dig_P1;
-    int16_t  dig_P2;
-    int16_t  dig_P3;
-    int16_t  dig_P4;
-    int16_t  dig_P5;
-    int16_t  dig_P6;
-    int16_t  dig_P7;
-    int16_t  dig_P8;
-    int16_t  dig_P9;
-    int32_t  t_fine;
-};
-
 // BMP280 measurement data
 struct BMP280Data {
     float temperature;  // Celsius
@@ -101,10 +85,6 @@ private:
     
     // Calibration
     bool readCalibrationData();
-    
-    // Compensation formulas
-    int32_t compensateTemperature(int32_t adc_T);
-    uint32_t compensatePressure(int32_t adc_P);
 };
 
 } // namespace PocketOS
@@ -42,8 +42,14 @@ BMP388Data BMP388Driver::readData() {
     uint32_t adc_P = ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[1] << 8) | buffer[0];
     uint32_t adc_T = ((uint32_t)buffer[5] << 16) | ((uint32_t)buffer[4] << 8) | buffer[3];
     
-    data.temperature = compensateTemperature(adc_T);
-    data.pressure = compensatePressure(adc_P);
+#if POCKETOS_BMP388_FLOAT_COMPENSATION
+    data.temperature = BaroCompensation::bmp388TemperatureFloat(quantized, adc_T);
+    data.pressure = BaroCompensation::bmp388PressureFloat(quantized, data.temperature, adc_P) * 0.01f;  // Pa -> hPa
+#else
+    int64_t tLin = BaroCompensation::bmp388TLin(calibration, adc_T);
+    data.temperature = BaroCompensation::bmp388Temperature(tLin) * 0.01f;
+    data.pressure = BaroCompensation::bmp388Pressure(calibration, tLin, adc_P) * 0.0001f;  // 0.01 Pa -> hPa
+#endif
     data.valid = true;
     
     return data;
@@ -121,33 +127,12 @@ bool BMP388Driver::readCalibrationData() {
     calibration.par_p10 = buffer[19];
     calibration.par_p11 = buffer[20];
     
+#if POCKETOS_BMP388_FLOAT_COMPENSATION
+    BaroCompensation::bmp388Quantize(calibration, quantized);
+#endif
     return true;
 }
 
-float BMP388Driver::compensateTemperature(uint32_t adc_T) {
-    float partial_data1 = (float)(adc_T - calibration.par_t1);
-    float partial_data2 = (float)(partial_data1 * calibration.par_t2);
-    calibration.t_lin = (int64_t)(partial_data2 + (partial_data1 * partial_data1) * calibration.par_t3);
-    return (float)calibration.t_lin / 65536.0f;
-}
-
-float BMP388Driver::compensatePressure(uint32_t adc_P) {
-    float partial_data1 = (float)calibration.t_lin * (float)calibration.t_lin;
-    float partial_data2 = partial_data1 / 64.0f;
-    float partial_data3 = (partial_data2 / 256.0f) * (float)calibration.par_p8;
-    float partial_data4 = (float)calibration.par_p7 * partial_data1 * 16.0f;
-    float offset = (float)calibration.par_p6 * 4194304.0f + partial_data3 + partial_data4;
-    
-    partial_data2 = ((float)calibration.par_p4 / 8192.0f) * partial_data1;
-    partial_data3 = ((float)calibration.par_p3 / 256.0f) * partial_data1 * partial_data1;
-    partial_data4 = (float)calibration.par_p2 * partial_data1 * 4.0f;
-    float sensitivity = ((float)calibration.par_p1 - 16384.0f) * 70368744177664.0f + partial_data2 + partial_data3 + partial_data4;
-    
-    float comp_press = (offset / sensitivity) * ((float)adc_P - 8388608.0f);
-    
-    return comp_press / 100.0f;
-}
-
 #if POCKETOS_BMP388_ENABLE_REGISTER_ACCESS
 const RegisterDesc* BMP388Driver::registers(size_t& count) const {
     static const RegisterDesc BMP388_REGISTERS[] = {
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "baro_compensation.h"
 
 #if POCKETOS_BMP388_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
@@ -15,25 +16,6 @@ namespace PocketOS {
 #define BMP388_ADDR_COUNT 2
 const uint8_t BMP388_VALID_ADDRESSES[BMP388_ADDR_COUNT] = { 0x76, 0x77 };
 
-// BMP388 calibration data structure
-struct BMP388CalibrationData {
-    uint16_t par_t1;
-    uint16_t par_t2;
-    int8_t   par_t3;
-    int16_t  par_p1;
-    int16_t  par_p2;
-    int8_t   par_p3;
-    int8_t   par_p4;
-    uint16_t par_p5;
-    uint16_t par_p6;
-    int8_t   par_p7;
-    int8_t   par_p8;
-    int16_t  par_p9;
-    int8_t   par_p10;
-    int8_t   par_p11;
-    int64_t  t_lin;
-};
-
 // BMP388 measurement data
 struct BMP388Data {
     float temperature;  // Celsius
@@ -95,6 +77,9 @@ private:
     uint8_t address;
     bool initialized;
     BMP388CalibrationData calibration;
+#if POCKETOS_BMP388_FLOAT_COMPENSATION
+    BMP388FloatCalibration quantized;  // Scaled once at init
+#endif
     
     // I2C communication
     bool writeRegister(uint8_t reg, uint8_t value);
@@ -103,10 +88,6 @@ private:
     
     // Calibration
     bool readCalibrationData();
-    
-    // Compensation formulas
-    float compensateTemperature(uint32_t adc_T);
-    float compensatePressure(uint32_t adc_P);
 };
 
 } // namespace PocketOS
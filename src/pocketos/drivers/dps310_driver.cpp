@@ -72,9 +72,14 @@ DPS310Data DPS310Driver::readData() {
     int32_t raw_tmp = ((int32_t)buffer[3] << 16) | ((int32_t)buffer[4] << 8) | buffer[5];
     if (raw_tmp & 0x800000) raw_tmp |= 0xFF000000;
     
-    float temp_scaled = compensateTemperature(raw_tmp);
-    data.temperature = temp_scaled;
-    data.pressure = compensatePressure(raw_psr, temp_scaled);
+    // Pressure is corrected with the scaled raw temperature
+#if POCKETOS_DPS310_FLOAT_COMPENSATION
+    data.temperature = BaroCompensation::dps310TemperatureFloat(calibration, raw_tmp);
+    data.pressure = BaroCompensation::dps310PressureFloat(calibration, raw_psr, raw_tmp) * 0.01f;  // Pa -> hPa
+#else
+    data.temperature = BaroCompensation::dps310Temperature(calibration, raw_tmp) * 0.01f;
+    data.pressure = BaroCompensation::dps310Pressure(calibration, raw_psr, raw_tmp) * (1.0f / 25600.0f);  // Q24.8 Pa -> hPa
+#endif
     data.valid = true;
     
     return data;
@@ -167,18 +172,6 @@ bool DPS310Driver::readCalibrationData() {
     return true;
 }
 
-float DPS310Driver::compensateTemperature(int32_t raw) {
-    float temp_scaled = (float)raw / 524288.0f;
-    return (float)calibration.c0 * 0.5f + (float)calibration.c1 * temp_scaled;
-}
-
-float DPS310Driver::compensatePressure(int32_t raw, float temp_scaled) {
-    float prs_scaled = (float)raw / 524288.0f;
-    float prs = (float)calibration.c00 + prs_scaled * ((float)calibration.c10 + prs_scaled * ((float)calibration.c20 + prs_scaled * (float)calibration.c30));
-    prs += temp_scaled * ((float)calibration.c01 + prs_scaled * ((float)calibration.c11 + prs_scaled * (float)calibration.c21));
-    return prs / 100.0f;
-}
-
 #if POCKETOS_DPS310_ENABLE_REGISTER_ACCESS
 const RegisterDesc* DPS310Driver::registers(size_t& count) const {
     static const RegisterDesc DPS310_REGISTERS[] = {
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "baro_compensation.h"
 
 #if POCKETOS_DPS310_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
@@ -15,19 +16,6 @@ namespace PocketOS {
 #define DPS310_ADDR_COUNT 1
 const uint8_t DPS310_VALID_ADDRESSES[DPS310_ADDR_COUNT] = { 0x77 };
 
-// DPS310 calibration data structure
-struct DPS310CalibrationData {
-    int32_t c0;
-    int32_t c1;
-    int32_t c00;
-    int32_t c10;
-    int32_t c01;
-    int32_t c11;
-    int32_t c20;
-    int32_t c21;
-    int32_t c30;
-};
-
 // DPS310 measurement data
 struct DPS310Data {
     float temperature;  // Celsius
@@ -97,10 +85,6 @@ private:
     
     // Calibration
     bool readCalibrationData();
-    
-    // Compensation formulas
-    float compensateTemperature(int32_t raw);
-    float compensatePressure(int32_t raw, float temp_scaled);
 };
 
 } // namespace PocketOS
@@ -238,6 +238,10 @@ bool DS1307Driver::setSquareWave(bool enable, uint8_t rate) {
     
     return writeRegister(DS1307_REG_CONTROL, ctrl);
 }
+
+bool DS1307Driver::enableSecondPulse() {
+    return setSquareWave(true, 0);
+}
 #endif
 
 CapabilitySchema DS1307Driver::getSchema() const {
@@ -50,6 +50,7 @@ public:
     
     // Square wave control
     bool setSquareWave(bool enable, uint8_t rate);  // rate: 0=1Hz, 1=4.096kHz, 2=8.192kHz, 3=32.768kHz
+    bool enableSecondPulse();  // 1 Hz output (SystemClock pulse input)
 #endif
     
     // Get capability schema
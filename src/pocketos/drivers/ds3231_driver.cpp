@@ -244,6 +244,10 @@ bool DS3231Driver::setSquareWave(bool enable, uint8_t rate) {
     
     return writeRegister(DS3231_REG_CONTROL, ctrl);
 }
+
+bool DS3231Driver::enableSecondPulse() {
+    return setSquareWave(true, 0);
+}
 #endif
 
 CapabilitySchema DS3231Driver::getSchema() const {
@@ -75,6 +75,7 @@ public:
     
     // Square wave control
     bool setSquareWave(bool enable, uint8_t rate);  // rate: 0=1Hz, 1=1.024kHz, 2=4.096kHz, 3=8.192kHz
+    bool enableSecondPulse();  // 1 Hz output (SystemClock pulse input)
     
     // 32kHz output control
     bool enable32kHzOutput(bool enable);
@@ -0,0 +1,89 @@
+#ifndef POCKETOS_GFX_FONT_H
+#define POCKETOS_GFX_FONT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PocketOS {
+
+/**
+ * Bitmap Fonts and Glyph Cache
+ *
+ * Fonts are fixed-width, column-major 1bpp: glyphWidth bytes per glyph,
+ * one byte per column, bit 0 at the top (height up to 8 rows). Each
+ * character cell is advance x lineHeight pixels; columns past glyphWidth
+ * are spacing.
+ *
+ * The glyph cache keeps opaque glyphs pre-rasterized to RGB565 for a
+ * (font, character, colours, scale) key, so repeated text (labels,
+ * digits on a dashboard) becomes one pixel-rectangle write per glyph.
+ * Entries are replaced least recently used first.
+ */
+
+// Cached glyphs
+// Can be overridden via build flags: -DPOCKETOS_GFX_GLYPH_CACHE_ENTRIES=16
+#ifndef POCKETOS_GFX_GLYPH_CACHE_ENTRIES
+#define POCKETOS_GFX_GLYPH_CACHE_ENTRIES 8
+#endif
+
+// Largest cell (pixels) that is cached; default fits the 5x7 font at scale 2
+#ifndef POCKETOS_GFX_GLYPH_MAX_PIXELS
+#define POCKETOS_GFX_GLYPH_MAX_PIXELS 192
+#endif
+
+struct GfxFont {
+    const uint8_t* data;   // glyphWidth bytes per character
+    uint8_t first;         // First character in data
+    uint8_t last;          // Last character in data
+    uint8_t glyphWidth;    // Columns stored per glyph
+    uint8_t glyphHeight;   // Rows used (<= 8)
+    uint8_t advance;       // Cell width
+    uint8_t lineHeight;    // Cell height
+
+    // Column bits for a character (nullptr if not in the font)
+    const uint8_t* glyph(char c) const {
+        uint8_t ch = (uint8_t)c;
+        if (ch < first || ch > last) {
+            return nullptr;
+        }
+        return data + (size_t)(ch - first) * glyphWidth;
+    }
+};
+
+// Built-in 5x7 ASCII font (0x20-0x7E), 6x8 cell
+extern const GfxFont GFX_FONT_5X7;
+
+class GfxGlyphCache {
+public:
+    // Opaque cell for c (advance*scale x lineHeight*scale pixels, rows
+    // contiguous), or nullptr if the cell is too large to cache.
+    static const uint16_t* lookup(const GfxFont* font, char c, uint16_t fg, uint16_t bg, uint8_t scale);
+
+    static void clear();
+
+    static uint32_t hits() { return hits_; }
+    static uint32_t misses() { return misses_; }
+
+    // Rasterize one opaque cell into out (must hold the cell)
+    static void rasterize(const GfxFont* font, char c, uint16_t fg, uint16_t bg, uint8_t scale, uint16_t* out);
+
+private:
+    struct Entry {
+        const GfxFont* font;
+        uint16_t fg;
+        uint16_t bg;
+        uint32_t lastUse;
+        char c;
+        uint8_t scale;
+        uint16_t pixels[POCKETOS_GFX_GLYPH_MAX_PIXELS];
+    };
+
+    static Entry entries_[POCKETOS_GFX_GLYPH_CACHE_ENTRIES];
+    static uint32_t clock_;
+    static uint32_t hits_;
+    static uint32_t misses_;
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_GFX_FONT_H
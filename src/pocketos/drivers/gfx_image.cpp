@@ -0,0 +1,322 @@
+#include "gfx_image.h"
+
+namespace PocketOS {
+
+static inline uint16_t readLE16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+GfxImageDecoder::GfxImageDecoder()
+    : data_(nullptr), len_(0), start_(0), pos_(0), palette_(nullptr),
+      width_(0), height_(0), encoding_(GFX_IMAGE_RAW), paletteSize_(0),
+      left_(0), error_(false), packetLeft_(0), packetRun_(false), runColor_(0) {
+}
+
+bool GfxImageDecoder::begin(const uint8_t* data, size_t len) {
+    data_ = nullptr;
+    left_ = 0;
+    error_ = false;
+
+    if (!data || len < GFX_IMAGE_HEADER_SIZE) {
+        return false;
+    }
+    if (data[0] != 'P' || data[1] != 'I' || data[2] != 'M' || data[3] != 'G' ||
+        data[4] != GFX_IMAGE_VERSION) {
+        return false;
+    }
+
+    uint8_t encoding = data[5];
+    uint16_t width = readLE16(data + 6);
+    uint16_t height = readLE16(data + 8);
+    uint16_t paletteSize = readLE16(data + 10);
+    if (width == 0 || height == 0 || encoding > GFX_IMAGE_INDEXED) {
+        return false;
+    }
+    if (encoding == GFX_IMAGE_INDEXED) {
+        if (paletteSize == 0 || paletteSize > GFX_IMAGE_MAX_PALETTE) {
+            return false;
+        }
+    } else if (paletteSize != 0) {
+        return false;
+    }
+
+    size_t start = GFX_IMAGE_HEADER_SIZE + (size_t)paletteSize * 2;
+    if (start > len) {
+        return false;
+    }
+    if (encoding == GFX_IMAGE_RAW && len - start < (size_t)width * height * 2) {
+        return false;
+    }
+
+    data_ = data;
+    len_ = len;
+    start_ = start;
+    palette_ = data + GFX_IMAGE_HEADER_SIZE;
+    width_ = width;
+    height_ = height;
+    encoding_ = encoding;
+    paletteSize_ = paletteSize;
+    rewind();
+    return true;
+}
+
+void GfxImageDecoder::rewind() {
+    pos_ = start_;
+    left_ = data_ ? (uint32_t)width_ * height_ : 0;
+    error_ = false;
+    packetLeft_ = 0;
+    packetRun_ = false;
+}
+
+bool GfxImageDecoder::loadPacket() {
+    if (encoding_ == GFX_IMAGE_RAW) {
+        // The whole stream is one literal (length checked in begin())
+        packetRun_ = false;
+        packetLeft_ = left_;
+        return true;
+    }
+
+    if (pos_ >= len_) {
+        return fail();
+    }
+    uint8_t control = data_[pos_++];
+    uint32_t count = control & 0x3F;
+    if (control & 0x40) {
+        if (pos_ >= len_) {
+            return fail();
+        }
+        count = (count << 8) | data_[pos_++];
+    }
+    count++;
+    if (count > left_) {
+        return fail();
+    }
+
+    size_t valueSize = (encoding_ == GFX_IMAGE_INDEXED) ? 1 : 2;
+    packetRun_ = (control & 0x80) != 0;
+    packetLeft_ = count;
+
+    if (packetRun_) {
+        if (len_ - pos_ < valueSize) {
+            return fail();
+        }
+        if (valueSize == 1) {
+            uint8_t index = data_[pos_++];
+            if (index >= paletteSize_) {
+                return fail();
+            }
+            runColor_ = readLE16(palette_ + (size_t)index * 2);
+        } else {
+            runColor_ = readLE16(data_ + pos_);
+            pos_ += 2;
+        }
+    } else if (len_ - pos_ < (size_t)count * valueSize) {
+        return fail();
+    }
+    return true;
+}
+
+bool GfxImageDecoder::readValues(uint16_t* out, uint32_t count) {
+    if (encoding_ == GFX_IMAGE_INDEXED) {
+        const uint8_t* src = data_ + pos_;
+        for (uint32_t i = 0; i < count; i++) {
+            uint8_t index = src[i];
+            if (index >= paletteSize_) {
+                return fail();
+            }
+            out[i] = readLE16(palette_ + (size_t)index * 2);
+        }
+        pos_ += count;
+    } else {
+        const uint8_t* src = data_ + pos_;
+        for (uint32_t i = 0; i < count; i++) {
+            out[i] = readLE16(src + i * 2);
+        }
+        pos_ += (size_t)count * 2;
+    }
+    return true;
+}
+
+bool GfxImageDecoder::next(GfxImageChunk& chunk) {
+    if (!data_ || error_ || left_ == 0) {
+        return false;
+    }
+
+    uint32_t n = 0;
+    while (left_ > 0 && n < POCKETOS_GFX_IMAGE_CHUNK) {
+        if (packetLeft_ == 0 && !loadPacket()) {
+            return false;
+        }
+
+        if (packetRun_ && packetLeft_ >= POCKETOS_GFX_IMAGE_MIN_FILL) {
+            if (n > 0) {
+                break;  // Hand out the buffered pixels first
+            }
+            chunk.fill = true;
+            chunk.color = runColor_;
+            chunk.count = packetLeft_;
+            chunk.pixels = nullptr;
+            left_ -= packetLeft_;
+            packetLeft_ = 0;
+            return true;
+        }
+
+        uint32_t take = packetLeft_;
+        if (take > POCKETOS_GFX_IMAGE_CHUNK - n) {
+            take = POCKETOS_GFX_IMAGE_CHUNK - n;
+        }
+        if (packetRun_) {
+            for (uint32_t i = 0; i < take; i++) {
+                buffer_[n + i] = runColor_;
+            }
+        } else if (!readValues(buffer_ + n, take)) {
+            return false;
+        }
+        n += take;
+        packetLeft_ -= take;
+        left_ -= take;
+    }
+
+    chunk.fill = false;
+    chunk.color = 0;
+    chunk.count = n;
+    chunk.pixels = buffer_;
+    return true;
+}
+
+bool GfxImageDecoder::readRow(uint16_t* out) {
+    if (!data_ || error_ || left_ < width_ || !out) {
+        return false;
+    }
+
+    uint32_t need = width_;
+    while (need > 0) {
+        if (packetLeft_ == 0 && !loadPacket()) {
+            return false;
+        }
+        uint32_t take = packetLeft_ < need ? packetLeft_ : need;
+        if (packetRun_) {
+            for (uint32_t i = 0; i < take; i++) {
+                out[i] = runColor_;
+            }
+        } else if (!readValues(out, take)) {
+            return false;
+        }
+        out += take;
+        need -= take;
+        packetLeft_ -= take;
+        left_ -= take;
+    }
+    return true;
+}
+
+// ---- Streaming ----
+
+bool gfxStreamImage(GfxImageDecoder& image, int32_t x, int32_t y, uint16_t clipW, uint16_t clipH,
+                    const GfxImageSink& sink) {
+    int32_t w = image.width();
+    int32_t h = image.height();
+    bool clipped = clipW && clipH && (x < 0 || y < 0 || x + w > clipW || y + h > clipH);
+
+    if (!clipped) {
+        // One window: runs become fills, literals stream in chunks
+        sink.window(sink.context, x, y, (uint16_t)w, (uint16_t)h);
+        GfxImageChunk chunk;
+        while (image.next(chunk)) {
+            if (chunk.fill) {
+                sink.fill(sink.context, chunk.color, chunk.count);
+            } else {
+                sink.push(sink.context, chunk.pixels, chunk.count);
+            }
+        }
+        if (sink.end) {
+            sink.end(sink.context);
+        }
+        return !image.error();
+    }
+
+    // Clipped: a row at a time, each visible slice its own window
+    if (w > POCKETOS_GFX_IMAGE_MAX_ROW) {
+        return false;
+    }
+    int32_t x0 = x < 0 ? 0 : x;
+    int32_t x1 = x + w > clipW ? clipW : x + w;
+    uint16_t row[POCKETOS_GFX_IMAGE_MAX_ROW];
+    for (int32_t r = 0; r < h && y + r < clipH; r++) {
+        if (!image.readRow(row)) {
+            break;
+        }
+        if (y + r < 0 || x0 >= x1) {
+            continue;
+        }
+        sink.window(sink.context, x0, y + r, (uint16_t)(x1 - x0), 1);
+        sink.push(sink.context, row + (x0 - x), (uint32_t)(x1 - x0));
+        if (sink.end) {
+            sink.end(sink.context);
+        }
+    }
+    return !image.error();
+}
+
+GfxImageRectSink::GfxImageRectSink(void* context, FillFn fill, WriteFn write)
+    : context_(context), fill_(fill), write_(write), x_(0), y_(0), w_(0), col_(0), row_(0) {
+}
+
+GfxImageSink GfxImageRectSink::sink() {
+    GfxImageSink s = { this, &GfxImageRectSink::onWindow, &GfxImageRectSink::onFill,
+                       &GfxImageRectSink::onPush, nullptr };
+    return s;
+}
+
+void GfxImageRectSink::onWindow(void* self, int32_t x, int32_t y, uint16_t w, uint16_t) {
+    GfxImageRectSink* s = static_cast<GfxImageRectSink*>(self);
+    s->x_ = x;
+    s->y_ = y;
+    s->w_ = w;
+    s->col_ = 0;
+    s->row_ = 0;
+}
+
+void GfxImageRectSink::onFill(void* self, uint16_t color, uint32_t count) {
+    GfxImageRectSink* s = static_cast<GfxImageRectSink*>(self);
+    while (count > 0) {
+        if (s->col_ == 0 && count >= (uint32_t)s->w_) {
+            int32_t rows = (int32_t)(count / s->w_);
+            s->fill_(s->context_, s->x_, s->y_ + s->row_, s->w_, rows, color);
+            s->row_ += rows;
+            count -= (uint32_t)(rows * s->w_);
+            continue;
+        }
+        int32_t take = s->w_ - s->col_;
+        if ((uint32_t)take > count) {
+            take = (int32_t)count;
+        }
+        s->fill_(s->context_, s->x_ + s->col_, s->y_ + s->row_, take, 1, color);
+        count -= (uint32_t)take;
+        s->col_ += take;
+        if (s->col_ == s->w_) {
+            s->col_ = 0;
+            s->row_++;
+        }
+    }
+}
+
+void GfxImageRectSink::onPush(void* self, const uint16_t* pixels, uint32_t count) {
+    GfxImageRectSink* s = static_cast<GfxImageRectSink*>(self);
+    while (count > 0) {
+        int32_t take = s->w_ - s->col_;
+        if ((uint32_t)take > count) {
+            take = (int32_t)count;
+        }
+        s->write_(s->context_, s->x_ + s->col_, s->y_ + s->row_, take, pixels);
+        pixels += take;
+        count -= (uint32_t)take;
+        s->col_ += take;
+        if (s->col_ == s->w_) {
+            s->col_ = 0;
+            s->row_++;
+        }
+    }
+}
+
+} // namespace PocketOS
@@ -0,0 +1,194 @@
+#ifndef POCKETOS_GFX_IMAGE_H
+#define POCKETOS_GFX_IMAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PocketOS {
+
+/**
+ * Compressed Image Format (PIMG)
+ *
+ * RGB565 images for the TFT drivers, stored in flash and decoded while
+ * they stream to the panel. Produced on the host by tools/pimg/pimgconv.
+ *
+ * Header (12 bytes, little-endian):
+ *   0  "PIMG"
+ *   4  version (1)
+ *   5  encoding (GfxImageEncoding)
+ *   6  width
+ *   8  height
+ *   10 palette entries (INDEXED: 1-256, otherwise 0)
+ * followed by the palette (RGB565 per entry), then the pixel stream.
+ *
+ * The pixel stream covers width x height pixels in row order. RAW is
+ * plain RGB565. RLE565 and INDEXED are a sequence of packets, which may
+ * cross row boundaries:
+ *   control byte: bit 7 = run (one value follows) / literal (count values)
+ *                 bit 6 = long count, low 6 bits are the high byte of
+ *                 count - 1 and the next byte the low byte (up to 16384)
+ *                 otherwise count - 1 is in the low 6 bits (up to 64)
+ *   value:        RGB565 (2 bytes) for RLE565, palette index (1 byte) for INDEXED
+ *
+ * GfxImageDecoder never expands the whole image: next() hands out the
+ * stream as block fills (runs of at least POCKETOS_GFX_IMAGE_MIN_FILL)
+ * and small RGB565 buffers. gfxStreamImage() hands those to a
+ * GfxImageSink, which the TFT drivers write straight into one address
+ * window.
+ */
+
+// Literal pixels translated per next() call (decoder RAM: 2 bytes each)
+// Can be overridden via build flags: -DPOCKETOS_GFX_IMAGE_CHUNK=128
+#ifndef POCKETOS_GFX_IMAGE_CHUNK
+#define POCKETOS_GFX_IMAGE_CHUNK 64
+#endif
+
+// Shortest run handed out as a block fill; shorter runs are buffered
+#ifndef POCKETOS_GFX_IMAGE_MIN_FILL
+#define POCKETOS_GFX_IMAGE_MIN_FILL 16
+#endif
+
+// Widest image the row-at-a-time path (clipped / framebuffer) can draw
+#ifndef POCKETOS_GFX_IMAGE_MAX_ROW
+#define POCKETOS_GFX_IMAGE_MAX_ROW 320
+#endif
+
+#define GFX_IMAGE_HEADER_SIZE 12
+#define GFX_IMAGE_VERSION 1
+#define GFX_IMAGE_MAX_PALETTE 256
+#define GFX_IMAGE_MAX_SHORT 64
+#define GFX_IMAGE_MAX_COUNT 16384
+
+enum GfxImageEncoding {
+    GFX_IMAGE_RAW = 0,
+    GFX_IMAGE_RLE565 = 1,
+    GFX_IMAGE_INDEXED = 2
+};
+
+// One piece of the pixel stream
+struct GfxImageChunk {
+    bool fill;                 // true: count pixels of color
+    uint16_t color;
+    uint32_t count;
+    const uint16_t* pixels;    // fill == false: count RGB565 pixels
+};
+
+class GfxImageDecoder {
+public:
+    GfxImageDecoder();
+
+    // Parse and check the header; false if data is not a valid image
+    bool begin(const uint8_t* data, size_t len);
+
+    // Back to the first pixel
+    void rewind();
+
+    uint16_t width() const { return width_; }
+    uint16_t height() const { return height_; }
+    uint8_t encoding() const { return encoding_; }
+    uint16_t paletteSize() const { return paletteSize_; }
+    uint32_t pixelsLeft() const { return left_; }
+
+    // True once the stream turned out to be truncated or corrupt
+    bool error() const { return error_; }
+
+    // Next piece of the stream in pixel order (pieces may cross rows).
+    // chunk.pixels stays valid until the next call. False at the end or
+    // on error.
+    bool next(GfxImageChunk& chunk);
+
+    // Next row, width() pixels
+    bool readRow(uint16_t* out);
+
+private:
+    const uint8_t* data_;
+    size_t len_;
+    size_t start_;      // First byte of the pixel stream
+    size_t pos_;
+    const uint8_t* palette_;
+
+    uint16_t width_;
+    uint16_t height_;
+    uint8_t encoding_;
+    uint16_t paletteSize_;
+
+    uint32_t left_;     // Pixels not handed out yet
+    bool error_;
+
+    // Current packet
+    uint32_t packetLeft_;
+    bool packetRun_;
+    uint16_t runColor_;
+
+    uint16_t buffer_[POCKETOS_GFX_IMAGE_CHUNK];
+
+    bool loadPacket();
+    // Values of the current literal packet; bounds were checked by loadPacket()
+    bool readValues(uint16_t* out, uint32_t count);
+    bool fail() { error_ = true; return false; }
+};
+
+// Destination of gfxStreamImage(): an address window that takes pixels in
+// row order (the TFT controllers). Every callback gets context.
+struct GfxImageSink {
+    void* context;
+    // Open a w x h window at (x, y)
+    void (*window)(void* context, int32_t x, int32_t y, uint16_t w, uint16_t h);
+    // count pixels of one colour
+    void (*fill)(void* context, uint16_t color, uint32_t count);
+    // count RGB565 pixels
+    void (*push)(void* context, const uint16_t* pixels, uint32_t count);
+    // Window complete (nullptr if nothing to do)
+    void (*end)(void* context);
+};
+
+/**
+ * Draw a PIMG image through a sink, the one decode loop for all targets.
+ *
+ * An image that fits [0, clipW) x [0, clipH) at (x, y) is a single window:
+ * runs become fills, literal pixels pushes. Otherwise it is drawn a row at
+ * a time, each row clipped into its own window (images up to
+ * POCKETOS_GFX_IMAGE_MAX_ROW wide). clipW/clipH of 0: the sink clips
+ * itself and the image is always one window.
+ *
+ * image must have been begin()'d. False if the image is too wide to clip
+ * or the stream is corrupt (then image.error() is set).
+ */
+bool gfxStreamImage(GfxImageDecoder& image, int32_t x, int32_t y, uint16_t clipW, uint16_t clipH,
+                    const GfxImageSink& sink);
+
+/**
+ * Image sink for targets that take rectangles instead of a window
+ * (GfxRenderer, TFTFramebuffer). Fills and pushes are split at row ends;
+ * a fill covering whole rows is one rectangle.
+ */
+class GfxImageRectSink {
+public:
+    typedef void (*FillFn)(void* context, int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+    typedef void (*WriteFn)(void* context, int32_t x, int32_t y, int32_t w, const uint16_t* pixels);
+
+    GfxImageRectSink(void* context, FillFn fill, WriteFn write);
+
+    // Valid while this object lives
+    GfxImageSink sink();
+
+private:
+    void* context_;
+    FillFn fill_;
+    WriteFn write_;
+
+    // Current window and position in it
+    int32_t x_;
+    int32_t y_;
+    int32_t w_;
+    int32_t col_;
+    int32_t row_;
+
+    static void onWindow(void* self, int32_t x, int32_t y, uint16_t w, uint16_t h);
+    static void onFill(void* self, uint16_t color, uint32_t count);
+    static void onPush(void* self, const uint16_t* pixels, uint32_t count);
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_GFX_IMAGE_H
@@ -0,0 +1,51 @@
+#ifndef POCKETOS_GFX_PANEL_H
+#define POCKETOS_GFX_PANEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PocketOS {
+
+/**
+ * Graphics Panel Interface
+ *
+ * The minimal surface GfxRenderer draws on. Colours are RGB565; 1bpp
+ * panels threshold them. All coordinates reach the panel already clipped,
+ * so backends never bounds-check.
+ *
+ * The renderer only emits horizontal spans, solid rectangles and pixel
+ * rectangles. Backends are free to batch them (e.g. merge stacked spans
+ * into one window write) as long as everything is on the panel after
+ * flush().
+ *
+ * This header has no Arduino dependency so the renderer can be built on
+ * the host against GfxMemorySurface.
+ */
+class IGfxPanel {
+public:
+    virtual ~IGfxPanel() {}
+
+    virtual uint16_t width() const = 0;
+    virtual uint16_t height() const = 0;
+
+    // Solid horizontal run of w pixels
+    virtual void fillSpan(uint16_t x, uint16_t y, uint16_t w, uint16_t color) = 0;
+
+    // Solid rectangle (default: one span per row)
+    virtual void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+        for (uint16_t r = 0; r < h; r++) {
+            fillSpan(x, y + r, w, color);
+        }
+    }
+
+    // Pixel rectangle; row r starts at pixels + r * stride
+    virtual void writeRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                           const uint16_t* pixels, size_t stride) = 0;
+
+    // Push out anything the backend is still batching
+    virtual void flush() {}
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_GFX_PANEL_H
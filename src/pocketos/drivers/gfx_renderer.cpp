@@ -0,0 +1,385 @@
+#include "gfx_renderer.h"
+#include "gfx_image.h"
+
+namespace PocketOS {
+
+static inline void swap16(int16_t& a, int16_t& b) {
+    int16_t t = a;
+    a = b;
+    b = t;
+}
+
+GfxRenderer::GfxRenderer(IGfxPanel& panel)
+    : panel_(panel), clipX0_(0), clipY0_(0), clipX1_(0), clipY1_(0),
+      font_(&GFX_FONT_5X7), textFg_(0xFFFF), textBg_(0x0000), textOpaque_(false), textScale_(1) {
+    resetClip();
+}
+
+void GfxRenderer::setClip(int16_t x, int16_t y, int16_t w, int16_t h) {
+    int32_t x1 = (int32_t)x + w;
+    int32_t y1 = (int32_t)y + h;
+    clipX0_ = x < 0 ? 0 : x;
+    clipY0_ = y < 0 ? 0 : y;
+    clipX1_ = (int16_t)(x1 > width() ? width() : x1);
+    clipY1_ = (int16_t)(y1 > height() ? height() : y1);
+}
+
+void GfxRenderer::resetClip() {
+    clipX0_ = 0;
+    clipY0_ = 0;
+    clipX1_ = width();
+    clipY1_ = height();
+}
+
+// ---- Clipped emitters ----
+
+void GfxRenderer::span(int32_t x, int32_t y, int32_t w, uint16_t color) {
+    if (y < clipY0_ || y >= clipY1_ || w <= 0) {
+        return;
+    }
+    int32_t x1 = x + w;
+    if (x < clipX0_) x = clipX0_;
+    if (x1 > clipX1_) x1 = clipX1_;
+    if (x >= x1) {
+        return;
+    }
+    stats_.spans++;
+    stats_.pixels += (uint32_t)(x1 - x);
+    panel_.fillSpan((uint16_t)x, (uint16_t)y, (uint16_t)(x1 - x), color);
+}
+
+void GfxRenderer::rect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+    if (h == 1) {
+        span(x, y, w, color);
+        return;
+    }
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    int32_t x1 = x + w;
+    int32_t y1 = y + h;
+    if (x < clipX0_) x = clipX0_;
+    if (y < clipY0_) y = clipY0_;
+    if (x1 > clipX1_) x1 = clipX1_;
+    if (y1 > clipY1_) y1 = clipY1_;
+    if (x >= x1 || y >= y1) {
+        return;
+    }
+    stats_.rects++;
+    stats_.pixels += (uint32_t)(x1 - x) * (uint32_t)(y1 - y);
+    panel_.fillRect((uint16_t)x, (uint16_t)y, (uint16_t)(x1 - x), (uint16_t)(y1 - y), color);
+}
+
+void GfxRenderer::image(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* pixels, size_t stride) {
+    if (!pixels || w <= 0 || h <= 0) {
+        return;
+    }
+    int32_t x1 = x + w;
+    int32_t y1 = y + h;
+    int32_t skipX = x < clipX0_ ? clipX0_ - x : 0;
+    int32_t skipY = y < clipY0_ ? clipY0_ - y : 0;
+    x += skipX;
+    y += skipY;
+    if (x1 > clipX1_) x1 = clipX1_;
+    if (y1 > clipY1_) y1 = clipY1_;
+    if (x >= x1 || y >= y1) {
+        return;
+    }
+    stats_.writes++;
+    stats_.pixels += (uint32_t)(x1 - x) * (uint32_t)(y1 - y);
+    panel_.writeRect((uint16_t)x, (uint16_t)y, (uint16_t)(x1 - x), (uint16_t)(y1 - y),
+                     pixels + (size_t)skipY * stride + skipX, stride);
+}
+
+// ---- Primitives ----
+
+void GfxRenderer::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    span(x, y, 1, color);
+}
+
+void GfxRenderer::drawHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    span(x, y, w, color);
+}
+
+void GfxRenderer::drawVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    rect(x, y, 1, h, color);
+}
+
+void GfxRenderer::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    if (y0 == y1) {
+        if (x1 < x0) swap16(x0, x1);
+        span(x0, y0, (int32_t)x1 - x0 + 1, color);
+        return;
+    }
+    if (x0 == x1) {
+        if (y1 < y0) swap16(y0, y1);
+        rect(x0, y0, 1, (int32_t)y1 - y0 + 1, color);
+        return;
+    }
+
+    // Bresenham along the major axis; each run of constant minor
+    // coordinate is emitted once (a span, or a 1-wide rect when steep)
+    bool steep = (y1 > y0 ? y1 - y0 : y0 - y1) > (x1 > x0 ? x1 - x0 : x0 - x1);
+    if (steep) {
+        swap16(x0, y0);
+        swap16(x1, y1);
+    }
+    if (x0 > x1) {
+        swap16(x0, x1);
+        swap16(y0, y1);
+    }
+
+    int32_t dx = (int32_t)x1 - x0;
+    int32_t dy = y1 > y0 ? (int32_t)y1 - y0 : (int32_t)y0 - y1;
+    int32_t ystep = y0 < y1 ? 1 : -1;
+    int32_t err = dx / 2;
+    int32_t y = y0;
+    int32_t runStart = x0;
+
+    for (int32_t x = x0; x <= x1; x++) {
+        err -= dy;
+        if (err < 0 || x == x1) {
+            int32_t len = x - runStart + 1;
+            if (steep) {
+                rect(y, runStart, 1, len, color);
+            } else {
+                span(runStart, y, len, color);
+            }
+            runStart = x + 1;
+        }
+        if (err < 0) {
+            y += ystep;
+            err += dx;
+        }
+    }
+}
+
+void GfxRenderer::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    span(x, y, w, color);
+    if (h > 1) {
+        span(x, (int32_t)y + h - 1, w, color);
+    }
+    if (h > 2) {
+        rect(x, (int32_t)y + 1, 1, h - 2, color);
+        if (w > 1) {
+            rect((int32_t)x + w - 1, (int32_t)y + 1, 1, h - 2, color);
+        }
+    }
+}
+
+void GfxRenderer::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    rect(x, y, w, h, color);
+}
+
+void GfxRenderer::fillScreen(uint16_t color) {
+    rect(0, 0, width(), height(), color);
+}
+
+void GfxRenderer::drawCircle(int16_t cx, int16_t cy, int16_t r, uint16_t color) {
+    if (r < 0) {
+        return;
+    }
+    if (r == 0) {
+        span(cx, cy, 1, color);
+        return;
+    }
+
+    // Midpoint circle. In the octant from the top, x advances while y
+    // holds, so each run [xs, x] at row y is one span (mirrored to the
+    // bottom) and one vertical run in the side octants.
+    int32_t x = 0;
+    int32_t y = r;
+    int32_t f = 1 - r;
+    int32_t ddx = 1;
+    int32_t ddy = -2 * (int32_t)r;
+    int32_t xs = 0;
+
+    while (true) {
+        bool more = x < y;
+        int32_t nx = x;
+        int32_t ny = y;
+        if (more) {
+            if (f >= 0) {
+                ny--;
+                ddy += 2;
+                f += ddy;
+            }
+            nx++;
+            ddx += 2;
+            f += ddx;
+        }
+
+        if (!more || ny != y) {
+            int32_t len = x - xs + 1;
+            span(cx + xs, cy - y, len, color);
+            span(cx - x, cy - y, len, color);
+            span(cx + xs, cy + y, len, color);
+            span(cx - x, cy + y, len, color);
+            rect(cx + y, cy + xs, 1, len, color);
+            rect(cx + y, cy - x, 1, len, color);
+            rect(cx - y, cy + xs, 1, len, color);
+            rect(cx - y, cy - x, 1, len, color);
+            xs = nx;
+        }
+
+        if (!more) {
+            break;
+        }
+        x = nx;
+        y = ny;
+    }
+}
+
+void GfxRenderer::fillCircle(int16_t cx, int16_t cy, int16_t r, uint16_t color) {
+    if (r < 0) {
+        return;
+    }
+
+    // Same walk as drawCircle: rows cy +/- x are filled once per step,
+    // rows cy +/- y once per run (with the run's widest x)
+    int32_t x = 0;
+    int32_t y = r;
+    int32_t f = 1 - r;
+    int32_t ddx = 1;
+    int32_t ddy = -2 * (int32_t)r;
+
+    while (true) {
+        span(cx - y, cy + x, 2 * y + 1, color);
+        if (x > 0) {
+            span(cx - y, cy - x, 2 * y + 1, color);
+        }
+
+        bool more = x < y;
+        int32_t nx = x;
+        int32_t ny = y;
+        if (more) {
+            if (f >= 0) {
+                ny--;
+                ddy += 2;
+                f += ddy;
+            }
+            nx++;
+            ddx += 2;
+            f += ddx;
+        }
+
+        if ((!more || ny != y) && y > x) {
+            span(cx - x, cy - y, 2 * x + 1, color);
+            span(cx - x, cy + y, 2 * x + 1, color);
+        }
+
+        if (!more) {
+            break;
+        }
+        x = nx;
+        y = ny;
+    }
+}
+
+void GfxRenderer::blit(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pixels) {
+    image(x, y, w, h, pixels, (size_t)(w > 0 ? w : 0));
+}
+
+bool GfxRenderer::drawCompressedImage(int16_t x, int16_t y, const uint8_t* data, size_t len) {
+    GfxImageDecoder decoder;
+    if (!decoder.begin(data, len)) {
+        return false;
+    }
+
+    // One window, split into spans/rects/row slices; the emitters clip
+    GfxImageRectSink rects(this, &GfxRenderer::imageFill, &GfxRenderer::imageWrite);
+    return gfxStreamImage(decoder, x, y, 0, 0, rects.sink());
+}
+
+void GfxRenderer::imageFill(void* self, int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+    GfxRenderer* gfx = static_cast<GfxRenderer*>(self);
+    if (h == 1) {
+        gfx->span(x, y, w, color);
+    } else {
+        gfx->rect(x, y, w, h, color);
+    }
+}
+
+void GfxRenderer::imageWrite(void* self, int32_t x, int32_t y, int32_t w, const uint16_t* pixels) {
+    static_cast<GfxRenderer*>(self)->image(x, y, w, 1, pixels, (size_t)w);
+}
+
+// ---- Text ----
+
+int16_t GfxRenderer::drawChar(int16_t x, int16_t y, char c) {
+    int32_t s = textScale_;
+    int32_t cellW = (int32_t)font_->advance * s;
+    int32_t cellH = (int32_t)font_->lineHeight * s;
+
+    // Skip cells entirely outside the clip rectangle
+    if (x + cellW <= clipX0_ || x >= clipX1_ || y + cellH <= clipY0_ || y >= clipY1_) {
+        return (int16_t)(x + cellW);
+    }
+
+    if (textOpaque_) {
+        const uint16_t* cell = GfxGlyphCache::lookup(font_, c, textFg_, textBg_, textScale_);
+        if (cell) {
+            image(x, y, cellW, cellH, cell, (size_t)cellW);
+            return (int16_t)(x + cellW);
+        }
+        // Too large to cache: background, then the glyph on top
+        rect(x, y, cellW, cellH, textBg_);
+    }
+
+    const uint8_t* cols = font_->glyph(c);
+    if (!cols) {
+        return (int16_t)(x + cellW);
+    }
+
+    // Runs of set bits along each glyph row
+    for (uint8_t row = 0; row < font_->glyphHeight; row++) {
+        uint8_t col = 0;
+        while (col < font_->glyphWidth) {
+            if (!(cols[col] & (1 << row))) {
+                col++;
+                continue;
+            }
+            uint8_t start = col;
+            while (col < font_->glyphWidth && (cols[col] & (1 << row))) {
+                col++;
+            }
+            rect(x + start * s, y + row * s, (col - start) * s, s, textFg_);
+        }
+    }
+    return (int16_t)(x + cellW);
+}
+
+int16_t GfxRenderer::drawText(int16_t x, int16_t y, const char* text) {
+    if (!text) {
+        return x;
+    }
+    int16_t startX = x;
+    for (const char* p = text; *p; p++) {
+        if (*p == '\n') {
+            x = startX;
+            y += textHeight();
+        } else {
+            x = drawChar(x, y, *p);
+        }
+    }
+    return x;
+}
+
+int16_t GfxRenderer::textWidth(const char* text) const {
+    int32_t widest = 0;
+    int32_t line = 0;
+    for (const char* p = text; p && *p; p++) {
+        if (*p == '\n') {
+            line = 0;
+        } else {
+            line += (int32_t)font_->advance * textScale_;
+            if (line > widest) widest = line;
+        }
+    }
+    return (int16_t)widest;
+}
+
+} // namespace PocketOS
@@ -0,0 +1,121 @@
+#ifndef POCKETOS_GFX_RENDERER_H
+#define POCKETOS_GFX_RENDERER_H
+
+#include "gfx_panel.h"
+#include "gfx_font.h"
+
+namespace PocketOS {
+
+/**
+ * 2D Renderer
+ *
+ * Shared drawing layer for all display drivers. Primitives are reduced to
+ * horizontal spans, solid rectangles and pixel rectangles on an IGfxPanel:
+ *
+ * - Lines: Bresenham, emitting each horizontal (or vertical) run once
+ *   rather than one call per pixel
+ * - Rectangles, circles (outline and filled) as spans
+ * - blit(): RGB565 image, clipped, one pixel-rectangle write
+ * - drawCompressedImage(): PIMG image (gfx_image.h), runs as spans or
+ *   rectangles, literal pixels as row slices
+ * - Text: opaque glyphs come pre-rasterized from GfxGlyphCache;
+ *   transparent glyphs are drawn as runs of set bits
+ *
+ * Everything is clipped against the clip rectangle (default: whole panel).
+ * Coordinates are signed so shapes may extend off-screen.
+ *
+ *   GfxRenderer gfx(panel);
+ *   gfx.fillRect(0, 0, 240, 20, 0x001F);
+ *   gfx.setTextColor(0xFFFF, 0x001F);
+ *   gfx.drawText(4, 6, "Temp 21.4C");
+ *   gfx.flush();
+ */
+
+// Calls issued to the panel (for draw-call measurements)
+struct GfxStats {
+    uint32_t spans;
+    uint32_t rects;
+    uint32_t writes;
+    uint32_t pixels;
+
+    GfxStats() : spans(0), rects(0), writes(0), pixels(0) {}
+};
+
+class GfxRenderer {
+public:
+    explicit GfxRenderer(IGfxPanel& panel);
+
+    IGfxPanel& panel() { return panel_; }
+    int16_t width() const { return (int16_t)panel_.width(); }
+    int16_t height() const { return (int16_t)panel_.height(); }
+
+    // Clipping (intersected with the panel)
+    void setClip(int16_t x, int16_t y, int16_t w, int16_t h);
+    void resetClip();
+
+    // Primitives
+    void drawPixel(int16_t x, int16_t y, uint16_t color);
+    void drawHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    void drawVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillScreen(uint16_t color);
+    void drawCircle(int16_t cx, int16_t cy, int16_t r, uint16_t color);
+    void fillCircle(int16_t cx, int16_t cy, int16_t r, uint16_t color);
+
+    // RGB565 image, rows of w pixels
+    void blit(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pixels);
+
+    // PIMG image (see gfx_image.h); false if the data is invalid or corrupt
+    bool drawCompressedImage(int16_t x, int16_t y, const uint8_t* data, size_t len);
+
+    // Text
+    void setFont(const GfxFont* font) { font_ = font ? font : &GFX_FONT_5X7; }
+    const GfxFont* getFont() const { return font_; }
+    void setTextColor(uint16_t fg) { textFg_ = fg; textOpaque_ = false; }
+    void setTextColor(uint16_t fg, uint16_t bg) { textFg_ = fg; textBg_ = bg; textOpaque_ = true; }
+    void setTextScale(uint8_t scale) { textScale_ = scale ? scale : 1; }
+
+    // Returns the x position after the character/text
+    int16_t drawChar(int16_t x, int16_t y, char c);
+    int16_t drawText(int16_t x, int16_t y, const char* text);
+    int16_t textWidth(const char* text) const;
+    int16_t textHeight() const { return (int16_t)font_->lineHeight * textScale_; }
+
+    // Push out anything the panel backend is batching
+    void flush() { panel_.flush(); }
+
+    const GfxStats& stats() const { return stats_; }
+    void resetStats() { stats_ = GfxStats(); }
+
+private:
+    IGfxPanel& panel_;
+
+    // Clip rectangle, exclusive right/bottom
+    int16_t clipX0_;
+    int16_t clipY0_;
+    int16_t clipX1_;
+    int16_t clipY1_;
+
+    const GfxFont* font_;
+    uint16_t textFg_;
+    uint16_t textBg_;
+    bool textOpaque_;
+    uint8_t textScale_;
+
+    GfxStats stats_;
+
+    // Clipped emitters; everything reaches the panel through these
+    void span(int32_t x, int32_t y, int32_t w, uint16_t color);
+    void rect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+    void image(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* pixels, size_t stride);
+
+    // GfxImageRectSink callbacks for drawCompressedImage()
+    static void imageFill(void* self, int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+    static void imageWrite(void* self, int32_t x, int32_t y, int32_t w, const uint16_t* pixels);
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_GFX_RENDERER_H
@@ -0,0 +1,129 @@
+#include "gfx_surface.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace PocketOS {
+
+GfxMemorySurface::GfxMemorySurface()
+    : pixels_(nullptr), width_(0), height_(0),
+      spanCalls_(0), rectCalls_(0), writeCalls_(0), pixelsTouched_(0) {
+}
+
+GfxMemorySurface::~GfxMemorySurface() {
+    end();
+}
+
+bool GfxMemorySurface::begin(uint16_t width, uint16_t height) {
+    end();
+    if (width == 0 || height == 0) {
+        return false;
+    }
+
+    pixels_ = (uint16_t*)calloc((size_t)width * height, sizeof(uint16_t));
+    if (!pixels_) {
+        return false;
+    }
+    width_ = width;
+    height_ = height;
+    resetCounters();
+    return true;
+}
+
+void GfxMemorySurface::end() {
+    free(pixels_);
+    pixels_ = nullptr;
+    width_ = 0;
+    height_ = 0;
+}
+
+void GfxMemorySurface::fillSpan(uint16_t x, uint16_t y, uint16_t w, uint16_t color) {
+    spanCalls_++;
+    pixelsTouched_ += w;
+    uint16_t* p = pixels_ + (size_t)y * width_ + x;
+    for (uint16_t i = 0; i < w; i++) {
+        p[i] = color;
+    }
+}
+
+void GfxMemorySurface::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    rectCalls_++;
+    pixelsTouched_ += (uint32_t)w * h;
+    for (uint16_t r = 0; r < h; r++) {
+        uint16_t* p = pixels_ + (size_t)(y + r) * width_ + x;
+        for (uint16_t i = 0; i < w; i++) {
+            p[i] = color;
+        }
+    }
+}
+
+void GfxMemorySurface::writeRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                                 const uint16_t* pixels, size_t stride) {
+    writeCalls_++;
+    pixelsTouched_ += (uint32_t)w * h;
+    for (uint16_t r = 0; r < h; r++) {
+        memcpy(pixels_ + (size_t)(y + r) * width_ + x, pixels + (size_t)r * stride, (size_t)w * 2);
+    }
+}
+
+uint16_t GfxMemorySurface::getPixel(uint16_t x, uint16_t y) const {
+    if (!pixels_ || x >= width_ || y >= height_) {
+        return 0;
+    }
+    return pixels_[(size_t)y * width_ + x];
+}
+
+void GfxMemorySurface::clear(uint16_t color) {
+    if (!pixels_) {
+        return;
+    }
+    size_t count = (size_t)width_ * height_;
+    for (size_t i = 0; i < count; i++) {
+        pixels_[i] = color;
+    }
+}
+
+bool GfxMemorySurface::writePPM(GfxWriteFn write, void* context) const {
+    if (!pixels_ || !write) {
+        return false;
+    }
+
+    char header[24];
+    int len = snprintf(header, sizeof(header), "P6\n%u %u\n255\n", (unsigned)width_, (unsigned)height_);
+    if (write(context, (const uint8_t*)header, (size_t)len) != (size_t)len) {
+        return false;
+    }
+
+    // One row at a time keeps the stack small on target
+    uint8_t row[3 * 64];
+    for (uint16_t y = 0; y < height_; y++) {
+        const uint16_t* src = pixels_ + (size_t)y * width_;
+        uint16_t x = 0;
+        while (x < width_) {
+            uint16_t n = (width_ - x) < 64 ? (width_ - x) : 64;
+            for (uint16_t i = 0; i < n; i++) {
+                uint16_t c = src[x + i];
+                uint8_t r5 = (c >> 11) & 0x1F;
+                uint8_t g6 = (c >> 5) & 0x3F;
+                uint8_t b5 = c & 0x1F;
+                row[i * 3] = (uint8_t)((r5 << 3) | (r5 >> 2));
+                row[i * 3 + 1] = (uint8_t)((g6 << 2) | (g6 >> 4));
+                row[i * 3 + 2] = (uint8_t)((b5 << 3) | (b5 >> 2));
+            }
+            if (write(context, row, (size_t)n * 3) != (size_t)n * 3) {
+                return false;
+            }
+            x += n;
+        }
+    }
+    return true;
+}
+
+void GfxMemorySurface::resetCounters() {
+    spanCalls_ = 0;
+    rectCalls_ = 0;
+    writeCalls_ = 0;
+    pixelsTouched_ = 0;
+}
+
+} // namespace PocketOS
@@ -0,0 +1,66 @@
+#ifndef POCKETOS_GFX_SURFACE_H
+#define POCKETOS_GFX_SURFACE_H
+
+#include "gfx_panel.h"
+
+namespace PocketOS {
+
+// Byte sink for image export (fwrite wrapper on the host, File/Serial on target).
+// Returns the number of bytes accepted.
+typedef size_t (*GfxWriteFn)(void* context, const uint8_t* data, size_t len);
+
+/**
+ * In-memory RGB565 Panel
+ *
+ * Renders into RAM instead of a display. Used on the host for pixel-exact
+ * comparisons and draw-call measurements, and on target as an off-screen
+ * canvas that can be blitted with writeRect().
+ *
+ * Counters record what a hardware backend would have received.
+ */
+class GfxMemorySurface : public IGfxPanel {
+public:
+    GfxMemorySurface();
+    ~GfxMemorySurface();
+
+    // Allocate a w x h surface cleared to black
+    bool begin(uint16_t width, uint16_t height);
+    void end();
+    bool isValid() const { return pixels_ != nullptr; }
+
+    virtual uint16_t width() const override { return width_; }
+    virtual uint16_t height() const override { return height_; }
+
+    virtual void fillSpan(uint16_t x, uint16_t y, uint16_t w, uint16_t color) override;
+    virtual void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) override;
+    virtual void writeRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                           const uint16_t* pixels, size_t stride) override;
+
+    uint16_t getPixel(uint16_t x, uint16_t y) const;
+    const uint16_t* data() const { return pixels_; }
+    void clear(uint16_t color);
+
+    // Binary PPM (P6), RGB565 expanded to 8 bits per channel
+    bool writePPM(GfxWriteFn write, void* context) const;
+
+    // Panel calls received since the last resetCounters()
+    uint32_t spanCalls() const { return spanCalls_; }
+    uint32_t rectCalls() const { return rectCalls_; }
+    uint32_t writeCalls() const { return writeCalls_; }
+    uint32_t pixelsTouched() const { return pixelsTouched_; }
+    void resetCounters();
+
+private:
+    uint16_t* pixels_;
+    uint16_t width_;
+    uint16_t height_;
+
+    uint32_t spanCalls_;
+    uint32_t rectCalls_;
+    uint32_t writeCalls_;
+    uint32_t pixelsTouched_;
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_GFX_SURFACE_H
@@ -0,0 +1,80 @@
+#ifndef POCKETOS_GFX_TFT_PANEL_H
+#define POCKETOS_GFX_TFT_PANEL_H
+
+#include "gfx_panel.h"
+
+namespace PocketOS {
+
+/**
+ * TFT Panel Backend
+ *
+ * Adapts ILI9341Driver, ST7789Driver or ST7735Driver to IGfxPanel.
+ * Stacked spans with the same x, width and colour (rectangle edges, thick
+ * lines, vertical runs) are merged into one fillRect(), i.e. one window
+ * set plus one block fill. Pixel rectangles go to drawImage() as a single
+ * window. Both paths land in the framebuffer when the driver has one.
+ *
+ *   ILI9341Driver tft;
+ *   GfxTFTPanel<ILI9341Driver> panel(tft);
+ *   GfxRenderer gfx(panel);
+ */
+template <typename TDriver>
+class GfxTFTPanel : public IGfxPanel {
+public:
+    explicit GfxTFTPanel(TDriver& driver)
+        : driver_(driver), pending_(false), px_(0), py_(0), pw_(0), ph_(0), pcolor_(0) {}
+
+    virtual uint16_t width() const override { return driver_.width(); }
+    virtual uint16_t height() const override { return driver_.height(); }
+
+    virtual void fillSpan(uint16_t x, uint16_t y, uint16_t w, uint16_t color) override {
+        if (pending_ && x == px_ && w == pw_ && color == pcolor_ && y == py_ + ph_) {
+            ph_++;
+            return;
+        }
+        flushPending();
+        pending_ = true;
+        px_ = x;
+        py_ = y;
+        pw_ = w;
+        ph_ = 1;
+        pcolor_ = color;
+    }
+
+    virtual void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) override {
+        flushPending();
+        driver_.fillRect(x, y, w, h, color);
+    }
+
+    virtual void writeRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                           const uint16_t* pixels, size_t stride) override {
+        flushPending();
+        driver_.drawImage(x, y, w, h, pixels, (uint16_t)stride);
+    }
+
+    virtual void flush() override {
+        flushPending();
+    }
+
+private:
+    TDriver& driver_;
+
+    // Span run being merged
+    bool pending_;
+    uint16_t px_;
+    uint16_t py_;
+    uint16_t pw_;
+    uint16_t ph_;
+    uint16_t pcolor_;
+
+    void flushPending() {
+        if (pending_) {
+            driver_.fillRect(px_, py_, pw_, ph_, pcolor_);
+            pending_ = false;
+        }
+    }
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_GFX_TFT_PANEL_H
@@ -0,0 +1,381 @@
+#ifndef POCKETOS_I2C_DRIVER_ADAPTER_H
+#define POCKETOS_I2C_DRIVER_ADAPTER_H
+
+#include <Arduino.h>
+#include <string.h>
+#include "../core/device_registry.h"
+#include "../core/capability_schema.h"
+#include "../core/clock_discipline.h"
+#include "measurement.h"
+
+namespace PocketOS {
+
+/**
+ * I2C Driver Adapter
+ *
+ * Wraps a standalone I2C driver (init(uint8_t), getSchema(), deinit(), and
+ * optionally readData()/getParameter()/setParameter()) in the IDriver
+ * interface so it can be bound in DeviceRegistry.
+ *
+ * update() polls readData() every poll_ms milliseconds (0 = never).
+ * Drivers with startMeasurement()/collect() (measurement.h) are polled
+ * without blocking: the conversion is started at the poll time and
+ * collected by the first update() after its deadline.
+ *
+ * The last valid sample is kept so DeviceRegistry can read its fields as
+ * named signals (readSignal("temperature"), see POCKETOS_SIGNAL_FIELDS)
+ * and run the per-device signal filters on it.
+ *
+ * RTC drivers (readDateTime()/setDateTime()) are exposed as a Unix-seconds
+ * clock for SystemClock.
+ *
+ * With an interrupt line attached (param irq), an edge triggers the read
+ * instead of the poll_ms timer, which then only runs every
+ * ADAPTER_IRQ_FALLBACK_POLLS periods in case an edge was missed (e.g. a
+ * level already asserted at attach time). Drivers with setInterruptPin()
+ * (FIFO IMUs) are given the pin so they skip status reads while it is idle.
+ *
+ * Param sample_us is the micros() time the last valid sample was triggered:
+ * the ISR timestamp of its edge when interrupt driven, else the poll time.
+ */
+
+#define ADAPTER_IRQ_FALLBACK_POLLS 4
+
+namespace AdapterDetail {
+
+// Sample type: readData()'s result, or NoSample for drivers without one
+struct NoSample {
+    bool valid;
+    NoSample() : valid(false) {}
+};
+
+template <typename T> T& lvalue();
+
+template <typename T>
+auto sampleOf(T& driver, int) -> decltype(driver.readData());
+
+template <typename T>
+NoSample sampleOf(T&, long);
+
+// Drivers with readData(): poll, keep valid samples and report validity
+template <typename T, typename S>
+auto poll(T& driver, S& last, int) -> decltype(driver.readData().valid) {
+    auto data = driver.readData();
+    if (data.valid) {
+        last = data;
+    }
+    return data.valid;
+}
+
+// Drivers without readData() (expanders, RTCs, displays): nothing to poll
+template <typename T, typename S>
+bool poll(T&, S&, long) {
+    return true;
+}
+
+// Drivers with startMeasurement()/collect(): trigger only
+template <typename T>
+auto start(T& driver, uint32_t& readyAtMs, int) -> decltype(driver.collect().valid, bool()) {
+    readyAtMs = driver.startMeasurement();
+    return true;
+}
+
+template <typename T>
+bool start(T&, uint32_t&, long) {
+    return false;
+}
+
+template <typename T, typename S>
+auto collect(T& driver, S& last, int) -> decltype(driver.collect().valid) {
+    auto data = driver.collect();
+    if (data.valid) {
+        last = data;
+    }
+    return data.valid;
+}
+
+template <typename T, typename S>
+bool collect(T&, S&, long) {
+    return false;
+}
+
+template <typename T>
+auto getParameter(T& driver, const String& name, int) -> decltype(driver.getParameter(name)) {
+    return driver.getParameter(name);
+}
+
+template <typename T>
+String getParameter(T&, const String&, long) {
+    return "";
+}
+
+template <typename T>
+auto setParameter(T& driver, const String& name, const String& value, int)
+    -> decltype(driver.setParameter(name, value)) {
+    return driver.setParameter(name, value);
+}
+
+template <typename T>
+bool setParameter(T&, const String&, const String&, long) {
+    return false;
+}
+
+// RTC drivers (readDateTime()/setDateTime()): wall clock as Unix seconds
+template <typename T>
+auto readClock(T& driver, uint32_t& seconds, int) -> decltype(driver.readDateTime().valid, bool()) {
+    auto dt = driver.readDateTime();
+    if (!dt.valid) {
+        return false;
+    }
+    CivilTime t;
+    t.year = dt.year;
+    t.month = dt.month;
+    t.day = dt.day;
+    t.hour = dt.hour;
+    t.minute = dt.minute;
+    t.second = dt.second;
+    t.weekday = 0;
+    seconds = ClockDiscipline::civilToUnix(t);
+    return true;
+}
+
+template <typename T>
+bool readClock(T&, uint32_t&, long) {
+    return false;
+}
+
+template <typename T>
+auto writeClock(T& driver, uint32_t seconds, int) -> decltype(driver.setDateTime(driver.readDateTime())) {
+    CivilTime t;
+    ClockDiscipline::unixToCivil(seconds, t);
+    decltype(driver.readDateTime()) dt;
+    dt.year = t.year;
+    dt.month = t.month;
+    dt.day = t.day;
+    dt.hour = t.hour;
+    dt.minute = t.minute;
+    dt.second = t.second;
+    dt.dayOfWeek = (uint8_t)(dt.dayOfWeek + t.weekday);  // Default is the driver's Sunday
+    dt.valid = true;
+    return driver.setDateTime(dt);
+}
+
+template <typename T>
+bool writeClock(T&, uint32_t, long) {
+    return false;
+}
+
+template <typename T>
+auto enableSecondPulse(T& driver, int) -> decltype(driver.enableSecondPulse()) {
+    return driver.enableSecondPulse();
+}
+
+template <typename T>
+bool enableSecondPulse(T&, long) {
+    return false;
+}
+
+template <typename T>
+auto setInterruptPin(T& driver, int pin, int) -> decltype(driver.setInterruptPin((int8_t)pin)) {
+    driver.setInterruptPin((int8_t)pin);
+}
+
+template <typename T>
+void setInterruptPin(T&, int, long) {
+}
+
+// Numeric sample fields exposed as signals (arrays and non-numeric
+// fields are skipped by the cast)
+#define POCKETOS_SIGNAL_FIELDS(X) \
+    X(temperature) X(humidity) X(pressure) X(gas) \
+    X(co2) X(eco2) X(tvoc) X(voc_index) \
+    X(lux) X(ambient) X(proximity) X(ir) X(uv) X(uvIndex) X(colorTemp) \
+    X(distance_mm) X(angle) X(value) X(percentage) \
+    X(voltage) X(current) X(power) X(busVoltage) X(shuntVoltage) \
+    X(accel_x) X(accel_y) X(accel_z) X(gyro_x) X(gyro_y) X(gyro_z) \
+    X(mag_x) X(mag_y) X(mag_z) \
+    X(objectTemperature) X(heart_rate) X(spo2)
+
+#define POCKETOS_SIGNAL_EXTRACTOR(field) \
+    template <typename S> \
+    auto signal_##field(const S& s, float& out, int) -> decltype((float)s.field, bool()) { \
+        out = (float)s.field; \
+        return true; \
+    } \
+    template <typename S> \
+    bool signal_##field(const S&, float&, long) { \
+        return false; \
+    }
+
+POCKETOS_SIGNAL_FIELDS(POCKETOS_SIGNAL_EXTRACTOR)
+#undef POCKETOS_SIGNAL_EXTRACTOR
+
+// Field `name` of a sample ("temp" is accepted for temperature);
+// false if the sample type has no such field
+template <typename S>
+bool readSignal(const S& sample, const char* name, float& out) {
+    if (strcmp(name, "temp") == 0) {
+        name = "temperature";
+    }
+#define POCKETOS_SIGNAL_MATCH(field) \
+    if (strcmp(name, #field) == 0) { \
+        return signal_##field(sample, out, 0); \
+    }
+    POCKETOS_SIGNAL_FIELDS(POCKETOS_SIGNAL_MATCH)
+#undef POCKETOS_SIGNAL_MATCH
+    return false;
+}
+
+} // namespace AdapterDetail
+
+template <typename TDriver>
+class I2CDriverAdapter : public IDriver {
+public:
+    I2CDriverAdapter(uint8_t address, uint32_t pollMs)
+        : address(address), pollMs(pollMs), lastPollMs(0), readyAtMs(0), measuring(false),
+          readCount(0), readFailCount(0), sampleSeq(0), irqPin(-1), irqPending(false),
+          irqCount(0), irqEdgeUs(0), triggerUs(0), sampleUs(0) {}
+
+    virtual ~I2CDriverAdapter() {
+        driver.deinit();
+    }
+
+    virtual bool init() override {
+        measuring = false;
+        return driver.init(address);
+    }
+
+    virtual bool setParam(const String& name, const String& value) override {
+        if (name == "poll_ms") {
+            long ms = value.toInt();
+            if (ms < 0) {
+                return false;
+            }
+            pollMs = (uint32_t)ms;
+            return true;
+        }
+        return AdapterDetail::setParameter(driver, name, value, 0);
+    }
+
+    virtual String getParam(const String& name) override {
+        if (name == "poll_ms") {
+            return String(pollMs);
+        } else if (name == "read_count") {
+            return String(readCount);
+        } else if (name == "read_failures") {
+            return String(readFailCount);
+        } else if (name == "irq_count") {
+            return String(irqCount);
+        } else if (name == "sample_us") {
+            return String(sampleUs);
+        }
+        return AdapterDetail::getParameter(driver, name, 0);
+    }
+
+    virtual CapabilitySchema getSchema() override {
+        return driver.getSchema();
+    }
+
+    virtual void update() override {
+        if (measuring) {
+            if (measurementDue(readyAtMs)) {
+                measuring = false;
+                record(AdapterDetail::collect(driver, lastSample, 0));
+            }
+            return;
+        }
+
+        unsigned long now = millis();
+        triggerUs = (uint32_t)micros();
+        if (irqPin >= 0) {
+            bool fallback = pollMs != 0 && now - lastPollMs >= pollMs * ADAPTER_IRQ_FALLBACK_POLLS;
+            if (!irqPending && !fallback) {
+                return;
+            }
+            if (irqPending) {
+                triggerUs = irqEdgeUs;
+            }
+            irqPending = false;
+        } else if (pollMs == 0 || now - lastPollMs < pollMs) {
+            return;
+        }
+        lastPollMs = now;
+
+        if (AdapterDetail::start(driver, readyAtMs, 0)) {
+            measuring = readyAtMs != MEASUREMENT_NOT_STARTED;
+            return;
+        }
+        record(AdapterDetail::poll(driver, lastSample, 0));
+    }
+
+    virtual uint32_t sampleSequence() const override {
+        return sampleSeq;
+    }
+
+    virtual bool readSignal(const char* name, float& value) override {
+        return AdapterDetail::readSignal(lastSample, name, value);
+    }
+
+    virtual bool readClock(uint32_t& unixSeconds) override {
+        return AdapterDetail::readClock(driver, unixSeconds, 0);
+    }
+
+    virtual bool writeClock(uint32_t unixSeconds) override {
+        return AdapterDetail::writeClock(driver, unixSeconds, 0);
+    }
+
+    virtual bool enableSecondPulse() override {
+        return AdapterDetail::enableSecondPulse(driver, 0);
+    }
+
+    virtual void setInterruptPin(int pin) override {
+        irqPin = pin;
+        irqPending = pin >= 0;   // Read once: the line may already be asserted
+        irqEdgeUs = (uint32_t)micros();
+        AdapterDetail::setInterruptPin(driver, pin, 0);
+    }
+
+    virtual void onInterrupt(uint32_t timestampUs) override {
+        irqPending = true;
+        irqCount++;
+        irqEdgeUs = timestampUs;
+    }
+
+    TDriver& getDriver() { return driver; }
+
+private:
+    typedef decltype(AdapterDetail::sampleOf(AdapterDetail::lvalue<TDriver>(), 0)) Sample;
+
+    TDriver driver;
+    uint8_t address;
+    uint32_t pollMs;
+    unsigned long lastPollMs;
+    uint32_t readyAtMs;
+    bool measuring;
+    uint32_t readCount;
+    uint32_t readFailCount;
+    uint32_t sampleSeq;
+    int irqPin;
+    bool irqPending;
+    uint32_t irqCount;
+    uint32_t irqEdgeUs;      // ISR timestamp of the latest edge
+    uint32_t triggerUs;      // Edge or poll time of the read in progress
+    uint32_t sampleUs;       // Trigger time of lastSample
+    Sample lastSample;
+
+    void record(bool ok) {
+        if (ok) {
+            readCount++;
+            if (lastSample.valid) {
+                sampleSeq++;
+                sampleUs = triggerUs;
+            }
+        } else {
+            readFailCount++;
+        }
+    }
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_I2C_DRIVER_ADAPTER_H
@@ -11,25 +11,48 @@ namespace PocketOS {
 
 // ICM20948 Register addresses (Bank 0)
 #define ICM20948_REG_WHO_AM_I       0x00
+#define ICM20948_REG_USER_CTRL      0x03
 #define ICM20948_REG_PWR_MGMT_1     0x06
 #define ICM20948_REG_PWR_MGMT_2     0x07
+#define ICM20948_REG_INT_STATUS_2   0x1B
 #define ICM20948_REG_ACCEL_XOUT_H   0x2D
 #define ICM20948_REG_GYRO_XOUT_H    0x33
 #define ICM20948_REG_TEMP_OUT_H     0x39
+#define ICM20948_REG_FIFO_EN_2      0x67
+#define ICM20948_REG_FIFO_RST       0x68
+#define ICM20948_REG_FIFO_MODE      0x69
+#define ICM20948_REG_FIFO_COUNTH    0x70
+#define ICM20948_REG_FIFO_R_W       0x72
 #define ICM20948_REG_REG_BANK_SEL   0x7F
 
 // Bank 2
-#define ICM20948_REG_GYRO_CONFIG_1  0x01
-#define ICM20948_REG_ACCEL_CONFIG   0x14
+#define ICM20948_REG_GYRO_SMPLRT_DIV    0x00
+#define ICM20948_REG_GYRO_CONFIG_1      0x01
+#define ICM20948_REG_ACCEL_SMPLRT_DIV_1 0x10
+#define ICM20948_REG_ACCEL_SMPLRT_DIV_2 0x11
+#define ICM20948_REG_ACCEL_CONFIG       0x14
 
 // WHO_AM_I value
 #define ICM20948_WHO_AM_I_VALUE     0xEA
 
+// USER_CTRL / FIFO_EN_2 bits
+#define ICM20948_FIFO_EN            0x40
+#define ICM20948_ACCEL_FIFO_EN      0x10
+#define ICM20948_GYRO_FIFO_EN       0x0E
+
+// Internal sample rate with the DLPF enabled (FCHOICE = 1)
+#define ICM20948_BASE_RATE_HZ       1125
+
+// Temperature refresh while batching (not in the FIFO)
+#define ICM20948_TEMP_INTERVAL_MS   1000
+
 #if POCKETOS_ICM20948_ENABLE_REGISTER_ACCESS
 static const RegisterDesc ICM20948_REGISTERS[] = {
     RegisterDesc(0x00, "WHO_AM_I", 1, RegisterAccess::RO, 0xEA),
+    RegisterDesc(0x03, "USER_CTRL", 1, RegisterAccess::RW, 0x00),
     RegisterDesc(0x06, "PWR_MGMT_1", 1, RegisterAccess::RW, 0x41),
     RegisterDesc(0x07, "PWR_MGMT_2", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x1B, "INT_STATUS_2", 1, RegisterAccess::RO, 0x00),
     RegisterDesc(0x2D, "ACCEL_XOUT_H", 1, RegisterAccess::RO, 0x00),
     RegisterDesc(0x2E, "ACCEL_XOUT_L", 1, RegisterAccess::RO, 0x00),
     RegisterDesc(0x2F, "ACCEL_YOUT_H", 1, RegisterAccess::RO, 0x00),
@@ -44,24 +67,31 @@ static const RegisterDesc ICM20948_REGISTERS[] = {
     RegisterDesc(0x38, "GYRO_ZOUT_L", 1, RegisterAccess::RO, 0x00),
     RegisterDesc(0x39, "TEMP_OUT_H", 1, RegisterAccess::RO, 0x00),
     RegisterDesc(0x3A, "TEMP_OUT_L", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x67, "FIFO_EN_2", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x68, "FIFO_RST", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x69, "FIFO_MODE", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x70, "FIFO_COUNTH", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x71, "FIFO_COUNTL", 1, RegisterAccess::RO, 0x00),
     RegisterDesc(0x7F, "REG_BANK_SEL", 1, RegisterAccess::RW, 0x00),
 };
 #define ICM20948_REGISTER_COUNT (sizeof(ICM20948_REGISTERS) / sizeof(RegisterDesc))
 #endif
 
-ICM20948Driver::ICM20948Driver() : address(0), initialized(false), 
-                                    accelScale(1.0f), gyroScale(1.0f) {}
+ICM20948Driver::ICM20948Driver() : address(0), initialized(false),
+                                    accelUnit(1.0f), gyroUnit(1.0f),
+                                    sampleDiv(0), batchAccel(true), batchGyro(true), watermark(0),
+                                    temperatureRaw(0), lastTempMs(0), fifoOverruns(0), busBytes(0) {}
 
 bool ICM20948Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
-    
+
 #if POCKETOS_ICM20948_ENABLE_LOGGING
-    Logger::info("ICM20948: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("ICM20948: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
-    
+
     // Select bank 0
     selectBank(0);
-    
+
     // Check WHO_AM_I
     uint8_t whoAmI = 0;
     if (!readRegister(ICM20948_REG_WHO_AM_I, &whoAmI)) {
@@ -70,97 +100,200 @@ bool ICM20948Driver::init(uint8_t i2cAddress) {
 #endif
         return false;
     }
-    
+
     if (whoAmI != ICM20948_WHO_AM_I_VALUE) {
 #if POCKETOS_ICM20948_ENABLE_LOGGING
-        Logger::error("ICM20948: Invalid WHO_AM_I: 0x" + String(whoAmI, HEX));
+        Logger::error(("ICM20948: Invalid WHO_AM_I: 0x" + String(whoAmI, HEX)).c_str());
 #endif
         return false;
     }
-    
-#if POCKETOS_ICM20948_ENABLE_CONFIGURATION
+
     // Reset device
     writeRegister(ICM20948_REG_PWR_MGMT_1, 0x80);
     delay(100);
-    
+
     // Wake up and use best available clock
     writeRegister(ICM20948_REG_PWR_MGMT_1, 0x01);
     delay(10);
-    
+
     // Enable accel and gyro
     writeRegister(ICM20948_REG_PWR_MGMT_2, 0x00);
     delay(10);
-    
-    // Configure accel and gyro (Bank 2)
+
+    // ±4g, ±500 dps, DLPF on (FCHOICE) so the sample rate dividers apply (Bank 2)
     selectBank(2);
-    writeRegister(ICM20948_REG_ACCEL_CONFIG, 0x01);  // ±4g
-    writeRegister(ICM20948_REG_GYRO_CONFIG_1, 0x01);  // ±500 dps
+    writeRegister(ICM20948_REG_ACCEL_CONFIG, (1 << 1) | 0x01);
+    writeRegister(ICM20948_REG_GYRO_CONFIG_1, (1 << 1) | 0x01);
     selectBank(0);
-    
-    accelScale = 4.0f / 32768.0f * 9.81f;  // ±4g to m/s²
-    gyroScale = 500.0f / 32768.0f * 0.017453293f;  // ±500dps to rad/s
-#else
-    // Minimal: wake up
-    writeRegister(ICM20948_REG_PWR_MGMT_1, 0x01);
-    writeRegister(ICM20948_REG_PWR_MGMT_2, 0x00);
-    delay(10);
-    
-    accelScale = 2.0f / 32768.0f * 9.81f;  // Default ±2g to m/s²
-    gyroScale = 250.0f / 32768.0f * 0.017453293f;  // Default ±250dps to rad/s
+
+    accelUnit = 4.0f / 32768.0f * 9.81f;  // ±4g to m/s²
+    gyroUnit = 500.0f / 32768.0f * 0.017453293f;  // ±500dps to rad/s
+
+    uint32_t div = (ICM20948_BASE_RATE_HZ + POCKETOS_IMU_DEFAULT_ODR_HZ / 2) / POCKETOS_IMU_DEFAULT_ODR_HZ;
+    sampleDiv = (uint8_t)(div > 256 ? 255 : (div ? div - 1 : 0));
+
+    if (!ring.begin()) {
+#if POCKETOS_ICM20948_ENABLE_LOGGING
+        Logger::error("ICM20948: Out of memory for sample ring");
 #endif
-    
+        return false;
+    }
+
+    if (!configureFifo()) {
+#if POCKETOS_ICM20948_ENABLE_LOGGING
+        Logger::error("ICM20948: Failed to configure FIFO");
+#endif
+        ring.end();
+        return false;
+    }
+
     initialized = true;
 #if POCKETOS_ICM20948_ENABLE_LOGGING
-    Logger::info("ICM20948: Initialized successfully");
+    Logger::info(("ICM20948: Initialized successfully (FIFO " +
+                  String(ICM20948_BASE_RATE_HZ / (1.0f + sampleDiv), 1) + " Hz)").c_str());
 #endif
     return true;
 }
 
 void ICM20948Driver::deinit() {
     if (initialized) {
+        writeRegister(ICM20948_REG_FIFO_EN_2, 0x00);
         writeRegister(ICM20948_REG_PWR_MGMT_1, 0x40);  // Sleep
     }
+    ring.end();
     initialized = false;
 }
 
+bool ICM20948Driver::configureFifo() {
+    // Same divider for both sensors so every FIFO frame holds one of each
+    bool ok = selectBank(2);
+    ok &= writeRegister(ICM20948_REG_GYRO_SMPLRT_DIV, sampleDiv);
+    ok &= writeRegister(ICM20948_REG_ACCEL_SMPLRT_DIV_1, 0x00);
+    ok &= writeRegister(ICM20948_REG_ACCEL_SMPLRT_DIV_2, sampleDiv);
+    ok &= selectBank(0);
+
+    uint8_t userCtrl = 0;
+    ok &= readRegister(ICM20948_REG_USER_CTRL, &userCtrl);
+    ok &= writeRegister(ICM20948_REG_FIFO_EN_2, 0x00);
+    ok &= writeRegister(ICM20948_REG_FIFO_MODE, 0x00);      // Stream
+    ok &= writeRegister(ICM20948_REG_FIFO_RST, 0x1F);
+    ok &= writeRegister(ICM20948_REG_FIFO_RST, 0x00);
+    ok &= writeRegister(ICM20948_REG_USER_CTRL, (uint8_t)(userCtrl | ICM20948_FIFO_EN));
+    ok &= writeRegister(ICM20948_REG_FIFO_EN_2, (uint8_t)((batchAccel ? ICM20948_ACCEL_FIFO_EN : 0) |
+                                                          (batchGyro ? ICM20948_GYRO_FIFO_EN : 0)));
+    if (!ok) {
+        return false;
+    }
+
+    time.reset((uint32_t)((1000000UL * (1 + sampleDiv)) / ICM20948_BASE_RATE_HZ));
+    return true;
+}
+
+uint16_t ICM20948Driver::pollFifo() {
+    if (!initialized) {
+        return 0;
+    }
+
+    // Stream mode overwrites the oldest bytes when full, which breaks the
+    // frame alignment: start over after an overflow
+    uint8_t overflow = 0;
+    if (!readRegister(ICM20948_REG_INT_STATUS_2, &overflow)) {
+        return 0;
+    }
+    if (overflow & 0x1F) {
+        fifoOverruns++;
+        writeRegister(ICM20948_REG_FIFO_RST, 0x1F);
+        writeRegister(ICM20948_REG_FIFO_RST, 0x00);
+        time.resync();
+        return 0;
+    }
+
+    uint8_t countBuf[2];
+    if (!readRegisters(ICM20948_REG_FIFO_COUNTH, countBuf, 2)) {
+        return 0;
+    }
+    uint32_t now = micros();
+    busBytes += 3;
+
+    const uint8_t frame = frameBytes();
+    uint16_t count = (uint16_t)(((countBuf[0] & 0x1F) << 8) | countBuf[1]) / frame;
+    if (count == 0 || (watermark > 0 && count < watermark)) {
+        return 0;
+    }
+    time.anchorBurst(now, count);
+
+    // FIFO_R_W does not auto-increment: a burst returns consecutive FIFO bytes
+    ImuRawSample held;
+    if (!ring.latest(held)) {
+        memset(&held, 0, sizeof(held));
+    }
+    uint8_t burst[POCKETOS_IMU_FIFO_I2C_BUFFER];
+    const uint16_t perBurst = (uint16_t)(sizeof(burst) / frame);
+    uint16_t added = 0;
+    while (added < count) {
+        uint16_t n = (uint16_t)(count - added) > perBurst ? perBurst : (uint16_t)(count - added);
+        if (!readRegisters(ICM20948_REG_FIFO_R_W, burst, (size_t)n * frame)) {
+            break;
+        }
+        busBytes += (uint32_t)n * frame;
+
+        const uint8_t* p = burst;
+        for (uint16_t i = 0; i < n; i++) {
+            if (batchAccel) {
+                for (uint8_t k = 0; k < 3; k++, p += 2) {
+                    held.accel[k] = (int16_t)((p[0] << 8) | p[1]);
+                }
+            }
+            if (batchGyro) {
+                for (uint8_t k = 0; k < 3; k++, p += 2) {
+                    held.gyro[k] = (int16_t)((p[0] << 8) | p[1]);
+                }
+            }
+            ring.push(held.accel, held.gyro, time.next());
+        }
+        added += n;
+    }
+    return added;
+}
+
 ICM20948Data ICM20948Driver::readData() {
     ICM20948Data data;
-    
+
     if (!initialized) {
         return data;
     }
-    
-    selectBank(0);
-    
-    uint8_t buffer[14];
-    
-    // Read accel (6 bytes) + temp (2 bytes) + gyro (6 bytes)
-    if (readRegisters(ICM20948_REG_ACCEL_XOUT_H, buffer, 14)) {
-        int16_t ax = (int16_t)((buffer[0] << 8) | buffer[1]);
-        int16_t ay = (int16_t)((buffer[2] << 8) | buffer[3]);
-        int16_t az = (int16_t)((buffer[4] << 8) | buffer[5]);
-        
-        data.accel_x = ax * accelScale;
-        data.accel_y = ay * accelScale;
-        data.accel_z = az * accelScale;
-        
-        int16_t temp = (int16_t)((buffer[6] << 8) | buffer[7]);
-        data.temperature = (temp / 333.87f) + 21.0f;
-        
-        int16_t gx = (int16_t)((buffer[8] << 8) | buffer[9]);
-        int16_t gy = (int16_t)((buffer[10] << 8) | buffer[11]);
-        int16_t gz = (int16_t)((buffer[12] << 8) | buffer[13]);
-        
-        data.gyro_x = gx * gyroScale;
-        data.gyro_y = gy * gyroScale;
-        data.gyro_z = gz * gyroScale;
-        
-        data.valid = true;
+
+    data.batch = pollFifo();
+
+    ImuRawSample sample;
+    if (!ring.latest(sample)) {
+        return data;
     }
-    
+
+    data.accel_x = sample.accel[0] * accelUnit;
+    data.accel_y = sample.accel[1] * accelUnit;
+    data.accel_z = sample.accel[2] * accelUnit;
+    data.gyro_x = sample.gyro[0] * gyroUnit;
+    data.gyro_y = sample.gyro[1] * gyroUnit;
+    data.gyro_z = sample.gyro[2] * gyroUnit;
+
+    // Temperature is not batched: refresh it once a second
+    unsigned long nowMs = millis();
+    if (lastTempMs == 0 || nowMs - lastTempMs >= ICM20948_TEMP_INTERVAL_MS) {
+        uint8_t tempBuf[2];
+        if (readRegisters(ICM20948_REG_TEMP_OUT_H, tempBuf, 2)) {
+            temperatureRaw = (int16_t)((tempBuf[0] << 8) | tempBuf[1]);
+            lastTempMs = nowMs ? nowMs : 1;
+        }
+    }
+    data.temperature = (temperatureRaw / 333.87f) + 21.0f;
+
+    data.timestamp_us = sample.timestampUs;
+    data.valid = true;
+
     // Read magnetometer
     readMagnetometer(data.mag_x, data.mag_y, data.mag_z);
-    
+
     return data;
 }
 
@@ -173,27 +306,53 @@ bool ICM20948Driver::readMagnetometer(float& x, float& y, float& z) {
 
 CapabilitySchema ICM20948Driver::getSchema() const {
     CapabilitySchema schema;
-    
-    // Basic settings
-    schema.addSetting("driver", ParamType::STRING, true, "icm20948", "", "", "");
-    schema.addSetting("tier", ParamType::STRING, true, POCKETOS_ICM20948_TIER_NAME, "", "", "");
-    
+
     // Output signals
-    schema.addSignal("accel_x", ParamType::FLOAT, true, "m/s²");
-    schema.addSignal("accel_y", ParamType::FLOAT, true, "m/s²");
-    schema.addSignal("accel_z", ParamType::FLOAT, true, "m/s²");
-    schema.addSignal("gyro_x", ParamType::FLOAT, true, "rad/s");
-    schema.addSignal("gyro_y", ParamType::FLOAT, true, "rad/s");
-    schema.addSignal("gyro_z", ParamType::FLOAT, true, "rad/s");
-    schema.addSignal("mag_x", ParamType::FLOAT, true, "µT");
-    schema.addSignal("mag_y", ParamType::FLOAT, true, "µT");
-    schema.addSignal("mag_z", ParamType::FLOAT, true, "µT");
-    schema.addSignal("temperature", ParamType::FLOAT, true, "°C");
-    
+    schema.addSignal("accel_x", ParamType::FLOAT, false, "m/s²");
+    schema.addSignal("accel_y", ParamType::FLOAT, false, "m/s²");
+    schema.addSignal("accel_z", ParamType::FLOAT, false, "m/s²");
+    schema.addSignal("gyro_x", ParamType::FLOAT, false, "rad/s");
+    schema.addSignal("gyro_y", ParamType::FLOAT, false, "rad/s");
+    schema.addSignal("gyro_z", ParamType::FLOAT, false, "rad/s");
+    schema.addSignal("mag_x", ParamType::FLOAT, false, "µT");
+    schema.addSignal("mag_y", ParamType::FLOAT, false, "µT");
+    schema.addSignal("mag_z", ParamType::FLOAT, false, "µT");
+    schema.addSignal("temperature", ParamType::FLOAT, false, "°C");
+    schema.addSignal("samples", ParamType::COUNTER, false, "");
+    schema.addSignal("fifo_overruns", ParamType::COUNTER, false, "");
+
+#if POCKETOS_ICM20948_ENABLE_CONFIGURATION
+    schema.addSetting("odr_hz", ParamType::INT, true, 5, 1125, 0, "Hz");
+    schema.addSetting("watermark", ParamType::INT, true, 0, 255, 1, "samples");
+    schema.addSetting("batch", ParamType::ENUM, true, 0, 0, 0, "both,accel,gyro");
+    schema.addSetting("accel_range", ParamType::INT, true, 0, 3, 1, "");
+    schema.addSetting("gyro_range", ParamType::INT, true, 0, 3, 1, "");
+#endif
+
     return schema;
 }
 
 String ICM20948Driver::getParameter(const String& name) {
+    if (name == "samples") {
+        return String(ring.pushed());
+    } else if (name == "ring_dropped") {
+        return String(ring.dropped());
+    } else if (name == "fifo_overruns") {
+        return String(fifoOverruns);
+    } else if (name == "bus_bytes") {
+        return String(busBytes);
+    } else if (name == "rate_hz") {
+        return String(time.rateHz(), 1);
+    }
+#if POCKETOS_ICM20948_ENABLE_CONFIGURATION
+    if (name == "odr_hz") {
+        return String(ICM20948_BASE_RATE_HZ / (1.0f + sampleDiv), 1);
+    } else if (name == "watermark") {
+        return String(watermark);
+    } else if (name == "batch") {
+        return batchAccel && batchGyro ? "both" : (batchAccel ? "accel" : "gyro");
+    }
+#endif
     return "";
 }
 
@@ -203,6 +362,17 @@ bool ICM20948Driver::setParameter(const String& name, const String& value) {
         return setAccelRange(value.toInt());
     } else if (name == "gyro_range") {
         return setGyroRange(value.toInt());
+    } else if (name == "odr_hz") {
+        long hz = value.toInt();
+        return hz > 0 && hz <= ICM20948_BASE_RATE_HZ && setOdr((uint16_t)hz);
+    } else if (name == "watermark") {
+        long samples = value.toInt();
+        return samples >= 0 && samples <= 255 && setWatermark((uint16_t)samples);
+    } else if (name == "batch") {
+        if (value == "both") return setBatching(true, true);
+        if (value == "accel") return setBatching(true, false);
+        if (value == "gyro") return setBatching(false, true);
+        return false;
     }
 #endif
     return false;
@@ -210,34 +380,55 @@ bool ICM20948Driver::setParameter(const String& name, const String& value) {
 
 #if POCKETOS_ICM20948_ENABLE_CONFIGURATION
 bool ICM20948Driver::setAccelRange(uint8_t range) {
-    if (!initialized) return false;
+    if (!initialized || range > 3) return false;
     selectBank(2);
-    bool result = writeRegister(ICM20948_REG_ACCEL_CONFIG, range);
+    // ACCEL_FS_SEL[1:0] in bits 2:1, keep the DLPF on
+    bool result = writeRegister(ICM20948_REG_ACCEL_CONFIG, (uint8_t)((range << 1) | 0x01));
     selectBank(0);
-    
+
     // Update scale factor
     float ranges[] = {2.0f, 4.0f, 8.0f, 16.0f};
-    if (range < 4) {
-        accelScale = ranges[range] / 32768.0f * 9.81f;
-    }
-    
+    accelUnit = ranges[range] / 32768.0f * 9.81f;
+
     return result;
 }
 
 bool ICM20948Driver::setGyroRange(uint8_t range) {
-    if (!initialized) return false;
+    if (!initialized || range > 3) return false;
     selectBank(2);
-    bool result = writeRegister(ICM20948_REG_GYRO_CONFIG_1, range);
+    // GYRO_FS_SEL[1:0] in bits 2:1, keep the DLPF on
+    bool result = writeRegister(ICM20948_REG_GYRO_CONFIG_1, (uint8_t)((range << 1) | 0x01));
     selectBank(0);
-    
+
     // Update scale factor
     float ranges[] = {250.0f, 500.0f, 1000.0f, 2000.0f};
-    if (range < 4) {
-        gyroScale = ranges[range] / 32768.0f * 0.017453293f;
-    }
-    
+    gyroUnit = ranges[range] / 32768.0f * 0.017453293f;
+
     return result;
 }
+
+bool ICM20948Driver::setOdr(uint16_t hz) {
+    if (!initialized || hz == 0 || hz > ICM20948_BASE_RATE_HZ) return false;
+
+    uint32_t div = (ICM20948_BASE_RATE_HZ + hz / 2) / hz;
+    sampleDiv = (uint8_t)(div > 256 ? 255 : div - 1);
+    return configureFifo();
+}
+
+bool ICM20948Driver::setBatching(bool accel, bool gyro) {
+    if (!initialized || (!accel && !gyro)) return false;
+
+    batchAccel = accel;
+    batchGyro = gyro;
+    return configureFifo();
+}
+
+bool ICM20948Driver::setWatermark(uint16_t samples) {
+    if (!initialized) return false;
+
+    watermark = samples;
+    return true;
+}
 #endif
 
 #if POCKETOS_ICM20948_ENABLE_REGISTER_ACCESS
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "imu_fifo.h"
 
 #if POCKETOS_ICM20948_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
@@ -15,21 +16,35 @@ namespace PocketOS {
 #define ICM20948_ADDR_COUNT 2
 const uint8_t ICM20948_VALID_ADDRESSES[ICM20948_ADDR_COUNT] = { 0x68, 0x69 };
 
-// ICM20948 measurement data
+// ICM20948 measurement data (newest FIFO sample)
 struct ICM20948Data {
     float accel_x, accel_y, accel_z;   // m/s²
     float gyro_x, gyro_y, gyro_z;       // rad/s
     float mag_x, mag_y, mag_z;          // µT
     float temperature;                   // °C
+    uint32_t timestamp_us;               // Host time of the sample
+    uint16_t batch;                      // Samples drained by this read
     bool valid;
     
     ICM20948Data() : accel_x(0), accel_y(0), accel_z(0),
                      gyro_x(0), gyro_y(0), gyro_z(0),
                      mag_x(0), mag_y(0), mag_z(0),
-                     temperature(0), valid(false) {}
+                     temperature(0), timestamp_us(0), batch(0), valid(false) {}
 };
 
-// ICM20948 9-DoF IMU
+/**
+ * ICM20948 9-DoF IMU
+ *
+ * Accel and gyro are batched in the FIFO (stream mode, 12 bytes per
+ * sample, big-endian accel XYZ then gyro XYZ) at 1125/(1+div) Hz, up to
+ * 1.125 kHz. pollFifo() reads the overflow flag and FIFO count, then
+ * drains whole samples in Wire-buffer-sized bursts of FIFO_R_W into the
+ * ImuSampleRing. The sensor has no timestamp counter outside the DMP:
+ * sample times count back from micros() at the count read, with the
+ * period tracked across bursts. The watermark is applied to the count
+ * (no programmable FIFO threshold interrupt); an overflow resets the
+ * FIFO.
+ */
 class ICM20948Driver {
 public:
     ICM20948Driver();
@@ -41,6 +56,15 @@ public:
     
     // Read measurements
     ICM20948Data readData();
+
+    // FIFO batching: samples added to the ring by this call
+    uint16_t pollFifo();
+    ImuSampleRing& samples() { return ring; }
+    const ImuTimebase& timebase() const { return time; }
+
+    // Raw ring counts to m/s² and rad/s
+    float accelScale() const { return accelUnit; }
+    float gyroScale() const { return gyroUnit; }
     
     // Get capability schema
     CapabilitySchema getSchema() const;
@@ -81,13 +105,31 @@ public:
     // Tier 1: Configuration
     bool setAccelRange(uint8_t range);
     bool setGyroRange(uint8_t range);
+    bool setOdr(uint16_t hz);               // 4.4 Hz - 1125 Hz
+    bool setBatching(bool accel, bool gyro);
+    bool setWatermark(uint16_t samples);
 #endif
     
 private:
     uint8_t address;
     bool initialized;
-    float accelScale;
-    float gyroScale;
+    float accelUnit;        // m/s² per LSB
+    float gyroUnit;         // rad/s per LSB
+
+    uint8_t sampleDiv;      // Rate = 1125 / (1 + sampleDiv) Hz
+    bool batchAccel;
+    bool batchGyro;
+    uint16_t watermark;     // Samples
+
+    ImuSampleRing ring;
+    ImuTimebase time;
+    int16_t temperatureRaw;
+    unsigned long lastTempMs;
+    uint32_t fifoOverruns;
+    uint32_t busBytes;
+
+    bool configureFifo();
+    uint8_t frameBytes() const { return (uint8_t)((batchAccel ? 6 : 0) + (batchGyro ? 6 : 0)); }
     
     // I2C communication
     bool writeRegister(uint8_t reg, uint8_t value);
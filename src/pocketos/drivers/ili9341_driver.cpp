@@ -1,4 +1,5 @@
 #include "ili9341_driver.h"
+#include "gfx_image.h"
 #include "../core/logger.h"
 #include "../core/resource_manager.h"
 #include <SPI.h>
@@ -362,22 +363,31 @@ bool ILI9341Driver::begin() {
 bool ILI9341Driver::setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
     if (!initialized_) return false;
     
-    sendCommand(ILI9341_CASET);
-    sendData16(x0);
-    sendData16(x1);
-    
-    sendCommand(ILI9341_PASET);
-    sendData16(y0);
-    sendData16(y1);
-    
-    sendCommand(ILI9341_RAMWR);
-    return true;
+    // CASET, PASET and RAMWR under one CS assertion
+    static const uint8_t cmds[3] = { ILI9341_CASET, ILI9341_PASET, ILI9341_RAMWR };
+    uint8_t cols[4] = { (uint8_t)(x0 >> 8), (uint8_t)(x0 & 0xFF), (uint8_t)(x1 >> 8), (uint8_t)(x1 & 0xFF) };
+    uint8_t rows[4] = { (uint8_t)(y0 >> 8), (uint8_t)(y0 & 0xFF), (uint8_t)(y1 >> 8), (uint8_t)(y1 & 0xFF) };
+    SPITransferDesc chain[5] = {
+        SPITransferDesc::command(&cmds[0], 1),
+        SPITransferDesc::data(cols, 4),
+        SPITransferDesc::command(&cmds[1], 1),
+        SPITransferDesc::data(rows, 4),
+        SPITransferDesc::command(&cmds[2], 1)
+    };
+    return spiTransaction(chain, 5);
 }
 
 bool ILI9341Driver::setPixel(uint16_t x, uint16_t y, uint16_t color) {
     if (!initialized_) return false;
     if (x >= _width || y >= _height) return false;
     
+#if POCKETOS_ILI9341_ENABLE_CONFIGURATION
+    if (framebuffer_.isEnabled()) {
+        framebuffer_.setPixel(x, y, color);
+        return true;
+    }
+#endif
+    
     setWindow(x, y, x, y);
     sendData16(color);
     return true;
@@ -388,16 +398,22 @@ bool ILI9341Driver::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uin
     if (x >= _width || y >= _height) return false;
     if (x + w > _width) w = _width - x;
     if (y + h > _height) h = _height - y;
+    if (w == 0 || h == 0) return true;
+    
+#if POCKETOS_ILI9341_ENABLE_CONFIGURATION
+    if (framebuffer_.isEnabled()) {
+        framebuffer_.fillRect(x, y, w, h, color);
+        return true;
+    }
+#endif
     
     setWindow(x, y, x + w - 1, y + h - 1);
     
-    uint32_t pixels = (uint32_t)w * h;
+    // Block fill: one pattern write for the whole window
+    beginTransaction();
     setDCData();
-    setCS(true);
-    for (uint32_t i = 0; i < pixels; i++) {
-        SPI.write16(color);
-    }
-    setCS(false);
+    writePattern16(color, (uint32_t)w * h);
+    endTransaction();
     
     return true;
 }
@@ -406,6 +422,72 @@ bool ILI9341Driver::fillScreen(uint16_t color) {
     return fillRect(0, 0, _width, _height, color);
 }
 
+bool ILI9341Driver::drawHLine(uint16_t x, uint16_t y, uint16_t w, uint16_t color) {
+    return fillRect(x, y, w, 1, color);
+}
+
+bool ILI9341Driver::drawVLine(uint16_t x, uint16_t y, uint16_t h, uint16_t color) {
+    return fillRect(x, y, 1, h, color);
+}
+
+bool ILI9341Driver::drawImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* pixels, uint16_t stride) {
+    if (!initialized_ || !pixels) return false;
+    if (x >= _width || y >= _height) return false;
+    if (stride == 0) stride = w;
+    if (x + w > _width) w = _width - x;
+    if (y + h > _height) h = _height - y;
+    if (w == 0 || h == 0) return true;
+    
+#if POCKETOS_ILI9341_ENABLE_CONFIGURATION
+    if (framebuffer_.isEnabled()) {
+        framebuffer_.writeRect(x, y, w, h, pixels, stride);
+        return true;
+    }
+#endif
+    
+    // One window; rows stream back to back
+    setWindow(x, y, x + w - 1, y + h - 1);
+    beginTransaction();
+    setDCData();
+    for (uint16_t r = 0; r < h; r++) {
+        writeWords(pixels + (size_t)r * stride, w);
+    }
+    endTransaction();
+    
+    return true;
+}
+
+bool ILI9341Driver::drawCompressedImage(uint16_t x, uint16_t y, const uint8_t* data, size_t len) {
+    if (!initialized_) return false;
+    if (x >= _width || y >= _height) return false;
+    
+    GfxImageDecoder image;
+    if (!image.begin(data, len)) {
+        Logger::error("ILI9341: Invalid image data");
+        return false;
+    }
+    
+    GfxImageSink sink = imageSink(&ILI9341Driver::imageWindow);
+#if POCKETOS_ILI9341_ENABLE_CONFIGURATION
+    if (framebuffer_.isEnabled()) {
+        sink = framebuffer_.imageSink();
+    }
+#endif
+    
+    bool ok = gfxStreamImage(image, x, y, _width, _height, sink);
+    if (image.error()) {
+        Logger::error("ILI9341: Corrupt image data");
+    }
+    return ok;
+}
+
+void ILI9341Driver::imageWindow(void* context, int32_t x, int32_t y, uint16_t w, uint16_t h) {
+    ILI9341Driver* self = static_cast<ILI9341Driver*>(static_cast<SPIDriverBase*>(context));
+    self->setWindow(x, y, x + w - 1, y + h - 1);
+    self->beginTransaction();
+    self->setDCData();
+}
+
 bool ILI9341Driver::pushColor(uint16_t color) {
     if (!initialized_) return false;
     sendData16(color);
@@ -415,12 +497,10 @@ bool ILI9341Driver::pushColor(uint16_t color) {
 bool ILI9341Driver::pushColors(const uint16_t* colors, uint16_t len) {
     if (!initialized_) return false;
     
+    beginTransaction();
     setDCData();
-    setCS(true);
-    for (uint16_t i = 0; i < len; i++) {
-        SPI.write16(colors[i]);
-    }
-    setCS(false);
+    writeWords(colors, len);
+    endTransaction();
     
     return true;
 }
@@ -458,6 +538,13 @@ bool ILI9341Driver::setRotation(uint8_t rotation) {
     
     sendCommand(ILI9341_MADCTL);
     sendData(madctl);
+    
+#if POCKETOS_ILI9341_ENABLE_CONFIGURATION
+    // Framebuffer geometry follows the rotation (contents are cleared)
+    if (framebuffer_.isEnabled()) {
+        beginFramebuffer(framebuffer_.getMode(), framebuffer_.isDoubleBuffered());
+    }
+#endif
     return true;
 }
 
@@ -511,6 +598,26 @@ uint8_t ILI9341Driver::readStatus() {
 }
 #endif
 
+#if POCKETOS_ILI9341_ENABLE_CONFIGURATION
+bool ILI9341Driver::beginFramebuffer(TFTFramebufferMode mode, bool doubleBuffer) {
+    if (!initialized_) return false;
+    return framebuffer_.begin("ILI9341", chainSink(), _width, _height, mode, doubleBuffer);
+}
+
+void ILI9341Driver::endFramebuffer() {
+    framebuffer_.end();
+}
+
+void ILI9341Driver::selectBand(uint16_t band, uint16_t background) {
+    framebuffer_.selectBand(band, background);
+}
+
+bool ILI9341Driver::flush() {
+    if (!initialized_) return false;
+    return framebuffer_.flush();
+}
+#endif
+
 #if POCKETOS_ILI9341_ENABLE_REGISTER_ACCESS
 const RegisterDesc* ILI9341Driver::registers(size_t& count) const {
     count = ILI9341_REGISTER_COUNT;
@@ -529,9 +636,17 @@ bool ILI9341Driver::writeData16(uint16_t data) {
     return sendData16(data);
 }
 
+const RegisterDesc* ILI9341Driver::findRegisterByName(const String& name) const {
+    size_t count;
+    const RegisterDesc* regs = registers(count);
+    return RegisterUtils::findByName(regs, count, name);
+}
+#endif
+
 bool ILI9341Driver::readData(uint8_t cmd, uint8_t* buf, size_t len) {
     if (!initialized_) return false;
     
+    spiWaitIdle();
     setDCCommand();
     setCS(true);
     SPI.transfer(cmd);
@@ -548,13 +663,6 @@ bool ILI9341Driver::readData(uint8_t cmd, uint8_t* buf, size_t len) {
     return true;
 }
 
-const RegisterDesc* ILI9341Driver::findRegisterByName(const String& name) const {
-    size_t count;
-    const RegisterDesc* regs = registers(count);
-    return RegisterUtils::findByName(regs, count, name);
-}
-#endif
-
 bool ILI9341Driver::hardwareReset() {
     if (getPinConfig().rst < 0) return false;
     
@@ -571,6 +679,7 @@ bool ILI9341Driver::hardwareReset() {
 bool ILI9341Driver::sendCommand(uint8_t cmd) {
     if (!initialized_) return false;
     
+    spiWaitIdle();
     setDCCommand();
     setCS(true);
     SPI.transfer(cmd);
@@ -582,6 +691,7 @@ bool ILI9341Driver::sendCommand(uint8_t cmd) {
 bool ILI9341Driver::sendData(uint8_t data) {
     if (!initialized_) return false;
     
+    spiWaitIdle();
     setDCData();
     setCS(true);
     SPI.transfer(data);
@@ -593,6 +703,7 @@ bool ILI9341Driver::sendData(uint8_t data) {
 bool ILI9341Driver::sendData16(uint16_t data) {
     if (!initialized_) return false;
     
+    spiWaitIdle();
     setDCData();
     setCS(true);
     SPI.write16(data);
@@ -0,0 +1,271 @@
+#include "imu_fifo.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace PocketOS {
+
+// ---------------------------------------------------------------------------
+// ImuSampleRing
+// ---------------------------------------------------------------------------
+
+ImuSampleRing::ImuSampleRing()
+    : times(nullptr), mask(0), head(0), tail(0), pushedCount(0), droppedCount(0) {
+    for (uint8_t a = 0; a < IMU_AXES; a++) {
+        axes[a] = nullptr;
+    }
+    memset(&last, 0, sizeof(last));
+}
+
+ImuSampleRing::~ImuSampleRing() {
+    end();
+}
+
+bool ImuSampleRing::begin(uint16_t capacity) {
+    end();
+    if (capacity < 2 || capacity > 32768) {
+        return false;
+    }
+    uint16_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    // One allocation: six int16 axis arrays, then the timestamps
+    uint8_t* block = (uint8_t*)malloc((size_t)size * (IMU_AXES * sizeof(int16_t) + sizeof(uint32_t)));
+    if (!block) {
+        return false;
+    }
+    times = (uint32_t*)block;
+    int16_t* axisBase = (int16_t*)(block + (size_t)size * sizeof(uint32_t));
+    for (uint8_t a = 0; a < IMU_AXES; a++) {
+        axes[a] = axisBase + (size_t)a * size;
+    }
+    mask = (uint16_t)(size - 1);
+    clear();
+    return true;
+}
+
+void ImuSampleRing::end() {
+    free(times);
+    times = nullptr;
+    for (uint8_t a = 0; a < IMU_AXES; a++) {
+        axes[a] = nullptr;
+    }
+    mask = 0;
+    head = tail = 0;
+}
+
+void ImuSampleRing::clear() {
+    head = tail = 0;
+    pushedCount = 0;
+    droppedCount = 0;
+}
+
+void ImuSampleRing::push(const int16_t accel[3], const int16_t gyro[3], uint32_t timestampUs) {
+    for (uint8_t i = 0; i < 3; i++) {
+        last.accel[i] = accel[i];
+        last.gyro[i] = gyro[i];
+    }
+    last.timestampUs = timestampUs;
+    pushedCount++;
+
+    if (!times) {
+        return;
+    }
+    if (head - tail > mask) {
+        tail++;
+        droppedCount++;
+    }
+    uint16_t slot = (uint16_t)(head & mask);
+    axes[IMU_ACCEL_X][slot] = accel[0];
+    axes[IMU_ACCEL_Y][slot] = accel[1];
+    axes[IMU_ACCEL_Z][slot] = accel[2];
+    axes[IMU_GYRO_X][slot] = gyro[0];
+    axes[IMU_GYRO_Y][slot] = gyro[1];
+    axes[IMU_GYRO_Z][slot] = gyro[2];
+    times[slot] = timestampUs;
+    head++;
+}
+
+uint16_t ImuSampleRing::contiguous() const {
+    uint16_t n = available();
+    uint16_t toEnd = (uint16_t)(capacity() - (tail & mask));
+    return n < toEnd ? n : toEnd;
+}
+
+void ImuSampleRing::consume(uint16_t n) {
+    if (n > available()) {
+        n = available();
+    }
+    tail += n;
+}
+
+bool ImuSampleRing::latest(ImuRawSample& sample) const {
+    if (pushedCount == 0) {
+        return false;
+    }
+    sample = last;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// ImuTimebase
+// ---------------------------------------------------------------------------
+
+ImuTimebase::ImuTimebase()
+    : nominalQ8(0), periodQ8(0), baseUs(0), offsetQ8(0), lastAnchorUs(0), sinceAnchor(0),
+      anchored(false) {}
+
+void ImuTimebase::reset(uint32_t nominalPeriodUs) {
+    nominalQ8 = nominalPeriodUs << 8;
+    periodQ8 = nominalQ8;
+    baseUs = 0;
+    offsetQ8 = 0;
+    sinceAnchor = 0;
+    anchored = false;
+}
+
+void ImuTimebase::refine(uint32_t dtUs, uint32_t samples) {
+    if (samples == 0) {
+        return;
+    }
+    uint32_t measured = (uint32_t)(((uint64_t)dtUs << 8) / samples);
+
+    // The sensor clock is within a few percent of nominal: anything far
+    // off is a gap (overflow, stalled reader), not a rate
+    if (measured < nominalQ8 - nominalQ8 / 4 || measured > nominalQ8 + nominalQ8 / 4) {
+        return;
+    }
+    periodQ8 = (uint32_t)((int32_t)periodQ8 + ((int32_t)(measured - periodQ8) / 8));
+}
+
+void ImuTimebase::anchor(uint32_t tUs) {
+    if (anchored) {
+        refine(tUs - lastAnchorUs, sinceAnchor);
+    }
+    lastAnchorUs = tUs;
+    sinceAnchor = 0;
+    anchored = true;
+    baseUs = tUs;
+    offsetQ8 = 0;
+}
+
+void ImuTimebase::anchorBurst(uint32_t tUs, uint16_t n) {
+    if (n == 0) {
+        return;
+    }
+    // n samples were produced since the previous burst's newest sample
+    if (anchored) {
+        refine(tUs - lastAnchorUs, n);
+    }
+    lastAnchorUs = tUs;
+    sinceAnchor = 0;
+    anchored = true;
+    baseUs = tUs - (uint32_t)(((uint64_t)periodQ8 * (n - 1)) >> 8);
+    offsetQ8 = 0;
+}
+
+uint32_t ImuTimebase::next() {
+    uint32_t t = baseUs + (offsetQ8 >> 8);
+    offsetQ8 += periodQ8;
+    if (offsetQ8 >= (1UL << 24)) {
+        baseUs += offsetQ8 >> 8;
+        offsetQ8 &= 0xFF;
+    }
+    sinceAnchor++;
+    return t;
+}
+
+// ---------------------------------------------------------------------------
+// ImuTaggedFifo
+// ---------------------------------------------------------------------------
+
+static inline int16_t le16(const uint8_t* p) {
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+ImuTaggedFifo::ImuTaggedFifo() {
+    reset(true, true, 25000);
+}
+
+void ImuTaggedFifo::reset(bool accelOn, bool gyroOn, uint32_t timestampLsbNs) {
+    wantAccel = accelOn;
+    wantGyro = gyroOn;
+    lsbNs = timestampLsbNs;
+    for (uint8_t i = 0; i < 3; i++) {
+        accel[i] = 0;
+        gyro[i] = 0;
+    }
+    haveAccel = false;
+    haveGyro = false;
+    temperature = 0;
+    haveTemperature = false;
+}
+
+bool ImuTaggedFifo::flush(ImuSampleRing& ring, ImuTimebase& time) {
+    if (!haveAccel && !haveGyro) {
+        return false;
+    }
+    ring.push(accel, gyro, time.next());
+    haveAccel = false;
+    haveGyro = false;
+    return true;
+}
+
+uint16_t ImuTaggedFifo::decode(const uint8_t* words, uint16_t count, ImuSampleRing& ring, ImuTimebase& time) {
+    uint16_t samples = 0;
+
+    for (uint16_t w = 0; w < count; w++) {
+        const uint8_t* word = words + (size_t)w * IMU_TAGGED_WORD_SIZE;
+        const uint8_t* data = word + 1;
+
+        switch (word[0] >> 3) {
+            case IMU_TAG_GYRO:
+                if (haveGyro && flush(ring, time)) {
+                    samples++;
+                }
+                gyro[0] = le16(data);
+                gyro[1] = le16(data + 2);
+                gyro[2] = le16(data + 4);
+                haveGyro = true;
+                break;
+
+            case IMU_TAG_ACCEL:
+                if (haveAccel && flush(ring, time)) {
+                    samples++;
+                }
+                accel[0] = le16(data);
+                accel[1] = le16(data + 2);
+                accel[2] = le16(data + 4);
+                haveAccel = true;
+                break;
+
+            case IMU_TAG_TEMPERATURE:
+                temperature = le16(data);
+                haveTemperature = true;
+                continue;
+
+            case IMU_TAG_TIMESTAMP: {
+                // A half-filled batch belongs to the previous time slot
+                if (flush(ring, time)) {
+                    samples++;
+                }
+                uint32_t ticks = (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+                                 ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+                time.anchor((uint32_t)(((uint64_t)ticks * lsbNs) / 1000));
+                continue;
+            }
+
+            default:
+                continue;   // Configuration change, sensor hub, step counter...
+        }
+
+        if ((!wantAccel || haveAccel) && (!wantGyro || haveGyro) && flush(ring, time)) {
+            samples++;
+        }
+    }
+    return samples;
+}
+
+} // namespace PocketOS
@@ -0,0 +1,170 @@
+#ifndef POCKETOS_IMU_FIFO_H
+#define POCKETOS_IMU_FIFO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PocketOS {
+
+/**
+ * IMU FIFO Batching
+ *
+ * Shared pieces for IMU drivers that drain the sensor FIFO in bursts
+ * instead of reading one sample per poll:
+ *
+ *   ImuSampleRing  - per-device sample ring, structure-of-arrays (one
+ *                    array per axis plus timestamps), raw counts
+ *   ImuTimebase    - a timestamp for every sample from sparse time
+ *                    points (sensor timestamp words or counters, or the
+ *                    host clock), with the sample period tracked
+ *   ImuTaggedFifo  - decoder for ST tagged FIFO words (LSM6DSOX,
+ *                    ISM330DHCX): tag byte + 6 data bytes
+ *
+ * Samples stay in raw int16 counts; the driver owns the scale factors.
+ * A consumer walks contiguous() spans of the ring arrays and consume()s
+ * them, so batches are processed without copying.
+ *
+ * No Arduino dependency: exercised on the host.
+ */
+
+// Samples kept per device (rounded up to a power of two, 16 bytes each)
+// Can be overridden via build flags: -DPOCKETOS_IMU_RING_SAMPLES=1024
+#ifndef POCKETOS_IMU_RING_SAMPLES
+#define POCKETOS_IMU_RING_SAMPLES 512
+#endif
+
+// Wire buffer size: a FIFO burst is read in transactions of at most this
+// many bytes (whole FIFO words)
+#ifndef POCKETOS_IMU_FIFO_I2C_BUFFER
+#define POCKETOS_IMU_FIFO_I2C_BUFFER 128
+#endif
+
+// Output data rate set by init()
+#ifndef POCKETOS_IMU_DEFAULT_ODR_HZ
+#define POCKETOS_IMU_DEFAULT_ODR_HZ 104
+#endif
+
+enum ImuAxis : uint8_t {
+    IMU_ACCEL_X = 0,
+    IMU_ACCEL_Y,
+    IMU_ACCEL_Z,
+    IMU_GYRO_X,
+    IMU_GYRO_Y,
+    IMU_GYRO_Z,
+    IMU_AXES
+};
+
+struct ImuRawSample {
+    int16_t accel[3];
+    int16_t gyro[3];
+    uint32_t timestampUs;
+};
+
+class ImuSampleRing {
+public:
+    ImuSampleRing();
+    ~ImuSampleRing();
+
+    bool begin(uint16_t capacity = POCKETOS_IMU_RING_SAMPLES);
+    void end();
+    void clear();
+
+    // Append one sample; a full ring drops its oldest sample
+    void push(const int16_t accel[3], const int16_t gyro[3], uint32_t timestampUs);
+
+    uint16_t available() const { return (uint16_t)(head - tail); }
+    uint16_t capacity() const { return mask ? (uint16_t)(mask + 1) : 0; }
+
+    // Oldest unconsumed samples stored contiguously: channel(axis)[0..n)
+    // and timestamps()[0..n) with n = contiguous(), then consume(n)
+    uint16_t contiguous() const;
+    const int16_t* channel(ImuAxis axis) const { return axes[axis] + (tail & mask); }
+    const uint32_t* timestamps() const { return times + (tail & mask); }
+    void consume(uint16_t n);
+
+    // Newest sample (kept even without ring storage)
+    bool latest(ImuRawSample& sample) const;
+
+    uint32_t pushed() const { return pushedCount; }
+    uint32_t dropped() const { return droppedCount; }
+
+private:
+    int16_t* axes[IMU_AXES];
+    uint32_t* times;
+    uint16_t mask;          // capacity - 1
+    uint32_t head;          // Free-running write and read counters
+    uint32_t tail;
+    uint32_t pushedCount;
+    uint32_t droppedCount;
+    ImuRawSample last;
+};
+
+class ImuTimebase {
+public:
+    ImuTimebase();
+
+    void reset(uint32_t nominalPeriodUs);
+    // Forget the anchor (after a FIFO overflow or reconfiguration)
+    void resync() { anchored = false; }
+
+    // The next sample was taken at t (timestamp word ahead of its data)
+    void anchor(uint32_t tUs);
+    // The next n samples end at t (time read alongside a FIFO burst)
+    void anchorBurst(uint32_t tUs, uint16_t n);
+
+    uint32_t next();
+
+    uint32_t periodUs() const { return periodQ8 >> 8; }
+    float rateHz() const { return periodQ8 ? 256000000.0f / (float)periodQ8 : 0; }
+
+private:
+    uint32_t nominalQ8;     // Sample period, µs in Q8
+    uint32_t periodQ8;
+    uint32_t baseUs;
+    uint32_t offsetQ8;      // From baseUs to the next sample
+    uint32_t lastAnchorUs;
+    uint32_t sinceAnchor;   // Samples since lastAnchorUs
+    bool anchored;
+
+    void refine(uint32_t dtUs, uint32_t samples);
+};
+
+// ST tagged FIFO word: TAG_SENSOR in bits 7-3 of the first byte
+#define IMU_TAGGED_WORD_SIZE     7
+#define IMU_TAG_GYRO             0x01
+#define IMU_TAG_ACCEL            0x02
+#define IMU_TAG_TEMPERATURE      0x03
+#define IMU_TAG_TIMESTAMP        0x04
+
+class ImuTaggedFifo {
+public:
+    ImuTaggedFifo();
+
+    // Sensors batched, and the timestamp LSB in ns (25000 nominal)
+    void reset(bool accel, bool gyro, uint32_t timestampLsbNs);
+
+    // Decode count words into ring; returns samples pushed. Gyro and
+    // accelerometer words of one batch are paired into one sample; a
+    // sensor missing from a batch repeats its previous value.
+    uint16_t decode(const uint8_t* words, uint16_t count, ImuSampleRing& ring, ImuTimebase& time);
+
+    bool hasTemperature() const { return haveTemperature; }
+    int16_t temperatureRaw() const { return temperature; }
+
+private:
+    bool wantAccel;
+    bool wantGyro;
+    uint32_t lsbNs;
+    int16_t accel[3];
+    int16_t gyro[3];
+    bool haveAccel;
+    bool haveGyro;
+    int16_t temperature;
+    bool haveTemperature;
+
+    bool flush(ImuSampleRing& ring, ImuTimebase& time);
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_IMU_FIFO_H
@@ -9,75 +9,443 @@
 
 namespace PocketOS {
 
-#define ISM330DHCX_REG_WHO_AM_I   0x0F
-#define ISM330DHCX_REG_CTRL1      0x10
-#define ISM330DHCX_REG_CTRL2      0x11
-#define ISM330DHCX_REG_STATUS     0x1E
+// ISM330DHCX Register addresses
+#define ISM330DHCX_REG_FIFO_CTRL1     0x07
+#define ISM330DHCX_REG_FIFO_CTRL2     0x08
+#define ISM330DHCX_REG_FIFO_CTRL3     0x09
+#define ISM330DHCX_REG_FIFO_CTRL4     0x0A
+#define ISM330DHCX_REG_INT1_CTRL      0x0D
+#define ISM330DHCX_REG_WHO_AM_I       0x0F
+#define ISM330DHCX_REG_CTRL1_XL       0x10
+#define ISM330DHCX_REG_CTRL2_G        0x11
+#define ISM330DHCX_REG_CTRL3_C        0x12
+#define ISM330DHCX_REG_CTRL10_C       0x19
+#define ISM330DHCX_REG_FIFO_STATUS1   0x3A
+#define ISM330DHCX_REG_FIFO_STATUS2   0x3B
+#define ISM330DHCX_REG_FREQ_FINE      0x63
+#define ISM330DHCX_REG_FIFO_DATA_TAG  0x78
+
+// WHO_AM_I value
+#define ISM330DHCX_WHO_AM_I_VALUE     0x6B
+
+// CTRL3_C: block data update, register auto-increment, software reset
+#define ISM330DHCX_CTRL3_BDU_INC      0x44
+#define ISM330DHCX_CTRL3_SW_RESET     0x01
+
+// FIFO_CTRL4: timestamp every 32 batches, temperature at 1.6 Hz, continuous mode
+#define ISM330DHCX_FIFO_CTRL4_VALUE   0xD6
+
+// FIFO_STATUS2 bits
+#define ISM330DHCX_FIFO_OVR           0x40
+#define ISM330DHCX_FIFO_WTM_MAX       511
+
+// ODR / BDR codes 1-10, in 0.1 Hz
+static const uint32_t ISM330DHCX_ODR_DHZ[] = { 125, 260, 520, 1040, 2080, 4160, 8330, 16670, 33330, 66670 };
+#define ISM330DHCX_ODR_COUNT (sizeof(ISM330DHCX_ODR_DHZ) / sizeof(ISM330DHCX_ODR_DHZ[0]))
+
+// Burst size: whole 7-byte FIFO words per Wire transaction
+#define ISM330DHCX_BURST_WORDS (POCKETOS_IMU_FIFO_I2C_BUFFER / IMU_TAGGED_WORD_SIZE)
 
 #if POCKETOS_ISM330DHCX_ENABLE_REGISTER_ACCESS
 static const RegisterDesc ISM330DHCX_REGISTERS[] = {
-    RegisterDesc(0x0F, "WHO_AM_I", 1, RegisterAccess::RO, 0x00),
-    RegisterDesc(0x10, "CTRL1", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x11, "CTRL2", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x1E, "STATUS", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x07, "FIFO_CTRL1", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x08, "FIFO_CTRL2", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x09, "FIFO_CTRL3", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x0A, "FIFO_CTRL4", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x0D, "INT1_CTRL", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x0F, "WHO_AM_I", 1, RegisterAccess::RO, 0x6B),
+    RegisterDesc(0x10, "CTRL1_XL", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x11, "CTRL2_G", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x12, "CTRL3_C", 1, RegisterAccess::RW, 0x04),
+    RegisterDesc(0x13, "CTRL4_C", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x14, "CTRL5_C", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x15, "CTRL6_C", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x16, "CTRL7_G", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x17, "CTRL8_XL", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x18, "CTRL9_XL", 1, RegisterAccess::RW, 0xE0),
+    RegisterDesc(0x19, "CTRL10_C", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x20, "OUT_TEMP_L", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x21, "OUT_TEMP_H", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x22, "OUTX_L_G", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x23, "OUTX_H_G", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x24, "OUTY_L_G", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x25, "OUTY_H_G", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x26, "OUTZ_L_G", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x27, "OUTZ_H_G", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x28, "OUTX_L_XL", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x29, "OUTX_H_XL", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x2A, "OUTY_L_XL", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x2B, "OUTY_H_XL", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x2C, "OUTZ_L_XL", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x2D, "OUTZ_H_XL", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x3A, "FIFO_STATUS1", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x3B, "FIFO_STATUS2", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x40, "TIMESTAMP0", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x41, "TIMESTAMP1", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x42, "TIMESTAMP2", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x43, "TIMESTAMP3", 1, RegisterAccess::RO, 0x00),
 };
-
 #define ISM330DHCX_REGISTER_COUNT (sizeof(ISM330DHCX_REGISTERS) / sizeof(RegisterDesc))
 #endif
 
-ISM330DHCXDriver::ISM330DHCXDriver() : address(0), initialized(false) {}
+ISM330DHCXDriver::ISM330DHCXDriver() : address(0), initialized(false),
+                                   accelMg(0.061f), gyroMdps(8.75f),
+                                   odrCode(4), batchAccel(true), batchGyro(true),
+                                   watermark(0), intPin(-1), fifoOverruns(0), busBytes(0) {}
 
 bool ISM330DHCXDriver::init(uint8_t i2cAddress) {
     address = i2cAddress;
-    
+
 #if POCKETOS_ISM330DHCX_ENABLE_LOGGING
-    Logger::info("ISM330DHCX: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("ISM330DHCX: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
-    
-#if POCKETOS_ISM330DHCX_ENABLE_CONFIGURATION
-    writeRegister(ISM330DHCX_REG_CTRL1, 0x00);
-    writeRegister(ISM330DHCX_REG_CTRL2, 0x00);
+
+    // Check WHO_AM_I
+    uint8_t whoAmI = 0;
+    if (!readRegister(ISM330DHCX_REG_WHO_AM_I, &whoAmI)) {
+#if POCKETOS_ISM330DHCX_ENABLE_LOGGING
+        Logger::error("ISM330DHCX: Failed to read WHO_AM_I");
+#endif
+        return false;
+    }
+
+    if (whoAmI != ISM330DHCX_WHO_AM_I_VALUE) {
+#if POCKETOS_ISM330DHCX_ENABLE_LOGGING
+        Logger::error(("ISM330DHCX: Invalid WHO_AM_I: 0x" + String(whoAmI, HEX)).c_str());
+#endif
+        return false;
+    }
+
+    // Software reset, then block data update with auto-increment
+    writeRegister(ISM330DHCX_REG_CTRL3_C, ISM330DHCX_CTRL3_SW_RESET);
+    uint8_t ctrl3 = ISM330DHCX_CTRL3_SW_RESET;
+    for (uint8_t tries = 0; tries < 10 && (ctrl3 & ISM330DHCX_CTRL3_SW_RESET); tries++) {
+        delay(1);
+        readRegister(ISM330DHCX_REG_CTRL3_C, &ctrl3);
+    }
+    writeRegister(ISM330DHCX_REG_CTRL3_C, ISM330DHCX_CTRL3_BDU_INC);
+
+    // ±2g, ±250dps
+    accelMg = 0.061f;
+    gyroMdps = 8.75f;
+    odrCode = 1;
+    while (odrCode < ISM330DHCX_ODR_COUNT && ISM330DHCX_ODR_DHZ[odrCode - 1] < POCKETOS_IMU_DEFAULT_ODR_HZ * 10UL) {
+        odrCode++;
+    }
+
+    if (!ring.begin()) {
+#if POCKETOS_ISM330DHCX_ENABLE_LOGGING
+        Logger::error("ISM330DHCX: Out of memory for sample ring");
+#endif
+        return false;
+    }
+
+    if (!configureFifo()) {
+#if POCKETOS_ISM330DHCX_ENABLE_LOGGING
+        Logger::error("ISM330DHCX: Failed to configure FIFO");
 #endif
-    
+        ring.end();
+        return false;
+    }
+
     initialized = true;
 #if POCKETOS_ISM330DHCX_ENABLE_LOGGING
-    Logger::info("ISM330DHCX: Initialized successfully");
+    Logger::info(("ISM330DHCX: Initialized successfully (FIFO " +
+                  String(ISM330DHCX_ODR_DHZ[odrCode - 1] / 10) + " Hz)").c_str());
 #endif
     return true;
 }
 
 void ISM330DHCXDriver::deinit() {
+    if (initialized) {
+        writeRegister(ISM330DHCX_REG_FIFO_CTRL4, 0x00);  // FIFO bypass
+        writeRegister(ISM330DHCX_REG_CTRL1_XL, 0x00);    // Power down accel
+        writeRegister(ISM330DHCX_REG_CTRL2_G, 0x00);     // Power down gyro
+    }
+    ring.end();
     initialized = false;
 }
 
+uint16_t ISM330DHCXDriver::watermarkWords() const {
+    uint16_t perSample = (uint16_t)((batchAccel ? 1 : 0) + (batchGyro ? 1 : 0));
+    uint32_t words = (uint32_t)watermark * perSample + watermark / 32;
+    if (words > ISM330DHCX_FIFO_WTM_MAX) {
+        words = ISM330DHCX_FIFO_WTM_MAX;
+    }
+    return (uint16_t)(words ? words : 1);
+}
+
+bool ISM330DHCXDriver::configureFifo() {
+    uint8_t ctrl1 = 0;
+    uint8_t ctrl2 = 0;
+    if (!readRegister(ISM330DHCX_REG_CTRL1_XL, &ctrl1) || !readRegister(ISM330DHCX_REG_CTRL2_G, &ctrl2)) {
+        return false;
+    }
+
+    // Bypass first: empties the FIFO so no sample of the old rate remains
+    uint16_t wtm = watermarkWords();
+    bool ok = writeRegister(ISM330DHCX_REG_FIFO_CTRL4, 0x00);
+    ok &= writeRegister(ISM330DHCX_REG_CTRL10_C, 0x20);    // TIMESTAMP_EN
+    ok &= writeRegister(ISM330DHCX_REG_CTRL1_XL, (uint8_t)((odrCode << 4) | (ctrl1 & 0x0F)));
+    ok &= writeRegister(ISM330DHCX_REG_CTRL2_G, (uint8_t)((odrCode << 4) | (ctrl2 & 0x0F)));
+    ok &= writeRegister(ISM330DHCX_REG_FIFO_CTRL1, (uint8_t)(wtm & 0xFF));
+    ok &= writeRegister(ISM330DHCX_REG_FIFO_CTRL2, (uint8_t)(wtm >> 8));
+    ok &= writeRegister(ISM330DHCX_REG_FIFO_CTRL3,
+                        (uint8_t)(((batchGyro ? odrCode : 0) << 4) | (batchAccel ? odrCode : 0)));
+    ok &= writeRegister(ISM330DHCX_REG_INT1_CTRL, 0x08);   // INT1_FIFO_TH
+    ok &= writeRegister(ISM330DHCX_REG_FIFO_CTRL4, ISM330DHCX_FIFO_CTRL4_VALUE);
+    if (!ok) {
+        return false;
+    }
+
+    // Timestamp LSB: 25 µs trimmed by the factory frequency offset
+    uint8_t fine = 0;
+    readRegister(ISM330DHCX_REG_FREQ_FINE, &fine);
+    uint32_t lsbNs = (uint32_t)(25000.0f / (1.0f + 0.0015f * (int8_t)fine));
+
+    decoder.reset(batchAccel, batchGyro, lsbNs);
+    time.reset((uint32_t)(10000000UL / ISM330DHCX_ODR_DHZ[odrCode - 1]));
+    return true;
+}
+
+uint16_t ISM330DHCXDriver::pollFifo() {
+    if (!initialized) {
+        return 0;
+    }
+
+    // INT1 follows the watermark flag: no bus traffic until it is reached
+    if (intPin >= 0 && digitalRead(intPin) == LOW) {
+        return 0;
+    }
+
+    uint8_t status[2];
+    if (!readRegisters(ISM330DHCX_REG_FIFO_STATUS1, status, 2)) {
+        return 0;
+    }
+    busBytes += 2;
+
+    uint16_t words = (uint16_t)(status[0] | ((status[1] & 0x03) << 8));
+    if (status[1] & ISM330DHCX_FIFO_OVR) {
+        fifoOverruns++;
+    }
+    if (words == 0 || (intPin < 0 && watermark > 0 && words < watermarkWords())) {
+        return 0;
+    }
+
+    // Reads from FIFO_DATA_OUT_TAG roll back to the tag register after
+    // each word, so a burst is any number of whole words
+    uint8_t burst[ISM330DHCX_BURST_WORDS * IMU_TAGGED_WORD_SIZE];
+    uint16_t added = 0;
+    while (words > 0) {
+        uint16_t n = words > ISM330DHCX_BURST_WORDS ? ISM330DHCX_BURST_WORDS : words;
+        if (!readRegisters(ISM330DHCX_REG_FIFO_DATA_TAG, burst, (size_t)n * IMU_TAGGED_WORD_SIZE)) {
+            break;
+        }
+        busBytes += (uint32_t)n * IMU_TAGGED_WORD_SIZE;
+        added += decoder.decode(burst, n, ring, time);
+        words -= n;
+    }
+    return added;
+}
+
+ISM330DHCXData ISM330DHCXDriver::readData() {
+    ISM330DHCXData data;
+
+    if (!initialized) {
+        return data;
+    }
+
+    data.batch = pollFifo();
+
+    ImuRawSample sample;
+    if (!ring.latest(sample)) {
+        return data;
+    }
+
+    // Convert to m/s² (mg/LSB * 0.001 * 9.81)
+    float a = accelScale();
+    data.accel_x = sample.accel[0] * a;
+    data.accel_y = sample.accel[1] * a;
+    data.accel_z = sample.accel[2] * a;
+
+    // Convert to rad/s (mdps/LSB * 0.001 * PI/180)
+    float g = gyroScale();
+    data.gyro_x = sample.gyro[0] * g;
+    data.gyro_y = sample.gyro[1] * g;
+    data.gyro_z = sample.gyro[2] * g;
+
+    if (decoder.hasTemperature()) {
+        data.temperature = 25.0f + (decoder.temperatureRaw() / 256.0f);  // LSB/°C = 256
+    }
+
+    data.timestamp_us = sample.timestampUs;
+    data.valid = true;
+    return data;
+}
+
 CapabilitySchema ISM330DHCXDriver::getSchema() const {
     CapabilitySchema schema;
-    schema.tier = POCKETOS_ISM330DHCX_TIER_NAME;
+
+    // Output signals
+    schema.addSignal("accel_x", ParamType::FLOAT, false, "m/s²");
+    schema.addSignal("accel_y", ParamType::FLOAT, false, "m/s²");
+    schema.addSignal("accel_z", ParamType::FLOAT, false, "m/s²");
+    schema.addSignal("gyro_x", ParamType::FLOAT, false, "rad/s");
+    schema.addSignal("gyro_y", ParamType::FLOAT, false, "rad/s");
+    schema.addSignal("gyro_z", ParamType::FLOAT, false, "rad/s");
+    schema.addSignal("temperature", ParamType::FLOAT, false, "°C");
+    schema.addSignal("samples", ParamType::COUNTER, false, "");
+    schema.addSignal("fifo_overruns", ParamType::COUNTER, false, "");
+
+#if POCKETOS_ISM330DHCX_ENABLE_CONFIGURATION
+    schema.addSetting("odr_hz", ParamType::INT, true, 12, 6667, 0, "Hz");
+    schema.addSetting("watermark", ParamType::INT, true, 0, 255, 1, "samples");
+    schema.addSetting("batch", ParamType::ENUM, true, 0, 0, 0, "both,accel,gyro");
+    schema.addSetting("int_pin", ParamType::INT, true, -1, 255, 1, "");
+    schema.addSetting("accel_range", ParamType::INT, true, 0, 3, 1, "");
+    schema.addSetting("gyro_range", ParamType::INT, true, 0, 3, 1, "");
+#endif
+
     return schema;
 }
 
-bool ISM330DHCXDriver::writeRegister(uint8_t reg, uint8_t value) {
-    Wire.beginTransmission(address);
-    Wire.write(reg);
-    Wire.write(value);
-    return Wire.endTransmission() == 0;
+String ISM330DHCXDriver::getParameter(const String& name) {
+    if (name == "samples") {
+        return String(ring.pushed());
+    } else if (name == "ring_dropped") {
+        return String(ring.dropped());
+    } else if (name == "fifo_overruns") {
+        return String(fifoOverruns);
+    } else if (name == "bus_bytes") {
+        return String(busBytes);
+    } else if (name == "rate_hz") {
+        return String(time.rateHz(), 1);
+    }
+#if POCKETOS_ISM330DHCX_ENABLE_CONFIGURATION
+    if (name == "odr_hz") {
+        return String(ISM330DHCX_ODR_DHZ[odrCode - 1] / 10);
+    } else if (name == "watermark") {
+        return String(watermark);
+    } else if (name == "batch") {
+        return batchAccel && batchGyro ? "both" : (batchAccel ? "accel" : "gyro");
+    } else if (name == "int_pin") {
+        return String(intPin);
+    } else if (name == "accel_range") {
+        uint8_t ctrl;
+        if (readRegister(ISM330DHCX_REG_CTRL1_XL, &ctrl)) {
+            return String((ctrl >> 2) & 0x03);
+        }
+    } else if (name == "gyro_range") {
+        uint8_t ctrl;
+        if (readRegister(ISM330DHCX_REG_CTRL2_G, &ctrl)) {
+            return String((ctrl >> 2) & 0x03);
+        }
+    }
+#endif
+    return "";
 }
 
-bool ISM330DHCXDriver::readRegister(uint8_t reg, uint8_t* value) {
-    Wire.beginTransmission(address);
-    Wire.write(reg);
-    if (Wire.endTransmission() != 0) {
+bool ISM330DHCXDriver::setParameter(const String& name, const String& value) {
+#if POCKETOS_ISM330DHCX_ENABLE_CONFIGURATION
+    if (name == "accel_range") {
+        return setAccelRange(value.toInt());
+    } else if (name == "gyro_range") {
+        return setGyroRange(value.toInt());
+    } else if (name == "odr_hz") {
+        long hz = value.toInt();
+        return hz > 0 && hz <= 6667 && setOdr((uint16_t)hz);
+    } else if (name == "watermark") {
+        long samples = value.toInt();
+        return samples >= 0 && samples <= 255 && setWatermark((uint16_t)samples);
+    } else if (name == "batch") {
+        if (value == "both") return setBatching(true, true);
+        if (value == "accel") return setBatching(true, false);
+        if (value == "gyro") return setBatching(false, true);
         return false;
-    }
-    
-    Wire.requestFrom(address, (uint8_t)1);
-    if (Wire.available()) {
-        *value = Wire.read();
+    } else if (name == "int_pin") {
+        long pin = value.toInt();
+        if (pin < -1 || pin > 127) {
+            return false;
+        }
+        setInterruptPin((int8_t)pin);
         return true;
     }
+#endif
+    return false;
+}
+
+#if POCKETOS_ISM330DHCX_ENABLE_CONFIGURATION
+bool ISM330DHCXDriver::setAccelRange(uint8_t range) {
+    if (!initialized || range > 3) return false;
+
+    uint8_t ctrl;
+    if (!readRegister(ISM330DHCX_REG_CTRL1_XL, &ctrl)) return false;
+
+    // Clear and set range bits (FS_XL[1:0])
+    ctrl = (ctrl & 0xF3) | ((range & 0x03) << 2);
+    writeRegister(ISM330DHCX_REG_CTRL1_XL, ctrl);
+
+    // Update scale: 0=±2g, 1=±16g, 2=±4g, 3=±8g
+    float scales[] = { 0.061f, 0.488f, 0.122f, 0.244f };
+    accelMg = scales[range];
+
+    return true;
+}
+
+bool ISM330DHCXDriver::setGyroRange(uint8_t range) {
+    if (!initialized || range > 3) return false;
+
+    uint8_t ctrl;
+    if (!readRegister(ISM330DHCX_REG_CTRL2_G, &ctrl)) return false;
+
+    // Clear and set range bits (FS_G[1:0])
+    ctrl = (ctrl & 0xF3) | ((range & 0x03) << 2);
+    writeRegister(ISM330DHCX_REG_CTRL2_G, ctrl);
+
+    // Update scale: 0=±250dps, 1=±500dps, 2=±1000dps, 3=±2000dps
+    float scales[] = { 8.75f, 17.50f, 35.0f, 70.0f };
+    gyroMdps = scales[range];
+
+    return true;
+}
+
+bool ISM330DHCXDriver::setOdr(uint16_t hz) {
+    if (!initialized) return false;
+
+    for (uint8_t code = 1; code <= ISM330DHCX_ODR_COUNT; code++) {
+        if (ISM330DHCX_ODR_DHZ[code - 1] >= hz * 10UL) {
+            odrCode = code;
+            return configureFifo();
+        }
+    }
     return false;
 }
 
+bool ISM330DHCXDriver::setBatching(bool accel, bool gyro) {
+    if (!initialized || (!accel && !gyro)) return false;
+
+    batchAccel = accel;
+    batchGyro = gyro;
+    return configureFifo();
+}
+
+bool ISM330DHCXDriver::setWatermark(uint16_t samples) {
+    if (!initialized) return false;
+
+    watermark = samples;
+    uint16_t wtm = watermarkWords();
+    return writeRegister(ISM330DHCX_REG_FIFO_CTRL1, (uint8_t)(wtm & 0xFF)) &&
+           writeRegister(ISM330DHCX_REG_FIFO_CTRL2, (uint8_t)(wtm >> 8));
+}
+
+void ISM330DHCXDriver::setInterruptPin(int8_t pin) {
+    intPin = pin;
+    if (pin >= 0) {
+        pinMode(pin, INPUT);
+    }
+}
+#endif
+
 #if POCKETOS_ISM330DHCX_ENABLE_REGISTER_ACCESS
 const RegisterDesc* ISM330DHCXDriver::registers(size_t& count) const {
     count = ISM330DHCX_REGISTER_COUNT;
@@ -85,15 +453,16 @@ const RegisterDesc* ISM330DHCXDriver::registers(size_t& count) const {
 }
 
 bool ISM330DHCXDriver::regRead(uint16_t reg, uint8_t* buf, size_t len) {
-    if (!initialized || reg > 0xFF || len != 1) {
+    if (!initialized || reg > 0xFF) {
         return false;
     }
-    
-    const RegisterDesc* regDesc = RegisterUtils::findByAddr(ISM330DHCX_REGISTERS, ISM330DHCX_REGISTER_COUNT, reg);
+
+    const RegisterDesc* regDesc = RegisterUtils::findByAddr(
+        ISM330DHCX_REGISTERS, ISM330DHCX_REGISTER_COUNT, reg);
     if (!regDesc || !RegisterUtils::isReadable(regDesc->access)) {
         return false;
     }
-    
+
     return readRegister((uint8_t)reg, buf);
 }
 
@@ -101,12 +470,13 @@ bool ISM330DHCXDriver::regWrite(uint16_t reg, const uint8_t* buf, size_t len) {
     if (!initialized || reg > 0xFF || len != 1) {
         return false;
     }
-    
-    const RegisterDesc* regDesc = RegisterUtils::findByAddr(ISM330DHCX_REGISTERS, ISM330DHCX_REGISTER_COUNT, reg);
+
+    const RegisterDesc* regDesc = RegisterUtils::findByAddr(
+        ISM330DHCX_REGISTERS, ISM330DHCX_REGISTER_COUNT, reg);
     if (!regDesc || !RegisterUtils::isWritable(regDesc->access)) {
         return false;
     }
-    
+
     return writeRegister((uint8_t)reg, buf[0]);
 }
 
@@ -115,4 +485,44 @@ const RegisterDesc* ISM330DHCXDriver::findRegisterByName(const String& name) con
 }
 #endif
 
+bool ISM330DHCXDriver::writeRegister(uint8_t reg, uint8_t value) {
+    Wire.beginTransmission(address);
+    Wire.write(reg);
+    Wire.write(value);
+    return Wire.endTransmission() == 0;
+}
+
+bool ISM330DHCXDriver::readRegister(uint8_t reg, uint8_t* value) {
+    Wire.beginTransmission(address);
+    Wire.write(reg);
+    if (Wire.endTransmission(false) != 0) {
+        return false;
+    }
+
+    if (Wire.requestFrom(address, (uint8_t)1) != 1) {
+        return false;
+    }
+
+    *value = Wire.read();
+    return true;
+}
+
+bool ISM330DHCXDriver::readRegisters(uint8_t reg, uint8_t* buffer, size_t len) {
+    Wire.beginTransmission(address);
+    Wire.write(reg);
+    if (Wire.endTransmission(false) != 0) {
+        return false;
+    }
+
+    if (Wire.requestFrom(address, (uint8_t)len) != len) {
+        return false;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        buffer[i] = Wire.read();
+    }
+
+    return true;
+}
+
 } // namespace PocketOS
@@ -4,42 +4,78 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "imu_fifo.h"
+
+#if POCKETOS_ISM330DHCX_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
+#endif
 
 namespace PocketOS {
 
+// ISM330DHCX valid I2C addresses
 #define ISM330DHCX_ADDR_COUNT 2
 const uint8_t ISM330DHCX_VALID_ADDRESSES[ISM330DHCX_ADDR_COUNT] = { 0x6A, 0x6B };
 
+// ISM330DHCX measurement data (newest FIFO sample)
 struct ISM330DHCXData {
-    float accel_x, accel_y, accel_z;  // g
-    float gyro_x, gyro_y, gyro_z;     // dps
+    float accel_x, accel_y, accel_z;  // m/s²
+    float gyro_x, gyro_y, gyro_z;      // rad/s
+    float temperature;                  // °C
+    uint32_t timestamp_us;              // Sensor time of the sample
+    uint16_t batch;                     // Samples drained by this read
     bool valid;
-    
-    ISM330DHCXData() : accel_x(0), accel_y(0), accel_z(0), 
-                       gyro_x(0), gyro_y(0), gyro_z(0), valid(false) {}
+
+    ISM330DHCXData() : accel_x(0), accel_y(0), accel_z(0),
+                     gyro_x(0), gyro_y(0), gyro_z(0),
+                     temperature(0), timestamp_us(0), batch(0), valid(false) {}
 };
 
+/**
+ * ISM330DHCX industrial 6-axis IMU (Accelerometer + Gyroscope)
+ *
+ * Register-compatible FIFO with the LSM6DSOX, batched the same way:
+ * tagged words drained by pollFifo() into an ImuSampleRing, timestamps
+ * from the 25 µs sensor counter, optional INT1 watermark pin.
+ */
 class ISM330DHCXDriver {
 public:
     ISM330DHCXDriver();
-    
+
+    // Driver lifecycle
     bool init(uint8_t i2cAddress);
     void deinit();
     bool isInitialized() const { return initialized; }
-    
+
+    // Read measurements
     ISM330DHCXData readData();
+
+    // FIFO batching: samples added to the ring by this call
+    uint16_t pollFifo();
+    ImuSampleRing& samples() { return ring; }
+    const ImuTimebase& timebase() const { return time; }
+
+    // Raw ring counts to m/s² and rad/s
+    float accelScale() const { return accelMg * 0.001f * 9.81f; }
+    float gyroScale() const { return gyroMdps * 0.001f * 0.017453293f; }
+
+    // Get capability schema
     CapabilitySchema getSchema() const;
-    
+
+    // Parameter get/set
+    String getParameter(const String& name);
+    bool setParameter(const String& name, const String& value);
+
+    // Device info
     uint8_t getAddress() const { return address; }
     String getDriverId() const { return "ism330dhcx"; }
     String getDriverTier() const { return POCKETOS_ISM330DHCX_TIER_NAME; }
-    
+
+    // Address enumeration (all tiers)
     static const uint8_t* validAddresses(size_t& count) {
         count = ISM330DHCX_ADDR_COUNT;
         return ISM330DHCX_VALID_ADDRESSES;
     }
-    
+
     static bool supportsAddress(uint8_t addr) {
         for (size_t i = 0; i < ISM330DHCX_ADDR_COUNT; i++) {
             if (ISM330DHCX_VALID_ADDRESSES[i] == addr) {
@@ -48,22 +84,52 @@ public:
         }
         return false;
     }
-    
+
 #if POCKETOS_ISM330DHCX_ENABLE_REGISTER_ACCESS
+    // Tier 2: Complete register access
     const RegisterDesc* registers(size_t& count) const;
     bool regRead(uint16_t reg, uint8_t* buf, size_t len);
     bool regWrite(uint16_t reg, const uint8_t* buf, size_t len);
     const RegisterDesc* findRegisterByName(const String& name) const;
 #endif
-    
+
+#if POCKETOS_ISM330DHCX_ENABLE_CONFIGURATION
+    // Tier 1: Configuration
+    bool setAccelRange(uint8_t range);
+    bool setGyroRange(uint8_t range);
+    bool setOdr(uint16_t hz);               // 12.5 Hz - 6.66 kHz, rounded up
+    bool setBatching(bool accel, bool gyro);
+    bool setWatermark(uint16_t samples);
+    void setInterruptPin(int8_t pin);       // -1 = poll the FIFO status
+#endif
+
 private:
     uint8_t address;
     bool initialized;
-    
+    float accelMg;          // mg/LSB
+    float gyroMdps;         // mdps/LSB
+
+    uint8_t odrCode;
+    bool batchAccel;
+    bool batchGyro;
+    uint16_t watermark;     // Samples
+    int8_t intPin;
+
+    ImuSampleRing ring;
+    ImuTimebase time;
+    ImuTaggedFifo decoder;
+    uint32_t fifoOverruns;
+    uint32_t busBytes;
+
+    bool configureFifo();
+    uint16_t watermarkWords() const;
+
+    // I2C communication
     bool writeRegister(uint8_t reg, uint8_t value);
     bool readRegister(uint8_t reg, uint8_t* value);
+    bool readRegisters(uint8_t reg, uint8_t* buffer, size_t len);
 };
 
 } // namespace PocketOS
 
-#endif
+#endif // POCKETOS_ISM330DHCX_DRIVER_H
@@ -0,0 +1,119 @@
+#include "lora_airtime.h"
+
+#include <string.h>
+
+namespace PocketOS {
+
+uint32_t loraSymbolUs(const LoRaModemParams& params) {
+    if (params.bandwidthHz == 0) {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)1000000 << params.spreadingFactor) / params.bandwidthHz);
+}
+
+bool loraNeedsLowDataRateOptimize(uint8_t spreadingFactor, uint32_t bandwidthHz) {
+    // 2^SF / BW > 16 ms
+    return ((uint64_t)1000 << spreadingFactor) > (uint64_t)16 * bandwidthHz;
+}
+
+uint32_t loraPayloadSymbols(const LoRaModemParams& params, uint8_t payloadLen) {
+    int32_t sf = params.spreadingFactor;
+    int32_t num = 8 * (int32_t)payloadLen - 4 * sf + 28 + (params.crc ? 16 : 0) -
+                  (params.explicitHeader ? 0 : 20);
+    int32_t den = 4 * (sf - (params.lowDataRateOptimize ? 2 : 0));
+    if (num <= 0 || den <= 0) {
+        return 8;
+    }
+    return 8 + (uint32_t)((num + den - 1) / den) * params.codingRate;
+}
+
+uint32_t loraAirtimeUs(const LoRaModemParams& params, uint8_t payloadLen) {
+    if (params.bandwidthHz == 0) {
+        return 0;
+    }
+    // Whole packet in quarter symbols: preamble + 4.25 + payload symbols
+    uint64_t quarters = 4 * (uint64_t)params.preambleSymbols + 17 +
+                        4 * (uint64_t)loraPayloadSymbols(params, payloadLen);
+    uint64_t us = ((quarters * 1000000) << params.spreadingFactor) / (4 * (uint64_t)params.bandwidthHz);
+    return us > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t)us;
+}
+
+DutyCycleTracker::DutyCycleTracker() {
+    configure(0, 3600000UL);
+}
+
+void DutyCycleTracker::configure(uint16_t permille, uint32_t windowMs) {
+    permille_ = permille > 1000 ? 1000 : permille;
+    windowMs_ = windowMs < LORA_DUTY_BUCKETS ? LORA_DUTY_BUCKETS : windowMs;
+    bucketMs_ = (windowMs_ + LORA_DUTY_BUCKETS - 1) / LORA_DUTY_BUCKETS;   // Buckets cover the whole window
+    reset();
+}
+
+void DutyCycleTracker::reset() {
+    memset(buckets_, 0, sizeof(buckets_));
+    current_ = 0;
+    bucketStartMs_ = 0;
+}
+
+uint64_t DutyCycleTracker::budgetUs() const {
+    return (uint64_t)windowMs_ * permille_;   // ms * 1000 us * permille / 1000
+}
+
+void DutyCycleTracker::advance(uint32_t nowMs) {
+    uint32_t steps = (nowMs - bucketStartMs_) / bucketMs_;
+    if (steps == 0) {
+        return;
+    }
+    if (steps > LORA_DUTY_BUCKETS) {
+        memset(buckets_, 0, sizeof(buckets_));
+    } else {
+        for (uint32_t i = 0; i < steps; i++) {
+            current_ = (uint8_t)((current_ + 1) % (LORA_DUTY_BUCKETS + 1));
+            buckets_[current_] = 0;
+        }
+    }
+    bucketStartMs_ += steps * bucketMs_;
+}
+
+uint64_t DutyCycleTracker::usedUs(uint32_t nowMs) {
+    advance(nowMs);
+    uint64_t used = 0;
+    for (int i = 0; i <= LORA_DUTY_BUCKETS; i++) {
+        used += buckets_[i];
+    }
+    return used;
+}
+
+uint32_t DutyCycleTracker::waitMs(uint32_t nowMs, uint32_t airtimeUs) {
+    if (permille_ == 0) {
+        return 0;
+    }
+    uint64_t budget = budgetUs();
+    if (airtimeUs > budget) {
+        return 0xFFFFFFFFUL;
+    }
+    uint64_t used = usedUs(nowMs);
+    if (used + airtimeUs <= budget) {
+        return 0;
+    }
+    // Buckets leave oldest first; the bucket `age` steps back from the
+    // current one is cleared LORA_DUTY_BUCKETS + 1 - age steps from now
+    for (uint32_t age = LORA_DUTY_BUCKETS; age > 0; age--) {
+        uint8_t idx = (uint8_t)((current_ + LORA_DUTY_BUCKETS + 1 - age) % (LORA_DUTY_BUCKETS + 1));
+        used -= buckets_[idx];
+        if (used + airtimeUs <= budget) {
+            uint32_t clearMs = bucketStartMs_ + (LORA_DUTY_BUCKETS + 1 - age) * bucketMs_;
+            return clearMs - nowMs;
+        }
+    }
+    // Only the current bucket is left and it alone is over budget
+    return bucketStartMs_ + (LORA_DUTY_BUCKETS + 1) * bucketMs_ - nowMs;
+}
+
+void DutyCycleTracker::record(uint32_t nowMs, uint32_t airtimeUs) {
+    advance(nowMs);
+    uint32_t& bucket = buckets_[current_];
+    bucket = airtimeUs > 0xFFFFFFFFUL - bucket ? 0xFFFFFFFFUL : bucket + airtimeUs;
+}
+
+} // namespace PocketOS
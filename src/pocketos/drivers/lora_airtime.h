@@ -0,0 +1,134 @@
+#ifndef POCKETOS_LORA_AIRTIME_H
+#define POCKETOS_LORA_AIRTIME_H
+
+#include <stdint.h>
+
+namespace PocketOS {
+
+/**
+ * LoRa time on air, duty-cycle accounting and packet queues
+ *
+ * loraAirtimeUs() is the Semtech formula (SX1276 datasheet 4.1.1.7) in
+ * integer arithmetic, truncated to the microsecond.
+ *
+ * DutyCycleTracker keeps transmitted airtime in LORA_DUTY_BUCKETS buckets
+ * across the window, plus one extra bucket. Airtime stays counted for at
+ * least the full window after the transmission started, and for at most
+ * one bucket longer. The limit is therefore never exceeded in any
+ * window. The cost is up to window/LORA_DUTY_BUCKETS of extra waiting
+ * (1 minute for the ETSI 1 hour window).
+ *
+ * No Arduino dependency: the SX127x driver and the host radio model
+ * (tools/lorasim) share this code.
+ */
+
+#ifndef LORA_MAX_PAYLOAD
+#define LORA_MAX_PAYLOAD 255
+#endif
+#ifndef LORA_DUTY_BUCKETS
+#define LORA_DUTY_BUCKETS 60
+#endif
+
+struct LoRaModemParams {
+    uint8_t spreadingFactor;     // 6-12
+    uint32_t bandwidthHz;        // 7800 ... 500000
+    uint8_t codingRate;          // 5-8 (4/5 to 4/8)
+    uint16_t preambleSymbols;    // Programmed length; the chip adds 4.25
+    bool explicitHeader;
+    bool crc;
+    bool lowDataRateOptimize;
+
+    LoRaModemParams()
+        : spreadingFactor(7), bandwidthHz(125000), codingRate(5), preambleSymbols(8),
+          explicitHeader(true), crc(true), lowDataRateOptimize(false) {}
+};
+
+// Symbol time (2^SF / BW), microseconds
+uint32_t loraSymbolUs(const LoRaModemParams& params);
+
+// The datasheet requires low data rate optimisation above 16 ms symbols
+bool loraNeedsLowDataRateOptimize(uint8_t spreadingFactor, uint32_t bandwidthHz);
+
+// Payload symbols (header, payload and CRC) after the preamble
+uint32_t loraPayloadSymbols(const LoRaModemParams& params, uint8_t payloadLen);
+
+// Time on air of one packet, preamble to last payload symbol
+uint32_t loraAirtimeUs(const LoRaModemParams& params, uint8_t payloadLen);
+
+class DutyCycleTracker {
+public:
+    DutyCycleTracker();
+
+    // permille: allowed share of the window (10 = 1 %); 0 = no limit
+    void configure(uint16_t permille, uint32_t windowMs);
+    uint16_t permille() const { return permille_; }
+    uint32_t windowMs() const { return windowMs_; }
+    uint64_t budgetUs() const;
+
+    // Airtime still counted against the window at nowMs
+    uint64_t usedUs(uint32_t nowMs);
+
+    // Milliseconds until airtimeUs may start: 0 = now, UINT32_MAX if a
+    // single packet exceeds the whole budget
+    uint32_t waitMs(uint32_t nowMs, uint32_t airtimeUs);
+
+    // Count a transmission starting at nowMs (calls must not go back in time)
+    void record(uint32_t nowMs, uint32_t airtimeUs);
+
+    void reset();
+
+private:
+    uint16_t permille_;
+    uint32_t windowMs_;
+    uint32_t bucketMs_;
+    uint32_t bucketStartMs_;          // Start of the current bucket
+    uint8_t current_;
+    uint32_t buckets_[LORA_DUTY_BUCKETS + 1];   // Airtime, us
+
+    void advance(uint32_t nowMs);
+};
+
+struct LoRaPacket {
+    uint64_t timestampUs;   // RX: RxDone edge; TX: queued
+    int16_t rssi;           // dBm (RX)
+    int8_t snrQuarterDb;    // SNR in 0.25 dB steps (RX)
+    uint8_t len;
+    uint8_t data[LORA_MAX_PAYLOAD];
+};
+
+// Fixed ring of packets, filled and drained in place (no copies through
+// the queue). Single producer and single consumer, both in the main loop.
+template <uint8_t N>
+class LoRaPacketQueue {
+public:
+    static_assert(N > 0 && N <= 128 && (N & (N - 1)) == 0, "Queue size must be a power of two up to 128");
+
+    LoRaPacketQueue() : head_(0), tail_(0), highWater_(0) {}
+
+    // Slot to fill, or nullptr if full; publish it with commit()
+    LoRaPacket* reserve() { return count() < N ? &slots_[head_ & (N - 1)] : nullptr; }
+    void commit() {
+        head_++;
+        if (count() > highWater_) {
+            highWater_ = count();
+        }
+    }
+
+    // Oldest packet, or nullptr if empty; release it with pop()
+    const LoRaPacket* front() const { return count() > 0 ? &slots_[tail_ & (N - 1)] : nullptr; }
+    void pop() { tail_++; }
+
+    uint8_t count() const { return (uint8_t)(head_ - tail_); }
+    uint8_t highWater() const { return highWater_; }
+    void clear() { tail_ = head_; }
+
+private:
+    LoRaPacket slots_[N];
+    uint8_t head_;          // Free-running
+    uint8_t tail_;
+    uint8_t highWater_;
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_LORA_AIRTIME_H
@@ -58,8 +58,9 @@ LPS22HBData LPS22HBDriver::readData() {
     int32_t press_raw = ((int32_t)press_buffer[2] << 16) | ((int32_t)press_buffer[1] << 8) | press_buffer[0];
     int16_t temp_raw = ((int16_t)temp_buffer[1] << 8) | temp_buffer[0];
     
-    data.pressure = press_raw / 4096.0f;
-    data.temperature = temp_raw / 100.0f;
+    // Outputs are already fixed point (1/4096 hPa, 0.01 degC): no compensation
+    data.pressure = press_raw * (1.0f / 4096.0f);  // Exact: power-of-two scale
+    data.temperature = temp_raw * 0.01f;
     data.valid = true;
     
     return data;
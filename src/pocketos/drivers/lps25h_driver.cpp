@@ -58,8 +58,13 @@ LPS25HData LPS25HDriver::readData() {
     int32_t press_raw = ((int32_t)press_buffer[2] << 16) | ((int32_t)press_buffer[1] << 8) | press_buffer[0];
     int16_t temp_raw = ((int16_t)temp_buffer[1] << 8) | temp_buffer[0];
     
+#if POCKETOS_LPS25H_FLOAT_COMPENSATION
     data.pressure = press_raw / 4096.0f;
-    data.temperature = 42.5f + (temp_raw / 480.0f);
+    data.temperature = BaroCompensation::lps25hTemperatureFloat(temp_raw);
+#else
+    data.pressure = press_raw * (1.0f / 4096.0f);  // Exact: power-of-two scale
+    data.temperature = BaroCompensation::lps25hTemperature(temp_raw) * 0.01f;
+#endif
     data.valid = true;
     
     return data;
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "baro_compensation.h"
 
 #if POCKETOS_LPS25H_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
@@ -10,29 +10,57 @@
 namespace PocketOS {
 
 // LSM6DS33 Register addresses
+#define LSM6DS33_REG_FIFO_CTRL1     0x06
+#define LSM6DS33_REG_FIFO_CTRL2     0x07
+#define LSM6DS33_REG_FIFO_CTRL3     0x08
+#define LSM6DS33_REG_FIFO_CTRL5     0x0A
+#define LSM6DS33_REG_INT1_CTRL      0x0D
 #define LSM6DS33_REG_WHO_AM_I       0x0F
 #define LSM6DS33_REG_CTRL1_XL       0x10
 #define LSM6DS33_REG_CTRL2_G        0x11
+#define LSM6DS33_REG_CTRL3_C        0x12
 #define LSM6DS33_REG_OUT_TEMP_L     0x20
-#define LSM6DS33_REG_OUT_TEMP_H     0x21
-#define LSM6DS33_REG_OUTX_L_G       0x22
-#define LSM6DS33_REG_OUTX_H_G       0x23
-#define LSM6DS33_REG_OUTY_L_G       0x24
-#define LSM6DS33_REG_OUTY_H_G       0x25
-#define LSM6DS33_REG_OUTZ_L_G       0x26
-#define LSM6DS33_REG_OUTZ_H_G       0x27
-#define LSM6DS33_REG_OUTX_L_XL      0x28
-#define LSM6DS33_REG_OUTX_H_XL      0x29
-#define LSM6DS33_REG_OUTY_L_XL      0x2A
-#define LSM6DS33_REG_OUTY_H_XL      0x2B
-#define LSM6DS33_REG_OUTZ_L_XL      0x2C
-#define LSM6DS33_REG_OUTZ_H_XL      0x2D
+#define LSM6DS33_REG_FIFO_STATUS1   0x3A
+#define LSM6DS33_REG_FIFO_DATA_OUT  0x3E
+#define LSM6DS33_REG_TIMESTAMP0     0x40
+#define LSM6DS33_REG_TAP_CFG        0x58
+#define LSM6DS33_REG_WAKE_UP_DUR    0x5C
 
 // WHO_AM_I value
 #define LSM6DS33_WHO_AM_I_VALUE     0x69
 
+// CTRL3_C: block data update, register auto-increment, software reset
+#define LSM6DS33_CTRL3_BDU_INC      0x44
+#define LSM6DS33_CTRL3_SW_RESET     0x01
+
+// Timestamp counter: TIMER_EN, TIMER_HR (25 µs LSB, 24 bits)
+#define LSM6DS33_TIMER_EN           0x80
+#define LSM6DS33_TIMER_HR           0x10
+#define LSM6DS33_TIMESTAMP_LSB_US   25
+
+// FIFO_STATUS2 bits
+#define LSM6DS33_FIFO_OVR           0x40
+#define LSM6DS33_FIFO_FTH_MAX       4095
+
+// FIFO_CTRL5: continuous mode
+#define LSM6DS33_FIFO_CONTINUOUS    0x06
+
+// ODR codes 1-10, in 0.1 Hz; the gyro stops at code 8 (1.66 kHz)
+static const uint32_t LSM6DS33_ODR_DHZ[] = { 125, 260, 520, 1040, 2080, 4160, 8330, 16670, 33330, 66670 };
+#define LSM6DS33_ODR_COUNT (sizeof(LSM6DS33_ODR_DHZ) / sizeof(LSM6DS33_ODR_DHZ[0]))
+#define LSM6DS33_GYRO_ODR_MAX       8
+
+// Temperature refresh while batching (not in the FIFO)
+#define LSM6DS33_TEMP_INTERVAL_MS   1000
+
 #if POCKETOS_LSM6DS33_ENABLE_REGISTER_ACCESS
 static const RegisterDesc LSM6DS33_REGISTERS[] = {
+    RegisterDesc(0x06, "FIFO_CTRL1", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x07, "FIFO_CTRL2", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x08, "FIFO_CTRL3", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x09, "FIFO_CTRL4", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x0A, "FIFO_CTRL5", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x0D, "INT1_CTRL", 1, RegisterAccess::RW, 0x00),
     RegisterDesc(0x0F, "WHO_AM_I", 1, RegisterAccess::RO, 0x69),
     RegisterDesc(0x10, "CTRL1_XL", 1, RegisterAccess::RW, 0x00),
     RegisterDesc(0x11, "CTRL2_G", 1, RegisterAccess::RW, 0x00),
@@ -58,20 +86,32 @@ static const RegisterDesc LSM6DS33_REGISTERS[] = {
     RegisterDesc(0x2B, "OUTY_H_XL", 1, RegisterAccess::RO, 0x00),
     RegisterDesc(0x2C, "OUTZ_L_XL", 1, RegisterAccess::RO, 0x00),
     RegisterDesc(0x2D, "OUTZ_H_XL", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x3A, "FIFO_STATUS1", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x3B, "FIFO_STATUS2", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x3C, "FIFO_STATUS3", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x3D, "FIFO_STATUS4", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x40, "TIMESTAMP0", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x41, "TIMESTAMP1", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x42, "TIMESTAMP2", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x58, "TAP_CFG", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x5C, "WAKE_UP_DUR", 1, RegisterAccess::RW, 0x00),
 };
 #define LSM6DS33_REGISTER_COUNT (sizeof(LSM6DS33_REGISTERS) / sizeof(RegisterDesc))
 #endif
 
-LSM6DS33Driver::LSM6DS33Driver() : address(0), initialized(false), 
-                                   accelScale(0.061f), gyroScale(8.75f) {}
+LSM6DS33Driver::LSM6DS33Driver() : address(0), initialized(false),
+                                   accelMg(0.061f), gyroMdps(8.75f),
+                                   odrCode(4), batchAccel(true), batchGyro(true),
+                                   watermark(0), intPin(-1), sensorUs(0), lastTicks(0),
+                                   temperatureRaw(0), lastTempMs(0), fifoOverruns(0), busBytes(0) {}
 
 bool LSM6DS33Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
-    
+
 #if POCKETOS_LSM6DS33_ENABLE_LOGGING
-    Logger::info("LSM6DS33: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("LSM6DS33: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
-    
+
     // Check WHO_AM_I
     uint8_t whoAmI = 0;
     if (!readRegister(LSM6DS33_REG_WHO_AM_I, &whoAmI)) {
@@ -80,114 +120,287 @@ bool LSM6DS33Driver::init(uint8_t i2cAddress) {
 #endif
         return false;
     }
-    
+
     if (whoAmI != LSM6DS33_WHO_AM_I_VALUE) {
 #if POCKETOS_LSM6DS33_ENABLE_LOGGING
-        Logger::error("LSM6DS33: Invalid WHO_AM_I: 0x" + String(whoAmI, HEX));
+        Logger::error(("LSM6DS33: Invalid WHO_AM_I: 0x" + String(whoAmI, HEX)).c_str());
 #endif
         return false;
     }
-    
-#if POCKETOS_LSM6DS33_ENABLE_CONFIGURATION
-    // Configure accelerometer: 104Hz, ±2g
-    writeRegister(LSM6DS33_REG_CTRL1_XL, 0x40);
-    accelScale = 0.061f;  // mg/LSB for ±2g
-    
-    // Configure gyroscope: 104Hz, ±245dps
-    writeRegister(LSM6DS33_REG_CTRL2_G, 0x40);
-    gyroScale = 8.75f;  // mdps/LSB for ±245dps
-#else
-    // Minimal configuration: 104Hz for both
-    writeRegister(LSM6DS33_REG_CTRL1_XL, 0x40);
-    writeRegister(LSM6DS33_REG_CTRL2_G, 0x40);
-    accelScale = 0.061f;
-    gyroScale = 8.75f;
+
+    // Software reset, then block data update with auto-increment
+    writeRegister(LSM6DS33_REG_CTRL3_C, LSM6DS33_CTRL3_SW_RESET);
+    uint8_t ctrl3 = LSM6DS33_CTRL3_SW_RESET;
+    for (uint8_t tries = 0; tries < 10 && (ctrl3 & LSM6DS33_CTRL3_SW_RESET); tries++) {
+        delay(1);
+        readRegister(LSM6DS33_REG_CTRL3_C, &ctrl3);
+    }
+    writeRegister(LSM6DS33_REG_CTRL3_C, LSM6DS33_CTRL3_BDU_INC);
+
+    // Timestamp counter at 25 µs
+    writeRegister(LSM6DS33_REG_TAP_CFG, LSM6DS33_TIMER_EN);
+    writeRegister(LSM6DS33_REG_WAKE_UP_DUR, LSM6DS33_TIMER_HR);
+
+    // ±2g, ±250dps
+    accelMg = 0.061f;
+    gyroMdps = 8.75f;
+    odrCode = 1;
+    while (odrCode < LSM6DS33_ODR_COUNT && LSM6DS33_ODR_DHZ[odrCode - 1] < POCKETOS_IMU_DEFAULT_ODR_HZ * 10UL) {
+        odrCode++;
+    }
+    if (odrCode > LSM6DS33_GYRO_ODR_MAX) {
+        odrCode = LSM6DS33_GYRO_ODR_MAX;
+    }
+
+    if (!ring.begin()) {
+#if POCKETOS_LSM6DS33_ENABLE_LOGGING
+        Logger::error("LSM6DS33: Out of memory for sample ring");
+#endif
+        return false;
+    }
+
+    if (!configureFifo()) {
+#if POCKETOS_LSM6DS33_ENABLE_LOGGING
+        Logger::error("LSM6DS33: Failed to configure FIFO");
 #endif
-    
-    delay(10);  // Wait for first measurement
-    
+        ring.end();
+        return false;
+    }
+
     initialized = true;
 #if POCKETOS_LSM6DS33_ENABLE_LOGGING
-    Logger::info("LSM6DS33: Initialized successfully");
+    Logger::info(("LSM6DS33: Initialized successfully (FIFO " +
+                  String(LSM6DS33_ODR_DHZ[odrCode - 1] / 10) + " Hz)").c_str());
 #endif
     return true;
 }
 
 void LSM6DS33Driver::deinit() {
     if (initialized) {
-        writeRegister(LSM6DS33_REG_CTRL1_XL, 0x00);  // Power down accel
-        writeRegister(LSM6DS33_REG_CTRL2_G, 0x00);   // Power down gyro
+        writeRegister(LSM6DS33_REG_FIFO_CTRL5, 0x00);  // FIFO bypass
+        writeRegister(LSM6DS33_REG_CTRL1_XL, 0x00);    // Power down accel
+        writeRegister(LSM6DS33_REG_CTRL2_G, 0x00);     // Power down gyro
     }
+    ring.end();
     initialized = false;
 }
 
+uint16_t LSM6DS33Driver::watermarkWords() const {
+    uint32_t words = (uint32_t)watermark * patternWords();
+    if (words > LSM6DS33_FIFO_FTH_MAX) {
+        words = LSM6DS33_FIFO_FTH_MAX;
+    }
+    return (uint16_t)(words ? words : patternWords());
+}
+
+bool LSM6DS33Driver::configureFifo() {
+    uint8_t ctrl1 = 0;
+    uint8_t ctrl2 = 0;
+    if (!readRegister(LSM6DS33_REG_CTRL1_XL, &ctrl1) || !readRegister(LSM6DS33_REG_CTRL2_G, &ctrl2)) {
+        return false;
+    }
+
+    // Bypass first: empties the FIFO so no sample of the old rate remains
+    uint16_t fth = watermarkWords();
+    uint8_t gyroCode = odrCode > LSM6DS33_GYRO_ODR_MAX ? LSM6DS33_GYRO_ODR_MAX : odrCode;
+    bool ok = writeRegister(LSM6DS33_REG_FIFO_CTRL5, 0x00);
+    ok &= writeRegister(LSM6DS33_REG_CTRL1_XL, (uint8_t)((odrCode << 4) | (ctrl1 & 0x0F)));
+    ok &= writeRegister(LSM6DS33_REG_CTRL2_G, (uint8_t)((gyroCode << 4) | (ctrl2 & 0x0F)));
+    ok &= writeRegister(LSM6DS33_REG_FIFO_CTRL1, (uint8_t)(fth & 0xFF));
+    ok &= writeRegister(LSM6DS33_REG_FIFO_CTRL2, (uint8_t)(fth >> 8));
+    // Decimation 1 (no decimation) for batched sensors, 0 for the others
+    ok &= writeRegister(LSM6DS33_REG_FIFO_CTRL3, (uint8_t)(((batchGyro ? 1 : 0) << 3) | (batchAccel ? 1 : 0)));
+    ok &= writeRegister(LSM6DS33_REG_INT1_CTRL, 0x08);   // INT1_FTH
+    ok &= writeRegister(LSM6DS33_REG_FIFO_CTRL5, (uint8_t)((odrCode << 3) | LSM6DS33_FIFO_CONTINUOUS));
+    if (!ok) {
+        return false;
+    }
+
+    time.reset((uint32_t)(10000000UL / LSM6DS33_ODR_DHZ[odrCode - 1]));
+    return true;
+}
+
+uint32_t LSM6DS33Driver::readTimestampUs() {
+    uint8_t buf[3];
+    if (!readRegisters(LSM6DS33_REG_TIMESTAMP0, buf, 3)) {
+        return sensorUs;
+    }
+    busBytes += 3;
+
+    // 24-bit counter (wraps after 419 s): accumulate the deltas
+    uint32_t ticks = (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16);
+    sensorUs += ((ticks - lastTicks) & 0xFFFFFF) * LSM6DS33_TIMESTAMP_LSB_US;
+    lastTicks = ticks;
+    return sensorUs;
+}
+
+uint16_t LSM6DS33Driver::pollFifo() {
+    if (!initialized) {
+        return 0;
+    }
+
+    // INT1 follows the threshold flag: no bus traffic until it is reached
+    if (intPin >= 0 && digitalRead(intPin) == LOW) {
+        return 0;
+    }
+
+    // Time first: every sample counted by the status is older than it
+    uint32_t now = readTimestampUs();
+    uint8_t status[4];
+    if (!readRegisters(LSM6DS33_REG_FIFO_STATUS1, status, 4)) {
+        return 0;
+    }
+    busBytes += 4;
+
+    uint16_t words = (uint16_t)(status[0] | ((status[1] & 0x0F) << 8));
+    uint16_t pattern = (uint16_t)(status[2] | ((status[3] & 0x03) << 8));
+    uint8_t per = patternWords();
+    if (status[1] & LSM6DS33_FIFO_OVR) {
+        fifoOverruns++;
+        time.resync();
+    }
+
+    // After an overrun the next word may be mid-sample: drop to the pattern start
+    uint8_t burst[POCKETOS_IMU_FIFO_I2C_BUFFER];
+    if (pattern != 0 && pattern < per) {
+        uint16_t skip = (uint16_t)(per - pattern);
+        if (skip > words || !readRegisters(LSM6DS33_REG_FIFO_DATA_OUT, burst, (size_t)skip * 2)) {
+            return 0;
+        }
+        busBytes += (uint32_t)skip * 2;
+        words -= skip;
+    }
+
+    uint16_t count = words / per;
+    if (count == 0 || (intPin < 0 && watermark > 0 && count < watermark)) {
+        return 0;
+    }
+    time.anchorBurst(now, count);
+
+    // FIFO_DATA_OUT_H rolls back to _L: whole samples per transaction
+    ImuRawSample held;
+    if (!ring.latest(held)) {
+        memset(&held, 0, sizeof(held));
+    }
+    const uint16_t sampleBytes = (uint16_t)(per * 2);
+    const uint16_t perBurst = (uint16_t)(sizeof(burst) / sampleBytes);
+    uint16_t added = 0;
+    while (added < count) {
+        uint16_t n = (uint16_t)(count - added) > perBurst ? perBurst : (uint16_t)(count - added);
+        if (!readRegisters(LSM6DS33_REG_FIFO_DATA_OUT, burst, (size_t)n * sampleBytes)) {
+            break;
+        }
+        busBytes += (uint32_t)n * sampleBytes;
+
+        const uint8_t* p = burst;
+        for (uint16_t i = 0; i < n; i++) {
+            if (batchGyro) {
+                for (uint8_t k = 0; k < 3; k++, p += 2) {
+                    held.gyro[k] = (int16_t)(p[0] | (p[1] << 8));
+                }
+            }
+            if (batchAccel) {
+                for (uint8_t k = 0; k < 3; k++, p += 2) {
+                    held.accel[k] = (int16_t)(p[0] | (p[1] << 8));
+                }
+            }
+            ring.push(held.accel, held.gyro, time.next());
+        }
+        added += n;
+    }
+    return added;
+}
+
 LSM6DS33Data LSM6DS33Driver::readData() {
     LSM6DS33Data data;
-    
+
     if (!initialized) {
         return data;
     }
-    
-    uint8_t buffer[6];
-    
-    // Read accelerometer data (6 bytes)
-    if (readRegisters(LSM6DS33_REG_OUTX_L_XL, buffer, 6)) {
-        int16_t x = (int16_t)((buffer[1] << 8) | buffer[0]);
-        int16_t y = (int16_t)((buffer[3] << 8) | buffer[2]);
-        int16_t z = (int16_t)((buffer[5] << 8) | buffer[4]);
-        
-        // Convert to m/s² (mg/LSB * 0.001 * 9.81)
-        data.accel_x = x * accelScale * 0.001f * 9.81f;
-        data.accel_y = y * accelScale * 0.001f * 9.81f;
-        data.accel_z = z * accelScale * 0.001f * 9.81f;
-    }
-    
-    // Read gyroscope data (6 bytes)
-    if (readRegisters(LSM6DS33_REG_OUTX_L_G, buffer, 6)) {
-        int16_t x = (int16_t)((buffer[1] << 8) | buffer[0]);
-        int16_t y = (int16_t)((buffer[3] << 8) | buffer[2]);
-        int16_t z = (int16_t)((buffer[5] << 8) | buffer[4]);
-        
-        // Convert to rad/s (mdps/LSB * 0.001 * PI/180)
-        float dpsToRad = 0.001f * 3.14159265f / 180.0f;
-        data.gyro_x = x * gyroScale * dpsToRad;
-        data.gyro_y = y * gyroScale * dpsToRad;
-        data.gyro_z = z * gyroScale * dpsToRad;
-    }
-    
-    // Read temperature (2 bytes)
-    uint8_t tempBuf[2];
-    if (readRegisters(LSM6DS33_REG_OUT_TEMP_L, tempBuf, 2)) {
-        int16_t temp = (int16_t)((tempBuf[1] << 8) | tempBuf[0]);
-        data.temperature = 25.0f + (temp / 16.0f);  // LSB/°C = 16
-    }
-    
+
+    data.batch = pollFifo();
+
+    ImuRawSample sample;
+    if (!ring.latest(sample)) {
+        return data;
+    }
+
+    // Convert to m/s² (mg/LSB * 0.001 * 9.81)
+    float a = accelScale();
+    data.accel_x = sample.accel[0] * a;
+    data.accel_y = sample.accel[1] * a;
+    data.accel_z = sample.accel[2] * a;
+
+    // Convert to rad/s (mdps/LSB * 0.001 * PI/180)
+    float g = gyroScale();
+    data.gyro_x = sample.gyro[0] * g;
+    data.gyro_y = sample.gyro[1] * g;
+    data.gyro_z = sample.gyro[2] * g;
+
+    // Temperature is not batched: refresh it once a second
+    unsigned long nowMs = millis();
+    if (lastTempMs == 0 || nowMs - lastTempMs >= LSM6DS33_TEMP_INTERVAL_MS) {
+        uint8_t tempBuf[2];
+        if (readRegisters(LSM6DS33_REG_OUT_TEMP_L, tempBuf, 2)) {
+            temperatureRaw = (int16_t)((tempBuf[1] << 8) | tempBuf[0]);
+            lastTempMs = nowMs ? nowMs : 1;
+        }
+    }
+    data.temperature = 25.0f + (temperatureRaw / 16.0f);  // LSB/°C = 16
+
+    data.timestamp_us = sample.timestampUs;
     data.valid = true;
     return data;
 }
 
 CapabilitySchema LSM6DS33Driver::getSchema() const {
     CapabilitySchema schema;
-    
-    // Basic settings
-    schema.addSetting("driver", ParamType::STRING, true, "lsm6ds33", "", "", "");
-    schema.addSetting("tier", ParamType::STRING, true, POCKETOS_LSM6DS33_TIER_NAME, "", "", "");
-    
+
     // Output signals
-    schema.addSignal("accel_x", ParamType::FLOAT, true, "m/s²");
-    schema.addSignal("accel_y", ParamType::FLOAT, true, "m/s²");
-    schema.addSignal("accel_z", ParamType::FLOAT, true, "m/s²");
-    schema.addSignal("gyro_x", ParamType::FLOAT, true, "rad/s");
-    schema.addSignal("gyro_y", ParamType::FLOAT, true, "rad/s");
-    schema.addSignal("gyro_z", ParamType::FLOAT, true, "rad/s");
-    schema.addSignal("temperature", ParamType::FLOAT, true, "°C");
-    
+    schema.addSignal("accel_x", ParamType::FLOAT, false, "m/s²");
+    schema.addSignal("accel_y", ParamType::FLOAT, false, "m/s²");
+    schema.addSignal("accel_z", ParamType::FLOAT, false, "m/s²");
+    schema.addSignal("gyro_x", ParamType::FLOAT, false, "rad/s");
+    schema.addSignal("gyro_y", ParamType::FLOAT, false, "rad/s");
+    schema.addSignal("gyro_z", ParamType::FLOAT, false, "rad/s");
+    schema.addSignal("temperature", ParamType::FLOAT, false, "°C");
+    schema.addSignal("samples", ParamType::COUNTER, false, "");
+    schema.addSignal("fifo_overruns", ParamType::COUNTER, false, "");
+
+#if POCKETOS_LSM6DS33_ENABLE_CONFIGURATION
+    schema.addSetting("odr_hz", ParamType::INT, true, 12, 6667, 0, "Hz");
+    schema.addSetting("watermark", ParamType::INT, true, 0, 682, 1, "samples");
+    schema.addSetting("batch", ParamType::ENUM, true, 0, 0, 0, "both,accel,gyro");
+    schema.addSetting("int_pin", ParamType::INT, true, -1, 255, 1, "");
+    schema.addSetting("accel_range", ParamType::INT, true, 0, 3, 1, "");
+    schema.addSetting("gyro_range", ParamType::INT, true, 0, 3, 1, "");
+#endif
+
     return schema;
 }
 
 String LSM6DS33Driver::getParameter(const String& name) {
+    if (name == "samples") {
+        return String(ring.pushed());
+    } else if (name == "ring_dropped") {
+        return String(ring.dropped());
+    } else if (name == "fifo_overruns") {
+        return String(fifoOverruns);
+    } else if (name == "bus_bytes") {
+        return String(busBytes);
+    } else if (name == "rate_hz") {
+        return String(time.rateHz(), 1);
+    }
 #if POCKETOS_LSM6DS33_ENABLE_CONFIGURATION
-    if (name == "accel_range") {
+    if (name == "odr_hz") {
+        return String(LSM6DS33_ODR_DHZ[odrCode - 1] / 10);
+    } else if (name == "watermark") {
+        return String(watermark);
+    } else if (name == "batch") {
+        return batchAccel && batchGyro ? "both" : (batchAccel ? "accel" : "gyro");
+    } else if (name == "int_pin") {
+        return String(intPin);
+    } else if (name == "accel_range") {
         uint8_t ctrl;
         if (readRegister(LSM6DS33_REG_CTRL1_XL, &ctrl)) {
             return String((ctrl >> 2) & 0x03);
@@ -208,6 +421,24 @@ bool LSM6DS33Driver::setParameter(const String& name, const String& value) {
         return setAccelRange(value.toInt());
     } else if (name == "gyro_range") {
         return setGyroRange(value.toInt());
+    } else if (name == "odr_hz") {
+        long hz = value.toInt();
+        return hz > 0 && hz <= 6667 && setOdr((uint16_t)hz);
+    } else if (name == "watermark") {
+        long samples = value.toInt();
+        return samples >= 0 && samples <= 682 && setWatermark((uint16_t)samples);
+    } else if (name == "batch") {
+        if (value == "both") return setBatching(true, true);
+        if (value == "accel") return setBatching(true, false);
+        if (value == "gyro") return setBatching(false, true);
+        return false;
+    } else if (name == "int_pin") {
+        long pin = value.toInt();
+        if (pin < -1 || pin > 127) {
+            return false;
+        }
+        setInterruptPin((int8_t)pin);
+        return true;
     }
 #endif
     return false;
@@ -216,37 +447,77 @@ bool LSM6DS33Driver::setParameter(const String& name, const String& value) {
 #if POCKETOS_LSM6DS33_ENABLE_CONFIGURATION
 bool LSM6DS33Driver::setAccelRange(uint8_t range) {
     if (!initialized || range > 3) return false;
-    
+
     uint8_t ctrl;
     if (!readRegister(LSM6DS33_REG_CTRL1_XL, &ctrl)) return false;
-    
+
     // Clear and set range bits (FS_XL[1:0])
     ctrl = (ctrl & 0xF3) | ((range & 0x03) << 2);
     writeRegister(LSM6DS33_REG_CTRL1_XL, ctrl);
-    
+
     // Update scale: 0=±2g, 1=±16g, 2=±4g, 3=±8g
     float scales[] = { 0.061f, 0.488f, 0.122f, 0.244f };
-    accelScale = scales[range];
-    
+    accelMg = scales[range];
+
     return true;
 }
 
 bool LSM6DS33Driver::setGyroRange(uint8_t range) {
     if (!initialized || range > 3) return false;
-    
+
     uint8_t ctrl;
     if (!readRegister(LSM6DS33_REG_CTRL2_G, &ctrl)) return false;
-    
+
     // Clear and set range bits (FS_G[1:0])
     ctrl = (ctrl & 0xF3) | ((range & 0x03) << 2);
     writeRegister(LSM6DS33_REG_CTRL2_G, ctrl);
-    
-    // Update scale: 0=±245dps, 1=±500dps, 2=±1000dps, 3=±2000dps
+
+    // Update scale: 0=±250dps, 1=±500dps, 2=±1000dps, 3=±2000dps
     float scales[] = { 8.75f, 17.50f, 35.0f, 70.0f };
-    gyroScale = scales[range];
-    
+    gyroMdps = scales[range];
+
     return true;
 }
+
+bool LSM6DS33Driver::setOdr(uint16_t hz) {
+    if (!initialized) return false;
+
+    uint8_t maxCode = batchGyro ? LSM6DS33_GYRO_ODR_MAX : LSM6DS33_ODR_COUNT;
+    for (uint8_t code = 1; code <= maxCode; code++) {
+        if (LSM6DS33_ODR_DHZ[code - 1] >= hz * 10UL) {
+            odrCode = code;
+            return configureFifo();
+        }
+    }
+    return false;
+}
+
+bool LSM6DS33Driver::setBatching(bool accel, bool gyro) {
+    if (!initialized || (!accel && !gyro)) return false;
+
+    batchAccel = accel;
+    batchGyro = gyro;
+    if (gyro && odrCode > LSM6DS33_GYRO_ODR_MAX) {
+        odrCode = LSM6DS33_GYRO_ODR_MAX;
+    }
+    return configureFifo();
+}
+
+bool LSM6DS33Driver::setWatermark(uint16_t samples) {
+    if (!initialized) return false;
+
+    watermark = samples;
+    uint16_t fth = watermarkWords();
+    return writeRegister(LSM6DS33_REG_FIFO_CTRL1, (uint8_t)(fth & 0xFF)) &&
+           writeRegister(LSM6DS33_REG_FIFO_CTRL2, (uint8_t)(fth >> 8));
+}
+
+void LSM6DS33Driver::setInterruptPin(int8_t pin) {
+    intPin = pin;
+    if (pin >= 0) {
+        pinMode(pin, INPUT);
+    }
+}
 #endif
 
 #if POCKETOS_LSM6DS33_ENABLE_REGISTER_ACCESS
@@ -259,13 +530,13 @@ bool LSM6DS33Driver::regRead(uint16_t reg, uint8_t* buf, size_t len) {
     if (!initialized || reg > 0xFF) {
         return false;
     }
-    
+
     const RegisterDesc* regDesc = RegisterUtils::findByAddr(
         LSM6DS33_REGISTERS, LSM6DS33_REGISTER_COUNT, reg);
     if (!regDesc || !RegisterUtils::isReadable(regDesc->access)) {
         return false;
     }
-    
+
     return readRegister((uint8_t)reg, buf);
 }
 
@@ -273,13 +544,13 @@ bool LSM6DS33Driver::regWrite(uint16_t reg, const uint8_t* buf, size_t len) {
     if (!initialized || reg > 0xFF || len != 1) {
         return false;
     }
-    
+
     const RegisterDesc* regDesc = RegisterUtils::findByAddr(
         LSM6DS33_REGISTERS, LSM6DS33_REGISTER_COUNT, reg);
     if (!regDesc || !RegisterUtils::isWritable(regDesc->access)) {
         return false;
     }
-    
+
     return writeRegister((uint8_t)reg, buf[0]);
 }
 
@@ -301,11 +572,11 @@ bool LSM6DS33Driver::readRegister(uint8_t reg, uint8_t* value) {
     if (Wire.endTransmission(false) != 0) {
         return false;
     }
-    
+
     if (Wire.requestFrom(address, (uint8_t)1) != 1) {
         return false;
     }
-    
+
     *value = Wire.read();
     return true;
 }
@@ -316,15 +587,15 @@ bool LSM6DS33Driver::readRegisters(uint8_t reg, uint8_t* buffer, size_t len) {
     if (Wire.endTransmission(false) != 0) {
         return false;
     }
-    
+
     if (Wire.requestFrom(address, (uint8_t)len) != len) {
         return false;
     }
-    
+
     for (size_t i = 0; i < len; i++) {
         buffer[i] = Wire.read();
     }
-    
+
     return true;
 }
 
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "imu_fifo.h"
 
 #if POCKETOS_LSM6DS33_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
@@ -15,49 +16,70 @@ namespace PocketOS {
 #define LSM6DS33_ADDR_COUNT 2
 const uint8_t LSM6DS33_VALID_ADDRESSES[LSM6DS33_ADDR_COUNT] = { 0x6A, 0x6B };
 
-// LSM6DS33 measurement data
+// LSM6DS33 measurement data (newest FIFO sample)
 struct LSM6DS33Data {
     float accel_x, accel_y, accel_z;  // m/s²
     float gyro_x, gyro_y, gyro_z;      // rad/s
     float temperature;                  // °C
+    uint32_t timestamp_us;              // Sensor time of the sample
+    uint16_t batch;                     // Samples drained by this read
     bool valid;
-    
+
     LSM6DS33Data() : accel_x(0), accel_y(0), accel_z(0),
                      gyro_x(0), gyro_y(0), gyro_z(0),
-                     temperature(0), valid(false) {}
+                     temperature(0), timestamp_us(0), batch(0), valid(false) {}
 };
 
-// LSM6DS33 6-axis IMU (Accelerometer + Gyroscope)
+/**
+ * LSM6DS33 6-axis IMU (Accelerometer + Gyroscope)
+ *
+ * The FIFO holds untagged 16-bit words in a fixed pattern (gyro XYZ then
+ * accel XYZ). pollFifo() reads the 25 µs timestamp counter and the FIFO
+ * status, realigns to the pattern if needed, and drains whole samples
+ * (12 bytes with both sensors, the minimum the data allows) into the
+ * ImuSampleRing. Sample times count back from the timestamp at the
+ * newest sample. Gyro batching limits the rate to 1.66 kHz; accel alone
+ * runs to 6.66 kHz.
+ */
 class LSM6DS33Driver {
 public:
     LSM6DS33Driver();
-    
+
     // Driver lifecycle
     bool init(uint8_t i2cAddress);
     void deinit();
     bool isInitialized() const { return initialized; }
-    
+
     // Read measurements
     LSM6DS33Data readData();
-    
+
+    // FIFO batching: samples added to the ring by this call
+    uint16_t pollFifo();
+    ImuSampleRing& samples() { return ring; }
+    const ImuTimebase& timebase() const { return time; }
+
+    // Raw ring counts to m/s² and rad/s
+    float accelScale() const { return accelMg * 0.001f * 9.81f; }
+    float gyroScale() const { return gyroMdps * 0.001f * 0.017453293f; }
+
     // Get capability schema
     CapabilitySchema getSchema() const;
-    
+
     // Parameter get/set
     String getParameter(const String& name);
     bool setParameter(const String& name, const String& value);
-    
+
     // Device info
     uint8_t getAddress() const { return address; }
     String getDriverId() const { return "lsm6ds33"; }
     String getDriverTier() const { return POCKETOS_LSM6DS33_TIER_NAME; }
-    
+
     // Address enumeration (all tiers)
     static const uint8_t* validAddresses(size_t& count) {
         count = LSM6DS33_ADDR_COUNT;
         return LSM6DS33_VALID_ADDRESSES;
     }
-    
+
     static bool supportsAddress(uint8_t addr) {
         for (size_t i = 0; i < LSM6DS33_ADDR_COUNT; i++) {
             if (LSM6DS33_VALID_ADDRESSES[i] == addr) {
@@ -66,7 +88,7 @@ public:
         }
         return false;
     }
-    
+
 #if POCKETOS_LSM6DS33_ENABLE_REGISTER_ACCESS
     // Tier 2: Complete register access
     const RegisterDesc* registers(size_t& count) const;
@@ -74,19 +96,43 @@ public:
     bool regWrite(uint16_t reg, const uint8_t* buf, size_t len);
     const RegisterDesc* findRegisterByName(const String& name) const;
 #endif
-    
+
 #if POCKETOS_LSM6DS33_ENABLE_CONFIGURATION
     // Tier 1: Configuration
     bool setAccelRange(uint8_t range);
     bool setGyroRange(uint8_t range);
+    bool setOdr(uint16_t hz);               // 12.5 Hz - 6.66 kHz (1.66 kHz with gyro)
+    bool setBatching(bool accel, bool gyro);
+    bool setWatermark(uint16_t samples);
+    void setInterruptPin(int8_t pin);       // -1 = poll the FIFO status
 #endif
-    
+
 private:
     uint8_t address;
     bool initialized;
-    float accelScale;
-    float gyroScale;
-    
+    float accelMg;          // mg/LSB
+    float gyroMdps;         // mdps/LSB
+
+    uint8_t odrCode;
+    bool batchAccel;
+    bool batchGyro;
+    uint16_t watermark;     // Samples
+    int8_t intPin;
+
+    ImuSampleRing ring;
+    ImuTimebase time;
+    uint32_t sensorUs;      // Timestamp counter, unwrapped from 24 bits
+    uint32_t lastTicks;
+    int16_t temperatureRaw;
+    unsigned long lastTempMs;
+    uint32_t fifoOverruns;
+    uint32_t busBytes;
+
+    bool configureFifo();
+    uint16_t watermarkWords() const;
+    uint8_t patternWords() const { return (uint8_t)((batchAccel ? 3 : 0) + (batchGyro ? 3 : 0)); }
+    uint32_t readTimestampUs();
+
     // I2C communication
     bool writeRegister(uint8_t reg, uint8_t value);
     bool readRegister(uint8_t reg, uint8_t* value);
@@ -10,29 +10,49 @@
 namespace PocketOS {
 
 // LSM6DSOX Register addresses
+#define LSM6DSOX_REG_FIFO_CTRL1     0x07
+#define LSM6DSOX_REG_FIFO_CTRL2     0x08
+#define LSM6DSOX_REG_FIFO_CTRL3     0x09
+#define LSM6DSOX_REG_FIFO_CTRL4     0x0A
+#define LSM6DSOX_REG_INT1_CTRL      0x0D
 #define LSM6DSOX_REG_WHO_AM_I       0x0F
 #define LSM6DSOX_REG_CTRL1_XL       0x10
 #define LSM6DSOX_REG_CTRL2_G        0x11
-#define LSM6DSOX_REG_OUT_TEMP_L     0x20
-#define LSM6DSOX_REG_OUT_TEMP_H     0x21
-#define LSM6DSOX_REG_OUTX_L_G       0x22
-#define LSM6DSOX_REG_OUTX_H_G       0x23
-#define LSM6DSOX_REG_OUTY_L_G       0x24
-#define LSM6DSOX_REG_OUTY_H_G       0x25
-#define LSM6DSOX_REG_OUTZ_L_G       0x26
-#define LSM6DSOX_REG_OUTZ_H_G       0x27
-#define LSM6DSOX_REG_OUTX_L_XL      0x28
-#define LSM6DSOX_REG_OUTX_H_XL      0x29
-#define LSM6DSOX_REG_OUTY_L_XL      0x2A
-#define LSM6DSOX_REG_OUTY_H_XL      0x2B
-#define LSM6DSOX_REG_OUTZ_L_XL      0x2C
-#define LSM6DSOX_REG_OUTZ_H_XL      0x2D
+#define LSM6DSOX_REG_CTRL3_C        0x12
+#define LSM6DSOX_REG_CTRL10_C       0x19
+#define LSM6DSOX_REG_FIFO_STATUS1   0x3A
+#define LSM6DSOX_REG_FIFO_STATUS2   0x3B
+#define LSM6DSOX_REG_FREQ_FINE      0x63
+#define LSM6DSOX_REG_FIFO_DATA_TAG  0x78
 
 // WHO_AM_I value
 #define LSM6DSOX_WHO_AM_I_VALUE     0x6C
 
+// CTRL3_C: block data update, register auto-increment, software reset
+#define LSM6DSOX_CTRL3_BDU_INC      0x44
+#define LSM6DSOX_CTRL3_SW_RESET     0x01
+
+// FIFO_CTRL4: timestamp every 32 batches, temperature at 1.6 Hz, continuous mode
+#define LSM6DSOX_FIFO_CTRL4_VALUE   0xD6
+
+// FIFO_STATUS2 bits
+#define LSM6DSOX_FIFO_OVR           0x40
+#define LSM6DSOX_FIFO_WTM_MAX       511
+
+// ODR / BDR codes 1-10, in 0.1 Hz
+static const uint32_t LSM6DSOX_ODR_DHZ[] = { 125, 260, 520, 1040, 2080, 4160, 8330, 16670, 33330, 66670 };
+#define LSM6DSOX_ODR_COUNT (sizeof(LSM6DSOX_ODR_DHZ) / sizeof(LSM6DSOX_ODR_DHZ[0]))
+
+// Burst size: whole 7-byte FIFO words per Wire transaction
+#define LSM6DSOX_BURST_WORDS (POCKETOS_IMU_FIFO_I2C_BUFFER / IMU_TAGGED_WORD_SIZE)
+
 #if POCKETOS_LSM6DSOX_ENABLE_REGISTER_ACCESS
 static const RegisterDesc LSM6DSOX_REGISTERS[] = {
+    RegisterDesc(0x07, "FIFO_CTRL1", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x08, "FIFO_CTRL2", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x09, "FIFO_CTRL3", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x0A, "FIFO_CTRL4", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x0D, "INT1_CTRL", 1, RegisterAccess::RW, 0x00),
     RegisterDesc(0x0F, "WHO_AM_I", 1, RegisterAccess::RO, 0x6C),
     RegisterDesc(0x10, "CTRL1_XL", 1, RegisterAccess::RW, 0x00),
     RegisterDesc(0x11, "CTRL2_G", 1, RegisterAccess::RW, 0x00),
@@ -58,20 +78,28 @@ static const RegisterDesc LSM6DSOX_REGISTERS[] = {
     RegisterDesc(0x2B, "OUTY_H_XL", 1, RegisterAccess::RO, 0x00),
     RegisterDesc(0x2C, "OUTZ_L_XL", 1, RegisterAccess::RO, 0x00),
     RegisterDesc(0x2D, "OUTZ_H_XL", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x3A, "FIFO_STATUS1", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x3B, "FIFO_STATUS2", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x40, "TIMESTAMP0", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x41, "TIMESTAMP1", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x42, "TIMESTAMP2", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x43, "TIMESTAMP3", 1, RegisterAccess::RO, 0x00),
 };
 #define LSM6DSOX_REGISTER_COUNT (sizeof(LSM6DSOX_REGISTERS) / sizeof(RegisterDesc))
 #endif
 
-LSM6DSOXDriver::LSM6DSOXDriver() : address(0), initialized(false), 
-                                   accelScale(0.061f), gyroScale(8.75f) {}
+LSM6DSOXDriver::LSM6DSOXDriver() : address(0), initialized(false),
+                                   accelMg(0.061f), gyroMdps(8.75f),
+                                   odrCode(4), batchAccel(true), batchGyro(true),
+                                   watermark(0), intPin(-1), fifoOverruns(0), busBytes(0) {}
 
 bool LSM6DSOXDriver::init(uint8_t i2cAddress) {
     address = i2cAddress;
-    
+
 #if POCKETOS_LSM6DSOX_ENABLE_LOGGING
-    Logger::info("LSM6DSOX: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("LSM6DSOX: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
-    
+
     // Check WHO_AM_I
     uint8_t whoAmI = 0;
     if (!readRegister(LSM6DSOX_REG_WHO_AM_I, &whoAmI)) {
@@ -80,114 +108,229 @@ bool LSM6DSOXDriver::init(uint8_t i2cAddress) {
 #endif
         return false;
     }
-    
+
     if (whoAmI != LSM6DSOX_WHO_AM_I_VALUE) {
 #if POCKETOS_LSM6DSOX_ENABLE_LOGGING
-        Logger::error("LSM6DSOX: Invalid WHO_AM_I: 0x" + String(whoAmI, HEX));
+        Logger::error(("LSM6DSOX: Invalid WHO_AM_I: 0x" + String(whoAmI, HEX)).c_str());
 #endif
         return false;
     }
-    
-#if POCKETOS_LSM6DSOX_ENABLE_CONFIGURATION
-    // Configure accelerometer: 104Hz, ±2g
-    writeRegister(LSM6DSOX_REG_CTRL1_XL, 0x40);
-    accelScale = 0.061f;  // mg/LSB for ±2g
-    
-    // Configure gyroscope: 104Hz, ±250dps
-    writeRegister(LSM6DSOX_REG_CTRL2_G, 0x40);
-    gyroScale = 8.75f;  // mdps/LSB for ±250dps
-#else
-    // Minimal configuration: 104Hz for both
-    writeRegister(LSM6DSOX_REG_CTRL1_XL, 0x40);
-    writeRegister(LSM6DSOX_REG_CTRL2_G, 0x40);
-    accelScale = 0.061f;
-    gyroScale = 8.75f;
+
+    // Software reset, then block data update with auto-increment
+    writeRegister(LSM6DSOX_REG_CTRL3_C, LSM6DSOX_CTRL3_SW_RESET);
+    uint8_t ctrl3 = LSM6DSOX_CTRL3_SW_RESET;
+    for (uint8_t tries = 0; tries < 10 && (ctrl3 & LSM6DSOX_CTRL3_SW_RESET); tries++) {
+        delay(1);
+        readRegister(LSM6DSOX_REG_CTRL3_C, &ctrl3);
+    }
+    writeRegister(LSM6DSOX_REG_CTRL3_C, LSM6DSOX_CTRL3_BDU_INC);
+
+    // ±2g, ±250dps
+    accelMg = 0.061f;
+    gyroMdps = 8.75f;
+    odrCode = 1;
+    while (odrCode < LSM6DSOX_ODR_COUNT && LSM6DSOX_ODR_DHZ[odrCode - 1] < POCKETOS_IMU_DEFAULT_ODR_HZ * 10UL) {
+        odrCode++;
+    }
+
+    if (!ring.begin()) {
+#if POCKETOS_LSM6DSOX_ENABLE_LOGGING
+        Logger::error("LSM6DSOX: Out of memory for sample ring");
+#endif
+        return false;
+    }
+
+    if (!configureFifo()) {
+#if POCKETOS_LSM6DSOX_ENABLE_LOGGING
+        Logger::error("LSM6DSOX: Failed to configure FIFO");
 #endif
-    
-    delay(10);  // Wait for first measurement
-    
+        ring.end();
+        return false;
+    }
+
     initialized = true;
 #if POCKETOS_LSM6DSOX_ENABLE_LOGGING
-    Logger::info("LSM6DSOX: Initialized successfully");
+    Logger::info(("LSM6DSOX: Initialized successfully (FIFO " +
+                  String(LSM6DSOX_ODR_DHZ[odrCode - 1] / 10) + " Hz)").c_str());
 #endif
     return true;
 }
 
 void LSM6DSOXDriver::deinit() {
     if (initialized) {
-        writeRegister(LSM6DSOX_REG_CTRL1_XL, 0x00);  // Power down accel
-        writeRegister(LSM6DSOX_REG_CTRL2_G, 0x00);   // Power down gyro
+        writeRegister(LSM6DSOX_REG_FIFO_CTRL4, 0x00);  // FIFO bypass
+        writeRegister(LSM6DSOX_REG_CTRL1_XL, 0x00);    // Power down accel
+        writeRegister(LSM6DSOX_REG_CTRL2_G, 0x00);     // Power down gyro
     }
+    ring.end();
     initialized = false;
 }
 
+uint16_t LSM6DSOXDriver::watermarkWords() const {
+    uint16_t perSample = (uint16_t)((batchAccel ? 1 : 0) + (batchGyro ? 1 : 0));
+    uint32_t words = (uint32_t)watermark * perSample + watermark / 32;
+    if (words > LSM6DSOX_FIFO_WTM_MAX) {
+        words = LSM6DSOX_FIFO_WTM_MAX;
+    }
+    return (uint16_t)(words ? words : 1);
+}
+
+bool LSM6DSOXDriver::configureFifo() {
+    uint8_t ctrl1 = 0;
+    uint8_t ctrl2 = 0;
+    if (!readRegister(LSM6DSOX_REG_CTRL1_XL, &ctrl1) || !readRegister(LSM6DSOX_REG_CTRL2_G, &ctrl2)) {
+        return false;
+    }
+
+    // Bypass first: empties the FIFO so no sample of the old rate remains
+    uint16_t wtm = watermarkWords();
+    bool ok = writeRegister(LSM6DSOX_REG_FIFO_CTRL4, 0x00);
+    ok &= writeRegister(LSM6DSOX_REG_CTRL10_C, 0x20);    // TIMESTAMP_EN
+    ok &= writeRegister(LSM6DSOX_REG_CTRL1_XL, (uint8_t)((odrCode << 4) | (ctrl1 & 0x0F)));
+    ok &= writeRegister(LSM6DSOX_REG_CTRL2_G, (uint8_t)((odrCode << 4) | (ctrl2 & 0x0F)));
+    ok &= writeRegister(LSM6DSOX_REG_FIFO_CTRL1, (uint8_t)(wtm & 0xFF));
+    ok &= writeRegister(LSM6DSOX_REG_FIFO_CTRL2, (uint8_t)(wtm >> 8));
+    ok &= writeRegister(LSM6DSOX_REG_FIFO_CTRL3,
+                        (uint8_t)(((batchGyro ? odrCode : 0) << 4) | (batchAccel ? odrCode : 0)));
+    ok &= writeRegister(LSM6DSOX_REG_INT1_CTRL, 0x08);   // INT1_FIFO_TH
+    ok &= writeRegister(LSM6DSOX_REG_FIFO_CTRL4, LSM6DSOX_FIFO_CTRL4_VALUE);
+    if (!ok) {
+        return false;
+    }
+
+    // Timestamp LSB: 25 µs trimmed by the factory frequency offset
+    uint8_t fine = 0;
+    readRegister(LSM6DSOX_REG_FREQ_FINE, &fine);
+    uint32_t lsbNs = (uint32_t)(25000.0f / (1.0f + 0.0015f * (int8_t)fine));
+
+    decoder.reset(batchAccel, batchGyro, lsbNs);
+    time.reset((uint32_t)(10000000UL / LSM6DSOX_ODR_DHZ[odrCode - 1]));
+    return true;
+}
+
+uint16_t LSM6DSOXDriver::pollFifo() {
+    if (!initialized) {
+        return 0;
+    }
+
+    // INT1 follows the watermark flag: no bus traffic until it is reached
+    if (intPin >= 0 && digitalRead(intPin) == LOW) {
+        return 0;
+    }
+
+    uint8_t status[2];
+    if (!readRegisters(LSM6DSOX_REG_FIFO_STATUS1, status, 2)) {
+        return 0;
+    }
+    busBytes += 2;
+
+    uint16_t words = (uint16_t)(status[0] | ((status[1] & 0x03) << 8));
+    if (status[1] & LSM6DSOX_FIFO_OVR) {
+        fifoOverruns++;
+    }
+    if (words == 0 || (intPin < 0 && watermark > 0 && words < watermarkWords())) {
+        return 0;
+    }
+
+    // Reads from FIFO_DATA_OUT_TAG roll back to the tag register after
+    // each word, so a burst is any number of whole words
+    uint8_t burst[LSM6DSOX_BURST_WORDS * IMU_TAGGED_WORD_SIZE];
+    uint16_t added = 0;
+    while (words > 0) {
+        uint16_t n = words > LSM6DSOX_BURST_WORDS ? LSM6DSOX_BURST_WORDS : words;
+        if (!readRegisters(LSM6DSOX_REG_FIFO_DATA_TAG, burst, (size_t)n * IMU_TAGGED_WORD_SIZE)) {
+            break;
+        }
+        busBytes += (uint32_t)n * IMU_TAGGED_WORD_SIZE;
+        added += decoder.decode(burst, n, ring, time);
+        words -= n;
+    }
+    return added;
+}
+
 LSM6DSOXData LSM6DSOXDriver::readData() {
     LSM6DSOXData data;
-    
+
     if (!initialized) {
         return data;
     }
-    
-    uint8_t buffer[6];
-    
-    // Read accelerometer data (6 bytes)
-    if (readRegisters(LSM6DSOX_REG_OUTX_L_XL, buffer, 6)) {
-        int16_t x = (int16_t)((buffer[1] << 8) | buffer[0]);
-        int16_t y = (int16_t)((buffer[3] << 8) | buffer[2]);
-        int16_t z = (int16_t)((buffer[5] << 8) | buffer[4]);
-        
-        // Convert to m/s² (mg/LSB * 0.001 * 9.81)
-        data.accel_x = x * accelScale * 0.001f * 9.81f;
-        data.accel_y = y * accelScale * 0.001f * 9.81f;
-        data.accel_z = z * accelScale * 0.001f * 9.81f;
-    }
-    
-    // Read gyroscope data (6 bytes)
-    if (readRegisters(LSM6DSOX_REG_OUTX_L_G, buffer, 6)) {
-        int16_t x = (int16_t)((buffer[1] << 8) | buffer[0]);
-        int16_t y = (int16_t)((buffer[3] << 8) | buffer[2]);
-        int16_t z = (int16_t)((buffer[5] << 8) | buffer[4]);
-        
-        // Convert to rad/s (mdps/LSB * 0.001 * PI/180)
-        float dpsToRad = 0.001f * 3.14159265f / 180.0f;
-        data.gyro_x = x * gyroScale * dpsToRad;
-        data.gyro_y = y * gyroScale * dpsToRad;
-        data.gyro_z = z * gyroScale * dpsToRad;
-    }
-    
-    // Read temperature (2 bytes)
-    uint8_t tempBuf[2];
-    if (readRegisters(LSM6DSOX_REG_OUT_TEMP_L, tempBuf, 2)) {
-        int16_t temp = (int16_t)((tempBuf[1] << 8) | tempBuf[0]);
-        data.temperature = 25.0f + (temp / 256.0f);  // LSB/°C = 256
-    }
-    
+
+    data.batch = pollFifo();
+
+    ImuRawSample sample;
+    if (!ring.latest(sample)) {
+        return data;
+    }
+
+    // Convert to m/s² (mg/LSB * 0.001 * 9.81)
+    float a = accelScale();
+    data.accel_x = sample.accel[0] * a;
+    data.accel_y = sample.accel[1] * a;
+    data.accel_z = sample.accel[2] * a;
+
+    // Convert to rad/s (mdps/LSB * 0.001 * PI/180)
+    float g = gyroScale();
+    data.gyro_x = sample.gyro[0] * g;
+    data.gyro_y = sample.gyro[1] * g;
+    data.gyro_z = sample.gyro[2] * g;
+
+    if (decoder.hasTemperature()) {
+        data.temperature = 25.0f + (decoder.temperatureRaw() / 256.0f);  // LSB/°C = 256
+    }
+
+    data.timestamp_us = sample.timestampUs;
     data.valid = true;
     return data;
 }
 
 CapabilitySchema LSM6DSOXDriver::getSchema() const {
     CapabilitySchema schema;
-    
-    // Basic settings
-    schema.addSetting("driver", ParamType::STRING, true, "lsm6dsox", "", "", "");
-    schema.addSetting("tier", ParamType::STRING, true, POCKETOS_LSM6DSOX_TIER_NAME, "", "", "");
-    
+
     // Output signals
-    schema.addSignal("accel_x", ParamType::FLOAT, true, "m/s²");
-    schema.addSignal("accel_y", ParamType::FLOAT, true, "m/s²");
-    schema.addSignal("accel_z", ParamType::FLOAT, true, "m/s²");
-    schema.addSignal("gyro_x", ParamType::FLOAT, true, "rad/s");
-    schema.addSignal("gyro_y", ParamType::FLOAT, true, "rad/s");
-    schema.addSignal("gyro_z", ParamType::FLOAT, true, "rad/s");
-    schema.addSignal("temperature", ParamType::FLOAT, true, "°C");
-    
+    schema.addSignal("accel_x", ParamType::FLOAT, false, "m/s²");
+    schema.addSignal("accel_y", ParamType::FLOAT, false, "m/s²");
+    schema.addSignal("accel_z", ParamType::FLOAT, false, "m/s²");
+    schema.addSignal("gyro_x", ParamType::FLOAT, false, "rad/s");
+    schema.addSignal("gyro_y", ParamType::FLOAT, false, "rad/s");
+    schema.addSignal("gyro_z", ParamType::FLOAT, false, "rad/s");
+    schema.addSignal("temperature", ParamType::FLOAT, false, "°C");
+    schema.addSignal("samples", ParamType::COUNTER, false, "");
+    schema.addSignal("fifo_overruns", ParamType::COUNTER, false, "");
+
+#if POCKETOS_LSM6DSOX_ENABLE_CONFIGURATION
+    schema.addSetting("odr_hz", ParamType::INT, true, 12, 6667, 0, "Hz");
+    schema.addSetting("watermark", ParamType::INT, true, 0, 255, 1, "samples");
+    schema.addSetting("batch", ParamType::ENUM, true, 0, 0, 0, "both,accel,gyro");
+    schema.addSetting("int_pin", ParamType::INT, true, -1, 255, 1, "");
+    schema.addSetting("accel_range", ParamType::INT, true, 0, 3, 1, "");
+    schema.addSetting("gyro_range", ParamType::INT, true, 0, 3, 1, "");
+#endif
+
     return schema;
 }
 
 String LSM6DSOXDriver::getParameter(const String& name) {
+    if (name == "samples") {
+        return String(ring.pushed());
+    } else if (name == "ring_dropped") {
+        return String(ring.dropped());
+    } else if (name == "fifo_overruns") {
+        return String(fifoOverruns);
+    } else if (name == "bus_bytes") {
+        return String(busBytes);
+    } else if (name == "rate_hz") {
+        return String(time.rateHz(), 1);
+    }
 #if POCKETOS_LSM6DSOX_ENABLE_CONFIGURATION
-    if (name == "accel_range") {
+    if (name == "odr_hz") {
+        return String(LSM6DSOX_ODR_DHZ[odrCode - 1] / 10);
+    } else if (name == "watermark") {
+        return String(watermark);
+    } else if (name == "batch") {
+        return batchAccel && batchGyro ? "both" : (batchAccel ? "accel" : "gyro");
+    } else if (name == "int_pin") {
+        return String(intPin);
+    } else if (name == "accel_range") {
         uint8_t ctrl;
         if (readRegister(LSM6DSOX_REG_CTRL1_XL, &ctrl)) {
             return String((ctrl >> 2) & 0x03);
@@ -208,6 +351,24 @@ bool LSM6DSOXDriver::setParameter(const String& name, const String& value) {
         return setAccelRange(value.toInt());
     } else if (name == "gyro_range") {
         return setGyroRange(value.toInt());
+    } else if (name == "odr_hz") {
+        long hz = value.toInt();
+        return hz > 0 && hz <= 6667 && setOdr((uint16_t)hz);
+    } else if (name == "watermark") {
+        long samples = value.toInt();
+        return samples >= 0 && samples <= 255 && setWatermark((uint16_t)samples);
+    } else if (name == "batch") {
+        if (value == "both") return setBatching(true, true);
+        if (value == "accel") return setBatching(true, false);
+        if (value == "gyro") return setBatching(false, true);
+        return false;
+    } else if (name == "int_pin") {
+        long pin = value.toInt();
+        if (pin < -1 || pin > 127) {
+            return false;
+        }
+        setInterruptPin((int8_t)pin);
+        return true;
     }
 #endif
     return false;
@@ -216,37 +377,73 @@ bool LSM6DSOXDriver::setParameter(const String& name, const String& value) {
 #if POCKETOS_LSM6DSOX_ENABLE_CONFIGURATION
 bool LSM6DSOXDriver::setAccelRange(uint8_t range) {
     if (!initialized || range > 3) return false;
-    
+
     uint8_t ctrl;
     if (!readRegister(LSM6DSOX_REG_CTRL1_XL, &ctrl)) return false;
-    
+
     // Clear and set range bits (FS_XL[1:0])
     ctrl = (ctrl & 0xF3) | ((range & 0x03) << 2);
     writeRegister(LSM6DSOX_REG_CTRL1_XL, ctrl);
-    
+
     // Update scale: 0=±2g, 1=±16g, 2=±4g, 3=±8g
     float scales[] = { 0.061f, 0.488f, 0.122f, 0.244f };
-    accelScale = scales[range];
-    
+    accelMg = scales[range];
+
     return true;
 }
 
 bool LSM6DSOXDriver::setGyroRange(uint8_t range) {
     if (!initialized || range > 3) return false;
-    
+
     uint8_t ctrl;
     if (!readRegister(LSM6DSOX_REG_CTRL2_G, &ctrl)) return false;
-    
+
     // Clear and set range bits (FS_G[1:0])
     ctrl = (ctrl & 0xF3) | ((range & 0x03) << 2);
     writeRegister(LSM6DSOX_REG_CTRL2_G, ctrl);
-    
+
     // Update scale: 0=±250dps, 1=±500dps, 2=±1000dps, 3=±2000dps
     float scales[] = { 8.75f, 17.50f, 35.0f, 70.0f };
-    gyroScale = scales[range];
-    
+    gyroMdps = scales[range];
+
     return true;
 }
+
+bool LSM6DSOXDriver::setOdr(uint16_t hz) {
+    if (!initialized) return false;
+
+    for (uint8_t code = 1; code <= LSM6DSOX_ODR_COUNT; code++) {
+        if (LSM6DSOX_ODR_DHZ[code - 1] >= hz * 10UL) {
+            odrCode = code;
+            return configureFifo();
+        }
+    }
+    return false;
+}
+
+bool LSM6DSOXDriver::setBatching(bool accel, bool gyro) {
+    if (!initialized || (!accel && !gyro)) return false;
+
+    batchAccel = accel;
+    batchGyro = gyro;
+    return configureFifo();
+}
+
+bool LSM6DSOXDriver::setWatermark(uint16_t samples) {
+    if (!initialized) return false;
+
+    watermark = samples;
+    uint16_t wtm = watermarkWords();
+    return writeRegister(LSM6DSOX_REG_FIFO_CTRL1, (uint8_t)(wtm & 0xFF)) &&
+           writeRegister(LSM6DSOX_REG_FIFO_CTRL2, (uint8_t)(wtm >> 8));
+}
+
+void LSM6DSOXDriver::setInterruptPin(int8_t pin) {
+    intPin = pin;
+    if (pin >= 0) {
+        pinMode(pin, INPUT);
+    }
+}
 #endif
 
 #if POCKETOS_LSM6DSOX_ENABLE_REGISTER_ACCESS
@@ -259,13 +456,13 @@ bool LSM6DSOXDriver::regRead(uint16_t reg, uint8_t* buf, size_t len) {
     if (!initialized || reg > 0xFF) {
         return false;
     }
-    
+
     const RegisterDesc* regDesc = RegisterUtils::findByAddr(
         LSM6DSOX_REGISTERS, LSM6DSOX_REGISTER_COUNT, reg);
     if (!regDesc || !RegisterUtils::isReadable(regDesc->access)) {
         return false;
     }
-    
+
     return readRegister((uint8_t)reg, buf);
 }
 
@@ -273,13 +470,13 @@ bool LSM6DSOXDriver::regWrite(uint16_t reg, const uint8_t* buf, size_t len) {
     if (!initialized || reg > 0xFF || len != 1) {
         return false;
     }
-    
+
     const RegisterDesc* regDesc = RegisterUtils::findByAddr(
         LSM6DSOX_REGISTERS, LSM6DSOX_REGISTER_COUNT, reg);
     if (!regDesc || !RegisterUtils::isWritable(regDesc->access)) {
         return false;
     }
-    
+
     return writeRegister((uint8_t)reg, buf[0]);
 }
 
@@ -301,11 +498,11 @@ bool LSM6DSOXDriver::readRegister(uint8_t reg, uint8_t* value) {
     if (Wire.endTransmission(false) != 0) {
         return false;
     }
-    
+
     if (Wire.requestFrom(address, (uint8_t)1) != 1) {
         return false;
     }
-    
+
     *value = Wire.read();
     return true;
 }
@@ -316,15 +513,15 @@ bool LSM6DSOXDriver::readRegisters(uint8_t reg, uint8_t* buffer, size_t len) {
     if (Wire.endTransmission(false) != 0) {
         return false;
     }
-    
+
     if (Wire.requestFrom(address, (uint8_t)len) != len) {
         return false;
     }
-    
+
     for (size_t i = 0; i < len; i++) {
         buffer[i] = Wire.read();
     }
-    
+
     return true;
 }
 
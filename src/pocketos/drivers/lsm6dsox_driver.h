@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "imu_fifo.h"
 
 #if POCKETOS_LSM6DSOX_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
@@ -15,49 +16,73 @@ namespace PocketOS {
 #define LSM6DSOX_ADDR_COUNT 2
 const uint8_t LSM6DSOX_VALID_ADDRESSES[LSM6DSOX_ADDR_COUNT] = { 0x6A, 0x6B };
 
-// LSM6DSOX measurement data
+// LSM6DSOX measurement data (newest FIFO sample)
 struct LSM6DSOXData {
     float accel_x, accel_y, accel_z;  // m/s²
     float gyro_x, gyro_y, gyro_z;      // rad/s
     float temperature;                  // °C
+    uint32_t timestamp_us;              // Sensor time of the sample
+    uint16_t batch;                     // Samples drained by this read
     bool valid;
-    
+
     LSM6DSOXData() : accel_x(0), accel_y(0), accel_z(0),
                      gyro_x(0), gyro_y(0), gyro_z(0),
-                     temperature(0), valid(false) {}
+                     temperature(0), timestamp_us(0), batch(0), valid(false) {}
 };
 
-// LSM6DSOX 6-axis IMU with ML core (Accelerometer + Gyroscope)
+/**
+ * LSM6DSOX 6-axis IMU with ML core (Accelerometer + Gyroscope)
+ *
+ * Samples are batched in the sensor FIFO (continuous mode) together with
+ * a timestamp word every 32 batches and the temperature at 1.6 Hz.
+ * pollFifo() drains it in bursts of whole tagged words
+ * (POCKETOS_IMU_FIFO_I2C_BUFFER bytes per transaction) into the
+ * device's ImuSampleRing, each sample timestamped from the sensor's
+ * 25 µs counter. readData() polls and reports the newest sample.
+ *
+ * With an interrupt pin (INT1 = FIFO watermark) the FIFO status is only
+ * read once the pin is high; without one it is read every poll and the
+ * FIFO is drained once the watermark is reached (0 = every poll).
+ */
 class LSM6DSOXDriver {
 public:
     LSM6DSOXDriver();
-    
+
     // Driver lifecycle
     bool init(uint8_t i2cAddress);
     void deinit();
     bool isInitialized() const { return initialized; }
-    
+
     // Read measurements
     LSM6DSOXData readData();
-    
+
+    // FIFO batching: samples added to the ring by this call
+    uint16_t pollFifo();
+    ImuSampleRing& samples() { return ring; }
+    const ImuTimebase& timebase() const { return time; }
+
+    // Raw ring counts to m/s² and rad/s
+    float accelScale() const { return accelMg * 0.001f * 9.81f; }
+    float gyroScale() const { return gyroMdps * 0.001f * 0.017453293f; }
+
     // Get capability schema
     CapabilitySchema getSchema() const;
-    
+
     // Parameter get/set
     String getParameter(const String& name);
     bool setParameter(const String& name, const String& value);
-    
+
     // Device info
     uint8_t getAddress() const { return address; }
     String getDriverId() const { return "lsm6dsox"; }
     String getDriverTier() const { return POCKETOS_LSM6DSOX_TIER_NAME; }
-    
+
     // Address enumeration (all tiers)
     static const uint8_t* validAddresses(size_t& count) {
         count = LSM6DSOX_ADDR_COUNT;
         return LSM6DSOX_VALID_ADDRESSES;
     }
-    
+
     static bool supportsAddress(uint8_t addr) {
         for (size_t i = 0; i < LSM6DSOX_ADDR_COUNT; i++) {
             if (LSM6DSOX_VALID_ADDRESSES[i] == addr) {
@@ -66,7 +91,7 @@ public:
         }
         return false;
     }
-    
+
 #if POCKETOS_LSM6DSOX_ENABLE_REGISTER_ACCESS
     // Tier 2: Complete register access
     const RegisterDesc* registers(size_t& count) const;
@@ -74,19 +99,38 @@ public:
     bool regWrite(uint16_t reg, const uint8_t* buf, size_t len);
     const RegisterDesc* findRegisterByName(const String& name) const;
 #endif
-    
+
 #if POCKETOS_LSM6DSOX_ENABLE_CONFIGURATION
     // Tier 1: Configuration
     bool setAccelRange(uint8_t range);
     bool setGyroRange(uint8_t range);
+    bool setOdr(uint16_t hz);               // 12.5 Hz - 6.66 kHz, rounded up
+    bool setBatching(bool accel, bool gyro);
+    bool setWatermark(uint16_t samples);
+    void setInterruptPin(int8_t pin);       // -1 = poll the FIFO status
 #endif
-    
+
 private:
     uint8_t address;
     bool initialized;
-    float accelScale;
-    float gyroScale;
-    
+    float accelMg;          // mg/LSB
+    float gyroMdps;         // mdps/LSB
+
+    uint8_t odrCode;
+    bool batchAccel;
+    bool batchGyro;
+    uint16_t watermark;     // Samples
+    int8_t intPin;
+
+    ImuSampleRing ring;
+    ImuTimebase time;
+    ImuTaggedFifo decoder;
+    uint32_t fifoOverruns;
+    uint32_t busBytes;
+
+    bool configureFifo();
+    uint16_t watermarkWords() const;
+
     // I2C communication
     bool writeRegister(uint8_t reg, uint8_t value);
     bool readRegister(uint8_t reg, uint8_t* value);
@@ -12,26 +12,82 @@ namespace PocketOS {
 #define MAX30101_REG_INT_STATUS     0x00
 #define MAX30101_REG_INT_ENABLE     0x02
 #define MAX30101_REG_FIFO_WR_PTR    0x04
+#define MAX30101_REG_OVF_COUNTER    0x05
 #define MAX30101_REG_FIFO_RD_PTR    0x06
 #define MAX30101_REG_FIFO_DATA      0x07
+#define MAX30101_REG_FIFO_CONFIG    0x08
 #define MAX30101_REG_MODE_CONFIG    0x09
 #define MAX30101_REG_SPO2_CONFIG    0x0A
 #define MAX30101_REG_LED1_PA        0x0C
 #define MAX30101_REG_LED2_PA        0x0D
 #define MAX30101_REG_LED3_PA        0x0E
+#define MAX30101_REG_MULTI_LED1     0x11
+#define MAX30101_REG_MULTI_LED2     0x12
 #define MAX30101_REG_PART_ID        0xFF
 
 #define MAX30101_PART_ID            0x15
 
-MAX30101Driver::MAX30101Driver() : address(0), initialized(false) {}
+// MODE_CONFIG
+#define MAX30101_MODE_SHDN          0x80
+#define MAX30101_MODE_RESET         0x40
+#define MAX30101_MODE_SPO2          0x03    // Red + IR
+#define MAX30101_MODE_MULTI_LED     0x07    // Slots 1-4
+
+// FIFO_CONFIG: no sample averaging, rollover, almost-full at 17 samples
+#define MAX30101_FIFO_CONFIG_VALUE  0x1F
+
+// SPO2_CONFIG: ADC range 4096 nA; LED pulse width 411 µs (18-bit) or 215 µs (17-bit)
+#define MAX30101_ADC_RGE_4096       0x20
+#define MAX30101_LED_PW_411         0x03
+#define MAX30101_LED_PW_215         0x02
+
+// Default LED amplitude: 7.2 mA (0.2 mA/LSB)
+#define MAX30101_DEFAULT_PA         0x24
+
+#define MAX30101_SAMPLE_MASK        0x3FFFF
+
+// SPO2_CONFIG SR codes 0-4
+static const uint16_t MAX30101_RATES[] = { 50, 100, 200, 400, 800 };
+#define MAX30101_RATE_COUNT (sizeof(MAX30101_RATES) / sizeof(MAX30101_RATES[0]))
+
+#if POCKETOS_MAX30101_ENABLE_REGISTER_ACCESS
+static const RegisterDesc MAX30101_REGISTERS[] = {
+    RegisterDesc(0x00, "INT_STATUS_1", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x01, "INT_STATUS_2", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x02, "INT_ENABLE_1", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x03, "INT_ENABLE_2", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x04, "FIFO_WR_PTR", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x05, "OVF_COUNTER", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x06, "FIFO_RD_PTR", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x07, "FIFO_DATA", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x08, "FIFO_CONFIG", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x09, "MODE_CONFIG", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x0A, "SPO2_CONFIG", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x0C, "LED1_PA", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x0D, "LED2_PA", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x0E, "LED3_PA", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x11, "MULTI_LED_CTRL1", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x12, "MULTI_LED_CTRL2", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0xFF, "PART_ID", 1, RegisterAccess::RO, 0x15),
+};
+
+#define MAX30101_REGISTER_COUNT (sizeof(MAX30101_REGISTERS) / sizeof(RegisterDesc))
+#endif
+
+MAX30101Driver::MAX30101Driver()
+    : address(0), initialized(false), rateHz(POCKETOS_MAX30101_DEFAULT_RATE_HZ), leds(2),
+      haveLatest(false), samples(0), fifoOverflows(0), busBytes(0) {
+    current[0] = current[1] = current[2] = MAX30101_DEFAULT_PA;
+    latest[0] = latest[1] = latest[2] = 0;
+}
 
 bool MAX30101Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
-    
+
 #if POCKETOS_MAX30101_ENABLE_LOGGING
-    Logger::info("MAX30101: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("MAX30101: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
-    
+
     uint8_t partId = 0;
     if (!readRegister(MAX30101_REG_PART_ID, &partId)) {
 #if POCKETOS_MAX30101_ENABLE_LOGGING
@@ -39,117 +95,316 @@ bool MAX30101Driver::init(uint8_t i2cAddress) {
 #endif
         return false;
     }
-    
+
     if (partId != MAX30101_PART_ID) {
 #if POCKETOS_MAX30101_ENABLE_LOGGING
-        Logger::error("MAX30101: Invalid part ID: 0x" + String(partId, HEX));
+        Logger::error(("MAX30101: Invalid part ID: 0x" + String(partId, HEX)).c_str());
 #endif
         return false;
     }
-    
-    writeRegister(MAX30101_REG_MODE_CONFIG, 0x40);
-    delay(50);
-    
-#if POCKETOS_MAX30101_ENABLE_CONFIGURATION
-    writeRegister(MAX30101_REG_SPO2_CONFIG, 0x27);
-    writeRegister(MAX30101_REG_LED1_PA, 0x24);
-    writeRegister(MAX30101_REG_LED2_PA, 0x24);
-    writeRegister(MAX30101_REG_LED3_PA, 0x24);
+
+    // Soft reset; the bit clears itself when done
+    writeRegister(MAX30101_REG_MODE_CONFIG, MAX30101_MODE_RESET);
+    uint8_t mode = MAX30101_MODE_RESET;
+    for (uint8_t tries = 0; tries < 10 && (mode & MAX30101_MODE_RESET); tries++) {
+        delay(1);
+        readRegister(MAX30101_REG_MODE_CONFIG, &mode);
+    }
+
+    samples = 0;
+    fifoOverflows = 0;
+    busBytes = 0;
+    haveLatest = false;
+
+    if (!configure()) {
+#if POCKETOS_MAX30101_ENABLE_LOGGING
+        Logger::error("MAX30101: Failed to configure FIFO");
 #endif
-    
-    writeRegister(MAX30101_REG_MODE_CONFIG, 0x07);
-    
+        return false;
+    }
+
     initialized = true;
 #if POCKETOS_MAX30101_ENABLE_LOGGING
-    Logger::info("MAX30101: Initialized successfully");
+    Logger::info(("MAX30101: Initialized successfully (" + String(rateHz) + " Hz, " +
+                  String(leds) + " LEDs)").c_str());
 #endif
     return true;
 }
 
 void MAX30101Driver::deinit() {
     if (initialized) {
-        writeRegister(MAX30101_REG_MODE_CONFIG, 0x80);
+        writeRegister(MAX30101_REG_MODE_CONFIG, MAX30101_MODE_SHDN);
     }
     initialized = false;
 }
 
+bool MAX30101Driver::configure() {
+    uint8_t code = 0;
+    while (code < MAX30101_RATE_COUNT - 1 && MAX30101_RATES[code] < rateHz) {
+        code++;
+    }
+    rateHz = MAX30101_RATES[code];
+
+    // 411 µs pulses fit up to 400 Hz with two LEDs, 200 Hz with three
+    uint8_t pw = (uint32_t)rateHz * leds <= 800 ? MAX30101_LED_PW_411 : MAX30101_LED_PW_215;
+
+    // Shut down while reconfiguring, and restart the FIFO empty
+    bool ok = writeRegister(MAX30101_REG_MODE_CONFIG, MAX30101_MODE_SHDN);
+    ok &= writeRegister(MAX30101_REG_FIFO_CONFIG, MAX30101_FIFO_CONFIG_VALUE);
+    ok &= writeRegister(MAX30101_REG_SPO2_CONFIG, (uint8_t)(MAX30101_ADC_RGE_4096 | (code << 2) | pw));
+    ok &= writeRegister(MAX30101_REG_LED1_PA, current[0]);
+    ok &= writeRegister(MAX30101_REG_LED2_PA, current[1]);
+    ok &= writeRegister(MAX30101_REG_LED3_PA, leds == 3 ? current[2] : 0);
+    ok &= writeRegister(MAX30101_REG_MULTI_LED1, 0x21);     // Slot 1 red, slot 2 IR
+    ok &= writeRegister(MAX30101_REG_MULTI_LED2, leds == 3 ? 0x03 : 0x00);  // Slot 3 green
+    ok &= writeRegister(MAX30101_REG_FIFO_WR_PTR, 0);
+    ok &= writeRegister(MAX30101_REG_OVF_COUNTER, 0);
+    ok &= writeRegister(MAX30101_REG_FIFO_RD_PTR, 0);
+    ok &= writeRegister(MAX30101_REG_MODE_CONFIG, leds == 3 ? MAX30101_MODE_MULTI_LED : MAX30101_MODE_SPO2);
+    if (!ok) {
+        return false;
+    }
+
+    ppg.begin(rateHz);
+    return true;
+}
+
+uint8_t MAX30101Driver::readFifo(uint32_t* redOut, uint32_t* irOut, uint32_t* greenOut, uint8_t max) {
+    if (!initialized || max == 0) {
+        return 0;
+    }
+
+    // FIFO_WR_PTR, OVF_COUNTER, FIFO_RD_PTR in one transaction
+    uint8_t ptr[3];
+    if (!readRegisters(MAX30101_REG_FIFO_WR_PTR, ptr, 3)) {
+        return 0;
+    }
+    busBytes += 3;
+
+    uint8_t pending = (uint8_t)((ptr[0] - ptr[2]) & (MAX30101_FIFO_DEPTH - 1));
+    if (ptr[1] != 0) {
+        // Rolled over: the FIFO is full and the oldest samples were lost
+        fifoOverflows += ptr[1];
+        pending = MAX30101_FIFO_DEPTH;
+    }
+    if (pending > max) {
+        pending = max;
+    }
+
+    // FIFO_DATA does not auto-increment: every byte read pops the FIFO,
+    // so a burst is any number of whole samples (3 bytes per LED)
+    const uint8_t sampleBytes = (uint8_t)(3 * leds);
+    const uint8_t perBurst = (uint8_t)(POCKETOS_MAX30101_I2C_BUFFER / sampleBytes);
+    uint8_t burst[POCKETOS_MAX30101_I2C_BUFFER];
+
+    uint8_t done = 0;
+    while (done < pending) {
+        uint8_t n = (uint8_t)(pending - done);
+        if (n > perBurst) {
+            n = perBurst;
+        }
+        if (!readRegisters(MAX30101_REG_FIFO_DATA, burst, (size_t)n * sampleBytes)) {
+            break;
+        }
+        busBytes += (uint32_t)n * sampleBytes;
+
+        const uint8_t* p = burst;
+        for (uint8_t i = 0; i < n; i++, done++) {
+            redOut[done] = (((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2]) & MAX30101_SAMPLE_MASK;
+            irOut[done] = (((uint32_t)p[3] << 16) | ((uint32_t)p[4] << 8) | p[5]) & MAX30101_SAMPLE_MASK;
+            if (leds == 3) {
+                if (greenOut) {
+                    greenOut[done] = (((uint32_t)p[6] << 16) | ((uint32_t)p[7] << 8) | p[8]) & MAX30101_SAMPLE_MASK;
+                }
+            } else if (greenOut) {
+                greenOut[done] = 0;
+            }
+            p += sampleBytes;
+        }
+    }
+
+    samples += done;
+    return done;
+}
+
+uint8_t MAX30101Driver::pollFifo() {
+    uint8_t n = readFifo(red, ir, green, MAX30101_FIFO_DEPTH);
+    if (n == 0) {
+        return 0;
+    }
+
+    ppg.process(red, ir, n);
+    latest[0] = red[n - 1];
+    latest[1] = ir[n - 1];
+    latest[2] = green[n - 1];
+    haveLatest = true;
+    return n;
+}
+
 MAX30101Data MAX30101Driver::readData() {
     MAX30101Data data;
-    
+
     if (!initialized) {
         return data;
     }
-    
-    uint8_t wrPtr = 0, rdPtr = 0;
-    if (!readRegister(MAX30101_REG_FIFO_WR_PTR, &wrPtr)) {
-        return data;
-    }
-    if (!readRegister(MAX30101_REG_FIFO_RD_PTR, &rdPtr)) {
+
+    data.batch = pollFifo();
+    if (!haveLatest) {
         return data;
     }
-    
-    int8_t numSamples = wrPtr - rdPtr;
-    if (numSamples < 0) numSamples += 32;
-    
-    if (numSamples > 0) {
-        data.red = readFIFO();
-        data.ir = readFIFO();
-        data.green = readFIFO();
-        data.valid = true;
-    }
-    
-    return data;
-}
 
-uint32_t MAX30101Driver::readFIFO() {
-    uint32_t value = 0;
-    Wire.beginTransmission(address);
-    Wire.write(MAX30101_REG_FIFO_DATA);
-    Wire.endTransmission(false);
-    
-    Wire.requestFrom(address, (uint8_t)3);
-    if (Wire.available() >= 3) {
-        value = Wire.read();
-        value = (value << 8) | Wire.read();
-        value = (value << 8) | Wire.read();
-        value &= 0x3FFFF;
-    }
-    
-    return value;
+    data.red = latest[0];
+    data.ir = latest[1];
+    data.green = latest[2];
+    data.heart_rate = ppg.heartRate();
+    data.spo2 = ppg.spo2();
+    data.perfusion = ppg.perfusion();
+    data.finger = ppg.fingerPresent();
+    data.valid = true;
+    return data;
 }
 
 CapabilitySchema MAX30101Driver::getSchema() const {
     CapabilitySchema schema;
-    schema.driverId = "max30101";
-    schema.tier = POCKETOS_MAX30101_TIER_NAME;
-    
-    schema.outputs.push_back(OutputDesc("red", "Red LED PPG", "18-bit", "0-262143"));
-    schema.outputs.push_back(OutputDesc("ir", "Infrared LED PPG", "18-bit", "0-262143"));
-    schema.outputs.push_back(OutputDesc("green", "Green LED PPG", "18-bit", "0-262143"));
-    
+
+    // Output signals
+    schema.addSignal("red", ParamType::INT, false, "counts");
+    schema.addSignal("ir", ParamType::INT, false, "counts");
+    schema.addSignal("green", ParamType::INT, false, "counts");
+    schema.addSignal("heart_rate", ParamType::FLOAT, false, "bpm");
+    schema.addSignal("spo2", ParamType::FLOAT, false, "%");
+    schema.addSignal("perfusion", ParamType::FLOAT, false, "%");
+    schema.addSignal("finger", ParamType::BOOL, false, "");
+    schema.addSignal("beats", ParamType::COUNTER, false, "");
+    schema.addSignal("samples", ParamType::COUNTER, false, "");
+    schema.addSignal("fifo_overflows", ParamType::COUNTER, false, "");
+
+#if POCKETOS_MAX30101_ENABLE_CONFIGURATION
+    schema.addSetting("sample_rate", ParamType::INT, true, 50, 800, 0, "Hz");
+    schema.addSetting("leds", ParamType::INT, true, 2, 3, 1, "");
+    schema.addSetting("red_current", ParamType::FLOAT, true, 0, 51, 0.2f, "mA");
+    schema.addSetting("ir_current", ParamType::FLOAT, true, 0, 51, 0.2f, "mA");
+    schema.addSetting("green_current", ParamType::FLOAT, true, 0, 51, 0.2f, "mA");
+#endif
+
     return schema;
 }
 
 String MAX30101Driver::getParameter(const String& name) {
+    if (name == "red") {
+        return String(latest[0]);
+    } else if (name == "ir") {
+        return String(latest[1]);
+    } else if (name == "green") {
+        return String(latest[2]);
+    } else if (name == "heart_rate") {
+        return String(ppg.heartRate(), 1);
+    } else if (name == "spo2") {
+        return String(ppg.spo2(), 1);
+    } else if (name == "perfusion") {
+        return String(ppg.perfusion(), 2);
+    } else if (name == "finger") {
+        return ppg.fingerPresent() ? "true" : "false";
+    } else if (name == "beats") {
+        return String(ppg.beats());
+    } else if (name == "samples") {
+        return String(samples);
+    } else if (name == "fifo_overflows") {
+        return String(fifoOverflows);
+    } else if (name == "bus_bytes") {
+        return String(busBytes);
+    }
+#if POCKETOS_MAX30101_ENABLE_CONFIGURATION
+    if (name == "sample_rate") {
+        return String(rateHz);
+    } else if (name == "leds") {
+        return String(leds);
+    } else if (name == "red_current") {
+        return String(current[0] * 0.2f, 1);
+    } else if (name == "ir_current") {
+        return String(current[1] * 0.2f, 1);
+    } else if (name == "green_current") {
+        return String(current[2] * 0.2f, 1);
+    }
+#endif
     return "";
 }
 
 bool MAX30101Driver::setParameter(const String& name, const String& value) {
+#if POCKETOS_MAX30101_ENABLE_CONFIGURATION
+    if (name == "sample_rate") {
+        long hz = value.toInt();
+        return hz > 0 && hz <= 800 && setSampleRate((uint16_t)hz);
+    } else if (name == "leds") {
+        return setLedCount((uint8_t)value.toInt());
+    } else if (name == "red_current") {
+        return setLedCurrent(0, value.toFloat());
+    } else if (name == "ir_current") {
+        return setLedCurrent(1, value.toFloat());
+    } else if (name == "green_current") {
+        return setLedCurrent(2, value.toFloat());
+    }
+#endif
+    return false;
+}
+
+#if POCKETOS_MAX30101_ENABLE_CONFIGURATION
+bool MAX30101Driver::setSampleRate(uint16_t hz) {
+    if (!initialized) return false;
+
+    for (uint8_t code = 0; code < MAX30101_RATE_COUNT; code++) {
+        if (MAX30101_RATES[code] == hz) {
+            // 800 Hz needs 215 µs pulses; three LEDs do not fit
+            if ((uint32_t)hz * leds > 1600) {
+                return false;
+            }
+            rateHz = hz;
+            return configure();
+        }
+    }
     return false;
 }
 
+bool MAX30101Driver::setLedCount(uint8_t count) {
+    if (!initialized || count < 2 || count > 3) return false;
+    if ((uint32_t)rateHz * count > 1600) return false;
+
+    leds = count;
+    return configure();
+}
+
+bool MAX30101Driver::setLedCurrent(uint8_t led, float mA) {
+    if (!initialized || led > 2 || mA < 0 || mA > 51.0f) return false;
+
+    current[led] = (uint8_t)(mA / 0.2f + 0.5f);
+    if (led == 2 && leds < 3) {
+        return true;        // Applied when green is enabled
+    }
+    // Amplitude changes the DC level: restart the pipeline's tracking
+    ppg.reset();
+    return writeRegister(MAX30101_REG_LED1_PA + led, current[led]);
+}
+#endif
+
 bool MAX30101Driver::readRegister(uint8_t reg, uint8_t* value) {
+    return readRegisters(reg, value, 1);
+}
+
+bool MAX30101Driver::readRegisters(uint8_t reg, uint8_t* buffer, size_t len) {
     Wire.beginTransmission(address);
     Wire.write(reg);
-    if (Wire.endTransmission() != 0) {
+    if (Wire.endTransmission(false) != 0) {
         return false;
     }
-    
-    if (Wire.requestFrom(address, (uint8_t)1) != 1) {
+
+    if (Wire.requestFrom(address, (uint8_t)len) != len) {
         return false;
     }
-    
-    *value = Wire.read();
+
+    for (size_t i = 0; i < len; i++) {
+        buffer[i] = Wire.read();
+    }
+
     return true;
 }
 
@@ -161,33 +416,13 @@ bool MAX30101Driver::writeRegister(uint8_t reg, uint8_t value) {
 }
 
 #if POCKETOS_MAX30101_ENABLE_REGISTER_ACCESS
-static const RegisterDesc MAX30101_REGISTERS[] = {
-    RegisterDesc(0x00, "INT_STATUS_1", 1, RegisterAccess::RO, 0x00),
-    RegisterDesc(0x01, "INT_STATUS_2", 1, RegisterAccess::RO, 0x00),
-    RegisterDesc(0x02, "INT_ENABLE_1", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x03, "INT_ENABLE_2", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x04, "FIFO_WR_PTR", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x05, "OVF_COUNTER", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x06, "FIFO_RD_PTR", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x07, "FIFO_DATA", 1, RegisterAccess::RO, 0x00),
-    RegisterDesc(0x08, "FIFO_CONFIG", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x09, "MODE_CONFIG", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x0A, "SPO2_CONFIG", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x0C, "LED1_PA", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x0D, "LED2_PA", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x0E, "LED3_PA", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0xFF, "PART_ID", 1, RegisterAccess::RO, 0x15),
-};
-
-#define MAX30101_REGISTER_COUNT (sizeof(MAX30101_REGISTERS) / sizeof(RegisterDesc))
-
 const RegisterDesc* MAX30101Driver::registers(size_t& count) const {
     count = MAX30101_REGISTER_COUNT;
     return MAX30101_REGISTERS;
 }
 
 bool MAX30101Driver::regRead(uint16_t reg, uint8_t* buf, size_t len) {
-    if (!initialized || reg > 0xFF) {
+    if (!initialized || reg > 0xFF || len != 1) {
         return false;
     }
     return readRegister((uint8_t)reg, buf);
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "ppg_pipeline.h"
 
 #if POCKETOS_MAX30101_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
@@ -11,61 +12,141 @@
 
 namespace PocketOS {
 
+// Sample rate after init() (50-800 Hz)
+// Can be overridden via build flags: -DPOCKETOS_MAX30101_DEFAULT_RATE_HZ=200
+#ifndef POCKETOS_MAX30101_DEFAULT_RATE_HZ
+#define POCKETOS_MAX30101_DEFAULT_RATE_HZ 100
+#endif
+
+// Largest Wire transaction: FIFO bursts are split into whole samples
+#ifndef POCKETOS_MAX30101_I2C_BUFFER
+#define POCKETOS_MAX30101_I2C_BUFFER 128
+#endif
+
+#define MAX30101_FIFO_DEPTH 32
+
 #define MAX30101_ADDR_COUNT 1
 const uint8_t MAX30101_VALID_ADDRESSES[MAX30101_ADDR_COUNT] = { 0x57 };
 
+// MAX30101 measurement data (newest FIFO sample and pipeline output)
 struct MAX30101Data {
-    uint32_t red;
+    uint32_t red;           // 18-bit counts
     uint32_t ir;
-    uint32_t green;
+    uint32_t green;         // 0 unless three LEDs are enabled
+    float heart_rate;       // bpm, 0 = no reading yet
+    float spo2;             // %, 0 = no reading yet
+    float perfusion;        // IR AC/DC, %
+    bool finger;
+    uint8_t batch;          // Samples drained by this read
     bool valid;
-    
-    MAX30101Data() : red(0), ir(0), green(0), valid(false) {}
+
+    MAX30101Data() : red(0), ir(0), green(0), heart_rate(0), spo2(0), perfusion(0),
+                     finger(false), batch(0), valid(false) {}
 };
 
+/**
+ * MAX30101 pulse oximeter and heart-rate sensor
+ *
+ * The sensor samples red and IR (and optionally green) into its 32-deep
+ * FIFO with rollover. pollFifo() reads the three pointer registers in one
+ * transaction, then drains every pending sample in bursts of whole
+ * samples (POCKETOS_MAX30101_I2C_BUFFER bytes each) and feeds them to a
+ * PpgPipeline for heart rate and SpO2. readData() polls and reports the
+ * newest sample with the pipeline output.
+ *
+ * readFifo() drains into caller-owned buffers instead, for raw logging or
+ * a different pipeline; those samples bypass the built-in one.
+ *
+ * At the default 100 Hz the FIFO holds 320 ms, so the 20 ms registry poll
+ * never loses samples; fifo_overflows counts any that were.
+ */
 class MAX30101Driver {
 public:
     MAX30101Driver();
-    
+
+    // Driver lifecycle
     bool init(uint8_t i2cAddress);
     void deinit();
     bool isInitialized() const { return initialized; }
-    
+
+    // Read measurements
     MAX30101Data readData();
-    
+
+    // Drain the FIFO through the pipeline: samples processed by this call
+    uint8_t pollFifo();
+
+    // Drain up to `max` samples (oldest first) into caller buffers; green
+    // may be null. Returns the number of samples read.
+    uint8_t readFifo(uint32_t* red, uint32_t* ir, uint32_t* green, uint8_t max);
+
+    const PpgPipeline& pipeline() const { return ppg; }
+    uint16_t sampleRate() const { return rateHz; }
+    uint8_t ledCount() const { return leds; }
+
+    // Get capability schema
     CapabilitySchema getSchema() const;
+
+    // Parameter get/set
     String getParameter(const String& name);
     bool setParameter(const String& name, const String& value);
-    
+
+    // Device info
     uint8_t getAddress() const { return address; }
     String getDriverId() const { return "max30101"; }
     String getDriverTier() const { return POCKETOS_MAX30101_TIER_NAME; }
-    
+
+    // Address enumeration (all tiers)
     static const uint8_t* validAddresses(size_t& count) {
         count = MAX30101_ADDR_COUNT;
         return MAX30101_VALID_ADDRESSES;
     }
-    
+
     static bool supportsAddress(uint8_t addr) {
         return addr == 0x57;
     }
-    
+
 #if POCKETOS_MAX30101_ENABLE_REGISTER_ACCESS
+    // Tier 2: Complete register access
     const RegisterDesc* registers(size_t& count) const;
     bool regRead(uint16_t reg, uint8_t* buf, size_t len);
     bool regWrite(uint16_t reg, const uint8_t* buf, size_t len);
     const RegisterDesc* findRegisterByName(const String& name) const;
 #endif
-    
+
+#if POCKETOS_MAX30101_ENABLE_CONFIGURATION
+    // Tier 1: Configuration
+    bool setSampleRate(uint16_t hz);        // 50, 100, 200, 400, 800
+    bool setLedCount(uint8_t count);        // 2 = red + IR, 3 = + green
+    bool setLedCurrent(uint8_t led, float mA);  // 0 red, 1 IR, 2 green; 0-51 mA
+#endif
+
 private:
     uint8_t address;
     bool initialized;
-    
-    bool readRegister(uint8_t reg, uint8_t* value);
+
+    uint16_t rateHz;
+    uint8_t leds;
+    uint8_t current[3];     // LED pulse amplitude, 0.2 mA/LSB
+
+    PpgPipeline ppg;
+    uint32_t red[MAX30101_FIFO_DEPTH];
+    uint32_t ir[MAX30101_FIFO_DEPTH];
+    uint32_t green[MAX30101_FIFO_DEPTH];
+    uint32_t latest[3];     // Newest red, IR, green
+    bool haveLatest;
+
+    uint32_t samples;
+    uint32_t fifoOverflows;
+    uint32_t busBytes;
+
+    bool configure();
+
+    // I2C communication
     bool writeRegister(uint8_t reg, uint8_t value);
-    uint32_t readFIFO();
+    bool readRegister(uint8_t reg, uint8_t* value);
+    bool readRegisters(uint8_t reg, uint8_t* buffer, size_t len);
 };
 
 } // namespace PocketOS
 
-#endif
+#endif // POCKETOS_MAX30101_DRIVER_H
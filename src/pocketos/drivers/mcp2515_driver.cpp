@@ -1,5 +1,6 @@
 #include "mcp2515_driver.h"
 #include "../core/logger.h"
+#include "../core/system_clock.h"
 #include <SPI.h>
 
 namespace PocketOS {
@@ -10,6 +11,21 @@ namespace PocketOS {
 #define MCP2515_CMD_WRITE       0x02
 #define MCP2515_CMD_READ_STATUS 0xA0
 #define MCP2515_CMD_BIT_MODIFY  0x05
+#define MCP2515_CMD_READ_RX     0x90    // | (n << 2): READ RX BUFFER n from SIDH
+
+// Registers and bits used outside the register map
+#define MCP2515_REG_CANSTAT     0x0E
+#define MCP2515_REG_CANCTRL     0x0F
+#define MCP2515_REG_CANINTE     0x2B
+#define MCP2515_REG_CANINTF     0x2C
+#define MCP2515_REG_EFLG        0x2D
+#define MCP2515_REG_RXB0CTRL    0x60
+#define MCP2515_INT_RX0IF       0x01
+#define MCP2515_INT_RX1IF       0x02
+#define MCP2515_INT_ERRIF       0x20
+#define MCP2515_EFLG_RX0OVR     0x40
+#define MCP2515_EFLG_RX1OVR     0x80
+#define MCP2515_MODE_TIMEOUT_MS 20
 
 // MCP2515 Modes
 #define MCP2515_MODE_NORMAL     0x00
@@ -169,9 +185,22 @@ static const RegisterDesc MCP2515_REGISTERS[] = {
 #define MCP2515_REGISTER_COUNT (sizeof(MCP2515_REGISTERS) / sizeof(RegisterDesc))
 #endif
 
+static_assert((MCP2515_RX_RING_SIZE & (MCP2515_RX_RING_SIZE - 1)) == 0, "MCP2515_RX_RING_SIZE must be a power of two");
+static_assert(MCP2515_RX_RING_SIZE <= 32768, "MCP2515_RX_RING_SIZE too large");
+
+static const char* const MCP2515_MODE_NAMES[] = { "normal", "sleep", "loopback", "listen", "config" };
+
 MCP2515Driver::MCP2515Driver() 
-    : initialized_(false), oscillator_mhz_(16) {
+    : initialized_(false), oscillator_mhz_(16), bitrate_(0), stats_() {
     setRegisterConvention(SPIRegisterConvention::MCP2515);
+#if POCKETOS_MCP2515_ENABLE_BASIC_READ
+    rxHead_ = 0;
+    rxTail_ = 0;
+#endif
+#if POCKETOS_MCP2515_ENABLE_ERROR_HANDLING
+    memset(filters_, 0, sizeof(filters_));
+    memset(masks_, 0, sizeof(masks_));
+#endif
 }
 
 MCP2515Driver::~MCP2515Driver() {
@@ -192,19 +221,32 @@ bool MCP2515Driver::init(const String& endpoint) {
     
     // Verify communication by reading CANSTAT
     uint8_t canstat;
-    if (!regRead(0x0E, &canstat, 1)) {
+    if (!regRead(MCP2515_REG_CANSTAT, &canstat, 1)) {
         deinit();
         return false;
     }
     
     // Should be in config mode after reset (0x80)
     if ((canstat & 0xE0) != 0x80) {
-        Logger::error("MCP2515: Failed to verify device (CANSTAT=" + String(canstat, HEX) + ")");
+        Logger::error(("MCP2515: Failed to verify device (CANSTAT=" + String(canstat, HEX) + ")").c_str());
         deinit();
         return false;
     }
     
     initialized_ = true;
+    
+    // RXB0 rolls over into RXB1 when full (BUKT)
+    uint8_t rxb0ctrl = 0x04;
+    regWrite(MCP2515_REG_RXB0CTRL, &rxb0ctrl, 1);
+    
+    // INT goes low while any enabled flag is set
+    if (getPinConfig().irq >= 0) {
+        uint8_t inte = MCP2515_INT_RX0IF | MCP2515_INT_RX1IF | MCP2515_INT_ERRIF;
+        if (!regWrite(MCP2515_REG_CANINTE, &inte, 1) || !attachIrq(IrqEdge::FALLING_EDGE, onIrq, this)) {
+            Logger::warning("MCP2515: INT not attached, polling RX flags");
+        }
+    }
+    
     Logger::info("MCP2515: Initialized successfully");
     return true;
 }
@@ -232,7 +274,7 @@ bool MCP2515Driver::identifyProbe(const String& endpoint) {
     
     // Read CANSTAT - should be in config mode (0x80)
     uint8_t canstat;
-    if (!driver.regRead(0x0E, &canstat, 1)) {
+    if (!driver.regRead(MCP2515_REG_CANSTAT, &canstat, 1)) {
         return false;
     }
     
@@ -244,6 +286,109 @@ bool MCP2515Driver::reset() {
     return spiWrite(&cmd, 1);
 }
 
+void MCP2515Driver::update() {
+#if POCKETOS_MCP2515_ENABLE_BASIC_READ
+    if (!initialized_) {
+        return;
+    }
+    // INT is a level: still low here means frames arrived after the edge's
+    // drain without a new edge. Without a pin, check the flags every pass.
+    if (irqLine() < 0 || digitalRead(getPinConfig().irq) == LOW) {
+        drainRx(SystemClock::nowUs());
+    }
+#endif
+}
+
+void MCP2515Driver::onIrq(void* context, const IrqEvent& event) {
+#if POCKETOS_MCP2515_ENABLE_BASIC_READ
+    MCP2515Driver* self = static_cast<MCP2515Driver*>(context);
+    self->stats_.irqEvents++;
+    self->drainRx(SystemClock::toUnixUs(SystemClock::monoFromMicros(event.timestampUs)));
+#endif
+}
+
+CapabilitySchema MCP2515Driver::getSchema() const {
+    CapabilitySchema schema;
+    schema.addSetting("mode", ParamType::ENUM, true);
+    schema.addSetting("bitrate", ParamType::INT, true, 125000, 1000000, 0, "bit/s");
+#if POCKETOS_MCP2515_ENABLE_ERROR_HANDLING
+    schema.addSetting("filter<0-5>", ParamType::STRING, true);
+    schema.addSetting("mask<0-1>", ParamType::STRING, true);
+#endif
+    schema.addSignal("rx_frames", ParamType::COUNTER, false);
+    schema.addSignal("rx_overflows", ParamType::COUNTER, false);
+    schema.addSignal("ring_drops", ParamType::COUNTER, false);
+    schema.addCommand("can.dump", "<max> [text|bin]");
+    return schema;
+}
+
+String MCP2515Driver::getParameter(const String& name) {
+    if (name == "mode") {
+        uint8_t mode = currentMode();
+        return mode <= MCP2515_MODE_CONFIG ? String(MCP2515_MODE_NAMES[mode >> 5]) : String("");
+    } else if (name == "bitrate") {
+        return String(bitrate_);
+    } else if (name == "rx_frames") {
+        return String(stats_.rxFrames);
+    } else if (name == "rx_overflows") {
+        return String(stats_.hwOverflows);
+    } else if (name == "ring_drops") {
+        return String(stats_.ringDrops);
+    } else if (name == "irq_events") {
+        return String(stats_.irqEvents);
+#if POCKETOS_MCP2515_ENABLE_BASIC_READ
+    } else if (name == "ring_count") {
+        return String(framesQueued());
+    } else if (name == "ring_high_water") {
+        return String(stats_.ringHighWater);
+#endif
+    }
+#if POCKETOS_MCP2515_ENABLE_ERROR_HANDLING
+    if (name.startsWith("filter") && name.length() == 7) {
+        uint8_t n = (uint8_t)(name.charAt(6) - '0');
+        return n < 6 ? String(filters_[n] & CAN_EFF_MASK, HEX) : String("");
+    } else if (name.startsWith("mask") && name.length() == 5) {
+        uint8_t n = (uint8_t)(name.charAt(4) - '0');
+        return n < 2 ? String(masks_[n] & CAN_EFF_MASK, HEX) : String("");
+    } else if (name == "tec") {
+        return String(getTxErrors());
+    } else if (name == "rec") {
+        return String(getRxErrors());
+    } else if (name == "eflg") {
+        return "0x" + String(getErrorFlags(), HEX);
+    }
+#endif
+    return "";
+}
+
+bool MCP2515Driver::setParameter(const String& name, const String& value) {
+#if POCKETOS_MCP2515_ENABLE_BASIC_READ
+    if (name == "mode") {
+        for (uint8_t i = 0; i < sizeof(MCP2515_MODE_NAMES) / sizeof(MCP2515_MODE_NAMES[0]); i++) {
+            if (value == MCP2515_MODE_NAMES[i]) {
+                return setMode((uint8_t)(i << 5));
+            }
+        }
+        return false;
+    }
+    if (name == "bitrate") {
+        // Bit timing is writable in config mode only
+        uint8_t prev = currentMode();
+        if (prev > MCP2515_MODE_CONFIG || !setMode(MCP2515_MODE_CONFIG)) {
+            return false;
+        }
+        bool ok = setBitrate((uint32_t)value.toInt(), oscillator_mhz_);
+        return setMode(prev) && ok;
+    }
+#endif
+#if POCKETOS_MCP2515_ENABLE_ERROR_HANDLING
+    if (name.startsWith("filter") || name.startsWith("mask")) {
+        return setFilterParam(name, value);
+    }
+#endif
+    return false;
+}
+
 #if POCKETOS_MCP2515_ENABLE_BASIC_READ
 bool MCP2515Driver::sendFrame(uint32_t id, const uint8_t* data, uint8_t len, bool extended) {
     if (!initialized_ || len > 8) {
@@ -288,44 +433,140 @@ bool MCP2515Driver::receiveFrame(uint32_t& id, uint8_t* data, uint8_t& len, bool
         return false;
     }
     
-    // Check if RX buffer 0 has data
-    uint8_t status;
-    if (!readStatus(status)) {
-        return false;
+    if (framesQueued() == 0) {
+        drainRx(SystemClock::nowUs());
     }
-    
-    if ((status & 0x01) == 0) {
+    CanFrame frame;
+    if (!popFrame(frame)) {
         return false;  // No message
     }
     
-    // Read RX buffer 0
-    uint8_t rxbuf[13];
-    if (!regRead(0x61, rxbuf, 13)) {
-        return false;
+    extended = (frame.id & CAN_EFF_FLAG) != 0;
+    id = frame.id & CAN_EFF_MASK;
+    len = frame.dlc;
+    memcpy(data, frame.data, len);
+    return true;
+}
+
+uint16_t MCP2515Driver::drainRx(uint64_t timestampUs) {
+    if (!initialized_) {
+        return 0;
     }
     
-    // Parse ID
-    extended = (rxbuf[1] & 0x08) != 0;
-    if (extended) {
-        id = ((uint32_t)rxbuf[0] << 21) | ((uint32_t)(rxbuf[1] & 0xE0) << 13) |
-             ((uint32_t)(rxbuf[1] & 0x03) << 16) | ((uint32_t)rxbuf[2] << 8) | rxbuf[3];
-    } else {
-        id = ((uint32_t)rxbuf[0] << 3) | (rxbuf[1] >> 5);
+    uint16_t added = 0;
+    // Bounded: on a busy bus a buffer refills while the other is read
+    for (uint8_t round = 0; round < 4; round++) {
+        uint8_t intf;
+        if (!regRead(MCP2515_REG_CANINTF, &intf, 1)) {
+            break;
+        }
+        
+        if (intf & MCP2515_INT_ERRIF) {
+            uint8_t eflg;
+            if (regRead(MCP2515_REG_EFLG, &eflg, 1) && (eflg & (MCP2515_EFLG_RX0OVR | MCP2515_EFLG_RX1OVR))) {
+                stats_.hwOverflows += ((eflg & MCP2515_EFLG_RX0OVR) ? 1 : 0) + ((eflg & MCP2515_EFLG_RX1OVR) ? 1 : 0);
+                modifyRegister(MCP2515_REG_EFLG, MCP2515_EFLG_RX0OVR | MCP2515_EFLG_RX1OVR, 0x00);
+            }
+            modifyRegister(MCP2515_REG_CANINTF, MCP2515_INT_ERRIF, 0x00);
+        }
+        
+        if ((intf & (MCP2515_INT_RX0IF | MCP2515_INT_RX1IF)) == 0) {
+            break;
+        }
+        // RXB0 first: with rollover it holds the older frame
+        if ((intf & MCP2515_INT_RX0IF) && readRxBuffer(0, timestampUs)) {
+            added++;
+        }
+        if ((intf & MCP2515_INT_RX1IF) && readRxBuffer(1, timestampUs)) {
+            added++;
+        }
+    }
+    return added;
+}
+
+bool MCP2515Driver::readRxBuffer(uint8_t n, uint64_t timestampUs) {
+    // SIDH..D7 in one transaction; raising CS clears RXnIF
+    uint8_t cmd = (uint8_t)(MCP2515_CMD_READ_RX | (n << 2));
+    uint8_t rx[13];
+    if (!spiWriteRead(&cmd, 1, rx, sizeof(rx))) {
+        return false;
     }
+    stats_.rxFrames++;
     
-    // Parse length
-    len = rxbuf[4] & 0x0F;
-    if (len > 8) {
-        len = 8;
+    if (framesQueued() >= MCP2515_RX_RING_SIZE) {
+        stats_.ringDrops++;
+        return false;
     }
     
-    // Copy data
-    for (uint8_t i = 0; i < len; i++) {
-        data[i] = rxbuf[5 + i];
+    CanFrame& frame = rxRing_[rxHead_ & (MCP2515_RX_RING_SIZE - 1)];
+    if (rx[1] & 0x08) {
+        frame.id = ((uint32_t)rx[0] << 21) | ((uint32_t)(rx[1] & 0xE0) << 13) |
+                   ((uint32_t)(rx[1] & 0x03) << 16) | ((uint32_t)rx[2] << 8) | rx[3];
+        frame.id |= CAN_EFF_FLAG;
+        if (rx[4] & 0x40) {
+            frame.id |= CAN_RTR_FLAG;
+        }
+    } else {
+        frame.id = ((uint32_t)rx[0] << 3) | (rx[1] >> 5);
+        if (rx[1] & 0x10) {
+            frame.id |= CAN_RTR_FLAG;
+        }
+    }
+    frame.dlc = rx[4] & 0x0F;
+    if (frame.dlc > 8) {
+        frame.dlc = 8;
     }
+    memset(frame.data, 0, sizeof(frame.data));
+    memcpy(frame.data, rx + 5, frame.dlc);
+    frame.timestampUs = timestampUs;
+    rxHead_++;
     
-    // Clear interrupt flag
-    return modifyRegister(0x2C, 0x01, 0x00);
+    if (framesQueued() > stats_.ringHighWater) {
+        stats_.ringHighWater = framesQueued();
+    }
+    return true;
+}
+
+bool MCP2515Driver::popFrame(CanFrame& frame) {
+    if (rxHead_ == rxTail_) {
+        return false;
+    }
+    frame = rxRing_[rxTail_ & (MCP2515_RX_RING_SIZE - 1)];
+    rxTail_++;
+    return true;
+}
+
+size_t MCP2515Driver::formatCandump(const CanFrame& frame, const char* iface, char* out, size_t len) {
+    if (len < CAN_CANDUMP_LINE_MAX) {
+        return 0;
+    }
+    int n = snprintf(out, len, "(%lu.%06lu) %.8s ", (unsigned long)(frame.timestampUs / 1000000ULL),
+                     (unsigned long)(frame.timestampUs % 1000000ULL), iface);
+    if (frame.id & CAN_EFF_FLAG) {
+        n += snprintf(out + n, len - n, "%08lX#", (unsigned long)(frame.id & CAN_EFF_MASK));
+    } else {
+        n += snprintf(out + n, len - n, "%03lX#", (unsigned long)(frame.id & CAN_SFF_MASK));
+    }
+    if (frame.id & CAN_RTR_FLAG) {
+        n += snprintf(out + n, len - n, "R");
+    } else {
+        for (uint8_t i = 0; i < frame.dlc; i++) {
+            n += snprintf(out + n, len - n, "%02X", frame.data[i]);
+        }
+    }
+    return (size_t)n;
+}
+
+void MCP2515Driver::packFrame(const CanFrame& frame, uint8_t* out) {
+    for (uint8_t i = 0; i < 8; i++) {
+        out[i] = (uint8_t)(frame.timestampUs >> (8 * i));
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        out[8 + i] = (uint8_t)(frame.id >> (8 * i));
+    }
+    out[12] = frame.dlc;
+    out[13] = out[14] = out[15] = 0;
+    memcpy(out + 16, frame.data, 8);
 }
 
 bool MCP2515Driver::setMode(uint8_t mode) {
@@ -333,7 +574,18 @@ bool MCP2515Driver::setMode(uint8_t mode) {
         return false;
     }
     
-    return modifyRegister(0x0F, 0xE0, mode);
+    if (!modifyRegister(MCP2515_REG_CANCTRL, 0xE0, mode)) {
+        return false;
+    }
+    // The change takes effect once the bus is idle
+    unsigned long start = millis();
+    while (currentMode() != mode) {
+        if (millis() - start > MCP2515_MODE_TIMEOUT_MS) {
+            return false;
+        }
+        delay(1);
+    }
+    return true;
 }
 
 bool MCP2515Driver::setBitrate(uint32_t bitrate, uint8_t oscillator_mhz) {
@@ -346,7 +598,9 @@ bool MCP2515Driver::setBitrate(uint32_t bitrate, uint8_t oscillator_mhz) {
     // Simple bitrate calculation for common rates
     uint8_t cnf1, cnf2, cnf3;
     
-    if (oscillator_mhz == 16 && bitrate == 500000) {
+    if (oscillator_mhz == 16 && bitrate == 1000000) {
+        cnf1 = 0x00; cnf2 = 0xD0; cnf3 = 0x82;
+    } else if (oscillator_mhz == 16 && bitrate == 500000) {
         cnf1 = 0x00; cnf2 = 0x90; cnf3 = 0x02;
     } else if (oscillator_mhz == 16 && bitrate == 250000) {
         cnf1 = 0x01; cnf2 = 0x90; cnf3 = 0x02;
@@ -356,9 +610,13 @@ bool MCP2515Driver::setBitrate(uint32_t bitrate, uint8_t oscillator_mhz) {
         return false;  // Unsupported combination
     }
     
-    return regWrite(0x2A, &cnf1, 1) && 
-           regWrite(0x29, &cnf2, 1) && 
-           regWrite(0x28, &cnf3, 1);
+    if (!regWrite(0x2A, &cnf1, 1) || 
+        !regWrite(0x29, &cnf2, 1) || 
+        !regWrite(0x28, &cnf3, 1)) {
+        return false;
+    }
+    bitrate_ = bitrate;
+    return true;
 }
 #endif
 
@@ -369,7 +627,8 @@ bool MCP2515Driver::setFilter(uint8_t filter_num, uint32_t mask, bool extended)
     }
     
     uint8_t regs[4];
-    uint8_t base_addr = 0x00 + (filter_num * 4);
+    // RXF0-2 at 0x00, RXF3-5 at 0x10 (BFPCTRL..CANCTRL sit between)
+    uint8_t base_addr = filter_num < 3 ? filter_num * 4 : 0x10 + (filter_num - 3) * 4;
     
     if (extended) {
         regs[0] = (uint8_t)(mask >> 21);
@@ -383,7 +642,11 @@ bool MCP2515Driver::setFilter(uint8_t filter_num, uint32_t mask, bool extended)
         regs[3] = 0;
     }
     
-    return regWrite(base_addr, regs, 4);
+    if (!regWrite(base_addr, regs, 4)) {
+        return false;
+    }
+    filters_[filter_num] = mask | (extended ? CAN_EFF_FLAG : 0);
+    return true;
 }
 
 bool MCP2515Driver::setMask(uint8_t mask_num, uint32_t mask, bool extended) {
@@ -406,12 +669,45 @@ bool MCP2515Driver::setMask(uint8_t mask_num, uint32_t mask, bool extended) {
         regs[3] = 0;
     }
     
-    return regWrite(base_addr, regs, 4);
+    if (!regWrite(base_addr, regs, 4)) {
+        return false;
+    }
+    masks_[mask_num] = mask | (extended ? CAN_EFF_FLAG : 0);
+    return true;
+}
+
+// filter<0-5> / mask<0-1> = hex identifier; more than 3 digits is a
+// 29-bit (extended) identifier, as in candump. RXB0 uses mask0 and
+// filters 0-1, RXB1 mask1 and filters 2-5.
+bool MCP2515Driver::setFilterParam(const String& name, const String& value) {
+    bool isMask = name.startsWith("mask");
+    String index = name.substring(isMask ? 4 : 6);
+    if (index.length() != 1 || !isdigit((unsigned char)index.charAt(0))) {
+        return false;
+    }
+    uint8_t n = (uint8_t)(index.charAt(0) - '0');
+    String hex = value.startsWith("0x") ? value.substring(2) : value;
+    if (hex.length() == 0 || hex.length() > 8) {
+        return false;
+    }
+    char* end;
+    uint32_t id = (uint32_t)strtoul(hex.c_str(), &end, 16);
+    bool extended = hex.length() > 3;
+    if (*end != '\0' || id > (extended ? CAN_EFF_MASK : CAN_SFF_MASK)) {
+        return false;
+    }
+    
+    uint8_t prev = currentMode();
+    if (prev > MCP2515_MODE_CONFIG || !setMode(MCP2515_MODE_CONFIG)) {
+        return false;
+    }
+    bool ok = isMask ? setMask(n, id, extended) : setFilter(n, id, extended);
+    return setMode(prev) && ok;
 }
 
 uint8_t MCP2515Driver::getErrorFlags() {
     uint8_t eflg;
-    if (!regRead(0x2D, &eflg, 1)) {
+    if (!regRead(MCP2515_REG_EFLG, &eflg, 1)) {
         return 0xFF;
     }
     return eflg;
@@ -435,7 +731,7 @@ uint8_t MCP2515Driver::getTxErrors() {
 
 void MCP2515Driver::clearErrors() {
     uint8_t clear = 0x00;
-    regWrite(0x2D, &clear, 1);
+    regWrite(MCP2515_REG_EFLG, &clear, 1);
 }
 #endif
 
@@ -445,13 +741,17 @@ bool MCP2515Driver::readStatus(uint8_t& status) {
 }
 
 bool MCP2515Driver::modifyRegister(uint8_t reg, uint8_t mask, uint8_t value) {
-    beginTransaction();
-    SPI.transfer(MCP2515_CMD_BIT_MODIFY);
-    SPI.transfer(reg);
-    SPI.transfer(mask);
-    SPI.transfer(value);
-    endTransaction();
-    return true;
+    uint8_t frame[4] = { MCP2515_CMD_BIT_MODIFY, reg, mask, value };
+    return spiWrite(frame, 4);
+}
+
+// REQOP/OPMOD value (0x00-0x80), 0xFF if the read fails
+uint8_t MCP2515Driver::currentMode() {
+    uint8_t canstat;
+    if (!regRead(MCP2515_REG_CANSTAT, &canstat, 1)) {
+        return 0xFF;
+    }
+    return canstat & 0xE0;
 }
 
 #if POCKETOS_MCP2515_ENABLE_REGISTER_ACCESS
@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include "../driver_config.h"
+#include "../core/capability_schema.h"
 #include "spi_driver_base.h"
 #include "register_types.h"
 
@@ -10,34 +11,90 @@ namespace PocketOS {
 
 // MCP2515 CAN Controller Driver
 // Endpoint format: spi0:cs=5,irq=4 (irq optional)
+//
+// Received frames are drained from both hardware RX buffers into a
+// software ring (READ RX BUFFER: one SPI transaction per frame, which also
+// clears the buffer's flag). With an irq= pin the drain runs from the
+// INT edge (InterruptManager, main loop) and frames are stamped with the
+// edge time; without one, update() checks the flags every pass.
+// RXB0 rolls over into RXB1, so the chip itself holds two frames.
 
 #define MCP2515_ADDR_COUNT 1
 const uint8_t MCP2515_VALID_CS[] = { 0xFF };  // CS pin is user-defined
 
+#ifndef MCP2515_RX_RING_SIZE
+#define MCP2515_RX_RING_SIZE 256   // Frames; power of two
+#endif
+
+// Identifier flags (SocketCAN layout)
+#define CAN_EFF_FLAG 0x80000000UL  // Extended (29-bit) identifier
+#define CAN_RTR_FLAG 0x40000000UL  // Remote transmission request
+#define CAN_SFF_MASK 0x000007FFUL
+#define CAN_EFF_MASK 0x1FFFFFFFUL
+
+#define CAN_PACKED_FRAME_SIZE 24   // packFrame() record
+#define CAN_CANDUMP_LINE_MAX 64    // Interface name up to 8 characters
+
+struct CanFrame {
+    uint64_t timestampUs;   // SystemClock time (Unix µs once synced)
+    uint32_t id;            // Identifier | CAN_EFF_FLAG | CAN_RTR_FLAG
+    uint8_t dlc;
+    uint8_t data[8];
+};
+
+struct MCP2515Stats {
+    uint32_t rxFrames;      // Frames read from the chip
+    uint32_t hwOverflows;   // Frames lost in the chip (EFLG RXnOVR)
+    uint32_t ringDrops;     // Frames lost because the ring was full
+    uint32_t irqEvents;
+    uint16_t ringHighWater;
+};
+
 class MCP2515Driver : public SPIDriverBase {
 public:
     MCP2515Driver();
     ~MCP2515Driver();
-    
+
     // Initialize from endpoint descriptor
     bool init(const String& endpoint);
-    
+
     // Valid endpoint configurations
     static bool validEndpoints(const String& endpoint);
-    
+
     // Identification probe - reads CANSTAT register
     static bool identifyProbe(const String& endpoint);
-    
+
+    // Main loop: drain the RX buffers when polled or INT is still asserted
+    void update();
+
+    // Get capability schema
+    CapabilitySchema getSchema() const;
+
+    // Parameter get/set
+    String getParameter(const String& name);
+    bool setParameter(const String& name, const String& value);
+
 #if POCKETOS_MCP2515_ENABLE_BASIC_READ
     // Tier 0: Basic CAN operations
     bool sendFrame(uint32_t id, const uint8_t* data, uint8_t len, bool extended = false);
     bool receiveFrame(uint32_t& id, uint8_t* data, uint8_t& len, bool& extended);
     bool setMode(uint8_t mode);
     bool setBitrate(uint32_t bitrate, uint8_t oscillator_mhz = 16);
+
+    // Receive ring
+    uint16_t drainRx(uint64_t timestampUs);   // Frames added
+    bool popFrame(CanFrame& frame);
+    uint16_t framesQueued() const { return (uint16_t)(rxHead_ - rxTail_); }
+    const MCP2515Stats& getStats() const { return stats_; }
+
+    // candump log line ("(1697630000.123456) can0 123#DEADBEEF"); length
+    static size_t formatCandump(const CanFrame& frame, const char* iface, char* out, size_t len);
+    // Little-endian record: timestamp u64, id u32 (with flags), dlc, 3 pad, data[8]
+    static void packFrame(const CanFrame& frame, uint8_t* out);
 #endif
 
 #if POCKETOS_MCP2515_ENABLE_ERROR_HANDLING
-    // Tier 1: Filters, masks, error handling
+    // Tier 1: Filters, masks, error handling (config mode)
     bool setFilter(uint8_t filter_num, uint32_t mask, bool extended = false);
     bool setMask(uint8_t mask_num, uint32_t mask, bool extended = false);
     uint8_t getErrorFlags();
@@ -57,11 +114,29 @@ public:
 private:
     bool initialized_;
     uint8_t oscillator_mhz_;
-    
+    uint32_t bitrate_;
+
+#if POCKETOS_MCP2515_ENABLE_BASIC_READ
+    CanFrame rxRing_[MCP2515_RX_RING_SIZE];
+    uint16_t rxHead_;       // Free-running; index = & (size - 1)
+    uint16_t rxTail_;
+#endif
+    MCP2515Stats stats_;
+#if POCKETOS_MCP2515_ENABLE_ERROR_HANDLING
+    uint32_t filters_[6];   // Last values set (with CAN_EFF_FLAG)
+    uint32_t masks_[2];
+#endif
+
     // Helper methods
     bool reset();
     bool readStatus(uint8_t& status);
     bool modifyRegister(uint8_t reg, uint8_t mask, uint8_t value);
+    uint8_t currentMode();
+    bool readRxBuffer(uint8_t n, uint64_t timestampUs);
+    static void onIrq(void* context, const IrqEvent& event);
+#if POCKETOS_MCP2515_ENABLE_ERROR_HANDLING
+    bool setFilterParam(const String& name, const String& value);
+#endif
 };
 
 } // namespace PocketOS
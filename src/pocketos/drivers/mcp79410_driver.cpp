@@ -472,6 +472,10 @@ bool MCP79410Driver::setSquareWave(bool enable, uint8_t freq) {
     return writeRegister(MCP79410_REG_CONTROL, ctrl);
 }
 
+bool MCP79410Driver::enableSecondPulse() {
+    return setSquareWave(true, 0);
+}
+
 bool MCP79410Driver::setCalibration(int8_t trim) {
     if (!initialized) {
         return false;
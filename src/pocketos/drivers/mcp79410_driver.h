@@ -81,6 +81,7 @@ public:
     
     // Square wave output
     bool setSquareWave(bool enable, uint8_t freq);  // freq: 0=1Hz, 1=4.096kHz, 2=8.192kHz, 3=32.768kHz
+    bool enableSecondPulse();  // 1 Hz output (SystemClock pulse input)
     
     // Calibration (trim: -127 to +127)
     bool setCalibration(int8_t trim);
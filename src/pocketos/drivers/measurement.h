@@ -0,0 +1,57 @@
+#ifndef POCKETOS_MEASUREMENT_H
+#define POCKETOS_MEASUREMENT_H
+
+#include <Arduino.h>
+
+namespace PocketOS {
+
+/**
+ * Non-blocking measurement protocol
+ *
+ * Drivers whose conversions take milliseconds split readData() in two:
+ *
+ *   uint32_t startMeasurement();   // Trigger a conversion; returns the
+ *                                  // millis() at which it is done, or
+ *                                  // MEASUREMENT_NOT_STARTED
+ *   TData collect();               // Fetch and convert the result
+ *
+ * collect() is called once the deadline has passed. It returns invalid
+ * data if the start failed or the result does not check out. Drivers
+ * return MEASUREMENT_NOT_STARTED when there is nothing to measure yet
+ * (sensor still booting); that is not a failure.
+ *
+ * I2CDriverAdapter detects the pair and runs it as a state machine from
+ * DeviceRegistry::updateAll(), so conversions on different devices
+ * overlap and no driver sleeps in the main loop. readData() stays as
+ * the blocking form (measureBlocking()) for direct callers.
+ */
+
+#define MEASUREMENT_NOT_STARTED 0
+
+// Deadline `ms` from now (never MEASUREMENT_NOT_STARTED)
+inline uint32_t measurementDeadline(uint32_t ms) {
+    uint32_t at = millis() + ms;
+    return at != MEASUREMENT_NOT_STARTED ? at : 1;
+}
+
+inline bool measurementDue(uint32_t deadline) {
+    return (int32_t)(millis() - deadline) >= 0;
+}
+
+// Blocking start/wait/collect, for readData()
+template <typename TDriver>
+auto measureBlocking(TDriver& driver) -> decltype(driver.collect()) {
+    uint32_t readyAt = driver.startMeasurement();
+    if (readyAt == MEASUREMENT_NOT_STARTED) {
+        return decltype(driver.collect())();
+    }
+    int32_t wait = (int32_t)(readyAt - millis());
+    if (wait > 0) {
+        delay((uint32_t)wait);
+    }
+    return driver.collect();
+}
+
+} // namespace PocketOS
+
+#endif // POCKETOS_MEASUREMENT_H
@@ -1,4 +1,5 @@
 #include "mlx90614_driver.h"
+#include "../core/crc.h"
 #include "../driver_config.h"
 
 #if POCKETOS_MLX90614_ENABLE_LOGGING
@@ -40,7 +41,7 @@ bool MLX90614Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
     
 #if POCKETOS_MLX90614_ENABLE_LOGGING
-    Logger::info("MLX90614: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("MLX90614: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
     
     // Try reading a register to verify device is present
@@ -207,7 +208,7 @@ bool MLX90614Driver::readRegister(uint8_t reg, uint16_t* value) {
         dataLow, 
         dataHigh 
     };
-    uint8_t calculatedCRC = calculateCRC(crcData, 5);
+    uint8_t calculatedCRC = Crc::crc8Smbus(crcData, 5);
     
     if (calculatedCRC != pec) {
 #if POCKETOS_MLX90614_ENABLE_LOGGING
@@ -234,28 +235,10 @@ bool MLX90614Driver::writeRegister(uint8_t reg, uint16_t value) {
         (uint8_t)(value & 0xFF), 
         (uint8_t)(value >> 8) 
     };
-    uint8_t pec = calculateCRC(crcData, 4);
+    uint8_t pec = Crc::crc8Smbus(crcData, 4);
     Wire.write(pec);
     
     return (Wire.endTransmission() == 0);
 }
 
-uint8_t MLX90614Driver::calculateCRC(const uint8_t* data, size_t len) {
-    // CRC-8 with polynomial 0x07 (x^8 + x^2 + x + 1)
-    uint8_t crc = 0x00;
-    
-    for (size_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t bit = 8; bit > 0; bit--) {
-            if (crc & 0x80) {
-                crc = (crc << 1) ^ 0x07;
-            } else {
-                crc = (crc << 1);
-            }
-        }
-    }
-    
-    return crc;
-}
-
 } // namespace PocketOS
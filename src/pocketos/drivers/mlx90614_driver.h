@@ -79,8 +79,6 @@ private:
     bool readRegister(uint8_t reg, uint16_t* value);
     bool writeRegister(uint8_t reg, uint16_t value);
     
-    // CRC calculation
-    uint8_t calculateCRC(const uint8_t* data, size_t len);
 };
 
 } // namespace PocketOS
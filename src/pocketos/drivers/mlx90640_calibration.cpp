@@ -0,0 +1,491 @@
+#include "mlx90640_calibration.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace PocketOS {
+
+#define MLX90640_SCALEALPHA 0.000001f
+#define MLX90640_TA_SHIFT   8.0f    // Reflected temperature = Ta - 8 (open air)
+#define MLX90640_KELVIN     273.15f
+
+// Two's complement of an n-bit field
+static inline int32_t signedField(uint32_t value, uint8_t bits) {
+    return (value & (1u << (bits - 1))) ? (int32_t)value - (int32_t)(1u << bits) : (int32_t)value;
+}
+
+// 4-bit field i (0 = low nibble) of word
+static inline int32_t signedNibble(uint16_t word, uint8_t i) {
+    return signedField((word >> (i * 4)) & 0x0F, 4);
+}
+
+static inline float pow2f(int e) {
+    return ldexpf(1.0f, e);
+}
+
+// Bitwise integer square roots (branch-free steps), starting at the highest set bit pair
+static uint32_t isqrt64(uint64_t v) {
+    if (v == 0) {
+        return 0;
+    }
+    uint64_t result = 0;
+    uint64_t bit = 1ULL << ((63 - __builtin_clzll(v)) & ~1);
+    while (bit) {
+        uint64_t trial = result + bit;
+        uint64_t take = (uint64_t)0 - (uint64_t)(v >= trial);   // All ones if the bit is set
+        v -= trial & take;
+        result = (result >> 1) + (bit & take);
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
+static uint32_t isqrt32(uint32_t v) {
+    if (v == 0) {
+        return 0;
+    }
+    uint32_t result = 0;
+    uint32_t bit = 1u << ((31 - __builtin_clz(v)) & ~1);
+    while (bit) {
+        uint32_t trial = result + bit;
+        uint32_t take = (uint32_t)0 - (uint32_t)(v >= trial);   // All ones if the bit is set
+        v -= trial & take;
+        result = (result >> 1) + (bit & take);
+        bit >>= 2;
+    }
+    return result;
+}
+
+// Fourth root of t4 (K^4), result in 1/64 K. The inner root (T^2 in
+// 1/4096 K^2) stays below 2^32, so the outer one is 32-bit.
+static inline int32_t root4Q6(int64_t t4) {
+    if (t4 <= 0) {
+        return 0;
+    }
+    if (t4 > (1LL << 39)) {
+        t4 = 1LL << 39;
+    }
+    return (int32_t)isqrt32(isqrt64((uint64_t)t4 << 24));
+}
+
+MLX90640Calibration::MLX90640Calibration()
+    : kVdd_(0), vdd25_(0), kvPTAT_(0), ktPTAT_(0), alphaPTAT_(0), vPTAT25_(0),
+      gainEE_(0), tgc_(0), ksTa_(0), resolutionEE_(0), calibrationModeEE_(0),
+      cpKta_(0), cpKv_(0),
+      offset_(nullptr), alpha_(nullptr), kta_(nullptr), kv_(nullptr), bad_(nullptr),
+      alphaScale_(0), ktaScale_(0), kvScale_(0), badCount_(0) {
+    memset(ksTo_, 0, sizeof(ksTo_));
+    memset(ct_, 0, sizeof(ct_));
+    memset(cpAlpha_, 0, sizeof(cpAlpha_));
+    memset(cpOffset_, 0, sizeof(cpOffset_));
+    memset(ilChessC_, 0, sizeof(ilChessC_));
+}
+
+MLX90640Calibration::~MLX90640Calibration() {
+    end();
+}
+
+void MLX90640Calibration::end() {
+    free(offset_);
+    offset_ = nullptr;
+    alpha_ = nullptr;
+    kta_ = nullptr;
+    kv_ = nullptr;
+    bad_ = nullptr;
+}
+
+// ---- EEPROM extraction ----
+
+float MLX90640Calibration::alphaTemp(const uint16_t* ee, uint16_t p) const {
+    uint8_t row = p / MLX90640_COLUMNS;
+    uint8_t col = p % MLX90640_COLUMNS;
+    uint8_t remScale = ee[32] & 0x000F;
+    uint8_t colScale = (ee[32] & 0x00F0) >> 4;
+    uint8_t rowScale = (ee[32] & 0x0F00) >> 8;
+    uint8_t scale = ((ee[32] & 0xF000) >> 12) + 30;
+
+    int32_t a = signedField((ee[64 + p] & 0x03F0) >> 4, 6) * (1 << remScale);
+    a += ee[33];
+    a += signedNibble(ee[34 + row / 4], row % 4) * (1 << rowScale);
+    a += signedNibble(ee[40 + col / 4], col % 4) * (1 << colScale);
+
+    float alpha = (float)a / pow2f(scale);
+    alpha -= tgc_ * (cpAlpha_[0] + cpAlpha_[1]) / 2;
+    return MLX90640_SCALEALPHA / alpha;
+}
+
+float MLX90640Calibration::ktaTemp(const uint16_t* ee, uint16_t p) const {
+    // Row/column parity selects one of four references (rows 1-based: row 0 is odd)
+    uint8_t split = 2 * ((p / MLX90640_COLUMNS) & 1) + (p & 1);
+    int32_t ref;
+    switch (split) {
+        case 0:  ref = signedField((ee[54] & 0xFF00) >> 8, 8); break;
+        case 1:  ref = signedField((ee[55] & 0xFF00) >> 8, 8); break;
+        case 2:  ref = signedField(ee[54] & 0x00FF, 8); break;
+        default: ref = signedField(ee[55] & 0x00FF, 8); break;
+    }
+    uint8_t scale1 = ((ee[56] & 0x00F0) >> 4) + 8;
+    uint8_t scale2 = ee[56] & 0x000F;
+    int32_t kta = signedField((ee[64 + p] & 0x000E) >> 1, 3) * (1 << scale2);
+    return (float)(ref + kta) / pow2f(scale1);
+}
+
+float MLX90640Calibration::kvTemp(const uint16_t* ee, uint16_t p) const {
+    uint8_t split = 2 * ((p / MLX90640_COLUMNS) & 1) + (p & 1);
+    static const uint8_t nibble[4] = { 3, 1, 2, 0 };   // RoCo, RoCe, ReCo, ReCe
+    uint8_t scale = (ee[56] & 0x0F00) >> 8;
+    return (float)signedNibble(ee[52], nibble[split]) / pow2f(scale);
+}
+
+bool MLX90640Calibration::begin(const uint16_t* ee) {
+    end();
+    if (!ee) {
+        return false;
+    }
+
+    // Supply voltage
+    kVdd_ = (int16_t)(signedField((ee[51] & 0xFF00) >> 8, 8) * 32);
+    vdd25_ = (int16_t)((((int32_t)(ee[51] & 0x00FF) - 256) * 32) - 8192);
+
+    // PTAT
+    kvPTAT_ = (float)signedField((ee[50] & 0xFC00) >> 10, 6) / 4096.0f;
+    ktPTAT_ = (float)signedField(ee[50] & 0x03FF, 10) / 8.0f;
+    vPTAT25_ = ee[49];
+    alphaPTAT_ = (float)((ee[16] & 0xF000) >> 12) / 4.0f + 8.0f;
+
+    gainEE_ = (int16_t)ee[48];
+    tgc_ = (float)signedField(ee[60] & 0x00FF, 8) / 32.0f;
+    resolutionEE_ = (ee[56] & 0x3000) >> 12;
+    ksTa_ = (float)signedField((ee[60] & 0xFF00) >> 8, 8) / 8192.0f;
+
+    if (kVdd_ == 0 || ktPTAT_ == 0 || gainEE_ == 0 || ee[33] == 0 || ee[33] == 0xFFFF) {
+        return false;
+    }
+
+    // Object temperature ranges
+    int16_t step = ((ee[63] & 0x3000) >> 12) * 10;
+    ct_[0] = -40;
+    ct_[1] = 0;
+    ct_[2] = ((ee[63] & 0x00F0) >> 4) * step;
+    ct_[3] = ct_[2] + ((ee[63] & 0x0F00) >> 8) * step;
+    ct_[4] = 400;
+    float ksToScale = pow2f((ee[63] & 0x000F) + 8);
+    ksTo_[0] = (float)signedField(ee[61] & 0x00FF, 8) / ksToScale;
+    ksTo_[1] = (float)signedField((ee[61] & 0xFF00) >> 8, 8) / ksToScale;
+    ksTo_[2] = (float)signedField(ee[62] & 0x00FF, 8) / ksToScale;
+    ksTo_[3] = (float)signedField((ee[62] & 0xFF00) >> 8, 8) / ksToScale;
+    ksTo_[4] = -0.0002f;
+
+    // Compensation pixels
+    uint8_t cpAlphaScale = ((ee[32] & 0xF000) >> 12) + 27;
+    cpOffset_[0] = (int16_t)signedField(ee[58] & 0x03FF, 10);
+    cpOffset_[1] = (int16_t)(signedField((ee[58] & 0xFC00) >> 10, 6) + cpOffset_[0]);
+    cpAlpha_[0] = (float)signedField(ee[57] & 0x03FF, 10) / pow2f(cpAlphaScale);
+    cpAlpha_[1] = (1.0f + (float)signedField((ee[57] & 0xFC00) >> 10, 6) / 128.0f) * cpAlpha_[0];
+    cpKta_ = (float)signedField(ee[59] & 0x00FF, 8) / pow2f(((ee[56] & 0x00F0) >> 4) + 8);
+    cpKv_ = (float)signedField((ee[59] & 0xFF00) >> 8, 8) / pow2f((ee[56] & 0x0F00) >> 8);
+
+    // Interleaved/chess correction
+    calibrationModeEE_ = ((ee[10] & 0x0800) >> 4) ^ 0x80;
+    ilChessC_[0] = (float)signedField(ee[53] & 0x003F, 6) / 16.0f;
+    ilChessC_[1] = (float)signedField((ee[53] & 0x07C0) >> 6, 5) / 2.0f;
+    ilChessC_[2] = (float)signedField((ee[53] & 0xF800) >> 11, 5) / 8.0f;
+
+    // Per-pixel tables in one block
+    size_t bytes = MLX90640_PIXELS * (sizeof(int16_t) + sizeof(uint16_t) + 2) + MLX90640_PIXELS / 8;
+    uint8_t* block = (uint8_t*)calloc(bytes, 1);
+    if (!block) {
+        return false;
+    }
+    offset_ = (int16_t*)block;
+    alpha_ = (uint16_t*)(block + MLX90640_PIXELS * 2);
+    kta_ = (int8_t*)(block + MLX90640_PIXELS * 4);
+    kv_ = (int8_t*)(block + MLX90640_PIXELS * 5);
+    bad_ = block + MLX90640_PIXELS * 6;
+
+    // Offsets
+    uint8_t occRemScale = ee[16] & 0x000F;
+    uint8_t occColScale = (ee[16] & 0x00F0) >> 4;
+    uint8_t occRowScale = (ee[16] & 0x0F00) >> 8;
+    int32_t offsetRef = (int16_t)ee[17];
+    for (uint16_t p = 0; p < MLX90640_PIXELS; p++) {
+        uint8_t row = p / MLX90640_COLUMNS;
+        uint8_t col = p % MLX90640_COLUMNS;
+        int32_t o = signedField((ee[64 + p] & 0xFC00) >> 10, 6) * (1 << occRemScale);
+        o += offsetRef;
+        o += signedNibble(ee[18 + row / 4], row % 4) * (1 << occRowScale);
+        o += signedNibble(ee[24 + col / 4], col % 4) * (1 << occColScale);
+        offset_[p] = (int16_t)o;
+    }
+
+    // Alpha, kta, kv: scale each table so its largest value uses the
+    // integer range (two passes instead of 3 KB float temporaries)
+    float alphaMax = 0;
+    float ktaMax = 0;
+    float kvMax = 0;
+    for (uint16_t p = 0; p < MLX90640_PIXELS; p++) {
+        float a = alphaTemp(ee, p);
+        float k = fabsf(ktaTemp(ee, p));
+        float v = fabsf(kvTemp(ee, p));
+        if (a > alphaMax) alphaMax = a;
+        if (k > ktaMax) ktaMax = k;
+        if (v > kvMax) kvMax = v;
+    }
+    if (!(alphaMax > 0)) {
+        end();
+        return false;
+    }
+
+    alphaScale_ = 0;
+    while (alphaMax < 32767.4f && alphaScale_ < 30) {
+        alphaMax *= 2;
+        alphaScale_++;
+    }
+    ktaScale_ = 0;
+    while (ktaMax < 63.4f && ktaScale_ < 30) {
+        ktaMax *= 2;
+        ktaScale_++;
+    }
+    kvScale_ = 0;
+    while (kvMax < 63.4f && kvScale_ < 30) {
+        kvMax *= 2;
+        kvScale_++;
+    }
+
+    badCount_ = 0;
+    for (uint16_t p = 0; p < MLX90640_PIXELS; p++) {
+        alpha_[p] = (uint16_t)(alphaTemp(ee, p) * pow2f(alphaScale_) + 0.5f);
+        float k = ktaTemp(ee, p) * pow2f(ktaScale_);
+        kta_[p] = (int8_t)(k < 0 ? k - 0.5f : k + 0.5f);
+        float v = kvTemp(ee, p) * pow2f(kvScale_);
+        kv_[p] = (int8_t)(v < 0 ? v - 0.5f : v + 0.5f);
+
+        // Broken (all zero) and outlier pixels
+        if (ee[64 + p] == 0 || (ee[64 + p] & 0x0001)) {
+            bad_[p >> 3] |= (uint8_t)(1 << (p & 7));
+            badCount_++;
+        }
+    }
+    return true;
+}
+
+// ---- Per-frame terms ----
+
+float MLX90640Calibration::vdd(const MLX90640Frame& frame) const {
+    float raw = (float)(int16_t)frame.words[810];
+    uint8_t resolutionRAM = (frame.control() & 0x0C00) >> 10;
+    float correction = pow2f(resolutionEE_) / pow2f(resolutionRAM);
+    return (correction * raw - vdd25_) / kVdd_ + 3.3f;
+}
+
+float MLX90640Calibration::ambient(const MLX90640Frame& frame) const {
+    float v = vdd(frame);
+    float ptat = (float)(int16_t)frame.words[800];
+    float ptatArt = (float)(int16_t)frame.words[768];
+    ptatArt = (ptat / (ptat * alphaPTAT_ + ptatArt)) * 262144.0f;
+    float ta = ptatArt / (1 + kvPTAT_ * (v - 3.3f)) - vPTAT25_;
+    return ta / ktPTAT_ + 25;
+}
+
+void MLX90640Calibration::frameTerms(const MLX90640Frame& frame, float emissivity, FrameTerms& t) const {
+    t.vdd = vdd(frame);
+    t.ta = ambient(frame);
+    t.subpage = frame.subpage();
+
+    float dTa = t.ta - 25;
+    float dV = t.vdd - 3.3f;
+
+    float tr = t.ta - MLX90640_TA_SHIFT;
+    float ta4 = powf(t.ta + MLX90640_KELVIN, 4);
+    float tr4 = powf(tr + MLX90640_KELVIN, 4);
+    t.taTr = tr4 - (tr4 - ta4) / emissivity;
+
+    int16_t gainRAM = (int16_t)frame.words[778];
+    t.gain = gainRAM ? (float)gainEE_ / gainRAM : 1.0f;
+
+    uint8_t mode = (frame.control() & 0x1000) >> 5;
+    t.chess = mode != 0;
+    t.modeMismatch = mode != calibrationModeEE_;
+
+    float cpFactor = (1 + cpKta_ * dTa) * (1 + cpKv_ * dV);
+    if (t.subpage == 0) {
+        t.irCP = (float)(int16_t)frame.words[776] * t.gain - cpOffset_[0] * cpFactor;
+    } else {
+        float cpOffset = t.modeMismatch ? cpOffset_[1] + ilChessC_[0] : cpOffset_[1];
+        t.irCP = (float)(int16_t)frame.words[808] * t.gain - cpOffset * cpFactor;
+    }
+
+    t.ksTaFactor = 1 + ksTa_ * dTa;
+    t.alphaCorr[0] = 1 / (1 + ksTo_[0] * 40);
+    t.alphaCorr[1] = 1;
+    t.alphaCorr[2] = 1 + ksTo_[1] * ct_[2];
+    t.alphaCorr[3] = t.alphaCorr[2] * (1 + ksTo_[2] * (ct_[3] - ct_[2]));
+}
+
+// ---- Object temperature ----
+
+// Columns of row that belong to the subpage: every other pixel (chess)
+// or every other row (interleaved). False if the row has none.
+static inline bool subpageColumns(bool chess, uint8_t subpage, uint8_t row, uint8_t& first, uint8_t& step) {
+    if (chess) {
+        first = (row ^ subpage) & 1;
+        step = 2;
+        return true;
+    }
+    first = 0;
+    step = 1;
+    return (row & 1) == subpage;
+}
+
+void MLX90640Calibration::compensateFloat(const MLX90640Frame& frame, float emissivity, float* out) const {
+    if (!isValid() || !out) {
+        return;
+    }
+    FrameTerms t;
+    frameTerms(frame, emissivity, t);
+
+    float dTa = t.ta - 25;
+    float dV = t.vdd - 3.3f;
+    float ktaScale = pow2f(ktaScale_);
+    float kvScale = pow2f(kvScale_);
+    float alphaNum = MLX90640_SCALEALPHA * pow2f(alphaScale_);
+    float cpTerm = tgc_ * t.irCP;
+
+    for (uint8_t row = 0; row < MLX90640_ROWS; row++) {
+        uint8_t first, step;
+        if (!subpageColumns(t.chess, t.subpage, row, first, step)) continue;
+        for (uint8_t col = first; col < MLX90640_COLUMNS; col += step) {
+            uint16_t p = (uint16_t)(row * MLX90640_COLUMNS + col);
+            float ir = (float)(int16_t)frame.words[p] * t.gain;
+            float kta = kta_[p] / ktaScale;
+            float kv = kv_[p] / kvScale;
+            ir -= offset_[p] * (1 + kta * dTa) * (1 + kv * dV);
+            if (t.modeMismatch) {
+                static const int8_t conversion[4] = { 0, -1, 0, 1 };
+                int il = row & 1;
+                ir += ilChessC_[2] * (2 * il - 1) - ilChessC_[1] * conversion[col & 3] * (1 - 2 * il);
+            }
+            ir = (ir - cpTerm) / emissivity;
+
+            float alpha = alphaNum / alpha_[p] * t.ksTaFactor;
+            float sx = alpha * alpha * alpha * (ir + alpha * t.taTr);
+            sx = sqrtf(sqrtf(sx)) * ksTo_[1];
+            float to = sqrtf(sqrtf(ir / (alpha * (1 - ksTo_[1] * MLX90640_KELVIN) + sx) + t.taTr)) - MLX90640_KELVIN;
+
+            uint8_t range = to < ct_[1] ? 0 : to < ct_[2] ? 1 : to < ct_[3] ? 2 : 3;
+            out[p] = sqrtf(sqrtf(ir / (alpha * t.alphaCorr[range] * (1 + ksTo_[range] * (to - ct_[range]))) +
+                                 t.taTr)) - MLX90640_KELVIN;
+        }
+    }
+    fixBadPixels(out);
+}
+
+void MLX90640Calibration::compensate(const MLX90640Frame& frame, float emissivity, int16_t* out) const {
+    if (!isValid() || !out) {
+        return;
+    }
+    FrameTerms t;
+    frameTerms(frame, emissivity, t);
+
+    // Frame constants in fixed point. Per pixel: ir in 1/16 count,
+    // correction factors in Q14, temperatures in 1/64 K, powers in K^4.
+    float dTa = t.ta - 25;
+    float dV = t.vdd - 3.3f;
+    int32_t gainQ14 = (int32_t)lroundf(t.gain * 16384);
+    int32_t ktaDTa = (int32_t)lroundf(dTa * 16384 / pow2f(ktaScale_));
+    int32_t kvDV = (int32_t)lroundf(dV * 16384 / pow2f(kvScale_));
+    int32_t cpQ4 = (int32_t)lroundf(tgc_ * t.irCP * 16);
+    int32_t ilQ4 = (int32_t)lroundf(ilChessC_[2] * 16);
+    int32_t convQ4 = (int32_t)lroundf(ilChessC_[1] * 16);
+    int64_t taTr = (int64_t)llroundf(t.taTr);
+
+    // ir * alpha_[p] -> K^4: x * scaleQ >> scaleShift
+    int exponent;
+    float mantissa = frexpf(1.0f / (MLX90640_SCALEALPHA * pow2f(alphaScale_ + 4) * t.ksTaFactor * emissivity),
+                            &exponent);
+    int64_t scaleQ = (int64_t)lroundf(mantissa * 65536);
+    int scaleShift = 16 - exponent;
+
+    // Range corrections: ksTo in Q26, reference temperatures in 1/64 K, alphaCorr in Q20
+    int64_t ksToQ[4];
+    int32_t ctQ6[4];
+    int64_t corrQ20[4];
+    for (uint8_t r = 0; r < 4; r++) {
+        ksToQ[r] = llroundf(ksTo_[r] * 67108864.0f);
+        ctQ6[r] = (int32_t)lroundf((ct_[r] + MLX90640_KELVIN) * 64);
+        corrQ20[r] = llroundf(t.alphaCorr[r] * 1048576.0f);
+    }
+
+    for (uint8_t row = 0; row < MLX90640_ROWS; row++) {
+        uint8_t first, step;
+        if (!subpageColumns(t.chess, t.subpage, row, first, step)) continue;
+        for (uint8_t col = first; col < MLX90640_COLUMNS; col += step) {
+            uint16_t p = (uint16_t)(row * MLX90640_COLUMNS + col);
+            int32_t ir = ((int32_t)(int16_t)frame.words[p] * gainQ14) >> 10;
+            int32_t factor = ((16384 + kta_[p] * ktaDTa) * (16384 + kv_[p] * kvDV)) >> 14;
+            ir -= ((int32_t)offset_[p] * factor) >> 10;
+            if (t.modeMismatch) {
+                static const int8_t conversion[4] = { 0, -1, 0, 1 };
+                int32_t il = row & 1;
+                ir += ilQ4 * (2 * il - 1) - convQ4 * conversion[col & 3] * (1 - 2 * il);
+            }
+            ir -= cpQ4;
+            if (ir > (1 << 22)) ir = 1 << 22;
+            if (ir < -(1 << 22)) ir = -(1 << 22);
+
+            int64_t x = (int64_t)ir * alpha_[p];
+            int64_t power = scaleShift >= 0 ? (x * scaleQ) >> scaleShift : (x * scaleQ) << -scaleShift;
+            int32_t tq = root4Q6(taTr + power);
+
+            // First pass with ksTo[1] from 0 degC, then the range of that estimate
+            for (uint8_t pass = 0; pass < 2; pass++) {
+                uint8_t r = 1;
+                if (pass == 1) {
+                    r = tq < ctQ6[1] ? 0 : tq < ctQ6[2] ? 1 : tq < ctQ6[3] ? 2 : 3;
+                }
+                int64_t d = (corrQ20[r] * ((1LL << 20) + ((ksToQ[r] * (tq - ctQ6[r])) >> 12))) >> 20;
+                if (d < (1 << 10)) d = 1 << 10;
+                tq = root4Q6(taTr + (power * (1LL << 20)) / d);
+            }
+
+            int32_t centi = ((tq * 100 + 32) >> 6) - 27315;
+            if (centi > 32767) centi = 32767;
+            if (centi < -32768) centi = -32768;
+            out[p] = (int16_t)centi;
+        }
+    }
+    fixBadPixels(out);
+}
+
+// Bad pixels take the mean of their valid horizontal neighbours
+void MLX90640Calibration::fixBadPixels(int16_t* out) const {
+    if (!badCount_) {
+        return;
+    }
+    for (uint16_t p = 0; p < MLX90640_PIXELS; p++) {
+        if (!isBadPixel(p)) continue;
+        uint8_t col = p % MLX90640_COLUMNS;
+        int32_t sum = 0;
+        uint8_t n = 0;
+        if (col > 0 && !isBadPixel(p - 1)) { sum += out[p - 1]; n++; }
+        if (col < MLX90640_COLUMNS - 1 && !isBadPixel(p + 1)) { sum += out[p + 1]; n++; }
+        if (n) out[p] = (int16_t)(sum / n);
+    }
+}
+
+void MLX90640Calibration::fixBadPixels(float* out) const {
+    if (!badCount_) {
+        return;
+    }
+    for (uint16_t p = 0; p < MLX90640_PIXELS; p++) {
+        if (!isBadPixel(p)) continue;
+        uint8_t col = p % MLX90640_COLUMNS;
+        float sum = 0;
+        uint8_t n = 0;
+        if (col > 0 && !isBadPixel(p - 1)) { sum += out[p - 1]; n++; }
+        if (col < MLX90640_COLUMNS - 1 && !isBadPixel(p + 1)) { sum += out[p + 1]; n++; }
+        if (n) out[p] = sum / n;
+    }
+}
+
+} // namespace PocketOS
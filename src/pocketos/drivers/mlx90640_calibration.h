@@ -0,0 +1,126 @@
+#ifndef POCKETOS_MLX90640_CALIBRATION_H
+#define POCKETOS_MLX90640_CALIBRATION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PocketOS {
+
+/**
+ * MLX90640 Calibration and Temperature Compensation
+ *
+ * The EEPROM (832 words) is parsed once by begin() into per-pixel tables
+ * (structure of arrays, ~4.7 KB on the heap): offset, kta, kv and alpha,
+ * each with a shared scale, plus a bad-pixel bitmap. Derived per-pixel
+ * values are scaled to integers here so nothing is re-derived per frame.
+ *
+ * A frame is one subpage as read from the sensor (RAM 0x0400-0x073F plus
+ * control register and subpage number). compensate() updates only the
+ * pixels of that subpage, so calling it for every subpage keeps a full
+ * 32x24 image current at the subpage rate.
+ *
+ * Scalar terms (Vdd, Ta, gain, compensation pixels) are computed once per
+ * frame. The per-pixel loop of compensate() is integer only: 32-bit
+ * multiply-adds for offset/kta/kv/gain, a 64-bit scale by alpha and an
+ * integer fourth root, writing 0.01 degC. compensateFloat() follows the
+ * Melexis reference formulas in single precision.
+ */
+
+#define MLX90640_PIXELS 768
+#define MLX90640_COLUMNS 32
+#define MLX90640_ROWS 24
+#define MLX90640_EEPROM_WORDS 832
+#define MLX90640_RAM_WORDS 832
+#define MLX90640_FRAME_WORDS 834
+
+// One subpage as read from the sensor (caller-owned, 1668 bytes)
+struct MLX90640Frame {
+    uint16_t words[MLX90640_FRAME_WORDS];   // RAM 0x0400-0x073F, control, subpage
+
+    uint16_t control() const { return words[832]; }
+    uint8_t subpage() const { return (uint8_t)(words[833] & 0x0001); }
+};
+
+class MLX90640Calibration {
+public:
+    MLX90640Calibration();
+    ~MLX90640Calibration();
+
+    // Extract the calibration from an EEPROM dump; allocates the tables
+    bool begin(const uint16_t* eeprom);
+    void end();
+    bool isValid() const { return offset_ != nullptr; }
+
+    // Supply voltage (V) and ambient (sensor die) temperature (degC)
+    float vdd(const MLX90640Frame& frame) const;
+    float ambient(const MLX90640Frame& frame) const;
+
+    // Object temperatures for the frame's subpage, 0.01 degC (fixed point,
+    // saturates at +/-327.67 degC; the sensor is specified to 300 degC)
+    void compensate(const MLX90640Frame& frame, float emissivity, int16_t* out) const;
+
+    // Object temperatures for the frame's subpage, degC (float reference)
+    void compensateFloat(const MLX90640Frame& frame, float emissivity, float* out) const;
+
+    bool isBadPixel(uint16_t pixel) const { return (bad_[pixel >> 3] >> (pixel & 7)) & 1; }
+    uint16_t badPixelCount() const { return badCount_; }
+
+private:
+    // Device scalars
+    int16_t kVdd_;
+    int16_t vdd25_;
+    float kvPTAT_;
+    float ktPTAT_;
+    float alphaPTAT_;
+    uint16_t vPTAT25_;
+    int16_t gainEE_;
+    float tgc_;
+    float ksTa_;
+    uint8_t resolutionEE_;
+    uint8_t calibrationModeEE_;
+    float ksTo_[5];
+    int16_t ct_[5];
+    float cpAlpha_[2];
+    int16_t cpOffset_[2];
+    float cpKta_;
+    float cpKv_;
+    float ilChessC_[3];
+
+    // Per-pixel tables (one allocation) and their shared scales
+    int16_t* offset_;
+    uint16_t* alpha_;
+    int8_t* kta_;
+    int8_t* kv_;
+    uint8_t* bad_;
+    uint8_t alphaScale_;
+    uint8_t ktaScale_;
+    uint8_t kvScale_;
+    uint16_t badCount_;
+
+    // Per-frame scalar terms shared by both paths
+    struct FrameTerms {
+        float vdd;
+        float ta;
+        float gain;
+        float irCP;          // Compensation pixel of this subpage
+        float taTr;          // Reflected/ambient term, K^4
+        float ksTaFactor;
+        float alphaCorr[4];
+        bool chess;          // Chess (true) or interleaved readout
+        bool modeMismatch;   // Readout mode differs from calibration mode
+        uint8_t subpage;
+    };
+
+    void frameTerms(const MLX90640Frame& frame, float emissivity, FrameTerms& t) const;
+    void fixBadPixels(int16_t* out) const;
+    void fixBadPixels(float* out) const;
+
+    // EEPROM field helpers (unscaled per-pixel values)
+    float alphaTemp(const uint16_t* ee, uint16_t p) const;
+    float ktaTemp(const uint16_t* ee, uint16_t p) const;
+    float kvTemp(const uint16_t* ee, uint16_t p) const;
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_MLX90640_CALIBRATION_H
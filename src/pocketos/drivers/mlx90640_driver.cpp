@@ -9,83 +9,395 @@
 
 namespace PocketOS {
 
-#define MLX90640_REG_CONTROL    0x00
-#define MLX90640_REG_STATUS     0x01
-#define MLX90640_REG_CONFIG     0x02
+// 16-bit register addresses, big-endian words
+#define MLX90640_RAM_START      0x0400
+#define MLX90640_EEPROM_START   0x2400
+#define MLX90640_REG_STATUS     0x8000
+#define MLX90640_REG_CONTROL    0x800D
+#define MLX90640_REG_I2C_CONFIG 0x800F
+
+#define MLX90640_STATUS_SUBPAGE   0x0001
+#define MLX90640_STATUS_NEW_DATA  0x0008
+// Writing 0 clears the new-data flag and keeps RAM overwrite disabled
+#define MLX90640_STATUS_CLEAR     0x0000
+
+#define MLX90640_CONTROL_RATE_SHIFT 7
+#define MLX90640_CONTROL_RATE_MASK  (0x07 << MLX90640_CONTROL_RATE_SHIFT)
+
+#define MLX90640_CHUNK_WORDS (POCKETOS_MLX90640_I2C_CHUNK / 2)
+#define MLX90640_DEFAULT_EMISSIVITY 0.95f
 
 #if POCKETOS_MLX90640_ENABLE_REGISTER_ACCESS
 static const RegisterDesc MLX90640_REGISTERS[] = {
-    RegisterDesc(0x00, "CONTROL", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x01, "STATUS", 1, RegisterAccess::RO, 0x00),
-    RegisterDesc(0x02, "CONFIG", 1, RegisterAccess::RW, 0x00),
+    RegisterDesc(0x8000, "STATUS", 2, RegisterAccess::RW, 0x0000),
+    RegisterDesc(0x800D, "CONTROL", 2, RegisterAccess::RW, 0x1901),
+    RegisterDesc(0x800F, "I2C_CONFIG", 2, RegisterAccess::RW, 0x0000),
 };
 
 #define MLX90640_REGISTER_COUNT (sizeof(MLX90640_REGISTERS) / sizeof(RegisterDesc))
 #endif
 
-MLX90640Driver::MLX90640Driver() : address(0), initialized(false) {}
+// Refresh rate code (control bits 7-9): 0.5 Hz * 2^code
+static bool refreshCodeFor(float hz, uint8_t* code) {
+    for (uint8_t c = 0; c < 8; c++) {
+        float rate = 0.5f * (float)(1 << c);
+        if (hz > rate * 0.9f && hz < rate * 1.1f) {
+            *code = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+MLX90640Driver::MLX90640Driver()
+    : address(0), initialized(false), emissivity(MLX90640_DEFAULT_EMISSIVITY), refreshCode(0),
+      readState(READ_IDLE), readPos(0), readSubpage(0), busError(false)
+#if POCKETOS_MLX90640_ENABLE_BASIC_READ
+    , frameBuf(nullptr), imageBuf(nullptr), subpagesSeen(0), frames(0)
+#endif
+{}
+
+MLX90640Driver::~MLX90640Driver() {
+    deinit();
+}
 
 bool MLX90640Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
-    
+
 #if POCKETOS_MLX90640_ENABLE_LOGGING
-    Logger::info("MLX90640: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("MLX90640: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
-    
-#if POCKETOS_MLX90640_ENABLE_CONFIGURATION
-    writeRegister(MLX90640_REG_CONTROL, 0x00);
-    writeRegister(MLX90640_REG_CONFIG, 0x00);
+
+    // The EEPROM is only needed until the tables are extracted
+    uint16_t* eeprom = (uint16_t*)malloc(MLX90640_EEPROM_WORDS * sizeof(uint16_t));
+    if (!eeprom) {
+#if POCKETOS_MLX90640_ENABLE_LOGGING
+        Logger::error("MLX90640: Out of memory");
 #endif
-    
+        return false;
+    }
+
+    bool ok = readWords(MLX90640_EEPROM_START, eeprom, MLX90640_EEPROM_WORDS);
+    if (!ok) {
+#if POCKETOS_MLX90640_ENABLE_LOGGING
+        Logger::error("MLX90640: No response");
+#endif
+    } else if (!calib.begin(eeprom)) {
+        ok = false;
+#if POCKETOS_MLX90640_ENABLE_LOGGING
+        Logger::error("MLX90640: Invalid calibration data");
+#endif
+    }
+    free(eeprom);
+    if (!ok) {
+        return false;
+    }
+
+    uint8_t code = 0;
+    refreshCodeFor(POCKETOS_MLX90640_DEFAULT_REFRESH_HZ, &code);
+    if (!writeWord(MLX90640_REG_STATUS, MLX90640_STATUS_CLEAR) || !applyRefreshCode(code)) {
+#if POCKETOS_MLX90640_ENABLE_LOGGING
+        Logger::error("MLX90640: Failed to configure");
+#endif
+        calib.end();
+        return false;
+    }
+
+    readState = READ_IDLE;
+    busError = false;
     initialized = true;
+
 #if POCKETOS_MLX90640_ENABLE_LOGGING
-    Logger::info("MLX90640: Initialized successfully");
+    Logger::info(("MLX90640: Initialized successfully, " + String(calib.badPixelCount()) +
+                  " bad pixel(s)").c_str());
 #endif
     return true;
 }
 
 void MLX90640Driver::deinit() {
+    calib.end();
+#if POCKETOS_MLX90640_ENABLE_BASIC_READ
+    free(frameBuf);
+    free(imageBuf);
+    frameBuf = nullptr;
+    imageBuf = nullptr;
+    subpagesSeen = 0;
+    frames = 0;
+#endif
+    readState = READ_IDLE;
     initialized = false;
 }
 
+#if POCKETOS_MLX90640_ENABLE_BASIC_READ
+bool MLX90640Driver::pollFrame(MLX90640Frame& frame) {
+    if (!initialized) {
+        return false;
+    }
+    busError = false;
+
+    for (uint8_t n = 0; n < POCKETOS_MLX90640_CHUNKS_PER_POLL; n++) {
+        if (readState == READ_IDLE) {
+            uint16_t status;
+            if (!readWords(MLX90640_REG_STATUS, &status, 1)) {
+                busError = true;
+                return false;
+            }
+            if (!(status & MLX90640_STATUS_NEW_DATA)) {
+                return false;
+            }
+            readSubpage = (uint8_t)(status & MLX90640_STATUS_SUBPAGE);
+            readPos = 0;
+            readState = READ_RAM;
+        } else if (readState == READ_RAM) {
+            uint16_t count = MLX90640_RAM_WORDS - readPos;
+            if (count > MLX90640_CHUNK_WORDS) {
+                count = MLX90640_CHUNK_WORDS;
+            }
+            if (!readWords(MLX90640_RAM_START + readPos, frame.words + readPos, count)) {
+                readState = READ_IDLE;
+                busError = true;
+                return false;
+            }
+            readPos += count;
+            if (readPos >= MLX90640_RAM_WORDS) {
+                readState = READ_FINISH;
+            }
+        } else {
+            // Release the subpage only once all of it is in the frame
+            readState = READ_IDLE;
+            if (!readWords(MLX90640_REG_CONTROL, &frame.words[832], 1) ||
+                !writeWord(MLX90640_REG_STATUS, MLX90640_STATUS_CLEAR)) {
+                busError = true;
+                return false;
+            }
+            frame.words[833] = readSubpage;
+            if (!validFrame(frame)) {
+                busError = true;
+                return false;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MLX90640Driver::readFrame(MLX90640Frame& frame, uint32_t timeoutMs) {
+    unsigned long start = millis();
+    while (millis() - start < timeoutMs) {
+        if (pollFrame(frame)) {
+            return true;
+        }
+        if (busError) {
+#if POCKETOS_MLX90640_ENABLE_LOGGING
+            Logger::error("MLX90640: Frame read failed");
+#endif
+            return false;
+        }
+        if (readState == READ_IDLE) {
+            delay(1);
+        }
+    }
+    return false;
+}
+
+void MLX90640Driver::compensate(const MLX90640Frame& frame, int16_t* centiDegrees) const {
+    calib.compensate(frame, emissivity, centiDegrees);
+}
+
+void MLX90640Driver::compensateFloat(const MLX90640Frame& frame, float* degrees) const {
+    calib.compensateFloat(frame, emissivity, degrees);
+}
+
 MLX90640Data MLX90640Driver::readData() {
-    MLX90640Data data;
-    
     if (!initialized) {
+        return MLX90640Data();
+    }
+
+    if (!frameBuf) {
+        frameBuf = (MLX90640Frame*)malloc(sizeof(MLX90640Frame));
+        imageBuf = (int16_t*)calloc(MLX90640_PIXELS, sizeof(int16_t));
+        if (!frameBuf || !imageBuf) {
+            free(frameBuf);
+            free(imageBuf);
+            frameBuf = nullptr;
+            imageBuf = nullptr;
+#if POCKETOS_MLX90640_ENABLE_LOGGING
+            Logger::error("MLX90640: Out of memory");
+#endif
+            return MLX90640Data();
+        }
+    }
+
+    if (!pollFrame(*frameBuf)) {
+        // No new subpage yet: the last summary stays current
+        MLX90640Data data = last;
+        data.valid = !busError && image() != nullptr;
         return data;
     }
-    
-    data.valid = true;
-    return data;
-}
 
-CapabilitySchema MLX90640Driver::getSchema() const {
-    CapabilitySchema schema;
-    schema.tier = POCKETOS_MLX90640_TIER_NAME;
-    return schema;
+    calib.compensate(*frameBuf, emissivity, imageBuf);
+    subpagesSeen |= (uint8_t)(1 << frameBuf->subpage());
+    frames++;
+
+    int16_t lo = imageBuf[0];
+    int16_t hi = imageBuf[0];
+    for (uint16_t p = 1; p < MLX90640_PIXELS; p++) {
+        if (imageBuf[p] < lo) lo = imageBuf[p];
+        if (imageBuf[p] > hi) hi = imageBuf[p];
+    }
+    // Centre = mean of the four middle pixels
+    const uint16_t c = (MLX90640_ROWS / 2 - 1) * MLX90640_COLUMNS + MLX90640_COLUMNS / 2 - 1;
+    int32_t center = (int32_t)imageBuf[c] + imageBuf[c + 1] +
+                     imageBuf[c + MLX90640_COLUMNS] + imageBuf[c + MLX90640_COLUMNS + 1];
+
+    last.ambient = calib.ambient(*frameBuf);
+    last.minTemp = lo / 100.0f;
+    last.maxTemp = hi / 100.0f;
+    last.centerTemp = center / 400.0f;
+    last.subpage = frameBuf->subpage();
+    last.valid = image() != nullptr;
+    return last;
 }
+#endif
 
-bool MLX90640Driver::writeRegister(uint8_t reg, uint8_t value) {
-    Wire.beginTransmission(address);
-    Wire.write(reg);
-    Wire.write(value);
-    return Wire.endTransmission() == 0;
+bool MLX90640Driver::applyRefreshCode(uint8_t code) {
+    uint16_t control;
+    if (!readWords(MLX90640_REG_CONTROL, &control, 1)) {
+        return false;
+    }
+    control = (uint16_t)((control & ~MLX90640_CONTROL_RATE_MASK) |
+                         ((uint16_t)code << MLX90640_CONTROL_RATE_SHIFT));
+    if (!writeWord(MLX90640_REG_CONTROL, control)) {
+        return false;
+    }
+    refreshCode = code;
+    return true;
 }
 
-bool MLX90640Driver::readRegister(uint8_t reg, uint8_t* value) {
-    Wire.beginTransmission(address);
-    Wire.write(reg);
-    if (Wire.endTransmission() != 0) {
+#if POCKETOS_MLX90640_ENABLE_CONFIGURATION
+bool MLX90640Driver::setRefreshRate(float hz) {
+    uint8_t code;
+    if (!initialized || !refreshCodeFor(hz, &code)) {
         return false;
     }
-    
-    Wire.requestFrom(address, (uint8_t)1);
-    if (Wire.available()) {
-        *value = Wire.read();
+    return applyRefreshCode(code);
+}
+
+float MLX90640Driver::getRefreshRate() const {
+    return 0.5f * (float)(1 << refreshCode);
+}
+
+void MLX90640Driver::setEmissivity(float value) {
+    if (value < 0.1f) value = 0.1f;
+    if (value > 1.0f) value = 1.0f;
+    emissivity = value;
+}
+
+String MLX90640Driver::getParameter(const String& name) {
+    if (name == "refresh_hz") {
+        return String(getRefreshRate(), 1);
+    } else if (name == "emissivity") {
+        return String(emissivity, 2);
+    } else if (name == "bad_pixels") {
+        return String(calib.badPixelCount());
+    }
+#if POCKETOS_MLX90640_ENABLE_BASIC_READ
+    if (name == "frames") {
+        return String(frames);
+    } else if (name == "ambient") {
+        return String(last.ambient, 2);
+    } else if (name == "min") {
+        return String(last.minTemp, 2);
+    } else if (name == "max") {
+        return String(last.maxTemp, 2);
+    } else if (name == "center") {
+        return String(last.centerTemp, 2);
+    }
+#endif
+    return "";
+}
+
+bool MLX90640Driver::setParameter(const String& name, const String& value) {
+    if (name == "refresh_hz") {
+        return setRefreshRate(value.toFloat());
+    } else if (name == "emissivity") {
+        float e = value.toFloat();
+        if (e < 0.1f || e > 1.0f) {
+            return false;
+        }
+        setEmissivity(e);
         return true;
     }
     return false;
 }
+#endif
+
+CapabilitySchema MLX90640Driver::getSchema() const {
+    CapabilitySchema schema;
+
+#if POCKETOS_MLX90640_ENABLE_BASIC_READ
+    schema.addSignal("ambient", ParamType::FLOAT, false, "C");
+    schema.addSignal("min", ParamType::FLOAT, false, "C");
+    schema.addSignal("max", ParamType::FLOAT, false, "C");
+    schema.addSignal("center", ParamType::FLOAT, false, "C");
+    schema.addSignal("frames", ParamType::COUNTER, false, "");
+    schema.addSignal("image", ParamType::BLOB, false, "0.01C");
+#endif
+#if POCKETOS_MLX90640_ENABLE_CONFIGURATION
+    schema.addSetting("refresh_hz", ParamType::FLOAT, true, 0.5f, 64.0f, 0, "Hz");
+    schema.addSetting("emissivity", ParamType::FLOAT, true, 0.1f, 1.0f, 0.01f, "");
+    schema.addSetting("bad_pixels", ParamType::INT, false, 0, 0, 0, "");
+#endif
+
+    return schema;
+}
+
+bool MLX90640Driver::validFrame(const MLX90640Frame& frame) const {
+    // 0x7FFF in the auxiliary block marks a partially written subpage
+    static const uint16_t aux[] = { 768, 776, 778, 800, 808, 810 };
+    for (size_t i = 0; i < sizeof(aux) / sizeof(aux[0]); i++) {
+        if (frame.words[aux[i]] == 0x7FFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MLX90640Driver::readWords(uint16_t reg, uint16_t* out, size_t count) {
+    while (count > 0) {
+        size_t words = count > MLX90640_CHUNK_WORDS ? MLX90640_CHUNK_WORDS : count;
+        uint8_t bytes = (uint8_t)(words * 2);
+
+        Wire.beginTransmission(address);
+        Wire.write((uint8_t)(reg >> 8));
+        Wire.write((uint8_t)(reg & 0xFF));
+        if (Wire.endTransmission(false) != 0) {
+            return false;
+        }
+        if (Wire.requestFrom(address, bytes) != bytes) {
+            return false;
+        }
+        for (size_t i = 0; i < words; i++) {
+            uint8_t hi = Wire.read();
+            uint8_t lo = Wire.read();
+            out[i] = (uint16_t)((hi << 8) | lo);
+        }
+
+        reg += (uint16_t)words;
+        out += words;
+        count -= words;
+    }
+    return true;
+}
+
+bool MLX90640Driver::writeWord(uint16_t reg, uint16_t value) {
+    Wire.beginTransmission(address);
+    Wire.write((uint8_t)(reg >> 8));
+    Wire.write((uint8_t)(reg & 0xFF));
+    Wire.write((uint8_t)(value >> 8));
+    Wire.write((uint8_t)(value & 0xFF));
+    return Wire.endTransmission() == 0;
+}
 
 #if POCKETOS_MLX90640_ENABLE_REGISTER_ACCESS
 const RegisterDesc* MLX90640Driver::registers(size_t& count) const {
@@ -94,29 +406,35 @@ const RegisterDesc* MLX90640Driver::registers(size_t& count) const {
 }
 
 bool MLX90640Driver::regRead(uint16_t reg, uint8_t* buf, size_t len) {
-    if (!initialized || reg > 0xFF || len != 1) {
+    if (!initialized || len != 2) {
         return false;
     }
-    
+
     const RegisterDesc* regDesc = RegisterUtils::findByAddr(MLX90640_REGISTERS, MLX90640_REGISTER_COUNT, reg);
     if (!regDesc || !RegisterUtils::isReadable(regDesc->access)) {
         return false;
     }
-    
-    return readRegister((uint8_t)reg, buf);
+
+    uint16_t value;
+    if (!readWords(reg, &value, 1)) {
+        return false;
+    }
+    buf[0] = (uint8_t)(value >> 8);
+    buf[1] = (uint8_t)(value & 0xFF);
+    return true;
 }
 
 bool MLX90640Driver::regWrite(uint16_t reg, const uint8_t* buf, size_t len) {
-    if (!initialized || reg > 0xFF || len != 1) {
+    if (!initialized || len != 2) {
         return false;
     }
-    
+
     const RegisterDesc* regDesc = RegisterUtils::findByAddr(MLX90640_REGISTERS, MLX90640_REGISTER_COUNT, reg);
     if (!regDesc || !RegisterUtils::isWritable(regDesc->access)) {
         return false;
     }
-    
-    return writeRegister((uint8_t)reg, buf[0]);
+
+    return writeWord(reg, (uint16_t)((buf[0] << 8) | buf[1]));
 }
 
 const RegisterDesc* MLX90640Driver::findRegisterByName(const String& name) const {
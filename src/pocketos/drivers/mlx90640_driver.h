@@ -5,39 +5,118 @@
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
 #include "register_types.h"
+#include "mlx90640_calibration.h"
 
 namespace PocketOS {
 
 #define MLX90640_ADDR_COUNT 1
 const uint8_t MLX90640_VALID_ADDRESSES[MLX90640_ADDR_COUNT] = { 0x33 };
 
+// Bytes per I2C read transaction (must fit the Wire receive buffer)
+// Can be overridden via build flags: -DPOCKETOS_MLX90640_I2C_CHUNK=64
+#ifndef POCKETOS_MLX90640_I2C_CHUNK
+#define POCKETOS_MLX90640_I2C_CHUNK 128
+#endif
+
+// Read transactions per pollFrame() call (bounds the time spent per loop)
+#ifndef POCKETOS_MLX90640_CHUNKS_PER_POLL
+#define POCKETOS_MLX90640_CHUNKS_PER_POLL 4
+#endif
+
+// Subpage refresh rate set by init() (0.5, 1, 2, 4, 8, 16, 32, 64 Hz)
+#ifndef POCKETOS_MLX90640_DEFAULT_REFRESH_HZ
+#define POCKETOS_MLX90640_DEFAULT_REFRESH_HZ 8
+#endif
+
+#if POCKETOS_MLX90640_I2C_CHUNK < 2 || POCKETOS_MLX90640_I2C_CHUNK > 254
+#error "POCKETOS_MLX90640_I2C_CHUNK must be 2-254 bytes"
+#endif
+
+// Summary of the latest image (the image itself is read via image())
 struct MLX90640Data {
-    float temperatures[768];  // 32x24 thermal array
+    float ambient;      // Sensor die temperature, degC
+    float minTemp;
+    float maxTemp;
+    float centerTemp;
+    uint8_t subpage;    // Subpage that was just merged into the image
     bool valid;
-    
-    MLX90640Data() : valid(false) { memset(temperatures, 0, sizeof(temperatures)); }
+
+    MLX90640Data() : ambient(0), minTemp(0), maxTemp(0), centerTemp(0), subpage(0), valid(false) {}
 };
 
+/**
+ * MLX90640 32x24 IR Thermal Camera
+ *
+ * init() reads the EEPROM once and extracts the calibration into
+ * MLX90640Calibration's per-pixel tables. After that a subpage is
+ * 834 words of RAM + control data, read in POCKETOS_MLX90640_I2C_CHUNK
+ * byte transactions:
+ *
+ *   pollFrame(frame)  - non-blocking: checks the data-ready flag, then
+ *                       advances the read by up to CHUNKS_PER_POLL
+ *                       transactions per call; true once frame is complete
+ *                       (pass the same frame until then)
+ *   readFrame(frame)  - blocking helper built on pollFrame()
+ *   compensate*()     - temperatures for the frame's subpage
+ *
+ * Frames and images are caller-owned. readData() (DeviceRegistry polling)
+ * runs the same pipeline on buffers the driver allocates on first use and
+ * keeps a 0.01 degC image current at the subpage rate.
+ *
+ * RAM overwrite is disabled, so the sensor holds a subpage until its
+ * data-ready flag is cleared after the last chunk; a slow reader drops
+ * subpages instead of mixing two of them.
+ */
 class MLX90640Driver {
 public:
     MLX90640Driver();
-    
+    ~MLX90640Driver();
+
     bool init(uint8_t i2cAddress);
     void deinit();
     bool isInitialized() const { return initialized; }
-    
+
+#if POCKETOS_MLX90640_ENABLE_BASIC_READ
+    // Caller-owned frame pipeline
+    bool pollFrame(MLX90640Frame& frame);
+    bool readFrame(MLX90640Frame& frame, uint32_t timeoutMs = 1000);
+
+    // Object temperatures for the frame's subpage into a 768-entry image
+    void compensate(const MLX90640Frame& frame, int16_t* centiDegrees) const;
+    void compensateFloat(const MLX90640Frame& frame, float* degrees) const;
+
+    const MLX90640Calibration& calibration() const { return calib; }
+
+    // Registry path: advance the read into driver-owned buffers
     MLX90640Data readData();
+
+    // Latest image (0.01 degC, row-major 32x24); nullptr until both
+    // subpages have been read
+    const int16_t* image() const { return subpagesSeen == 0x03 ? imageBuf : nullptr; }
+    uint32_t frameCount() const { return frames; }
+#endif
+
+#if POCKETOS_MLX90640_ENABLE_CONFIGURATION
+    bool setRefreshRate(float hz);
+    float getRefreshRate() const;
+    void setEmissivity(float value);
+    float getEmissivity() const { return emissivity; }
+
+    String getParameter(const String& name);
+    bool setParameter(const String& name, const String& value);
+#endif
+
     CapabilitySchema getSchema() const;
-    
+
     uint8_t getAddress() const { return address; }
     String getDriverId() const { return "mlx90640"; }
     String getDriverTier() const { return POCKETOS_MLX90640_TIER_NAME; }
-    
+
     static const uint8_t* validAddresses(size_t& count) {
         count = MLX90640_ADDR_COUNT;
         return MLX90640_VALID_ADDRESSES;
     }
-    
+
     static bool supportsAddress(uint8_t addr) {
         for (size_t i = 0; i < MLX90640_ADDR_COUNT; i++) {
             if (MLX90640_VALID_ADDRESSES[i] == addr) {
@@ -46,20 +125,41 @@ public:
         }
         return false;
     }
-    
+
 #if POCKETOS_MLX90640_ENABLE_REGISTER_ACCESS
     const RegisterDesc* registers(size_t& count) const;
     bool regRead(uint16_t reg, uint8_t* buf, size_t len);
     bool regWrite(uint16_t reg, const uint8_t* buf, size_t len);
     const RegisterDesc* findRegisterByName(const String& name) const;
 #endif
-    
+
 private:
     uint8_t address;
     bool initialized;
-    
-    bool writeRegister(uint8_t reg, uint8_t value);
-    bool readRegister(uint8_t reg, uint8_t* value);
+    MLX90640Calibration calib;
+    float emissivity;
+    uint8_t refreshCode;
+
+    // Chunked read state: readPos is the next RAM word to read
+    enum ReadState : uint8_t { READ_IDLE, READ_RAM, READ_FINISH };
+    ReadState readState;
+    uint16_t readPos;
+    uint8_t readSubpage;
+    bool busError;
+
+#if POCKETOS_MLX90640_ENABLE_BASIC_READ
+    // Registry path buffers, allocated on the first readData()
+    MLX90640Frame* frameBuf;
+    int16_t* imageBuf;
+    uint8_t subpagesSeen;
+    uint32_t frames;
+    MLX90640Data last;
+#endif
+
+    bool readWords(uint16_t reg, uint16_t* out, size_t count);
+    bool writeWord(uint16_t reg, uint16_t value);
+    bool applyRefreshCode(uint8_t code);
+    bool validFrame(const MLX90640Frame& frame) const;
 };
 
 } // namespace PocketOS
@@ -0,0 +1,162 @@
+#include "mono_framebuffer.h"
+#include <stdlib.h>
+
+namespace PocketOS {
+
+MonoFramebuffer::MonoFramebuffer()
+    : buffer_(nullptr), width_(0), height_(0), pages_(0) {
+    for (uint8_t p = 0; p < MONO_FB_MAX_PAGES; p++) {
+        markClean(p);
+    }
+}
+
+MonoFramebuffer::~MonoFramebuffer() {
+    end();
+}
+
+bool MonoFramebuffer::begin(uint8_t width, uint8_t height) {
+    end();
+    if (width == 0 || width > MONO_FB_MAX_WIDTH || height == 0 || (height & 7) ||
+        height / 8 > MONO_FB_MAX_PAGES) {
+        return false;
+    }
+
+    buffer_ = (uint8_t*)calloc((size_t)width * (height / 8), 1);
+    if (!buffer_) {
+        return false;
+    }
+    width_ = width;
+    height_ = height;
+    pages_ = height / 8;
+
+    // GDDRAM content is unknown after reset: first flush sends everything
+    markAllDirty();
+    return true;
+}
+
+void MonoFramebuffer::end() {
+    free(buffer_);
+    buffer_ = nullptr;
+    width_ = 0;
+    height_ = 0;
+    pages_ = 0;
+}
+
+void MonoFramebuffer::updateByte(uint8_t page, uint8_t col, uint8_t mask, bool on) {
+    uint8_t* b = buffer_ + (size_t)page * width_ + col;
+    uint8_t next = on ? (uint8_t)(*b | mask) : (uint8_t)(*b & ~mask);
+    if (next == *b) {
+        return;
+    }
+    *b = next;
+    if (col < dirtyLo_[page]) dirtyLo_[page] = col;
+    if (col > dirtyHi_[page]) dirtyHi_[page] = col;
+}
+
+void MonoFramebuffer::setPixel(uint16_t x, uint16_t y, bool on) {
+    if (!buffer_ || x >= width_ || y >= height_) {
+        return;
+    }
+    updateByte((uint8_t)(y >> 3), (uint8_t)x, (uint8_t)(1 << (y & 7)), on);
+}
+
+bool MonoFramebuffer::getPixel(uint16_t x, uint16_t y) const {
+    if (!buffer_ || x >= width_ || y >= height_) {
+        return false;
+    }
+    return (buffer_[(size_t)(y >> 3) * width_ + x] >> (y & 7)) & 1;
+}
+
+void MonoFramebuffer::clear() {
+    fillRect(0, 0, width_, height_, 0);
+}
+
+void MonoFramebuffer::fillSpan(uint16_t x, uint16_t y, uint16_t w, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+}
+
+void MonoFramebuffer::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    if (!buffer_ || x >= width_ || y >= height_ || w == 0 || h == 0) {
+        return;
+    }
+    uint16_t x1 = (x + w > width_) ? width_ : x + w;
+    uint16_t y1 = (y + h > height_) ? height_ : y + h;
+    bool on = color != 0;
+
+    // One byte mask per page covers up to 8 rows at once
+    for (uint16_t page = y >> 3; page <= (uint16_t)((y1 - 1) >> 3); page++) {
+        uint16_t top = page * 8;
+        uint8_t first = (y > top) ? (uint8_t)(y - top) : 0;
+        uint8_t last = (y1 < top + 8) ? (uint8_t)(y1 - top - 1) : 7;
+        uint8_t mask = (uint8_t)((0xFF << first) & (0xFF >> (7 - last)));
+        for (uint16_t col = x; col < x1; col++) {
+            updateByte((uint8_t)page, (uint8_t)col, mask, on);
+        }
+    }
+}
+
+void MonoFramebuffer::writeRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                                const uint16_t* pixels, size_t stride) {
+    for (uint16_t r = 0; r < h; r++) {
+        const uint16_t* row = pixels + (size_t)r * stride;
+        for (uint16_t c = 0; c < w; c++) {
+            setPixel(x + c, y + r, row[c] != 0);
+        }
+    }
+}
+
+bool MonoFramebuffer::hasDirty() const {
+    for (uint8_t p = 0; p < pages_; p++) {
+        if (pageDirty(p)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MonoFramebuffer::markAllDirty() {
+    for (uint8_t p = 0; p < pages_; p++) {
+        dirtyLo_[p] = 0;
+        dirtyHi_[p] = width_ ? width_ - 1 : 0;
+    }
+}
+
+bool MonoFramebuffer::nextWindow(MonoWindow& window) {
+    if (!buffer_) {
+        return false;
+    }
+
+    for (uint8_t p = 0; p < pages_; p++) {
+        if (!pageDirty(p)) {
+            continue;
+        }
+
+        window.col0 = dirtyLo_[p];
+        window.col1 = dirtyHi_[p];
+        window.page0 = p;
+        window.page1 = p;
+        markClean(p);
+
+        // Grow downwards while one window is cheaper than two
+        while (window.page1 + 1 < pages_ && pageDirty(window.page1 + 1)) {
+            uint8_t q = window.page1 + 1;
+            uint8_t lo = dirtyLo_[q] < window.col0 ? dirtyLo_[q] : window.col0;
+            uint8_t hi = dirtyHi_[q] > window.col1 ? dirtyHi_[q] : window.col1;
+            uint32_t rows = window.page1 - window.page0 + 1;
+            uint32_t merged = (rows + 1) * (uint32_t)(hi - lo + 1);
+            uint32_t separate = rows * (uint32_t)(window.col1 - window.col0 + 1) +
+                                (uint32_t)(dirtyHi_[q] - dirtyLo_[q] + 1) + MONO_FB_MERGE_SLACK;
+            if (merged > separate) {
+                break;
+            }
+            window.col0 = lo;
+            window.col1 = hi;
+            window.page1 = q;
+            markClean(q);
+        }
+        return true;
+    }
+    return false;
+}
+
+} // namespace PocketOS
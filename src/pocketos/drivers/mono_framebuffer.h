@@ -0,0 +1,94 @@
+#ifndef POCKETOS_MONO_FRAMEBUFFER_H
+#define POCKETOS_MONO_FRAMEBUFFER_H
+
+#include "gfx_panel.h"
+
+namespace PocketOS {
+
+/**
+ * Monochrome Framebuffer - 1bpp page layout with dirty tracking
+ *
+ * Shared by the SSD1306 and SSD1309 drivers. The buffer matches GDDRAM:
+ * one byte per column per 8-row page, bit 0 at the top. Each page keeps
+ * the column range that changed since the last flush; writes that leave
+ * a byte unchanged do not dirty it, so redrawing a whole screen where a
+ * few digits changed only marks those digits.
+ *
+ * nextWindow() hands out the dirty regions as (column range, page range)
+ * windows. Neighbouring dirty pages are merged into one window when
+ * resending the extra columns is cheaper than another window setup.
+ *
+ * Also an IGfxPanel, so GfxRenderer can draw on it: any non-zero colour
+ * sets a pixel, zero clears it (spans, rectangles, images and glyphs).
+ */
+
+// Largest supported panel (SSD1306/SSD1309 GDDRAM)
+#define MONO_FB_MAX_WIDTH 128
+#define MONO_FB_MAX_PAGES 8
+
+// Bytes a merged window may resend and still beat another window setup
+// (one command transaction: control byte + 6 command bytes + address)
+#define MONO_FB_MERGE_SLACK 8
+
+// Dirty region in GDDRAM coordinates (inclusive)
+struct MonoWindow {
+    uint8_t col0;
+    uint8_t col1;
+    uint8_t page0;
+    uint8_t page1;
+};
+
+class MonoFramebuffer : public IGfxPanel {
+public:
+    MonoFramebuffer();
+    ~MonoFramebuffer();
+
+    // height must be a multiple of 8 (32 or 64 for SSD130x)
+    bool begin(uint8_t width, uint8_t height);
+    void end();
+    bool isValid() const { return buffer_ != nullptr; }
+
+    virtual uint16_t width() const override { return width_; }
+    virtual uint16_t height() const override { return height_; }
+    uint8_t pages() const { return pages_; }
+
+    // Drawing (clipped)
+    void setPixel(uint16_t x, uint16_t y, bool on);
+    bool getPixel(uint16_t x, uint16_t y) const;
+    void clear();
+
+    // IGfxPanel
+    virtual void fillSpan(uint16_t x, uint16_t y, uint16_t w, uint16_t color) override;
+    virtual void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) override;
+    virtual void writeRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                           const uint16_t* pixels, size_t stride) override;
+
+    // Dirty tracking
+    bool hasDirty() const;
+    void markAllDirty();
+
+    // Next dirty window; its pages are marked clean
+    bool nextWindow(MonoWindow& window);
+
+    // Start of a page row in GDDRAM layout
+    const uint8_t* pageData(uint8_t page) const { return buffer_ + (size_t)page * width_; }
+
+private:
+    uint8_t* buffer_;
+    uint8_t width_;
+    uint8_t height_;
+    uint8_t pages_;
+
+    // Per page dirty column range; dirtyLo_ > dirtyHi_ means clean
+    uint8_t dirtyLo_[MONO_FB_MAX_PAGES];
+    uint8_t dirtyHi_[MONO_FB_MAX_PAGES];
+
+    // Set bits of mask in one byte to on/off, tracking the change
+    void updateByte(uint8_t page, uint8_t col, uint8_t mask, bool on);
+    bool pageDirty(uint8_t page) const { return dirtyLo_[page] <= dirtyHi_[page]; }
+    void markClean(uint8_t page) { dirtyLo_[page] = 0xFF; dirtyHi_[page] = 0; }
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_MONO_FRAMEBUFFER_H
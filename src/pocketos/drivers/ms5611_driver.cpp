@@ -55,31 +55,16 @@ MS5611Data MS5611Driver::readData() {
     
     if (D1 == 0 || D2 == 0) return data;
     
-    int32_t dT = D2 - ((int32_t)calibration.c5 << 8);
-    int32_t TEMP = 2000 + (((int64_t)dT * calibration.c6) >> 23);
-    
-    int64_t OFF = ((int64_t)calibration.c2 << 16) + (((int64_t)calibration.c4 * dT) >> 7);
-    int64_t SENS = ((int64_t)calibration.c1 << 15) + (((int64_t)calibration.c3 * dT) >> 8);
-    
-    if (TEMP < 2000) {
-        int32_t T2 = ((int64_t)dT * dT) >> 31;
-        int64_t OFF2 = (5 * (TEMP - 2000) * (TEMP - 2000)) >> 1;
-        int64_t SENS2 = (5 * (TEMP - 2000) * (TEMP - 2000)) >> 2;
-        
-        if (TEMP < -1500) {
-            OFF2 += 7 * (TEMP + 1500) * (TEMP + 1500);
-            SENS2 += (11 * (TEMP + 1500) * (TEMP + 1500)) >> 1;
-        }
-        
-        TEMP -= T2;
-        OFF -= OFF2;
-        SENS -= SENS2;
-    }
-    
-    int32_t P = (((D1 * SENS) >> 21) - OFF) >> 15;
-    
-    data.temperature = TEMP / 100.0f;
-    data.pressure = P / 100.0f;
+#if POCKETOS_MS5611_FLOAT_COMPENSATION
+    float pressure;
+    BaroCompensation::ms5611Float(calibration, D1, D2, data.temperature, pressure);
+    data.pressure = pressure * 0.01f;  // Pa -> hPa
+#else
+    int32_t temperature, pressure;
+    BaroCompensation::ms5611(calibration, D1, D2, temperature, pressure);
+    data.temperature = temperature * 0.01f;
+    data.pressure = pressure * 0.01f;  // Pa -> hPa
+#endif
     data.valid = true;
     
     return data;
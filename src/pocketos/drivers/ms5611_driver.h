@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "baro_compensation.h"
 
 #if POCKETOS_MS5611_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
@@ -15,16 +16,6 @@ namespace PocketOS {
 #define MS5611_ADDR_COUNT 1
 const uint8_t MS5611_VALID_ADDRESSES[MS5611_ADDR_COUNT] = { 0x77 };
 
-// MS5611 calibration data structure
-struct MS5611CalibrationData {
-    uint16_t c1;  // Pressure sensitivity
-    uint16_t c2;  // Pressure offset
-    uint16_t c3;  // Temperature coefficient of pressure sensitivity
-    uint16_t c4;  // Temperature coefficient of pressure offset
-    uint16_t c5;  // Reference temperature
-    uint16_t c6;  // Temperature coefficient of the temperature
-};
-
 // MS5611 measurement data
 struct MS5611Data {
     float temperature;  // Celsius
@@ -18,6 +18,7 @@ namespace PocketOS {
 #define MS8607_HUM_NO_HOLD  0xF5
 
 MS8607Driver::MS8607Driver() : address(0), initialized(false) {
+    memset(&calibration, 0, sizeof(calibration));
 }
 
 bool MS8607Driver::init(uint8_t i2cAddress) {
@@ -39,6 +40,13 @@ bool MS8607Driver::init(uint8_t i2cAddress) {
     }
     delay(10);
     
+    if (!readCalibrationData()) {
+#if POCKETOS_MS8607_ENABLE_LOGGING
+        Logger::error("MS8607: Failed to read calibration");
+#endif
+        return false;
+    }
+    
     initialized = true;
 #if POCKETOS_MS8607_ENABLE_LOGGING
     Logger::info("MS8607: Initialized");
@@ -54,31 +62,31 @@ MS8607Data MS8607Driver::readData() {
     MS8607Data data;
     if (!initialized) return data;
     
-    sendCommand(MS8607_ADDR_PT, MS8607_CMD_CONV_D2);
-    delay(10);
-    uint8_t temp_buf[3];
-    if (readData(MS8607_ADDR_PT, temp_buf, 3)) {
-        uint32_t D2 = ((uint32_t)temp_buf[0] << 16) | ((uint32_t)temp_buf[1] << 8) | temp_buf[2];
-        data.temperature = (D2 / 524288.0f) - 40.0f;
-    }
+    uint32_t D2 = 0;
+    uint32_t D1 = 0;
+    if (!readADC(MS8607_CMD_CONV_D2, &D2) || !readADC(MS8607_CMD_CONV_D1, &D1)) return data;
     
-    sendCommand(MS8607_ADDR_PT, MS8607_CMD_CONV_D1);
-    delay(10);
-    uint8_t press_buf[3];
-    if (readData(MS8607_ADDR_PT, press_buf, 3)) {
-        uint32_t D1 = ((uint32_t)press_buf[0] << 16) | ((uint32_t)press_buf[1] << 8) | press_buf[2];
-        data.pressure = D1 / 4096.0f;
-    }
+#if POCKETOS_MS8607_FLOAT_COMPENSATION
+    float pressure;
+    BaroCompensation::ms8607Float(calibration, D1, D2, data.temperature, pressure);
+    data.pressure = pressure * 0.01f;  // Pa -> hPa
+#else
+    int32_t temperature, pressure;
+    BaroCompensation::ms8607(calibration, D1, D2, temperature, pressure);
+    data.temperature = temperature * 0.01f;
+    data.pressure = pressure * 0.01f;  // Pa -> hPa
+#endif
     
     sendCommand(MS8607_ADDR_HUM, MS8607_HUM_NO_HOLD);
     delay(20);
     uint8_t hum_buf[3];
     if (readData(MS8607_ADDR_HUM, hum_buf, 3)) {
-        uint16_t raw_hum = ((uint16_t)hum_buf[0] << 8) | hum_buf[1];
-        raw_hum &= 0xFFFC;
-        data.humidity = ((125.0f * raw_hum) / 65536.0f) - 6.0f;
-        if (data.humidity < 0) data.humidity = 0;
-        if (data.humidity > 100) data.humidity = 100;
+        uint16_t D3 = ((uint16_t)hum_buf[0] << 8) | hum_buf[1];
+#if POCKETOS_MS8607_FLOAT_COMPENSATION
+        data.humidity = BaroCompensation::ms8607HumidityFloat(D3, data.temperature);
+#else
+        data.humidity = BaroCompensation::ms8607Humidity(D3, temperature) * 0.01f;
+#endif
     }
     
     data.valid = true;
@@ -123,6 +131,31 @@ bool MS8607Driver::readData(uint8_t addr, uint8_t* buffer, size_t len) {
     return (count == len);
 }
 
+bool MS8607Driver::readADC(uint8_t cmd, uint32_t* value) {
+    if (!sendCommand(MS8607_ADDR_PT, cmd)) return false;
+    delay(10);
+    if (!sendCommand(MS8607_ADDR_PT, MS8607_CMD_ADC_READ)) return false;
+    uint8_t buffer[3];
+    if (!readData(MS8607_ADDR_PT, buffer, 3)) return false;
+    *value = ((uint32_t)buffer[0] << 16) | ((uint32_t)buffer[1] << 8) | buffer[2];
+    return *value != 0;
+}
+
+bool MS8607Driver::readCalibrationData() {
+    // PROM words 1-6 hold C1-C6 (word 0 is CRC and factory data)
+    uint16_t* coefficients[6] = {
+        &calibration.c1, &calibration.c2, &calibration.c3,
+        &calibration.c4, &calibration.c5, &calibration.c6
+    };
+    for (uint8_t i = 0; i < 6; i++) {
+        if (!sendCommand(MS8607_ADDR_PT, MS8607_CMD_PROM + (i + 1) * 2)) return false;
+        uint8_t buffer[2];
+        if (!readData(MS8607_ADDR_PT, buffer, 2)) return false;
+        *coefficients[i] = ((uint16_t)buffer[0] << 8) | buffer[1];
+    }
+    return true;
+}
+
 #if POCKETOS_MS8607_ENABLE_REGISTER_ACCESS
 const RegisterDesc* MS8607Driver::registers(size_t& count) const {
     static const RegisterDesc MS8607_REGISTERS[] = {
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "baro_compensation.h"
 
 #if POCKETOS_MS8607_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
@@ -76,10 +77,15 @@ public:
 private:
     uint8_t address;
     bool initialized;
+    MS8607CalibrationData calibration;
     
     // I2C communication
     bool sendCommand(uint8_t addr, uint8_t cmd);
     bool readData(uint8_t addr, uint8_t* buffer, size_t len);
+    bool readADC(uint8_t cmd, uint32_t* value);
+    
+    // Calibration (pressure/temperature PROM)
+    bool readCalibrationData();
 };
 
 } // namespace PocketOS
@@ -1,6 +1,7 @@
 #include "nrf24l01_driver.h"
 #include "../core/logger.h"
 #include "../core/resource_manager.h"
+#include "../core/system_clock.h"
 #include <SPI.h>
 
 namespace PocketOS {
@@ -8,13 +9,60 @@ namespace PocketOS {
 // nRF24L01+ Commands
 #define NRF24_CMD_R_REGISTER    0x00
 #define NRF24_CMD_W_REGISTER    0x20
+#define NRF24_CMD_ACTIVATE      0x50    // Followed by 0x73 (nRF24L01 without +)
+#define NRF24_CMD_R_RX_PL_WID   0x60
 #define NRF24_CMD_R_RX_PAYLOAD  0x61
 #define NRF24_CMD_W_TX_PAYLOAD  0xA0
+#define NRF24_CMD_W_ACK_PAYLOAD 0xA8    // | pipe
 #define NRF24_CMD_FLUSH_TX      0xE1
 #define NRF24_CMD_FLUSH_RX      0xE2
 #define NRF24_CMD_REUSE_TX_PL   0xE3
 #define NRF24_CMD_NOP           0xFF
 
+// Registers
+#define NRF24_REG_CONFIG        0x00
+#define NRF24_REG_EN_AA         0x01
+#define NRF24_REG_EN_RXADDR     0x02
+#define NRF24_REG_SETUP_RETR    0x04
+#define NRF24_REG_RF_CH         0x05
+#define NRF24_REG_RF_SETUP      0x06
+#define NRF24_REG_STATUS        0x07
+#define NRF24_REG_OBSERVE_TX    0x08
+#define NRF24_REG_RX_ADDR_P0    0x0A
+#define NRF24_REG_TX_ADDR       0x10
+#define NRF24_REG_FIFO_STATUS   0x17
+#define NRF24_REG_DYNPD         0x1C
+#define NRF24_REG_FEATURE       0x1D
+
+// CONFIG: TX_DS is masked off the IRQ pin; streaming polls it
+#define NRF24_CONFIG_PRIM_RX    0x01
+#define NRF24_CONFIG_PWR_UP     0x02
+#define NRF24_CONFIG_DEFAULT    0x2D    // MASK_TX_DS | EN_CRC | CRCO (16-bit) | PWR_UP
+
+// STATUS
+#define NRF24_STATUS_RX_DR      0x40
+#define NRF24_STATUS_TX_DS      0x20
+#define NRF24_STATUS_MAX_RT     0x10
+#define NRF24_STATUS_TX_FULL    0x01
+#define NRF24_STATUS_PIPE(s)    (((s) >> 1) & 0x07)    // 6 unused, 7 RX FIFO empty
+
+// FIFO_STATUS
+#define NRF24_FIFO_TX_FULL      0x20
+#define NRF24_FIFO_TX_EMPTY     0x10
+
+// FEATURE: dynamic payload length, ACK payloads, NOACK transmit command
+#define NRF24_FEATURE_ALL       0x07
+
+static const char* NRF24_ROLE_NAMES[] = { "standby", "prx", "ptx" };
+static const char* NRF24_RATE_NAMES[] = { "1M", "2M", "250k" };
+
+static_assert((NRF24_TX_QUEUE_SIZE & (NRF24_TX_QUEUE_SIZE - 1)) == 0 && NRF24_TX_QUEUE_SIZE <= 128,
+              "NRF24_TX_QUEUE_SIZE must be a power of two up to 128");
+static_assert((NRF24_RX_QUEUE_SIZE & (NRF24_RX_QUEUE_SIZE - 1)) == 0 && NRF24_RX_QUEUE_SIZE <= 128,
+              "NRF24_RX_QUEUE_SIZE must be a power of two up to 128");
+static_assert((NRF24_TX_SHADOW & (NRF24_TX_SHADOW - 1)) == 0 && NRF24_TX_SHADOW > NRF24_HW_FIFO_DEPTH,
+              "NRF24_TX_SHADOW must be a power of two above the FIFO depth");
+
 #if POCKETOS_NRF24L01_ENABLE_REGISTER_ACCESS
 // Complete nRF24L01+ Register Map (0x00-0x1D, 30 registers)
 static const RegisterDesc NRF24L01_REGISTERS[] = {
@@ -49,9 +97,24 @@ static const RegisterDesc NRF24L01_REGISTERS[] = {
 #define NRF24L01_REGISTER_COUNT (sizeof(NRF24L01_REGISTERS) / sizeof(RegisterDesc))
 #endif
 
-NRF24L01Driver::NRF24L01Driver() 
-    : initialized_(false), ce_pin_(-1) {
+NRF24L01Driver::NRF24L01Driver()
+    : initialized_(false), ce_pin_(-1), role_(NRF24Role::STANDBY), dataRate_(1), pipe0Tx_(false) {
     setRegisterConvention(SPIRegisterConvention::NRF24);
+    memset(&stats_, 0, sizeof(stats_));
+    memset(txAddr_, 0xE7, sizeof(txAddr_));     // Reset values
+    memset(rxAddrP0_, 0xE7, sizeof(rxAddrP0_));
+#if POCKETOS_NRF24L01_ENABLE_BASIC_READ
+    txHead_ = 0;
+    txTail_ = 0;
+    hwTail_ = 0;
+    hwCount_ = 0;
+    rxHead_ = 0;
+    rxTail_ = 0;
+    streamSliceUs_ = NRF24_STREAM_SLICE_US;
+    rateStartMs_ = 0;
+    rateTxBytes_ = 0;
+    rateRxBytes_ = 0;
+#endif
 }
 
 NRF24L01Driver::~NRF24L01Driver() {
@@ -66,7 +129,7 @@ bool NRF24L01Driver::init(const String& endpoint) {
     if (!initFromEndpoint(endpoint)) {
         return false;
     }
-    
+
     // Parse CE pin from endpoint (required for nRF24L01+)
     int ceIdx = endpoint.indexOf("ce=");
     if (ceIdx < 0) {
@@ -74,7 +137,7 @@ bool NRF24L01Driver::init(const String& endpoint) {
         deinit();
         return false;
     }
-    
+
     // Extract CE pin number
     int commaIdx = endpoint.indexOf(',', ceIdx);
     String cePinStr;
@@ -84,38 +147,65 @@ bool NRF24L01Driver::init(const String& endpoint) {
         cePinStr = endpoint.substring(ceIdx + 3);
     }
     ce_pin_ = cePinStr.toInt();
-    
+
     // Claim CE pin
     if (!ResourceManager::claim(ResourceType::GPIO_PIN, ce_pin_, "nrf24l01_ce")) {
         Logger::error("NRF24L01: Failed to claim CE pin");
         deinit();
         return false;
     }
-    
+
     // Configure CE pin
     pinMode(ce_pin_, OUTPUT);
     setCE(false);
-    
+
     delay(100);  // Power on reset delay
-    
+
     // Verify communication by reading CONFIG register
     uint8_t config;
-    if (!readRegister(0x00, &config, 1)) {
+    if (!readRegister(NRF24_REG_CONFIG, &config, 1)) {
         Logger::error("NRF24L01: Failed to read CONFIG register");
         deinit();
         return false;
     }
-    
-    // Power up and set to RX mode
-    config = 0x0F;  // PWR_UP | PRIM_RX | EN_CRC | CRCO
-    if (!writeRegister(0x00, &config, 1)) {
+
+    // Power up in standby (CE low); the role is set below
+    if (!writeRegister(NRF24_REG_CONFIG, NRF24_CONFIG_DEFAULT)) {
         deinit();
         return false;
     }
-    
+
     delay(5);  // Power up delay
-    
     initialized_ = true;
+
+    // Pipe 0 starts on its reading address, whatever a previous run left
+    writePipe0(false);
+
+    // Dynamic payload length and ACK payloads on every pipe. The
+    // nRF24L01 (without +) ignores FEATURE until ACTIVATE 0x73.
+    writeRegister(NRF24_REG_FEATURE, NRF24_FEATURE_ALL);
+    if (readRegister(NRF24_REG_FEATURE) != NRF24_FEATURE_ALL) {
+        uint8_t activate[2] = { NRF24_CMD_ACTIVATE, 0x73 };
+        spiWrite(activate, 2);
+        writeRegister(NRF24_REG_FEATURE, NRF24_FEATURE_ALL);
+    }
+    writeRegister(NRF24_REG_DYNPD, 0x3F);
+    writeRegister(NRF24_REG_EN_AA, 0x3F);   // DPL requires auto-ack
+
+#if POCKETOS_NRF24L01_ENABLE_BASIC_READ
+    setDataRate(dataRate_);   // Also sets the retransmit delay
+    writeCommand(NRF24_CMD_FLUSH_TX);
+    writeCommand(NRF24_CMD_FLUSH_RX);
+    writeRegister(NRF24_REG_STATUS, NRF24_STATUS_RX_DR | NRF24_STATUS_TX_DS | NRF24_STATUS_MAX_RT);
+
+    // IRQ is active low and stays low until the flags are cleared
+    if (getPinConfig().irq >= 0 && !attachIrq(IrqEdge::FALLING_EDGE, onIrq, this)) {
+        Logger::warning("NRF24L01: IRQ not attached, polling STATUS");
+    }
+    rateStartMs_ = millis();
+    setRole(NRF24Role::PRX);
+#endif
+
     Logger::info("NRF24L01: Initialized successfully");
     return true;
 }
@@ -125,12 +215,12 @@ bool NRF24L01Driver::validEndpoints(const String& endpoint) {
     if (!endpoint.startsWith("spi")) {
         return false;
     }
-    
+
     int colonIdx = endpoint.indexOf(':');
     if (colonIdx < 0) {
         return false;
     }
-    
+
     // Must have CS and CE pins
     return endpoint.indexOf("cs=") > colonIdx && endpoint.indexOf("ce=") > colonIdx;
 }
@@ -140,15 +230,194 @@ bool NRF24L01Driver::identifyProbe(const String& endpoint) {
     if (!driver.init(endpoint)) {
         return false;
     }
-    
+
     // Read CONFIG register
     uint8_t config;
-    if (!driver.readRegister(0x00, &config, 1)) {
+    if (!driver.readRegister(NRF24_REG_CONFIG, &config, 1)) {
         return false;
     }
-    
+
     // CONFIG should have valid bits set
-    return (config & 0x08) != 0;  // Check PWR_UP bit
+    return (config & 0x08) != 0;  // Check EN_CRC bit
+}
+
+void NRF24L01Driver::update() {
+#if POCKETOS_NRF24L01_ENABLE_BASIC_READ
+    if (!initialized_) {
+        return;
+    }
+    // IRQ still low here means an event after the edge was serviced.
+    // Without a pin, read STATUS every pass.
+    if (irqLine() < 0 || digitalRead(getPinConfig().irq) == LOW) {
+        service(SystemClock::nowUs());
+    }
+    stream();
+    updateRates();
+#endif
+}
+
+CapabilitySchema NRF24L01Driver::getSchema() const {
+    CapabilitySchema schema;
+    schema.addSetting("channel", ParamType::INT, true, 0, 125, 1);
+    schema.addSetting("rate", ParamType::STRING, true);
+    schema.addSetting("stream_slice_us", ParamType::INT, true, 0, 100000, 100, "us");
+#if POCKETOS_NRF24L01_ENABLE_ERROR_HANDLING
+    schema.addSetting("tx_addr", ParamType::STRING, true);
+    schema.addSetting("rx_addr1", ParamType::STRING, true);
+#endif
+    schema.addSignal("tx_packets", ParamType::COUNTER, false);
+    schema.addSignal("tx_failed", ParamType::COUNTER, false);
+    schema.addSignal("retransmit_avg", ParamType::FLOAT, false);
+    schema.addSignal("rx_packets", ParamType::COUNTER, false);
+    schema.addSignal("ack_payloads", ParamType::COUNTER, false);
+    schema.addSignal("tx_kbps", ParamType::FLOAT, false, "kbit/s");
+    schema.addSignal("rx_kbps", ParamType::FLOAT, false, "kbit/s");
+    schema.addCommand("nrf.send", "<hex>");
+    schema.addCommand("nrf.ack", "<pipe> <hex>");
+    schema.addCommand("nrf.recv", "[max]");
+    schema.addCommand("nrf.bench", "[packets] [len]");
+    return schema;
+}
+
+#if POCKETOS_NRF24L01_ENABLE_ERROR_HANDLING
+// Addresses are shown and parsed as hex, most significant byte first
+// (the chip takes them LSByte first)
+static String formatAddress(const uint8_t* addr, uint8_t width) {
+    String text = "0x";
+    for (int i = width - 1; i >= 0; i--) {
+        if (addr[i] < 0x10) {
+            text += "0";
+        }
+        text += String(addr[i], HEX);
+    }
+    return text;
+}
+
+static bool parseAddress(const String& value, uint64_t& address) {
+    char* end = nullptr;
+    address = strtoull(value.c_str(), &end, 16);
+    return value.length() > 0 && end && *end == '\0' && address <= 0xFFFFFFFFFFULL;
+}
+#endif
+
+String NRF24L01Driver::getParameter(const String& name) {
+    if (name == "role") {
+        return String(NRF24_ROLE_NAMES[(uint8_t)role_]);
+    } else if (name == "rate") {
+        return String(NRF24_RATE_NAMES[dataRate_]);
+    } else if (name == "tx_packets") {
+        return String(stats_.txPackets);
+    } else if (name == "tx_bytes") {
+        return String(stats_.txBytes);
+    } else if (name == "tx_failed") {
+        return String(stats_.txFailed);
+    } else if (name == "retransmit_avg") {
+        return String(stats_.arcSamples ? (float)stats_.arcSum / stats_.arcSamples : 0.0f, 2);
+    } else if (name == "retransmit_max") {
+        return String(stats_.arcMax);
+    } else if (name == "rx_packets") {
+        return String(stats_.rxPackets);
+    } else if (name == "rx_bytes") {
+        return String(stats_.rxBytes);
+    } else if (name == "rx_drops") {
+        return String(stats_.rxDrops);
+    } else if (name == "ack_payloads") {
+        return String(stats_.ackPayloads);
+    } else if (name == "ack_sent") {
+        return String(stats_.ackSent);
+    } else if (name == "irq_events") {
+        return String(stats_.irqEvents);
+    } else if (name == "tx_kbps") {
+        return String(stats_.txBps * 8 / 1000.0f, 1);
+    } else if (name == "rx_kbps") {
+        return String(stats_.rxBps * 8 / 1000.0f, 1);
+    }
+    if (!initialized_) {
+        return "";
+    }
+    if (name == "channel") {
+        return String(readRegister(NRF24_REG_RF_CH));
+    }
+#if POCKETOS_NRF24L01_ENABLE_BASIC_READ
+    if (name == "tx_queued") {
+        return String(txQueued());
+    } else if (name == "rx_queued") {
+        return String(rxQueued());
+    } else if (name == "stream_slice_us") {
+        return String(streamSliceUs_);
+    }
+#endif
+#if POCKETOS_NRF24L01_ENABLE_ERROR_HANDLING
+    if (name == "tx_addr") {
+        uint8_t addr[5];
+        readRegister(NRF24_REG_TX_ADDR, addr, 5);
+        return formatAddress(addr, 5);
+    } else if (name.startsWith("rx_addr") && name.length() == 8) {
+        int pipe = name.charAt(7) - '0';
+        if (pipe < 0 || pipe > 5) {
+            return "";
+        }
+        // Pipes 2-5 share bytes 1-4 with pipe 1. Pipe 0 from the shadow:
+        // the register holds TX_ADDR while PTX.
+        uint8_t addr[5];
+        readRegister(NRF24_REG_RX_ADDR_P0 + 1, addr, 5);
+        if (pipe == 0) {
+            memcpy(addr, rxAddrP0_, 5);
+        } else if (pipe > 1) {
+            readRegister(NRF24_REG_RX_ADDR_P0 + pipe, addr, 1);
+        }
+        return formatAddress(addr, 5);
+    } else if (name == "status") {
+        return "0x" + String(getStatus(), HEX);
+    }
+#endif
+    return "";
+}
+
+bool NRF24L01Driver::setParameter(const String& name, const String& value) {
+#if POCKETOS_NRF24L01_ENABLE_BASIC_READ
+    if (name == "stream_slice_us") {
+        long us = value.toInt();
+        if (us < 0 || us > 100000) {
+            return false;
+        }
+        streamSliceUs_ = (uint32_t)us;
+        return true;
+    }
+
+    // Radio settings are written with CE low, between bursts
+    if (!initialized_ || role_ == NRF24Role::PTX) {
+        return false;
+    }
+    bool listening = role_ == NRF24Role::PRX;
+    setCE(false);
+    bool ok = false;
+    if (name == "channel") {
+        long channel = value.toInt();
+        ok = channel >= 0 && channel <= 125 && setChannel((uint8_t)channel);
+    } else if (name == "rate") {
+        for (uint8_t i = 0; i < 3; i++) {
+            if (value == NRF24_RATE_NAMES[i]) {
+                ok = setDataRate(i);
+            }
+        }
+    }
+#if POCKETOS_NRF24L01_ENABLE_ERROR_HANDLING
+    uint64_t address;
+    if (name == "tx_addr") {
+        ok = parseAddress(value, address) && openWritingPipe(address);
+    } else if (name.startsWith("rx_addr") && name.length() == 8) {
+        int pipe = name.charAt(7) - '0';
+        ok = pipe >= 0 && pipe <= 5 && parseAddress(value, address) && openReadingPipe((uint8_t)pipe, address);
+    }
+#endif
+    if (listening) {
+        setCE(true);
+    }
+    return ok;
+#else
+    return false;
+#endif
 }
 
 void NRF24L01Driver::setCE(bool active) {
@@ -161,135 +430,363 @@ bool NRF24L01Driver::writeCommand(uint8_t cmd) {
     return spiWrite(&cmd, 1);
 }
 
+uint8_t NRF24L01Driver::readStatus() {
+    // Every command clocks STATUS out on its first byte
+    uint8_t cmd = NRF24_CMD_NOP;
+    uint8_t status = 0xFF;
+    SPITransferDesc desc = SPITransferDesc::transfer(&cmd, &status, 1);
+    spiTransaction(&desc, 1);
+    return status;
+}
+
 bool NRF24L01Driver::readRegister(uint8_t reg, uint8_t* data, uint8_t len) {
     uint8_t cmd = NRF24_CMD_R_REGISTER | (reg & 0x1F);
     return spiWriteRead(&cmd, 1, data, len);
 }
 
-bool NRF24L01Driver::writeRegister(uint8_t reg, const uint8_t* data, uint8_t len) {
-    beginTransaction();
-    uint8_t cmd = NRF24_CMD_W_REGISTER | (reg & 0x1F);
-    SPI.transfer(cmd);
-    for (uint8_t i = 0; i < len; i++) {
-        SPI.transfer(data[i]);
+uint8_t NRF24L01Driver::readRegister(uint8_t reg) {
+    uint8_t value = 0;
+    readRegister(reg, &value, 1);
+    return value;
+}
+
+bool NRF24L01Driver::writePipe0(bool transmitting) {
+    if (!writeRegister(NRF24_REG_RX_ADDR_P0, transmitting ? txAddr_ : rxAddrP0_, 5)) {
+        return false;
     }
-    endTransaction();
+    pipe0Tx_ = transmitting;
     return true;
 }
 
+bool NRF24L01Driver::writeRegister(uint8_t reg, const uint8_t* data, uint8_t len) {
+    uint8_t cmd = NRF24_CMD_W_REGISTER | (reg & 0x1F);
+    SPITransferDesc chain[2] = {
+        SPITransferDesc::write(&cmd, 1),
+        SPITransferDesc::write(data, len)
+    };
+    return spiTransaction(chain, 2);
+}
+
 #if POCKETOS_NRF24L01_ENABLE_BASIC_READ
-bool NRF24L01Driver::transmit(const uint8_t* data, uint8_t len) {
-    if (!initialized_ || len > 32) {
-        return false;
+void NRF24L01Driver::onIrq(void* context, const IrqEvent& event) {
+    NRF24L01Driver* self = static_cast<NRF24L01Driver*>(context);
+    self->stats_.irqEvents++;
+    self->service(SystemClock::toUnixUs(SystemClock::monoFromMicros(event.timestampUs)));
+}
+
+void NRF24L01Driver::service(uint64_t timestampUs) {
+    uint8_t status = readStatus();
+    if (status & 0x80) {
+        return;   // Bit 7 reads 0; 0xFF is an empty bus
     }
-    
-    // Switch to TX mode
-    uint8_t config;
-    if (!readRegister(0x00, &config, 1)) {
-        return false;
+    if (status & NRF24_STATUS_TX_DS) {
+        if (role_ == NRF24Role::PRX) {
+            stats_.ackSent++;
+        }
+        writeRegister(NRF24_REG_STATUS, NRF24_STATUS_TX_DS);
     }
-    
-    config &= ~0x01;  // Clear PRIM_RX (TX mode)
-    if (!writeRegister(0x00, &config, 1)) {
-        return false;
+    if (status & NRF24_STATUS_MAX_RT) {
+        handleMaxRt();
     }
-    
-    // Write payload
-    beginTransaction();
-    SPI.transfer(NRF24_CMD_W_TX_PAYLOAD);
-    for (uint8_t i = 0; i < len; i++) {
-        SPI.transfer(data[i]);
+    if ((status & NRF24_STATUS_RX_DR) || NRF24_STATUS_PIPE(status) < 6) {
+        drainRx(timestampUs);
     }
-    endTransaction();
-    
-    // Pulse CE to start transmission
-    setCE(true);
-    delayMicroseconds(15);
+}
+
+void NRF24L01Driver::drainRx(uint64_t timestampUs) {
+    // The RX FIFO holds three packets; bounded in case the air keeps it full
+    for (uint8_t i = 0; i < NRF24_HW_FIFO_DEPTH * 2; i++) {
+        uint8_t cmd[2] = { NRF24_CMD_R_RX_PL_WID, NRF24_CMD_NOP };
+        uint8_t resp[2] = { 0xFF, 0 };
+        SPITransferDesc desc = SPITransferDesc::transfer(cmd, resp, 2);
+        spiTransaction(&desc, 1);
+        uint8_t pipe = NRF24_STATUS_PIPE(resp[0]);
+        if (pipe > 5) {
+            break;
+        }
+        uint8_t len = resp[1];
+        if (len == 0 || len > NRF24_MAX_PAYLOAD) {
+            // Corrupt width: the datasheet says to flush the RX FIFO
+            writeCommand(NRF24_CMD_FLUSH_RX);
+            break;
+        }
+
+        // A full queue still reads the payload out to free the chip FIFO
+        bool full = rxQueued() >= NRF24_RX_QUEUE_SIZE;
+        NRF24Packet scratch;
+        NRF24Packet& packet = full ? scratch : rxQueue_[rxHead_ & (NRF24_RX_QUEUE_SIZE - 1)];
+        uint8_t rd = NRF24_CMD_R_RX_PAYLOAD;
+        spiWriteRead(&rd, 1, packet.data, len);
+        stats_.rxPackets++;
+        stats_.rxBytes += len;
+        rateRxBytes_ += len;
+        if (role_ == NRF24Role::PTX) {
+            stats_.ackPayloads++;
+        }
+        if (full) {
+            stats_.rxDrops++;
+            continue;
+        }
+        packet.timestampUs = timestampUs;
+        packet.pipe = pipe;
+        packet.len = len;
+        packet.ackPayload = role_ == NRF24Role::PTX;
+        rxHead_++;
+    }
+    writeRegister(NRF24_REG_STATUS, NRF24_STATUS_RX_DR);
+}
+
+void NRF24L01Driver::writePayload(uint8_t cmd, const uint8_t* data, uint8_t len) {
+    SPITransferDesc chain[2] = {
+        SPITransferDesc::write(&cmd, 1),
+        SPITransferDesc::write(data, len)
+    };
+    spiTransaction(chain, 2);
+}
+
+void NRF24L01Driver::setRole(NRF24Role role) {
     setCE(false);
-    
-    // Wait for transmission (simplified)
-    delay(1);
-    
+    if ((role == NRF24Role::PTX) != pipe0Tx_) {
+        writePipe0(role == NRF24Role::PTX);
+    }
+    uint8_t config = readRegister(NRF24_REG_CONFIG);
+    if (role == NRF24Role::STANDBY) {
+        config &= ~NRF24_CONFIG_PWR_UP;
+    } else if (role == NRF24Role::PRX) {
+        config |= NRF24_CONFIG_PWR_UP | NRF24_CONFIG_PRIM_RX;
+    } else {
+        config = (config | NRF24_CONFIG_PWR_UP) & ~NRF24_CONFIG_PRIM_RX;
+    }
+    writeRegister(NRF24_REG_CONFIG, config);
+    role_ = role;
+
+    // PRX listens; PTX sends whatever the TX FIFO holds, back to back
+    if (role != NRF24Role::STANDBY) {
+        setCE(true);
+    }
+}
+
+void NRF24L01Driver::stream() {
+    bool pending = txHead_ != txTail_ || hwCount_ > 0;
+    if (role_ == NRF24Role::STANDBY || (role_ == NRF24Role::PRX && !pending)) {
+        return;
+    }
+    if (role_ == NRF24Role::PRX) {
+        // Anything still in the TX FIFO is an unsent ACK payload
+        if (!(readRegister(NRF24_REG_FIFO_STATUS) & NRF24_FIFO_TX_EMPTY)) {
+            writeCommand(NRF24_CMD_FLUSH_TX);
+        }
+        setRole(NRF24Role::PTX);
+    }
+
+    // Keep the FIFO topped up for one slice, then let the loop run
+    uint32_t start = micros();
+    while (true) {
+        uint8_t status = readStatus();
+        if (status & NRF24_STATUS_MAX_RT) {
+            handleMaxRt();
+        }
+        if (status & NRF24_STATUS_TX_DS) {
+            writeRegister(NRF24_REG_STATUS, NRF24_STATUS_TX_DS);
+        }
+        if (NRF24_STATUS_PIPE(status) < 6) {
+            drainRx(SystemClock::nowUs());
+        }
+        refillFifo();
+        if (txHead_ == txTail_ && hwCount_ == 0) {
+            setRole(NRF24Role::PRX);
+            return;
+        }
+        if ((uint32_t)(micros() - start) >= streamSliceUs_) {
+            return;
+        }
+    }
+}
+
+uint8_t NRF24L01Driver::refillFifo() {
+    // Empty: everything written was acked
+    uint8_t fifo = readRegister(NRF24_REG_FIFO_STATUS);
+    if (fifo & NRF24_FIFO_TX_EMPTY) {
+        resolveAcked(0);
+    }
+
+    uint8_t written = 0;
+    bool full = (fifo & NRF24_FIFO_TX_FULL) != 0;
+    while (!full && txHead_ != txTail_ && hwCount_ < NRF24_TX_SHADOW) {
+        const NRF24Packet& packet = txQueue_[txTail_ & (NRF24_TX_QUEUE_SIZE - 1)];
+        writePayload(NRF24_CMD_W_TX_PAYLOAD, packet.data, packet.len);
+        hwFifo_[(uint8_t)(hwTail_ + hwCount_) & (NRF24_TX_SHADOW - 1)] = packet;
+        hwCount_++;
+        txTail_++;
+        written++;
+        full = (readStatus() & NRF24_STATUS_TX_FULL) != 0;
+    }
+
+    // Full: the last three written are in flight, the rest were acked
+    if (full) {
+        resolveAcked(NRF24_HW_FIFO_DEPTH);
+    }
+    return written;
+}
+
+void NRF24L01Driver::resolveAcked(uint8_t stillQueued) {
+    if (stillQueued >= hwCount_) {
+        return;
+    }
+    while (hwCount_ > stillQueued) {
+        const NRF24Packet& packet = hwFifo_[hwTail_ & (NRF24_TX_SHADOW - 1)];
+        stats_.txPackets++;
+        stats_.txBytes += packet.len;
+        rateTxBytes_ += packet.len;
+        hwTail_++;
+        hwCount_--;
+    }
+
+    // ARC_CNT belongs to the packet in flight; with the FIFO empty, that
+    // is the last one acked
+    if (stillQueued == 0) {
+        uint8_t arc = readRegister(NRF24_REG_OBSERVE_TX) & 0x0F;
+        stats_.arcSamples++;
+        stats_.arcSum += arc;
+        if (arc > stats_.arcMax) {
+            stats_.arcMax = arc;
+        }
+    }
+}
+
+void NRF24L01Driver::handleMaxRt() {
+    // The chip stops with the failed packet at the head of its FIFO. Fill
+    // the free slots with throwaway payloads to learn how many are left.
+    setCE(false);
+    uint8_t depth = NRF24_HW_FIFO_DEPTH;
+    uint8_t filler = 0;
+    while (depth > 0 && !(readStatus() & NRF24_STATUS_TX_FULL)) {
+        writePayload(NRF24_CMD_W_TX_PAYLOAD, &filler, 1);
+        depth--;
+    }
+    writeCommand(NRF24_CMD_FLUSH_TX);
+
+    // Everything ahead of the failed packet got through
+    resolveAcked(depth);
+    if (hwCount_ > 0) {
+        stats_.txFailed++;
+        hwTail_++;
+        hwCount_--;
+    }
+
+    // Resend the packets that were queued behind it
+    for (uint8_t i = 0; i < hwCount_; i++) {
+        const NRF24Packet& packet = hwFifo_[(uint8_t)(hwTail_ + i) & (NRF24_TX_SHADOW - 1)];
+        writePayload(NRF24_CMD_W_TX_PAYLOAD, packet.data, packet.len);
+    }
+    writeRegister(NRF24_REG_STATUS, NRF24_STATUS_MAX_RT | NRF24_STATUS_TX_DS);
+    if (role_ == NRF24Role::PTX) {
+        setCE(true);
+    }
+}
+
+void NRF24L01Driver::updateRates() {
+    uint32_t now = millis();
+    uint32_t elapsed = now - rateStartMs_;
+    if (elapsed < 1000) {
+        return;
+    }
+    stats_.txBps = (uint32_t)((uint64_t)rateTxBytes_ * 1000 / elapsed);
+    stats_.rxBps = (uint32_t)((uint64_t)rateRxBytes_ * 1000 / elapsed);
+    rateTxBytes_ = 0;
+    rateRxBytes_ = 0;
+    rateStartMs_ = now;
+}
+
+bool NRF24L01Driver::transmit(const uint8_t* data, uint8_t len) {
+    if (!initialized_ || len == 0 || len > NRF24_MAX_PAYLOAD ||
+        (uint8_t)(txHead_ - txTail_) >= NRF24_TX_QUEUE_SIZE) {
+        return false;
+    }
+    NRF24Packet& packet = txQueue_[txHead_ & (NRF24_TX_QUEUE_SIZE - 1)];
+    memcpy(packet.data, data, len);
+    packet.len = len;
+    packet.pipe = 0;
+    packet.ackPayload = false;
+    packet.timestampUs = SystemClock::nowUs();
+    txHead_++;
     return true;
 }
 
 bool NRF24L01Driver::receive(uint8_t* data, uint8_t& len) {
-    if (!initialized_) {
+    NRF24Packet packet;
+    if (!initialized_ || !popPacket(packet)) {
         return false;
     }
-    
-    if (!available()) {
+    memcpy(data, packet.data, packet.len);
+    len = packet.len;
+    return true;
+}
+
+bool NRF24L01Driver::available() {
+    return rxQueued() > 0;
+}
+
+bool NRF24L01Driver::popPacket(NRF24Packet& packet) {
+    if (rxHead_ == rxTail_) {
         return false;
     }
-    
-    // Read payload length from register RX_PW_P0 (assumes pipe 0)
-    // For dynamic payload, this would need to be read from DPL feature
-    // For now, fixed at 32 bytes as maximum payload size
-    len = 32;
-    
-    // Read payload
-    beginTransaction();
-    SPI.transfer(NRF24_CMD_R_RX_PAYLOAD);
-    for (uint8_t i = 0; i < len; i++) {
-        data[i] = SPI.transfer(0xFF);
-    }
-    endTransaction();
-    
-    // Clear RX_DR flag
-    uint8_t status = 0x40;
-    writeRegister(0x07, &status, 1);
-    
+    packet = rxQueue_[rxTail_ & (NRF24_RX_QUEUE_SIZE - 1)];
+    rxTail_++;
     return true;
 }
 
-bool NRF24L01Driver::available() {
-    uint8_t status;
-    if (!readRegister(0x07, &status, 1)) {
+bool NRF24L01Driver::writeAckPayload(uint8_t pipe, const uint8_t* data, uint8_t len) {
+    // As PTX the payload would go out as an ordinary packet
+    if (!initialized_ || role_ != NRF24Role::PRX || pipe > 5 || len == 0 || len > NRF24_MAX_PAYLOAD) {
         return false;
     }
-    
-    return (status & 0x40) != 0;  // RX_DR flag
+    if (readStatus() & NRF24_STATUS_TX_FULL) {
+        return false;
+    }
+    writePayload(NRF24_CMD_W_ACK_PAYLOAD | pipe, data, len);
+    return true;
+}
+
+void NRF24L01Driver::resetStats() {
+    memset(&stats_, 0, sizeof(stats_));
+    rateStartMs_ = millis();
+    rateTxBytes_ = 0;
+    rateRxBytes_ = 0;
 }
 
 bool NRF24L01Driver::setPowerUp(bool powerUp) {
     if (!initialized_) {
         return false;
     }
-    
-    uint8_t config;
-    if (!readRegister(0x00, &config, 1)) {
-        return false;
+    if (!powerUp) {
+        setRole(NRF24Role::STANDBY);
+    } else if (role_ == NRF24Role::STANDBY) {
+        setRole(NRF24Role::PRX);
     }
-    
-    if (powerUp) {
-        config |= 0x02;
-    } else {
-        config &= ~0x02;
-    }
-    
-    return writeRegister(0x00, &config, 1);
+    return true;
 }
 
 bool NRF24L01Driver::setChannel(uint8_t channel) {
     if (!initialized_ || channel > 125) {
         return false;
     }
-    
-    return writeRegister(0x05, &channel, 1);
+
+    return writeRegister(NRF24_REG_RF_CH, &channel, 1);
 }
 
 bool NRF24L01Driver::setDataRate(uint8_t rate) {
     if (!initialized_ || rate > 2) {
         return false;
     }
-    
+
     uint8_t rf_setup;
-    if (!readRegister(0x06, &rf_setup, 1)) {
+    if (!readRegister(NRF24_REG_RF_SETUP, &rf_setup, 1)) {
         return false;
     }
-    
+
     rf_setup &= ~0x28;  // Clear RF_DR bits
-    
+
     if (rate == 0) {
         // 1Mbps - both bits 0
     } else if (rate == 1) {
@@ -297,8 +794,15 @@ bool NRF24L01Driver::setDataRate(uint8_t rate) {
     } else if (rate == 2) {
         rf_setup |= 0x20;  // 250kbps
     }
-    
-    return writeRegister(0x06, &rf_setup, 1);
+
+    if (!writeRegister(NRF24_REG_RF_SETUP, &rf_setup, 1)) {
+        return false;
+    }
+    dataRate_ = rate;
+
+    // 15 retries; the retransmit delay must cover a 32-byte ACK payload:
+    // 500 us at 1 and 2 Mbps, 1500 us at 250 kbps
+    return writeRegister(NRF24_REG_SETUP_RETR, rate == 2 ? 0x5F : 0x1F);
 }
 #endif
 
@@ -334,7 +838,14 @@ bool NRF24L01Driver::openReadingPipe(uint8_t pipe, uint64_t address) {
     uint8_t reg = 0x0A + pipe;
     uint8_t width = (pipe < 2) ? 5 : 1;
     
-    if (!writeRegister(reg, addr, width)) {
+    // Pipe 0 takes the address now unless it is receiving auto-ACKs;
+    // setRole() puts it back when the radio leaves PTX
+    bool deferred = false;
+    if (pipe == 0) {
+        memcpy(rxAddrP0_, addr, 5);
+        deferred = pipe0Tx_;
+    }
+    if (!deferred && !writeRegister(reg, addr, width)) {
         return false;
     }
     
@@ -358,7 +869,13 @@ bool NRF24L01Driver::openWritingPipe(uint64_t address) {
         addr[i] = (address >> (i * 8)) & 0xFF;
     }
     
-    return writeRegister(0x10, addr, 5);
+    // Auto-ack replies come back to TX_ADDR: pipe 0 listens there while
+    // transmitting, its reading address is kept
+    memcpy(txAddr_, addr, 5);
+    if (!writeRegister(NRF24_REG_TX_ADDR, addr, 5)) {
+        return false;
+    }
+    return !pipe0Tx_ || writePipe0(true);
 }
 
 bool NRF24L01Driver::setPowerMode(uint8_t mode) {
@@ -366,6 +883,11 @@ bool NRF24L01Driver::setPowerMode(uint8_t mode) {
         return false;
     }
     
+    // Streaming resumes only from RX (mode 2); TX mode leaves CE to the caller
+    role_ = mode == 2 ? NRF24Role::PRX : NRF24Role::STANDBY;
+    if ((mode == 3) != pipe0Tx_ && !writePipe0(mode == 3)) {
+        return false;
+    }
     uint8_t config;
     if (!readRegister(0x00, &config, 1)) {
         return false;
@@ -407,6 +929,9 @@ uint8_t NRF24L01Driver::getStatus() {
 
 void NRF24L01Driver::flushTx() {
     writeCommand(NRF24_CMD_FLUSH_TX);
+#if POCKETOS_NRF24L01_ENABLE_BASIC_READ
+    hwCount_ = 0;   // Flushed packets are neither acked nor failed
+#endif
 }
 
 void NRF24L01Driver::flushRx() {
@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include "../driver_config.h"
+#include "../core/capability_schema.h"
 #include "spi_driver_base.h"
 #include "register_types.h"
 
@@ -10,6 +11,72 @@ namespace PocketOS {
 
 // nRF24L01+ 2.4GHz Transceiver Driver
 // Endpoint format: spi0:cs=5,ce=16,irq=4 (ce required, irq optional)
+//
+// The radio listens (PRX) on all enabled pipes by default, with dynamic
+// payload length and ACK payloads on. transmit() queues a packet. While
+// packets are queued the radio runs as PTX with CE held high. update()
+// keeps the 3-deep TX FIFO topped up, and the chip sends back to back.
+// It returns to PRX when everything has been sent.
+//
+// The driver shadows what it wrote to the TX FIFO. A pass that finds the
+// FIFO full (3 in flight) or empty (0) knows exactly how many earlier
+// packets were acked, so TX_DS events that coalesce between passes still
+// give exact counts. On MAX_RT only the failed packet is dropped; the
+// packets queued behind it are written again. ACK payloads preloaded as
+// PRX are flushed when the node starts transmitting itself.
+//
+// RX drains every pipe (R_RX_PL_WID, then R_RX_PAYLOAD) into a queue. In
+// PTX mode, received packets are ACK payloads sent back by the remote
+// PRX: a request and its response take one air round trip.
+//
+// Auto-ACKs come back to TX_ADDR, so pipe 0 listens on the writing
+// address while transmitting (PTX or power mode 3) and on its own reading
+// address otherwise. The driver keeps both and rewrites RX_ADDR_P0 whenever
+// the radio enters or leaves transmit.
+
+#ifndef NRF24_TX_QUEUE_SIZE
+#define NRF24_TX_QUEUE_SIZE 16      // Packets; power of two
+#endif
+#ifndef NRF24_RX_QUEUE_SIZE
+#define NRF24_RX_QUEUE_SIZE 16      // Packets; power of two
+#endif
+#ifndef NRF24_STREAM_SLICE_US
+#define NRF24_STREAM_SLICE_US 2000  // Refill time per main loop pass while streaming
+#endif
+#define NRF24_MAX_PAYLOAD 32
+#define NRF24_HW_FIFO_DEPTH 3
+#define NRF24_TX_SHADOW 8           // Written to the chip, not yet resolved; power of two
+
+enum class NRF24Role : uint8_t {
+    STANDBY,
+    PRX,        // Listening
+    PTX         // Streaming the TX queue
+};
+
+struct NRF24Packet {
+    uint64_t timestampUs;   // RX: IRQ edge (or drain time); TX: queued
+    uint8_t pipe;           // RX pipe 0-5
+    uint8_t len;
+    bool ackPayload;        // Received as PTX: the remote's ACK payload
+    uint8_t data[NRF24_MAX_PAYLOAD];
+};
+
+struct NRF24Stats {
+    uint32_t txPackets;         // Acknowledged
+    uint32_t txBytes;
+    uint32_t txFailed;          // MAX_RT: no ACK after all retries
+    uint32_t arcSamples;        // OBSERVE_TX.ARC_CNT samples (last packet of a batch)
+    uint32_t arcSum;
+    uint8_t arcMax;
+    uint32_t rxPackets;
+    uint32_t rxBytes;
+    uint32_t rxDrops;           // RX queue full
+    uint32_t ackPayloads;       // ACK payloads received as PTX
+    uint32_t ackSent;           // Preloaded ACK payloads sent as PRX
+    uint32_t irqEvents;
+    uint32_t txBps;             // Acknowledged payload bytes/s, last full second
+    uint32_t rxBps;
+};
 
 class NRF24L01Driver : public SPIDriverBase {
 public:
@@ -25,14 +92,36 @@ public:
     // Identification probe - reads CONFIG register
     static bool identifyProbe(const String& endpoint);
     
+    // Main loop: service IRQ flags, stream the TX queue, drain RX
+    void update();
+    
+    // Get capability schema
+    CapabilitySchema getSchema() const;
+    
+    // Parameter get/set
+    String getParameter(const String& name);
+    bool setParameter(const String& name, const String& value);
+    
 #if POCKETOS_NRF24L01_ENABLE_BASIC_READ
-    // Tier 0: Basic TX/RX
-    bool transmit(const uint8_t* data, uint8_t len);
+    // Tier 0: Basic TX/RX (non-blocking)
+    bool transmit(const uint8_t* data, uint8_t len);   // Queue; false if full
     bool receive(uint8_t* data, uint8_t& len);
     bool available();
     bool setPowerUp(bool powerUp);
     bool setChannel(uint8_t channel);
     bool setDataRate(uint8_t rate);  // 0=1Mbps, 1=2Mbps, 2=250kbps
+    
+    // Response for the next packet received on a pipe (PRX); the chip
+    // holds up to three across all pipes
+    bool writeAckPayload(uint8_t pipe, const uint8_t* data, uint8_t len);
+    
+    // Packet queues
+    bool popPacket(NRF24Packet& packet);
+    uint8_t txQueued() const { return (uint8_t)(txHead_ - txTail_) + hwCount_; }
+    uint8_t rxQueued() const { return (uint8_t)(rxHead_ - rxTail_); }
+    NRF24Role getRole() const { return role_; }
+    const NRF24Stats& getStats() const { return stats_; }
+    void resetStats();
 #endif
 
 #if POCKETOS_NRF24L01_ENABLE_ERROR_HANDLING
@@ -58,12 +147,50 @@ public:
 private:
     bool initialized_;
     int8_t ce_pin_;
+    NRF24Role role_;
+    uint8_t dataRate_;
+    NRF24Stats stats_;
+    uint8_t txAddr_[5];         // openWritingPipe()
+    uint8_t rxAddrP0_[5];       // openReadingPipe(0)
+    bool pipe0Tx_;              // RX_ADDR_P0 holds txAddr_ (auto-ack listening)
+    
+#if POCKETOS_NRF24L01_ENABLE_BASIC_READ
+    NRF24Packet txQueue_[NRF24_TX_QUEUE_SIZE];
+    uint8_t txHead_;            // Free-running
+    uint8_t txTail_;
+    NRF24Packet hwFifo_[NRF24_TX_SHADOW];   // Written to the chip; ring from hwTail_
+    uint8_t hwTail_;            // Free-running
+    uint8_t hwCount_;
+    NRF24Packet rxQueue_[NRF24_RX_QUEUE_SIZE];
+    uint8_t rxHead_;
+    uint8_t rxTail_;
+    uint32_t streamSliceUs_;
+    uint32_t rateStartMs_;
+    uint32_t rateTxBytes_;
+    uint32_t rateRxBytes_;
+#endif
     
     // Helper methods
     void setCE(bool active);
     bool writeCommand(uint8_t cmd);
+    uint8_t readStatus();
     bool readRegister(uint8_t reg, uint8_t* data, uint8_t len);
     bool writeRegister(uint8_t reg, const uint8_t* data, uint8_t len);
+    bool writeRegister(uint8_t reg, uint8_t value) { return writeRegister(reg, &value, 1); }
+    uint8_t readRegister(uint8_t reg);
+    bool writePipe0(bool transmitting);   // RX_ADDR_P0 and pipe0Tx_
+#if POCKETOS_NRF24L01_ENABLE_BASIC_READ
+    void service(uint64_t timestampUs);
+    void drainRx(uint64_t timestampUs);
+    void stream();
+    void writePayload(uint8_t cmd, const uint8_t* data, uint8_t len);
+    uint8_t refillFifo();
+    void resolveAcked(uint8_t stillQueued);
+    void handleMaxRt();
+    void setRole(NRF24Role role);
+    void updateRates();
+    static void onIrq(void* context, const IrqEvent& event);
+#endif
 };
 
 } // namespace PocketOS
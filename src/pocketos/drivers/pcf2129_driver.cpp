@@ -321,6 +321,10 @@ bool PCF2129Driver::setClockOutput(bool enable, uint8_t freq) {
     return writeRegister(PCF2129_REG_CLKOUT_CTL, clkout);
 }
 
+bool PCF2129Driver::enableSecondPulse() {
+    return setClockOutput(true, 6);
+}
+
 bool PCF2129Driver::enableTimestamp(bool enable) {
     if (!initialized) {
         return false;
@@ -75,6 +75,7 @@ public:
     
     // Clock output control
     bool setClockOutput(bool enable, uint8_t freq);  // freq: 0=32.768kHz, 1=16.384kHz, 2=8.192kHz, 3=4.096kHz, 4=2.048kHz, 5=1.024kHz, 6=1Hz, 7=disabled
+    bool enableSecondPulse();  // 1 Hz output (SystemClock pulse input)
     
     // Timestamp capture
     bool enableTimestamp(bool enable);
@@ -308,6 +308,10 @@ bool PCF8523Driver::setClockOutput(bool enable, uint8_t freq) {
     return writeRegister(PCF8523_REG_TMR_CLKOUT, clkout);
 }
 
+bool PCF8523Driver::enableSecondPulse() {
+    return setClockOutput(true, 6);
+}
+
 bool PCF8523Driver::setOffset(uint8_t mode, uint8_t offset) {
     if (!initialized || offset > 63) {
         return false;
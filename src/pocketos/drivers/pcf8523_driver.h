@@ -73,6 +73,7 @@ public:
     
     // Clock output control
     bool setClockOutput(bool enable, uint8_t freq);  // freq: 0=32.768kHz, 1=16.384kHz, 2=8.192kHz, 3=4.096kHz, 4=1.024kHz, 5=32Hz, 6=1Hz, 7=disabled
+    bool enableSecondPulse();  // 1 Hz output (SystemClock pulse input)
     
     // Offset calibration (mode: 0=slow, 1=fast; offset: 0-63)
     bool setOffset(uint8_t mode, uint8_t offset);
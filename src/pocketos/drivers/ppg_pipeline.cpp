@@ -0,0 +1,274 @@
+#include "ppg_pipeline.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace PocketOS {
+
+#define PPG_Q28 268435456.0f
+
+// Butterworth (Q = 1/sqrt(2)) biquad via the bilinear transform, Q28
+static void designBiquad(float f0, float fs, bool highPass, int32_t b[3], int32_t a[2]) {
+    const float w0 = 2.0f * 3.14159265f * f0 / fs;
+    const float c = cosf(w0);
+    const float alpha = sinf(w0) / (2.0f * 0.70710678f);
+    const float a0 = 1.0f + alpha;
+
+    float b0 = (highPass ? (1.0f + c) : (1.0f - c)) / 2.0f;
+    float b1 = highPass ? -(1.0f + c) : (1.0f - c);
+
+    b[0] = (int32_t)lroundf(b0 / a0 * PPG_Q28);
+    b[1] = (int32_t)lroundf(b1 / a0 * PPG_Q28);
+    b[2] = b[0];
+    a[0] = (int32_t)lroundf(-2.0f * c / a0 * PPG_Q28);
+    a[1] = (int32_t)lroundf((1.0f - alpha) / a0 * PPG_Q28);
+}
+
+static inline int32_t runBiquad(int32_t x, int32_t& x1, int32_t& x2, int32_t& y1, int32_t& y2,
+                                const int32_t b[3], const int32_t a[2]) {
+    int64_t acc = (int64_t)b[0] * x + (int64_t)b[1] * x1 + (int64_t)b[2] * x2 -
+                  (int64_t)a[0] * y1 - (int64_t)a[1] * y2;
+    int32_t y = (int32_t)((acc + (1 << 27)) >> 28);
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = y;
+    return y;
+}
+
+PpgPipeline::PpgPipeline()
+    : inputRate_(0), rate_(0), decimation_(1), decimCount_(0), dcShift_(7) {
+    memset(hpB_, 0, sizeof(hpB_));
+    memset(hpA_, 0, sizeof(hpA_));
+    memset(lpB_, 0, sizeof(lpB_));
+    memset(lpA_, 0, sizeof(lpA_));
+    reset();
+}
+
+bool PpgPipeline::begin(uint16_t sampleRateHz) {
+    if (sampleRateHz < 10 || sampleRateHz > 3200) {
+        return false;
+    }
+    inputRate_ = sampleRateHz;
+    decimation_ = (uint8_t)(sampleRateHz > 100 ? sampleRateHz / 100 : 1);
+    rate_ = (uint16_t)(sampleRateHz / decimation_);
+
+    // DC time constant ~1.3 s
+    dcShift_ = 0;
+    while ((1U << dcShift_) < (uint32_t)(rate_ + rate_ / 4)) {
+        dcShift_++;
+    }
+
+    designBiquad(0.5f, rate_, true, hpB_, hpA_);
+    designBiquad(4.0f, rate_, false, lpB_, lpA_);
+    reset();
+    return true;
+}
+
+void PpgPipeline::reset() {
+    memset(&red_, 0, sizeof(red_));
+    memset(&ir_, 0, sizeof(ir_));
+    decimCount_ = 0;
+    sample_ = 0;
+    settleUntil_ = 0;
+    primed_ = false;
+    finger_ = false;
+    beats_ = 0;
+    perfusion_ = 0;
+    clearBeats();
+}
+
+void PpgPipeline::clearBeats() {
+    s1_ = s2_ = 0;
+    armed_ = false;
+    envelope_ = 0;
+    lastBeatQ8_ = 0;
+    haveBeat_ = false;
+    intervalCount_ = 0;
+    ratioCount_ = 0;
+    rejects_ = 0;
+    heartRate_ = 0;
+    spo2_ = 0;
+}
+
+void PpgPipeline::process(const uint32_t* red, const uint32_t* ir, uint16_t count) {
+    if (rate_ == 0) {
+        return;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        red_.acc += red[i];
+        ir_.acc += ir[i];
+        if (++decimCount_ < decimation_) {
+            continue;
+        }
+        int32_t r = (int32_t)(red_.acc / decimation_);
+        int32_t x = (int32_t)(ir_.acc / decimation_);
+        red_.acc = 0;
+        ir_.acc = 0;
+        decimCount_ = 0;
+        analyse(r, x);
+    }
+}
+
+void PpgPipeline::prime(int32_t red, int32_t ir) {
+    memset(&red_, 0, sizeof(red_));
+    memset(&ir_, 0, sizeof(ir_));
+    red_.dcQ8 = red << 8;
+    ir_.dcQ8 = ir << 8;
+    primed_ = true;
+    settleUntil_ = sample_ + rate_;     // One second for the filters to settle
+    clearBeats();
+}
+
+int32_t PpgPipeline::filter(Channel& ch, int32_t x) {
+    ch.dcQ8 += ((x << 8) - ch.dcQ8) >> dcShift_;
+    int32_t ac = x - (ch.dcQ8 >> 8);
+    int32_t y = runBiquad(ac, ch.hp.x1, ch.hp.x2, ch.hp.y1, ch.hp.y2, hpB_, hpA_);
+    y = runBiquad(y, ch.lp.x1, ch.lp.x2, ch.lp.y1, ch.lp.y2, lpB_, lpA_);
+
+    if (y < ch.min) {
+        ch.min = y;
+    }
+    if (y > ch.max) {
+        ch.max = y;
+    }
+    return y;
+}
+
+void PpgPipeline::analyse(int32_t red, int32_t ir) {
+    bool finger = ir >= POCKETOS_PPG_FINGER_THRESHOLD;
+    if (finger != finger_) {
+        finger_ = finger;
+        primed_ = false;
+        clearBeats();
+        perfusion_ = 0;
+    }
+    if (!finger_) {
+        sample_++;
+        return;
+    }
+    if (!primed_) {
+        prime(red, ir);
+    }
+
+    filter(red_, red);
+    // Absorption peaks (systole) are minima of the raw signal
+    int32_t s = -filter(ir_, ir);
+
+    uint32_t now = sample_++;
+    if ((int32_t)(now - settleUntil_) < 0) {
+        red_.min = red_.max = 0;
+        ir_.min = ir_.max = 0;
+        s2_ = s1_;
+        s1_ = s;
+        return;
+    }
+
+    // A beat needs a negative excursion first (rejects the dicrotic notch)
+    if (s < 0) {
+        armed_ = true;
+    }
+
+    if (armed_ && s1_ > s2_ && s1_ >= s && s1_ > envelope_ / 2 && s1_ > 0) {
+        // Parabolic fit through the three samples around the maximum
+        int32_t denom = s2_ - 2 * s1_ + s;
+        int32_t offsetQ8 = denom != 0 ? (int32_t)(((int64_t)(s2_ - s) * 128) / denom) : 0;
+        uint32_t peakQ8 = ((now - 1) << 8) + (uint32_t)offsetQ8;
+
+        uint32_t refractoryQ8 = (uint32_t)rate_ * 64;       // 250 ms
+        if (!haveBeat_ || peakQ8 - lastBeatQ8_ >= refractoryQ8) {
+            onBeat(s1_, peakQ8);
+        }
+    }
+    s2_ = s1_;
+    s1_ = s;
+
+    if (haveBeat_) {
+        uint32_t sinceQ8 = (now << 8) - lastBeatQ8_;
+        if (sinceQ8 > (uint32_t)rate_ * 3 * 256) {
+            // No beat for 3 s: the reading is stale
+            clearBeats();
+        } else if (sinceQ8 > (uint32_t)rate_ * 384) {
+            envelope_ -= envelope_ >> 5;                    // Let smaller beats through
+        }
+    }
+}
+
+void PpgPipeline::onBeat(int32_t peak, uint32_t peakQ8) {
+    envelope_ = envelope_ ? (3 * envelope_ + peak) / 4 : peak;
+    armed_ = false;
+    beats_++;
+
+    if (haveBeat_) {
+        uint32_t interval = peakQ8 - lastBeatQ8_;
+        float bpm = 60.0f * 256.0f * rate_ / (float)interval;
+
+        if (bpm >= 30.0f && bpm <= 220.0f) {
+            bool accept = true;
+            if (intervalCount_ >= 2) {
+                uint32_t sum = 0;
+                for (uint8_t i = 0; i < intervalCount_; i++) {
+                    sum += intervals_[i];
+                }
+                uint32_t mean = sum / intervalCount_;
+                uint32_t diff = interval > mean ? interval - mean : mean - interval;
+                if (diff > mean / 4) {
+                    accept = false;
+                    // Three misfits in a row: the rhythm changed, start over
+                    if (++rejects_ >= 3) {
+                        intervalCount_ = 0;
+                        ratioCount_ = 0;
+                        rejects_ = 0;
+                    }
+                }
+            }
+
+            if (accept) {
+                rejects_ = 0;
+                if (intervalCount_ == PPG_HISTORY) {
+                    memmove(intervals_, intervals_ + 1, (PPG_HISTORY - 1) * sizeof(intervals_[0]));
+                    intervalCount_--;
+                }
+                intervals_[intervalCount_++] = interval;
+
+                uint32_t sum = 0;
+                for (uint8_t i = 0; i < intervalCount_; i++) {
+                    sum += intervals_[i];
+                }
+                heartRate_ = 60.0f * 256.0f * rate_ * intervalCount_ / (float)sum;
+
+                // Ratio of ratios over this beat
+                int32_t dcRed = red_.dcQ8 >> 8;
+                int32_t dcIr = ir_.dcQ8 >> 8;
+                int32_t acRed = red_.max - red_.min;
+                int32_t acIr = ir_.max - ir_.min;
+                if (acRed > 0 && acIr > 0 && dcRed > 0 && dcIr > 0) {
+                    float r = ((float)acRed * (float)dcIr) / ((float)acIr * (float)dcRed);
+                    perfusion_ = 100.0f * acIr / (float)dcIr;
+                    if (r > 0.2f && r < 1.8f) {
+                        if (ratioCount_ == PPG_HISTORY) {
+                            memmove(ratios_, ratios_ + 1, (PPG_HISTORY - 1) * sizeof(ratios_[0]));
+                            ratioCount_--;
+                        }
+                        ratios_[ratioCount_++] = r;
+
+                        float mean = 0;
+                        for (uint8_t i = 0; i < ratioCount_; i++) {
+                            mean += ratios_[i];
+                        }
+                        mean /= ratioCount_;
+                        float spo2 = -45.060f * mean * mean + 30.354f * mean + 94.845f;
+                        spo2_ = spo2 > 100.0f ? 100.0f : (spo2 < 0 ? 0 : spo2);
+                    }
+                }
+            }
+        }
+    }
+
+    lastBeatQ8_ = peakQ8;
+    haveBeat_ = true;
+    red_.min = red_.max = 0;
+    ir_.min = ir_.max = 0;
+}
+
+} // namespace PocketOS
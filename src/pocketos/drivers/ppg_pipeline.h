@@ -0,0 +1,116 @@
+#ifndef POCKETOS_PPG_PIPELINE_H
+#define POCKETOS_PPG_PIPELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PocketOS {
+
+/**
+ * PPG Pipeline
+ *
+ * Heart rate and SpO2 from red and infrared photoplethysmogram samples
+ * (MAX30101 and similar), processed incrementally: process() takes any
+ * batch size and keeps all state between batches.
+ *
+ *   1. Decimation to the analysis rate (<= 100 Hz, averaging)
+ *   2. DC tracking per channel (~1.3 s time constant)
+ *   3. Band-pass 0.5-4 Hz: Butterworth high-pass and low-pass biquads,
+ *      Q28 coefficients, integer state
+ *   4. Beat detection on the inverted IR signal: local maximum above half
+ *      the running peak amplitude, re-armed by a negative crossing, with a
+ *      250 ms refractory period; peak time refined by parabolic fit
+ *   5. Heart rate from the mean of the last four beat intervals (30-220
+ *      bpm, intervals more than 25% off the mean are rejected)
+ *   6. SpO2 per beat from the ratio of ratios R = (ACred/DCred) /
+ *      (ACir/DCir), averaged over four beats:
+ *      SpO2 = -45.060 R² + 30.354 R + 94.845
+ *
+ * Per-sample work is integer only; float is used once per beat.
+ * The SpO2 curve is Maxim's empirical calibration. It is not a medical
+ * measurement and shifts with the enclosure and LED currents.
+ *
+ * No Arduino dependency: exercised on the host.
+ */
+
+// IR DC level (18-bit counts) below which no finger is assumed
+// Can be overridden via build flags: -DPOCKETOS_PPG_FINGER_THRESHOLD=30000
+#ifndef POCKETOS_PPG_FINGER_THRESHOLD
+#define POCKETOS_PPG_FINGER_THRESHOLD 50000
+#endif
+
+#define PPG_HISTORY 4
+
+class PpgPipeline {
+public:
+    PpgPipeline();
+
+    // Sample rate of the raw input; false if out of range (10-3200 Hz)
+    bool begin(uint16_t sampleRateHz);
+    void reset();
+
+    void process(const uint32_t* red, const uint32_t* ir, uint16_t count);
+
+    // 0 while there is no reading
+    float heartRate() const { return heartRate_; }     // bpm
+    float spo2() const { return spo2_; }               // %
+    float perfusion() const { return perfusion_; }     // IR AC/DC, %
+    bool fingerPresent() const { return finger_; }
+    uint32_t beats() const { return beats_; }
+    uint16_t analysisRateHz() const { return rate_; }
+
+private:
+    struct Biquad {
+        int32_t x1, x2, y1, y2;
+    };
+
+    struct Channel {
+        uint32_t acc;           // Decimation sum
+        int32_t dcQ8;           // DC, Q8
+        Biquad hp;
+        Biquad lp;
+        int32_t min, max;       // Band-passed extremes since the last beat
+    };
+
+    uint16_t inputRate_;
+    uint16_t rate_;             // Analysis rate
+    uint8_t decimation_;
+    uint8_t decimCount_;
+    uint8_t dcShift_;
+    int32_t hpB_[3], hpA_[2];   // Q28
+    int32_t lpB_[3], lpA_[2];
+
+    Channel red_;
+    Channel ir_;
+
+    // Beat detection on the inverted IR band-pass output
+    int32_t s1_, s2_;           // Previous two samples
+    bool armed_;
+    int32_t envelope_;
+    uint32_t sample_;           // Analysis samples since begin()
+    uint32_t settleUntil_;      // No beats before this sample (filters settling)
+    bool primed_;
+    uint32_t lastBeatQ8_;       // Time of the last beat, samples Q8
+    bool haveBeat_;
+    uint32_t intervals_[PPG_HISTORY];  // Samples Q8
+    float ratios_[PPG_HISTORY];
+    uint8_t intervalCount_;
+    uint8_t ratioCount_;
+    uint8_t rejects_;
+
+    float heartRate_;
+    float spo2_;
+    float perfusion_;
+    bool finger_;
+    uint32_t beats_;
+
+    void analyse(int32_t red, int32_t ir);
+    int32_t filter(Channel& ch, int32_t x);
+    void onBeat(int32_t peak, uint32_t peakQ8);
+    void prime(int32_t red, int32_t ir);
+    void clearBeats();
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_PPG_PIPELINE_H
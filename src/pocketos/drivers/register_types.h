@@ -20,7 +20,7 @@ enum class RegisterAccess {
 /**
  * Bus type (for register access routing)
  */
-enum class BusType {
+enum class BusType : uint8_t {
     I2C = 0,
     SPI = 1,
     UNKNOWN = 255
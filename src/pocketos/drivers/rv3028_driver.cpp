@@ -443,6 +443,10 @@ bool RV3028Driver::setClockOutput(bool enable, uint8_t freq) {
     return writeRegister(RV3028_REG_CLKOUT, clkout);
 }
 
+bool RV3028Driver::enableSecondPulse() {
+    return setClockOutput(true, 5);
+}
+
 bool RV3028Driver::readEEPROM(uint8_t address, uint8_t* data, uint8_t length) {
     if (!initialized || address >= 43 || (address + length) > 43) {
         return false;
@@ -83,6 +83,7 @@ public:
     
     // Clock output control (CLKOUT)
     bool setClockOutput(bool enable, uint8_t freq);  // freq: 0=32.768kHz, 1=8.192kHz, 2=1.024kHz, 3=64Hz, 4=32Hz, 5=1Hz
+    bool enableSecondPulse();  // 1 Hz output (SystemClock pulse input)
     
     // EEPROM access (43 bytes user EEPROM)
     bool readEEPROM(uint8_t address, uint8_t* data, uint8_t length);
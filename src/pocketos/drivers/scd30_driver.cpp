@@ -1,4 +1,5 @@
 #include "scd30_driver.h"
+#include "../core/crc.h"
 #include "../driver_config.h"
 #if POCKETOS_SCD30_ENABLE_LOGGING
 #include "../core/logger.h"
@@ -14,7 +15,8 @@ namespace PocketOS {
 #define SCD30_CMD_READ_MEAS    0x0300
 #define SCD30_CMD_SOFT_RESET   0xD304
 
-SCD30Driver::SCD30Driver() : address(0), initialized(false) {
+SCD30Driver::SCD30Driver()
+    : address(0), initialized(false), configured(false), pending(false), bootReadyAt(0) {
 }
 
 bool SCD30Driver::init(uint8_t i2cAddress) {
@@ -26,8 +28,22 @@ bool SCD30Driver::init(uint8_t i2cAddress) {
 #endif
         return false;
     }
-    delay(2000);
     
+    // The sensor needs 2 s after reset; continuous mode is started by
+    // startMeasurement() once it has booted instead of sleeping here.
+    bootReadyAt = measurementDeadline(2000);
+    configured = false;
+    pending = false;
+    last = SCD30Data();
+    
+    initialized = true;
+#if POCKETOS_SCD30_ENABLE_LOGGING
+    Logger::info("SCD30: Initialized");
+#endif
+    return true;
+}
+
+bool SCD30Driver::startContinuous() {
     if (!sendCommand(SCD30_CMD_SET_INTERVAL, 2)) {
 #if POCKETOS_SCD30_ENABLE_LOGGING
         Logger::error("SCD30: Set interval failed");
@@ -42,10 +58,7 @@ bool SCD30Driver::init(uint8_t i2cAddress) {
         return false;
     }
     
-    initialized = true;
-#if POCKETOS_SCD30_ENABLE_LOGGING
-    Logger::info("SCD30: Initialized");
-#endif
+    configured = true;
     return true;
 }
 
@@ -57,24 +70,42 @@ void SCD30Driver::deinit() {
 }
 
 SCD30Data SCD30Driver::readData() {
+    return measureBlocking(*this);
+}
+
+uint32_t SCD30Driver::startMeasurement() {
+    pending = false;
+    if (!initialized) return measurementDeadline(0);
+    
+    if (!configured) {
+        // Still booting after reset: nothing to read yet
+        if (!measurementDue(bootReadyAt)) return MEASUREMENT_NOT_STARTED;
+        if (!startContinuous()) return measurementDeadline(0);
+        return MEASUREMENT_NOT_STARTED;
+    }
+    
+    if (!sendCommand(SCD30_CMD_READ_MEAS)) return measurementDeadline(0);
+    
+    pending = true;
+    return measurementDeadline(3);  // Minimum 3 ms between command and read
+}
+
+SCD30Data SCD30Driver::collect() {
     SCD30Data data;
-    if (!initialized) return data;
+    if (!pending) return data;
+    pending = false;
     
+    // Three big-endian floats, each as two CRC-protected words
     uint8_t buffer[18];
-    Wire.beginTransmission(address);
-    Wire.write(SCD30_CMD_READ_MEAS >> 8);
-    Wire.write(SCD30_CMD_READ_MEAS & 0xFF);
-    if (Wire.endTransmission() != 0) return data;
+    if (!readData(buffer, 18)) return data;
     
-    delay(10);
-    Wire.requestFrom(address, (uint8_t)18);
-    size_t count = 0;
-    while (Wire.available() && count < 18) {
-        buffer[count++] = Wire.read();
+    if (!Crc::checkSensirionFrame(buffer, 6)) {
+#if POCKETOS_SCD30_ENABLE_LOGGING
+        Logger::error("SCD30: CRC mismatch");
+#endif
+        return data;
     }
     
-    if (count != 18) return data;
-    
     uint32_t co2_raw = ((uint32_t)buffer[0] << 24) | ((uint32_t)buffer[1] << 16) | ((uint32_t)buffer[3] << 8) | buffer[4];
     uint32_t temp_raw = ((uint32_t)buffer[6] << 24) | ((uint32_t)buffer[7] << 16) | ((uint32_t)buffer[9] << 8) | buffer[10];
     uint32_t hum_raw = ((uint32_t)buffer[12] << 24) | ((uint32_t)buffer[13] << 16) | ((uint32_t)buffer[15] << 8) | buffer[16];
@@ -88,6 +119,7 @@ SCD30Data SCD30Driver::readData() {
     data.temperature = temp;
     data.humidity = hum;
     data.valid = true;
+    last = data;
     
     return data;
 }
@@ -108,6 +140,11 @@ String SCD30Driver::getParameter(const String& name) {
     if (name == "address") return "0x" + String(address, HEX);
     if (name == "driver") return "scd30";
     if (name == "tier") return POCKETOS_SCD30_TIER_NAME;
+    if (name == "initialized") return initialized ? "true" : "false";
+    if (name == "running") return configured ? "true" : "false";
+    if (name == "co2") return last.valid ? String(last.co2, 1) : "";
+    if (name == "temperature") return last.valid ? String(last.temperature, 2) : "";
+    if (name == "humidity") return last.valid ? String(last.humidity, 2) : "";
     return "";
 }
 
@@ -121,8 +158,7 @@ bool SCD30Driver::sendCommand(uint16_t cmd, uint16_t arg) {
     Wire.write(cmd & 0xFF);
     Wire.write(arg >> 8);
     Wire.write(arg & 0xFF);
-    uint8_t crc_data[2] = {(uint8_t)(arg >> 8), (uint8_t)(arg & 0xFF)};
-    Wire.write(computeCRC(crc_data, 2));
+    Wire.write(Crc::sensirionWord(arg));
     return (Wire.endTransmission() == 0);
 }
 
@@ -142,21 +178,6 @@ bool SCD30Driver::readData(uint8_t* buffer, size_t len) {
     return (count == len);
 }
 
-uint8_t SCD30Driver::computeCRC(uint8_t data[], uint8_t len) {
-    uint8_t crc = 0xFF;
-    for (uint8_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t bit = 8; bit > 0; --bit) {
-            if (crc & 0x80) {
-                crc = (crc << 1) ^ 0x31;
-            } else {
-                crc = (crc << 1);
-            }
-        }
-    }
-    return crc;
-}
-
 #if POCKETOS_SCD30_ENABLE_REGISTER_ACCESS
 const RegisterDesc* SCD30Driver::registers(size_t& count) const {
     static const RegisterDesc SCD30_REGISTERS[] = {
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "measurement.h"
 
 #if POCKETOS_SCD30_ENABLE_REGISTER_ACCESS
 #include "register_types.h"
@@ -35,9 +36,14 @@ public:
     void deinit();
     bool isInitialized() const { return initialized; }
     
-    // Read measurements
+    // Read measurements (blocking)
     SCD30Data readData();
     
+    // Non-blocking measurement (measurement.h); not started until the
+    // sensor has booted and continuous mode is running
+    uint32_t startMeasurement();
+    SCD30Data collect();
+    
     // Get capability schema
     CapabilitySchema getSchema() const;
     
@@ -76,12 +82,17 @@ public:
 private:
     uint8_t address;
     bool initialized;
+    bool configured;        // Continuous measurement started
+    bool pending;
+    uint32_t bootReadyAt;   // millis() when the post-reset boot is done
+    SCD30Data last;
+    
+    bool startContinuous();
     
     // I2C communication
     bool sendCommand(uint16_t cmd, uint16_t arg);
     bool sendCommand(uint16_t cmd);
     bool readData(uint8_t* buffer, size_t len);
-    uint8_t computeCRC(uint8_t data[], uint8_t len);
 };
 
 } // namespace PocketOS
@@ -1,4 +1,5 @@
 #include "scd40_driver.h"
+#include "../core/crc.h"
 #include "../driver_config.h"
 #if POCKETOS_SCD40_ENABLE_LOGGING
 #include "../core/logger.h"
@@ -72,7 +73,7 @@ SCD40Data SCD40Driver::readData() {
         buffer[count++] = Wire.read();
     }
     
-    if (count != 9) return data;
+    if (count != 9 || !Crc::checkSensirionFrame(buffer, 3)) return data;
     
     uint16_t co2_raw = ((uint16_t)buffer[0] << 8) | buffer[1];
     uint16_t temp_raw = ((uint16_t)buffer[3] << 8) | buffer[4];
@@ -125,21 +126,6 @@ bool SCD40Driver::readData(uint8_t* buffer, size_t len) {
     return (count == len);
 }
 
-uint8_t SCD40Driver::computeCRC(uint8_t data[], uint8_t len) {
-    uint8_t crc = 0xFF;
-    for (uint8_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t bit = 8; bit > 0; --bit) {
-            if (crc & 0x80) {
-                crc = (crc << 1) ^ 0x31;
-            } else {
-                crc = (crc << 1);
-            }
-        }
-    }
-    return crc;
-}
-
 #if POCKETOS_SCD40_ENABLE_REGISTER_ACCESS
 const RegisterDesc* SCD40Driver::registers(size_t& count) const {
     static const RegisterDesc SCD40_REGISTERS[] = {
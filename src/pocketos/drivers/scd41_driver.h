@@ -80,7 +80,6 @@ private:
     // I2C communication
     bool sendCommand(uint16_t cmd);
     bool readData(uint8_t* buffer, size_t len);
-    uint8_t computeCRC(uint8_t data[], uint8_t len);
 };
 
 } // namespace PocketOS
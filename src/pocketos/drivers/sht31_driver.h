@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "measurement.h"
 
 namespace PocketOS {
 
@@ -30,9 +31,13 @@ public:
     void deinit();
     bool isInitialized() const { return initialized; }
     
-    // Read measurements
+    // Read measurements (blocking)
     SHT31Data readData();
     
+    // Non-blocking measurement (measurement.h)
+    uint32_t startMeasurement();
+    SHT31Data collect();
+    
     // Get capability schema
     CapabilitySchema getSchema() const;
     
@@ -69,6 +74,8 @@ public:
 private:
     uint8_t address;
     bool initialized;
+    bool pending;
+    SHT31Data last;         // Latest valid measurement
     
 #if POCKETOS_SHT31_ENABLE_LOGGING
     uint32_t readCount;
@@ -79,8 +86,6 @@ private:
     bool sendCommand(uint16_t cmd);
     bool readData(uint8_t* buffer, size_t len);
     
-    // CRC calculation
-    uint8_t calculateCRC(const uint8_t* data, size_t len);
 };
 
 } // namespace PocketOS
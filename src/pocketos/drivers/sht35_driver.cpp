@@ -1,4 +1,5 @@
 #include "sht35_driver.h"
+#include "../core/crc.h"
 #include "../driver_config.h"
 
 #if POCKETOS_SHT35_ENABLE_LOGGING
@@ -19,7 +20,7 @@ namespace PocketOS {
 #define SHT35_CMD_HEATER_ENABLE      0x306D  // Enable heater
 #define SHT35_CMD_HEATER_DISABLE     0x3066  // Disable heater
 
-SHT35Driver::SHT35Driver() : address(0), initialized(false) {
+SHT35Driver::SHT35Driver() : address(0), initialized(false), pending(false) {
 #if POCKETOS_SHT35_ENABLE_LOGGING
     readCount = 0;
     errorCount = 0;
@@ -30,7 +31,7 @@ bool SHT35Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
     
 #if POCKETOS_SHT35_ENABLE_LOGGING
-    Logger::info("SHT35: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("SHT35: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
     
 #if POCKETOS_SHT35_ENABLE_CONFIGURATION
@@ -52,6 +53,8 @@ bool SHT35Driver::init(uint8_t i2cAddress) {
     }
 #endif
     
+    pending = false;
+    last = SHT35Data();
     initialized = true;
 #if POCKETOS_SHT35_ENABLE_LOGGING
     Logger::info("SHT35: Initialized successfully");
@@ -70,23 +73,35 @@ void SHT35Driver::deinit() {
 }
 
 SHT35Data SHT35Driver::readData() {
-    SHT35Data data;
-    
+    return measureBlocking(*this);
+}
+
+uint32_t SHT35Driver::startMeasurement() {
+    pending = false;
     if (!initialized) {
-        return data;
+        return measurementDeadline(0);
     }
     
-    // Send measurement command (high repeatability)
+    // Send measurement command (high repeatability, no clock stretching)
     if (!sendCommand(SHT35_CMD_MEASURE_HIGH_REP)) {
 #if POCKETOS_SHT35_ENABLE_LOGGING
         errorCount++;
         Logger::error("SHT35: Failed to send measurement command");
 #endif
-        return data;
+        return measurementDeadline(0);
     }
     
-    // Wait for measurement to complete
-    delay(16); // High repeatability measurement takes ~15.5ms
+    pending = true;
+    return measurementDeadline(16); // High repeatability measurement takes ~15.5ms
+}
+
+SHT35Data SHT35Driver::collect() {
+    SHT35Data data;
+    
+    if (!pending) {
+        return data;
+    }
+    pending = false;
     
     // Read 6 bytes: temp MSB, temp LSB, temp CRC, hum MSB, hum LSB, hum CRC
     uint8_t buffer[6];
@@ -99,20 +114,11 @@ SHT35Data SHT35Driver::readData() {
     }
     
 #if POCKETOS_SHT35_ENABLE_ERROR_HANDLING
-    // Verify CRC for temperature
-    if (calculateCRC(buffer, 2) != buffer[2]) {
+    // Verify both words in one pass
+    if (!Crc::checkSensirionFrame(buffer, 2)) {
 #if POCKETOS_SHT35_ENABLE_LOGGING
         errorCount++;
-        Logger::error("SHT35: Temperature CRC mismatch");
-#endif
-        return data;
-    }
-    
-    // Verify CRC for humidity
-    if (calculateCRC(buffer + 3, 2) != buffer[5]) {
-#if POCKETOS_SHT35_ENABLE_LOGGING
-        errorCount++;
-        Logger::error("SHT35: Humidity CRC mismatch");
+        Logger::error("SHT35: CRC mismatch");
 #endif
         return data;
     }
@@ -133,6 +139,7 @@ SHT35Data SHT35Driver::readData() {
     if (data.humidity < 0.0f) data.humidity = 0.0f;
     
     data.valid = true;
+    last = data;
     
 #if POCKETOS_SHT35_ENABLE_LOGGING
     readCount++;
@@ -178,6 +185,10 @@ String SHT35Driver::getParameter(const String& name) {
         return POCKETOS_SHT35_TIER_NAME;
     } else if (name == "initialized") {
         return initialized ? "true" : "false";
+    } else if (name == "temperature") {
+        return last.valid ? String(last.temperature, 2) : "";
+    } else if (name == "humidity") {
+        return last.valid ? String(last.humidity, 2) : "";
     }
 #if POCKETOS_SHT35_ENABLE_HEATER
     else if (name == "heater") {
@@ -254,22 +265,4 @@ bool SHT35Driver::readData(uint8_t* buffer, size_t len) {
     return (bytesRead == len);
 }
 
-uint8_t SHT35Driver::calculateCRC(const uint8_t* data, size_t len) {
-    // CRC-8 with polynomial 0x31 (x^8 + x^5 + x^4 + 1)
-    uint8_t crc = 0xFF;
-    
-    for (size_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t bit = 8; bit > 0; bit--) {
-            if (crc & 0x80) {
-                crc = (crc << 1) ^ 0x31;
-            } else {
-                crc = (crc << 1);
-            }
-        }
-    }
-    
-    return crc;
-}
-
 } // namespace PocketOS
@@ -1,4 +1,5 @@
 #include "sht40_driver.h"
+#include "../core/crc.h"
 #include "../driver_config.h"
 
 #if POCKETOS_SHT40_ENABLE_LOGGING
@@ -16,7 +17,7 @@ namespace PocketOS {
 #define SHT40_CMD_SOFT_RESET          0x94  // Soft reset
 #define SHT40_CMD_READ_SERIAL         0x89  // Read serial number
 
-SHT40Driver::SHT40Driver() : address(0), initialized(false) {
+SHT40Driver::SHT40Driver() : address(0), initialized(false), pending(false) {
 #if POCKETOS_SHT40_ENABLE_LOGGING
     readCount = 0;
     errorCount = 0;
@@ -27,7 +28,7 @@ bool SHT40Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
     
 #if POCKETOS_SHT40_ENABLE_LOGGING
-    Logger::info("SHT40: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("SHT40: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
     
 #if POCKETOS_SHT40_ENABLE_CONFIGURATION
@@ -41,6 +42,8 @@ bool SHT40Driver::init(uint8_t i2cAddress) {
     delay(1); // Wait for reset to complete
 #endif
     
+    pending = false;
+    last = SHT40Data();
     initialized = true;
 #if POCKETOS_SHT40_ENABLE_LOGGING
     Logger::info("SHT40: Initialized successfully");
@@ -53,10 +56,13 @@ void SHT40Driver::deinit() {
 }
 
 SHT40Data SHT40Driver::readData() {
-    SHT40Data data;
-    
+    return measureBlocking(*this);
+}
+
+uint32_t SHT40Driver::startMeasurement() {
+    pending = false;
     if (!initialized) {
-        return data;
+        return measurementDeadline(0);
     }
     
     // Send measurement command (high precision)
@@ -65,11 +71,20 @@ SHT40Data SHT40Driver::readData() {
         errorCount++;
         Logger::error("SHT40: Failed to send measurement command");
 #endif
-        return data;
+        return measurementDeadline(0);
     }
     
-    // Wait for measurement to complete
-    delay(10); // High precision measurement takes ~8.3ms
+    pending = true;
+    return measurementDeadline(10); // High precision measurement takes ~8.3ms
+}
+
+SHT40Data SHT40Driver::collect() {
+    SHT40Data data;
+    
+    if (!pending) {
+        return data;
+    }
+    pending = false;
     
     // Read 6 bytes: temp MSB, temp LSB, temp CRC, hum MSB, hum LSB, hum CRC
     uint8_t buffer[6];
@@ -82,20 +97,11 @@ SHT40Data SHT40Driver::readData() {
     }
     
 #if POCKETOS_SHT40_ENABLE_ERROR_HANDLING
-    // Verify CRC for temperature
-    if (calculateCRC(buffer, 2) != buffer[2]) {
+    // Verify both words in one pass
+    if (!Crc::checkSensirionFrame(buffer, 2)) {
 #if POCKETOS_SHT40_ENABLE_LOGGING
         errorCount++;
-        Logger::error("SHT40: Temperature CRC mismatch");
-#endif
-        return data;
-    }
-    
-    // Verify CRC for humidity
-    if (calculateCRC(buffer + 3, 2) != buffer[5]) {
-#if POCKETOS_SHT40_ENABLE_LOGGING
-        errorCount++;
-        Logger::error("SHT40: Humidity CRC mismatch");
+        Logger::error("SHT40: CRC mismatch");
 #endif
         return data;
     }
@@ -116,6 +122,7 @@ SHT40Data SHT40Driver::readData() {
     if (data.humidity < 0.0f) data.humidity = 0.0f;
     
     data.valid = true;
+    last = data;
     
 #if POCKETOS_SHT40_ENABLE_LOGGING
     readCount++;
@@ -157,6 +164,10 @@ String SHT40Driver::getParameter(const String& name) {
         return POCKETOS_SHT40_TIER_NAME;
     } else if (name == "initialized") {
         return initialized ? "true" : "false";
+    } else if (name == "temperature") {
+        return last.valid ? String(last.temperature, 2) : "";
+    } else if (name == "humidity") {
+        return last.valid ? String(last.humidity, 2) : "";
     }
 #if POCKETOS_SHT40_ENABLE_LOGGING
     else if (name == "read_count") {
@@ -189,22 +200,4 @@ bool SHT40Driver::readData(uint8_t* buffer, size_t len) {
     return (bytesRead == len);
 }
 
-uint8_t SHT40Driver::calculateCRC(const uint8_t* data, size_t len) {
-    // CRC-8 with polynomial 0x31 (x^8 + x^5 + x^4 + 1)
-    uint8_t crc = 0xFF;
-    
-    for (size_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t bit = 8; bit > 0; bit--) {
-            if (crc & 0x80) {
-                crc = (crc << 1) ^ 0x31;
-            } else {
-                crc = (crc << 1);
-            }
-        }
-    }
-    
-    return crc;
-}
-
 } // namespace PocketOS
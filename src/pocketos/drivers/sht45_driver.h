@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
+#include "measurement.h"
 
 namespace PocketOS {
 
@@ -30,9 +31,13 @@ public:
     void deinit();
     bool isInitialized() const { return initialized; }
     
-    // Read measurements
+    // Read measurements (blocking)
     SHT45Data readData();
     
+    // Non-blocking measurement (measurement.h)
+    uint32_t startMeasurement();
+    SHT45Data collect();
+    
     // Get capability schema
     CapabilitySchema getSchema() const;
     
@@ -63,6 +68,8 @@ public:
 private:
     uint8_t address;
     bool initialized;
+    bool pending;
+    SHT45Data last;         // Latest valid measurement
     
 #if POCKETOS_SHT45_ENABLE_LOGGING
     uint32_t readCount;
@@ -73,8 +80,6 @@ private:
     bool sendCommand(uint8_t cmd);
     bool readData(uint8_t* buffer, size_t len);
     
-    // CRC calculation
-    uint8_t calculateCRC(const uint8_t* data, size_t len);
 };
 
 } // namespace PocketOS
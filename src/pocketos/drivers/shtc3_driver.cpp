@@ -1,4 +1,5 @@
 #include "shtc3_driver.h"
+#include "../core/crc.h"
 #include "../driver_config.h"
 
 #if POCKETOS_SHTC3_ENABLE_LOGGING
@@ -30,7 +31,7 @@ bool SHTC3Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
     
 #if POCKETOS_SHTC3_ENABLE_LOGGING
-    Logger::info("SHTC3: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("SHTC3: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
     
 #if POCKETOS_SHTC3_ENABLE_CONFIGURATION
@@ -100,21 +101,11 @@ SHTC3Data SHTC3Driver::readData() {
     }
     
 #if POCKETOS_SHTC3_ENABLE_ERROR_HANDLING
-    // Verify CRC for temperature
-    if (calculateCRC(buffer, 2) != buffer[2]) {
+    // Verify both words in one pass
+    if (!Crc::checkSensirionFrame(buffer, 2)) {
 #if POCKETOS_SHTC3_ENABLE_LOGGING
         errorCount++;
-        Logger::error("SHTC3: Temperature CRC mismatch");
-#endif
-        sendCommand(SHTC3_CMD_SLEEP); // Put sensor back to sleep
-        return data;
-    }
-    
-    // Verify CRC for humidity
-    if (calculateCRC(buffer + 3, 2) != buffer[5]) {
-#if POCKETOS_SHTC3_ENABLE_LOGGING
-        errorCount++;
-        Logger::error("SHTC3: Humidity CRC mismatch");
+        Logger::error("SHTC3: CRC mismatch");
 #endif
         sendCommand(SHTC3_CMD_SLEEP); // Put sensor back to sleep
         return data;
@@ -213,22 +204,4 @@ bool SHTC3Driver::readData(uint8_t* buffer, size_t len) {
     return (bytesRead == len);
 }
 
-uint8_t SHTC3Driver::calculateCRC(const uint8_t* data, size_t len) {
-    // CRC-8 with polynomial 0x31 (x^8 + x^5 + x^4 + 1)
-    uint8_t crc = 0xFF;
-    
-    for (size_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t bit = 8; bit > 0; bit--) {
-            if (crc & 0x80) {
-                crc = (crc << 1) ^ 0x31;
-            } else {
-                crc = (crc << 1);
-            }
-        }
-    }
-    
-    return crc;
-}
-
 } // namespace PocketOS
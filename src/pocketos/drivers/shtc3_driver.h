@@ -73,8 +73,6 @@ private:
     bool sendCommand(uint16_t cmd);
     bool readData(uint8_t* buffer, size_t len);
     
-    // CRC calculation
-    uint8_t calculateCRC(const uint8_t* data, size_t len);
 };
 
 } // namespace PocketOS
@@ -1,4 +1,5 @@
 #include "si7021_driver.h"
+#include "../core/crc.h"
 #include "../driver_config.h"
 
 #if POCKETOS_SI7021_ENABLE_LOGGING
@@ -32,7 +33,7 @@ bool SI7021Driver::init(uint8_t i2cAddress) {
     address = i2cAddress;
     
 #if POCKETOS_SI7021_ENABLE_LOGGING
-    Logger::info("SI7021: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("SI7021: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
     
 #if POCKETOS_SI7021_ENABLE_CONFIGURATION
@@ -94,7 +95,7 @@ SI7021Data SI7021Driver::readData() {
     
 #if POCKETOS_SI7021_ENABLE_ERROR_HANDLING
     // Verify CRC for humidity
-    if (calculateCRC(humBuffer, 2) != humBuffer[2]) {
+    if (Crc::crc8(humBuffer, 2, 0x00) != humBuffer[2]) {
 #if POCKETOS_SI7021_ENABLE_LOGGING
         errorCount++;
         Logger::error("SI7021: Humidity CRC mismatch");
@@ -275,22 +276,4 @@ bool SI7021Driver::readData(uint8_t* buffer, size_t len) {
     return (bytesRead == len);
 }
 
-uint8_t SI7021Driver::calculateCRC(const uint8_t* data, size_t len) {
-    // CRC-8 with polynomial 0x31 (x^8 + x^5 + x^4 + 1)
-    uint8_t crc = 0x00;
-    
-    for (size_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t bit = 8; bit > 0; bit--) {
-            if (crc & 0x80) {
-                crc = (crc << 1) ^ 0x31;
-            } else {
-                crc = (crc << 1);
-            }
-        }
-    }
-    
-    return crc;
-}
-
 } // namespace PocketOS
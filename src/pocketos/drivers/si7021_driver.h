@@ -78,9 +78,6 @@ private:
     // I2C communication
     bool sendCommand(uint8_t cmd);
     bool readData(uint8_t* buffer, size_t len);
-    
-    // CRC calculation
-    uint8_t calculateCRC(const uint8_t* data, size_t len);
 };
 
 } // namespace PocketOS
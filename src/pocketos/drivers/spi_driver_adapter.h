@@ -0,0 +1,63 @@
+#ifndef POCKETOS_SPI_DRIVER_ADAPTER_H
+#define POCKETOS_SPI_DRIVER_ADAPTER_H
+
+#include <Arduino.h>
+#include "../core/device_registry.h"
+#include "../core/capability_schema.h"
+#include "i2c_driver_adapter.h"
+
+namespace PocketOS {
+
+/**
+ * SPI Driver Adapter
+ *
+ * Wraps an SPI driver (init(endpoint), getSchema(), update(), deinit(),
+ * and optionally getParameter()/setParameter()) in the IDriver interface
+ * so it can be bound in DeviceRegistry to an endpoint such as
+ * "spi0:cs=5,irq=4".
+ *
+ * update() is called every main loop pass; the driver decides what to do
+ * (drain a FIFO, service its irq= pin, ...). SPI drivers attach their own
+ * irq= pin through SPIDriverBase::attachIrq(), so the registry's irq
+ * param does not apply to them.
+ */
+
+template <typename TDriver>
+class SPIDriverAdapter : public IDriver {
+public:
+    explicit SPIDriverAdapter(const String& endpoint) : endpoint(endpoint) {}
+
+    virtual ~SPIDriverAdapter() {
+        driver.deinit();
+    }
+
+    virtual bool init() override {
+        return driver.init(endpoint);
+    }
+
+    virtual bool setParam(const String& name, const String& value) override {
+        return AdapterDetail::setParameter(driver, name, value, 0);
+    }
+
+    virtual String getParam(const String& name) override {
+        return AdapterDetail::getParameter(driver, name, 0);
+    }
+
+    virtual CapabilitySchema getSchema() override {
+        return driver.getSchema();
+    }
+
+    virtual void update() override {
+        driver.update();
+    }
+
+    TDriver& getDriver() { return driver; }
+
+private:
+    TDriver driver;
+    String endpoint;
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_SPI_DRIVER_ADAPTER_H
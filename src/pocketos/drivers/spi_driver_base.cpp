@@ -3,11 +3,44 @@
 #include "../core/logger.h"
 #include <SPI.h>
 
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
+
 namespace PocketOS {
 
+// Source of dummy bytes for receive-only and clock-only segments
+static const uint8_t SPI_ZERO_CHUNK[32] = { 0 };
+
+#if defined(ARDUINO_ARCH_ESP32)
+struct SPIAsyncJob {
+    SPIDriverBase* owner;
+    const SPITransferDesc* chain;
+    size_t count;
+    SPITransferCallback callback;
+    void* context;
+};
+
+static QueueHandle_t s_asyncQueue = nullptr;
+static TaskHandle_t s_asyncTask = nullptr;
+
+// Bus ownership: taken when a chain is queued, given by the transfer task
+// after the callback returns (binary semaphore, created with the task)
+static SemaphoreHandle_t s_busSem = nullptr;
+
+// The transfer task already owns the bus while a callback runs
+static bool onTransferTask() {
+    return s_asyncTask && xTaskGetCurrentTaskHandle() == s_asyncTask;
+}
+#endif
+
 SPIDriverBase::SPIDriverBase() 
     : initialized_(false), 
-      reg_convention_(SPIRegisterConvention::GENERIC) {
+      reg_convention_(SPIRegisterConvention::GENERIC),
+      irq_line_(-1) {
     pins_.cs = -1;
     pins_.dc = -1;
     pins_.rst = -1;
@@ -26,7 +59,7 @@ bool SPIDriverBase::initFromEndpoint(const String& endpoint) {
     
     // Parse endpoint descriptor
     if (!parseEndpoint(endpoint)) {
-        Logger::error("SPIDriverBase: Failed to parse endpoint: " + endpoint);
+        Logger::error(("SPIDriverBase: Failed to parse endpoint: " + endpoint).c_str());
         return false;
     }
     
@@ -69,7 +102,7 @@ bool SPIDriverBase::initFromEndpoint(const String& endpoint) {
     }
     
     initialized_ = true;
-    Logger::info("SPIDriverBase: Initialized on SPI" + String(bus_config_.bus_id) + ", CS=" + String(pins_.cs));
+    Logger::info(("SPIDriverBase: Initialized on SPI" + String(bus_config_.bus_id) + ", CS=" + String(pins_.cs)).c_str());
     return true;
 }
 
@@ -78,6 +111,14 @@ void SPIDriverBase::deinit() {
         return;
     }
     
+    // The transfer task may still be using this device
+    spiWaitIdle();
+    
+    if (irq_line_ >= 0) {
+        InterruptManager::detach(irq_line_);
+        irq_line_ = -1;
+    }
+    
     // Release CS (set inactive)
     if (pins_.cs >= 0) {
         digitalWrite(pins_.cs, HIGH);
@@ -89,6 +130,15 @@ void SPIDriverBase::deinit() {
     initialized_ = false;
 }
 
+bool SPIDriverBase::attachIrq(IrqEdge edge, IrqHandler handler, void* context) {
+    if (!initialized_ || pins_.irq < 0 || irq_line_ >= 0) {
+        return false;
+    }
+    // The pin is already claimed under owner_id_; the claim stays with us
+    irq_line_ = InterruptManager::attach(pins_.irq, edge, handler, context, owner_id_.c_str());
+    return irq_line_ >= 0;
+}
+
 bool SPIDriverBase::parseEndpoint(const String& endpoint) {
     // Format: "spi0:cs=5,dc=16,rst=17,irq=4,busy=27"
     
@@ -128,13 +178,12 @@ bool SPIDriverBase::parseEndpoint(const String& endpoint) {
                 pins_.dc = value;
             } else if (key == "rst" || key == "reset") {
                 pins_.rst = value;
-            } else if (key == "irq" || key == "int") {
+            } else if (key == "irq" || key == "int" || key == "dio0") {
                 pins_.irq = value;
             } else if (key == "busy") {
                 pins_.busy = value;
             }
         }
-        }
         
         startIdx = commaIdx + 1;
     }
@@ -264,6 +313,7 @@ bool SPIDriverBase::readBusy() const {
 }
 
 void SPIDriverBase::beginTransaction() {
+    spiWaitIdle();
     SPISettings settings(bus_config_.speed_hz, bus_config_.bit_order, bus_config_.mode);
     SPI.beginTransaction(settings);
     setCS(true);  // Activate CS
@@ -274,71 +324,290 @@ void SPIDriverBase::endTransaction() {
     SPI.endTransaction();
 }
 
-bool SPIDriverBase::spiTransfer(uint8_t* data, size_t len) {
-    if (!initialized_) {
-        return false;
+void SPIDriverBase::writeBytes(const uint8_t* data, size_t len) {
+    if (!data) {
+        // Clock out zeros
+        while (len > 0) {
+            size_t n = len < sizeof(SPI_ZERO_CHUNK) ? len : sizeof(SPI_ZERO_CHUNK);
+            writeBytes(SPI_ZERO_CHUNK, n);
+            len -= n;
+        }
+        return;
     }
     
-    beginTransaction();
-    for (size_t i = 0; i < len; i++) {
-        data[i] = SPI.transfer(data[i]);
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    SPI.writeBytes(data, len);
+#elif defined(ARDUINO_ARCH_RP2040)
+    SPI.transfer(data, nullptr, len);
+#else
+    uint8_t chunk[32];
+    while (len > 0) {
+        size_t n = len < sizeof(chunk) ? len : sizeof(chunk);
+        memcpy(chunk, data, n);
+        SPI.transfer(chunk, n);
+        data += n;
+        len -= n;
+    }
+#endif
+}
+
+void SPIDriverBase::transferBytes(const uint8_t* tx, uint8_t* rx, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    if (!rx) {
+        writeBytes(tx, len);
+        return;
     }
-    endTransaction();
     
-    return true;
+    // Receive-only: send zeros from the receive buffer itself
+    if (!tx) {
+        memset(rx, 0, len);
+        tx = rx;
+    }
+    
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    SPI.transferBytes(tx, rx, len);
+#elif defined(ARDUINO_ARCH_RP2040)
+    SPI.transfer(tx, rx, len);
+#else
+    if (tx != rx) {
+        memcpy(rx, tx, len);
+    }
+    SPI.transfer(rx, len);
+#endif
 }
 
-bool SPIDriverBase::spiWrite(const uint8_t* data, size_t len) {
-    if (!initialized_) {
-        return false;
+void SPIDriverBase::writePattern16(uint16_t value, uint32_t count) {
+    if (count == 0) {
+        return;
     }
     
-    beginTransaction();
-    for (size_t i = 0; i < len; i++) {
-        SPI.transfer(data[i]);
-    }
-    endTransaction();
+    uint8_t pattern[2] = { (uint8_t)(value >> 8), (uint8_t)(value & 0xFF) };
     
-    return true;
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    // Core replicates the pattern into the hardware FIFO
+    SPI.writePattern(pattern, 2, count);
+#else
+    // Pre-fill a line once, then stream it
+    uint8_t line[POCKETOS_SPI_FILL_BUFFER];
+    const uint32_t linePixels = sizeof(line) / 2;
+    uint32_t fill = count < linePixels ? count : linePixels;
+    for (uint32_t i = 0; i < fill; i++) {
+        line[i * 2] = pattern[0];
+        line[i * 2 + 1] = pattern[1];
+    }
+    while (count > 0) {
+        uint32_t n = count < linePixels ? count : linePixels;
+        writeBytes(line, n * 2);
+        count -= n;
+    }
+#endif
 }
 
-bool SPIDriverBase::spiRead(uint8_t* data, size_t len) {
-    if (!initialized_) {
-        return false;
+void SPIDriverBase::writeWords(const uint16_t* values, size_t count) {
+    // Byte-swap a line at a time, then one bulk write per line
+    uint8_t line[POCKETOS_SPI_FILL_BUFFER];
+    const size_t lineWords = sizeof(line) / 2;
+    while (count > 0) {
+        size_t n = count < lineWords ? count : lineWords;
+        for (size_t i = 0; i < n; i++) {
+            line[i * 2] = (uint8_t)(values[i] >> 8);
+            line[i * 2 + 1] = (uint8_t)(values[i] & 0xFF);
+        }
+        writeBytes(line, n * 2);
+        values += n;
+        count -= n;
     }
+}
+
+bool SPIDriverBase::runChain(const SPITransferDesc* chain, size_t count) {
+    SPISettings settings(bus_config_.speed_hz, bus_config_.bit_order, bus_config_.mode);
+    SPI.beginTransaction(settings);
+    setCS(true);
     
-    beginTransaction();
-    for (size_t i = 0; i < len; i++) {
-        data[i] = SPI.transfer(0x00);  // Send dummy byte
+    for (size_t i = 0; i < count; i++) {
+        if (chain[i].dc == SPIDCMode::COMMAND) {
+            setDCCommand();
+        } else if (chain[i].dc == SPIDCMode::DATA) {
+            setDCData();
+        }
+        transferBytes(chain[i].tx, chain[i].rx, chain[i].len);
     }
-    endTransaction();
     
+    setCS(false);
+    SPI.endTransaction();
     return true;
 }
 
-bool SPIDriverBase::spiWriteRead(const uint8_t* write_data, size_t write_len, 
-                                  uint8_t* read_data, size_t read_len) {
-    if (!initialized_) {
+bool SPIDriverBase::spiTransaction(const SPITransferDesc* chain, size_t count) {
+    if (!initialized_ || !chain) {
         return false;
     }
     
-    beginTransaction();
+    spiWaitIdle();
+    return runChain(chain, count);
+}
+
+bool SPIDriverBase::spiTransactionAsync(const SPITransferDesc* chain, size_t count,
+                                        SPITransferCallback callback, void* context) {
+    if (!initialized_ || !chain) {
+        return false;
+    }
     
-    // Write phase
-    for (size_t i = 0; i < write_len; i++) {
-        SPI.transfer(write_data[i]);
+#if defined(ARDUINO_ARCH_ESP32)
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += chain[i].len;
     }
     
-    // Read phase
-    for (size_t i = 0; i < read_len; i++) {
-        read_data[i] = SPI.transfer(0x00);  // Send dummy byte
+    if (total >= POCKETOS_SPI_ASYNC_THRESHOLD && startAsyncTask()) {
+        // A callback queueing a follow-on chain keeps the bus it already has
+        bool chained = onTransferTask();
+        if (chained || xSemaphoreTake(s_busSem, portMAX_DELAY) == pdTRUE) {
+            SPIAsyncJob job = { this, chain, count, callback, context };
+            if (xQueueSend(s_asyncQueue, &job, 0) == pdTRUE) {
+                return true;
+            }
+            if (!chained) {
+                xSemaphoreGive(s_busSem);
+            }
+        }
     }
+#endif
     
-    endTransaction();
+    // Short chain or no transfer task: run inline
+    bool ok = spiTransaction(chain, count);
+    if (callback) {
+        callback(context, ok);
+    }
+    return ok;
+}
+
+SPIChainSink SPIDriverBase::chainSink() {
+    SPIChainSink sink = { this, &SPIDriverBase::sinkSend, &SPIDriverBase::spiWaitIdle };
+    return sink;
+}
+
+bool SPIDriverBase::sinkSend(SPIDriverBase* device, const SPITransferDesc* chain, size_t count) {
+    return device->spiTransactionAsync(chain, count, nullptr, nullptr);
+}
+
+GfxImageSink SPIDriverBase::imageSink(void (*window)(void* context, int32_t x, int32_t y, uint16_t w, uint16_t h)) {
+    GfxImageSink sink = { this, window, &SPIDriverBase::sinkFill, &SPIDriverBase::sinkPush, &SPIDriverBase::sinkEnd };
+    return sink;
+}
+
+void SPIDriverBase::sinkFill(void*, uint16_t color, uint32_t count) {
+    writePattern16(color, count);
+}
+
+void SPIDriverBase::sinkPush(void*, const uint16_t* pixels, uint32_t count) {
+    writeWords(pixels, count);
+}
+
+void SPIDriverBase::sinkEnd(void* context) {
+    static_cast<SPIDriverBase*>(context)->endTransaction();
+}
+
+bool SPIDriverBase::spiBusy() {
+#if defined(ARDUINO_ARCH_ESP32)
+    return s_busSem && uxSemaphoreGetCount(s_busSem) == 0;
+#else
+    return false;
+#endif
+}
+
+void SPIDriverBase::spiWaitIdle() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (!s_busSem || onTransferTask()) {
+        return;
+    }
+    // Block until the transfer task gives the bus back
+    xSemaphoreTake(s_busSem, portMAX_DELAY);
+    xSemaphoreGive(s_busSem);
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+bool SPIDriverBase::startAsyncTask() {
+    if (s_asyncQueue) {
+        return true;
+    }
     
+    s_busSem = xSemaphoreCreateBinary();
+    if (!s_busSem) {
+        return false;
+    }
+    xSemaphoreGive(s_busSem);
+    s_asyncQueue = xQueueCreate(1, sizeof(SPIAsyncJob));
+    if (!s_asyncQueue) {
+        vSemaphoreDelete(s_busSem);
+        s_busSem = nullptr;
+        return false;
+    }
+    
+    // Run transfers on the core the Arduino loop is not using
+#if portNUM_PROCESSORS > 1
+    BaseType_t core = 1 - xPortGetCoreID();
+#else
+    BaseType_t core = tskNO_AFFINITY;
+#endif
+    if (xTaskCreatePinnedToCore(asyncTask, "spi_async", 3072, nullptr, 5, &s_asyncTask, core) != pdPASS) {
+        vQueueDelete(s_asyncQueue);
+        s_asyncQueue = nullptr;
+        vSemaphoreDelete(s_busSem);
+        s_busSem = nullptr;
+        Logger::error("SPIDriverBase: Failed to start SPI transfer task");
+        return false;
+    }
     return true;
 }
 
+void SPIDriverBase::asyncTask(void* arg) {
+    (void)arg;
+    SPIAsyncJob job;
+    for (;;) {
+        if (xQueueReceive(s_asyncQueue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        bool ok = job.owner->runChain(job.chain, job.count);
+        if (job.callback) {
+            job.callback(job.context, ok);
+        }
+        
+        // Still owned if the callback queued the next chain
+        if (uxQueueMessagesWaiting(s_asyncQueue) == 0) {
+            xSemaphoreGive(s_busSem);
+        }
+    }
+}
+#endif
+
+bool SPIDriverBase::spiTransfer(uint8_t* data, size_t len) {
+    SPITransferDesc chain[1] = { SPITransferDesc::transfer(data, data, len) };
+    return spiTransaction(chain, 1);
+}
+
+bool SPIDriverBase::spiWrite(const uint8_t* data, size_t len) {
+    SPITransferDesc chain[1] = { SPITransferDesc::write(data, len) };
+    return spiTransaction(chain, 1);
+}
+
+bool SPIDriverBase::spiRead(uint8_t* data, size_t len) {
+    SPITransferDesc chain[1] = { SPITransferDesc::read(data, len) };
+    return spiTransaction(chain, 1);
+}
+
+bool SPIDriverBase::spiWriteRead(const uint8_t* write_data, size_t write_len, 
+                                  uint8_t* read_data, size_t read_len) {
+    SPITransferDesc chain[2] = {
+        SPITransferDesc::write(write_data, write_len),
+        SPITransferDesc::read(read_data, read_len)
+    };
+    return spiTransaction(chain, 2);
+}
+
 uint8_t SPIDriverBase::prepareReadCommand(uint8_t reg) {
     return SPIRegisterUtils::toReadAddr(reg, reg_convention_);
 }
@@ -371,28 +640,16 @@ bool SPIDriverBase::regWrite(uint16_t reg, const uint8_t* buf, size_t len) {
     }
     
     uint8_t reg8 = (uint8_t)reg;
-    uint8_t cmd = prepareWriteCommand(reg8);
-    
-    if (SPIRegisterUtils::requiresCommandByte(reg_convention_)) {
-        // MCP2515 style: send WRITE command, then register address, then data
-        beginTransaction();
-        SPI.transfer(cmd);    // WRITE command
-        SPI.transfer(reg8);   // Register address
-        for (size_t i = 0; i < len; i++) {
-            SPI.transfer(buf[i]);
-        }
-        endTransaction();
-        return true;
-    } else {
-        // NRF24/Generic style: send modified register address, then data
-        beginTransaction();
-        SPI.transfer(cmd);    // Modified register address
-        for (size_t i = 0; i < len; i++) {
-            SPI.transfer(buf[i]);
-        }
-        endTransaction();
-        return true;
-    }
+    uint8_t header[2] = { prepareWriteCommand(reg8), reg8 };
+    
+    // MCP2515 style: WRITE command + register address; NRF24/Generic style:
+    // modified register address only. Header and data share one CS assertion.
+    size_t header_len = SPIRegisterUtils::requiresCommandByte(reg_convention_) ? 2 : 1;
+    SPITransferDesc chain[2] = {
+        SPITransferDesc::write(header, header_len),
+        SPITransferDesc::write(buf, len)
+    };
+    return spiTransaction(chain, 2);
 }
 
 const RegisterDesc* SPIDriverBase::findRegisterByName(const String& name) const {
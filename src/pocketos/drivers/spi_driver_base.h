@@ -5,9 +5,34 @@
 #include <SPI.h>
 #include "../driver_config.h"
 #include "register_types.h"
+#include "gfx_image.h"
+#include "../core/interrupt_manager.h"
 
 namespace PocketOS {
 
+/**
+ * Asynchronous transfer threshold (bytes)
+ *
+ * spiTransactionAsync() chains whose total length is at least this many
+ * bytes are handed to the SPI transfer task (ESP32); shorter chains are
+ * cheaper to run inline and complete before the call returns.
+ * Can be overridden via build flags: -DPOCKETOS_SPI_ASYNC_THRESHOLD=256
+ */
+#ifndef POCKETOS_SPI_ASYNC_THRESHOLD
+#define POCKETOS_SPI_ASYNC_THRESHOLD 64
+#endif
+
+/**
+ * Block fill line buffer (bytes)
+ *
+ * writePattern16() and writeWords() stream 16-bit values through a line
+ * buffer of this size on cores without a native pattern write.
+ * Can be overridden via build flags: -DPOCKETOS_SPI_FILL_BUFFER=512
+ */
+#ifndef POCKETOS_SPI_FILL_BUFFER
+#define POCKETOS_SPI_FILL_BUFFER 128
+#endif
+
 // SPI register access conventions
 enum class SPIRegisterConvention {
     GENERIC = 0,     // Address byte(s), then data
@@ -36,6 +61,59 @@ struct SPIBusConfig {
     SPIBusConfig() : bus_id(0), speed_hz(1000000), mode(SPI_MODE0), bit_order(MSBFIRST) {}
 };
 
+// DC pin level for one segment of a chained transaction
+enum class SPIDCMode : uint8_t {
+    KEEP = 0,      // Leave DC as it is
+    COMMAND = 1,   // DC LOW before the segment
+    DATA = 2       // DC HIGH before the segment
+};
+
+// One segment of a chained transaction. All segments of a chain are
+// clocked under a single CS assertion, each with one bulk transfer.
+struct SPITransferDesc {
+    const uint8_t* tx;   // Bytes to send (nullptr = clock out 0x00)
+    uint8_t* rx;         // Bytes received (nullptr = discard)
+    size_t len;
+    SPIDCMode dc;
+
+    static SPITransferDesc write(const uint8_t* tx, size_t len) {
+        SPITransferDesc d = { tx, nullptr, len, SPIDCMode::KEEP };
+        return d;
+    }
+    static SPITransferDesc read(uint8_t* rx, size_t len) {
+        SPITransferDesc d = { nullptr, rx, len, SPIDCMode::KEEP };
+        return d;
+    }
+    static SPITransferDesc transfer(const uint8_t* tx, uint8_t* rx, size_t len) {
+        SPITransferDesc d = { tx, rx, len, SPIDCMode::KEEP };
+        return d;
+    }
+    static SPITransferDesc command(const uint8_t* tx, size_t len) {
+        SPITransferDesc d = { tx, nullptr, len, SPIDCMode::COMMAND };
+        return d;
+    }
+    static SPITransferDesc data(const uint8_t* tx, size_t len) {
+        SPITransferDesc d = { tx, nullptr, len, SPIDCMode::DATA };
+        return d;
+    }
+};
+
+// Completion callback for asynchronous transactions.
+// Runs on the SPI transfer task (ESP32) or inline; keep it short. The bus
+// stays owned until it returns; a chain it queues runs next.
+typedef void (*SPITransferCallback)(void* context, bool ok);
+
+class SPIDriverBase;
+
+// Lets a helper that builds chains for a driver (TFTFramebuffer) send them
+// through that driver: send() is spiTransactionAsync() without a callback,
+// waitIdle() is spiWaitIdle()
+struct SPIChainSink {
+    SPIDriverBase* device;
+    bool (*send)(SPIDriverBase* device, const SPITransferDesc* chain, size_t count);
+    void (*waitIdle)();
+};
+
 // SPI Driver Base Class
 class SPIDriverBase {
 public:
@@ -43,7 +121,7 @@ public:
     virtual ~SPIDriverBase();
     
     // Parse and initialize from endpoint descriptor
-    // Format: "spi0:cs=5,dc=16,rst=17,irq=4,busy=27"
+    // Format: "spi0:cs=5,dc=16,rst=17,irq=4,busy=27" (dio0= is an alias for irq=)
     bool initFromEndpoint(const String& endpoint);
     
     // Deinitialize and release resources
@@ -81,16 +159,56 @@ public:
     virtual const RegisterDesc* findRegisterByName(const String& name) const;
     
 protected:
-    // Low-level SPI transaction helpers
+    // Low-level SPI transaction helpers (each is one CS assertion)
     bool spiTransfer(uint8_t* data, size_t len);
     bool spiWrite(const uint8_t* data, size_t len);
     bool spiRead(uint8_t* data, size_t len);
     bool spiWriteRead(const uint8_t* write_data, size_t write_len, uint8_t* read_data, size_t read_len);
     
-    // Transaction management
+    // Chained transaction: all segments under one CS assertion
+    bool spiTransaction(const SPITransferDesc* chain, size_t count);
+    
+    // Asynchronous chained transaction. The chain and its buffers must stay
+    // valid until the callback runs. Chains shorter than
+    // POCKETOS_SPI_ASYNC_THRESHOLD (or on platforms without a transfer task)
+    // run inline and the callback fires before this returns.
+    bool spiTransactionAsync(const SPITransferDesc* chain, size_t count,
+                             SPITransferCallback callback, void* context);
+    
+    // Asynchronous transaction state (one in flight per bus). spiWaitIdle()
+    // blocks until the transfer task releases the bus.
+    static bool spiBusy();
+    static void spiWaitIdle();
+    
+    // This device as a chain sink for shared helpers
+    SPIChainSink chainSink();
+    
+    // This device as a gfxStreamImage() target. window() is the driver's:
+    // it sets the address window and leaves a data transaction open
+    // (beginTransaction(), setDCData()); pixels then go out as pattern
+    // and word writes and end() closes the transaction.
+    GfxImageSink imageSink(void (*window)(void* context, int32_t x, int32_t y, uint16_t w, uint16_t h));
+    
+    // Transaction management (beginTransaction waits for async work to finish)
     void beginTransaction();
     void endTransaction();
     
+    // Bulk data phase inside beginTransaction()/endTransaction():
+    // one core call per buffer instead of one SPI.transfer() per byte
+    static void writeBytes(const uint8_t* data, size_t len);
+    static void transferBytes(const uint8_t* tx, uint8_t* rx, size_t len);
+    
+    // Block fill: send a 16-bit value (MSB first) count times
+    static void writePattern16(uint16_t value, uint32_t count);
+    
+    // Send 16-bit values MSB first (e.g. RGB565 pixels) in bulk
+    static void writeWords(const uint16_t* values, size_t count);
+    
+    // Attach the endpoint's irq= pin to InterruptManager; the handler runs
+    // from the main loop. Detached by deinit(). False without an irq pin.
+    bool attachIrq(IrqEdge edge, IrqHandler handler, void* context);
+    int irqLine() const { return irq_line_; }
+    
     // Helper for register access based on convention
     uint8_t prepareReadCommand(uint8_t reg);
     uint8_t prepareWriteCommand(uint8_t reg);
@@ -101,6 +219,10 @@ private:
     SPIBusConfig bus_config_;
     SPIRegisterConvention reg_convention_;
     String owner_id_;  // For resource manager
+    int irq_line_;     // InterruptManager line, -1 = none
+    
+    // Run a chain on the bus (caller has already waited for idle)
+    bool runChain(const SPITransferDesc* chain, size_t count);
     
     // Parse endpoint descriptor
     bool parseEndpoint(const String& endpoint);
@@ -108,6 +230,17 @@ private:
     // Claim/release pins via ResourceManager
     bool claimPins();
     void releasePins();
+    
+    static bool sinkSend(SPIDriverBase* device, const SPITransferDesc* chain, size_t count);
+    static void sinkFill(void* context, uint16_t color, uint32_t count);
+    static void sinkPush(void* context, const uint16_t* pixels, uint32_t count);
+    static void sinkEnd(void* context);
+    
+#if defined(ARDUINO_ARCH_ESP32)
+    // SPI transfer task (async transactions)
+    static bool startAsyncTask();
+    static void asyncTask(void* arg);
+#endif
 };
 
 // Helper class for register convention utilities
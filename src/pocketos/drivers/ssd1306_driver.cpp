@@ -9,37 +9,132 @@
 
 namespace PocketOS {
 
-#define SSD1306_REG_WHO_AM_I   0x0F
-#define SSD1306_REG_CTRL1      0x10
-#define SSD1306_REG_CTRL2      0x11
-#define SSD1306_REG_STATUS     0x1E
+// I2C control bytes (Co = 0: the rest of the transaction is one stream)
+#define SSD1306_CONTROL_COMMAND  0x00
+#define SSD1306_CONTROL_DATA     0x40
+
+// Commands
+#define SSD1306_CMD_MEMORY_MODE      0x20
+#define SSD1306_CMD_COLUMN_ADDR      0x21
+#define SSD1306_CMD_PAGE_ADDR        0x22
+#define SSD1306_CMD_SCROLL_OFF       0x2E
+#define SSD1306_CMD_START_LINE       0x40
+#define SSD1306_CMD_CONTRAST         0x81
+#define SSD1306_CMD_CHARGE_PUMP      0x8D
+#define SSD1306_CMD_SEG_REMAP        0xA0
+#define SSD1306_CMD_DISPLAY_RESUME   0xA4
+#define SSD1306_CMD_NORMAL           0xA6
+#define SSD1306_CMD_INVERT           0xA7
+#define SSD1306_CMD_MUX_RATIO        0xA8
+#define SSD1306_CMD_DISPLAY_OFF      0xAE
+#define SSD1306_CMD_DISPLAY_ON       0xAF
+#define SSD1306_CMD_COM_SCAN_INC     0xC0
+#define SSD1306_CMD_COM_SCAN_DEC     0xC8
+#define SSD1306_CMD_DISPLAY_OFFSET   0xD3
+#define SSD1306_CMD_CLOCK_DIV        0xD5
+#define SSD1306_CMD_PRECHARGE        0xD9
+#define SSD1306_CMD_COM_PINS         0xDA
+#define SSD1306_CMD_VCOMH            0xDB
 
 #if POCKETOS_SSD1306_ENABLE_REGISTER_ACCESS
+// Command map (width = command byte + arguments; all write-only)
 static const RegisterDesc SSD1306_REGISTERS[] = {
-    RegisterDesc(0x0F, "WHO_AM_I", 1, RegisterAccess::RO, 0x00),
-    RegisterDesc(0x10, "CTRL1", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x11, "CTRL2", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x1E, "STATUS", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x20, "MEMORY_MODE", 2, RegisterAccess::WO, 0x02),
+    RegisterDesc(0x21, "COLUMN_ADDR", 3, RegisterAccess::WO, 0x00),
+    RegisterDesc(0x22, "PAGE_ADDR", 3, RegisterAccess::WO, 0x00),
+    RegisterDesc(0x2E, "SCROLL_OFF", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0x2F, "SCROLL_ON", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0x40, "START_LINE", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0x81, "CONTRAST", 2, RegisterAccess::WO, 0x7F),
+    RegisterDesc(0x8D, "CHARGE_PUMP", 2, RegisterAccess::WO, 0x10),
+    RegisterDesc(0xA0, "SEG_REMAP_OFF", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0xA1, "SEG_REMAP_ON", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0xA4, "DISPLAY_RESUME", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0xA5, "DISPLAY_ALL_ON", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0xA6, "NORMAL", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0xA7, "INVERT", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0xA8, "MUX_RATIO", 2, RegisterAccess::WO, 0x3F),
+    RegisterDesc(0xAE, "DISPLAY_OFF", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0xAF, "DISPLAY_ON", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0xC0, "COM_SCAN_INC", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0xC8, "COM_SCAN_DEC", 1, RegisterAccess::WO, 0x00),
+    RegisterDesc(0xD3, "DISPLAY_OFFSET", 2, RegisterAccess::WO, 0x00),
+    RegisterDesc(0xD5, "CLOCK_DIV", 2, RegisterAccess::WO, 0x80),
+    RegisterDesc(0xD9, "PRECHARGE", 2, RegisterAccess::WO, 0x22),
+    RegisterDesc(0xDA, "COM_PINS", 2, RegisterAccess::WO, 0x12),
+    RegisterDesc(0xDB, "VCOMH", 2, RegisterAccess::WO, 0x20),
 };
 
 #define SSD1306_REGISTER_COUNT (sizeof(SSD1306_REGISTERS) / sizeof(RegisterDesc))
 #endif
 
-SSD1306Driver::SSD1306Driver() : address(0), initialized(false) {}
+SSD1306Driver::SSD1306Driver() : address(0), initialized(false), lastFlushBytes(0)
+#if POCKETOS_SSD1306_ENABLE_CONFIGURATION
+    , contrast(0x8F), inverted(false)
+#endif
+{}
 
-bool SSD1306Driver::init(uint8_t i2cAddress) {
+bool SSD1306Driver::init(uint8_t i2cAddress, uint8_t height) {
     address = i2cAddress;
     
 #if POCKETOS_SSD1306_ENABLE_LOGGING
-    Logger::info("SSD1306: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("SSD1306: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
     
-#if POCKETOS_SSD1306_ENABLE_CONFIGURATION
-    writeRegister(SSD1306_REG_CTRL1, 0x00);
-    writeRegister(SSD1306_REG_CTRL2, 0x00);
+    if (height != 32 && height != 64) {
+#if POCKETOS_SSD1306_ENABLE_LOGGING
+        Logger::error("SSD1306: Unsupported panel height");
+#endif
+        return false;
+    }
+    
+    // Horizontal addressing: data auto-increments across the column
+    // window and wraps to the next page, so a window is one data stream
+    const uint8_t initSeq[] = {
+        SSD1306_CMD_DISPLAY_OFF,
+        SSD1306_CMD_CLOCK_DIV, 0x80,
+        SSD1306_CMD_MUX_RATIO, (uint8_t)(height - 1),
+        SSD1306_CMD_DISPLAY_OFFSET, 0x00,
+        SSD1306_CMD_START_LINE,
+        SSD1306_CMD_CHARGE_PUMP, 0x14,
+        SSD1306_CMD_MEMORY_MODE, 0x00,
+        SSD1306_CMD_SEG_REMAP | 0x01,
+        SSD1306_CMD_COM_SCAN_DEC,
+        SSD1306_CMD_COM_PINS, (uint8_t)(height == 64 ? 0x12 : 0x02),
+        SSD1306_CMD_CONTRAST, (uint8_t)(height == 64 ? 0xCF : 0x8F),
+        SSD1306_CMD_PRECHARGE, 0xF1,
+        SSD1306_CMD_VCOMH, 0x40,
+        SSD1306_CMD_DISPLAY_RESUME,
+        SSD1306_CMD_NORMAL,
+        SSD1306_CMD_SCROLL_OFF
+    };
+    if (!writeCommands(initSeq, sizeof(initSeq))) {
+#if POCKETOS_SSD1306_ENABLE_LOGGING
+        Logger::error("SSD1306: No response");
 #endif
+        return false;
+    }
     
     initialized = true;
+    
+#if POCKETOS_SSD1306_ENABLE_CONFIGURATION
+    contrast = (uint8_t)(height == 64 ? 0xCF : 0x8F);
+    inverted = false;
+#endif
+    
+#if POCKETOS_SSD1306_ENABLE_BASIC_DISPLAY
+    if (!framebuffer_.begin(128, height)) {
+#if POCKETOS_SSD1306_ENABLE_LOGGING
+        Logger::error("SSD1306: Out of memory");
+#endif
+        initialized = false;
+        return false;
+    }
+    display();
+#endif
+    
+    displayOn();
+    
 #if POCKETOS_SSD1306_ENABLE_LOGGING
     Logger::info("SSD1306: Initialized successfully");
 #endif
@@ -47,37 +142,201 @@ bool SSD1306Driver::init(uint8_t i2cAddress) {
 }
 
 void SSD1306Driver::deinit() {
+    if (initialized) {
+        displayOff();
+    }
+#if POCKETOS_SSD1306_ENABLE_BASIC_DISPLAY
+    framebuffer_.end();
+#endif
     initialized = false;
 }
 
 CapabilitySchema SSD1306Driver::getSchema() const {
     CapabilitySchema schema;
-    schema.tier = POCKETOS_SSD1306_TIER_NAME;
+    
+#if POCKETOS_SSD1306_ENABLE_BASIC_DISPLAY
+    schema.addSetting("width", ParamType::INT, false, 0, 0, 0, "px");
+    schema.addSetting("height", ParamType::INT, false, 0, 0, 0, "px");
+    schema.addCommand("display", "");
+    schema.addCommand("clear", "");
+#endif
+#if POCKETOS_SSD1306_ENABLE_CONFIGURATION
+    schema.addSetting("contrast", ParamType::INT, true, 0, 255, 1, "");
+    schema.addSetting("invert", ParamType::BOOL, true, 0, 1, 1, "");
+#endif
+    
     return schema;
 }
 
-bool SSD1306Driver::writeRegister(uint8_t reg, uint8_t value) {
+bool SSD1306Driver::writeCommands(const uint8_t* cmds, size_t len) {
     Wire.beginTransmission(address);
-    Wire.write(reg);
-    Wire.write(value);
+    Wire.write(SSD1306_CONTROL_COMMAND);
+    Wire.write(cmds, len);
     return Wire.endTransmission() == 0;
 }
 
-bool SSD1306Driver::readRegister(uint8_t reg, uint8_t* value) {
-    Wire.beginTransmission(address);
-    Wire.write(reg);
-    if (Wire.endTransmission() != 0) {
+bool SSD1306Driver::writeCommand(uint8_t cmd) {
+    return writeCommands(&cmd, 1);
+}
+
+bool SSD1306Driver::displayOn() {
+    return writeCommand(SSD1306_CMD_DISPLAY_ON);
+}
+
+bool SSD1306Driver::displayOff() {
+    return writeCommand(SSD1306_CMD_DISPLAY_OFF);
+}
+
+#if POCKETOS_SSD1306_ENABLE_BASIC_DISPLAY
+void SSD1306Driver::setPixel(uint16_t x, uint16_t y, bool on) {
+    framebuffer_.setPixel(x, y, on);
+}
+
+bool SSD1306Driver::getPixel(uint16_t x, uint16_t y) const {
+    return framebuffer_.getPixel(x, y);
+}
+
+void SSD1306Driver::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool on) {
+    framebuffer_.fillRect(x, y, w, h, on ? 1 : 0);
+}
+
+void SSD1306Driver::clearDisplay() {
+    framebuffer_.clear();
+}
+
+bool SSD1306Driver::sendWindow(const MonoWindow& window) {
+    const uint8_t cmds[6] = {
+        SSD1306_CMD_COLUMN_ADDR, window.col0, window.col1,
+        SSD1306_CMD_PAGE_ADDR, window.page0, window.page1
+    };
+    if (!writeCommands(cmds, sizeof(cmds))) {
+        return false;
+    }
+    
+    // Page slices are one continuous stream, split only at the burst limit
+    size_t room = 0;
+    size_t cols = (size_t)window.col1 - window.col0 + 1;
+    for (uint8_t page = window.page0; page <= window.page1; page++) {
+        const uint8_t* src = framebuffer_.pageData(page) + window.col0;
+        size_t left = cols;
+        while (left > 0) {
+            if (room == 0) {
+                Wire.beginTransmission(address);
+                Wire.write(SSD1306_CONTROL_DATA);
+                room = POCKETOS_SSD1306_I2C_BURST;
+            }
+            size_t n = left < room ? left : room;
+            Wire.write(src, n);
+            src += n;
+            left -= n;
+            room -= n;
+            lastFlushBytes += n;
+            if (room == 0 && Wire.endTransmission() != 0) {
+                return false;
+            }
+        }
+    }
+    if (room > 0 && Wire.endTransmission() != 0) {
+        return false;
+    }
+    return true;
+}
+
+bool SSD1306Driver::display() {
+    if (!initialized) {
         return false;
     }
     
-    Wire.requestFrom(address, (uint8_t)1);
-    if (Wire.available()) {
-        *value = Wire.read();
-        return true;
+    lastFlushBytes = 0;
+    MonoWindow window;
+    while (framebuffer_.nextWindow(window)) {
+        if (!sendWindow(window)) {
+            // GDDRAM state unknown: resend everything next time
+            framebuffer_.markAllDirty();
+#if POCKETOS_SSD1306_ENABLE_ERROR_HANDLING
+#if POCKETOS_SSD1306_ENABLE_LOGGING
+            Logger::error("SSD1306: Display update failed");
+#endif
+#endif
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SSD1306Driver::displayAll() {
+    framebuffer_.markAllDirty();
+    return display();
+}
+#endif
+
+#if POCKETOS_SSD1306_ENABLE_CONFIGURATION
+bool SSD1306Driver::setContrast(uint8_t value) {
+    const uint8_t cmds[2] = { SSD1306_CMD_CONTRAST, value };
+    if (!writeCommands(cmds, sizeof(cmds))) {
+        return false;
+    }
+    contrast = value;
+    return true;
+}
+
+bool SSD1306Driver::invertDisplay(bool invert) {
+    if (!writeCommand(invert ? SSD1306_CMD_INVERT : SSD1306_CMD_NORMAL)) {
+        return false;
+    }
+    inverted = invert;
+    return true;
+}
+
+String SSD1306Driver::getParameter(const String& name) {
+    if (name == "contrast") {
+        return String(contrast);
+    } else if (name == "invert") {
+        return inverted ? "1" : "0";
+    }
+#if POCKETOS_SSD1306_ENABLE_BASIC_DISPLAY
+    else if (name == "width") {
+        return String(framebuffer_.width());
+    } else if (name == "height") {
+        return String(framebuffer_.height());
+    } else if (name == "flush_bytes") {
+        return String(lastFlushBytes);
+    }
+#endif
+    return "";
+}
+
+bool SSD1306Driver::setParameter(const String& name, const String& value) {
+    if (name == "contrast") {
+        long v = value.toInt();
+        if (v < 0 || v > 255) {
+            return false;
+        }
+        return setContrast((uint8_t)v);
+    } else if (name == "invert") {
+        return invertDisplay(value == "true" || value == "1" || value == "on");
     }
     return false;
 }
 
+bool SSD1306Driver::setFlip(bool flip) {
+    // Rotate 180 degrees: mirror segments and COM scan direction
+    const uint8_t cmds[2] = {
+        (uint8_t)(flip ? SSD1306_CMD_SEG_REMAP : (SSD1306_CMD_SEG_REMAP | 0x01)),
+        (uint8_t)(flip ? SSD1306_CMD_COM_SCAN_INC : SSD1306_CMD_COM_SCAN_DEC)
+    };
+    if (!writeCommands(cmds, sizeof(cmds))) {
+        return false;
+    }
+#if POCKETOS_SSD1306_ENABLE_BASIC_DISPLAY
+    // Already-written GDDRAM is not remapped; redraw it
+    return displayAll();
+#else
+    return true;
+#endif
+}
+#endif
+
 #if POCKETOS_SSD1306_ENABLE_REGISTER_ACCESS
 const RegisterDesc* SSD1306Driver::registers(size_t& count) const {
     count = SSD1306_REGISTER_COUNT;
@@ -85,29 +344,29 @@ const RegisterDesc* SSD1306Driver::registers(size_t& count) const {
 }
 
 bool SSD1306Driver::regRead(uint16_t reg, uint8_t* buf, size_t len) {
-    if (!initialized || reg > 0xFF || len != 1) {
-        return false;
-    }
-    
-    const RegisterDesc* regDesc = RegisterUtils::findByAddr(SSD1306_REGISTERS, SSD1306_REGISTER_COUNT, reg);
-    if (!regDesc || !RegisterUtils::isReadable(regDesc->access)) {
-        return false;
-    }
-    
-    return readRegister((uint8_t)reg, buf);
+    // GDDRAM and command state cannot be read back over I2C
+    (void)reg;
+    (void)buf;
+    (void)len;
+    return false;
 }
 
 bool SSD1306Driver::regWrite(uint16_t reg, const uint8_t* buf, size_t len) {
-    if (!initialized || reg > 0xFF || len != 1) {
+    if (!initialized || reg > 0xFF) {
         return false;
     }
     
     const RegisterDesc* regDesc = RegisterUtils::findByAddr(SSD1306_REGISTERS, SSD1306_REGISTER_COUNT, reg);
-    if (!regDesc || !RegisterUtils::isWritable(regDesc->access)) {
+    if (!regDesc || !RegisterUtils::isWritable(regDesc->access) || len + 1 != regDesc->width) {
         return false;
     }
     
-    return writeRegister((uint8_t)reg, buf[0]);
+    uint8_t cmds[4];
+    cmds[0] = (uint8_t)reg;
+    for (size_t i = 0; i < len; i++) {
+        cmds[i + 1] = buf[i];
+    }
+    return writeCommands(cmds, len + 1);
 }
 
 const RegisterDesc* SSD1306Driver::findRegisterByName(const String& name) const {
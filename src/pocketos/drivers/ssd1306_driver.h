@@ -5,12 +5,19 @@
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
 #include "register_types.h"
+#include "mono_framebuffer.h"
 
 namespace PocketOS {
 
 #define SSD1306_ADDR_COUNT 2
 const uint8_t SSD1306_VALID_ADDRESSES[SSD1306_ADDR_COUNT] = { 0x3C, 0x3D };
 
+// Data bytes per I2C transaction (Wire buffer minus the control byte)
+// Can be overridden via build flags: -DPOCKETOS_SSD1306_I2C_BURST=31
+#ifndef POCKETOS_SSD1306_I2C_BURST
+#define POCKETOS_SSD1306_I2C_BURST 127
+#endif
+
 struct SSD1306Data {
     bool display_on;
     bool valid;
@@ -18,11 +25,14 @@ struct SSD1306Data {
     SSD1306Data() : display_on(false), valid(false) {}
 };
 
+// SSD1306 OLED driver (I2C). Drawing goes into a 1bpp framebuffer;
+// display() sends only the changed column range of each changed page.
 class SSD1306Driver {
 public:
     SSD1306Driver();
     
-    bool init(uint8_t i2cAddress);
+    // Panel height 32 or 64
+    bool init(uint8_t i2cAddress, uint8_t height = 64);
     void deinit();
     bool isInitialized() const { return initialized; }
     
@@ -31,6 +41,39 @@ public:
     bool displayOff();
     CapabilitySchema getSchema() const;
     
+#if POCKETOS_SSD1306_ENABLE_BASIC_DISPLAY
+    // Tier 0: Framebuffer drawing
+    uint16_t width() const { return framebuffer_.width(); }
+    uint16_t height() const { return framebuffer_.height(); }
+    void setPixel(uint16_t x, uint16_t y, bool on);
+    bool getPixel(uint16_t x, uint16_t y) const;
+    void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool on);
+    void clearDisplay();
+    
+    // Send dirty regions; returns false on I2C error (everything is resent next time)
+    bool display();
+    
+    // Full refresh regardless of dirty state
+    bool displayAll();
+    
+    // GDDRAM bytes sent by the last display()
+    uint32_t getLastFlushBytes() const { return lastFlushBytes; }
+    
+    // Drawing surface for GfxRenderer
+    MonoFramebuffer& framebuffer() { return framebuffer_; }
+#endif
+    
+#if POCKETOS_SSD1306_ENABLE_CONFIGURATION
+    // Tier 1: Panel configuration
+    bool setContrast(uint8_t contrast);
+    bool invertDisplay(bool invert);
+    bool setFlip(bool flip);
+    
+    // Parameter get/set (contrast, invert; width, height, flush_bytes read-only)
+    String getParameter(const String& name);
+    bool setParameter(const String& name, const String& value);
+#endif
+    
     uint8_t getAddress() const { return address; }
     String getDriverId() const { return "ssd1306"; }
     String getDriverTier() const { return POCKETOS_SSD1306_TIER_NAME; }
@@ -50,6 +93,7 @@ public:
     }
     
 #if POCKETOS_SSD1306_ENABLE_REGISTER_ACCESS
+    // Commands are write-only; regWrite sends the command followed by its arguments
     const RegisterDesc* registers(size_t& count) const;
     bool regRead(uint16_t reg, uint8_t* buf, size_t len);
     bool regWrite(uint16_t reg, const uint8_t* buf, size_t len);
@@ -59,9 +103,20 @@ public:
 private:
     uint8_t address;
     bool initialized;
+    uint32_t lastFlushBytes;
+    
+#if POCKETOS_SSD1306_ENABLE_CONFIGURATION
+    uint8_t contrast;
+    bool inverted;
+#endif
+    
+#if POCKETOS_SSD1306_ENABLE_BASIC_DISPLAY
+    MonoFramebuffer framebuffer_;
+    
+    bool sendWindow(const MonoWindow& window);
+#endif
     
-    bool writeRegister(uint8_t reg, uint8_t value);
-    bool readRegister(uint8_t reg, uint8_t* value);
+    bool writeCommands(const uint8_t* cmds, size_t len);
 };
 
 } // namespace PocketOS
@@ -1,4 +1,5 @@
 #include "st7735_driver.h"
+#include "gfx_image.h"
 #include "../core/logger.h"
 #include "../core/resource_manager.h"
 #include <SPI.h>
@@ -325,22 +326,31 @@ bool ST7735Driver::begin() {
 bool ST7735Driver::setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
     if (!initialized_) return false;
     
-    sendCommand(ST7735_CASET);
-    sendData16(x0);
-    sendData16(x1);
-    
-    sendCommand(ST7735_RASET);
-    sendData16(y0);
-    sendData16(y1);
-    
-    sendCommand(ST7735_RAMWR);
-    return true;
+    // CASET, RASET and RAMWR under one CS assertion
+    static const uint8_t cmds[3] = { ST7735_CASET, ST7735_RASET, ST7735_RAMWR };
+    uint8_t cols[4] = { (uint8_t)(x0 >> 8), (uint8_t)(x0 & 0xFF), (uint8_t)(x1 >> 8), (uint8_t)(x1 & 0xFF) };
+    uint8_t rows[4] = { (uint8_t)(y0 >> 8), (uint8_t)(y0 & 0xFF), (uint8_t)(y1 >> 8), (uint8_t)(y1 & 0xFF) };
+    SPITransferDesc chain[5] = {
+        SPITransferDesc::command(&cmds[0], 1),
+        SPITransferDesc::data(cols, 4),
+        SPITransferDesc::command(&cmds[1], 1),
+        SPITransferDesc::data(rows, 4),
+        SPITransferDesc::command(&cmds[2], 1)
+    };
+    return spiTransaction(chain, 5);
 }
 
 bool ST7735Driver::setPixel(uint16_t x, uint16_t y, uint16_t color) {
     if (!initialized_) return false;
     if (x >= _width || y >= _height) return false;
     
+#if POCKETOS_ST7735_ENABLE_CONFIGURATION
+    if (framebuffer_.isEnabled()) {
+        framebuffer_.setPixel(x, y, color);
+        return true;
+    }
+#endif
+    
     setWindow(x, y, x, y);
     sendData16(color);
     return true;
@@ -351,16 +361,22 @@ bool ST7735Driver::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint
     if (x >= _width || y >= _height) return false;
     if (x + w > _width) w = _width - x;
     if (y + h > _height) h = _height - y;
+    if (w == 0 || h == 0) return true;
+    
+#if POCKETOS_ST7735_ENABLE_CONFIGURATION
+    if (framebuffer_.isEnabled()) {
+        framebuffer_.fillRect(x, y, w, h, color);
+        return true;
+    }
+#endif
     
     setWindow(x, y, x + w - 1, y + h - 1);
     
-    uint32_t pixels = (uint32_t)w * h;
+    // Block fill: one pattern write for the whole window
+    beginTransaction();
     setDCData();
-    setCS(true);
-    for (uint32_t i = 0; i < pixels; i++) {
-        SPI.write16(color);
-    }
-    setCS(false);
+    writePattern16(color, (uint32_t)w * h);
+    endTransaction();
     
     return true;
 }
@@ -369,6 +385,72 @@ bool ST7735Driver::fillScreen(uint16_t color) {
     return fillRect(0, 0, _width, _height, color);
 }
 
+bool ST7735Driver::drawHLine(uint16_t x, uint16_t y, uint16_t w, uint16_t color) {
+    return fillRect(x, y, w, 1, color);
+}
+
+bool ST7735Driver::drawVLine(uint16_t x, uint16_t y, uint16_t h, uint16_t color) {
+    return fillRect(x, y, 1, h, color);
+}
+
+bool ST7735Driver::drawImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* pixels, uint16_t stride) {
+    if (!initialized_ || !pixels) return false;
+    if (x >= _width || y >= _height) return false;
+    if (stride == 0) stride = w;
+    if (x + w > _width) w = _width - x;
+    if (y + h > _height) h = _height - y;
+    if (w == 0 || h == 0) return true;
+    
+#if POCKETOS_ST7735_ENABLE_CONFIGURATION
+    if (framebuffer_.isEnabled()) {
+        framebuffer_.writeRect(x, y, w, h, pixels, stride);
+        return true;
+    }
+#endif
+    
+    // One window; rows stream back to back
+    setWindow(x, y, x + w - 1, y + h - 1);
+    beginTransaction();
+    setDCData();
+    for (uint16_t r = 0; r < h; r++) {
+        writeWords(pixels + (size_t)r * stride, w);
+    }
+    endTransaction();
+    
+    return true;
+}
+
+bool ST7735Driver::drawCompressedImage(uint16_t x, uint16_t y, const uint8_t* data, size_t len) {
+    if (!initialized_) return false;
+    if (x >= _width || y >= _height) return false;
+    
+    GfxImageDecoder image;
+    if (!image.begin(data, len)) {
+        Logger::error("ST7735: Invalid image data");
+        return false;
+    }
+    
+    GfxImageSink sink = imageSink(&ST7735Driver::imageWindow);
+#if POCKETOS_ST7735_ENABLE_CONFIGURATION
+    if (framebuffer_.isEnabled()) {
+        sink = framebuffer_.imageSink();
+    }
+#endif
+    
+    bool ok = gfxStreamImage(image, x, y, _width, _height, sink);
+    if (image.error()) {
+        Logger::error("ST7735: Corrupt image data");
+    }
+    return ok;
+}
+
+void ST7735Driver::imageWindow(void* context, int32_t x, int32_t y, uint16_t w, uint16_t h) {
+    ST7735Driver* self = static_cast<ST7735Driver*>(static_cast<SPIDriverBase*>(context));
+    self->setWindow(x, y, x + w - 1, y + h - 1);
+    self->beginTransaction();
+    self->setDCData();
+}
+
 bool ST7735Driver::pushColor(uint16_t color) {
     if (!initialized_) return false;
     sendData16(color);
@@ -378,12 +460,10 @@ bool ST7735Driver::pushColor(uint16_t color) {
 bool ST7735Driver::pushColors(const uint16_t* colors, uint16_t len) {
     if (!initialized_) return false;
     
+    beginTransaction();
     setDCData();
-    setCS(true);
-    for (uint16_t i = 0; i < len; i++) {
-        SPI.write16(colors[i]);
-    }
-    setCS(false);
+    writeWords(colors, len);
+    endTransaction();
     
     return true;
 }
@@ -421,6 +501,13 @@ bool ST7735Driver::setRotation(uint8_t rotation) {
     
     sendCommand(ST7735_MADCTL);
     sendData(madctl);
+    
+#if POCKETOS_ST7735_ENABLE_CONFIGURATION
+    // Framebuffer geometry follows the rotation (contents are cleared)
+    if (framebuffer_.isEnabled()) {
+        beginFramebuffer(framebuffer_.getMode(), framebuffer_.isDoubleBuffered());
+    }
+#endif
     return true;
 }
 
@@ -475,6 +562,26 @@ uint8_t ST7735Driver::readStatus() {
 }
 #endif
 
+#if POCKETOS_ST7735_ENABLE_CONFIGURATION
+bool ST7735Driver::beginFramebuffer(TFTFramebufferMode mode, bool doubleBuffer) {
+    if (!initialized_) return false;
+    return framebuffer_.begin("ST7735", chainSink(), _width, _height, mode, doubleBuffer);
+}
+
+void ST7735Driver::endFramebuffer() {
+    framebuffer_.end();
+}
+
+void ST7735Driver::selectBand(uint16_t band, uint16_t background) {
+    framebuffer_.selectBand(band, background);
+}
+
+bool ST7735Driver::flush() {
+    if (!initialized_) return false;
+    return framebuffer_.flush();
+}
+#endif
+
 #if POCKETOS_ST7735_ENABLE_REGISTER_ACCESS
 const RegisterDesc* ST7735Driver::registers(size_t& count) const {
     count = ST7735_REGISTER_COUNT;
@@ -493,9 +600,17 @@ bool ST7735Driver::writeData16(uint16_t data) {
     return sendData16(data);
 }
 
+const RegisterDesc* ST7735Driver::findRegisterByName(const String& name) const {
+    size_t count;
+    const RegisterDesc* regs = registers(count);
+    return RegisterUtils::findByName(regs, count, name);
+}
+#endif
+
 bool ST7735Driver::readData(uint8_t cmd, uint8_t* buf, size_t len) {
     if (!initialized_) return false;
     
+    spiWaitIdle();
     setDCCommand();
     setCS(true);
     SPI.transfer(cmd);
@@ -512,13 +627,6 @@ bool ST7735Driver::readData(uint8_t cmd, uint8_t* buf, size_t len) {
     return true;
 }
 
-const RegisterDesc* ST7735Driver::findRegisterByName(const String& name) const {
-    size_t count;
-    const RegisterDesc* regs = registers(count);
-    return RegisterUtils::findByName(regs, count, name);
-}
-#endif
-
 bool ST7735Driver::hardwareReset() {
     if (getPinConfig().rst < 0) return false;
     
@@ -535,6 +643,7 @@ bool ST7735Driver::hardwareReset() {
 bool ST7735Driver::sendCommand(uint8_t cmd) {
     if (!initialized_) return false;
     
+    spiWaitIdle();
     setDCCommand();
     setCS(true);
     SPI.transfer(cmd);
@@ -546,6 +655,7 @@ bool ST7735Driver::sendCommand(uint8_t cmd) {
 bool ST7735Driver::sendData(uint8_t data) {
     if (!initialized_) return false;
     
+    spiWaitIdle();
     setDCData();
     setCS(true);
     SPI.transfer(data);
@@ -557,6 +667,7 @@ bool ST7735Driver::sendData(uint8_t data) {
 bool ST7735Driver::sendData16(uint16_t data) {
     if (!initialized_) return false;
     
+    spiWaitIdle();
     setDCData();
     setCS(true);
     SPI.write16(data);
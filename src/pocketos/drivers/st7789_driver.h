@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "../driver_config.h"
 #include "spi_driver_base.h"
+#include "tft_framebuffer.h"
 #include "register_types.h"
 
 namespace PocketOS {
@@ -25,15 +26,24 @@ public:
     // Identification probe - reads Display ID (0x04 command)
     static bool identifyProbe(const String& endpoint);
     
+    // Read command response (used by identifyProbe and readID at every tier)
+    bool readData(uint8_t cmd, uint8_t* buf, size_t len);
+    
 #if POCKETOS_ST7789_ENABLE_BASIC_READ
     // Tier 0: Basic display operations
     bool begin();
     bool setPixel(uint16_t x, uint16_t y, uint16_t color);
     bool fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
     bool fillScreen(uint16_t color);
+    bool drawHLine(uint16_t x, uint16_t y, uint16_t w, uint16_t color);
+    bool drawVLine(uint16_t x, uint16_t y, uint16_t h, uint16_t color);
     bool setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
     bool pushColor(uint16_t color);
     bool pushColors(const uint16_t* colors, uint16_t len);
+    // RGB565 image; row r starts at pixels + r * stride (0 = w)
+    bool drawImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* pixels, uint16_t stride = 0);
+    // PIMG image (gfx_image.h), decoded by gfxStreamImage() while it streams into one window
+    bool drawCompressedImage(uint16_t x, uint16_t y, const uint8_t* data, size_t len);
     uint16_t width() const { return _width; }
     uint16_t height() const { return _height; }
 #endif
@@ -51,13 +61,24 @@ public:
     uint8_t readStatus();
 #endif
 
+#if POCKETOS_ST7789_ENABLE_CONFIGURATION
+    // Tier 1: Framebuffer mode - setPixel/fillRect/fillScreen draw into RAM
+    // and flush() sends the dirty rectangles. In STRIP mode render the frame
+    // band by band: selectBand(b), draw, flush().
+    bool beginFramebuffer(TFTFramebufferMode mode = TFTFramebufferMode::AUTO, bool doubleBuffer = false);
+    void endFramebuffer();
+    bool hasFramebuffer() const { return framebuffer_.isEnabled(); }
+    uint16_t framebufferBands() const { return framebuffer_.bandCount(); }
+    void selectBand(uint16_t band, uint16_t background = 0);
+    bool flush();
+#endif
+
 #if POCKETOS_ST7789_ENABLE_REGISTER_ACCESS
     // Tier 2: Complete register/command access
     const RegisterDesc* registers(size_t& count) const override;
     bool writeCommand(uint8_t cmd);
     bool writeData(uint8_t data);
     bool writeData16(uint16_t data);
-    bool readData(uint8_t cmd, uint8_t* buf, size_t len);
     const RegisterDesc* findRegisterByName(const String& name) const override;
 #endif
 
@@ -67,11 +88,18 @@ private:
     uint16_t _height;
     uint8_t _rotation;
     
+#if POCKETOS_ST7789_ENABLE_CONFIGURATION
+    TFTFramebuffer framebuffer_;
+#endif
+    
     // Helper methods
     bool hardwareReset();
     bool sendCommand(uint8_t cmd);
     bool sendData(uint8_t data);
     bool sendData16(uint16_t data);
+    
+    // drawCompressedImage() window: address window, then an open data transaction
+    static void imageWindow(void* context, int32_t x, int32_t y, uint16_t w, uint16_t h);
 };
 
 } // namespace PocketOS
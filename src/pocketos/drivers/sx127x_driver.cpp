@@ -1,5 +1,6 @@
 #include "sx127x_driver.h"
 #include "../core/logger.h"
+#include "../core/system_clock.h"
 #include <SPI.h>
 
 namespace PocketOS {
@@ -11,6 +12,40 @@ namespace PocketOS {
 #define SX127X_MODE_RXCONT      0x05
 #define SX127X_MODE_RXSINGLE    0x06
 
+// Registers and bits used outside the register map
+#define SX127X_REG_FIFO             0x00
+#define SX127X_REG_OP_MODE          0x01
+#define SX127X_REG_FIFO_ADDR_PTR    0x0D
+#define SX127X_REG_FIFO_TX_BASE     0x0E
+#define SX127X_REG_FIFO_RX_BASE     0x0F
+#define SX127X_REG_FIFO_RX_CURRENT  0x10    // 0x10-0x13: RX current, mask, flags, RX bytes
+#define SX127X_REG_IRQ_FLAGS        0x12
+#define SX127X_REG_MODEM_STAT       0x18
+#define SX127X_REG_PKT_SNR          0x19    // 0x19-0x1A: packet SNR, packet RSSI
+#define SX127X_REG_MODEM_CONFIG2    0x1E
+#define SX127X_REG_PAYLOAD_LENGTH   0x22
+#define SX127X_REG_SYNC_WORD        0x39
+#define SX127X_REG_DIO_MAPPING1     0x40
+#define SX127X_REG_VERSION          0x42
+#define SX127X_LORA_MODE            0x80    // OP_MODE LongRangeMode
+#define SX127X_LOW_FREQ_MODE        0x08    // OP_MODE LowFrequencyModeOn
+#define SX127X_IRQ_RX_DONE          0x40
+#define SX127X_IRQ_CRC_ERROR        0x20
+#define SX127X_IRQ_TX_DONE          0x08
+#define SX127X_MODEM_BUSY           0x0B    // Signal detected, synchronized, header valid
+#define SX127X_DIO0_RX_DONE         0x00
+#define SX127X_DIO0_TX_DONE         0x40
+#define SX127X_HF_PORT_HZ           779000000UL   // RSSI offset -157 above, -164 below
+
+static const char* const SX127X_STATE_NAMES[] = { "standby", "rx", "tx" };
+
+#if POCKETOS_SX127X_ENABLE_ERROR_HANDLING
+static const uint32_t SX127X_BANDWIDTHS[] = {
+    7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000
+};
+#define SX127X_BANDWIDTH_COUNT (sizeof(SX127X_BANDWIDTHS) / sizeof(SX127X_BANDWIDTHS[0]))
+#endif
+
 #if POCKETOS_SX127X_ENABLE_REGISTER_ACCESS
 // Complete SX127x Register Map (0x00-0x70, common and LoRa mode)
 static const RegisterDesc SX127X_REGISTERS[] = {
@@ -80,8 +115,17 @@ static const RegisterDesc SX127X_REGISTERS[] = {
 #endif
 
 SX127xDriver::SX127xDriver() 
-    : initialized_(false), frequency_(915000000) {
+    : initialized_(false), frequency_(915000000), txPower_(17), state_(SX127xState::STANDBY) {
     setRegisterConvention(SPIRegisterConvention::GENERIC);
+#if POCKETOS_SX127X_ENABLE_BASIC_READ
+    txStartMs_ = 0;
+    txTimeoutMs_ = 0;
+    txWaiting_ = false;
+    lastRssi_ = 0;
+    lastSnrQ4_ = 0;
+    duty_.configure(SX127X_DUTY_CYCLE_PERMILLE, SX127X_DUTY_WINDOW_MS);
+#endif
+    memset(&stats_, 0, sizeof(stats_));
 }
 
 SX127xDriver::~SX127xDriver() {
@@ -102,9 +146,9 @@ bool SX127xDriver::init(const String& endpoint) {
     }
     
     // Read version register
-    uint8_t version = readRegister(0x42);
+    uint8_t version = readRegister(SX127X_REG_VERSION);
     if (version != 0x12) {
-        Logger::error("SX127x: Invalid version: 0x" + String(version, HEX));
+        Logger::error(("SX127x: Invalid version: 0x" + String(version, HEX)).c_str());
         deinit();
         return false;
     }
@@ -114,12 +158,30 @@ bool SX127xDriver::init(const String& endpoint) {
     
     // Set to standby mode
     setMode(SX127X_MODE_STDBY);
+    initialized_ = true;
     
     // Set default frequency (915 MHz)
     setFrequency(frequency_);
     
-    initialized_ = true;
-    Logger::info("SX127x: Initialized successfully (version 0x" + String(version, HEX) + ")");
+    // Each direction gets the whole FIFO: TX is only loaded in standby,
+    // after received packets have been read out
+    writeRegister(SX127X_REG_FIFO_TX_BASE, 0x00);
+    writeRegister(SX127X_REG_FIFO_RX_BASE, 0x00);
+    
+    // Payload CRC on (modem_ default)
+    writeRegister(SX127X_REG_MODEM_CONFIG2, readRegister(SX127X_REG_MODEM_CONFIG2) | 0x04);
+    
+#if POCKETOS_SX127X_ENABLE_BASIC_READ
+    setTxPower(txPower_);
+    
+    // DIO0 is active high and stays high until the IRQ flags are cleared
+    if (getPinConfig().irq >= 0 && !attachIrq(IrqEdge::RISING_EDGE, onIrq, this)) {
+        Logger::warning("SX127x: DIO0 not attached, polling IRQ flags");
+    }
+    startReceive();
+#endif
+    
+    Logger::info(("SX127x: Initialized successfully (version 0x" + String(version, HEX) + ")").c_str());
     return true;
 }
 
@@ -153,112 +215,405 @@ bool SX127xDriver::identifyProbe(const String& endpoint) {
     }
     
     // Read VERSION register
-    uint8_t version = driver.readRegister(0x42);
+    uint8_t version = driver.readRegister(SX127X_REG_VERSION);
     return version == 0x12;
 }
 
+void SX127xDriver::update() {
+#if POCKETOS_SX127X_ENABLE_BASIC_READ
+    if (!initialized_) {
+        return;
+    }
+    // DIO0 still high here means an event after the edge was serviced.
+    // Without a pin, read the flags every pass.
+    if (irqLine() < 0 || digitalRead(getPinConfig().irq) == HIGH) {
+        service(SystemClock::nowUs());
+    }
+    if (state_ == SX127xState::TX && (uint32_t)(millis() - txStartMs_) > txTimeoutMs_) {
+        stats_.txTimeouts++;
+        writeRegister(SX127X_REG_IRQ_FLAGS, 0xFF);
+        startReceive();
+    }
+    if (state_ != SX127xState::TX) {
+        startNextTx();
+    }
+#endif
+}
+
+CapabilitySchema SX127xDriver::getSchema() const {
+    CapabilitySchema schema;
+    schema.addSetting("frequency", ParamType::INT, true, 137000000, 1020000000, 0, "Hz");
+    schema.addSetting("tx_power", ParamType::INT, true, 2, 20, 1, "dBm");
+    schema.addSetting("duty_cycle", ParamType::FLOAT, true, 0, 100, 0.1f, "%");
+    schema.addSetting("duty_window_s", ParamType::INT, true, 1, 86400, 1, "s");
+#if POCKETOS_SX127X_ENABLE_ERROR_HANDLING
+    schema.addSetting("sf", ParamType::INT, true, 6, 12, 1);
+    schema.addSetting("bw", ParamType::INT, true, 7800, 500000, 0, "Hz");
+    schema.addSetting("cr", ParamType::INT, true, 5, 8, 1);
+    schema.addSetting("preamble", ParamType::INT, true, 6, 65535, 1);
+    schema.addSetting("crc", ParamType::BOOL, true);
+    schema.addSetting("sync_word", ParamType::STRING, true);
+#endif
+    schema.addSignal("tx_packets", ParamType::COUNTER, false);
+    schema.addSignal("rx_packets", ParamType::COUNTER, false);
+    schema.addSignal("rx_crc_errors", ParamType::COUNTER, false);
+    schema.addSignal("last_rssi", ParamType::INT, false, "dBm");
+    schema.addSignal("last_snr", ParamType::FLOAT, false, "dB");
+    schema.addCommand("lora.send", "<hex>");
+    schema.addCommand("lora.recv", "[max]");
+    return schema;
+}
+
+String SX127xDriver::getParameter(const String& name) {
+    if (name == "state") {
+        return String(SX127X_STATE_NAMES[(uint8_t)state_]);
+    } else if (name == "frequency") {
+        return String(frequency_);
+    } else if (name == "tx_power") {
+        return String(txPower_);
+    } else if (name == "sf") {
+        return String(modem_.spreadingFactor);
+    } else if (name == "bw") {
+        return String(modem_.bandwidthHz);
+    } else if (name == "cr") {
+        return String(modem_.codingRate);
+    } else if (name == "preamble") {
+        return String(modem_.preambleSymbols);
+    } else if (name == "crc") {
+        return modem_.crc ? "on" : "off";
+    } else if (name == "ldro") {
+        return modem_.lowDataRateOptimize ? "on" : "off";
+    } else if (name == "tx_packets") {
+        return String(stats_.txPackets);
+    } else if (name == "tx_timeouts") {
+        return String(stats_.txTimeouts);
+    } else if (name == "tx_deferred") {
+        return String(stats_.txDeferred);
+    } else if (name == "rx_packets") {
+        return String(stats_.rxPackets);
+    } else if (name == "rx_crc_errors") {
+        return String(stats_.rxCrcErrors);
+    } else if (name == "rx_drops") {
+        return String(stats_.rxDrops);
+    } else if (name == "irq_events") {
+        return String(stats_.irqEvents);
+    } else if (name == "airtime_ms") {
+        return String((uint32_t)(stats_.airtimeUs / 1000));
+    }
+#if POCKETOS_SX127X_ENABLE_BASIC_READ
+    if (name == "tx_queued") {
+        return String(txQueued());
+    } else if (name == "rx_queued") {
+        return String(rxQueued());
+    } else if (name == "rx_high_water") {
+        return String(rxQueue_.highWater());
+    } else if (name == "last_rssi") {
+        return String(lastRssi_);
+    } else if (name == "last_snr") {
+        return String(lastSnrQ4_ / 4.0f, 2);
+    } else if (name == "duty_cycle") {
+        return String(duty_.permille() / 10.0f, 1);
+    } else if (name == "duty_window_s") {
+        return String(duty_.windowMs() / 1000);
+    } else if (name == "duty_used_ms") {
+        return String((uint32_t)(duty_.usedUs(millis()) / 1000));
+    }
+#endif
+#if POCKETOS_SX127X_ENABLE_ERROR_HANDLING
+    if (name == "rssi") {
+        return String(getRSSI());
+    } else if (name == "sync_word") {
+        return "0x" + String(readRegister(SX127X_REG_SYNC_WORD), HEX);
+    }
+#endif
+    return "";
+}
+
+bool SX127xDriver::setParameter(const String& name, const String& value) {
+#if POCKETOS_SX127X_ENABLE_BASIC_READ
+    if (name == "duty_cycle") {
+        float percent = value.toFloat();
+        if (percent < 0 || percent > 100) {
+            return false;
+        }
+        setDutyCycle((uint16_t)(percent * 10 + 0.5f), duty_.windowMs());
+        return true;
+    } else if (name == "duty_window_s") {
+        long seconds = value.toInt();
+        if (seconds < 1 || seconds > 86400) {
+            return false;
+        }
+        setDutyCycle(duty_.permille(), (uint32_t)seconds * 1000);
+        return true;
+    }
+    
+    // Radio settings are written in standby, between packets
+    if (!initialized_ || state_ == SX127xState::TX) {
+        return false;
+    }
+    bool wasReceiving = state_ == SX127xState::RX;
+    if (wasReceiving) {
+        setMode(SX127X_MODE_STDBY);
+        state_ = SX127xState::STANDBY;
+    }
+    bool ok = applyRadioParameter(name, value);
+    if (wasReceiving) {
+        startReceive();
+    }
+    return ok;
+#else
+    return false;
+#endif
+}
+
+bool SX127xDriver::readBurst(uint8_t reg, uint8_t* buf, size_t len) {
+    uint8_t addr = reg & 0x7F;
+    return spiWriteRead(&addr, 1, buf, len);
+}
+
+bool SX127xDriver::writeBurst(uint8_t reg, const uint8_t* buf, size_t len) {
+    // Bit 7 set = write; address and data under one CS assertion
+    uint8_t addr = 0x80 | (reg & 0x7F);
+    SPITransferDesc chain[2] = {
+        SPITransferDesc::write(&addr, 1),
+        SPITransferDesc::write(buf, len)
+    };
+    return spiTransaction(chain, 2);
+}
+
 uint8_t SX127xDriver::readRegister(uint8_t reg) {
-    uint8_t value;
-    regRead(reg, &value, 1);
+    uint8_t value = 0;
+    readBurst(reg, &value, 1);
     return value;
 }
 
 void SX127xDriver::writeRegister(uint8_t reg, uint8_t value) {
-    regWrite(reg, &value, 1);
+    writeBurst(reg, &value, 1);
 }
 
 void SX127xDriver::setLoRaMode() {
-    // Set LoRa mode in OP_MODE register
-    uint8_t opMode = readRegister(0x01);
-    opMode = (opMode & 0x7F) | 0x80;  // Set bit 7 for LoRa mode
-    writeRegister(0x01, opMode);
+    // LongRangeMode can only be changed in sleep mode
+    uint8_t lowFreq = readRegister(SX127X_REG_OP_MODE) & SX127X_LOW_FREQ_MODE;
+    writeRegister(SX127X_REG_OP_MODE, lowFreq | SX127X_MODE_SLEEP);
+    writeRegister(SX127X_REG_OP_MODE, SX127X_LORA_MODE | lowFreq | SX127X_MODE_SLEEP);
     delay(10);
 }
 
 bool SX127xDriver::setMode(uint8_t mode) {
-    uint8_t opMode = readRegister(0x01);
+    uint8_t opMode = readRegister(SX127X_REG_OP_MODE);
     opMode = (opMode & 0xF8) | (mode & 0x07);
-    writeRegister(0x01, opMode);
-    
-    if (mode == SX127X_MODE_TX || mode == SX127X_MODE_RXCONT || mode == SX127X_MODE_RXSINGLE) {
-        delay(1);
-    }
-    
+    writeRegister(SX127X_REG_OP_MODE, opMode);
     return true;
 }
 
 #if POCKETOS_SX127X_ENABLE_BASIC_READ
-bool SX127xDriver::transmit(const uint8_t* data, uint8_t len) {
-    if (!initialized_ || len > 255) {
-        return false;
+void SX127xDriver::onIrq(void* context, const IrqEvent& event) {
+    SX127xDriver* self = static_cast<SX127xDriver*>(context);
+    self->stats_.irqEvents++;
+    self->service(SystemClock::toUnixUs(SystemClock::monoFromMicros(event.timestampUs)));
+}
+
+void SX127xDriver::service(uint64_t timestampUs) {
+    uint8_t flags = readRegister(SX127X_REG_IRQ_FLAGS);
+    if (flags == 0) {
+        return;
     }
     
-    // Set to standby mode
-    setMode(SX127X_MODE_STDBY);
-    
-    // Set FIFO address pointer to TX base
-    writeRegister(0x0D, 0x00);
-    writeRegister(0x0E, 0x00);
-    
-    // Write payload to FIFO
-    for (uint8_t i = 0; i < len; i++) {
-        writeRegister(0x00, data[i]);
+    bool txDone = (flags & SX127X_IRQ_TX_DONE) && state_ == SX127xState::TX;
+    if (txDone) {
+        stats_.txPackets++;
+        state_ = SX127xState::STANDBY;   // The chip is back in standby
     }
-    
-    // Set payload length
-    writeRegister(0x22, len);
-    
-    // Start TX
-    setMode(SX127X_MODE_TX);
-    
-    // Wait for TX done (simplified - check IRQ flags)
-    while ((readRegister(0x12) & 0x08) == 0) {
-        delay(1);
+    if (flags & SX127X_IRQ_RX_DONE) {
+        if (flags & SX127X_IRQ_CRC_ERROR) {
+            stats_.rxCrcErrors++;
+        } else {
+            readPacket(timestampUs);
+        }
     }
+    writeRegister(SX127X_REG_IRQ_FLAGS, flags);
     
-    // Clear IRQ flags
-    writeRegister(0x12, 0xFF);
+    // Next queued packet straight away, otherwise back to listening
+    if (txDone && !startNextTx()) {
+        startReceive();
+    }
+}
+
+void SX127xDriver::readPacket(uint64_t timestampUs) {
+    // RX current address .. RX bytes, then packet SNR and RSSI
+    uint8_t rx[4];
+    uint8_t quality[2];
+    if (!readBurst(SX127X_REG_FIFO_RX_CURRENT, rx, sizeof(rx)) ||
+        !readBurst(SX127X_REG_PKT_SNR, quality, sizeof(quality))) {
+        return;
+    }
+    lastSnrQ4_ = (int8_t)quality[0];
+    lastRssi_ = packetRssi(quality[1], lastSnrQ4_);
+    stats_.rxPackets++;
+    
+    LoRaPacket* packet = rxQueue_.reserve();
+    if (!packet) {
+        stats_.rxDrops++;
+        return;
+    }
+    uint8_t len = rx[3];
+    writeRegister(SX127X_REG_FIFO_ADDR_PTR, rx[0]);
+    if (len > 0 && !readBurst(SX127X_REG_FIFO, packet->data, len)) {
+        return;
+    }
+    packet->timestampUs = timestampUs;
+    packet->rssi = lastRssi_;
+    packet->snrQuarterDb = lastSnrQ4_;
+    packet->len = len;
+    rxQueue_.commit();
+}
+
+int16_t SX127xDriver::packetRssi(uint8_t raw, int8_t snrQ4) const {
+    // Datasheet 5.5.5: below the noise floor the SNR corrects the reading
+    int16_t offset = frequency_ >= SX127X_HF_PORT_HZ ? -157 : -164;
+    if (snrQ4 < 0) {
+        return offset + raw + snrQ4 / 4;
+    }
+    return offset + (int16_t)(raw * 16 / 15);
+}
+
+bool SX127xDriver::startNextTx() {
+    const LoRaPacket* packet = txQueue_.front();
+    if (!packet) {
+        return false;
+    }
+    uint32_t now = millis();
+    uint32_t airtime = loraAirtimeUs(modem_, packet->len);
+    uint32_t wait = duty_.waitMs(now, airtime);
+    if (wait == 0xFFFFFFFFUL) {
+        // Settings changed after queueing; it can never go out
+        Logger::warning(("SX127x: " + String(airtime / 1000) + " ms packet exceeds the duty-cycle budget, dropped").c_str());
+        txQueue_.pop();
+        txWaiting_ = false;
+        return false;
+    }
+    if (wait > 0) {
+        if (!txWaiting_) {
+            txWaiting_ = true;
+            stats_.txDeferred++;
+        }
+        return false;
+    }
+    // Do not cut off a packet being received
+    if (state_ == SX127xState::RX && (readRegister(SX127X_REG_MODEM_STAT) & SX127X_MODEM_BUSY)) {
+        return false;
+    }
     
-    // Return to standby
     setMode(SX127X_MODE_STDBY);
+    writeRegister(SX127X_REG_FIFO_ADDR_PTR, 0x00);
+    if (!writeBurst(SX127X_REG_FIFO, packet->data, packet->len)) {
+        startReceive();
+        return false;
+    }
+    writeRegister(SX127X_REG_PAYLOAD_LENGTH, packet->len);
+    writeRegister(SX127X_REG_DIO_MAPPING1, SX127X_DIO0_TX_DONE);
+    setMode(SX127X_MODE_TX);
     
+    duty_.record(now, airtime);
+    stats_.airtimeUs += airtime;
+    txStartMs_ = now;
+    txTimeoutMs_ = airtime / 1000 + SX127X_TX_TIMEOUT_MARGIN_MS;
+    txWaiting_ = false;
+    state_ = SX127xState::TX;
+    txQueue_.pop();
     return true;
 }
 
-bool SX127xDriver::receive(uint8_t* data, uint8_t& len, int16_t& rssi, int8_t& snr) {
-    if (!initialized_) {
+void SX127xDriver::startReceive() {
+    setMode(SX127X_MODE_STDBY);
+    writeRegister(SX127X_REG_FIFO_ADDR_PTR, 0x00);
+    writeRegister(SX127X_REG_DIO_MAPPING1, SX127X_DIO0_RX_DONE);
+    setMode(SX127X_MODE_RXCONT);   // Stays in RX after each packet
+    state_ = SX127xState::RX;
+}
+
+bool SX127xDriver::applyRadioParameter(const String& name, const String& value) {
+    if (name == "frequency") {
+        return setFrequency((uint32_t)value.toInt());
+    } else if (name == "tx_power") {
+        return setTxPower((int8_t)value.toInt());
+    }
+#if POCKETOS_SX127X_ENABLE_ERROR_HANDLING
+    if (name == "sf") {
+        return setSpreadingFactor((uint8_t)value.toInt());
+    } else if (name == "bw") {
+        return setBandwidth((uint32_t)value.toInt());
+    } else if (name == "cr") {
+        return setCodingRate((uint8_t)value.toInt());
+    } else if (name == "preamble") {
+        long length = value.toInt();
+        return length >= 6 && length <= 65535 && setPreambleLength((uint16_t)length);
+    } else if (name == "crc") {
+        return setCRC(value == "on" || value == "1" || value == "true");
+    } else if (name == "sync_word") {
+        return setSyncWord((uint8_t)strtol(value.c_str(), nullptr, 16));
+    }
+#endif
+    return false;
+}
+
+bool SX127xDriver::transmit(const uint8_t* data, uint8_t len) {
+    if (!initialized_ || len == 0) {
         return false;
     }
-    
-    if (!available()) {
+    LoRaPacket* packet = txQueue_.reserve();
+    if (!packet) {
         return false;
     }
+    memcpy(packet->data, data, len);
+    packet->len = len;
+    packet->timestampUs = SystemClock::nowUs();
+    packet->rssi = 0;
+    packet->snrQuarterDb = 0;
+    txQueue_.commit();
     
-    // Get received packet length
-    len = readRegister(0x13);
-    
-    // Get FIFO RX current address
-    uint8_t fifoAddr = readRegister(0x10);
-    writeRegister(0x0D, fifoAddr);
-    
-    // Read payload from FIFO
-    for (uint8_t i = 0; i < len; i++) {
-        data[i] = readRegister(0x00);
+    // Start right away when the radio is free
+    if (state_ != SX127xState::TX) {
+        startNextTx();
     }
-    
-    // Get RSSI and SNR
-    rssi = -157 + readRegister(0x1A);
-    snr = (int8_t)readRegister(0x19) / 4;
-    
-    // Clear IRQ flags
-    writeRegister(0x12, 0xFF);
-    
+    return true;
+}
+
+bool SX127xDriver::receive(uint8_t* data, uint8_t& len, int16_t& rssi, int8_t& snr) {
+    const LoRaPacket* packet = rxQueue_.front();
+    if (!initialized_ || !packet) {
+        return false;
+    }
+    memcpy(data, packet->data, packet->len);
+    len = packet->len;
+    rssi = packet->rssi;
+    snr = packet->snrQuarterDb / 4;
+    rxQueue_.pop();
     return true;
 }
 
 bool SX127xDriver::available() {
-    uint8_t irqFlags = readRegister(0x12);
-    return (irqFlags & 0x40) != 0;  // RxDone flag
+    return rxQueue_.count() > 0;
+}
+
+bool SX127xDriver::popPacket(LoRaPacket& packet) {
+    const LoRaPacket* front = rxQueue_.front();
+    if (!front) {
+        return false;
+    }
+    packet = *front;
+    rxQueue_.pop();
+    return true;
+}
+
+uint32_t SX127xDriver::txWaitMs(uint8_t len) {
+    return duty_.waitMs(millis(), airtimeUs(len));
+}
+
+void SX127xDriver::setDutyCycle(uint16_t permille, uint32_t windowMs) {
+    // A new limit starts with an empty window
+    duty_.configure(permille, windowMs);
+    txWaiting_ = false;
 }
 
 bool SX127xDriver::setFrequency(uint32_t freq_hz) {
@@ -292,12 +647,17 @@ bool SX127xDriver::setTxPower(int8_t power) {
         writeRegister(0x4D, 0x84);
         writeRegister(0x09, 0x80 | (power - 2));
     }
+    txPower_ = power;
     
     return true;
 }
 #endif
 
 #if POCKETOS_SX127X_ENABLE_ERROR_HANDLING
+void SX127xDriver::updateLowDataRate() {
+    setLowDataRateOptimize(loraNeedsLowDataRateOptimize(modem_.spreadingFactor, modem_.bandwidthHz));
+}
+
 bool SX127xDriver::setSpreadingFactor(uint8_t sf) {
     if (!initialized_ || sf < 6 || sf > 12) {
         return false;
@@ -316,6 +676,8 @@ bool SX127xDriver::setSpreadingFactor(uint8_t sf) {
         writeRegister(0x37, 0x0A);
     }
     
+    modem_.spreadingFactor = sf;
+    updateLowDataRate();
     return true;
 }
 
@@ -324,22 +686,21 @@ bool SX127xDriver::setBandwidth(uint32_t bw_hz) {
         return false;
     }
     
-    uint8_t bw_code;
-    if (bw_hz <= 7800) bw_code = 0;
-    else if (bw_hz <= 10400) bw_code = 1;
-    else if (bw_hz <= 15600) bw_code = 2;
-    else if (bw_hz <= 20800) bw_code = 3;
-    else if (bw_hz <= 31250) bw_code = 4;
-    else if (bw_hz <= 41700) bw_code = 5;
-    else if (bw_hz <= 62500) bw_code = 6;
-    else if (bw_hz <= 125000) bw_code = 7;
-    else if (bw_hz <= 250000) bw_code = 8;
-    else bw_code = 9;  // 500kHz
+    // Nearest supported bandwidth at or above the request
+    uint8_t bw_code = SX127X_BANDWIDTH_COUNT - 1;
+    for (uint8_t i = 0; i < SX127X_BANDWIDTH_COUNT; i++) {
+        if (bw_hz <= SX127X_BANDWIDTHS[i]) {
+            bw_code = i;
+            break;
+        }
+    }
     
     uint8_t config1 = readRegister(0x1D);
     config1 = (config1 & 0x0F) | (bw_code << 4);
     writeRegister(0x1D, config1);
     
+    modem_.bandwidthHz = SX127X_BANDWIDTHS[bw_code];
+    updateLowDataRate();
     return true;
 }
 
@@ -353,6 +714,7 @@ bool SX127xDriver::setCodingRate(uint8_t cr) {
     config1 = (config1 & 0xF1) | (cr_code << 1);
     writeRegister(0x1D, config1);
     
+    modem_.codingRate = cr;
     return true;
 }
 
@@ -364,9 +726,9 @@ bool SX127xDriver::setPreambleLength(uint16_t length) {
     writeRegister(0x20, (uint8_t)(length >> 8));
     writeRegister(0x21, (uint8_t)(length));
     
+    modem_.preambleSymbols = length;
     return true;
 }
-
 bool SX127xDriver::setSyncWord(uint8_t sw) {
     if (!initialized_) {
         return false;
@@ -389,6 +751,7 @@ bool SX127xDriver::setLowDataRateOptimize(bool enable) {
     }
     writeRegister(0x26, config3);
     
+    modem_.lowDataRateOptimize = enable;
     return true;
 }
 
@@ -405,6 +768,7 @@ bool SX127xDriver::setCRC(bool enable) {
     }
     writeRegister(0x1E, config2);
     
+    modem_.crc = enable;
     return true;
 }
 
@@ -436,8 +800,7 @@ bool SX127xDriver::regRead(uint16_t reg, uint8_t* buf, size_t len) {
         return false;
     }
     
-    uint8_t cmd = reg & 0x7F;
-    return spiWriteRead(&cmd, 1, buf, len);
+    return readBurst((uint8_t)reg, buf, len);
 }
 
 bool SX127xDriver::regWrite(uint16_t reg, const uint8_t* buf, size_t len) {
@@ -445,15 +808,7 @@ bool SX127xDriver::regWrite(uint16_t reg, const uint8_t* buf, size_t len) {
         return false;
     }
     
-    beginTransaction();
-    uint8_t cmd = 0x80 | (reg & 0x7F);
-    SPI.transfer(cmd);
-    for (size_t i = 0; i < len; i++) {
-        SPI.transfer(buf[i]);
-    }
-    endTransaction();
-    
-    return true;
+    return writeBurst((uint8_t)reg, buf, len);
 }
 
 const RegisterDesc* SX127xDriver::findRegisterByName(const String& name) const {
@@ -3,13 +3,54 @@
 
 #include <Arduino.h>
 #include "../driver_config.h"
+#include "../core/capability_schema.h"
 #include "spi_driver_base.h"
 #include "register_types.h"
+#include "lora_airtime.h"
 
 namespace PocketOS {
 
 // SX127x LoRa Transceiver Driver (SX1276/1277/1278/1279)
 // Endpoint format: spi0:cs=5,rst=17,dio0=4 (rst and dio0 optional)
+//
+// The radio runs asynchronously. transmit() queues a packet and returns.
+// update() starts the next queued packet when the duty-cycle budget allows
+// it and no reception is in progress. The radio goes back to continuous RX
+// after TxDone. Received packets go into a queue with their RSSI, SNR and
+// the time of the RxDone edge. DIO0 signals TxDone or RxDone through
+// InterruptManager. Without dio0=, update() reads the IRQ flags on every
+// pass instead.
+
+#ifndef SX127X_TX_QUEUE_SIZE
+#define SX127X_TX_QUEUE_SIZE 4      // Packets; power of two
+#endif
+#ifndef SX127X_RX_QUEUE_SIZE
+#define SX127X_RX_QUEUE_SIZE 8      // Packets; power of two
+#endif
+#ifndef SX127X_DUTY_CYCLE_PERMILLE
+#define SX127X_DUTY_CYCLE_PERMILLE 10           // 1 % (EU868 g/g1); 0 = no limit
+#endif
+#ifndef SX127X_DUTY_WINDOW_MS
+#define SX127X_DUTY_WINDOW_MS 3600000UL         // ETSI EN 300 220: one hour
+#endif
+#define SX127X_TX_TIMEOUT_MARGIN_MS 100         // TxDone later than airtime + this = lost
+
+enum class SX127xState : uint8_t {
+    STANDBY,
+    RX,         // Continuous receive
+    TX
+};
+
+struct SX127xStats {
+    uint32_t txPackets;
+    uint32_t txTimeouts;    // No TxDone within airtime + margin
+    uint32_t txDeferred;    // Packets that had to wait for duty-cycle budget
+    uint32_t rxPackets;
+    uint32_t rxCrcErrors;
+    uint32_t rxDrops;       // RX queue full
+    uint32_t irqEvents;
+    uint64_t airtimeUs;     // Total transmitted
+};
 
 class SX127xDriver : public SPIDriverBase {
 public:
@@ -25,13 +66,37 @@ public:
     // Identification probe - reads VERSION register (0x42)
     static bool identifyProbe(const String& endpoint);
     
+    // Main loop: service DIO0/IRQ flags, TX timeouts and the TX queue
+    void update();
+    
+    // Get capability schema
+    CapabilitySchema getSchema() const;
+    
+    // Parameter get/set
+    String getParameter(const String& name);
+    bool setParameter(const String& name, const String& value);
+    
 #if POCKETOS_SX127X_ENABLE_BASIC_READ
-    // Tier 0: Basic LoRa TX/RX
-    bool transmit(const uint8_t* data, uint8_t len);
+    // Tier 0: Basic LoRa TX/RX (non-blocking)
+    bool transmit(const uint8_t* data, uint8_t len);   // Queue; false if full
     bool receive(uint8_t* data, uint8_t& len, int16_t& rssi, int8_t& snr);
     bool available();
     bool setFrequency(uint32_t freq_hz);
     bool setTxPower(int8_t power);
+    
+    // Packet queues
+    bool popPacket(LoRaPacket& packet);
+    uint8_t txQueued() const { return txQueue_.count(); }
+    uint8_t rxQueued() const { return rxQueue_.count(); }
+    SX127xState getState() const { return state_; }
+    const SX127xStats& getStats() const { return stats_; }
+    
+    // Airtime with the current modem settings, and the wait before a
+    // packet of that length may start under the duty-cycle limit
+    uint32_t airtimeUs(uint8_t len) const { return loraAirtimeUs(modem_, len); }
+    uint32_t txWaitMs(uint8_t len);
+    void setDutyCycle(uint16_t permille, uint32_t windowMs);
+    DutyCycleTracker& dutyCycle() { return duty_; }
 #endif
 
 #if POCKETOS_SX127X_ENABLE_ERROR_HANDLING
@@ -58,12 +123,41 @@ public:
 private:
     bool initialized_;
     uint32_t frequency_;
+    int8_t txPower_;
+    LoRaModemParams modem_;     // Mirrors MODEM_CONFIG1-3 and PREAMBLE
+    SX127xState state_;
+    
+#if POCKETOS_SX127X_ENABLE_BASIC_READ
+    LoRaPacketQueue<SX127X_TX_QUEUE_SIZE> txQueue_;
+    LoRaPacketQueue<SX127X_RX_QUEUE_SIZE> rxQueue_;
+    DutyCycleTracker duty_;
+    uint32_t txStartMs_;
+    uint32_t txTimeoutMs_;
+    bool txWaiting_;            // Head of the TX queue counted in txDeferred
+    int16_t lastRssi_;
+    int8_t lastSnrQ4_;
+#endif
+    SX127xStats stats_;
     
     // Helper methods
     bool setMode(uint8_t mode);
     uint8_t readRegister(uint8_t reg);
     void writeRegister(uint8_t reg, uint8_t value);
+    bool readBurst(uint8_t reg, uint8_t* buf, size_t len);
+    bool writeBurst(uint8_t reg, const uint8_t* buf, size_t len);
     void setLoRaMode();
+#if POCKETOS_SX127X_ENABLE_BASIC_READ
+    void service(uint64_t timestampUs);
+    void readPacket(uint64_t timestampUs);
+    bool startNextTx();
+    void startReceive();
+    int16_t packetRssi(uint8_t raw, int8_t snrQ4) const;
+    bool applyRadioParameter(const String& name, const String& value);
+    static void onIrq(void* context, const IrqEvent& event);
+#endif
+#if POCKETOS_SX127X_ENABLE_ERROR_HANDLING
+    void updateLowDataRate();
+#endif
 };
 
 } // namespace PocketOS
@@ -0,0 +1,385 @@
+#include "tft_framebuffer.h"
+#include "../core/logger.h"
+
+namespace PocketOS {
+
+static const uint8_t TFT_WINDOW_COMMANDS[3] = { TFT_DCS_CASET, TFT_DCS_RASET, TFT_DCS_RAMWR };
+
+TFTFramebuffer::TFTFramebuffer()
+    : mode_(TFTFramebufferMode::OFF), width_(0), height_(0), bandRows_(0),
+      bandY_(0), bandHeight_(0), psram_(false), drawIndex_(0), dirtyCount_(0),
+      chainCounter_(0), flushRect_(0), flushRow_(0),
+      imageRects_(this, &TFTFramebuffer::imageFill, &TFTFramebuffer::imageWrite) {
+    buffers_[0] = nullptr;
+    buffers_[1] = nullptr;
+    sink_.device = nullptr;
+    sink_.send = nullptr;
+    sink_.waitIdle = nullptr;
+}
+
+TFTFramebuffer::~TFTFramebuffer() {
+    end();
+}
+
+bool TFTFramebuffer::begin(const char* panel, const SPIChainSink& sink, uint16_t width, uint16_t height,
+                           TFTFramebufferMode mode, bool doubleBuffer) {
+    end();
+    if (mode == TFTFramebufferMode::OFF || width == 0 || height == 0 || !sink.send) {
+        return false;
+    }
+
+    sink_ = sink;
+
+    width_ = width;
+    height_ = height;
+
+    bool psramAvailable = false;
+#if defined(ARDUINO_ARCH_ESP32)
+    psramAvailable = psramFound();
+#endif
+
+    if (mode == TFTFramebufferMode::AUTO) {
+        mode = psramAvailable ? TFTFramebufferMode::FULL : TFTFramebufferMode::STRIP;
+    }
+
+    if (mode == TFTFramebufferMode::FULL) {
+        bandRows_ = height_;
+        if (!allocate((size_t)width_ * height_ * 2, true)) {
+            Logger::warning("TFTFramebuffer: Full frame does not fit, using strips");
+            mode = TFTFramebufferMode::STRIP;
+        }
+    }
+
+    if (mode == TFTFramebufferMode::STRIP) {
+        bandRows_ = POCKETOS_TFT_STRIP_ROWS < height_ ? POCKETOS_TFT_STRIP_ROWS : height_;
+        if (!allocate((size_t)width_ * bandRows_ * 2, false)) {
+            Logger::error("TFTFramebuffer: Out of memory");
+            return false;
+        }
+    }
+
+    // Second buffer is optional; fall back to single buffering
+    if (doubleBuffer) {
+        size_t bytes = (size_t)width_ * bandRows_ * 2;
+        uint16_t* first = buffers_[0];
+        bool firstPSRAM = psram_;
+        if (allocate(bytes, firstPSRAM)) {
+            buffers_[1] = buffers_[0];
+            buffers_[0] = first;
+            psram_ = firstPSRAM;
+        } else {
+            buffers_[0] = first;
+            psram_ = firstPSRAM;
+            Logger::warning("TFTFramebuffer: No memory for second buffer");
+        }
+    }
+
+    mode_ = mode;
+    drawIndex_ = 0;
+    bandY_ = 0;
+    bandHeight_ = bandRows_;
+    dirtyCount_ = 0;
+    memset(buffers_[0], 0, (size_t)width_ * bandRows_ * 2);
+    if (buffers_[1]) {
+        memset(buffers_[1], 0, (size_t)width_ * bandRows_ * 2);
+    }
+
+    Logger::info((String(panel) + ": Framebuffer " + (mode_ == TFTFramebufferMode::FULL ? "full" : "strip") +
+                  (buffers_[1] ? ", double buffered" : "") + (psram_ ? ", PSRAM" : "")).c_str());
+    return true;
+}
+
+void TFTFramebuffer::end() {
+    // The transfer task may still be reading a buffer
+    if (buffers_[0] && sink_.waitIdle) {
+        sink_.waitIdle();
+    }
+    for (int i = 0; i < 2; i++) {
+        if (buffers_[i]) {
+            free(buffers_[i]);
+            buffers_[i] = nullptr;
+        }
+    }
+    mode_ = TFTFramebufferMode::OFF;
+    dirtyCount_ = 0;
+    psram_ = false;
+}
+
+bool TFTFramebuffer::allocate(size_t bytes, bool preferPSRAM) {
+    void* p = nullptr;
+    psram_ = false;
+#if defined(ARDUINO_ARCH_ESP32)
+    if (preferPSRAM && psramFound()) {
+        p = ps_malloc(bytes);
+        psram_ = (p != nullptr);
+    }
+#else
+    (void)preferPSRAM;
+#endif
+    if (!p) {
+        p = malloc(bytes);
+    }
+    buffers_[0] = (uint16_t*)p;
+    return p != nullptr;
+}
+
+uint16_t TFTFramebuffer::bandCount() const {
+    if (mode_ != TFTFramebufferMode::STRIP || bandRows_ == 0) {
+        return 1;
+    }
+    return (uint16_t)((height_ + bandRows_ - 1) / bandRows_);
+}
+
+void TFTFramebuffer::selectBand(uint16_t band, uint16_t background) {
+    if (mode_ != TFTFramebufferMode::STRIP || band >= bandCount()) {
+        return;
+    }
+
+    // Alternate bands between buffers so band N is drawn while N-1 is sent
+    drawIndex_ = (buffers_[1] && (band & 1)) ? 1 : 0;
+    bandY_ = band * bandRows_;
+    bandHeight_ = (height_ - bandY_) < bandRows_ ? (height_ - bandY_) : bandRows_;
+
+    uint16_t wire = toWire(background);
+    uint16_t* buf = drawBuffer();
+    size_t pixels = (size_t)width_ * bandHeight_;
+    for (size_t i = 0; i < pixels; i++) {
+        buf[i] = wire;
+    }
+
+    dirtyCount_ = 0;
+    addDirty(0, bandY_, width_, bandHeight_);
+}
+
+void TFTFramebuffer::setPixel(uint16_t x, uint16_t y, uint16_t color) {
+    if (!isEnabled() || x >= width_ || y < bandY_ || y >= bandY_ + bandHeight_) {
+        return;
+    }
+    drawBuffer()[(size_t)(y - bandY_) * width_ + x] = toWire(color);
+    addDirty(x, y, 1, 1);
+}
+
+void TFTFramebuffer::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    if (!isEnabled() || w == 0 || h == 0 || x >= width_) {
+        return;
+    }
+
+    // Clip to screen width and to the current band
+    uint32_t x1 = (uint32_t)x + w;
+    uint32_t y1 = (uint32_t)y + h;
+    if (x1 > width_) x1 = width_;
+    if (y < bandY_) y = bandY_;
+    if (y1 > (uint32_t)bandY_ + bandHeight_) y1 = (uint32_t)bandY_ + bandHeight_;
+    if (y >= y1) {
+        return;
+    }
+    w = (uint16_t)(x1 - x);
+    h = (uint16_t)(y1 - y);
+
+    uint16_t wire = toWire(color);
+    uint16_t* row = drawBuffer() + (size_t)(y - bandY_) * width_ + x;
+    for (uint16_t r = 0; r < h; r++) {
+        for (uint16_t c = 0; c < w; c++) {
+            row[c] = wire;
+        }
+        row += width_;
+    }
+    addDirty(x, y, w, h);
+}
+
+void TFTFramebuffer::writeRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* pixels, size_t stride) {
+    if (!isEnabled() || !pixels || w == 0 || h == 0 || x >= width_) {
+        return;
+    }
+
+    // Clip to screen width and to the current band (source skips the same rows)
+    uint32_t x1 = (uint32_t)x + w;
+    uint32_t y1 = (uint32_t)y + h;
+    if (x1 > width_) x1 = width_;
+    if (y < bandY_) {
+        pixels += (size_t)(bandY_ - y) * stride;
+        y = bandY_;
+    }
+    if (y1 > (uint32_t)bandY_ + bandHeight_) y1 = (uint32_t)bandY_ + bandHeight_;
+    if (y >= y1) {
+        return;
+    }
+    w = (uint16_t)(x1 - x);
+    h = (uint16_t)(y1 - y);
+
+    uint16_t* row = drawBuffer() + (size_t)(y - bandY_) * width_ + x;
+    for (uint16_t r = 0; r < h; r++) {
+        for (uint16_t c = 0; c < w; c++) {
+            row[c] = toWire(pixels[c]);
+        }
+        row += width_;
+        pixels += stride;
+    }
+    addDirty(x, y, w, h);
+}
+
+// Image pieces arrive already clipped to the screen (gfxStreamImage)
+void TFTFramebuffer::imageFill(void* self, int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+    static_cast<TFTFramebuffer*>(self)->fillRect((uint16_t)x, (uint16_t)y, (uint16_t)w, (uint16_t)h, color);
+}
+
+void TFTFramebuffer::imageWrite(void* self, int32_t x, int32_t y, int32_t w, const uint16_t* pixels) {
+    static_cast<TFTFramebuffer*>(self)->writeRect((uint16_t)x, (uint16_t)y, (uint16_t)w, 1, pixels, (size_t)w);
+}
+
+TFTRect TFTFramebuffer::unite(const TFTRect& a, const TFTRect& b) {
+    uint16_t x0 = a.x < b.x ? a.x : b.x;
+    uint16_t y0 = a.y < b.y ? a.y : b.y;
+    uint32_t ax1 = (uint32_t)a.x + a.w, bx1 = (uint32_t)b.x + b.w;
+    uint32_t ay1 = (uint32_t)a.y + a.h, by1 = (uint32_t)b.y + b.h;
+    TFTRect u;
+    u.x = x0;
+    u.y = y0;
+    u.w = (uint16_t)((ax1 > bx1 ? ax1 : bx1) - x0);
+    u.h = (uint16_t)((ay1 > by1 ? ay1 : by1) - y0);
+    return u;
+}
+
+void TFTFramebuffer::addDirty(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    TFTRect r = { x, y, w, h };
+
+    // Merge into an existing rectangle when the union wastes little area
+    int best = -1;
+    uint32_t bestCost = 0xFFFFFFFF;
+    for (uint8_t i = 0; i < dirtyCount_; i++) {
+        TFTRect u = unite(dirty_[i], r);
+        uint32_t cost = area(u) - area(dirty_[i]);
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = i;
+        }
+        if (area(u) <= area(dirty_[i]) + area(r) + TFT_DIRTY_MERGE_SLACK) {
+            dirty_[i] = u;
+            return;
+        }
+    }
+
+    if (dirtyCount_ < TFT_MAX_DIRTY_RECTS) {
+        dirty_[dirtyCount_++] = r;
+    } else {
+        // List full: grow the rectangle that needs the least extra area
+        dirty_[best] = unite(dirty_[best], r);
+    }
+}
+
+void TFTFramebuffer::coalesce() {
+    // Merging can make further merges worthwhile; repeat until stable
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (uint8_t i = 0; i < dirtyCount_ && !merged; i++) {
+            for (uint8_t j = i + 1; j < dirtyCount_; j++) {
+                TFTRect u = unite(dirty_[i], dirty_[j]);
+                if (area(u) <= area(dirty_[i]) + area(dirty_[j]) + TFT_DIRTY_MERGE_SLACK) {
+                    dirty_[i] = u;
+                    dirty_[j] = dirty_[--dirtyCount_];
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+bool TFTFramebuffer::flush() {
+    if (!isEnabled() || !sink_.send) {
+        return false;
+    }
+
+    const SPITransferDesc* chain;
+    size_t count;
+    bool ok = true;
+    beginFlush();
+    while (ok && nextChain(chain, count)) {
+        ok = sink_.send(sink_.device, chain, count);
+    }
+    endFlush();
+
+    // Single buffer: drawing must not overwrite pixels still being sent
+    if (!isDoubleBuffered() && sink_.waitIdle) {
+        sink_.waitIdle();
+    }
+    return ok;
+}
+
+void TFTFramebuffer::beginFlush() {
+    coalesce();
+    flushRect_ = 0;
+    flushRow_ = 0;
+}
+
+bool TFTFramebuffer::nextChain(const SPITransferDesc*& chain, size_t& count) {
+    if (!isEnabled() || flushRect_ >= dirtyCount_) {
+        return false;
+    }
+
+    const TFTRect& r = dirty_[flushRect_];
+    uint16_t rows = r.h - flushRow_;
+    if (rows > TFT_FLUSH_MAX_ROWS) {
+        rows = TFT_FLUSH_MAX_ROWS;
+    }
+
+    uint16_t x0 = r.x;
+    uint16_t x1 = r.x + r.w - 1;
+    uint16_t y0 = r.y + flushRow_;
+    uint16_t y1 = y0 + rows - 1;
+
+    FlushChain& c = chains_[chainCounter_ & 1];
+    chainCounter_++;
+
+    c.caset[0] = x0 >> 8; c.caset[1] = x0 & 0xFF; c.caset[2] = x1 >> 8; c.caset[3] = x1 & 0xFF;
+    c.raset[0] = y0 >> 8; c.raset[1] = y0 & 0xFF; c.raset[2] = y1 >> 8; c.raset[3] = y1 & 0xFF;
+
+    c.segs[0] = SPITransferDesc::command(&TFT_WINDOW_COMMANDS[0], 1);
+    c.segs[1] = SPITransferDesc::data(c.caset, 4);
+    c.segs[2] = SPITransferDesc::command(&TFT_WINDOW_COMMANDS[1], 1);
+    c.segs[3] = SPITransferDesc::data(c.raset, 4);
+    c.segs[4] = SPITransferDesc::command(&TFT_WINDOW_COMMANDS[2], 1);
+
+    const uint16_t* src = drawBuffer() + (size_t)(y0 - bandY_) * width_ + x0;
+    if (r.w == width_) {
+        // Full-width rows are contiguous: one bulk segment
+        c.segs[5] = SPITransferDesc::data((const uint8_t*)src, (size_t)rows * width_ * 2);
+        count = 6;
+    } else {
+        for (uint16_t i = 0; i < rows; i++) {
+            c.segs[5 + i] = SPITransferDesc::data((const uint8_t*)(src + (size_t)i * width_), (size_t)r.w * 2);
+        }
+        count = 5 + rows;
+    }
+    chain = c.segs;
+
+    flushRow_ += rows;
+    if (flushRow_ >= r.h) {
+        flushRect_++;
+        flushRow_ = 0;
+    }
+    return true;
+}
+
+void TFTFramebuffer::endFlush() {
+    // Swap only after something was sent: with nothing queued, the other
+    // buffer may still be read by the previous flush's transfer
+    if (mode_ == TFTFramebufferMode::FULL && buffers_[1] && dirtyCount_ > 0) {
+        // Swap: the flushed buffer stays untouched while it is transferred.
+        // Bring the new draw buffer up to date with the regions just sent.
+        uint16_t* sent = drawBuffer();
+        drawIndex_ ^= 1;
+        uint16_t* next = drawBuffer();
+        for (uint8_t i = 0; i < dirtyCount_; i++) {
+            const TFTRect& r = dirty_[i];
+            for (uint16_t row = 0; row < r.h; row++) {
+                size_t offset = (size_t)(r.y + row) * width_ + r.x;
+                memcpy(next + offset, sent + offset, (size_t)r.w * 2);
+            }
+        }
+    }
+    dirtyCount_ = 0;
+}
+
+} // namespace PocketOS
@@ -0,0 +1,156 @@
+#ifndef POCKETOS_TFT_FRAMEBUFFER_H
+#define POCKETOS_TFT_FRAMEBUFFER_H
+
+#include <Arduino.h>
+#include "spi_driver_base.h"
+#include "gfx_image.h"
+
+namespace PocketOS {
+
+/**
+ * TFT Framebuffer - RGB565 off-screen buffer with dirty-rectangle flush
+ *
+ * Shared by the ILI9341, ST7789 and ST7735 drivers. Drawing goes into RAM;
+ * flush() sends each dirty rectangle as one chained SPI transaction
+ * (CASET, RASET, RAMWR, pixels) under a single CS assertion, through the
+ * driver's SPIChainSink. The drivers only forward to this class.
+ *
+ * Modes:
+ * - FULL:  whole screen in RAM (PSRAM when available). Dirty rectangles
+ *          are coalesced and only changed areas are sent.
+ * - STRIP: a band of POCKETOS_TFT_STRIP_ROWS rows. The frame is rendered
+ *          band by band: selectBand() clears the band to the background
+ *          colour, drawing is clipped to it, and flush() sends the band.
+ * - AUTO:  FULL in PSRAM if present, otherwise STRIP.
+ *
+ * Double buffering keeps two buffers (or two bands) so the next frame or
+ * band is drawn while the previous one is still being transferred.
+ *
+ * Pixels are stored byte-swapped (big-endian) so buffers go to the panel
+ * without conversion.
+ */
+
+// Rows per band in STRIP mode
+// Can be overridden via build flags: -DPOCKETOS_TFT_STRIP_ROWS=40
+#ifndef POCKETOS_TFT_STRIP_ROWS
+#define POCKETOS_TFT_STRIP_ROWS 20
+#endif
+
+// Dirty rectangles tracked before forced merging
+#define TFT_MAX_DIRTY_RECTS 8
+
+// Rows sent per chained transaction (bounds descriptor storage)
+#define TFT_FLUSH_MAX_ROWS 64
+
+// Extra pixels a merge may cover and still be cheaper than a second window set
+#define TFT_DIRTY_MERGE_SLACK 64
+
+// MIPI DCS commands shared by ILI9341/ST7789/ST7735
+#define TFT_DCS_CASET 0x2A
+#define TFT_DCS_RASET 0x2B
+#define TFT_DCS_RAMWR 0x2C
+
+enum class TFTFramebufferMode : uint8_t {
+    OFF = 0,
+    FULL = 1,
+    STRIP = 2,
+    AUTO = 3
+};
+
+struct TFTRect {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+};
+
+class TFTFramebuffer {
+public:
+    TFTFramebuffer();
+    ~TFTFramebuffer();
+
+    // Allocate buffers (AUTO resolves to FULL or STRIP). Chains go out
+    // through sink; panel names the driver in log messages.
+    bool begin(const char* panel, const SPIChainSink& sink, uint16_t width, uint16_t height,
+               TFTFramebufferMode mode, bool doubleBuffer);
+    // Waits for chains still in flight, then frees the buffers
+    void end();
+
+    bool isEnabled() const { return mode_ != TFTFramebufferMode::OFF; }
+    TFTFramebufferMode getMode() const { return mode_; }
+    bool isDoubleBuffered() const { return buffers_[1] != nullptr; }
+    bool isInPSRAM() const { return psram_; }
+
+    // Bands (1 in FULL mode)
+    uint16_t bandCount() const;
+    uint16_t bandRows() const { return bandRows_; }
+
+    // STRIP: make a band current, clear it and mark it dirty. FULL: no-op.
+    void selectBand(uint16_t band, uint16_t background);
+
+    // Drawing (screen coordinates, clipped to the screen and current band)
+    void setPixel(uint16_t x, uint16_t y, uint16_t color);
+    void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+    void writeRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* pixels, size_t stride);
+
+    // Target for gfxStreamImage(), drawn like writeRect()
+    GfxImageSink imageSink() { return imageRects_.sink(); }
+
+    // Send the dirty rectangles. One chain is prepared while the previous
+    // one is still being sent; single buffering waits for the last one.
+    bool flush();
+
+    // Flush protocol used by flush(): beginFlush(), nextChain() until
+    // false, endFlush(). Each chain stays valid until the chain after the
+    // next one is built.
+    void beginFlush();
+    bool nextChain(const SPITransferDesc*& chain, size_t& count);
+    void endFlush();
+
+    bool hasDirty() const { return dirtyCount_ > 0; }
+
+private:
+    struct FlushChain {
+        uint8_t caset[4];
+        uint8_t raset[4];
+        SPITransferDesc segs[5 + TFT_FLUSH_MAX_ROWS];
+    };
+
+    TFTFramebufferMode mode_;
+    SPIChainSink sink_;
+    uint16_t width_;
+    uint16_t height_;
+    uint16_t bandRows_;
+    uint16_t bandY_;         // First screen row of the current band
+    uint16_t bandHeight_;    // Rows in the current band
+    bool psram_;
+
+    uint16_t* buffers_[2];   // Second buffer only with double buffering
+    uint8_t drawIndex_;      // Buffer currently drawn into
+
+    TFTRect dirty_[TFT_MAX_DIRTY_RECTS];
+    uint8_t dirtyCount_;
+
+    // Flush iteration state
+    FlushChain chains_[2];
+    uint32_t chainCounter_;
+    uint8_t flushRect_;
+    uint16_t flushRow_;
+
+    GfxImageRectSink imageRects_;
+
+    uint16_t* drawBuffer() const { return buffers_[drawIndex_]; }
+    bool allocate(size_t bytes, bool preferPSRAM);
+    void addDirty(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+    void coalesce();
+
+    static uint16_t toWire(uint16_t color) { return (uint16_t)((color >> 8) | (color << 8)); }
+    static uint32_t area(const TFTRect& r) { return (uint32_t)r.w * r.h; }
+    static TFTRect unite(const TFTRect& a, const TFTRect& b);
+    static void imageFill(void* self, int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+    static void imageWrite(void* self, int32_t x, int32_t y, int32_t w, const uint16_t* pixels);
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_TFT_FRAMEBUFFER_H
@@ -0,0 +1,110 @@
+#include "thermal_display.h"
+#include "../core/logger.h"
+
+namespace PocketOS {
+
+ThermalDisplayService::ThermalDisplayService(MLX90640Driver& sensor, IGfxPanel& panel)
+    : sensor_(sensor), panel_(panel), scale_(0), lastFrame_(0), rendered_(0), lastRenderUs_(0),
+      windowStart_(0), windowFrames_(0), fps_(0) {}
+
+bool ThermalDisplayService::init() {
+    if (!sensor_.isInitialized()) {
+        Logger::error("ThermalDisplay: Sensor not initialized");
+        return false;
+    }
+    if (effectiveScale(scale_) == 0) {
+        Logger::error("ThermalDisplay: Panel too small");
+        return false;
+    }
+    lastFrame_ = sensor_.frameCount();
+    rendered_ = 0;
+    windowStart_ = millis();
+    windowFrames_ = 0;
+    fps_ = 0;
+    return true;
+}
+
+void ThermalDisplayService::tick() {
+    sensor_.readData();
+
+    const int16_t* image = sensor_.image();
+    uint32_t frame = sensor_.frameCount();
+    if (!image || frame == lastFrame_) {
+        return;
+    }
+    lastFrame_ = frame;
+
+    if (draw(image, effectiveScale(scale_))) {
+        windowFrames_++;
+    }
+
+    unsigned long now = millis();
+    if (now - windowStart_ >= 1000) {
+        fps_ = windowFrames_ * 1000.0f / (float)(now - windowStart_);
+        windowStart_ = now;
+        windowFrames_ = 0;
+    }
+}
+
+void ThermalDisplayService::shutdown() {
+    view_.end();
+}
+
+bool ThermalDisplayService::setScale(uint8_t scale) {
+    if (scale > THERMAL_MAX_SCALE || (scale != 0 && effectiveScale(scale) != scale)) {
+        return false;
+    }
+    scale_ = scale;
+    return true;
+}
+
+uint8_t ThermalDisplayService::effectiveScale(uint8_t scale) const {
+    uint8_t fit = ThermalView::fitScale(panel_.width(), panel_.height());
+    if (scale == 0) {
+        return fit;
+    }
+    return scale <= fit ? scale : 0;
+}
+
+bool ThermalDisplayService::draw(const int16_t* image, uint8_t scale) {
+    if (scale == 0) {
+        return false;
+    }
+    uint16_t x = (uint16_t)((panel_.width() - MLX90640_COLUMNS * scale) / 2);
+    uint16_t y = (uint16_t)((panel_.height() - MLX90640_ROWS * scale) / 2);
+
+    unsigned long start = micros();
+    bool ok = view_.render(image, panel_, x, y, scale);
+    lastRenderUs_ = (uint32_t)(micros() - start);
+    if (ok) {
+        rendered_++;
+    }
+    return ok;
+}
+
+float ThermalDisplayService::benchmark(uint8_t scale, uint16_t frames) {
+    scale = effectiveScale(scale);
+    if (scale == 0 || frames == 0) {
+        return 0;
+    }
+
+    int16_t* image = (int16_t*)malloc(MLX90640_PIXELS * sizeof(int16_t));
+    if (!image) {
+        return 0;
+    }
+
+    unsigned long start = micros();
+    for (uint16_t f = 0; f < frames; f++) {
+        thermalTestImage(image, f);
+        draw(image, scale);
+    }
+    unsigned long elapsed = micros() - start;
+    free(image);
+
+    float fps = elapsed > 0 ? frames * 1000000.0f / (float)elapsed : 0;
+    Logger::info(("ThermalDisplay: " + String(scale) + "x " + String(fps, 1) + " fps (" +
+                  String((uint32_t)(elapsed / frames)) + " us/frame)").c_str());
+    return fps;
+}
+
+} // namespace PocketOS
@@ -0,0 +1,78 @@
+#ifndef POCKETOS_THERMAL_DISPLAY_H
+#define POCKETOS_THERMAL_DISPLAY_H
+
+#include <Arduino.h>
+#include "../core/service_manager.h"
+#include "mlx90640_driver.h"
+#include "thermal_view.h"
+
+namespace PocketOS {
+
+/**
+ * Thermal Display Service
+ *
+ * Pipeline stage from an MLX90640 to a panel: every tick advances the
+ * sensor's chunked subpage read (readData()), and each completed subpage
+ * is rendered through ThermalView, centred on the panel at the largest
+ * scale that fits (or a fixed scale).
+ *
+ * The service owns the sensor's read loop; the same sensor must not also
+ * be bound in DeviceRegistry (both would consume the data-ready flag).
+ *
+ *   MLX90640Driver thermal;
+ *   ILI9341Driver tft;
+ *   GfxTFTPanel<ILI9341Driver> panel(tft);
+ *   ThermalDisplayService thermalView(thermal, panel);
+ *
+ *   thermal.init(0x33);
+ *   tft.init(...); tft.setRotation(1);          // 320x240: 8x = 256x192
+ *   ServiceManager::registerService(&thermalView);
+ *   ServiceManager::startService("thermal");
+ */
+class ThermalDisplayService : public Service {
+public:
+    ThermalDisplayService(MLX90640Driver& sensor, IGfxPanel& panel);
+
+    bool init() override;
+    void tick() override;
+    void shutdown() override;
+    const char* getName() const override { return "thermal"; }
+    uint32_t getTickInterval() const override { return 1; }  // Every tick; reads are chunked
+
+    ThermalView& view() { return view_; }
+
+    // Output scale (1..THERMAL_MAX_SCALE); 0 = largest that fits the panel
+    bool setScale(uint8_t scale);
+    uint8_t getScale() const { return scale_; }
+
+    // Frames drawn, time of the last render and rendered frames per second
+    uint32_t framesRendered() const { return rendered_; }
+    uint32_t lastRenderMicros() const { return lastRenderUs_; }
+    float fps() const { return fps_; }
+
+    // Render `frames` synthetic images at `scale` as fast as possible and
+    // return frames per second (blocking; measures upscale + panel writes)
+    float benchmark(uint8_t scale, uint16_t frames);
+
+private:
+    MLX90640Driver& sensor_;
+    IGfxPanel& panel_;
+    ThermalView view_;
+
+    uint8_t scale_;         // Requested scale (0 = fit)
+    uint32_t lastFrame_;    // Sensor frame count last rendered
+    uint32_t rendered_;
+    uint32_t lastRenderUs_;
+
+    // fps over a one second window
+    unsigned long windowStart_;
+    uint32_t windowFrames_;
+    float fps_;
+
+    bool draw(const int16_t* image, uint8_t scale);
+    uint8_t effectiveScale(uint8_t scale) const;
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_THERMAL_DISPLAY_H
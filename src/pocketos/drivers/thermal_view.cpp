@@ -0,0 +1,256 @@
+#include "thermal_view.h"
+
+#include <stdlib.h>
+
+namespace PocketOS {
+
+#define THERMAL_LEVEL_MAX (255 << 8)
+
+// Palette gradients: RGB888 stops spread evenly over the 256 entries
+struct ThermalStop {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+static const ThermalStop IRON_STOPS[] = {
+    { 0, 0, 0 }, { 32, 0, 140 }, { 180, 0, 150 }, { 240, 80, 0 }, { 255, 200, 0 }, { 255, 255, 255 }
+};
+static const ThermalStop RAINBOW_STOPS[] = {
+    { 0, 0, 128 }, { 0, 0, 255 }, { 0, 255, 255 }, { 0, 255, 0 }, { 255, 255, 0 }, { 255, 0, 0 }
+};
+static const ThermalStop GREY_STOPS[] = {
+    { 0, 0, 0 }, { 255, 255, 255 }
+};
+
+static inline uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b) {
+    return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+void thermalAxis(uint16_t o, uint8_t scale, uint8_t n, uint8_t* index, uint16_t* weight) {
+    // Output pixel centres on the source grid: (o + 0.5) / scale - 0.5, Q8
+    int32_t p = (((int32_t)(2 * o + 1) << 8) / (2 * scale)) - 128;
+    if (p < 0) {
+        p = 0;
+    }
+    int32_t i = p >> 8;
+    int32_t w = p & 0xFF;
+    if (i >= n - 1) {
+        i = n - 2;
+        w = 256;
+    }
+    *index = (uint8_t)i;
+    *weight = (uint16_t)w;
+}
+
+ThermalView::ThermalView()
+    : palette_(THERMAL_PALETTE_IRON), auto_(true), haveRange_(false), min_(2000), max_(4000),
+      tableScale_(0), band_(nullptr), bandSize_(0), lastBands_(0) {
+    setPalette(THERMAL_PALETTE_IRON);
+}
+
+ThermalView::~ThermalView() {
+    end();
+}
+
+void ThermalView::end() {
+    free(band_);
+    band_ = nullptr;
+    bandSize_ = 0;
+}
+
+void ThermalView::setPalette(ThermalPalette palette) {
+    const ThermalStop* stops = IRON_STOPS;
+    size_t count = sizeof(IRON_STOPS) / sizeof(IRON_STOPS[0]);
+    if (palette == THERMAL_PALETTE_RAINBOW) {
+        stops = RAINBOW_STOPS;
+        count = sizeof(RAINBOW_STOPS) / sizeof(RAINBOW_STOPS[0]);
+    } else if (palette == THERMAL_PALETTE_GREY) {
+        stops = GREY_STOPS;
+        count = sizeof(GREY_STOPS) / sizeof(GREY_STOPS[0]);
+    }
+    palette_ = palette;
+
+    const uint32_t segments = (uint32_t)(count - 1);
+    for (uint32_t i = 0; i < 256; i++) {
+        // Position along the gradient, 0 .. segments in Q8
+        uint32_t pos = (i * segments * 256) / 255;
+        uint32_t s = pos >> 8;
+        uint32_t f = pos & 0xFF;
+        if (s >= segments) {
+            s = segments - 1;
+            f = 256;
+        }
+        const ThermalStop& a = stops[s];
+        const ThermalStop& b = stops[s + 1];
+        uint8_t r = (uint8_t)(a.r + (((int32_t)b.r - a.r) * (int32_t)f) / 256);
+        uint8_t g = (uint8_t)(a.g + (((int32_t)b.g - a.g) * (int32_t)f) / 256);
+        uint8_t bl = (uint8_t)(a.b + (((int32_t)b.b - a.b) * (int32_t)f) / 256);
+        lut_[i] = rgb565(r, g, bl);
+    }
+}
+
+bool ThermalView::setRange(int16_t lo, int16_t hi) {
+    if (hi <= lo) {
+        return false;
+    }
+    min_ = lo;
+    max_ = hi;
+    auto_ = false;
+    haveRange_ = true;
+    return true;
+}
+
+void ThermalView::setAutoRange(bool enabled) {
+    auto_ = enabled;
+    haveRange_ = false;
+}
+
+uint8_t ThermalView::fitScale(uint16_t w, uint16_t h) {
+    uint16_t sx = w / MLX90640_COLUMNS;
+    uint16_t sy = h / MLX90640_ROWS;
+    uint16_t s = sx < sy ? sx : sy;
+    return (uint8_t)(s > THERMAL_MAX_SCALE ? THERMAL_MAX_SCALE : s);
+}
+
+void ThermalView::updateRange(const int16_t* image) {
+    int16_t lo = image[0];
+    int16_t hi = image[0];
+    for (uint16_t p = 1; p < MLX90640_PIXELS; p++) {
+        if (image[p] < lo) lo = image[p];
+        if (image[p] > hi) hi = image[p];
+    }
+
+    if (haveRange_) {
+        // Move a quarter of the way per frame
+        lo = (int16_t)(min_ + ((int32_t)lo - min_) / 4);
+        hi = (int16_t)(max_ + ((int32_t)hi - max_) / 4);
+    }
+    if ((int32_t)hi - lo < POCKETOS_THERMAL_MIN_SPAN) {
+        int32_t mid = ((int32_t)lo + hi) / 2;
+        int32_t l = mid - POCKETOS_THERMAL_MIN_SPAN / 2;
+        if (l < -32768) l = -32768;
+        if (l > 32767 - POCKETOS_THERMAL_MIN_SPAN) l = 32767 - POCKETOS_THERMAL_MIN_SPAN;
+        lo = (int16_t)l;
+        hi = (int16_t)(l + POCKETOS_THERMAL_MIN_SPAN);
+    }
+    min_ = lo;
+    max_ = hi;
+    haveRange_ = true;
+}
+
+void ThermalView::computeLevels(const int16_t* image) {
+    const int32_t span = (int32_t)max_ - min_;
+    // d <= span, so d * k <= 255 << 16 stays in 32 bits
+    const int32_t k = (int32_t)((255UL << 16) / (uint32_t)span);
+    for (uint16_t p = 0; p < MLX90640_PIXELS; p++) {
+        int32_t d = (int32_t)image[p] - min_;
+        if (d < 0) d = 0;
+        if (d > span) d = span;
+        int32_t level = (d * k) >> 8;
+        level_[p] = (uint16_t)(level > THERMAL_LEVEL_MAX ? THERMAL_LEVEL_MAX : level);
+    }
+}
+
+void ThermalView::buildTable(uint8_t scale) {
+    uint16_t w = (uint16_t)(MLX90640_COLUMNS * scale);
+    for (uint16_t o = 0; o < w; o++) {
+        thermalAxis(o, scale, MLX90640_COLUMNS, &xIndex_[o], &xWeight_[o]);
+    }
+    tableScale_ = scale;
+}
+
+bool ThermalView::render(const int16_t* image, IGfxPanel& panel, uint16_t x, uint16_t y, uint8_t scale) {
+    if (!image || scale == 0 || scale > THERMAL_MAX_SCALE) {
+        return false;
+    }
+    const uint16_t w = (uint16_t)(MLX90640_COLUMNS * scale);
+    const uint16_t h = (uint16_t)(MLX90640_ROWS * scale);
+    if ((uint32_t)x + w > panel.width() || (uint32_t)y + h > panel.height()) {
+        return false;
+    }
+
+    uint16_t bandRows = (uint16_t)(POCKETOS_THERMAL_BAND_PIXELS / w);
+    if (bandRows == 0) bandRows = 1;
+    if (bandRows > h) bandRows = h;
+    size_t need = (size_t)w * bandRows;
+    if (need > bandSize_) {
+        uint16_t* band = (uint16_t*)realloc(band_, need * sizeof(uint16_t));
+        if (!band) {
+            return false;
+        }
+        band_ = band;
+        bandSize_ = need;
+    }
+
+    if (auto_) {
+        updateRange(image);
+    }
+    computeLevels(image);
+    if (tableScale_ != scale) {
+        buildTable(scale);
+    }
+
+    // Vertically blended source row and its horizontal deltas
+    int32_t row[MLX90640_COLUMNS];
+    int32_t delta[MLX90640_COLUMNS];
+
+    lastBands_ = 0;
+    uint16_t rowsInBand = 0;
+    uint16_t bandY = y;
+    for (uint16_t oy = 0; oy < h; oy++) {
+        uint8_t yi;
+        uint16_t wy;
+        thermalAxis(oy, scale, MLX90640_ROWS, &yi, &wy);
+
+        const uint16_t* a = level_ + (uint16_t)yi * MLX90640_COLUMNS;
+        const uint16_t* b = a + MLX90640_COLUMNS;
+        for (uint8_t c = 0; c < MLX90640_COLUMNS; c++) {
+            row[c] = (int32_t)a[c] + ((((int32_t)b[c] - a[c]) * wy) >> 8);
+        }
+        for (uint8_t c = 0; c < MLX90640_COLUMNS - 1; c++) {
+            delta[c] = row[c + 1] - row[c];
+        }
+        delta[MLX90640_COLUMNS - 1] = 0;
+
+        uint16_t* out = band_ + (size_t)rowsInBand * w;
+        for (uint16_t ox = 0; ox < w; ox++) {
+            uint8_t i = xIndex_[ox];
+            int32_t v = row[i] + ((delta[i] * xWeight_[ox]) >> 8);
+            out[ox] = lut_[v >> 8];
+        }
+
+        if (++rowsInBand == bandRows || oy == h - 1) {
+            panel.writeRect(x, bandY, w, rowsInBand, band_, w);
+            bandY += rowsInBand;
+            rowsInBand = 0;
+            lastBands_++;
+        }
+    }
+    panel.flush();
+    return true;
+}
+
+void thermalTestImage(int16_t* image, uint16_t phase) {
+    // Hot spot on a circle around the centre, ~25 degC background
+    static const int8_t path[16][2] = {
+        { 8, 0 }, { 7, 3 }, { 6, 6 }, { 3, 7 }, { 0, 8 }, { -3, 7 }, { -6, 6 }, { -7, 3 },
+        { -8, 0 }, { -7, -3 }, { -6, -6 }, { -3, -7 }, { 0, -8 }, { 3, -7 }, { 6, -6 }, { 7, -3 }
+    };
+    const int16_t cx = 16 + path[phase & 15][0];
+    const int16_t cy = 12 + path[phase & 15][1] / 2;
+    for (int16_t r = 0; r < MLX90640_ROWS; r++) {
+        for (int16_t c = 0; c < MLX90640_COLUMNS; c++) {
+            int32_t dx = c - cx;
+            int32_t dy = r - cy;
+            int32_t d2 = dx * dx + dy * dy;
+            int32_t t = 2500 + r * 8 + ((phase * 7 + r * 13 + c * 29) % 11) - 5;
+            if (d2 < 36) {
+                t += (36 - d2) * 30;   // Up to ~36 degC at the centre
+            }
+            image[r * MLX90640_COLUMNS + c] = (int16_t)t;
+        }
+    }
+}
+
+} // namespace PocketOS
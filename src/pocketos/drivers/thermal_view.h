@@ -0,0 +1,119 @@
+#ifndef POCKETOS_THERMAL_VIEW_H
+#define POCKETOS_THERMAL_VIEW_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "gfx_panel.h"
+#include "mlx90640_calibration.h"
+
+namespace PocketOS {
+
+/**
+ * Thermal Image View
+ *
+ * Renders a 32x24 thermal image (0.01 degC, as produced by
+ * MLX90640Driver) scaled up on any IGfxPanel:
+ *
+ *   1. Each source pixel is mapped once per frame to a palette level
+ *      (Q8 fixed point) using the current range.
+ *   2. Output rows are bilinearly interpolated from those levels with
+ *      precomputed per-column indices and weights (integer only), then
+ *      looked up in a 256-entry RGB565 false-colour table.
+ *   3. Rows are collected into a band of at most
+ *      POCKETOS_THERMAL_BAND_PIXELS pixels and written with writeRect(),
+ *      so the upscaled image never exists in RAM as a whole.
+ *
+ * Auto-range follows the frame minimum/maximum with smoothing so the
+ * colours do not flicker; setRange() fixes the range instead.
+ *
+ * This header has no Arduino dependency so the view can be benchmarked
+ * on the host against GfxMemorySurface (tools/thermalbench).
+ */
+
+// Output pixels per panel write (band buffer: 2 bytes each)
+// Can be overridden via build flags: -DPOCKETOS_THERMAL_BAND_PIXELS=4096
+#ifndef POCKETOS_THERMAL_BAND_PIXELS
+#define POCKETOS_THERMAL_BAND_PIXELS 2048
+#endif
+
+// Smallest auto-range span, 0.01 degC (keeps sensor noise from filling the palette)
+#ifndef POCKETOS_THERMAL_MIN_SPAN
+#define POCKETOS_THERMAL_MIN_SPAN 200
+#endif
+
+// Widest output row (scale * 32)
+#define THERMAL_MAX_WIDTH 320
+#define THERMAL_MAX_SCALE (THERMAL_MAX_WIDTH / MLX90640_COLUMNS)
+
+enum ThermalPalette {
+    THERMAL_PALETTE_IRON = 0,
+    THERMAL_PALETTE_RAINBOW = 1,
+    THERMAL_PALETTE_GREY = 2
+};
+
+class ThermalView {
+public:
+    ThermalView();
+    ~ThermalView();
+
+    void setPalette(ThermalPalette palette);
+    ThermalPalette palette() const { return palette_; }
+    const uint16_t* lut() const { return lut_; }
+
+    // Fixed range in 0.01 degC (disables auto-range)
+    bool setRange(int16_t lo, int16_t hi);
+    void setAutoRange(bool enabled);
+    bool autoRange() const { return auto_; }
+    int16_t rangeMin() const { return min_; }
+    int16_t rangeMax() const { return max_; }
+
+    // Largest integer scale that fits a w x h area (0 if none)
+    static uint8_t fitScale(uint16_t w, uint16_t h);
+
+    // Draw image upscaled by scale (1..THERMAL_MAX_SCALE) with its top-left
+    // corner at (x, y); the result must fit on the panel. Allocates the band
+    // buffer on first use. False on bad arguments or out of memory.
+    bool render(const int16_t* image, IGfxPanel& panel, uint16_t x, uint16_t y, uint8_t scale);
+
+    // Panel writes issued by the last render()
+    uint16_t lastBands() const { return lastBands_; }
+
+    void end();
+
+private:
+    ThermalPalette palette_;
+    uint16_t lut_[256];
+
+    bool auto_;
+    bool haveRange_;
+    int16_t min_;
+    int16_t max_;
+
+    // Palette level per source pixel, Q8 (0 .. 255 << 8)
+    uint16_t level_[MLX90640_PIXELS];
+
+    // Horizontal interpolation table for tableScale_
+    uint8_t tableScale_;
+    uint8_t xIndex_[THERMAL_MAX_WIDTH];
+    uint16_t xWeight_[THERMAL_MAX_WIDTH];   // 0..256
+
+    uint16_t* band_;
+    size_t bandSize_;
+    uint16_t lastBands_;
+
+    void updateRange(const int16_t* image);
+    void computeLevels(const int16_t* image);
+    void buildTable(uint8_t scale);
+};
+
+// Sample axis for a scale: output position o maps to source cell index
+// (clamped to n - 2) and weight 0..256 towards index + 1
+void thermalAxis(uint16_t o, uint8_t scale, uint8_t n, uint8_t* index, uint16_t* weight);
+
+// Synthetic 32x24 scene (0.01 degC): warm background with a hot spot that
+// moves with phase. Used by the host and target benchmarks.
+void thermalTestImage(int16_t* image, uint16_t phase);
+
+} // namespace PocketOS
+
+#endif // POCKETOS_THERMAL_VIEW_H
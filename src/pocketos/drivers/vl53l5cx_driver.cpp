@@ -1,3 +1,7 @@
+#ifdef POCKETOS_VL53L5CX_BUFFERS_HEADER
+#include POCKETOS_VL53L5CX_BUFFERS_HEADER
+#endif
+
 #include "vl53l5cx_driver.h"
 #include "../driver_config.h"
 
@@ -9,70 +13,827 @@
 
 namespace PocketOS {
 
-#define VL53L5CX_REG_CONTROL    0x00
-#define VL53L5CX_REG_STATUS     0x01
+// Byte registers (page selected through VL53L5CX_REG_PAGE)
+#define VL53L5CX_REG_PAGE        0x7FFF
+#define VL53L5CX_REG_GO2_STATUS0 0x0006
+#define VL53L5CX_REG_GO2_STATUS1 0x0007
+
+// Host interface of the sensor MCU (page 2)
+#define VL53L5CX_UI_STATUS       0x2C00
+#define VL53L5CX_UI_START        0x2C04
+#define VL53L5CX_UI_END          0x2FFF
+#define VL53L5CX_UI_CONFIG       0x2C34
+#define VL53L5CX_UI_XTALK        0x2CF8
+#define VL53L5CX_UI_OFFSET       0x2E18
+#define VL53L5CX_UI_NVM_CMD      0x2FD8
+#define VL53L5CX_UI_AUTO_STOP    0x2FFC
+
+// Firmware parameter blocks (DCI)
+#define VL53L5CX_PARAM_RESULT_INFO    0x5440
+#define VL53L5CX_PARAM_ZONE_CONFIG    0x5450
+#define VL53L5CX_PARAM_FREQ_HZ        0x5458
+#define VL53L5CX_PARAM_RANGING_MODE   0xAD30
+#define VL53L5CX_PARAM_DSS_CONFIG     0xAD38
+#define VL53L5CX_PARAM_SINGLE_RANGE   0xD964
+#define VL53L5CX_PARAM_OUTPUT_CONFIG  0xD968
+#define VL53L5CX_PARAM_OUTPUT_ENABLES 0xD970
+#define VL53L5CX_PARAM_OUTPUT_LIST    0xD980
+#define VL53L5CX_PARAM_PIPE_CONTROL   0xDB80
+#define VL53L5CX_PARAM_SAFETY         0xE0C4
+
+#define VL53L5CX_FW_SIZE         0x15000   // Three pages: 32 KB, 32 KB, 20 KB
+#define VL53L5CX_FW_PAGE_SIZE    0x8000
+#define VL53L5CX_OFFSET_SIZE     488
+#define VL53L5CX_XTALK_SIZE      776
+#define VL53L5CX_NVM_SIZE        492
+#define VL53L5CX_WORK_SIZE       VL53L5CX_XTALK_SIZE   // Largest transfer
+
+#define VL53L5CX_WRITE_CHUNK     (POCKETOS_VL53L5CX_I2C_BUFFER - 2)
+
+// Possible outputs (block headers) and the ones enabled: start, metadata
+// and common data are mandatory; then targets per zone, distance, status
+static const uint32_t VL53L5CX_OUTPUTS[12] = {
+    0x0000000D, 0x54B400C0, 0x54C00040, 0x54D00104, 0x55D00404, 0xCF7C0401,
+    0xCFBC0404, 0xD2BC0402, 0xD33C0402, 0xD43C0401, 0xD47C0401, 0xCC5008C0
+};
+#define VL53L5CX_OUTPUT_ENABLES  0x00000527
 
 #if POCKETOS_VL53L5CX_ENABLE_REGISTER_ACCESS
 static const RegisterDesc VL53L5CX_REGISTERS[] = {
-    RegisterDesc(0x00, "CONTROL", 1, RegisterAccess::RW, 0x00),
-    RegisterDesc(0x01, "STATUS", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x0006, "GO2_STATUS0", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x0007, "GO2_STATUS1", 1, RegisterAccess::RO, 0x00),
+    RegisterDesc(0x7FFF, "PAGE", 1, RegisterAccess::RW, 0x00),
 };
 
 #define VL53L5CX_REGISTER_COUNT (sizeof(VL53L5CX_REGISTERS) / sizeof(RegisterDesc))
 #endif
 
-VL53L5CXDriver::VL53L5CXDriver() : address(0), initialized(false) {}
+// The MCU sends and expects 32-bit words most significant byte first;
+// DCI data and calibration blocks are laid out in host (little-endian)
+// order. Byte b of the host-order stream is raw[b ^ 3].
+static inline uint32_t getStream32(const uint8_t* raw, size_t off) {
+    return ((uint32_t)raw[off] << 24) | ((uint32_t)raw[off + 1] << 16) |
+           ((uint32_t)raw[off + 2] << 8) | raw[off + 3];
+}
+
+static inline void putStream32(uint8_t* raw, size_t off, uint32_t v) {
+    raw[off] = (uint8_t)(v >> 24);
+    raw[off + 1] = (uint8_t)(v >> 16);
+    raw[off + 2] = (uint8_t)(v >> 8);
+    raw[off + 3] = (uint8_t)v;
+}
+
+static inline int16_t getStream16(const uint8_t* raw, size_t off) {
+    return (int16_t)(raw[off ^ 3] | (raw[(off + 1) ^ 3] << 8));
+}
+
+static inline void putStream16(uint8_t* raw, size_t off, int16_t v) {
+    raw[off ^ 3] = (uint8_t)(v & 0xFF);
+    raw[(off + 1) ^ 3] = (uint8_t)((uint16_t)v >> 8);
+}
+
+static inline void putLE32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+VL53L5CXDriver::VL53L5CXDriver()
+    : address(0), initialized(false), ranging(false), zoneCount(16), frequencyHz(1),
+      resultSize(0), streamCount(255), work(nullptr), offsetData(nullptr)
+#if POCKETOS_VL53L5CX_ENABLE_BASIC_READ
+    , frames(0), busError(false)
+#endif
+{
+#ifdef POCKETOS_VL53L5CX_BUFFERS_HEADER
+    fw.firmware = VL53L5CX_FIRMWARE;
+    fw.firmwareSize = sizeof(VL53L5CX_FIRMWARE);
+    fw.configuration = VL53L5CX_DEFAULT_CONFIGURATION;
+    fw.configurationSize = sizeof(VL53L5CX_DEFAULT_CONFIGURATION);
+    fw.xtalk = VL53L5CX_DEFAULT_XTALK;
+    fw.nvmCommand = VL53L5CX_GET_NVM_CMD;
+    fw.nvmCommandSize = sizeof(VL53L5CX_GET_NVM_CMD);
+#endif
+#if POCKETOS_VL53L5CX_ENABLE_BASIC_READ
+    memset(&frame, 0, sizeof(frame));
+#endif
+}
+
+VL53L5CXDriver::~VL53L5CXDriver() {
+    deinit();
+}
 
 bool VL53L5CXDriver::init(uint8_t i2cAddress) {
     address = i2cAddress;
-    
+
 #if POCKETOS_VL53L5CX_ENABLE_LOGGING
-    Logger::info("VL53L5CX: Initializing at address 0x" + String(address, HEX));
+    Logger::info(("VL53L5CX: Initializing at address 0x" + String(address, HEX)).c_str());
 #endif
-    
-#if POCKETOS_VL53L5CX_ENABLE_CONFIGURATION
-    writeRegister(VL53L5CX_REG_CONTROL, 0x00);
+
+    if (!fw.firmware || fw.firmwareSize != VL53L5CX_FW_SIZE || !fw.configuration ||
+        !fw.xtalk || !fw.nvmCommand) {
+#if POCKETOS_VL53L5CX_ENABLE_LOGGING
+        Logger::error("VL53L5CX: No firmware image (see POCKETOS_VL53L5CX_BUFFERS_HEADER)");
 #endif
-    
+        return false;
+    }
+
+    if (!work) {
+        work = (uint8_t*)malloc(VL53L5CX_WORK_SIZE + VL53L5CX_OFFSET_SIZE);
+        if (!work) {
+#if POCKETOS_VL53L5CX_ENABLE_LOGGING
+            Logger::error("VL53L5CX: Out of memory");
+#endif
+            return false;
+        }
+        offsetData = work + VL53L5CX_WORK_SIZE;
+    }
+
+    unsigned long start = millis();
+    if (!bootAndUpload()) {
+#if POCKETOS_VL53L5CX_ENABLE_LOGGING
+        Logger::error("VL53L5CX: Firmware upload failed");
+#endif
+        deinit();
+        return false;
+    }
+
+    uint8_t zones = POCKETOS_VL53L5CX_DEFAULT_ZONES == 16 ? 16 : 64;
+    uint8_t hz = POCKETOS_VL53L5CX_DEFAULT_FREQ_HZ;
+    if (hz > (zones == 16 ? 60 : 15)) {
+        hz = zones == 16 ? 60 : 15;
+    }
+    if (!applyResolution(zones) || !applyContinuousMode() || !applyFrequency(hz) || !startRanging()) {
+#if POCKETOS_VL53L5CX_ENABLE_LOGGING
+        Logger::error("VL53L5CX: Failed to start ranging");
+#endif
+        deinit();
+        return false;
+    }
+
     initialized = true;
 #if POCKETOS_VL53L5CX_ENABLE_LOGGING
-    Logger::info("VL53L5CX: Initialized successfully");
+    Logger::info(("VL53L5CX: Initialized successfully (" + String(millis() - start) + " ms, " +
+                  String(zones == 16 ? "4x4" : "8x8") + " @ " + String(hz) + " Hz)").c_str());
 #endif
     return true;
 }
 
 void VL53L5CXDriver::deinit() {
+    if (ranging) {
+        stopRanging();
+    }
+    free(work);
+    work = nullptr;
+    offsetData = nullptr;
     initialized = false;
 }
 
+bool VL53L5CXDriver::bootAndUpload() {
+    uint8_t tmp;
+    bool ok = true;
+
+    // Software reboot
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x00);
+    ok &= writeByte(0x0009, 0x04);
+    ok &= writeByte(0x000F, 0x40);
+    ok &= writeByte(0x000A, 0x03);
+    ok &= readByte(VL53L5CX_REG_PAGE, &tmp);
+    ok &= writeByte(0x000C, 0x01);
+
+    ok &= writeByte(0x0101, 0x00);
+    ok &= writeByte(0x0102, 0x00);
+    ok &= writeByte(0x010A, 0x01);
+    ok &= writeByte(0x4002, 0x01);
+    ok &= writeByte(0x4002, 0x00);
+    ok &= writeByte(0x010A, 0x03);
+    ok &= writeByte(0x0103, 0x01);
+    ok &= writeByte(0x000C, 0x00);
+    ok &= writeByte(0x000F, 0x43);
+    delay(1);
+
+    ok &= writeByte(0x000F, 0x40);
+    ok &= writeByte(0x000A, 0x01);
+    delay(100);
+    if (!ok) {
+        return false;
+    }
+
+    // Wait for the sensor to boot
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x00);
+    ok &= pollForAnswer(1, 0, VL53L5CX_REG_GO2_STATUS0, 0xFF, 1);
+    ok &= writeByte(0x000E, 0x01);
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x02);
+
+    // Enable firmware access
+    ok &= writeByte(0x0003, 0x0D);
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x01);
+    ok &= pollForAnswer(1, 0, 0x0021, 0x10, 0x10);
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x00);
+
+    // Host access to GO1, power on
+    ok &= readByte(VL53L5CX_REG_PAGE, &tmp);
+    ok &= writeByte(0x000C, 0x01);
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x00);
+    ok &= writeByte(0x0101, 0x00);
+    ok &= writeByte(0x0102, 0x00);
+    ok &= writeByte(0x010A, 0x01);
+    ok &= writeByte(0x4002, 0x01);
+    ok &= writeByte(0x4002, 0x00);
+    ok &= writeByte(0x010A, 0x03);
+    ok &= writeByte(0x0103, 0x01);
+    ok &= writeByte(0x400F, 0x00);
+    ok &= writeByte(0x021A, 0x43);
+    ok &= writeByte(0x021A, 0x03);
+    ok &= writeByte(0x021A, 0x01);
+    ok &= writeByte(0x021A, 0x00);
+    ok &= writeByte(0x0219, 0x00);
+    ok &= writeByte(0x021B, 0x00);
+
+    // Wake up the MCU
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x00);
+    ok &= readByte(VL53L5CX_REG_PAGE, &tmp);
+    ok &= writeByte(0x000C, 0x00);
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x01);
+    ok &= writeByte(0x0020, 0x07);
+    ok &= writeByte(0x0020, 0x06);
+    if (!ok) {
+        return false;
+    }
+
+    // Firmware: pages 9, 10, 11 from address 0
+    for (uint8_t page = 0; page < 3; page++) {
+        size_t offset = (size_t)page * VL53L5CX_FW_PAGE_SIZE;
+        size_t len = fw.firmwareSize - offset;
+        if (len > VL53L5CX_FW_PAGE_SIZE) {
+            len = VL53L5CX_FW_PAGE_SIZE;
+        }
+        if (!writeByte(VL53L5CX_REG_PAGE, (uint8_t)(0x09 + page)) ||
+            !writeMulti(0x0000, fw.firmware + offset, len)) {
+            return false;
+        }
+    }
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x01);
+
+    // Check the download
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x02);
+    ok &= writeByte(0x0003, 0x0D);
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x01);
+    ok &= pollForAnswer(1, 0, 0x0021, 0x10, 0x10);
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x00);
+    ok &= readByte(VL53L5CX_REG_PAGE, &tmp);
+    ok &= writeByte(0x000C, 0x01);
+
+    // Reset the MCU and wait for it to boot the firmware
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x00);
+    ok &= writeByte(0x0114, 0x00);
+    ok &= writeByte(0x0115, 0x00);
+    ok &= writeByte(0x0116, 0x42);
+    ok &= writeByte(0x0117, 0x00);
+    ok &= writeByte(0x000B, 0x00);
+    ok &= readByte(VL53L5CX_REG_PAGE, &tmp);
+    ok &= writeByte(0x000C, 0x00);
+    ok &= writeByte(0x000B, 0x01);
+    ok &= pollForMcuBoot();
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x02);
+    if (!ok) {
+        return false;
+    }
+
+    // Offset calibration from NVM
+    if (!writeMulti(VL53L5CX_UI_NVM_CMD, fw.nvmCommand, fw.nvmCommandSize) ||
+        !pollForAnswer(4, 0, VL53L5CX_UI_STATUS, 0xFF, 2) ||
+        !readMulti(VL53L5CX_UI_START, work, VL53L5CX_NVM_SIZE)) {
+        return false;
+    }
+    memcpy(offsetData, work, VL53L5CX_OFFSET_SIZE);
+    if (!sendOffsetData(16) || !sendXtalkData(16)) {
+        return false;
+    }
+
+    // Default tuning, then single target per zone
+    if (!writeMulti(VL53L5CX_UI_CONFIG, fw.configuration, fw.configurationSize) ||
+        !pollForAnswer(4, 1, VL53L5CX_UI_STATUS, 0xFF, 0x03)) {
+        return false;
+    }
+    const uint8_t pipeControl[4] = { 1, 0x00, 0x01, 0x00 };
+    uint8_t singleRange[4];
+    putLE32(singleRange, 1);
+    return dciWrite(VL53L5CX_PARAM_PIPE_CONTROL, pipeControl, 4) &&
+           dciWrite(VL53L5CX_PARAM_SINGLE_RANGE, singleRange, 4);
+}
+
+bool VL53L5CXDriver::sendOffsetData(uint8_t zones) {
+    static const uint8_t dss4x4[8] = { 0x0F, 0x04, 0x04, 0x00, 0x08, 0x10, 0x10, 0x07 };
+    static const uint8_t footer[8] = { 0x00, 0x00, 0x00, 0x0F, 0x03, 0x01, 0x01, 0xE4 };
+
+    memcpy(work, offsetData, VL53L5CX_OFFSET_SIZE);
+
+    if (zones == 16) {
+        // 4x4 offsets: each zone is the mean of its 2x2 block of 8x8 zones
+        memcpy(work + 0x10, dss4x4, sizeof(dss4x4));
+        uint32_t signal[64];
+        int16_t range[64];
+        for (uint8_t i = 0; i < 64; i++) {
+            signal[i] = getStream32(work, 0x3C + 4 * i);
+            range[i] = getStream16(work, 0x140 + 2 * i);
+        }
+        for (uint8_t j = 0; j < 4; j++) {
+            for (uint8_t i = 0; i < 4; i++) {
+                uint8_t s = (uint8_t)(2 * i + 16 * j);
+                signal[i + 4 * j] = (signal[s] + signal[s + 1] + signal[s + 8] + signal[s + 9]) / 4;
+                range[i + 4 * j] = (int16_t)((range[s] + range[s + 1] + range[s + 8] + range[s + 9]) / 4);
+            }
+        }
+        for (uint8_t i = 0; i < 64; i++) {
+            putStream32(work, 0x3C + 4 * i, i < 16 ? signal[i] : 0);
+            putStream16(work, 0x140 + 2 * i, i < 16 ? range[i] : 0);
+        }
+    }
+
+    memmove(work, work + 8, VL53L5CX_OFFSET_SIZE - 8);
+    memcpy(work + 0x1E0, footer, sizeof(footer));
+    return writeMulti(VL53L5CX_UI_OFFSET, work, VL53L5CX_OFFSET_SIZE) &&
+           pollForAnswer(4, 1, VL53L5CX_UI_STATUS, 0xFF, 0x03);
+}
+
+bool VL53L5CXDriver::sendXtalkData(uint8_t zones) {
+    static const uint8_t res4x4[8] = { 0x0F, 0x04, 0x04, 0x17, 0x08, 0x10, 0x10, 0x07 };
+    static const uint8_t dss4x4[8] = { 0x00, 0x78, 0x00, 0x08, 0x00, 0x00, 0x00, 0x08 };
+    static const uint8_t profile4x4[4] = { 0xA0, 0xFC, 0x01, 0x00 };
+
+    memcpy(work, fw.xtalk, VL53L5CX_XTALK_SIZE);
+
+    if (zones == 16) {
+        memcpy(work + 0x08, res4x4, sizeof(res4x4));
+        memcpy(work + 0x20, dss4x4, sizeof(dss4x4));
+        uint32_t signal[64];
+        for (uint8_t i = 0; i < 64; i++) {
+            signal[i] = getStream32(work, 0x34 + 4 * i);
+        }
+        for (uint8_t j = 0; j < 4; j++) {
+            for (uint8_t i = 0; i < 4; i++) {
+                uint8_t s = (uint8_t)(2 * i + 16 * j);
+                signal[i + 4 * j] = (signal[s] + signal[s + 1] + signal[s + 8] + signal[s + 9]) / 4;
+            }
+        }
+        for (uint8_t i = 0; i < 64; i++) {
+            putStream32(work, 0x34 + 4 * i, i < 16 ? signal[i] : 0);
+        }
+        memcpy(work + 0x134, profile4x4, sizeof(profile4x4));
+        memset(work + 0x78, 0, 4);
+    }
+
+    return writeMulti(VL53L5CX_UI_XTALK, work, VL53L5CX_XTALK_SIZE) &&
+           pollForAnswer(4, 1, VL53L5CX_UI_STATUS, 0xFF, 0x03);
+}
+
+bool VL53L5CXDriver::applyResolution(uint8_t zones) {
+    uint8_t dss[16];
+    uint8_t zoneConfig[8];
+    bool small = zones == 16;
+
+    if (!dciRead(VL53L5CX_PARAM_DSS_CONFIG, dss, sizeof(dss))) {
+        return false;
+    }
+    dss[0x04] = small ? 64 : 16;
+    dss[0x06] = small ? 64 : 16;
+    dss[0x09] = small ? 4 : 1;
+    if (!dciWrite(VL53L5CX_PARAM_DSS_CONFIG, dss, sizeof(dss)) ||
+        !dciRead(VL53L5CX_PARAM_ZONE_CONFIG, zoneConfig, sizeof(zoneConfig))) {
+        return false;
+    }
+    zoneConfig[0x00] = small ? 4 : 8;
+    zoneConfig[0x01] = small ? 4 : 8;
+    zoneConfig[0x04] = small ? 8 : 4;
+    zoneConfig[0x05] = small ? 8 : 4;
+    if (!dciWrite(VL53L5CX_PARAM_ZONE_CONFIG, zoneConfig, sizeof(zoneConfig)) ||
+        !sendOffsetData(zones) || !sendXtalkData(zones)) {
+        return false;
+    }
+    zoneCount = zones;
+    return true;
+}
+
+bool VL53L5CXDriver::applyFrequency(uint8_t hz) {
+    if (!dciReplace(VL53L5CX_PARAM_FREQ_HZ, 4, &hz, 1, 1)) {
+        return false;
+    }
+    frequencyHz = hz;
+    return true;
+}
+
+bool VL53L5CXDriver::applyContinuousMode() {
+    uint8_t mode[8];
+    uint8_t singleRange[4];
+    if (!dciRead(VL53L5CX_PARAM_RANGING_MODE, mode, sizeof(mode))) {
+        return false;
+    }
+    mode[0x01] = 0x01;
+    mode[0x03] = 0x03;
+    putLE32(singleRange, 0);
+    return dciWrite(VL53L5CX_PARAM_RANGING_MODE, mode, sizeof(mode)) &&
+           dciWrite(VL53L5CX_PARAM_SINGLE_RANGE, singleRange, sizeof(singleRange));
+}
+
+bool VL53L5CXDriver::startRanging() {
+    uint8_t list[sizeof(VL53L5CX_OUTPUTS)];
+    uint32_t size = 0;
+
+    // Size the enabled blocks for the resolution; the result is
+    // their headers and payloads plus the stream header and footer
+    for (uint8_t i = 0; i < 12; i++) {
+        uint32_t bh = VL53L5CX_OUTPUTS[i];
+        if (VL53L5CX_OUTPUT_ENABLES & (1UL << i)) {
+            uint8_t type = (uint8_t)(bh & 0x0F);
+            if (type >= 0x1 && type < 0xD) {
+                bh = (bh & ~0x0000FFF0UL) | ((uint32_t)zoneCount << 4);
+                size += (uint32_t)type * zoneCount;
+            } else {
+                size += (bh >> 4) & 0x0FFF;
+            }
+            size += 4;
+        }
+        putLE32(list + 4 * i, bh);
+    }
+    size += 24;
+    if (size > VL53L5CX_WORK_SIZE) {
+        return false;
+    }
+
+    uint8_t config[8];
+    uint8_t enables[16];
+    putLE32(config, size);
+    putLE32(config + 4, 13);
+    putLE32(enables, VL53L5CX_OUTPUT_ENABLES);
+    putLE32(enables + 4, 0);
+    putLE32(enables + 8, 0);
+    putLE32(enables + 12, 0xC0000000UL);
+
+    if (!dciWrite(VL53L5CX_PARAM_OUTPUT_LIST, list, sizeof(list)) ||
+        !dciWrite(VL53L5CX_PARAM_OUTPUT_CONFIG, config, sizeof(config)) ||
+        !dciWrite(VL53L5CX_PARAM_OUTPUT_ENABLES, enables, sizeof(enables))) {
+        return false;
+    }
+
+    // Interrupt mode (xshut bypass), then the start command
+    static const uint8_t startCmd[4] = { 0x00, 0x03, 0x00, 0x00 };
+    if (!writeByte(VL53L5CX_REG_PAGE, 0x00) || !writeByte(0x0009, 0x05) ||
+        !writeByte(VL53L5CX_REG_PAGE, 0x02) ||
+        !writeMulti(VL53L5CX_UI_END - 3, startCmd, sizeof(startCmd)) ||
+        !pollForAnswer(4, 1, VL53L5CX_UI_STATUS, 0xFF, 0x03)) {
+        return false;
+    }
+
+    // The firmware must agree on the result size, and report no laser fault
+    uint8_t info[12];
+    uint8_t safety[8];
+    if (!dciRead(VL53L5CX_PARAM_RESULT_INFO, info, sizeof(info)) ||
+        !dciRead(VL53L5CX_PARAM_SAFETY, safety, sizeof(safety))) {
+        return false;
+    }
+    uint32_t reported = info[8] | ((uint32_t)info[9] << 8) | ((uint32_t)info[10] << 16) |
+                        ((uint32_t)info[11] << 24);
+    if (reported != size || safety[6] != 0) {
+        return false;
+    }
+
+    resultSize = (uint16_t)size;
+    streamCount = 255;
+    ranging = true;
+    return true;
+}
+
+bool VL53L5CXDriver::stopRanging() {
+    uint8_t flag[4];
+    uint8_t tmp = 0;
+    bool ok = readMulti(VL53L5CX_UI_AUTO_STOP, flag, sizeof(flag));
+    uint32_t autoStop = flag[0] | ((uint32_t)flag[1] << 8) | ((uint32_t)flag[2] << 16) |
+                        ((uint32_t)flag[3] << 24);
+
+    if (ok && autoStop != 0x4FF) {
+        // Stop the MCU and wait for it (up to 5 s)
+        ok &= writeByte(VL53L5CX_REG_PAGE, 0x00);
+        ok &= writeByte(0x0015, 0x16);
+        ok &= writeByte(0x0014, 0x01);
+        for (uint16_t timeout = 0; ok && !(tmp & 0x80); timeout++) {
+            if (timeout > 500) {
+                ok = false;
+                break;
+            }
+            ok &= readByte(VL53L5CX_REG_GO2_STATUS0, &tmp);
+            delay(10);
+        }
+    }
+
+    if (ok && readByte(VL53L5CX_REG_GO2_STATUS0, &tmp) && (tmp & 0x80)) {
+        ok &= readByte(VL53L5CX_REG_GO2_STATUS1, &tmp);
+        ok &= (tmp == 0x84 || tmp == 0x85);
+    }
+
+    // Undo the MCU stop and the xshut bypass
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x00);
+    ok &= writeByte(0x0014, 0x00);
+    ok &= writeByte(0x0015, 0x00);
+    ok &= writeByte(0x0009, 0x04);
+    ok &= writeByte(VL53L5CX_REG_PAGE, 0x02);
+
+    ranging = false;
+    return ok;
+}
+
+#if POCKETOS_VL53L5CX_ENABLE_BASIC_READ
+bool VL53L5CXDriver::pollFrame(VL53L5CXFrame& out) {
+    busError = false;
+    if (!initialized || !ranging) {
+        return false;
+    }
+
+    uint8_t head[4];
+    if (!readMulti(0x0000, head, sizeof(head))) {
+        busError = true;
+        return false;
+    }
+    bool ready = head[0] != streamCount && head[0] != 255 && head[1] == 0x05 &&
+                 (head[2] & 0x05) == 0x05 && (head[3] & 0x10) == 0x10;
+    if (!ready) {
+        if (head[3] & 0x80) {
+            busError = true;   // GO2 error reported by the MCU
+        }
+        return false;
+    }
+
+    if (!readMulti(0x0000, work, resultSize)) {
+        busError = true;
+        return false;
+    }
+    streamCount = work[0];
+    if (!vl53l5cxParseResults(work, resultSize, zoneCount, out)) {
+        busError = true;
+        return false;
+    }
+    return true;
+}
+
+VL53L5CXData VL53L5CXDriver::readData() {
+    VL53L5CXData data;
+    if (!initialized) {
+        return data;
+    }
+
+    if (pollFrame(frame)) {
+        frames++;
+    }
+    if (busError || frames == 0) {
+        return data;
+    }
+
+    uint16_t nearest = 0;
+    for (uint8_t z = 0; z < frame.zoneCount; z++) {
+        if (frame.isValid(z) && (nearest == 0 || frame.zones[z].distanceMm < nearest)) {
+            nearest = frame.zones[z].distanceMm;
+        }
+    }
+    data.distance_mm = nearest;
+    data.validZones = frame.validZones;
+    data.zoneCount = frame.zoneCount;
+    data.valid = true;
+    return data;
+}
+#endif
+
+#if POCKETOS_VL53L5CX_ENABLE_CONFIGURATION
+bool VL53L5CXDriver::setResolution(uint8_t zones) {
+    if (!initialized || (zones != 16 && zones != 64)) {
+        return false;
+    }
+    uint8_t hz = frequencyHz;
+    if (zones == 64 && hz > 15) {
+        hz = 15;
+    }
+    bool ok = stopRanging() && applyResolution(zones) && applyFrequency(hz) && startRanging();
+#if POCKETOS_VL53L5CX_ENABLE_LOGGING
+    if (!ok) {
+        Logger::error("VL53L5CX: Failed to change resolution");
+    }
+#endif
+    return ok;
+}
+
+bool VL53L5CXDriver::setFrequency(uint8_t hz) {
+    if (!initialized || hz == 0 || hz > (zoneCount == 16 ? 60 : 15)) {
+        return false;
+    }
+    return stopRanging() && applyFrequency(hz) && startRanging();
+}
+
+String VL53L5CXDriver::getParameter(const String& name) {
+    if (name == "resolution") {
+        return zoneCount == 16 ? "4x4" : "8x8";
+    } else if (name == "frequency_hz") {
+        return String(frequencyHz);
+    }
+#if POCKETOS_VL53L5CX_ENABLE_BASIC_READ
+    if (name == "frames") {
+        return String(frames);
+    } else if (name == "valid_zones") {
+        return String(frame.validZones);
+    } else if (name == "silicon_temp") {
+        return String(frame.siliconTempC);
+    } else if (name == "zones" || name == "zone_status") {
+        // Depth map as hex: 4 digits (mm) or 2 digits (status) per zone, row-major
+        static const char hex[] = "0123456789ABCDEF";
+        bool distances = name == "zones";
+        String out;
+        out.reserve(frame.zoneCount * (distances ? 4 : 2));
+        for (uint8_t z = 0; z < frame.zoneCount; z++) {
+            uint16_t v = distances ? frame.zones[z].distanceMm : frame.zones[z].status;
+            if (distances) {
+                out += hex[(v >> 12) & 0x0F];
+                out += hex[(v >> 8) & 0x0F];
+            }
+            out += hex[(v >> 4) & 0x0F];
+            out += hex[v & 0x0F];
+        }
+        return out;
+    }
+#endif
+    return "";
+}
+
+bool VL53L5CXDriver::setParameter(const String& name, const String& value) {
+    if (name == "resolution") {
+        if (value == "4x4" || value == "16") return setResolution(16);
+        if (value == "8x8" || value == "64") return setResolution(64);
+        return false;
+    } else if (name == "frequency_hz") {
+        long hz = value.toInt();
+        return hz > 0 && hz <= 60 && setFrequency((uint8_t)hz);
+    }
+    return false;
+}
+#endif
+
 CapabilitySchema VL53L5CXDriver::getSchema() const {
     CapabilitySchema schema;
-    schema.tier = POCKETOS_VL53L5CX_TIER_NAME;
+
+#if POCKETOS_VL53L5CX_ENABLE_BASIC_READ
+    schema.addSignal("distance_mm", ParamType::INT, false, "mm");
+    schema.addSignal("valid_zones", ParamType::INT, false, "");
+    schema.addSignal("zones", ParamType::BLOB, false, "mm");
+    schema.addSignal("zone_status", ParamType::BLOB, false, "");
+    schema.addSignal("frames", ParamType::COUNTER, false, "");
+#endif
+#if POCKETOS_VL53L5CX_ENABLE_CONFIGURATION
+    schema.addSetting("resolution", ParamType::ENUM, true, 0, 0, 0, "4x4,8x8");
+    schema.addSetting("frequency_hz", ParamType::INT, true, 1, 60, 1, "Hz");
+#endif
+
     return schema;
 }
 
-bool VL53L5CXDriver::writeRegister(uint8_t reg, uint8_t value) {
-    Wire.beginTransmission(address);
-    Wire.write(reg);
-    Wire.write(value);
-    return Wire.endTransmission() == 0;
+bool VL53L5CXDriver::dciRead(uint16_t index, uint8_t* data, uint16_t size) {
+    if (size + 12 > VL53L5CX_WORK_SIZE) {
+        return false;
+    }
+    const uint8_t cmd[12] = {
+        (uint8_t)(index >> 8), (uint8_t)(index & 0xFF),
+        (uint8_t)((size & 0xFF0) >> 4), (uint8_t)((size & 0x0F) << 4),
+        0x00, 0x00, 0x00, 0x0F, 0x00, 0x02, 0x00, 0x08
+    };
+    if (!writeMulti(VL53L5CX_UI_END - 11, cmd, sizeof(cmd)) ||
+        !pollForAnswer(4, 1, VL53L5CX_UI_STATUS, 0xFF, 0x03) ||
+        !readMulti(VL53L5CX_UI_START, work, size + 12)) {
+        return false;
+    }
+    // Skip the 4-byte header, convert to host order
+    for (uint16_t k = 0; k < size; k++) {
+        data[k] = work[(4 + k) ^ 3];
+    }
+    return true;
 }
 
-bool VL53L5CXDriver::readRegister(uint8_t reg, uint8_t* value) {
-    Wire.beginTransmission(address);
-    Wire.write(reg);
-    if (Wire.endTransmission() != 0) {
+bool VL53L5CXDriver::dciWrite(uint16_t index, const uint8_t* data, uint16_t size) {
+    if (size + 12 > VL53L5CX_WORK_SIZE || (size & 3) != 0) {
         return false;
     }
-    
-    Wire.requestFrom(address, (uint8_t)1);
-    if (Wire.available()) {
-        *value = Wire.read();
-        return true;
+    work[0] = (uint8_t)(index >> 8);
+    work[1] = (uint8_t)(index & 0xFF);
+    work[2] = (uint8_t)((size & 0xFF0) >> 4);
+    work[3] = (uint8_t)((size & 0x0F) << 4);
+    for (uint16_t k = 0; k < size; k++) {
+        work[4 + k] = data[k ^ 3];
+    }
+    const uint8_t footer[8] = {
+        0x00, 0x00, 0x00, 0x0F, 0x05, 0x01, (uint8_t)((size + 8) >> 8), (uint8_t)((size + 8) & 0xFF)
+    };
+    memcpy(work + 4 + size, footer, sizeof(footer));
+
+    return writeMulti((uint16_t)(VL53L5CX_UI_END - (size + 12) + 1), work, size + 12) &&
+           pollForAnswer(4, 1, VL53L5CX_UI_STATUS, 0xFF, 0x03);
+}
+
+bool VL53L5CXDriver::dciReplace(uint16_t index, uint16_t size, const uint8_t* value,
+                                uint16_t valueSize, uint16_t pos) {
+    uint8_t block[16];
+    if (size > sizeof(block) || pos + valueSize > size || !dciRead(index, block, size)) {
+        return false;
+    }
+    memcpy(block + pos, value, valueSize);
+    return dciWrite(index, block, size);
+}
+
+bool VL53L5CXDriver::pollForAnswer(uint8_t size, uint8_t pos, uint16_t reg, uint8_t mask, uint8_t expected) {
+    uint8_t buf[4];
+    // 2 s timeout
+    for (uint8_t tries = 0; tries < 200; tries++) {
+        if (!readMulti(reg, buf, size)) {
+            return false;
+        }
+        if (size >= 4 && buf[2] >= 0x7F) {
+            return false;   // MCU error
+        }
+        if ((buf[pos] & mask) == expected) {
+            return true;
+        }
+        delay(10);
     }
     return false;
 }
 
+bool VL53L5CXDriver::pollForMcuBoot() {
+    for (uint16_t timeout = 0; timeout < 500; timeout++) {
+        uint8_t status0;
+        uint8_t status1;
+        if (!readByte(VL53L5CX_REG_GO2_STATUS0, &status0)) {
+            return false;
+        }
+        if (status0 & 0x80) {
+            if (!readByte(VL53L5CX_REG_GO2_STATUS1, &status1)) {
+                return false;
+            }
+            if (status1 & 0x01) {
+                return true;
+            }
+        }
+        if (status0 & 0x01) {
+            return true;
+        }
+        delay(1);
+    }
+    return false;
+}
+
+bool VL53L5CXDriver::writeByte(uint16_t reg, uint8_t value) {
+    return writeMulti(reg, &value, 1);
+}
+
+bool VL53L5CXDriver::readByte(uint16_t reg, uint8_t* value) {
+    return readMulti(reg, value, 1);
+}
+
+bool VL53L5CXDriver::writeMulti(uint16_t reg, const uint8_t* data, size_t len) {
+    // Each write carries as much payload as the Wire buffer allows after
+    // the 16-bit address; the sensor auto-increments within the page
+    while (len > 0) {
+        size_t n = len > VL53L5CX_WRITE_CHUNK ? VL53L5CX_WRITE_CHUNK : len;
+        Wire.beginTransmission(address);
+        Wire.write((uint8_t)(reg >> 8));
+        Wire.write((uint8_t)(reg & 0xFF));
+        Wire.write(data, n);
+        if (Wire.endTransmission() != 0) {
+            return false;
+        }
+        reg += (uint16_t)n;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool VL53L5CXDriver::readMulti(uint16_t reg, uint8_t* data, size_t len) {
+    while (len > 0) {
+        uint8_t n = (uint8_t)(len > POCKETOS_VL53L5CX_I2C_BUFFER ? POCKETOS_VL53L5CX_I2C_BUFFER : len);
+        Wire.beginTransmission(address);
+        Wire.write((uint8_t)(reg >> 8));
+        Wire.write((uint8_t)(reg & 0xFF));
+        if (Wire.endTransmission(false) != 0) {
+            return false;
+        }
+        if (Wire.requestFrom(address, n) != n) {
+            return false;
+        }
+        for (uint8_t i = 0; i < n; i++) {
+            data[i] = (uint8_t)Wire.read();
+        }
+        reg += n;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
 #if POCKETOS_VL53L5CX_ENABLE_REGISTER_ACCESS
 const RegisterDesc* VL53L5CXDriver::registers(size_t& count) const {
     count = VL53L5CX_REGISTER_COUNT;
@@ -80,29 +841,29 @@ const RegisterDesc* VL53L5CXDriver::registers(size_t& count) const {
 }
 
 bool VL53L5CXDriver::regRead(uint16_t reg, uint8_t* buf, size_t len) {
-    if (!initialized || reg > 0xFF || len != 1) {
+    if (!initialized || len != 1) {
         return false;
     }
-    
+
     const RegisterDesc* regDesc = RegisterUtils::findByAddr(VL53L5CX_REGISTERS, VL53L5CX_REGISTER_COUNT, reg);
     if (!regDesc || !RegisterUtils::isReadable(regDesc->access)) {
         return false;
     }
-    
-    return readRegister((uint8_t)reg, buf);
+
+    return readByte(reg, buf);
 }
 
 bool VL53L5CXDriver::regWrite(uint16_t reg, const uint8_t* buf, size_t len) {
-    if (!initialized || reg > 0xFF || len != 1) {
+    if (!initialized || len != 1) {
         return false;
     }
-    
+
     const RegisterDesc* regDesc = RegisterUtils::findByAddr(VL53L5CX_REGISTERS, VL53L5CX_REGISTER_COUNT, reg);
     if (!regDesc || !RegisterUtils::isWritable(regDesc->access)) {
         return false;
     }
-    
-    return writeRegister((uint8_t)reg, buf[0]);
+
+    return writeByte(reg, buf[0]);
 }
 
 const RegisterDesc* VL53L5CXDriver::findRegisterByName(const String& name) const {
@@ -5,39 +5,125 @@
 #include "../driver_config.h"
 #include "../core/capability_schema.h"
 #include "register_types.h"
+#include "vl53l5cx_results.h"
 
 namespace PocketOS {
 
 #define VL53L5CX_ADDR_COUNT 1
 const uint8_t VL53L5CX_VALID_ADDRESSES[VL53L5CX_ADDR_COUNT] = { 0x29 };
 
+// Wire buffer size: reads move this many bytes per transaction, writes
+// this many minus the 2 address bytes
+// Can be overridden via build flags: -DPOCKETOS_VL53L5CX_I2C_BUFFER=256
+#ifndef POCKETOS_VL53L5CX_I2C_BUFFER
+#define POCKETOS_VL53L5CX_I2C_BUFFER 128
+#endif
+
+// Resolution (16 or 64 zones) and ranging frequency set by init()
+#ifndef POCKETOS_VL53L5CX_DEFAULT_ZONES
+#define POCKETOS_VL53L5CX_DEFAULT_ZONES 64
+#endif
+#ifndef POCKETOS_VL53L5CX_DEFAULT_FREQ_HZ
+#define POCKETOS_VL53L5CX_DEFAULT_FREQ_HZ 15
+#endif
+
+#if POCKETOS_VL53L5CX_I2C_BUFFER < 32 || POCKETOS_VL53L5CX_I2C_BUFFER > 255
+#error "POCKETOS_VL53L5CX_I2C_BUFFER must be 32-255 bytes"
+#endif
+
+/**
+ * ST firmware and default tuning for the sensor's MCU, from ST's
+ * VL53L5CX ULD package (vl53l5cx_buffers.h, BSD-3-Clause). The sensor
+ * cannot range without them. Either build with
+ *   -DPOCKETOS_VL53L5CX_BUFFERS_HEADER='"vl53l5cx_buffers.h"'
+ * (the header on the include path) so init() finds them, or hand them to
+ * setFirmware() before init().
+ */
+struct VL53L5CXFirmware {
+    const uint8_t* firmware;        // VL53L5CX_FIRMWARE, 86016 bytes
+    size_t firmwareSize;
+    const uint8_t* configuration;   // VL53L5CX_DEFAULT_CONFIGURATION
+    size_t configurationSize;
+    const uint8_t* xtalk;           // VL53L5CX_DEFAULT_XTALK, 776 bytes
+    const uint8_t* nvmCommand;      // VL53L5CX_GET_NVM_CMD
+    size_t nvmCommandSize;
+
+    VL53L5CXFirmware()
+        : firmware(nullptr), firmwareSize(0), configuration(nullptr), configurationSize(0),
+          xtalk(nullptr), nvmCommand(nullptr), nvmCommandSize(0) {}
+};
+
+// Summary of the latest frame (zones via zones())
 struct VL53L5CXData {
-    uint16_t distance_mm;
+    uint16_t distance_mm;   // Nearest valid zone
+    uint8_t validZones;
+    uint8_t zoneCount;      // 16 or 64
     bool valid;
-    
-    VL53L5CXData() : distance_mm(0), valid(false) {}
+
+    VL53L5CXData() : distance_mm(0), validZones(0), zoneCount(0), valid(false) {}
 };
 
+/**
+ * VL53L5CX 4x4 / 8x8 Multizone Time-of-Flight Sensor
+ *
+ * init() boots the sensor MCU, uploads the firmware in maximal Wire
+ * writes (POCKETOS_VL53L5CX_I2C_BUFFER - 2 payload bytes after each
+ * 16-bit register address, never crossing a 32 KB firmware page),
+ * loads the NVM offset calibration and default tuning, and starts
+ * continuous ranging. Upload takes about 2 s at 400 kHz.
+ *
+ * Only the outputs the driver uses are enabled (metadata, targets per
+ * zone, distance, target status), so a result is 128 bytes at 4x4 and
+ * 320 bytes at 8x8. Results are parsed in place from the receive buffer
+ * (vl53l5cx_results.h) into a compact zone array.
+ *
+ *   pollFrame(frame) - non-blocking: true when a new frame was read
+ *   readData()       - registry polling into the driver's own frame
+ *
+ * Continuous mode runs at up to 60 Hz (4x4) or 15 Hz (8x8).
+ */
 class VL53L5CXDriver {
 public:
     VL53L5CXDriver();
-    
+    ~VL53L5CXDriver();
+
+    void setFirmware(const VL53L5CXFirmware& firmware) { fw = firmware; }
+
     bool init(uint8_t i2cAddress);
     void deinit();
     bool isInitialized() const { return initialized; }
-    
+
+#if POCKETOS_VL53L5CX_ENABLE_BASIC_READ
+    bool pollFrame(VL53L5CXFrame& frame);
+
     VL53L5CXData readData();
+    const VL53L5CXFrame& lastFrame() const { return frame; }
+    uint32_t frameCount() const { return frames; }
+#endif
+
+    uint8_t getZoneCount() const { return zoneCount; }
+    uint8_t getFrequency() const { return frequencyHz; }
+
+#if POCKETOS_VL53L5CX_ENABLE_CONFIGURATION
+    // Both stop ranging, reconfigure and restart
+    bool setResolution(uint8_t zones);
+    bool setFrequency(uint8_t hz);
+
+    String getParameter(const String& name);
+    bool setParameter(const String& name, const String& value);
+#endif
+
     CapabilitySchema getSchema() const;
-    
+
     uint8_t getAddress() const { return address; }
     String getDriverId() const { return "vl53l5cx"; }
     String getDriverTier() const { return POCKETOS_VL53L5CX_TIER_NAME; }
-    
+
     static const uint8_t* validAddresses(size_t& count) {
         count = VL53L5CX_ADDR_COUNT;
         return VL53L5CX_VALID_ADDRESSES;
     }
-    
+
     static bool supportsAddress(uint8_t addr) {
         for (size_t i = 0; i < VL53L5CX_ADDR_COUNT; i++) {
             if (VL53L5CX_VALID_ADDRESSES[i] == addr) {
@@ -46,20 +132,57 @@ public:
         }
         return false;
     }
-    
+
 #if POCKETOS_VL53L5CX_ENABLE_REGISTER_ACCESS
     const RegisterDesc* registers(size_t& count) const;
     bool regRead(uint16_t reg, uint8_t* buf, size_t len);
     bool regWrite(uint16_t reg, const uint8_t* buf, size_t len);
     const RegisterDesc* findRegisterByName(const String& name) const;
 #endif
-    
+
 private:
     uint8_t address;
     bool initialized;
-    
-    bool writeRegister(uint8_t reg, uint8_t value);
-    bool readRegister(uint8_t reg, uint8_t* value);
+    bool ranging;
+    VL53L5CXFirmware fw;
+
+    uint8_t zoneCount;
+    uint8_t frequencyHz;
+    uint16_t resultSize;    // Bytes per result, from the enabled outputs
+    uint8_t streamCount;    // Last frame counter seen
+
+    // Work buffer (DCI transfers, calibration, results) and the NVM
+    // offset calibration, re-sent on every resolution change
+    uint8_t* work;
+    uint8_t* offsetData;
+
+#if POCKETOS_VL53L5CX_ENABLE_BASIC_READ
+    VL53L5CXFrame frame;
+    uint32_t frames;
+    bool busError;
+#endif
+
+    bool bootAndUpload();
+    bool startRanging();
+    bool stopRanging();
+    bool applyResolution(uint8_t zones);
+    bool applyFrequency(uint8_t hz);
+    bool applyContinuousMode();
+    bool sendOffsetData(uint8_t zones);
+    bool sendXtalkData(uint8_t zones);
+
+    // DCI: firmware parameter blocks, host byte order in data
+    bool dciRead(uint16_t index, uint8_t* data, uint16_t size);
+    bool dciWrite(uint16_t index, const uint8_t* data, uint16_t size);
+    bool dciReplace(uint16_t index, uint16_t size, const uint8_t* value, uint16_t valueSize, uint16_t pos);
+
+    bool pollForAnswer(uint8_t size, uint8_t pos, uint16_t reg, uint8_t mask, uint8_t expected);
+    bool pollForMcuBoot();
+
+    bool writeByte(uint16_t reg, uint8_t value);
+    bool readByte(uint16_t reg, uint8_t* value);
+    bool writeMulti(uint16_t reg, const uint8_t* data, size_t len);
+    bool readMulti(uint16_t reg, uint8_t* data, size_t len);
 };
 
 } // namespace PocketOS
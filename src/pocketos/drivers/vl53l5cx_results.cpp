@@ -0,0 +1,79 @@
+#include "vl53l5cx_results.h"
+
+namespace PocketOS {
+
+// Byte b of the host-order stream starting at a 4-byte aligned base
+static inline uint8_t streamByte(const uint8_t* base, size_t b) {
+    return base[b ^ 3];
+}
+
+static inline uint32_t readBE32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+bool vl53l5cxParseResults(const uint8_t* raw, size_t len, uint8_t zoneCount, VL53L5CXFrame& frame) {
+    if (!raw || len < 16 || (zoneCount != 16 && zoneCount != 64)) {
+        return false;
+    }
+
+    const uint8_t* nbTargets = nullptr;
+    const uint8_t* distance = nullptr;
+    const uint8_t* status = nullptr;
+    bool haveMeta = false;
+
+    frame.streamCount = raw[0];
+    frame.zoneCount = zoneCount;
+
+    // Blocks start after the 16-byte stream header
+    size_t i = 16;
+    while (i + 4 <= len) {
+        uint32_t header = readBE32(raw + i);
+        uint8_t type = (uint8_t)(header & 0x0F);
+        uint16_t size = (uint16_t)((header >> 4) & 0x0FFF);
+        uint16_t idx = (uint16_t)(header >> 16);
+        size_t payload = (type >= 0x1 && type < 0xD) ? (size_t)type * size : size;
+
+        // The stream ends with a footer that is not a block: stop at the
+        // first header whose payload does not fit (or is not whole words)
+        const uint8_t* data = raw + i + 4;
+        if ((payload & 3) != 0 || i + 4 + payload > len) {
+            break;
+        }
+
+        if (idx == VL53L5CX_BLOCK_METADATA && payload >= 12) {
+            frame.siliconTempC = (int8_t)streamByte(data, 8);
+            haveMeta = true;
+        } else if (idx == VL53L5CX_BLOCK_NB_TARGETS && type == 1 && size >= zoneCount) {
+            nbTargets = data;
+        } else if (idx == VL53L5CX_BLOCK_DISTANCE && type == 2 && size >= zoneCount) {
+            distance = data;
+        } else if (idx == VL53L5CX_BLOCK_TARGET_STATUS && type == 1 && size >= zoneCount) {
+            status = data;
+        }
+
+        i += 4 + payload;
+    }
+
+    if (!haveMeta || !nbTargets || !distance || !status) {
+        return false;
+    }
+
+    uint8_t valid = 0;
+    for (uint8_t z = 0; z < zoneCount; z++) {
+        VL53L5CXZone& zone = frame.zones[z];
+        zone.targets = streamByte(nbTargets, z);
+
+        // int16 little-endian in the host-order stream
+        int16_t d = (int16_t)(streamByte(distance, 2 * z) | (streamByte(distance, 2 * z + 1) << 8));
+        zone.distanceMm = d > 0 ? (uint16_t)(d / 4) : 0;
+        zone.status = zone.targets ? streamByte(status, z) : VL53L5CX_STATUS_NO_TARGET;
+
+        if (frame.isValid(z)) {
+            valid++;
+        }
+    }
+    frame.validZones = valid;
+    return true;
+}
+
+} // namespace PocketOS
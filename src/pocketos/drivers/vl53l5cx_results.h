@@ -0,0 +1,67 @@
+#ifndef POCKETOS_VL53L5CX_RESULTS_H
+#define POCKETOS_VL53L5CX_RESULTS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PocketOS {
+
+/**
+ * VL53L5CX Result Parsing
+ *
+ * A result, as read from the sensor, is a sequence of blocks, each a
+ * 32-bit header followed by its payload:
+ *   header: idx (bits 31-16), size (bits 15-4), type (bits 3-0)
+ *   type 1..12: size elements of type bytes each; otherwise size bytes
+ * The sensor sends every 32-bit word most significant byte first. ST's
+ * ULD byte-swaps the whole buffer and copies every block into a large
+ * results structure; here the blocks are read where they are: byte b of
+ * the host-order stream is raw[b ^ 3], so elements are fetched with an
+ * index XOR and nothing is copied or swapped.
+ *
+ * Distances are in the sensor's 0.25 mm units, negative values clamp to
+ * 0. Zones without a target get status VL53L5CX_STATUS_NO_TARGET.
+ *
+ * No Arduino dependency: the parser is exercised on the host.
+ */
+
+#define VL53L5CX_MAX_ZONES 64
+
+// Block indices of the outputs the driver enables
+#define VL53L5CX_BLOCK_METADATA     0x54B4
+#define VL53L5CX_BLOCK_NB_TARGETS   0xCF7C
+#define VL53L5CX_BLOCK_DISTANCE     0xD33C
+#define VL53L5CX_BLOCK_TARGET_STATUS 0xD47C
+
+// Target status: ST treats 5 and 9 (valid with large pulse) as valid ranges
+#define VL53L5CX_STATUS_VALID       5
+#define VL53L5CX_STATUS_VALID_LARGE_PULSE 9
+#define VL53L5CX_STATUS_NO_TARGET   255
+
+struct VL53L5CXZone {
+    uint16_t distanceMm;
+    uint8_t status;         // ST target status (VL53L5CX_STATUS_*)
+    uint8_t targets;        // Targets detected in the zone (0 or 1)
+};
+
+// One ranging frame (caller-owned, 260 bytes)
+struct VL53L5CXFrame {
+    VL53L5CXZone zones[VL53L5CX_MAX_ZONES];   // Row-major, zoneCount entries
+    uint8_t zoneCount;
+    uint8_t streamCount;    // Sensor frame counter
+    int8_t siliconTempC;
+    uint8_t validZones;
+
+    bool isValid(uint8_t zone) const {
+        return zones[zone].status == VL53L5CX_STATUS_VALID ||
+               zones[zone].status == VL53L5CX_STATUS_VALID_LARGE_PULSE;
+    }
+};
+
+// Parse a raw result of len bytes for zoneCount zones into frame.
+// False if a required block is missing or truncated.
+bool vl53l5cxParseResults(const uint8_t* raw, size_t len, uint8_t zoneCount, VL53L5CXFrame& frame);
+
+} // namespace PocketOS
+
+#endif // POCKETOS_VL53L5CX_RESULTS_H
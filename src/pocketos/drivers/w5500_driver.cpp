@@ -4,32 +4,7 @@
 
 namespace PocketOS {
 
-// W5500 Block Select Bits
-#define W5500_BSB_COMMON_REG    0x00
-#define W5500_BSB_S0_REG        0x08
-#define W5500_BSB_S0_TX_BUF     0x10
-#define W5500_BSB_S0_RX_BUF     0x18
-
-// W5500 Socket Commands
-#define W5500_CMD_OPEN          0x01
-#define W5500_CMD_LISTEN        0x02
-#define W5500_CMD_CONNECT       0x04
-#define W5500_CMD_DISCON        0x08
-#define W5500_CMD_CLOSE         0x10
-#define W5500_CMD_SEND          0x20
-#define W5500_CMD_RECV          0x40
-
-// W5500 Socket Status
-#define W5500_SOCK_CLOSED       0x00
-#define W5500_SOCK_INIT         0x13
-#define W5500_SOCK_LISTEN       0x14
-#define W5500_SOCK_ESTABLISHED  0x17
-#define W5500_SOCK_CLOSE_WAIT   0x1C
-#define W5500_SOCK_UDP          0x22
-
-// W5500 Protocols
-#define W5500_PROTO_TCP         0x01
-#define W5500_PROTO_UDP         0x02
+#define W5500_REG_VERSIONR      0x0039
 
 #if POCKETOS_W5500_ENABLE_REGISTER_ACCESS
 // Complete W5500 Register Map (Common and Socket registers)
@@ -131,6 +106,7 @@ static const RegisterDesc W5500_REGISTERS[] = {
 W5500Driver::W5500Driver() 
     : initialized_(false) {
     setRegisterConvention(SPIRegisterConvention::GENERIC);
+    sockets_.setBus(this);
 }
 
 W5500Driver::~W5500Driver() {
@@ -150,16 +126,20 @@ bool W5500Driver::init(const String& endpoint) {
         delay(200);  // Wait for W5500 to initialize
     }
     
-    // Read version register
-    uint8_t version = readByte(W5500_BSB_COMMON_REG, 0x0039);
+    // Read version register (readReg needs initialized_)
+    initialized_ = true;
+    uint8_t version = readByte(W5500_BSB_COMMON_REG, W5500_REG_VERSIONR);
     if (version != 0x04) {
-        Logger::error("W5500: Invalid version: 0x" + String(version, HEX));
+        initialized_ = false;
+        Logger::error(("W5500: Invalid version: 0x" + String(version, HEX)).c_str());
         deinit();
         return false;
     }
     
-    initialized_ = true;
-    Logger::info("W5500: Initialized successfully (version 0x" + String(version, HEX) + ")");
+    for (uint8_t i = 0; i < W5500_SOCKETS; i++) {
+        sockets_.configure(i);
+    }
+    Logger::info(("W5500: Initialized successfully (version 0x" + String(version, HEX) + ")").c_str());
     return true;
 }
 
@@ -185,7 +165,7 @@ bool W5500Driver::identifyProbe(const String& endpoint) {
     }
     
     // Read VERSIONR register
-    uint8_t version = driver.readByte(W5500_BSB_COMMON_REG, 0x0039);
+    uint8_t version = driver.readByte(W5500_BSB_COMMON_REG, W5500_REG_VERSIONR);
     return version == 0x04;
 }
 
@@ -194,22 +174,13 @@ bool W5500Driver::readReg(uint8_t block, uint16_t addr, uint8_t* data, uint16_t
         return false;
     }
     
-    beginTransaction();
-    
-    // Send address (high byte, low byte)
-    SPI.transfer((addr >> 8) & 0xFF);
-    SPI.transfer(addr & 0xFF);
-    
-    // Send control byte (block select + read mode)
-    SPI.transfer((block << 3) | 0x00);
-    
-    // Read data
-    for (uint16_t i = 0; i < len; i++) {
-        data[i] = SPI.transfer(0x00);
-    }
-    
-    endTransaction();
-    return true;
+    // Address (high byte, low byte), control byte (block select + read mode)
+    uint8_t header[3] = { (uint8_t)((addr >> 8) & 0xFF), (uint8_t)(addr & 0xFF), (uint8_t)((block << 3) | 0x00) };
+    SPITransferDesc chain[2] = {
+        SPITransferDesc::write(header, 3),
+        SPITransferDesc::read(data, len)
+    };
+    return spiTransaction(chain, 2);
 }
 
 bool W5500Driver::writeReg(uint8_t block, uint16_t addr, const uint8_t* data, uint16_t len) {
@@ -217,22 +188,13 @@ bool W5500Driver::writeReg(uint8_t block, uint16_t addr, const uint8_t* data, ui
         return false;
     }
     
-    beginTransaction();
-    
-    // Send address (high byte, low byte)
-    SPI.transfer((addr >> 8) & 0xFF);
-    SPI.transfer(addr & 0xFF);
-    
-    // Send control byte (block select + write mode)
-    SPI.transfer((block << 3) | 0x04);
-    
-    // Write data
-    for (uint16_t i = 0; i < len; i++) {
-        SPI.transfer(data[i]);
-    }
-    
-    endTransaction();
-    return true;
+    // Address (high byte, low byte), control byte (block select + write mode)
+    uint8_t header[3] = { (uint8_t)((addr >> 8) & 0xFF), (uint8_t)(addr & 0xFF), (uint8_t)((block << 3) | 0x04) };
+    SPITransferDesc chain[2] = {
+        SPITransferDesc::write(header, 3),
+        SPITransferDesc::write(data, len)
+    };
+    return spiTransaction(chain, 2);
 }
 
 uint8_t W5500Driver::readByte(uint8_t block, uint16_t addr) {
@@ -265,19 +227,20 @@ bool W5500Driver::socketOpen(uint8_t socket, uint8_t protocol, uint16_t port) {
     uint8_t block = getSocketBlockBase(socket);
     
     // Close socket if open
-    writeByte(block, 0x0001, W5500_CMD_CLOSE);
+    writeByte(block, W5500_Sn_CR, W5500_CMD_CLOSE);
     delay(1);
     
     // Set protocol
-    writeByte(block, 0x0000, protocol);
+    writeByte(block, W5500_Sn_MR, protocol);
     
     // Set port
-    writeWord(block, 0x0004, port);
+    writeWord(block, W5500_Sn_PORT, port);
     
     // Open socket
-    writeByte(block, 0x0001, W5500_CMD_OPEN);
+    writeByte(block, W5500_Sn_CR, W5500_CMD_OPEN);
     delay(1);
     
+    sockets_.configure(socket);
     return socketStatus(socket) != W5500_SOCK_CLOSED;
 }
 
@@ -287,7 +250,7 @@ bool W5500Driver::socketClose(uint8_t socket) {
     }
     
     uint8_t block = getSocketBlockBase(socket);
-    writeByte(block, 0x0001, W5500_CMD_CLOSE);
+    writeByte(block, W5500_Sn_CR, W5500_CMD_CLOSE);
     delay(1);
     
     return true;
@@ -301,13 +264,14 @@ bool W5500Driver::socketConnect(uint8_t socket, const uint8_t* ip, uint16_t port
     uint8_t block = getSocketBlockBase(socket);
     
     // Set destination IP
-    writeReg(block, 0x000C, ip, 4);
+    sockets_.forgetDestination(socket);
+    writeReg(block, W5500_Sn_DIPR, ip, 4);
     
     // Set destination port
-    writeWord(block, 0x0010, port);
+    writeWord(block, W5500_Sn_DPORT, port);
     
     // Connect
-    writeByte(block, 0x0001, W5500_CMD_CONNECT);
+    writeByte(block, W5500_Sn_CR, W5500_CMD_CONNECT);
     
     return true;
 }
@@ -318,7 +282,7 @@ bool W5500Driver::socketListen(uint8_t socket) {
     }
     
     uint8_t block = getSocketBlockBase(socket);
-    writeByte(block, 0x0001, W5500_CMD_LISTEN);
+    writeByte(block, W5500_Sn_CR, W5500_CMD_LISTEN);
     
     return true;
 }
@@ -328,23 +292,8 @@ int16_t W5500Driver::socketSend(uint8_t socket, const uint8_t* data, uint16_t le
         return -1;
     }
     
-    uint8_t block_reg = getSocketBlockBase(socket);
-    uint8_t block_tx = getSocketTxBufBase(socket);
-    
-    // Get TX write pointer
-    uint16_t ptr = readWord(block_reg, 0x0024);
-    
-    // Write data to TX buffer
-    writeReg(block_tx, ptr, data, len);
-    
-    // Update TX write pointer
-    ptr += len;
-    writeWord(block_reg, 0x0024, ptr);
-    
-    // Send command
-    writeByte(block_reg, 0x0001, W5500_CMD_SEND);
-    
-    return len;
+    // As much as fits; 0 while the previous SEND is still going out
+    return (int16_t)sockets_.send(socket, data, len > 0x7FFF ? 0x7FFF : len);
 }
 
 int16_t W5500Driver::socketRecv(uint8_t socket, uint8_t* data, uint16_t len) {
@@ -352,34 +301,7 @@ int16_t W5500Driver::socketRecv(uint8_t socket, uint8_t* data, uint16_t len) {
         return -1;
     }
     
-    uint8_t block_reg = getSocketBlockBase(socket);
-    uint8_t block_rx = getSocketRxBufBase(socket);
-    
-    // Get RX received size
-    uint16_t recv_size = readWord(block_reg, 0x0026);
-    if (recv_size == 0) {
-        return 0;
-    }
-    
-    // Limit to requested length
-    if (recv_size > len) {
-        recv_size = len;
-    }
-    
-    // Get RX read pointer
-    uint16_t ptr = readWord(block_reg, 0x0028);
-    
-    // Read data from RX buffer
-    readReg(block_rx, ptr, data, recv_size);
-    
-    // Update RX read pointer
-    ptr += recv_size;
-    writeWord(block_reg, 0x0028, ptr);
-    
-    // Receive command
-    writeByte(block_reg, 0x0001, W5500_CMD_RECV);
-    
-    return recv_size;
+    return (int16_t)sockets_.recv(socket, data, len > 0x7FFF ? 0x7FFF : len);
 }
 
 uint8_t W5500Driver::socketStatus(uint8_t socket) {
@@ -388,7 +310,7 @@ uint8_t W5500Driver::socketStatus(uint8_t socket) {
     }
     
     uint8_t block = getSocketBlockBase(socket);
-    return readByte(block, 0x0003);
+    return readByte(block, W5500_Sn_SR);
 }
 #endif
 
@@ -426,31 +348,17 @@ bool W5500Driver::setGateway(const uint8_t* gateway) {
 }
 
 bool W5500Driver::socketSendTo(uint8_t socket, const uint8_t* data, uint16_t len, const uint8_t* ip, uint16_t port) {
+    return socketSendTo(socket, nullptr, 0, data, len, ip, port);
+}
+
+bool W5500Driver::socketSendTo(uint8_t socket, const uint8_t* head, uint16_t headLen,
+                               const uint8_t* data, uint16_t len, const uint8_t* ip, uint16_t port) {
     if (!initialized_ || socket > 7) {
         return false;
     }
     
-    uint8_t block_reg = getSocketBlockBase(socket);
-    uint8_t block_tx = getSocketTxBufBase(socket);
-    
-    // Set destination IP and port
-    writeReg(block_reg, 0x000C, ip, 4);
-    writeWord(block_reg, 0x0010, port);
-    
-    // Get TX write pointer
-    uint16_t ptr = readWord(block_reg, 0x0024);
-    
-    // Write data to TX buffer
-    writeReg(block_tx, ptr, data, len);
-    
-    // Update TX write pointer
-    ptr += len;
-    writeWord(block_reg, 0x0024, ptr);
-    
-    // Send command
-    writeByte(block_reg, 0x0001, W5500_CMD_SEND);
-    
-    return true;
+    // False also while the previous datagram is still going out
+    return sockets_.sendTo(socket, head, headLen, data, len, ip, port) > 0;
 }
 
 int16_t W5500Driver::socketRecvFrom(uint8_t socket, uint8_t* data, uint16_t len, uint8_t* ip, uint16_t& port) {
@@ -458,66 +366,23 @@ int16_t W5500Driver::socketRecvFrom(uint8_t socket, uint8_t* data, uint16_t len,
         return -1;
     }
     
-    uint8_t block_reg = getSocketBlockBase(socket);
-    uint8_t block_rx = getSocketRxBufBase(socket);
-    
-    // Get RX received size
-    uint16_t recv_size = readWord(block_reg, 0x0026);
-    if (recv_size < 8) {
-        return 0;  // Need at least 8 bytes for UDP header
-    }
-    
-    // Get RX read pointer
-    uint16_t ptr = readWord(block_reg, 0x0028);
-    
-    // Read UDP header (IP:4 + port:2 + size:2)
-    uint8_t header[8];
-    readReg(block_rx, ptr, header, 8);
-    ptr += 8;
-    
-    // Extract IP and port
-    if (ip) {
-        for (int i = 0; i < 4; i++) {
-            ip[i] = header[i];
-        }
-    }
-    port = ((uint16_t)header[4] << 8) | header[5];
-    
-    // Get data size
-    uint16_t data_size = ((uint16_t)header[6] << 8) | header[7];
-    if (data_size > len) {
-        data_size = len;
-    }
-    
-    // Read data
-    readReg(block_rx, ptr, data, data_size);
-    ptr += data_size;
-    
-    // Update RX read pointer
-    writeWord(block_reg, 0x0028, ptr);
-    
-    // Receive command
-    writeByte(block_reg, 0x0001, W5500_CMD_RECV);
-    
-    return data_size;
+    return (int16_t)sockets_.recvFrom(socket, data, len > 0x7FFF ? 0x7FFF : len, ip, port);
 }
 
 uint16_t W5500Driver::getTxFreeSize(uint8_t socket) {
-    if (!initialized_ || socket > 7) {
+    W5500Window window;
+    if (!initialized_ || !sockets_.txWindow(socket, window)) {
         return 0;
     }
-    
-    uint8_t block = getSocketBlockBase(socket);
-    return readWord(block, 0x0020);
+    return window.len;
 }
 
 uint16_t W5500Driver::getRxRecvSize(uint8_t socket) {
-    if (!initialized_ || socket > 7) {
+    W5500Window window;
+    if (!initialized_ || !sockets_.rxWindow(socket, window)) {
         return 0;
     }
-    
-    uint8_t block = getSocketBlockBase(socket);
-    return readWord(block, 0x0026);
+    return window.len;
 }
 #endif
 
@@ -538,7 +403,7 @@ bool W5500Driver::regRead(uint16_t reg, uint8_t* buf, size_t len) {
         addr = reg;
     } else {
         // Socket registers (simplified - socket 0 only)
-        block = W5500_BSB_S0_REG;
+        block = W5500_BSB_SOCKET_REG(0);
         addr = reg & 0x0FFF;
     }
     
@@ -556,8 +421,9 @@ bool W5500Driver::regWrite(uint16_t reg, const uint8_t* buf, size_t len) {
         addr = reg;
     } else {
         // Socket registers (simplified - socket 0 only)
-        block = W5500_BSB_S0_REG;
+        block = W5500_BSB_SOCKET_REG(0);
         addr = reg & 0x0FFF;
+        sockets_.forgetDestination(0);
     }
     
     return writeReg(block, addr, buf, len);
@@ -5,13 +5,19 @@
 #include "../driver_config.h"
 #include "spi_driver_base.h"
 #include "register_types.h"
+#include "w5500_socket.h"
 
 namespace PocketOS {
 
 // W5500 Ethernet Controller Driver
 // Endpoint format: spi0:cs=5,rst=17,irq=4 (rst and irq optional)
+//
+// Every register or buffer access is one variable-length data mode frame
+// (chip select held for the address, control byte and all data). Socket
+// data moves through W5500Sockets: sockets() exposes the RX and TX ring
+// windows for in-place parsing, and the socket* calls are built on them.
 
-class W5500Driver : public SPIDriverBase {
+class W5500Driver : public SPIDriverBase, public W5500Bus {
 public:
     W5500Driver();
     ~W5500Driver();
@@ -34,6 +40,9 @@ public:
     int16_t socketSend(uint8_t socket, const uint8_t* data, uint16_t len);
     int16_t socketRecv(uint8_t socket, uint8_t* data, uint16_t len);
     uint8_t socketStatus(uint8_t socket);
+    
+    // Ring windows, burst reads and writes, batched consume/commit
+    W5500Sockets& sockets() { return sockets_; }
 #endif
 
 #if POCKETOS_W5500_ENABLE_ERROR_HANDLING
@@ -43,6 +52,9 @@ public:
     bool setSubnetMask(const uint8_t* subnet);
     bool setGateway(const uint8_t* gateway);
     bool socketSendTo(uint8_t socket, const uint8_t* data, uint16_t len, const uint8_t* ip, uint16_t port);
+    // UDP datagram of head followed by data, without joining them first
+    bool socketSendTo(uint8_t socket, const uint8_t* head, uint16_t headLen,
+                      const uint8_t* data, uint16_t len, const uint8_t* ip, uint16_t port);
     int16_t socketRecvFrom(uint8_t socket, uint8_t* data, uint16_t len, uint8_t* ip, uint16_t& port);
     uint16_t getTxFreeSize(uint8_t socket);
     uint16_t getRxRecvSize(uint8_t socket);
@@ -55,24 +67,25 @@ public:
     bool regWrite(uint16_t reg, const uint8_t* buf, size_t len) override;
     const RegisterDesc* findRegisterByName(const String& name) const override;
 #endif
+    
+    // W5500Bus: one SPI frame
+    bool readFrame(uint8_t block, uint16_t addr, uint8_t* data, uint16_t len) override {
+        return readReg(block, addr, data, len);
+    }
+    bool writeFrame(uint8_t block, uint16_t addr, const uint8_t* data, uint16_t len) override {
+        return writeReg(block, addr, data, len);
+    }
 
 private:
     bool initialized_;
+    W5500Sockets sockets_;
     
     // Helper methods
     uint8_t getSocketBlockBase(uint8_t socket) const {
-        return W5500_BSB_S0_REG + (socket * 0x20);
-    }
-    
-    uint8_t getSocketTxBufBase(uint8_t socket) const {
-        return W5500_BSB_S0_TX_BUF + (socket * 0x20);
-    }
-    
-    uint8_t getSocketRxBufBase(uint8_t socket) const {
-        return W5500_BSB_S0_RX_BUF + (socket * 0x20);
+        return W5500_BSB_SOCKET_REG(socket);
     }
     
-    // W5500-specific register access (3-byte addressing: control, addr_hi, addr_lo)
+    // W5500-specific register access (3-byte header: addr_hi, addr_lo, control)
     bool readReg(uint8_t block, uint16_t addr, uint8_t* data, uint16_t len);
     bool writeReg(uint8_t block, uint16_t addr, const uint8_t* data, uint16_t len);
     uint8_t readByte(uint8_t block, uint16_t addr);
@@ -0,0 +1,297 @@
+#include "w5500_socket.h"
+
+#include <string.h>
+
+namespace PocketOS {
+
+// Sn_TX_FSR and Sn_RX_RSR can change while they are read; the datasheet
+// asks for the same value twice in a row
+#define W5500_STABLE_READS 4
+
+W5500Sockets::W5500Sockets() : bus_(nullptr) {
+    for (uint8_t i = 0; i < W5500_SOCKETS; i++) {
+        rxSize_[i] = 2048;   // Reset default: 2 KB each way
+        txSize_[i] = 2048;
+        sendPending_[i] = false;
+        destValid_[i] = false;
+    }
+}
+
+bool W5500Sockets::configure(uint8_t socket) {
+    uint8_t sizes[2];   // Sn_RXBUF_SIZE, Sn_TXBUF_SIZE (KB)
+    if (!bus_ || socket >= W5500_SOCKETS ||
+        !bus_->readFrame(W5500_BSB_SOCKET_REG(socket), W5500_Sn_RXBUF_SIZE, sizes, 2)) {
+        return false;
+    }
+    rxSize_[socket] = (uint16_t)(sizes[0] * 1024);
+    txSize_[socket] = (uint16_t)(sizes[1] * 1024);
+    sendPending_[socket] = false;
+    destValid_[socket] = false;
+    return true;
+}
+
+void W5500Sockets::setSpans(W5500Window& window, uint16_t bufferSize) {
+    if (bufferSize == 0) {
+        window.spans[0].offset = 0;
+        window.spans[0].len = 0;
+        window.spans[1] = window.spans[0];
+        return;
+    }
+    uint16_t offset = window.ptr & (bufferSize - 1);
+    uint16_t first = window.len < bufferSize - offset ? window.len : (uint16_t)(bufferSize - offset);
+    window.spans[0].offset = offset;
+    window.spans[0].len = first;
+    window.spans[1].offset = 0;
+    window.spans[1].len = window.len - first;
+}
+
+bool W5500Sockets::rxWindow(uint8_t socket, W5500Window& window) {
+    if (!bus_ || socket >= W5500_SOCKETS) {
+        return false;
+    }
+    // Sn_RX_RSR and Sn_RX_RD in one frame
+    uint8_t regs[4];
+    uint16_t last = 0xFFFF;
+    for (uint8_t i = 0; i < W5500_STABLE_READS; i++) {
+        if (!bus_->readFrame(W5500_BSB_SOCKET_REG(socket), W5500_Sn_RX_RSR, regs, 4)) {
+            return false;
+        }
+        uint16_t rsr = ((uint16_t)regs[0] << 8) | regs[1];
+        if (rsr == last) {
+            break;
+        }
+        last = rsr;
+    }
+    window.len = last;
+    window.ptr = ((uint16_t)regs[2] << 8) | regs[3];
+    setSpans(window, rxSize_[socket]);
+    return true;
+}
+
+bool W5500Sockets::rxRead(uint8_t socket, const W5500Window& window, uint16_t offset, uint8_t* dst, uint16_t len) {
+    if (!bus_ || socket >= W5500_SOCKETS || (uint32_t)offset + len > window.len) {
+        return false;
+    }
+    if (len == 0) {
+        return true;
+    }
+    return bus_->readFrame(W5500_BSB_SOCKET_RX(socket), (uint16_t)(window.ptr + offset), dst, len);
+}
+
+bool W5500Sockets::rxDatagram(uint8_t socket, const W5500Window& window, uint16_t& offset, W5500Datagram& datagram) {
+    uint8_t header[W5500_UDP_HEADER_SIZE];
+    if (!rxRead(socket, window, offset, header, W5500_UDP_HEADER_SIZE)) {
+        return false;
+    }
+    memcpy(datagram.ip, header, 4);
+    datagram.port = ((uint16_t)header[4] << 8) | header[5];
+    datagram.len = ((uint16_t)header[6] << 8) | header[7];
+    datagram.offset = (uint16_t)(offset + W5500_UDP_HEADER_SIZE);
+    if ((uint32_t)datagram.offset + datagram.len > window.len) {
+        return false;   // Still being written, or the ring is out of step
+    }
+    offset = (uint16_t)(datagram.offset + datagram.len);
+    return true;
+}
+
+bool W5500Sockets::rxConsume(uint8_t socket, W5500Window& window, uint16_t len) {
+    if (!bus_ || socket >= W5500_SOCKETS || len > window.len) {
+        return false;
+    }
+    if (len == 0) {
+        return true;
+    }
+    uint16_t ptr = (uint16_t)(window.ptr + len);
+    uint8_t rd[2] = { (uint8_t)(ptr >> 8), (uint8_t)(ptr & 0xFF) };
+    if (!bus_->writeFrame(W5500_BSB_SOCKET_REG(socket), W5500_Sn_RX_RD, rd, 2) ||
+        !command(socket, W5500_CMD_RECV)) {
+        return false;
+    }
+    window.ptr = ptr;
+    window.len -= len;
+    setSpans(window, rxSize_[socket]);
+    return true;
+}
+
+bool W5500Sockets::txWindow(uint8_t socket, W5500Window& window) {
+    if (!bus_ || socket >= W5500_SOCKETS) {
+        return false;
+    }
+    // Sn_TX_FSR, Sn_TX_RD and Sn_TX_WR in one frame
+    uint8_t regs[6];
+    uint16_t last = 0xFFFF;
+    for (uint8_t i = 0; i < W5500_STABLE_READS; i++) {
+        if (!bus_->readFrame(W5500_BSB_SOCKET_REG(socket), W5500_Sn_TX_FSR, regs, 6)) {
+            return false;
+        }
+        uint16_t fsr = ((uint16_t)regs[0] << 8) | regs[1];
+        if (fsr == last) {
+            break;
+        }
+        last = fsr;
+    }
+    window.len = last;
+    window.ptr = ((uint16_t)regs[4] << 8) | regs[5];
+    setSpans(window, txSize_[socket]);
+    return true;
+}
+
+bool W5500Sockets::txWrite(uint8_t socket, const W5500Window& window, uint16_t offset, const uint8_t* src, uint16_t len) {
+    if (!bus_ || socket >= W5500_SOCKETS || (uint32_t)offset + len > window.len) {
+        return false;
+    }
+    if (len == 0) {
+        return true;
+    }
+    return bus_->writeFrame(W5500_BSB_SOCKET_TX(socket), (uint16_t)(window.ptr + offset), src, len);
+}
+
+bool W5500Sockets::txReady(uint8_t socket) {
+    if (!bus_ || socket >= W5500_SOCKETS) {
+        return false;
+    }
+    if (!sendPending_[socket]) {
+        return true;
+    }
+    uint8_t ir = 0;
+    if (!bus_->readFrame(W5500_BSB_SOCKET_REG(socket), W5500_Sn_IR, &ir, 1)) {
+        return false;
+    }
+    uint8_t done = ir & (W5500_IR_SEND_OK | W5500_IR_TIMEOUT);
+    if (!done) {
+        return false;
+    }
+    bus_->writeFrame(W5500_BSB_SOCKET_REG(socket), W5500_Sn_IR, &done, 1);
+    sendPending_[socket] = false;
+    return true;
+}
+
+bool W5500Sockets::txCommit(uint8_t socket, W5500Window& window, uint16_t len) {
+    if (!bus_ || socket >= W5500_SOCKETS || len > window.len) {
+        return false;
+    }
+    if (len == 0 || !txReady(socket)) {
+        return false;
+    }
+    uint16_t ptr = (uint16_t)(window.ptr + len);
+    uint8_t wr[2] = { (uint8_t)(ptr >> 8), (uint8_t)(ptr & 0xFF) };
+    if (!bus_->writeFrame(W5500_BSB_SOCKET_REG(socket), W5500_Sn_TX_WR, wr, 2) ||
+        !command(socket, W5500_CMD_SEND)) {
+        return false;
+    }
+    sendPending_[socket] = true;
+    window.ptr = ptr;
+    window.len -= len;
+    setSpans(window, txSize_[socket]);
+    return true;
+}
+
+bool W5500Sockets::txCommitTo(uint8_t socket, W5500Window& window, uint16_t len, const uint8_t* ip, uint16_t port) {
+    if (!bus_ || socket >= W5500_SOCKETS || !ip || len == 0 || len > window.len || !txReady(socket)) {
+        return false;
+    }
+    // Sn_DIPR and Sn_DPORT are adjacent: one frame, skipped for the same peer
+    uint8_t dest[6] = { ip[0], ip[1], ip[2], ip[3], (uint8_t)(port >> 8), (uint8_t)(port & 0xFF) };
+    if (!destValid_[socket] || memcmp(dest, dest_[socket], sizeof(dest)) != 0) {
+        if (!bus_->writeFrame(W5500_BSB_SOCKET_REG(socket), W5500_Sn_DIPR, dest, sizeof(dest))) {
+            destValid_[socket] = false;
+            return false;
+        }
+        memcpy(dest_[socket], dest, sizeof(dest));
+        destValid_[socket] = true;
+    }
+    return txCommit(socket, window, len);
+}
+
+bool W5500Sockets::command(uint8_t socket, uint8_t cmd) {
+    return bus_->writeFrame(W5500_BSB_SOCKET_REG(socket), W5500_Sn_CR, &cmd, 1);
+}
+
+int32_t W5500Sockets::send(uint8_t socket, const uint8_t* data, uint16_t len) {
+    if (!bus_ || socket >= W5500_SOCKETS) {
+        return -1;
+    }
+    W5500Window window;
+    if (len == 0 || !txReady(socket)) {
+        return 0;
+    }
+    if (!txWindow(socket, window)) {
+        return -1;
+    }
+    uint16_t n = len < window.len ? len : window.len;
+    if (n == 0) {
+        return 0;
+    }
+    if (!txWrite(socket, window, 0, data, n) || !txCommit(socket, window, n)) {
+        return -1;
+    }
+    return n;
+}
+
+int32_t W5500Sockets::recv(uint8_t socket, uint8_t* data, uint16_t len) {
+    W5500Window window;
+    if (!rxWindow(socket, window)) {
+        return -1;
+    }
+    uint16_t n = len < window.len ? len : window.len;
+    if (n == 0) {
+        return 0;
+    }
+    if (!rxRead(socket, window, 0, data, n) || !rxConsume(socket, window, n)) {
+        return -1;
+    }
+    return n;
+}
+
+int32_t W5500Sockets::sendTo(uint8_t socket, const uint8_t* head, uint16_t headLen,
+                             const uint8_t* data, uint16_t len, const uint8_t* ip, uint16_t port) {
+    if (!bus_ || socket >= W5500_SOCKETS || !ip) {
+        return -1;
+    }
+    uint32_t total = (uint32_t)headLen + len;
+    if (total == 0 || total > txSize_[socket]) {
+        return -1;   // Never fits
+    }
+    W5500Window window;
+    if (!txReady(socket)) {
+        return 0;
+    }
+    if (!txWindow(socket, window)) {
+        return -1;
+    }
+    if (window.len < total) {
+        return 0;
+    }
+    if (!txWrite(socket, window, 0, head, headLen) ||
+        !txWrite(socket, window, headLen, data, len) ||
+        !txCommitTo(socket, window, (uint16_t)total, ip, port)) {
+        return -1;
+    }
+    return (int32_t)total;
+}
+
+int32_t W5500Sockets::recvFrom(uint8_t socket, uint8_t* data, uint16_t len, uint8_t* ip, uint16_t& port) {
+    W5500Window window;
+    if (!rxWindow(socket, window)) {
+        return -1;
+    }
+    if (window.len < W5500_UDP_HEADER_SIZE) {
+        return 0;
+    }
+    uint16_t offset = 0;
+    W5500Datagram datagram;
+    if (!rxDatagram(socket, window, offset, datagram)) {
+        return 0;
+    }
+    uint16_t n = datagram.len < len ? datagram.len : len;
+    if (!rxRead(socket, window, datagram.offset, data, n) || !rxConsume(socket, window, offset)) {
+        return -1;
+    }
+    if (ip) {
+        memcpy(ip, datagram.ip, 4);
+    }
+    port = datagram.port;
+    return n;
+}
+
+} // namespace PocketOS
@@ -0,0 +1,173 @@
+#ifndef POCKETOS_W5500_SOCKET_H
+#define POCKETOS_W5500_SOCKET_H
+
+#include <stdint.h>
+
+namespace PocketOS {
+
+/**
+ * W5500 socket buffer windows
+ *
+ * Each socket's RX and TX buffers are rings in W5500 SRAM, addressed with
+ * free-running 16-bit pointers (Sn_RX_RD, Sn_TX_WR). The chip maps an
+ * address to (pointer & (size - 1)) and wraps the address as a burst
+ * crosses the end of the buffer. Any run of ring bytes can therefore move
+ * in one variable-length SPI frame, even across the wrap.
+ *
+ * A window is the readable (RX) or writable (TX) part of a ring: its
+ * pointer and length, plus where it sits in the buffer as one span, or two
+ * if it wraps. Protocol code reads headers at offsets in the window,
+ * transfers payloads straight between its own buffers and the chip, and
+ * then consumes (RX) or commits (TX) everything in one step. Packets are
+ * never staged in a driver buffer. Several datagrams can share one window,
+ * so the pointer registers and command are written once per batch.
+ *
+ * No Arduino dependency: W5500Driver supplies the SPI frames through
+ * W5500Bus, and the host model (tools/w5500sim) supplies a register-level
+ * chip.
+ */
+
+#define W5500_SOCKETS 8
+
+// Block select (BSB) values; the control byte is (BSB << 3) | RWB | OM
+#define W5500_BSB_COMMON_REG        0x00
+#define W5500_BSB_SOCKET_REG(n)     ((uint8_t)((n) * 4 + 1))
+#define W5500_BSB_SOCKET_TX(n)      ((uint8_t)((n) * 4 + 2))
+#define W5500_BSB_SOCKET_RX(n)      ((uint8_t)((n) * 4 + 3))
+
+// Socket register offsets
+#define W5500_Sn_MR                 0x0000
+#define W5500_Sn_CR                 0x0001
+#define W5500_Sn_IR                 0x0002
+#define W5500_Sn_SR                 0x0003
+#define W5500_Sn_PORT               0x0004
+#define W5500_Sn_DIPR               0x000C
+#define W5500_Sn_DPORT              0x0010
+#define W5500_Sn_RXBUF_SIZE         0x001E
+#define W5500_Sn_TXBUF_SIZE         0x001F
+#define W5500_Sn_TX_FSR             0x0020
+#define W5500_Sn_TX_RD              0x0022
+#define W5500_Sn_TX_WR              0x0024
+#define W5500_Sn_RX_RSR             0x0026
+#define W5500_Sn_RX_RD              0x0028
+#define W5500_Sn_RX_WR              0x002A
+
+// Socket commands (Sn_CR)
+#define W5500_CMD_OPEN              0x01
+#define W5500_CMD_LISTEN            0x02
+#define W5500_CMD_CONNECT           0x04
+#define W5500_CMD_DISCON            0x08
+#define W5500_CMD_CLOSE             0x10
+#define W5500_CMD_SEND              0x20
+#define W5500_CMD_RECV              0x40
+
+// Socket interrupts (Sn_IR, write 1 to clear)
+#define W5500_IR_SEND_OK            0x10
+#define W5500_IR_TIMEOUT            0x08
+#define W5500_IR_RECV               0x04
+#define W5500_IR_DISCON             0x02
+#define W5500_IR_CON                0x01
+
+// Socket status (Sn_SR)
+#define W5500_SOCK_CLOSED           0x00
+#define W5500_SOCK_INIT             0x13
+#define W5500_SOCK_LISTEN           0x14
+#define W5500_SOCK_ESTABLISHED      0x17
+#define W5500_SOCK_CLOSE_WAIT       0x1C
+#define W5500_SOCK_UDP              0x22
+
+// Protocols (Sn_MR)
+#define W5500_PROTO_TCP             0x01
+#define W5500_PROTO_UDP             0x02
+
+// UDP mode prefixes each received datagram with IP (4), port (2), length (2)
+#define W5500_UDP_HEADER_SIZE       8
+
+// One variable-length data mode frame: 3 header bytes, then len data bytes
+class W5500Bus {
+public:
+    virtual ~W5500Bus() {}
+    virtual bool readFrame(uint8_t block, uint16_t addr, uint8_t* data, uint16_t len) = 0;
+    virtual bool writeFrame(uint8_t block, uint16_t addr, const uint8_t* data, uint16_t len) = 0;
+};
+
+struct W5500Span {
+    uint16_t offset;    // Into the socket buffer
+    uint16_t len;
+};
+
+struct W5500Window {
+    uint16_t ptr;           // Sn_RX_RD (RX) or Sn_TX_WR (TX), free-running
+    uint16_t len;           // Bytes received (RX) or free (TX)
+    W5500Span spans[2];     // spans[1].len is 0 unless the window wraps
+};
+
+struct W5500Datagram {
+    uint8_t ip[4];
+    uint16_t port;
+    uint16_t len;           // Payload bytes
+    uint16_t offset;        // Payload position in the window
+};
+
+class W5500Sockets {
+public:
+    W5500Sockets();
+
+    void setBus(W5500Bus* bus) { bus_ = bus; }
+
+    // Read the socket's buffer sizes (after open or a size change)
+    bool configure(uint8_t socket);
+    uint16_t rxBufferSize(uint8_t socket) const { return socket < W5500_SOCKETS ? rxSize_[socket] : 0; }
+    uint16_t txBufferSize(uint8_t socket) const { return socket < W5500_SOCKETS ? txSize_[socket] : 0; }
+
+    // RX: received bytes from Sn_RX_RD (one frame)
+    bool rxWindow(uint8_t socket, W5500Window& window);
+    // Window bytes [offset, offset + len) into dst (one frame)
+    bool rxRead(uint8_t socket, const W5500Window& window, uint16_t offset, uint8_t* dst, uint16_t len);
+    // UDP: the datagram at offset; offset moves past it
+    bool rxDatagram(uint8_t socket, const W5500Window& window, uint16_t& offset, W5500Datagram& datagram);
+    // Release len bytes from the front of the window (Sn_RX_RD, RECV)
+    bool rxConsume(uint8_t socket, W5500Window& window, uint16_t len);
+
+    // TX: free space from Sn_TX_WR (one frame)
+    bool txWindow(uint8_t socket, W5500Window& window);
+    // src into window bytes [offset, offset + len) (one frame)
+    bool txWrite(uint8_t socket, const W5500Window& window, uint16_t offset, const uint8_t* src, uint16_t len);
+    // Publish len bytes and issue SEND. False, with nothing changed, while
+    // the previous SEND is still in progress.
+    bool txCommit(uint8_t socket, W5500Window& window, uint16_t len);
+    // UDP: commit len bytes as one datagram to ip:port. Sn_DIPR/Sn_DPORT
+    // are only written when the destination changes.
+    bool txCommitTo(uint8_t socket, W5500Window& window, uint16_t len, const uint8_t* ip, uint16_t port);
+    // The previous SEND has finished (SEND_OK or TIMEOUT)
+    bool txReady(uint8_t socket);
+    // Sn_DIPR/Sn_DPORT were written outside txCommitTo
+    void forgetDestination(uint8_t socket) { if (socket < W5500_SOCKETS) destValid_[socket] = false; }
+
+    // Copying calls built on the windows. send/recv return bytes moved
+    // (0 = nothing to do now), -1 on error.
+    int32_t send(uint8_t socket, const uint8_t* data, uint16_t len);
+    int32_t recv(uint8_t socket, uint8_t* data, uint16_t len);
+    // UDP: head and data go out as one datagram, gathered in the chip
+    int32_t sendTo(uint8_t socket, const uint8_t* head, uint16_t headLen,
+                   const uint8_t* data, uint16_t len, const uint8_t* ip, uint16_t port);
+    // UDP: one datagram; a payload longer than len is truncated and discarded
+    int32_t recvFrom(uint8_t socket, uint8_t* data, uint16_t len, uint8_t* ip, uint16_t& port);
+
+    // Buffer layout of len bytes from ptr
+    static void setSpans(W5500Window& window, uint16_t bufferSize);
+
+private:
+    W5500Bus* bus_;
+    uint16_t rxSize_[W5500_SOCKETS];
+    uint16_t txSize_[W5500_SOCKETS];
+    bool sendPending_[W5500_SOCKETS];
+    uint8_t dest_[W5500_SOCKETS][6];    // Last Sn_DIPR + Sn_DPORT written
+    bool destValid_[W5500_SOCKETS];
+
+    bool command(uint8_t socket, uint8_t cmd);
+};
+
+} // namespace PocketOS
+
+#endif // POCKETOS_W5500_SOCKET_H
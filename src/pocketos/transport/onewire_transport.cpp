@@ -1,5 +1,6 @@
 #include "onewire_transport.h"
 #include "../core/logger.h"
+#include "../core/crc.h"
 
 #ifdef ARDUINO_ARCH_ESP32
 #include <OneWire.h>
@@ -30,7 +31,7 @@ void OneWireROM::print() const {
     char buffer[32];
     snprintf(buffer, sizeof(buffer), "%02X:%02X%02X%02X%02X%02X%02X:%02X",
              family_code, serial[0], serial[1], serial[2], serial[3], serial[4], serial[5], crc);
-    Logger::info("OneWire ROM: %s", buffer);
+    Logger::info((String("OneWire ROM: ") + buffer).c_str());
 }
 
 OneWireTransport::OneWireTransport() 
@@ -53,9 +54,9 @@ OneWireError OneWireTransport::init(const OneWireConfig& config) {
     OneWireError result = platformInit();
     if (result == OneWireError::OK) {
         initialized_ = true;
-        Logger::info("OneWire initialized on pin %d", config_.pin);
+        Logger::info(("OneWire initialized on pin " + String(config_.pin)).c_str());
     } else {
-        Logger::error("OneWire init failed on pin %d", config_.pin);
+        Logger::error(("OneWire init failed on pin " + String(config_.pin)).c_str());
     }
     
     return result;
@@ -201,7 +202,7 @@ OneWireError OneWireTransport::readTemperature(const OneWireROM& rom, float* tem
     
     // Only works with DS18B20 family (0x28)
     if (rom.family_code != 0x28) {
-        Logger::warn("OneWire device 0x%02X is not DS18B20", rom.family_code);
+        Logger::warning(("OneWire device 0x" + String(rom.family_code, HEX) + " is not DS18B20").c_str());
         return OneWireError::BUS_ERROR;
     }
     
@@ -219,7 +220,7 @@ OneWireError OneWireTransport::readTemperature(const OneWireROM& rom, float* tem
     
     // Verify CRC
     if (crc8(data, 8) != data[8]) {
-        Logger::warn("OneWire temperature read CRC error");
+        Logger::warning("OneWire temperature read CRC error");
         return OneWireError::CRC_ERROR;
     }
     
@@ -231,19 +232,7 @@ OneWireError OneWireTransport::readTemperature(const OneWireROM& rom, float* tem
 }
 
 uint8_t OneWireTransport::crc8(const uint8_t* data, size_t length) {
-    uint8_t crc = 0;
-    
-    for (size_t i = 0; i < length; i++) {
-        uint8_t byte = data[i];
-        for (int bit = 0; bit < 8; bit++) {
-            uint8_t mix = (crc ^ byte) & 0x01;
-            crc >>= 1;
-            if (mix) crc ^= 0x8C;
-            byte >>= 1;
-        }
-    }
-    
-    return crc;
+    return Crc::crc8Maxim(data, length);
 }
 
 // Platform-specific initialization
@@ -0,0 +1,388 @@
+/*
+ * ahrsbench - AHRS filter accuracy and throughput (host tool)
+ *
+ * Runs the four AHRS variants (src/pocketos/drivers/ahrs_filter.h:
+ * Madgwick and Mahony, float and Q24 fixed point) over reference datasets
+ * and reports attitude error against the truth and updates per second.
+ *
+ * The built-in datasets are synthesised from an analytic trajectory:
+ * sensor readings are the true gravity and field rotated into the sensor
+ * frame, in raw counts, with noise and a constant gyroscope bias
+ * (4096 LSB/g, 65.5 LSB/dps, 6.6 LSB/uT, 200 Hz):
+ *
+ *   static  level and still
+ *   tilt    roll +/-40 deg, pitch +/-25 deg swings, yaw 20 deg/s
+ *   spin    yaw 360 deg/s with a 20 deg roll wobble
+ *
+ * Each dataset is fused with the magnetometer (9-axis: full attitude
+ * error) and without (6-axis: tilt error only, yaw is unobservable).
+ * Errors are RMS and maximum after the settle time. "vs float" is the
+ * largest angle between a fixed-point estimate and the float estimate of
+ * the same algorithm.
+ *
+ * Build (from the repository root):
+ *   g++ -O2 -std=c++17 -Isrc -o ahrsbench tools/ahrsbench/ahrsbench.cpp \
+ *       src/pocketos/drivers/ahrs_filter.cpp
+ *
+ * Usage:
+ *   ahrsbench [-b beta] [-p kp] [-i ki] [-s settle_s] [-f data.csv [-g rad_per_count]]
+ *
+ * A recorded dataset (-f) is CSV with one sample per line:
+ *   t_us,ax,ay,az,gx,gy,gz,mx,my,mz[,qw,qx,qy,qz]
+ * in raw counts; mag all zero = 6-axis. With the reference quaternion
+ * columns the errors are reported, otherwise the final attitude.
+ *
+ * Host throughput only ranks the variants; on an FPU-less core (ESP8266)
+ * use AhrsService::benchmark() on the target.
+ */
+
+#include "pocketos/drivers/ahrs_filter.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace PocketOS;
+
+static const double DEG = M_PI / 180.0;
+
+static const double ACCEL_LSB_PER_G = 4096.0;
+static const double GYRO_LSB_PER_DPS = 65.5;
+static const double MAG_LSB_PER_UT = 6.6;
+static const double RATE_HZ = 200.0;
+
+struct Quat {
+    double w, x, y, z;
+};
+
+static Quat mul(const Quat& a, const Quat& b) {
+    return { a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+             a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+             a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+             a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w };
+}
+
+static Quat conj(const Quat& q) {
+    return { q.w, -q.x, -q.y, -q.z };
+}
+
+// ZYX: sensor to earth
+static Quat fromEuler(double roll, double pitch, double yaw) {
+    Quat qx = { cos(roll / 2), sin(roll / 2), 0, 0 };
+    Quat qy = { cos(pitch / 2), 0, sin(pitch / 2), 0 };
+    Quat qz = { cos(yaw / 2), 0, 0, sin(yaw / 2) };
+    return mul(qz, mul(qy, qx));
+}
+
+// Earth-frame vector into the sensor frame
+static void toSensor(const Quat& q, const double e[3], double s[3]) {
+    Quat v = { 0, e[0], e[1], e[2] };
+    Quat r = mul(conj(q), mul(v, q));
+    s[0] = r.x;
+    s[1] = r.y;
+    s[2] = r.z;
+}
+
+// Angle between two attitudes (degrees)
+static double attitudeError(const Quat& a, const Quat& b) {
+    double d = fabs(a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z);
+    return 2.0 * acos(d > 1.0 ? 1.0 : d) / DEG;
+}
+
+// Angle between the two "up" directions (degrees)
+static double tiltError(const Quat& a, const Quat& b) {
+    const double up[3] = { 0, 0, 1 };
+    double ua[3], ub[3];
+    toSensor(a, up, ua);
+    toSensor(b, up, ub);
+    double d = ua[0] * ub[0] + ua[1] * ub[1] + ua[2] * ub[2];
+    return acos(d > 1.0 ? 1.0 : (d < -1.0 ? -1.0 : d)) / DEG;
+}
+
+struct Dataset {
+    std::string name;
+    std::vector<AhrsSample> samples;
+    std::vector<Quat> truth;
+    bool hasTruth;
+};
+
+typedef Quat (*Trajectory)(double t);
+
+static Quat trajStatic(double) {
+    return fromEuler(0, 0, 0);
+}
+
+static Quat trajTilt(double t) {
+    return fromEuler(40 * DEG * sin(2 * M_PI * 0.15 * t), 25 * DEG * sin(2 * M_PI * 0.11 * t), 20 * DEG * t);
+}
+
+static Quat trajSpin(double t) {
+    return fromEuler(20 * DEG * sin(2 * M_PI * 0.5 * t), 0, 360 * DEG * t);
+}
+
+static int32_t counts(double v) {
+    return (int32_t)lround(v);
+}
+
+static Dataset synthesise(const char* name, Trajectory traj, double seconds, bool withMag, uint32_t seed) {
+    Dataset d;
+    d.name = name;
+    d.hasTruth = true;
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> accelNoise(0, 0.003);     // g
+    std::normal_distribution<double> gyroNoise(0, 0.05);       // dps
+    std::normal_distribution<double> magNoise(0, 0.3);         // uT
+    const double gyroBias[3] = { 0.2, -0.15, 0.1 };            // dps
+
+    // 50 uT, 60 degree inclination (field points down, north)
+    const double field[3] = { 50 * cos(60 * DEG), 0, -50 * sin(60 * DEG) };
+    const double gravity[3] = { 0, 0, 1 };
+    const double h = 1e-4;
+
+    size_t n = (size_t)(seconds * RATE_HZ);
+    for (size_t i = 0; i < n; i++) {
+        double t = i / RATE_HZ;
+        Quat q = traj(t);
+
+        // Body rate from q' = q (x) (0, w) / 2
+        Quat qa = traj(t + h), qb = traj(t - h);
+        Quat dq = { (qa.w - qb.w) / (2 * h), (qa.x - qb.x) / (2 * h), (qa.y - qb.y) / (2 * h),
+                    (qa.z - qb.z) / (2 * h) };
+        Quat w = mul(conj(q), dq);
+
+        double a[3], m[3];
+        toSensor(q, gravity, a);
+        toSensor(q, field, m);
+
+        AhrsSample s;
+        const double rate[3] = { 2 * w.x, 2 * w.y, 2 * w.z };
+        for (int k = 0; k < 3; k++) {
+            s.accel[k] = counts((a[k] + accelNoise(rng)) * ACCEL_LSB_PER_G);
+            s.gyro[k] = counts((rate[k] / DEG + gyroBias[k] + gyroNoise(rng)) * GYRO_LSB_PER_DPS);
+            s.mag[k] = withMag ? counts((m[k] + magNoise(rng)) * MAG_LSB_PER_UT) : 0;
+        }
+        s.timestampUs = (uint32_t)llround(t * 1e6);
+
+        d.samples.push_back(s);
+        d.truth.push_back(q);
+    }
+    return d;
+}
+
+static bool loadCsv(const char* path, Dataset& d) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    d.name = path;
+    d.hasTruth = true;
+
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        double v[14];
+        int n = 0;
+        char* p = line;
+        while (n < 14) {
+            char* end;
+            v[n] = strtod(p, &end);
+            if (end == p) {
+                break;
+            }
+            n++;
+            p = end;
+            while (*p == ',' || *p == ' ' || *p == '\t') {
+                p++;
+            }
+        }
+        if (n < 10) {
+            continue;   // Header or blank line
+        }
+
+        AhrsSample s;
+        s.timestampUs = (uint32_t)v[0];
+        for (int k = 0; k < 3; k++) {
+            s.accel[k] = (int32_t)v[1 + k];
+            s.gyro[k] = (int32_t)v[4 + k];
+            s.mag[k] = (int32_t)v[7 + k];
+        }
+        d.samples.push_back(s);
+        if (n >= 14) {
+            d.truth.push_back({ v[10], v[11], v[12], v[13] });
+        } else {
+            d.hasTruth = false;
+        }
+    }
+    fclose(f);
+    if (!d.hasTruth) {
+        d.truth.clear();
+    }
+    return !d.samples.empty();
+}
+
+static Quat run(AhrsFilter& filter, const Dataset& d, size_t i, uint32_t& lastUs) {
+    const AhrsSample& s = d.samples[i];
+    filter.update(s, i == 0 ? 0 : s.timestampUs - lastUs);
+    lastUs = s.timestampUs;
+    float q[4];
+    filter.quaternion(q);
+    return { q[0], q[1], q[2], q[3] };
+}
+
+struct Result {
+    double rms;
+    double max;
+    double vsFloat;
+    Quat final;
+};
+
+static Result evaluate(AhrsFilter& filter, AhrsFilter* reference, const Dataset& d, bool tiltOnly,
+                       double settleS) {
+    Result r = { 0, 0, 0, { 1, 0, 0, 0 } };
+    filter.reset();
+    if (reference) {
+        reference->reset();
+    }
+
+    uint32_t lastUs = 0, refLastUs = 0;
+    double sum = 0;
+    size_t count = 0;
+    uint32_t startUs = d.samples.empty() ? 0 : d.samples[0].timestampUs;
+
+    for (size_t i = 0; i < d.samples.size(); i++) {
+        Quat q = run(filter, d, i, lastUs);
+        r.final = q;
+        if (reference) {
+            Quat ref = run(*reference, d, i, refLastUs);
+            double e = attitudeError(q, ref);
+            if (e > r.vsFloat) {
+                r.vsFloat = e;
+            }
+        }
+        if (!d.hasTruth || (d.samples[i].timestampUs - startUs) < settleS * 1e6) {
+            continue;
+        }
+        double e = tiltOnly ? tiltError(q, d.truth[i]) : attitudeError(q, d.truth[i]);
+        sum += e * e;
+        count++;
+        if (e > r.max) {
+            r.max = e;
+        }
+    }
+    r.rms = count ? sqrt(sum / count) : 0;
+    return r;
+}
+
+static double throughput(AhrsFilter& filter, const Dataset& d) {
+    filter.reset();
+    uint32_t lastUs = 0;
+    size_t updates = 0;
+    volatile float sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < 0.5) {
+        for (size_t i = 0; i < d.samples.size(); i++) {
+            const AhrsSample& s = d.samples[i];
+            filter.update(s, i == 0 ? 5000 : s.timestampUs - lastUs);
+            lastUs = s.timestampUs;
+        }
+        float q[4];
+        filter.quaternion(q);
+        sink = sink + q[0];
+        updates += d.samples.size();
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return updates / elapsed;
+}
+
+int main(int argc, char** argv) {
+    AhrsGains gains;
+    double settleS = 5.0;
+    const char* csv = nullptr;
+    float gyroScale = (float)(DEG / GYRO_LSB_PER_DPS);
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+            gains.beta = strtof(argv[++i], nullptr);
+        } else if (!strcmp(argv[i], "-p") && i + 1 < argc) {
+            gains.kp = strtof(argv[++i], nullptr);
+        } else if (!strcmp(argv[i], "-i") && i + 1 < argc) {
+            gains.ki = strtof(argv[++i], nullptr);
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            settleS = strtod(argv[++i], nullptr);
+        } else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+            csv = argv[++i];
+        } else if (!strcmp(argv[i], "-g") && i + 1 < argc) {
+            gyroScale = strtof(argv[++i], nullptr);
+        } else {
+            fprintf(stderr, "usage: %s [-b beta] [-p kp] [-i ki] [-s settle_s] [-f data.csv [-g rad_per_count]]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    MadgwickAhrs madgwick;
+    MahonyAhrs mahony;
+    MadgwickAhrsQ madgwickQ;
+    MahonyAhrsQ mahonyQ;
+    AhrsFilter* filters[4] = { &madgwick, &madgwickQ, &mahony, &mahonyQ };
+    AhrsFilter* references[4] = { nullptr, &madgwick, nullptr, &mahony };
+    for (AhrsFilter* f : filters) {
+        f->configure(gyroScale, gains);
+    }
+
+    printf("beta %.3f  kp %.3f  ki %.3f  settle %.1f s\n\n", gains.beta, gains.kp, gains.ki, settleS);
+
+    std::vector<Dataset> sets;
+    if (csv) {
+        Dataset d;
+        if (!loadCsv(csv, d)) {
+            fprintf(stderr, "%s: no samples\n", csv);
+            return 1;
+        }
+        sets.push_back(d);
+    } else {
+        sets.push_back(synthesise("static/9", trajStatic, 60, true, 1));
+        sets.push_back(synthesise("static/6", trajStatic, 60, false, 1));
+        sets.push_back(synthesise("tilt/9", trajTilt, 60, true, 2));
+        sets.push_back(synthesise("tilt/6", trajTilt, 60, false, 2));
+        sets.push_back(synthesise("spin/9", trajSpin, 30, true, 3));
+        sets.push_back(synthesise("spin/6", trajSpin, 30, false, 3));
+    }
+
+    printf("%-12s %-11s %9s %9s %10s\n", "dataset", "filter", "rms deg", "max deg", "vs float");
+    for (const Dataset& d : sets) {
+        bool sixAxis = !d.samples.empty() && d.samples[0].mag[0] == 0 && d.samples[0].mag[1] == 0 &&
+                       d.samples[0].mag[2] == 0;
+        for (int k = 0; k < 4; k++) {
+            Result r = evaluate(*filters[k], references[k], d, sixAxis, settleS);
+            if (d.hasTruth) {
+                printf("%-12s %-11s %9.3f %9.3f", d.name.c_str(), filters[k]->name(), r.rms, r.max);
+            } else {
+                float q[4] = { (float)r.final.w, (float)r.final.x, (float)r.final.y, (float)r.final.z };
+                float roll, pitch, yaw;
+                ahrsEuler(q, roll, pitch, yaw);
+                printf("%-12s %-11s  roll %.2f pitch %.2f yaw %.2f", d.name.c_str(), filters[k]->name(), roll,
+                       pitch, yaw);
+            }
+            if (references[k]) {
+                printf(" %10.4f", r.vsFloat);
+            }
+            printf("\n");
+        }
+    }
+
+    printf("\n%-11s %14s\n", "filter", "updates/s");
+    const Dataset& bench = sets.size() > 2 ? sets[2] : sets[0];
+    for (AhrsFilter* f : filters) {
+        printf("%-11s %14.0f\n", f->name(), throughput(*f, bench));
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+/*
+ * filterbench - signal filter correctness, output volume and cost (host tool)
+ *
+ * Checks each stage of src/pocketos/core/signal_filter.h against a direct
+ * (window re-scanning) implementation over a noisy random-walk signal:
+ *
+ *   avg:N      mean of the last N samples
+ *   median:N   middle of the sorted last N samples
+ *   ema:A      y += A * (x - y)
+ *   decimate:N block means, one output per N samples
+ *   deadband:D no output closer than D to the previous output
+ *
+ * plus spec parsing (accepted and rejected specs). Then it reports how many
+ * samples each chain lets through, i.e. the telemetry volume left after
+ * `param set <id> filter.<signal> <spec>`, and the cost per sample.
+ *
+ * Build (from the repository root):
+ *   g++ -O2 -std=c++11 -Isrc -o filterbench tools/filterbench/filterbench.cpp \
+ *       src/pocketos/core/signal_filter.cpp
+ */
+
+#include "pocketos/core/signal_filter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace PocketOS;
+
+static int failures = 0;
+static volatile float sink;  // Keeps the timed loop from being optimised out
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+// 20 C room temperature: slow drift plus +-0.05 C sensor noise
+static std::vector<float> makeSignal(size_t n) {
+    std::vector<float> x(n);
+    srand(1);
+    double level = 20.0;
+    for (size_t i = 0; i < n; i++) {
+        level += ((rand() % 2001) - 1000) * 1e-5;
+        x[i] = (float)(level + ((rand() % 1001) - 500) * 1e-4);
+    }
+    return x;
+}
+
+static void checkAverage(const std::vector<float>& x, int n) {
+    SignalFilter f;
+    char spec[16];
+    snprintf(spec, sizeof(spec), "avg:%d", n);
+    f.configure(spec);
+    double worst = 0;
+    for (size_t i = 0; i < x.size(); i++) {
+        float out;
+        f.process(x[i], out);
+        size_t from = i + 1 >= (size_t)n ? i + 1 - n : 0;
+        double sum = 0;
+        for (size_t k = from; k <= i; k++) sum += x[k];
+        worst = std::max(worst, std::fabs(out - sum / (i + 1 - from)));
+    }
+    // The running sum is re-summed every window, so error stays at float epsilon
+    check(worst < 1e-4, spec);
+}
+
+static void checkMedian(const std::vector<float>& x, int n) {
+    SignalFilter f;
+    char spec[16];
+    snprintf(spec, sizeof(spec), "median:%d", n);
+    f.configure(spec);
+    bool same = true;
+    for (size_t i = 0; i < x.size(); i++) {
+        float out;
+        f.process(x[i], out);
+        size_t from = i + 1 >= (size_t)n ? i + 1 - n : 0;
+        std::vector<float> w(x.begin() + from, x.begin() + i + 1);
+        std::sort(w.begin(), w.end());
+        size_t m = w.size();
+        float want = (m & 1) ? w[m / 2] : 0.5f * (w[m / 2 - 1] + w[m / 2]);
+        same = same && out == want;
+    }
+    check(same, spec);
+}
+
+static void checkEmaDecimateDeadband(const std::vector<float>& x) {
+    SignalFilter f;
+    f.configure("ema:0.2");
+    float y = x[0];
+    bool same = true;
+    for (size_t i = 0; i < x.size(); i++) {
+        float out;
+        f.process(x[i], out);
+        if (i > 0) y += 0.2f * (x[i] - y);
+        same = same && out == y;
+    }
+    check(same, "ema:0.2");
+
+    f.configure("decimate:10");
+    size_t outputs = 0;
+    same = true;
+    for (size_t i = 0; i < x.size(); i++) {
+        float out;
+        if (f.process(x[i], out)) {
+            float sum = 0;
+            for (size_t k = i - 9; k <= i; k++) sum += x[k];
+            same = same && std::fabs(out - sum / 10) < 1e-4 && i % 10 == 9;
+            outputs++;
+        }
+    }
+    check(same && outputs == x.size() / 10, "decimate:10");
+
+    f.configure("deadband:0.1");
+    float last = 0;
+    bool first = true;
+    same = true;
+    for (size_t i = 0; i < x.size(); i++) {
+        float out;
+        bool emitted = f.process(x[i], out);
+        bool want = first || std::fabs(x[i] - last) >= 0.1f;
+        same = same && emitted == want;
+        if (want) {
+            last = x[i];
+            first = false;
+        }
+    }
+    check(same, "deadband:0.1");
+}
+
+static void checkParsing() {
+    const char* good[] = { "none", "avg:1", "avg:16", "median:9", "ema:1", "ema:0.05",
+                           "decimate:255", "deadband:0", "median:5,ema:0.2,deadband:0.05" };
+    const char* bad[] = { "", "avg", "avg:0", "avg:17", "median:10", "ema:0", "ema:1.5",
+                          "ema:x", "deadband:-1", "decimate:256", "avg:4,", "lowpass:3",
+                          "avg:2,avg:2,avg:2,avg:2" };
+    for (const char* s : good) check(SignalFilter::validate(s), s);
+    for (const char* s : bad) check(!SignalFilter::validate(s), s);
+
+    SignalFilter f;
+    f.configure("ema:0.5");
+    check(!f.configure("bogus") && f.stageCount() == 1, "bad spec keeps chain");
+    float out;
+    check(!f.process(NAN, out), "NaN dropped");
+}
+
+int main() {
+    std::vector<float> x = makeSignal(20000);
+
+    checkParsing();
+    for (int n : { 1, 2, 5, 16 }) checkAverage(x, n);
+    for (int n : { 1, 2, 3, 5, 9 }) checkMedian(x, n);
+    checkEmaDecimateDeadband(x);
+    printf("correctness: %s\n\n", failures ? "FAILED" : "ok");
+
+    const char* chains[] = { "none", "avg:8", "median:5", "ema:0.2", "decimate:10",
+                             "deadband:0.05", "ema:0.2,deadband:0.05",
+                             "median:5,ema:0.2,deadband:0.05" };
+    printf("%-32s %10s %8s %10s\n", "chain", "outputs", "volume", "ns/sample");
+    for (const char* spec : chains) {
+        SignalFilter f;
+        f.configure(spec);
+        size_t outputs = 0;
+        float out;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int rep = 0; rep < 50; rep++) {
+            f.reset();
+            outputs = 0;
+            for (float v : x) {
+                if (f.process(v, out)) {
+                    outputs++;
+                    sink = out;
+                }
+            }
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() /
+                    (50.0 * x.size());
+        printf("%-32s %10zu %7.1f%% %10.1f\n", spec, outputs, 100.0 * outputs / x.size(), ns);
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,618 @@
+/*
+ * gfxcheck - 2D renderer scene checks and draw-call benchmark (host tool)
+ *
+ * Renders fixed scenes through GfxRenderer into a GfxMemorySurface and
+ * checks each one two ways (exit status 1 on any failure):
+ * - pixel-exact against a per-pixel reference rasterizer in this file
+ *   (one setPixel per covered pixel, same rasterization rules, same clip)
+ * - against the committed FNV-1a checksum of the scene in GOLDEN below,
+ *   so a change that alters both the renderer and the reference still
+ *   shows up
+ *
+ * Then benchmarks each primitive on a 240x320 surface: panel calls and
+ * pixels per primitive (against one call per pixel for a setPixel-only
+ * driver) and host time per primitive.
+ *
+ * Build (from the repository root):
+ *   g++ -O2 -std=c++11 -Isrc -o gfxcheck tools/gfxcheck/gfxcheck.cpp \
+ *       src/pocketos/drivers/gfx_renderer.cpp src/pocketos/drivers/gfx_surface.cpp \
+ *       src/pocketos/drivers/gfx_font.cpp src/pocketos/drivers/gfx_image.cpp
+ *
+ * Usage:
+ *   gfxcheck [-w dir] [-u] [-n rounds]
+ *     -w dir     write every scene as dir/<scene>.ppm
+ *     -u         print the GOLDEN table for the current renderer
+ *     -n rounds  benchmark rounds (default 200)
+ *
+ * After an intended rendering change: check the PPMs, then paste the -u
+ * output over GOLDEN.
+ */
+
+#include "pocketos/drivers/gfx_renderer.h"
+#include "pocketos/drivers/gfx_surface.h"
+#include "pocketos/drivers/gfx_image.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace PocketOS;
+
+static const uint16_t SCENE_W = 160;
+static const uint16_t SCENE_H = 128;
+static const uint16_t BACKGROUND = 0x0841;
+
+static const uint16_t BLACK = 0x0000;
+static const uint16_t RED = 0xF800;
+static const uint16_t GREEN = 0x07E0;
+static const uint16_t BLUE = 0x001F;
+static const uint16_t WHITE = 0xFFFF;
+static const uint16_t YELLOW = 0xFFE0;
+static const uint16_t CYAN = 0x07FF;
+
+// ---------------------------------------------------------------------------
+// Test images
+
+// 24x16 gradient for blit()
+static uint16_t gradient[24 * 16];
+
+static void makeGradient() {
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 24; x++) {
+            gradient[y * 24 + x] = (uint16_t)(((x * 31 / 23) << 11) | ((y * 63 / 15) << 5) | ((x + y) & 31));
+        }
+    }
+}
+
+// RLE565 12x4: a run crossing the first row end, a literal, a run to the end
+static const uint8_t PIMG_RLE[] = {
+    'P', 'I', 'M', 'G', 1, GFX_IMAGE_RLE565, 12, 0, 4, 0, 0, 0,
+    0x80 | 19, 0x00, 0xF8,                                          // 20 x red
+    0x05, 0x1F, 0x00, 0xE0, 0x07, 0xFF, 0xFF, 0x00, 0x00,
+          0x1F, 0x00, 0xE0, 0x07,                                   // 6 literals
+    0x80 | 21, 0xE0, 0x07,                                          // 22 x green
+};
+static const uint16_t PIMG_RLE_PIXELS_LITERAL[6] = { BLUE, GREEN, WHITE, BLACK, BLUE, GREEN };
+
+// INDEXED 20x3, 2-entry palette: long-count run of 30, then 30 alternating
+static const uint8_t PIMG_INDEXED[] = {
+    'P', 'I', 'M', 'G', 1, GFX_IMAGE_INDEXED, 20, 0, 3, 0, 2, 0,
+    0xE0, 0xFF, 0x1F, 0xF8,                                         // palette: yellow, magenta
+    0x80 | 0x40 | 0, 29, 0x00,                                      // 30 x index 0 (long count)
+    29, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,
+        0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1,                   // 30 literals
+};
+
+static void pimgRLEPixels(std::vector<uint16_t>& out) {
+    out.assign(48, GREEN);
+    for (int i = 0; i < 20; i++) out[i] = RED;
+    for (int i = 0; i < 6; i++) out[20 + i] = PIMG_RLE_PIXELS_LITERAL[i];
+}
+
+static void pimgIndexedPixels(std::vector<uint16_t>& out) {
+    out.assign(60, YELLOW);
+    for (int i = 30; i < 60; i++) out[i] = (i & 1) ? 0xF81F : YELLOW;
+}
+
+// ---------------------------------------------------------------------------
+// Reference rasterizer: one pixel at a time, no runs
+
+class RefCanvas {
+public:
+    RefCanvas(uint16_t w, uint16_t h) : w_(w), h_(h), px_((size_t)w * h, 0) { resetClip(); }
+
+    const std::vector<uint16_t>& pixels() const { return px_; }
+
+    void setClip(int x, int y, int w, int h) {
+        x0_ = x < 0 ? 0 : x;
+        y0_ = y < 0 ? 0 : y;
+        x1_ = x + w > w_ ? w_ : x + w;
+        y1_ = y + h > h_ ? h_ : y + h;
+    }
+    void resetClip() { x0_ = 0; y0_ = 0; x1_ = w_; y1_ = h_; }
+
+    void pixel(int x, int y, uint16_t c) {
+        if (x >= x0_ && x < x1_ && y >= y0_ && y < y1_) {
+            px_[(size_t)y * w_ + x] = c;
+        }
+    }
+
+    void fillRect(int x, int y, int w, int h, uint16_t c) {
+        for (int j = 0; j < h; j++)
+            for (int i = 0; i < w; i++) pixel(x + i, y + j, c);
+    }
+
+    void drawRect(int x, int y, int w, int h, uint16_t c) {
+        if (w <= 0 || h <= 0) return;
+        for (int i = 0; i < w; i++) { pixel(x + i, y, c); pixel(x + i, y + h - 1, c); }
+        for (int j = 0; j < h; j++) { pixel(x, y + j, c); pixel(x + w - 1, y + j, c); }
+    }
+
+    // Classic per-pixel Bresenham, error term starting at dx / 2
+    void line(int x0, int y0, int x1, int y1, uint16_t c) {
+        bool steep = abs(y1 - y0) > abs(x1 - x0);
+        if (steep) { std::swap(x0, y0); std::swap(x1, y1); }
+        if (x0 > x1) { std::swap(x0, x1); std::swap(y0, y1); }
+        int dx = x1 - x0;
+        int dy = abs(y1 - y0);
+        int err = dx / 2;
+        int ystep = y0 < y1 ? 1 : -1;
+        for (; x0 <= x1; x0++) {
+            if (steep) pixel(y0, x0, c); else pixel(x0, y0, c);
+            err -= dy;
+            if (err < 0) { y0 += ystep; err += dx; }
+        }
+    }
+
+    // Midpoint circle, eight mirrored points per step
+    void circlePoints(int cx, int cy, int r, std::vector<std::pair<int, int> >& pts) {
+        pts.clear();
+        if (r < 0) return;
+        int f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+        pts.push_back(std::make_pair(cx, cy + r));
+        pts.push_back(std::make_pair(cx, cy - r));
+        pts.push_back(std::make_pair(cx + r, cy));
+        pts.push_back(std::make_pair(cx - r, cy));
+        while (x < y) {
+            if (f >= 0) { y--; ddy += 2; f += ddy; }
+            x++; ddx += 2; f += ddx;
+            int px[8] = { cx + x, cx - x, cx + x, cx - x, cx + y, cx - y, cx + y, cx - y };
+            int py[8] = { cy + y, cy + y, cy - y, cy - y, cy + x, cy + x, cy - x, cy - x };
+            for (int i = 0; i < 8; i++) pts.push_back(std::make_pair(px[i], py[i]));
+        }
+    }
+
+    void circle(int cx, int cy, int r, uint16_t c) {
+        std::vector<std::pair<int, int> > pts;
+        circlePoints(cx, cy, r, pts);
+        for (size_t i = 0; i < pts.size(); i++) pixel(pts[i].first, pts[i].second, c);
+    }
+
+    // Filled circle: each row from its leftmost to its rightmost outline pixel
+    void fillCircle(int cx, int cy, int r, uint16_t c) {
+        std::vector<std::pair<int, int> > pts;
+        circlePoints(cx, cy, r, pts);
+        for (int y = cy - r; y <= cy + r; y++) {
+            int lo = 1 << 30, hi = -(1 << 30);
+            for (size_t i = 0; i < pts.size(); i++) {
+                if (pts[i].second != y) continue;
+                if (pts[i].first < lo) lo = pts[i].first;
+                if (pts[i].first > hi) hi = pts[i].first;
+            }
+            for (int x = lo; x <= hi; x++) pixel(x, y, c);
+        }
+    }
+
+    void blit(int x, int y, int w, int h, const uint16_t* src) {
+        for (int j = 0; j < h; j++)
+            for (int i = 0; i < w; i++) pixel(x + i, y + j, src[j * w + i]);
+    }
+
+    // Text with GFX_FONT_5X7; bg < 0 = transparent
+    int text(int x, int y, const char* s, uint16_t fg, int bg, int scale) {
+        const GfxFont& f = GFX_FONT_5X7;
+        int startX = x;
+        for (; *s; s++) {
+            if (*s == '\n') { x = startX; y += f.lineHeight * scale; continue; }
+            if (bg >= 0) fillRect(x, y, f.advance * scale, f.lineHeight * scale, (uint16_t)bg);
+            const uint8_t* cols = f.glyph(*s);
+            for (int col = 0; cols && col < f.glyphWidth; col++)
+                for (int row = 0; row < f.glyphHeight; row++)
+                    if (cols[col] & (1 << row)) fillRect(x + col * scale, y + row * scale, scale, scale, fg);
+            x += f.advance * scale;
+        }
+        return x;
+    }
+
+private:
+    int w_, h_;
+    int x0_, y0_, x1_, y1_;
+    std::vector<uint16_t> px_;
+};
+
+// ---------------------------------------------------------------------------
+// Scenes: the same drawing on the renderer and on the reference
+
+struct Scene {
+    const char* name;
+    void (*draw)(GfxRenderer& gfx, RefCanvas& ref);
+};
+
+static void sceneLines(GfxRenderer& gfx, RefCanvas& ref) {
+    // Fan from the centre to points on a ring well outside the surface,
+    // so every octant and both clipped ends are covered
+    const int cx = 80, cy = 64;
+    for (int i = 0; i < 48; i++) {
+        int a = i * 7;
+        int ex = cx + (int)((a % 97) * 4 - 190);
+        int ey = cy + (int)(((a * 13) % 89) * 3 - 130);
+        uint16_t c = (uint16_t)(0x1111 * (i % 15 + 1));
+        gfx.drawLine(cx, cy, ex, ey, c);
+        ref.line(cx, cy, ex, ey, c);
+    }
+    // Reversed endpoints, degenerate and axis-aligned lines
+    const int L[][4] = {
+        { 150, 10, 10, 20 }, { 10, 120, 12, 2 }, { 40, 40, 40, 40 },
+        { 5, 100, 155, 100 }, { 155, 104, 5, 104 }, { 120, 5, 120, 125 }, { 124, 125, 124, 5 },
+        { -20, -20, 180, 150 }, { 0, 127, 159, 0 },
+    };
+    for (size_t i = 0; i < sizeof(L) / sizeof(L[0]); i++) {
+        gfx.drawLine(L[i][0], L[i][1], L[i][2], L[i][3], WHITE);
+        ref.line(L[i][0], L[i][1], L[i][2], L[i][3], WHITE);
+    }
+    gfx.drawHLine(-10, 2, 50, RED);       ref.fillRect(-10, 2, 50, 1, RED);
+    gfx.drawVLine(158, 100, 60, GREEN);   ref.fillRect(158, 100, 1, 60, GREEN);
+    gfx.drawPixel(159, 127, CYAN);        ref.pixel(159, 127, CYAN);
+    gfx.drawPixel(160, 0, CYAN);          // Off-surface: no effect
+}
+
+static void sceneRects(GfxRenderer& gfx, RefCanvas& ref) {
+    const int R[][4] = {
+        { 4, 4, 30, 20 }, { -10, 30, 40, 12 }, { 140, 110, 40, 40 }, { 50, 4, 1, 1 },
+        { 54, 4, 1, 10 }, { 58, 4, 10, 1 }, { 70, 4, 2, 2 }, { 76, 4, 3, 3 }, { 90, 4, 0, 10 }, { 94, 4, 10, -3 },
+    };
+    for (size_t i = 0; i < sizeof(R) / sizeof(R[0]); i++) {
+        uint16_t c = (uint16_t)(0x2345 * (i + 1));
+        gfx.fillRect(R[i][0], R[i][1] + 40, R[i][2], R[i][3], c);
+        ref.fillRect(R[i][0], R[i][1] + 40, R[i][2], R[i][3], c);
+        gfx.drawRect(R[i][0], R[i][1], R[i][2], R[i][3], WHITE);
+        ref.drawRect(R[i][0], R[i][1], R[i][2], R[i][3], WHITE);
+    }
+}
+
+static void sceneCircles(GfxRenderer& gfx, RefCanvas& ref) {
+    for (int r = 0; r <= 13; r++) {
+        int cx = 8 + (r % 7) * 22 + r / 2;
+        int cy = 12 + (r / 7) * 28;
+        gfx.drawCircle(cx, cy, r, WHITE);
+        ref.circle(cx, cy, r, WHITE);
+        gfx.fillCircle(cx, cy + 56, r, (uint16_t)(0x0F0F + r * 0x1000));
+        ref.fillCircle(cx, cy + 56, r, (uint16_t)(0x0F0F + r * 0x1000));
+    }
+    // Large and partly off-surface
+    gfx.drawCircle(150, 120, 40, YELLOW);     ref.circle(150, 120, 40, YELLOW);
+    gfx.fillCircle(-5, 64, 30, RED);          ref.fillCircle(-5, 64, 30, RED);
+    gfx.drawCircle(80, 64, 100, CYAN);        ref.circle(80, 64, 100, CYAN);
+    gfx.drawCircle(80, 64, -1, CYAN);         // Negative radius: nothing
+}
+
+static void sceneText(GfxRenderer& gfx, RefCanvas& ref) {
+    const char* line = "PocketOS 0.9 {gfx}\n~!@#$%^&*()";
+    gfx.setTextScale(1);
+    gfx.setTextColor(WHITE, BLUE);
+    gfx.drawText(2, 2, line);
+    ref.text(2, 2, line, WHITE, BLUE, 1);
+
+    gfx.setTextColor(YELLOW);
+    gfx.drawText(2, 22, line);
+    ref.text(2, 22, line, YELLOW, -1, 1);
+
+    // Scale 2 fits the glyph cache, scale 3 takes the uncached path
+    gfx.setTextScale(2);
+    gfx.setTextColor(BLACK, GREEN);
+    gfx.drawText(-4, 42, "Ag\x01z");
+    ref.text(-4, 42, "Ag\x01z", BLACK, GREEN, 2);
+
+    gfx.setTextScale(3);
+    gfx.setTextColor(RED, WHITE);
+    gfx.drawText(100, 60, "W9");
+    ref.text(100, 60, "W9", RED, WHITE, 3);
+
+    gfx.setTextColor(CYAN);
+    gfx.drawText(4, 100, "3x");
+    ref.text(4, 100, "3x", CYAN, -1, 3);
+    gfx.setTextScale(1);
+}
+
+static void sceneBlit(GfxRenderer& gfx, RefCanvas& ref) {
+    const int P[][2] = { { 10, 10 }, { -8, 40 }, { 40, -6 }, { 145, 60 }, { 80, 118 }, { -30, -30 } };
+    for (size_t i = 0; i < sizeof(P) / sizeof(P[0]); i++) {
+        gfx.blit(P[i][0], P[i][1], 24, 16, gradient);
+        ref.blit(P[i][0], P[i][1], 24, 16, gradient);
+    }
+}
+
+static bool drawPIMG(GfxRenderer& gfx, RefCanvas& ref, int x, int y) {
+    std::vector<uint16_t> px;
+    pimgRLEPixels(px);
+    ref.blit(x, y, 12, 4, px.data());
+    bool ok = gfx.drawCompressedImage(x, y, PIMG_RLE, sizeof(PIMG_RLE));
+    pimgIndexedPixels(px);
+    ref.blit(x, y + 6, 20, 3, px.data());
+    return gfx.drawCompressedImage(x, y + 6, PIMG_INDEXED, sizeof(PIMG_INDEXED)) && ok;
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char* scene, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s: %s\n", scene, what);
+        failures++;
+    }
+}
+
+static void scenePIMG(GfxRenderer& gfx, RefCanvas& ref) {
+    check(drawPIMG(gfx, ref, 10, 10), "pimg", "decode at (10,10)");
+    check(drawPIMG(gfx, ref, -6, 60), "pimg", "decode clipped left");
+    check(drawPIMG(gfx, ref, 150, 122), "pimg", "decode clipped right/bottom");
+
+    // Truncated stream: reported as an error. The run before it is drawn;
+    // the literals are still buffered when the bad packet is hit and are not.
+    check(!gfx.drawCompressedImage(0, 0, PIMG_RLE, sizeof(PIMG_RLE) - 2), "pimg", "truncated image rejected");
+    ref.fillRect(0, 0, 12, 1, RED);
+    ref.fillRect(0, 1, 8, 1, RED);
+}
+
+static void sceneClip(GfxRenderer& gfx, RefCanvas& ref) {
+    gfx.setClip(20, 16, 100, 80);
+    ref.setClip(20, 16, 100, 80);
+    gfx.fillScreen(BLUE);                     ref.fillRect(0, 0, SCENE_W, SCENE_H, BLUE);
+    sceneLines(gfx, ref);
+    gfx.fillCircle(20, 16, 25, RED);          ref.fillCircle(20, 16, 25, RED);
+    gfx.drawCircle(110, 90, 20, WHITE);       ref.circle(110, 90, 20, WHITE);
+    gfx.blit(100, 80, 24, 16, gradient);      ref.blit(100, 80, 24, 16, gradient);
+    gfx.setTextColor(YELLOW, BLACK);
+    gfx.drawText(10, 40, "clipped text");     ref.text(10, 40, "clipped text", YELLOW, BLACK, 1);
+    drawPIMG(gfx, ref, 112, 50);
+
+    // Clip partly outside the surface
+    gfx.setClip(-10, 100, 40, 100);
+    ref.setClip(-10, 100, 40, 100);
+    gfx.fillCircle(20, 110, 15, GREEN);       ref.fillCircle(20, 110, 15, GREEN);
+    gfx.resetClip();
+    ref.resetClip();
+}
+
+static const Scene SCENES[] = {
+    { "lines", sceneLines },
+    { "rects", sceneRects },
+    { "circles", sceneCircles },
+    { "text", sceneText },
+    { "blit", sceneBlit },
+    { "pimg", scenePIMG },
+    { "clip", sceneClip },
+};
+
+// Committed checksums (FNV-1a over the RGB565 pixels, little-endian).
+// Regenerate with -u after an intended change.
+struct Golden {
+    const char* scene;
+    uint32_t fnv;
+};
+
+static const Golden GOLDEN[] = {
+    { "lines", 0x9B3AD2C7 },
+    { "rects", 0x48C71FEC },
+    { "circles", 0xF8B4B4E2 },
+    { "text", 0xBDE37E3F },
+    { "blit", 0xA9F8EE75 },
+    { "pimg", 0x59D0A8F5 },
+    { "clip", 0xB46788E2 },
+};
+
+// ---------------------------------------------------------------------------
+
+static uint32_t fnv1a(const uint16_t* px, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++) {
+        h = (h ^ (px[i] & 0xFF)) * 16777619u;
+        h = (h ^ (px[i] >> 8)) * 16777619u;
+    }
+    return h;
+}
+
+static size_t fileWrite(void* context, const uint8_t* data, size_t len) {
+    return fwrite(data, 1, len, (FILE*)context);
+}
+
+static bool writeScene(const std::string& dir, const char* name, const GfxMemorySurface& surface) {
+    std::string path = dir + "/" + name + ".ppm";
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        fprintf(stderr, "cannot write %s\n", path.c_str());
+        return false;
+    }
+    bool ok = surface.writePPM(fileWrite, f);
+    fclose(f);
+    return ok;
+}
+
+static void runScenes(const char* ppmDir, bool update) {
+    GfxMemorySurface surface;
+    if (!surface.begin(SCENE_W, SCENE_H)) {
+        check(false, "surface", "allocation");
+        return;
+    }
+
+    printf("%-8s %8s %8s %8s %8s %10s  %s\n", "scene", "spans", "rects", "writes", "pixels", "fnv1a", "result");
+    for (const Scene& scene : SCENES) {
+        GfxRenderer gfx(surface);
+        RefCanvas ref(SCENE_W, SCENE_H);
+        surface.clear(BACKGROUND);
+        ref.fillRect(0, 0, SCENE_W, SCENE_H, BACKGROUND);
+        surface.resetCounters();
+        scene.draw(gfx, ref);
+        gfx.flush();
+
+        // Pixel-exact against the reference
+        const uint16_t* got = surface.data();
+        const std::vector<uint16_t>& want = ref.pixels();
+        size_t bad = 0;
+        size_t first = 0;
+        for (size_t i = 0; i < want.size(); i++) {
+            if (got[i] != want[i] && bad++ == 0) {
+                first = i;
+            }
+        }
+        if (bad) {
+            char what[128];
+            snprintf(what, sizeof(what), "%zu pixels differ from the reference, first at (%zu,%zu): %04X != %04X",
+                     bad, first % SCENE_W, first / SCENE_W, got[first], want[first]);
+            check(false, scene.name, what);
+        }
+
+        // Committed checksum
+        uint32_t fnv = fnv1a(got, want.size());
+        const Golden* golden = nullptr;
+        for (const Golden& g : GOLDEN) {
+            if (!strcmp(g.scene, scene.name)) golden = &g;
+        }
+        if (!update) {
+            check(golden != nullptr, scene.name, "no committed checksum");
+            check(!golden || golden->fnv == fnv, scene.name, "checksum differs from GOLDEN");
+        }
+
+        const GfxStats& s = gfx.stats();
+        printf("%-8s %8u %8u %8u %8u   %08X  %s\n", scene.name, s.spans, s.rects, s.writes, s.pixels, fnv,
+               bad ? "reference mismatch" : (update || (golden && golden->fnv == fnv)) ? "ok" : "golden mismatch");
+        check(surface.spanCalls() == s.spans && surface.rectCalls() == s.rects && surface.writeCalls() == s.writes,
+              scene.name, "renderer stats match the calls the surface received");
+
+        if (ppmDir && !writeScene(ppmDir, scene.name, surface)) {
+            failures++;
+        }
+    }
+
+    if (update) {
+        printf("\nstatic const Golden GOLDEN[] = {\n");
+        for (const Scene& scene : SCENES) {
+            surface.clear(BACKGROUND);
+            GfxRenderer gfx(surface);
+            RefCanvas ref(SCENE_W, SCENE_H);
+            scene.draw(gfx, ref);
+            printf("    { \"%s\", 0x%08X },\n", scene.name, fnv1a(surface.data(), (size_t)SCENE_W * SCENE_H));
+        }
+        printf("};\n");
+    }
+    printf("\n");
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark: a fixed set of random primitives per kind
+
+struct Rng {
+    uint32_t s;
+    explicit Rng(uint32_t seed) : s(seed) {}
+    int range(int lo, int hi) {
+        s = s * 1664525u + 1013904223u;
+        return lo + (int)((s >> 8) % (uint32_t)(hi - lo + 1));
+    }
+};
+
+struct Bench {
+    const char* name;
+    void (*draw)(GfxRenderer& gfx, Rng& rng);
+};
+
+static void benchLine(GfxRenderer& g, Rng& r) { g.drawLine(r.range(-20, 259), r.range(-20, 339), r.range(-20, 259), r.range(-20, 339), (uint16_t)r.range(0, 0xFFFF)); }
+static void benchHLine(GfxRenderer& g, Rng& r) { g.drawHLine(r.range(0, 200), r.range(0, 319), r.range(1, 120), (uint16_t)r.range(0, 0xFFFF)); }
+static void benchVLine(GfxRenderer& g, Rng& r) { g.drawVLine(r.range(0, 239), r.range(0, 280), r.range(1, 120), (uint16_t)r.range(0, 0xFFFF)); }
+static void benchRect(GfxRenderer& g, Rng& r) { g.drawRect(r.range(0, 200), r.range(0, 280), r.range(2, 80), r.range(2, 80), (uint16_t)r.range(0, 0xFFFF)); }
+static void benchFillRect(GfxRenderer& g, Rng& r) { g.fillRect(r.range(0, 200), r.range(0, 280), r.range(2, 80), r.range(2, 80), (uint16_t)r.range(0, 0xFFFF)); }
+static void benchCircle(GfxRenderer& g, Rng& r) { g.drawCircle(r.range(20, 220), r.range(20, 300), r.range(4, 40), (uint16_t)r.range(0, 0xFFFF)); }
+static void benchFillCircle(GfxRenderer& g, Rng& r) { g.fillCircle(r.range(20, 220), r.range(20, 300), r.range(4, 40), (uint16_t)r.range(0, 0xFFFF)); }
+static void benchBlit(GfxRenderer& g, Rng& r) { g.blit(r.range(-10, 230), r.range(-10, 310), 24, 16, gradient); }
+static void benchPIMG(GfxRenderer& g, Rng& r) { g.drawCompressedImage(r.range(0, 220), r.range(0, 310), PIMG_INDEXED, sizeof(PIMG_INDEXED)); }
+
+static void benchTextOpaque(GfxRenderer& g, Rng& r) {
+    g.setTextScale(1);
+    g.setTextColor(WHITE, BLUE);
+    g.drawText(r.range(0, 170), r.range(0, 310), "Temp 21.4C");
+}
+
+static void benchTextTransparent(GfxRenderer& g, Rng& r) {
+    g.setTextScale(1);
+    g.setTextColor(WHITE);
+    g.drawText(r.range(0, 170), r.range(0, 310), "Temp 21.4C");
+}
+
+static const Bench BENCHES[] = {
+    { "drawLine", benchLine },
+    { "drawHLine", benchHLine },
+    { "drawVLine", benchVLine },
+    { "drawRect", benchRect },
+    { "fillRect", benchFillRect },
+    { "drawCircle", benchCircle },
+    { "fillCircle", benchFillCircle },
+    { "blit 24x16", benchBlit },
+    { "PIMG 20x3", benchPIMG },
+    { "text opaque", benchTextOpaque },
+    { "text transp.", benchTextTransparent },
+};
+
+static void runBenchmarks(int rounds) {
+    const int perRound = 100;
+    GfxMemorySurface surface;
+    if (!surface.begin(240, 320)) {
+        check(false, "benchmark", "surface allocation");
+        return;
+    }
+    GfxRenderer gfx(surface);
+
+    printf("240x320, %d primitives x %d rounds (per primitive: panel calls, pixels, host time)\n", perRound, rounds);
+    printf("%-13s %9s %9s %9s %10s %10s %10s\n", "primitive", "spans", "rects", "writes", "pixels", "calls/px", "ns");
+    for (const Bench& b : BENCHES) {
+        gfx.resetStats();
+        Rng rng(12345);
+        for (int i = 0; i < perRound; i++) {
+            b.draw(gfx, rng);
+        }
+        GfxStats s = gfx.stats();
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < rounds; k++) {
+            Rng timed(12345);
+            for (int i = 0; i < perRound; i++) {
+                b.draw(gfx, timed);
+            }
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / ((double)rounds * perRound);
+
+        // calls/px: panel calls against the one call per pixel a
+        // setPixel-only driver would take
+        uint32_t calls = s.spans + s.rects + s.writes;
+        printf("%-13s %9.1f %9.1f %9.1f %10.1f %10.3f %10.0f\n", b.name, (double)s.spans / perRound,
+               (double)s.rects / perRound, (double)s.writes / perRound, (double)s.pixels / perRound,
+               s.pixels ? (double)calls / s.pixels : 0.0, ns);
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    const char* ppmDir = nullptr;
+    bool update = false;
+    int rounds = 200;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-w") && i + 1 < argc) {
+            ppmDir = argv[++i];
+        } else if (!strcmp(argv[i], "-u")) {
+            update = true;
+        } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [-w dir] [-u] [-n rounds]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (rounds <= 0) {
+        fprintf(stderr, "rounds must be positive\n");
+        return 2;
+    }
+
+    makeGradient();
+    runScenes(ppmDir, update);
+    if (!update) {
+        runBenchmarks(rounds);
+    }
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,513 @@
+/*
+ * lorasim - LoRa airtime, duty cycle and radio queue model (host tool)
+ *
+ * Checks src/pocketos/drivers/lora_airtime.h, then runs a simulated radio
+ * network through the same queue and duty-cycle code as SX127xDriver:
+ *
+ *   airtime     loraAirtimeUs() against published time-on-air figures
+ *               and a floating-point transcription of the datasheet formula
+ *               for every SF, bandwidth, coding rate and payload length
+ *   duty        a sender that transmits whenever DutyCycleTracker allows.
+ *               It checks that no window of the configured length holds more
+ *               airtime than the budget, and reports the share of the budget
+ *               actually used
+ *   exchange    nodes with random traffic on one channel
+ *   burst       a sender queueing bursts larger than its TX queue
+ *
+ * The node model follows SX127xDriver::update(): a main loop pass every
+ * loop_ms services the IRQ flags (a DIO0 edge is dispatched on the next
+ * pass), starts the next queued packet when the duty cycle allows and no
+ * reception is in progress, and returns to continuous RX after TxDone.
+ * The chip model holds one received packet until its flags are cleared.
+ * The channel has no capture effect: overlapping packets are both lost.
+ * Receivers that were not listening for the whole packet lose it (half duplex).
+ *
+ * Build (from the repository root):
+ *   g++ -O2 -std=c++11 -Isrc -o lorasim tools/lorasim/lorasim.cpp \
+ *       src/pocketos/drivers/lora_airtime.cpp
+ *
+ * Usage:
+ *   lorasim [-l loop_ms] [-s seed]
+ */
+
+#include "pocketos/drivers/lora_airtime.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace PocketOS;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Airtime
+
+// Datasheet 4.1.1.7, transcribed in floating point
+static double referenceAirtimeUs(const LoRaModemParams& p, int len) {
+    double tsym = std::pow(2.0, p.spreadingFactor) / p.bandwidthHz * 1e6;
+    double num = 8.0 * len - 4.0 * p.spreadingFactor + 28 + 16 * (p.crc ? 1 : 0) - 20 * (p.explicitHeader ? 0 : 1);
+    double den = 4.0 * (p.spreadingFactor - 2 * (p.lowDataRateOptimize ? 1 : 0));
+    double payloadSymbols = 8 + std::max(std::ceil(num / den) * p.codingRate, 0.0);
+    return (p.preambleSymbols + 4.25 + payloadSymbols) * tsym;
+}
+
+static LoRaModemParams modem(uint8_t sf, uint32_t bw, uint8_t cr = 5) {
+    LoRaModemParams p;
+    p.spreadingFactor = sf;
+    p.bandwidthHz = bw;
+    p.codingRate = cr;
+    p.lowDataRateOptimize = loraNeedsLowDataRateOptimize(sf, bw);
+    return p;
+}
+
+static void testAirtime() {
+    printf("airtime\n");
+    struct Vector {
+        uint8_t sf;
+        uint32_t bw;
+        uint8_t len;
+        uint32_t us;
+        const char* source;
+    };
+    // LoRaWAN EU868 uplinks as the usual airtime calculators give them:
+    // 13 bytes of MAC overhead, empty or with a 51-byte application payload
+    static const Vector vectors[] = {
+        {  7, 125000, 13,   46336, "SF7/125k 13 B (DR5, empty)" },
+        {  7, 125000, 64,  118016, "SF7/125k 64 B (DR5, 51 B payload)" },
+        { 12, 125000, 64, 2793472, "SF12/125k 64 B (DR0, 51 B, LDRO)" },
+        {  7, 250000, 13,   23168, "SF7/250k 13 B (DR6, empty)" },
+        {  9, 125000, 20,  185344, "SF9/125k 20 B" },
+    };
+    for (const Vector& v : vectors) {
+        uint32_t us = loraAirtimeUs(modem(v.sf, v.bw), v.len);
+        printf("  %-36s %8.3f ms\n", v.source, us / 1000.0);
+        check(us == v.us, v.source);
+    }
+
+    static const uint32_t bandwidths[] = {
+        7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000
+    };
+    double worst = 0;
+    int cases = 0;
+    for (uint8_t sf = 6; sf <= 12; sf++) {
+        for (uint32_t bw : bandwidths) {
+            for (uint8_t cr = 5; cr <= 8; cr++) {
+                for (int len = 0; len <= 255; len++) {
+                    LoRaModemParams p = modem(sf, bw, cr);
+                    for (int variant = 0; variant < 2; variant++) {
+                        p.crc = variant == 0;
+                        p.explicitHeader = variant == 0;
+                        double ref = referenceAirtimeUs(p, len);
+                        double err = std::fabs(loraAirtimeUs(p, (uint8_t)len) - ref);
+                        worst = std::max(worst, err);
+                        cases++;
+                    }
+                }
+            }
+        }
+    }
+    printf("  sweep: %d cases, worst difference from the float formula %.3f us\n", cases, worst);
+    check(worst < 1.0, "airtime sweep within 1 us of the float formula");
+}
+
+// ---------------------------------------------------------------------------
+// Duty cycle compliance
+
+struct TxRecord {
+    uint64_t startMs;
+    uint32_t airtimeUs;
+};
+
+// Most airtime in any window: every maximal window starts at a transmission
+static uint64_t worstWindowUs(const std::vector<TxRecord>& log, uint64_t windowMs) {
+    uint64_t worst = 0;
+    size_t j = 0;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < log.size(); i++) {
+        while (j < log.size() && log[j].startMs < log[i].startMs + windowMs) {
+            sum += log[j].airtimeUs;
+            j++;
+        }
+        worst = std::max(worst, sum);
+        sum -= log[i].airtimeUs;
+    }
+    return worst;
+}
+
+static void testDutyCycle(uint32_t loopMs) {
+    printf("duty\n");
+    struct Case {
+        uint8_t sf;
+        uint8_t len;
+        uint16_t permille;
+        uint32_t windowMs;
+        uint32_t hours;
+    };
+    static const Case cases[] = {
+        { 12, 51, 10, 3600000, 6 },    // EU868 1 %
+        {  7, 20, 10, 3600000, 6 },
+        {  9, 32,  1, 3600000, 12 },   // 0.1 % sub-band
+        {  7, 64, 100, 60000, 1 },     // 10 % over a minute
+    };
+    for (const Case& c : cases) {
+        LoRaModemParams p = modem(c.sf, 125000);
+        uint32_t airtime = loraAirtimeUs(p, c.len);
+        DutyCycleTracker duty;
+        duty.configure(c.permille, c.windowMs);
+
+        std::vector<TxRecord> log;
+        uint64_t endMs = (uint64_t)c.hours * 3600000;
+        uint64_t busyUntilMs = 0;
+        for (uint64_t t = 1000; t < endMs; t += loopMs) {
+            if (t < busyUntilMs) {
+                continue;
+            }
+            if (duty.waitMs((uint32_t)t, airtime) == 0) {
+                duty.record((uint32_t)t, airtime);
+                log.push_back({ t, airtime });
+                busyUntilMs = t + airtime / 1000 + 1;
+            }
+        }
+        uint64_t worst = worstWindowUs(log, c.windowMs);
+        uint64_t budget = duty.budgetUs();
+        double used = 0;
+        for (const TxRecord& r : log) {
+            used += r.airtimeUs;
+        }
+        double share = used / (endMs * 1000.0) * 1000.0;
+        printf("  SF%-2u %3u B %5.1f %% / %4u s: %6zu packets, worst window %.1f%% of budget, "
+               "long-run %.3f %% (limit %.1f %%)\n",
+               c.sf, c.len, c.permille / 10.0, c.windowMs / 1000, log.size(),
+               100.0 * worst / budget, share / 10.0, c.permille / 10.0);
+        check(worst <= budget, "duty cycle budget held in every window");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Radio network model
+
+static const uint8_t IRQ_RX_DONE = 0x40;
+static const uint8_t IRQ_TX_DONE = 0x08;
+
+enum class Mode { STANDBY, RX, TX };
+
+struct Transmission {
+    int node;
+    uint64_t startUs;
+    uint64_t endUs;
+    bool collided;
+    LoRaPacket packet;
+};
+
+struct Counters {
+    uint32_t offered = 0;
+    uint32_t queueFull = 0;       // transmit() refused
+    uint32_t sent = 0;
+    uint32_t deferred = 0;
+    uint32_t delivered = 0;       // Packet copies that reached an RX queue
+    uint32_t collisions = 0;      // Copies lost to overlap
+    uint32_t halfDuplex = 0;      // Receiver was not listening
+    uint32_t overwritten = 0;     // Chip buffer overwritten before service
+    uint32_t rxDrops = 0;         // RX queue full
+    uint64_t airtimeUs = 0;
+    uint64_t txWaitUs = 0;        // transmit() to air
+    uint64_t txWaitMaxUs = 0;
+    uint64_t stampErrorUs = 0;    // Timestamp vs RxDone edge
+};
+
+struct Node {
+    // Chip
+    Mode mode = Mode::STANDBY;
+    uint64_t rxSinceUs = 0;
+    uint8_t irqFlags = 0;
+    LoRaPacket fifo;
+    uint64_t rxDoneUs = 0;
+    bool dio0 = false;            // Line attached: stamp from the edge
+
+    // Driver (SX127xDriver state)
+    LoRaPacketQueue<4> txQueue;
+    LoRaPacketQueue<8> rxQueue;
+    DutyCycleTracker duty;
+    bool txWaiting = false;
+    std::vector<uint64_t> queuedAt;   // Parallel to txQueue, for wait times
+
+    // Application
+    uint64_t phaseUs = 0;
+    uint64_t nextArrivalUs = 0;
+    double meanGapUs = 0;
+    uint32_t burst = 1;
+    uint8_t len = 20;
+};
+
+struct Network {
+    LoRaModemParams modem;
+    std::vector<Node> nodes;
+    std::vector<Transmission> air;
+    Counters counters;
+    uint32_t loopUs;
+    uint64_t nowUs = 0;
+
+    bool channelBusy(int self) const {
+        for (const Transmission& t : air) {
+            if (t.node != self) {
+                return true;   // Preamble detected: MODEM_STAT busy
+            }
+        }
+        return false;
+    }
+
+    void startReceive(Node& n) {
+        n.mode = Mode::RX;
+        n.rxSinceUs = nowUs;
+    }
+
+    bool startNextTx(int index) {
+        Node& n = nodes[index];
+        const LoRaPacket* p = n.txQueue.front();
+        if (!p) {
+            return false;
+        }
+        uint32_t airtime = loraAirtimeUs(modem, p->len);
+        uint32_t nowMs = (uint32_t)(nowUs / 1000);
+        if (n.duty.waitMs(nowMs, airtime) > 0) {
+            if (!n.txWaiting) {
+                n.txWaiting = true;
+                counters.deferred++;
+            }
+            return false;
+        }
+        if (n.mode == Mode::RX && channelBusy(index)) {
+            return false;
+        }
+        n.duty.record(nowMs, airtime);
+        n.txWaiting = false;
+        n.mode = Mode::TX;
+
+        Transmission t;
+        t.node = index;
+        t.startUs = nowUs;
+        t.endUs = nowUs + airtime;
+        t.collided = false;
+        t.packet = *p;
+        for (Transmission& other : air) {
+            other.collided = true;
+            t.collided = true;
+        }
+        air.push_back(t);
+
+        uint64_t wait = nowUs - n.queuedAt.front();
+        n.queuedAt.erase(n.queuedAt.begin());
+        counters.txWaitUs += wait;
+        counters.txWaitMaxUs = std::max(counters.txWaitMaxUs, wait);
+        counters.sent++;
+        counters.airtimeUs += airtime;
+        n.txQueue.pop();
+        return true;
+    }
+
+    // SX127xDriver::service()
+    void service(int index, uint64_t stampUs) {
+        Node& n = nodes[index];
+        uint8_t flags = n.irqFlags;
+        if (flags == 0) {
+            return;
+        }
+        bool txDone = (flags & IRQ_TX_DONE) != 0;
+        if (flags & IRQ_RX_DONE) {
+            LoRaPacket* slot = n.rxQueue.reserve();
+            if (slot) {
+                *slot = n.fifo;
+                slot->timestampUs = stampUs;
+                n.rxQueue.commit();
+                counters.delivered++;
+                counters.stampErrorUs += stampUs - n.rxDoneUs;
+            } else {
+                counters.rxDrops++;
+            }
+        }
+        n.irqFlags = 0;
+        if (txDone && !startNextTx(index)) {
+            startReceive(n);
+        }
+    }
+
+    // One main loop pass of a node
+    void loop(int index) {
+        Node& n = nodes[index];
+
+        // Application: traffic, and it reads what arrived
+        while (nowUs >= n.nextArrivalUs) {
+            for (uint32_t b = 0; b < n.burst; b++) {
+                counters.offered++;
+                LoRaPacket* p = n.txQueue.reserve();
+                if (!p) {
+                    counters.queueFull++;
+                    continue;
+                }
+                p->len = n.len;
+                memset(p->data, index, n.len);
+                n.txQueue.commit();
+                n.queuedAt.push_back(nowUs);
+            }
+            double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+            n.nextArrivalUs += (uint64_t)(-std::log(u) * n.meanGapUs) + 1;
+        }
+        while (n.rxQueue.front()) {
+            n.rxQueue.pop();
+        }
+
+        // Driver: the DIO0 edge (or a polled flag read) is handled here
+        service(index, n.dio0 ? n.rxDoneUs : nowUs);
+        if (n.mode != Mode::TX) {
+            startNextTx(index);
+        }
+    }
+
+    void completeTransmissions() {
+        for (size_t i = 0; i < air.size();) {
+            Transmission& t = air[i];
+            if (t.endUs > nowUs) {
+                i++;
+                continue;
+            }
+            for (size_t r = 0; r < nodes.size(); r++) {
+                if ((int)r == t.node) {
+                    continue;
+                }
+                Node& n = nodes[r];
+                if (t.collided) {
+                    counters.collisions++;
+                } else if (n.mode != Mode::RX || n.rxSinceUs > t.startUs) {
+                    counters.halfDuplex++;
+                } else {
+                    if (n.irqFlags & IRQ_RX_DONE) {
+                        counters.overwritten++;   // The unserviced packet is lost
+                    }
+                    n.fifo = t.packet;
+                    n.irqFlags |= IRQ_RX_DONE;
+                    n.rxDoneUs = t.endUs;
+                }
+            }
+            Node& sender = nodes[t.node];
+            sender.irqFlags |= IRQ_TX_DONE;
+            sender.mode = Mode::STANDBY;
+            air.erase(air.begin() + i);
+        }
+    }
+
+    void run(uint64_t durationUs) {
+        for (Node& n : nodes) {
+            startReceive(n);
+        }
+        // 100 us resolution: loop passes and packet ends
+        for (nowUs = 0; nowUs < durationUs; nowUs += 100) {
+            completeTransmissions();
+            for (size_t i = 0; i < nodes.size(); i++) {
+                if ((nowUs + nodes[i].phaseUs) % loopUs == 0) {
+                    loop((int)i);
+                }
+            }
+        }
+    }
+};
+
+static Network makeNetwork(uint32_t loopMs, uint8_t sf, int nodes, double gapS, uint32_t burst, uint8_t len,
+                           uint16_t permille, bool dio0) {
+    Network net;
+    net.modem = modem(sf, 125000);
+    net.loopUs = loopMs * 1000;
+    for (int i = 0; i < nodes; i++) {
+        Node n;
+        n.phaseUs = (uint64_t)(rand() % (net.loopUs / 100)) * 100;
+        n.meanGapUs = gapS * 1e6;
+        n.nextArrivalUs = (uint64_t)(gapS * 1e6 * (i + 1) / nodes);
+        n.burst = burst;
+        n.len = len;
+        n.dio0 = dio0;
+        n.duty.configure(permille, 3600000);
+        net.nodes.push_back(n);
+    }
+    return net;
+}
+
+static void report(const char* name, const Network& net, double durationS) {
+    const Counters& c = net.counters;
+    uint32_t copies = c.sent * (uint32_t)(net.nodes.size() - 1);
+    printf("  %s\n", name);
+    printf("    offered %u, queue full %u, sent %u, duty-cycle waits %u, mean TX wait %.1f ms (max %.1f ms)\n",
+           c.offered, c.queueFull, c.sent, c.deferred,
+           c.sent ? c.txWaitUs / 1000.0 / c.sent : 0.0, c.txWaitMaxUs / 1000.0);
+    printf("    received %u of %u copies: collisions %u, half duplex %u, chip overwrite %u, RX queue full %u\n",
+           c.delivered, copies, c.collisions, c.halfDuplex, c.overwritten, c.rxDrops);
+    printf("    timestamp error %.1f us mean; channel busy %.2f %%\n",
+           c.delivered ? (double)c.stampErrorUs / c.delivered : 0.0,
+           100.0 * c.airtimeUs / (durationS * 1e6));
+    printf("    loop time a blocking transmit() would take: %.1f s of %.0f s per node (%.2f %%)\n",
+           c.airtimeUs / 1e6 / net.nodes.size(), durationS,
+           100.0 * c.airtimeUs / net.nodes.size() / (durationS * 1e6));
+}
+
+static void testNetwork(uint32_t loopMs) {
+    printf("exchange (SF7/125k, 20 B, 3 nodes, one packet per 5 s each, 1 %%, 20 min)\n");
+    for (int dio0 = 1; dio0 >= 0; dio0--) {
+        Network net = makeNetwork(loopMs, 7, 3, 5.0, 1, 20, 10, dio0 != 0);
+        net.run(1200ull * 1000000);
+        report(dio0 ? "DIO0 interrupt" : "polled flags", net, 1200);
+        const Counters& c = net.counters;
+        uint32_t copies = c.sent * 2;
+        uint32_t pending = (uint32_t)net.air.size() * 2;   // Still on air at the end
+        for (const Node& n : net.nodes) {
+            pending += (n.irqFlags & IRQ_RX_DONE) ? 1 : 0;
+        }
+        check(c.delivered + c.collisions + c.halfDuplex + c.overwritten + c.rxDrops + pending == copies,
+              "exchange: every packet copy accounted for");
+        check(c.overwritten == 0, "exchange: chip buffer serviced before the next packet");
+    }
+
+    printf("burst (SF9/125k, 32 B, bursts of 6 every 60 s into a 4-packet queue, 1 %%, 1 h)\n");
+    Network net = makeNetwork(loopMs, 9, 2, 60.0, 6, 32, 10, true);
+    net.run(3600ull * 1000000);
+    report("DIO0 interrupt", net, 3600);
+    check(net.counters.queueFull > 0, "burst: queue overflow is reported, not blocking");
+    check(net.counters.sent + net.counters.queueFull <= net.counters.offered, "burst: counts consistent");
+}
+
+int main(int argc, char** argv) {
+    uint32_t loopMs = 10;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-l") && i + 1 < argc) {
+            loopMs = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            seed = (unsigned)atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [-l loop_ms] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (loopMs < 1) {
+        loopMs = 1;
+    }
+    srand(seed);
+
+    testAirtime();
+    testDutyCycle(loopMs);
+    testNetwork(loopMs);
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
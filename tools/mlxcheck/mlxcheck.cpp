@@ -0,0 +1,238 @@
+/*
+ * mlxcheck - MLX90640 compensation accuracy and cost (host tool)
+ *
+ * Builds a synthetic EEPROM (fixed seed, two bad pixels), extracts it with
+ * MLX90640Calibration (src/pocketos/drivers/mlx90640_calibration.h) and,
+ * for chess and interleaved readout and both subpages, searches the raw
+ * pixel words that make compensateFloat() reproduce a known scene:
+ *
+ *   background 23.5-25 degC, a 36.6 degC spot, a -15 degC corner,
+ *   a 180 degC block, a -20..250 degC sweep row and one 400 degC pixel
+ *
+ * Checks (every pixel at or below 300 degC, bad pixels excluded):
+ *
+ *   float path vs scene            <= 0.04 K  (raw word quantisation)
+ *   fixed path vs float path       <= 0.02 K
+ *   Vdd 3.33 V, Ta 31 degC         within 0.01 V / 0.05 K
+ *   only the frame's subpage written, bad pixels filled,
+ *   400 degC saturates the int16 image at 327.67
+ *
+ * then times both paths per subpage.
+ *
+ * Build (from the repository root):
+ *   g++ -O2 -std=c++11 -Isrc -o mlxcheck tools/mlxcheck/mlxcheck.cpp \
+ *       src/pocketos/drivers/mlx90640_calibration.cpp
+ *
+ * Usage:
+ *   mlxcheck [-n rounds]
+ *
+ * Host timings only rank the paths: x86 has a hardware sqrt, so the float
+ * path is far ahead here. The integer path is for FPU-less targets.
+ */
+
+#include "pocketos/drivers/mlx90640_calibration.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace PocketOS;
+
+#define UNSET_FIXED INT16_MIN
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+static void within(const char* what, double diff, double limit) {
+    printf("  %-30s max %.4f K (limit %.3f)\n", what, diff, limit);
+    if (!(diff <= limit)) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+// xorshift32: the EEPROM is the same on every host libc
+static uint32_t rngState = 7;
+
+static uint16_t rng16() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (uint16_t)(rngState >> 8);
+}
+
+// Plausible device scalars; per-pixel words random, pixels 100 and 101
+// marked bad (zero word, outlier bit)
+static void buildEeprom(uint16_t* ee) {
+    memset(ee, 0, MLX90640_EEPROM_WORDS * sizeof(uint16_t));
+    ee[16] = 0x4210; ee[17] = 0xFFB5;
+    for (int i = 18; i < 32; i++) ee[i] = rng16() & 0x3333;
+    ee[32] = 0x5154; ee[33] = 0x2F44;
+    for (int i = 34; i < 48; i++) ee[i] = rng16() & 0x3333;
+    ee[48] = 0x18EF; ee[49] = 0x2FF1; ee[50] = 0x5952; ee[51] = 0x9D68;
+    ee[52] = 0x4444; ee[53] = 0x2901; ee[54] = 0x6B6B; ee[55] = 0x6868;
+    ee[56] = 0x2363; ee[57] = 0x0811; ee[58] = 0x07B5; ee[59] = 0x044F;
+    ee[60] = 0xF020; ee[61] = 0x9A9A; ee[62] = 0x9A9A; ee[63] = 0x2889;
+    for (int p = 0; p < MLX90640_PIXELS; p++) {
+        ee[64 + p] = rng16() & 0xFFFE;
+    }
+    ee[64 + 100] = 0;
+    ee[64 + 101] |= 1;
+}
+
+#define HOT_PIXEL (20 * MLX90640_COLUMNS + 5)
+
+static float scene(int p) {
+    int r = p / MLX90640_COLUMNS;
+    int c = p % MLX90640_COLUMNS;
+    if (p == HOT_PIXEL) return 400.0f;
+    if (r == MLX90640_ROWS - 1) return -20.0f + 270.0f * c / (MLX90640_COLUMNS - 1);
+    if (r > 16 && c > 24) return 180.0f;
+    if (r < 3 && c < 4) return -15.0f;
+    if ((r - 8) * (r - 8) + (c - 10) * (c - 10) < 16) return 36.6f;
+    return 23.5f + 0.05f * c;
+}
+
+// Aux words for Vdd ~3.33 V and Ta ~31 degC
+static void setAux(const MLX90640Calibration& cal, MLX90640Frame& f, bool chess, uint8_t subpage) {
+    memset(&f, 0, sizeof(f));
+    f.words[832] = (chess ? 0x1000 : 0) | (2 << 10) | (3 << 7);
+    f.words[833] = subpage;
+    f.words[810] = (uint16_t)(int16_t)(-13088 - 3168 * 0.02f);
+    f.words[800] = 1700;
+    float dV = cal.vdd(f) - 3.3f;
+    float ptatArt = ((31 - 25) * 42.25f + 12273) * (1 + 22 / 4096.0f * dV);
+    f.words[768] = (uint16_t)(int16_t)lroundf(1700 * 262144.0f / ptatArt - 1700 * 9.0f);
+    f.words[778] = 0x18EF + 40;
+    f.words[776] = (uint16_t)(int16_t)-60;
+    f.words[808] = (uint16_t)(int16_t)-58;
+}
+
+// Per pixel, the smallest raw word whose float result reaches the scene
+static void solveRaw(const MLX90640Calibration& cal, MLX90640Frame& f, float emissivity) {
+    static int lo[MLX90640_PIXELS], hi[MLX90640_PIXELS];
+    static float out[MLX90640_PIXELS];
+    for (int p = 0; p < MLX90640_PIXELS; p++) {
+        lo[p] = -32768;
+        hi[p] = 32767;
+    }
+    for (int it = 0; it < 17; it++) {
+        for (int p = 0; p < MLX90640_PIXELS; p++) {
+            f.words[p] = (uint16_t)(int16_t)((lo[p] + hi[p]) / 2);
+            out[p] = NAN;
+        }
+        cal.compensateFloat(f, emissivity, out);
+        for (int p = 0; p < MLX90640_PIXELS; p++) {
+            int mid = (lo[p] + hi[p]) / 2;
+            if (std::isnan(out[p]) || out[p] < scene(p)) {
+                lo[p] = mid;
+            } else {
+                hi[p] = mid;
+            }
+        }
+    }
+    for (int p = 0; p < MLX90640_PIXELS; p++) {
+        f.words[p] = (uint16_t)(int16_t)hi[p];
+    }
+}
+
+static void runMode(const MLX90640Calibration& cal, bool chess, int rounds) {
+    const float emissivity = 0.95f;
+    printf("%s readout\n", chess ? "chess" : "interleaved");
+
+    for (uint8_t sub = 0; sub < 2; sub++) {
+        char what[64];
+        MLX90640Frame f;
+        setAux(cal, f, chess, sub);
+        printf(" subpage %u: vdd %.3f V, ta %.3f degC\n", sub, cal.vdd(f), cal.ambient(f));
+        check(fabs(cal.vdd(f) - 3.33) <= 0.01, "vdd");
+        check(fabs(cal.ambient(f) - 31.0) <= 0.05, "ambient");
+
+        solveRaw(cal, f, emissivity);
+
+        static float fl[MLX90640_PIXELS];
+        static int16_t fx[MLX90640_PIXELS];
+        for (int p = 0; p < MLX90640_PIXELS; p++) {
+            fl[p] = NAN;
+            fx[p] = UNSET_FIXED;
+        }
+        cal.compensateFloat(f, emissivity, fl);
+        cal.compensate(f, emissivity, fx);
+
+        int written = 0;
+        bool sameSet = true;
+        double maxTruth = 0, maxFixed = 0;
+        for (int p = 0; p < MLX90640_PIXELS; p++) {
+            bool fixedSet = fx[p] != UNSET_FIXED;
+            if (fixedSet != !std::isnan(fl[p])) {
+                sameSet = false;
+            }
+            if (!fixedSet) {
+                continue;
+            }
+            written++;
+            if (p == HOT_PIXEL) {
+                check(fx[p] == INT16_MAX, "400 degC saturates at 327.67");
+                continue;
+            }
+            if (cal.isBadPixel(p)) {
+                snprintf(what, sizeof(what), "bad pixel %d filled", p);
+                check(fabs(fx[p] / 100.0 - scene(p)) <= 0.5, what);
+                continue;
+            }
+            maxTruth = fmax(maxTruth, fabs(fl[p] - scene(p)));
+            maxFixed = fmax(maxFixed, fabs(fx[p] / 100.0 - fl[p]));
+        }
+        snprintf(what, sizeof(what), "subpage %u writes 384 pixels", sub);
+        check(written == MLX90640_PIXELS / 2, what);
+        check(sameSet, "fixed and float write the same pixels");
+        within("|float - scene|", maxTruth, 0.04);
+        within("|fixed - float|", maxFixed, 0.02);
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) cal.compensate(f, emissivity, fx);
+        auto t1 = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) cal.compensateFloat(f, emissivity, fl);
+        auto t2 = std::chrono::steady_clock::now();
+        printf("  host: fixed %.1f us/subpage, float %.1f us/subpage\n",
+               std::chrono::duration<double, std::micro>(t1 - t0).count() / rounds,
+               std::chrono::duration<double, std::micro>(t2 - t1).count() / rounds);
+    }
+}
+
+int main(int argc, char** argv) {
+    int rounds = 2000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: mlxcheck [-n rounds]\n");
+            return 2;
+        }
+    }
+    if (rounds < 1) rounds = 1;
+
+    static uint16_t ee[MLX90640_EEPROM_WORDS];
+    buildEeprom(ee);
+    MLX90640Calibration cal;
+    if (!cal.begin(ee)) {
+        printf("FAIL calibration extraction\n");
+        return 1;
+    }
+    printf("bad pixels: %u\n", cal.badPixelCount());
+    check(cal.badPixelCount() == 2 && cal.isBadPixel(100) && cal.isBadPixel(101), "bad pixel map");
+
+    runMode(cal, true, rounds);
+    runMode(cal, false, rounds);
+
+    printf("\nresult: %s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,406 @@
+/*
+ * pimgconv - PocketOS image converter (host tool)
+ *
+ * Converts binary PPM (P6) images to the PIMG format decoded by
+ * GfxImageDecoder (src/pocketos/drivers/gfx_image.h), and back.
+ *
+ * Build (from the repository root):
+ *   g++ -O2 -std=c++17 -Isrc -o pimgconv tools/pimgconv/pimgconv.cpp \
+ *       src/pocketos/drivers/gfx_image.cpp
+ *
+ * Usage:
+ *   pimgconv [-e auto|raw|rle565|indexed] input.ppm output.pimg
+ *   pimgconv [-e ...] -n name input.ppm output.h   (C array)
+ *   pimgconv -d input.pimg output.ppm               (decode)
+ *   pimgconv -b input.pimg                          (decode benchmark)
+ *
+ * Other formats: convert first, e.g. `magick icon.png icon.ppm`.
+ */
+
+#include "pocketos/drivers/gfx_image.h"
+
+#include <chrono>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace PocketOS;
+
+struct Image {
+    uint16_t width = 0;
+    uint16_t height = 0;
+    std::vector<uint16_t> pixels;   // RGB565
+};
+
+static bool readFile(const char* path, std::vector<uint8_t>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        out.insert(out.end(), buf, buf + n);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool writeFile(const char* path, const std::vector<uint8_t>& data) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    return fclose(f) == 0 && ok;
+}
+
+// ---- PPM ----
+
+static bool ppmToken(const std::vector<uint8_t>& d, size_t& pos, long& value) {
+    while (pos < d.size()) {
+        if (d[pos] == '#') {
+            while (pos < d.size() && d[pos] != '\n') pos++;
+        } else if (isspace(d[pos])) {
+            pos++;
+        } else {
+            break;
+        }
+    }
+    if (pos >= d.size() || !isdigit(d[pos])) {
+        return false;
+    }
+    value = 0;
+    while (pos < d.size() && isdigit(d[pos])) {
+        value = value * 10 + (d[pos++] - '0');
+    }
+    return true;
+}
+
+static bool readPPM(const char* path, Image& img) {
+    std::vector<uint8_t> d;
+    if (!readFile(path, d) || d.size() < 2 || d[0] != 'P' || d[1] != '6') {
+        return false;
+    }
+    size_t pos = 2;
+    long w, h, maxval;
+    if (!ppmToken(d, pos, w) || !ppmToken(d, pos, h) || !ppmToken(d, pos, maxval)) {
+        return false;
+    }
+    pos++;  // Single whitespace before the raster
+    if (w <= 0 || h <= 0 || w > 65535 || h > 65535 || maxval != 255 ||
+        d.size() - pos < (size_t)w * h * 3) {
+        return false;
+    }
+
+    img.width = (uint16_t)w;
+    img.height = (uint16_t)h;
+    img.pixels.resize((size_t)w * h);
+    for (size_t i = 0; i < img.pixels.size(); i++) {
+        const uint8_t* p = &d[pos + i * 3];
+        uint16_t r = (uint16_t)((p[0] * 31 + 127) / 255);
+        uint16_t g = (uint16_t)((p[1] * 63 + 127) / 255);
+        uint16_t b = (uint16_t)((p[2] * 31 + 127) / 255);
+        img.pixels[i] = (uint16_t)((r << 11) | (g << 5) | b);
+    }
+    return true;
+}
+
+static std::vector<uint8_t> toPPM(const Image& img) {
+    char header[32];
+    int n = snprintf(header, sizeof(header), "P6\n%u %u\n255\n", img.width, img.height);
+    std::vector<uint8_t> out(header, header + n);
+    for (uint16_t c : img.pixels) {
+        uint8_t r = (c >> 11) & 0x1F;
+        uint8_t g = (c >> 5) & 0x3F;
+        uint8_t b = c & 0x1F;
+        out.push_back((uint8_t)((r << 3) | (r >> 2)));
+        out.push_back((uint8_t)((g << 2) | (g >> 4)));
+        out.push_back((uint8_t)((b << 3) | (b >> 2)));
+    }
+    return out;
+}
+
+// ---- Encoder ----
+
+static void put16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back((uint8_t)(v & 0xFF));
+    out.push_back((uint8_t)(v >> 8));
+}
+
+static void putControl(std::vector<uint8_t>& out, bool run, size_t count) {
+    size_t c = count - 1;
+    uint8_t flag = run ? 0x80 : 0x00;
+    if (count <= GFX_IMAGE_MAX_SHORT) {
+        out.push_back((uint8_t)(flag | c));
+    } else {
+        out.push_back((uint8_t)(flag | 0x40 | (c >> 8)));
+        out.push_back((uint8_t)(c & 0xFF));
+    }
+}
+
+// Packets over a value stream (RGB565 or palette indices). Runs of 3 or
+// more become run packets; everything in between is literal.
+static void encodePackets(const std::vector<uint16_t>& values, size_t valueSize,
+                          std::vector<uint8_t>& out) {
+    auto putValue = [&](uint16_t v) {
+        if (valueSize == 1) out.push_back((uint8_t)v);
+        else put16(out, v);
+    };
+    auto runLength = [&](size_t i) {
+        size_t r = 1;
+        while (i + r < values.size() && values[i + r] == values[i] && r < GFX_IMAGE_MAX_COUNT) r++;
+        return r;
+    };
+
+    size_t i = 0;
+    while (i < values.size()) {
+        size_t run = runLength(i);
+        if (run >= 3) {
+            putControl(out, true, run);
+            putValue(values[i]);
+            i += run;
+            continue;
+        }
+        size_t start = i;
+        while (i < values.size() && i - start < GFX_IMAGE_MAX_COUNT && runLength(i) < 3) {
+            i++;
+        }
+        putControl(out, false, i - start);
+        for (size_t k = start; k < i; k++) {
+            putValue(values[k]);
+        }
+    }
+}
+
+static void putHeader(std::vector<uint8_t>& out, const Image& img, uint8_t encoding, uint16_t paletteSize) {
+    const char magic[4] = {'P', 'I', 'M', 'G'};
+    out.insert(out.end(), magic, magic + 4);
+    out.push_back(GFX_IMAGE_VERSION);
+    out.push_back(encoding);
+    put16(out, img.width);
+    put16(out, img.height);
+    put16(out, paletteSize);
+}
+
+static std::vector<uint8_t> encodeRaw(const Image& img) {
+    std::vector<uint8_t> out;
+    putHeader(out, img, GFX_IMAGE_RAW, 0);
+    for (uint16_t c : img.pixels) put16(out, c);
+    return out;
+}
+
+static std::vector<uint8_t> encodeRLE565(const Image& img) {
+    std::vector<uint8_t> out;
+    putHeader(out, img, GFX_IMAGE_RLE565, 0);
+    encodePackets(img.pixels, 2, out);
+    return out;
+}
+
+// Empty if the image has more than 256 colours
+static std::vector<uint8_t> encodeIndexed(const Image& img) {
+    std::map<uint16_t, size_t> counts;
+    for (uint16_t c : img.pixels) {
+        counts[c]++;
+        if (counts.size() > GFX_IMAGE_MAX_PALETTE) return {};
+    }
+
+    std::vector<uint16_t> palette;
+    std::map<uint16_t, uint16_t> index;
+    for (auto& kv : counts) {
+        index[kv.first] = (uint16_t)palette.size();
+        palette.push_back(kv.first);
+    }
+    std::vector<uint16_t> indices;
+    indices.reserve(img.pixels.size());
+    for (uint16_t c : img.pixels) indices.push_back(index[c]);
+
+    std::vector<uint8_t> out;
+    putHeader(out, img, GFX_IMAGE_INDEXED, (uint16_t)palette.size());
+    for (uint16_t c : palette) put16(out, c);
+    encodePackets(indices, 1, out);
+    return out;
+}
+
+// ---- Decoder checks ----
+
+static bool decodeImage(const std::vector<uint8_t>& data, Image& img) {
+    GfxImageDecoder decoder;
+    if (!decoder.begin(data.data(), data.size())) {
+        return false;
+    }
+    img.width = decoder.width();
+    img.height = decoder.height();
+    img.pixels.resize((size_t)img.width * img.height);
+    for (uint16_t r = 0; r < img.height; r++) {
+        if (!decoder.readRow(&img.pixels[(size_t)r * img.width])) return false;
+    }
+    return true;
+}
+
+// Two measurements per image:
+// - full decode: every pixel expanded into an RGB565 frame (readRow()),
+//   so px/ms is real decode throughput
+// - stream: next() as the TFT drivers use it; fills are handed to the
+//   panel unexpanded, so this is reported per piece, not per pixel
+static void benchmark(const std::vector<uint8_t>& data) {
+    GfxImageDecoder decoder;
+    if (!decoder.begin(data.data(), data.size())) {
+        fprintf(stderr, "invalid image\n");
+        return;
+    }
+    uint32_t pixels = (uint32_t)decoder.width() * decoder.height();
+    std::vector<uint16_t> frame(pixels);
+    uint32_t fills = 0;
+    uint32_t chunks = 0;
+    uint32_t sum = 0;
+    // At least 200 rounds and about 20 Mpx, so small images time stably
+    const int rounds = pixels < 100000 ? (int)(20000000 / pixels) : 200;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        decoder.rewind();
+        for (uint16_t r = 0; r < decoder.height(); r++) {
+            decoder.readRow(&frame[(size_t)r * decoder.width()]);
+        }
+        sum += frame[(size_t)i % pixels];
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        decoder.rewind();
+        GfxImageChunk chunk;
+        while (decoder.next(chunk)) {
+            if (chunk.fill) {
+                fills++;
+                sum += chunk.color;
+            } else {
+                chunks++;
+                sum += chunk.pixels[chunk.count - 1];
+            }
+        }
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    double fullMs = std::chrono::duration<double, std::milli>(t1 - t0).count() / rounds;
+    double streamMs = std::chrono::duration<double, std::milli>(t2 - t1).count() / rounds;
+    double pieces = (double)(fills + chunks) / rounds;
+
+    printf("%ux%u: full decode %.3f ms/frame, %.0f px/ms\n", decoder.width(), decoder.height(),
+           fullMs, pixels / fullMs);
+    printf("  stream %.3f ms/frame, %u fills + %u buffers per frame, %.0f pieces/ms (checksum %u)\n",
+           streamMs, fills / rounds, chunks / rounds, pieces / streamMs, sum);
+}
+
+// ---- Output ----
+
+static std::vector<uint8_t> toCArray(const std::vector<uint8_t>& data, const std::string& name) {
+    std::string s = "// Generated by pimgconv\n#include <stdint.h>\n#include <stddef.h>\n\n";
+    s += "const uint8_t " + name + "[] = {";
+    for (size_t i = 0; i < data.size(); i++) {
+        char b[16];
+        snprintf(b, sizeof(b), "%s0x%02X,", (i % 16 == 0) ? "\n    " : " ", data[i]);
+        s += b;
+    }
+    s += "\n};\nconst size_t " + name + "_len = sizeof(" + name + ");\n";
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+static const char* encodingName(uint8_t e) {
+    switch (e) {
+        case GFX_IMAGE_RAW: return "raw";
+        case GFX_IMAGE_RLE565: return "rle565";
+        case GFX_IMAGE_INDEXED: return "indexed";
+    }
+    return "?";
+}
+
+static int usage() {
+    fprintf(stderr,
+            "usage: pimgconv [-e auto|raw|rle565|indexed] [-n name] input.ppm output\n"
+            "       pimgconv -d input.pimg output.ppm\n"
+            "       pimgconv -b input.pimg\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    std::string encoding = "auto";
+    std::string name;
+    bool decode = false;
+    bool bench = false;
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-e") && i + 1 < argc) encoding = argv[++i];
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc) name = argv[++i];
+        else if (!strcmp(argv[i], "-d")) decode = true;
+        else if (!strcmp(argv[i], "-b")) bench = true;
+        else if (argv[i][0] == '-') return usage();
+        else files.push_back(argv[i]);
+    }
+
+    if (bench) {
+        std::vector<uint8_t> data;
+        if (files.size() != 1 || !readFile(files[0], data)) return usage();
+        benchmark(data);
+        return 0;
+    }
+
+    if (files.size() != 2) return usage();
+
+    if (decode) {
+        std::vector<uint8_t> data;
+        Image img;
+        if (!readFile(files[0], data) || !decodeImage(data, img)) {
+            fprintf(stderr, "%s: not a valid PIMG image\n", files[0]);
+            return 1;
+        }
+        return writeFile(files[1], toPPM(img)) ? 0 : 1;
+    }
+
+    Image img;
+    if (!readPPM(files[0], img)) {
+        fprintf(stderr, "%s: expected a binary PPM (P6, maxval 255)\n", files[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> out;
+    if (encoding == "raw" || encoding == "auto") {
+        out = encodeRaw(img);
+    }
+    if (encoding == "rle565" || encoding == "auto") {
+        std::vector<uint8_t> rle = encodeRLE565(img);
+        if (out.empty() || rle.size() < out.size()) out = rle;
+    }
+    if (encoding == "indexed" || encoding == "auto") {
+        std::vector<uint8_t> indexed = encodeIndexed(img);
+        if (indexed.empty() && encoding == "indexed") {
+            fprintf(stderr, "%s: more than %d colours\n", files[0], GFX_IMAGE_MAX_PALETTE);
+            return 1;
+        }
+        if (!indexed.empty() && (out.empty() || indexed.size() < out.size())) out = indexed;
+    }
+    if (out.empty()) return usage();
+
+    // Round trip through the device decoder
+    Image check;
+    if (!decodeImage(out, check) || check.pixels != img.pixels) {
+        fprintf(stderr, "internal error: round trip mismatch\n");
+        return 1;
+    }
+
+    size_t rawBytes = img.pixels.size() * 2;
+    printf("%s: %ux%u %s, %zu -> %zu bytes (%.1f:1)\n", files[0], img.width, img.height,
+           encodingName(out[5]), rawBytes, out.size(), (double)rawBytes / out.size());
+
+    if (!name.empty()) {
+        out = toCArray(out, name);
+    }
+    if (!writeFile(files[1], out)) {
+        fprintf(stderr, "%s: write failed\n", files[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+#pragma once
+/*
+ * Host Arduino shim for tools/tftbench: just enough of the core API (String,
+ * pins, timing) to build SPIDriverBase and the TFT drivers unmodified on a
+ * PC. Pin and timing functions are defined in tftbench.cpp.
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <algorithm>
+#include <ctype.h>
+#include <strings.h>
+typedef uint8_t byte;
+typedef bool boolean;
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+#define DEC 10
+#define HEX 16
+#define BIN 2
+#define OCT 8
+#define PI 3.14159265358979
+#define F(x) x
+#define PROGMEM
+#define NOT_AN_INTERRUPT -1
+inline int digitalPinToInterrupt(int p){return p;}
+unsigned long millis(); unsigned long micros(); void delay(unsigned long); void delayMicroseconds(unsigned int);
+void pinMode(uint8_t, uint8_t); void digitalWrite(uint8_t, uint8_t); int digitalRead(uint8_t);
+int analogRead(uint8_t); void analogWrite(uint8_t,int);
+void attachInterrupt(int, void(*)(), int); void detachInterrupt(int);
+void noInterrupts(); void interrupts(); void yield();
+template<class T> T constrain(T x, T a, T b){return x<a?a:(x>b?b:x);}
+inline uint8_t pgm_read_byte(const void* p){return *(const uint8_t*)p;}
+inline uint16_t pgm_read_word(const void* p){return *(const uint16_t*)p;}
+inline uint32_t pgm_read_dword(const void* p){return *(const uint32_t*)p;}
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define bitRead(v,b) (((v)>>(b))&1)
+#define bitSet(v,b) ((v)|=(1UL<<(b)))
+#define bitClear(v,b) ((v)&=~(1UL<<(b)))
+#define lowByte(w) ((uint8_t)((w)&0xff))
+#define highByte(w) ((uint8_t)((w)>>8))
+class __FlashStringHelper;
+class String {
+ public:
+  std::string s;
+  String(){}
+  String(const char* c){ if(c) s=c; }
+  String(const std::string& x):s(x){}
+  String(char c){s=std::string(1,c);}
+  String(unsigned char v, unsigned char base=10){s=fmt((unsigned long)v,base);}
+  String(int v, unsigned char base=10){ s = base==10? std::to_string(v):fmt((unsigned long)(unsigned)v,base);}
+  String(unsigned int v, unsigned char base=10){s=fmt(v,base);}
+  String(long v, unsigned char base=10){ s = base==10? std::to_string(v):fmt((unsigned long)v,base);}
+  String(unsigned long v, unsigned char base=10){s=fmt(v,base);}
+  String(long long v, unsigned char base=10){ s = std::to_string(v); (void)base;}
+  String(unsigned long long v, unsigned char base=10){ s = std::to_string(v); (void)base;}
+  String(float v, unsigned char d=2){char b[64];snprintf(b,64,"%.*f",d,(double)v);s=b;}
+  String(double v, unsigned char d=2){char b[64];snprintf(b,64,"%.*f",d,v);s=b;}
+  static std::string fmt(unsigned long v, int base){char b[70];int i=69;b[i]=0;if(!v){return "0";}while(v){int d=v%base;b[--i]=d<10?'0'+d:'a'+d-10;v/=base;}return std::string(b+i);}
+  unsigned int length() const {return s.size();}
+  const char* c_str() const {return s.c_str();}
+  bool reserve(unsigned int n){s.reserve(n);return true;}
+  int indexOf(char c, unsigned int from=0) const {auto p=s.find(c,from);return p==std::string::npos?-1:(int)p;}
+  int indexOf(const String& c, unsigned int from=0) const {auto p=s.find(c.s,from);return p==std::string::npos?-1:(int)p;}
+  int lastIndexOf(char c) const {auto p=s.rfind(c);return p==std::string::npos?-1:(int)p;}
+  int lastIndexOf(const String& c) const {auto p=s.rfind(c.s);return p==std::string::npos?-1:(int)p;}
+  String substring(unsigned int a) const {return a>s.size()?String():String(s.substr(a));}
+  String substring(unsigned int a, unsigned int b) const {if(a>b)std::swap(a,b); if(a>s.size())return String(); return String(s.substr(a,b-a));}
+  long toInt() const {return atol(s.c_str());}
+  float toFloat() const {return atof(s.c_str());}
+  double toDouble() const {return atof(s.c_str());}
+  bool startsWith(const String& p) const {return s.compare(0,p.s.size(),p.s)==0;}
+  bool startsWith(const String& p, unsigned int off) const {return s.compare(off,p.s.size(),p.s)==0;}
+  bool endsWith(const String& p) const {return s.size()>=p.s.size() && s.compare(s.size()-p.s.size(),p.s.size(),p.s)==0;}
+  bool equals(const String& o) const {return s==o.s;}
+  bool equalsIgnoreCase(const String& o) const {return strcasecmp(s.c_str(),o.s.c_str())==0;}
+  void trim(){size_t a=s.find_first_not_of(" \t\r\n"); size_t b=s.find_last_not_of(" \t\r\n"); s=a==std::string::npos?std::string():s.substr(a,b-a+1);}
+  void toLowerCase(){for(auto& c:s)c=tolower(c);} void toUpperCase(){for(auto& c:s)c=toupper(c);}
+  char charAt(unsigned int i) const {return i<s.size()?s[i]:0;}
+  void setCharAt(unsigned int i, char c){if(i<s.size())s[i]=c;}
+  char operator[](unsigned int i) const {return s[i];}
+  char& operator[](unsigned int i) {return s[i];}
+  void replace(const String&, const String&){}
+  void replace(char, char){}
+  void remove(unsigned int){} void remove(unsigned int, unsigned int){}
+  bool isEmpty() const {return s.empty();}
+  template<class T> bool concat(const T& v){ *this += v; return true; }
+  void toCharArray(char* b, unsigned int n, unsigned int i=0) const {if(!n)return; size_t k=i<s.size()?std::min<size_t>(n-1,s.size()-i):0; memcpy(b,s.data()+i,k); b[k]=0;}
+  int compareTo(const String& o) const {return s.compare(o.s);}
+  String& operator+=(const String& o){s+=o.s;return *this;}
+  String& operator+=(const char* o){if(o)s+=o;return *this;}
+  String& operator+=(char o){s+=o;return *this;}
+  String& operator+=(unsigned char o){*this+=String(o);return *this;}
+  String& operator+=(int o){*this+=String(o);return *this;}
+  String& operator+=(unsigned int o){*this+=String(o);return *this;}
+  String& operator+=(long o){*this+=String(o);return *this;}
+  String& operator+=(unsigned long o){*this+=String(o);return *this;}
+  String& operator+=(long long o){*this+=String(o);return *this;}
+  String& operator+=(unsigned long long o){*this+=String(o);return *this;}
+  String& operator+=(float o){*this+=String(o);return *this;}
+  String& operator+=(double o){*this+=String(o);return *this;}
+  bool operator==(const String& o) const {return s==o.s;}
+  bool operator==(const char* o) const {return s==o;}
+  bool operator!=(const String& o) const {return s!=o.s;}
+  bool operator!=(const char* o) const {return s!=o;}
+  bool operator<(const String& o) const {return s<o.s;}
+  bool operator>(const String& o) const {return s>o.s;}
+  operator const char*() const {return s.c_str();}
+};
+template<class T> inline String operator+(const String& a, const T& b){String r(a); r+=b; return r;}
+inline String operator+(const char* a, const String& b){String r(a); r+=b; return r;}
@@ -0,0 +1,54 @@
+#pragma once
+/*
+ * Counting fake SPI for tools/tftbench. Records bytes and core calls; CS
+ * cycles are counted from digitalWrite() on the chip select pin.
+ */
+#include <Arduino.h>
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+#define SPI_MODE2 2
+#define SPI_MODE3 3
+
+struct FakeSPIStats {
+    uint64_t bytes;         // Clocked out
+    uint64_t calls;         // Core data calls (transfer, write16, ...)
+    uint64_t csCycles;      // Chip select assertions
+    uint8_t* capture;       // First captureSize bytes clocked out, if set
+    size_t captureSize;
+    size_t captured;
+};
+extern FakeSPIStats fakeSPI;
+
+class SPISettings { public: SPISettings() {} SPISettings(uint32_t, uint8_t, uint8_t) {} };
+
+class SPIClass {
+public:
+    void begin() {}
+    void begin(int, int, int, int = -1) {}
+    void end() {}
+    void beginTransaction(SPISettings) {}
+    void endTransaction() {}
+    uint8_t transfer(uint8_t b) { count(&b, 1); return 0; }
+    void transfer(void* data, size_t n) { count(data, n); }
+    void transfer(const void* tx, void*, size_t n) { count(tx, n); }
+    uint16_t transfer16(uint16_t v) { write16(v); return 0; }
+    void write(uint8_t b) { count(&b, 1); }
+    void write16(uint16_t v) { uint8_t b[2] = { (uint8_t)(v >> 8), (uint8_t)v }; count(b, 2); }
+    void setFrequency(uint32_t) {}
+    void setDataMode(uint8_t) {}
+    void setBitOrder(uint8_t) {}
+
+private:
+    static void count(const void* data, size_t n) {
+        const uint8_t* p = (const uint8_t*)data;
+        for (size_t i = 0; p && i < n && fakeSPI.captured < fakeSPI.captureSize; i++) {
+            fakeSPI.capture[fakeSPI.captured++] = p[i];
+        }
+        fakeSPI.bytes += n;
+        fakeSPI.calls++;
+    }
+};
+extern SPIClass SPI;
@@ -0,0 +1,356 @@
+/*
+ * tftbench - TFT fill benchmark on a counting fake SPI (host tool)
+ *
+ * Builds the ILI9341, ST7789 and ST7735 drivers unmodified against a host
+ * Arduino shim (tools/tftbench/host) whose SPIClass counts bytes and core
+ * calls, and whose digitalWrite() counts chip select cycles. Each fill
+ * runs through the driver and through the per-pixel sequence the drivers
+ * used before block fill (7 CS cycles for the window, then one write16()
+ * per pixel), replayed on the same fake bus.
+ *
+ * Checks, per driver (exit status 1 on any failure):
+ * - fillScreen/fillRect/drawHLine/drawVLine: exactly one chained window
+ *   set and one pattern write (2 CS cycles), 11 window bytes + 2 per pixel
+ * - the window bytes carry the expected CASET/RASET coordinates
+ * - a framebuffer flush of one dirty rectangle is one CS cycle
+ * - drawCompressedImage: one window and one data phase when it fits, one
+ *   per row when clipped, one flushed rectangle in framebuffer mode
+ * - double-buffered framebuffer: each flush sends the buffer drawn since
+ *   the last one, and a flush with nothing dirty does not swap buffers
+ *
+ * Time is modelled from the counts: bytes at the SPI clock, plus a fixed
+ * cost per core call and per CS cycle. The counts are exact; the time is
+ * only as good as those two figures. The host build takes the generic
+ * SPIDriverBase path (pattern streamed from a POCKETOS_SPI_FILL_BUFFER
+ * line); on ESP32 the pattern write is a single SPI.writePattern() call.
+ *
+ * Build (from the repository root):
+ *   g++ -O2 -std=c++11 -Itools/tftbench/host -Isrc -o tftbench tools/tftbench/tftbench.cpp \
+ *       src/pocketos/drivers/ili9341_driver.cpp src/pocketos/drivers/st7789_driver.cpp \
+ *       src/pocketos/drivers/st7735_driver.cpp src/pocketos/drivers/spi_driver_base.cpp \
+ *       src/pocketos/drivers/tft_framebuffer.cpp src/pocketos/drivers/gfx_image.cpp \
+ *       src/pocketos/core/resource_manager.cpp src/pocketos/core/capability_schema.cpp
+ *
+ * Usage:
+ *   tftbench [-c spi_mhz] [-k call_overhead_us] [-s cs_overhead_us]
+ */
+
+#include <Arduino.h>
+#include <SPI.h>
+
+#include "pocketos/core/logger.h"
+#include "pocketos/core/interrupt_manager.h"
+#include "pocketos/drivers/ili9341_driver.h"
+#include "pocketos/drivers/st7789_driver.h"
+#include "pocketos/drivers/st7735_driver.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace PocketOS;
+
+// ---------------------------------------------------------------------------
+// Host shim: fake bus and core functions
+
+FakeSPIStats fakeSPI;
+SPIClass SPI;
+
+static const uint8_t PIN_CS = 5;
+static const uint8_t PIN_DC = 16;
+static const uint8_t PIN_RST = 17;
+static const char* ENDPOINT = "spi0:cs=5,dc=16,rst=17";
+
+static uint8_t pinLevel[64];
+static unsigned long hostMicros = 0;
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    if (pin >= sizeof(pinLevel)) {
+        return;
+    }
+    if (pin == PIN_CS && pinLevel[pin] == HIGH && level == LOW) {
+        fakeSPI.csCycles++;
+    }
+    pinLevel[pin] = level;
+}
+
+int digitalRead(uint8_t pin) { return pin < sizeof(pinLevel) ? pinLevel[pin] : LOW; }
+void delay(unsigned long ms) { hostMicros += ms * 1000; }
+void delayMicroseconds(unsigned int us) { hostMicros += us; }
+unsigned long millis() { return hostMicros / 1000; }
+unsigned long micros() { return hostMicros; }
+void yield() {}
+
+// Window bytes of the current measurement: the first bytes clocked out
+static uint8_t captured[16];
+static size_t capturedLen = 0;
+
+namespace PocketOS {
+
+void Logger::info(const char*) {}
+void Logger::warning(const char*) {}
+void Logger::error(const char* message) { fprintf(stderr, "error: %s\n", message); }
+void Logger::debug(const char*) {}
+
+int InterruptManager::attach(int, IrqEdge, IrqHandler, void*, const char*, int) { return -1; }
+bool InterruptManager::detach(int) { return true; }
+
+} // namespace PocketOS
+
+// ---------------------------------------------------------------------------
+
+static int failures = 0;
+
+static void check(bool ok, const char* panel, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s: %s\n", panel, what);
+        failures++;
+    }
+}
+
+struct Config {
+    double spiMhz;
+    double callUs;      // Per core SPI call
+    double csUs;        // Per CS cycle (assert, deassert, DC setup)
+
+    Config() : spiMhz(40), callUs(0.25), csUs(0.5) {}
+};
+
+struct Counts {
+    uint64_t bytes;
+    uint64_t calls;
+    uint64_t csCycles;
+
+    double timeUs(const Config& c) const { return bytes * 8.0 / c.spiMhz + calls * c.callUs + csCycles * c.csUs; }
+};
+
+static void resetCounts() {
+    memset(&fakeSPI, 0, sizeof(fakeSPI));
+    fakeSPI.capture = captured;
+    fakeSPI.captureSize = sizeof(captured);
+    capturedLen = 0;
+}
+
+static Counts takeCounts() {
+    Counts c = { fakeSPI.bytes, fakeSPI.calls, fakeSPI.csCycles };
+    capturedLen = fakeSPI.captured;
+    return c;
+}
+
+// The per-pixel fill the drivers used before block fill: every window
+// command and coordinate in its own CS cycle, then write16() per pixel
+static void setCS(bool active) { digitalWrite(PIN_CS, active ? LOW : HIGH); }
+
+static void legacyCommand(uint8_t cmd) {
+    digitalWrite(PIN_DC, LOW);
+    setCS(true);
+    SPI.transfer(cmd);
+    setCS(false);
+}
+
+static void legacyData16(uint16_t data) {
+    digitalWrite(PIN_DC, HIGH);
+    setCS(true);
+    SPI.write16(data);
+    setCS(false);
+}
+
+static void legacyFillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    legacyCommand(TFT_DCS_CASET);
+    legacyData16(x);
+    legacyData16(x + w - 1);
+    legacyCommand(TFT_DCS_RASET);
+    legacyData16(y);
+    legacyData16(y + h - 1);
+    legacyCommand(TFT_DCS_RAMWR);
+    digitalWrite(PIN_DC, HIGH);
+    setCS(true);
+    for (uint32_t i = 0; i < (uint32_t)w * h; i++) {
+        SPI.write16(color);
+    }
+    setCS(false);
+}
+
+// PIMG RLE565 12x4: 20 red (crossing a row end), 6 literals, 22 green
+static const uint8_t PIMG_12X4[] = {
+    'P', 'I', 'M', 'G', 1, 1, 12, 0, 4, 0, 0, 0,
+    0x80 | 19, 0x00, 0xF8,
+    0x05, 0x1F, 0x00, 0xE0, 0x07, 0xFF, 0xFF, 0x00, 0x00, 0x1F, 0x00, 0xE0, 0x07,
+    0x80 | 21, 0xE0, 0x07,
+};
+
+// ---------------------------------------------------------------------------
+
+struct Fill {
+    const char* name;
+    uint16_t x, y, w, h;    // 0 = to the panel edge
+};
+
+template <class Driver>
+static void runPanel(const char* panel, const Config& config) {
+    Driver driver;
+    memset(pinLevel, HIGH, sizeof(pinLevel));
+    if (!driver.init(ENDPOINT) || !driver.begin()) {
+        check(false, panel, "driver init");
+        return;
+    }
+    uint16_t width = driver.width();
+    uint16_t height = driver.height();
+
+    const Fill fills[] = {
+        { "fillScreen", 0, 0, 0, 0 },
+        { "fillRect 100x50", 10, 20, 100, 50 },
+        { "drawHLine", 0, 7, 0, 1 },
+        { "drawVLine", 3, 0, 1, 0 },
+    };
+
+    printf("%s %ux%u\n", panel, width, height);
+    printf("  %-16s %-8s %10s %10s %8s %12s %8s\n", "operation", "path", "bytes", "calls", "cs", "time_us", "speedup");
+    for (const Fill& f : fills) {
+        uint16_t w = f.w ? f.w : (uint16_t)(width - f.x);
+        uint16_t h = f.h ? f.h : (uint16_t)(height - f.y);
+        uint16_t color = 0xF81F;
+
+        resetCounts();
+        if (!strcmp(f.name, "fillScreen")) {
+            driver.fillScreen(color);
+        } else if (!strcmp(f.name, "drawHLine")) {
+            driver.drawHLine(f.x, f.y, w, color);
+        } else if (!strcmp(f.name, "drawVLine")) {
+            driver.drawVLine(f.x, f.y, h, color);
+        } else {
+            driver.fillRect(f.x, f.y, w, h, color);
+        }
+        Counts block = takeCounts();
+
+        uint16_t x1 = f.x + w - 1;
+        uint16_t y1 = f.y + h - 1;
+        const uint8_t window[11] = {
+            TFT_DCS_CASET, (uint8_t)(f.x >> 8), (uint8_t)f.x, (uint8_t)(x1 >> 8), (uint8_t)x1,
+            TFT_DCS_RASET, (uint8_t)(f.y >> 8), (uint8_t)f.y, (uint8_t)(y1 >> 8), (uint8_t)y1,
+            TFT_DCS_RAMWR,
+        };
+        char what[96];
+        snprintf(what, sizeof(what), "%s: one window set + one pattern write", f.name);
+        check(block.csCycles == 2, panel, what);
+        snprintf(what, sizeof(what), "%s: 11 window bytes + 2 per pixel", f.name);
+        check(block.bytes == 11 + 2ull * w * h, panel, what);
+        snprintf(what, sizeof(what), "%s: window coordinates", f.name);
+        check(capturedLen >= sizeof(window) && memcmp(captured, window, sizeof(window)) == 0, panel, what);
+
+        resetCounts();
+        legacyFillRect(f.x, f.y, w, h, color);
+        Counts legacy = takeCounts();
+
+        printf("  %-16s %-8s %10llu %10llu %8llu %12.1f\n", f.name, "pixel", (unsigned long long)legacy.bytes,
+               (unsigned long long)legacy.calls, (unsigned long long)legacy.csCycles, legacy.timeUs(config));
+        printf("  %-16s %-8s %10llu %10llu %8llu %12.1f %7.1fx\n", "", "block", (unsigned long long)block.bytes,
+               (unsigned long long)block.calls, (unsigned long long)block.csCycles, block.timeUs(config),
+               legacy.timeUs(config) / block.timeUs(config));
+    }
+
+    // Compressed image: whole, clipped at the right edge (one window per row)
+    resetCounts();
+    check(driver.drawCompressedImage(10, 20, PIMG_12X4, sizeof(PIMG_12X4)), panel, "image: decode");
+    Counts image = takeCounts();
+    check(image.csCycles == 2, panel, "image: one window set + one data phase");
+    check(image.bytes == 11 + 2 * 48, panel, "image: 11 window bytes + 2 per pixel");
+    resetCounts();
+    check(driver.drawCompressedImage(width - 6, 0, PIMG_12X4, sizeof(PIMG_12X4)), panel, "clipped image: decode");
+    Counts clipped = takeCounts();
+    check(clipped.csCycles == 2 * 4, panel, "clipped image: one window + data phase per row");
+    check(clipped.bytes == 4 * (11 + 2 * 6), panel, "clipped image: visible columns only");
+    resetCounts();
+    check(!driver.drawCompressedImage(10, 20, PIMG_12X4, sizeof(PIMG_12X4) - 2), panel, "truncated image rejected");
+    printf("  %-16s %-8s %10llu %10llu %8llu %12.1f\n", "PIMG 12x4", "stream", (unsigned long long)image.bytes,
+           (unsigned long long)image.calls, (unsigned long long)image.csCycles, image.timeUs(config));
+
+    // Framebuffer: one dirty rectangle goes out as one chained transaction
+    if (driver.beginFramebuffer(TFTFramebufferMode::FULL, false)) {
+        driver.flush();
+        resetCounts();
+        driver.fillRect(10, 20, 100, 50, 0x07E0);
+        driver.flush();
+        Counts fb = takeCounts();
+        check(fb.csCycles == 1, panel, "framebuffer flush: one chain per dirty rectangle");
+        check(fb.bytes == 11 + 2ull * 100 * 50, panel, "framebuffer flush: window + rectangle pixels");
+        printf("  %-16s %-8s %10llu %10llu %8llu %12.1f\n", "fb fillRect+flush", "chain", (unsigned long long)fb.bytes,
+               (unsigned long long)fb.calls, (unsigned long long)fb.csCycles, fb.timeUs(config));
+
+        resetCounts();
+        driver.drawCompressedImage(10, 20, PIMG_12X4, sizeof(PIMG_12X4));
+        driver.flush();
+        Counts fbImage = takeCounts();
+        check(fbImage.csCycles == 1 && fbImage.bytes == 11 + 2 * 48, panel, "framebuffer image: one flushed rectangle");
+        driver.endFramebuffer();
+    } else {
+        check(false, panel, "framebuffer allocation");
+    }
+    printf("\n");
+}
+
+// Pixel buffer of the last chain a framebuffer sent (its final segment)
+static const uint8_t* lastSent = nullptr;
+
+static bool recordSend(SPIDriverBase*, const SPITransferDesc* chain, size_t count) {
+    lastSent = chain[count - 1].tx;
+    return true;
+}
+
+// Double buffering: drawing after a flush must go to the buffer that flush
+// did not send, also when an empty flush came in between
+static void checkDoubleBuffer() {
+    TFTFramebuffer fb;
+    SPIChainSink sink = { nullptr, recordSend, nullptr };
+    if (!fb.begin("fb", sink, 32, 16, TFTFramebufferMode::FULL, true) || !fb.isDoubleBuffered()) {
+        check(false, "framebuffer", "double buffer allocation");
+        return;
+    }
+    fb.fillRect(0, 0, 32, 16, 0xF800);
+    fb.flush();
+    const uint8_t* first = lastSent;
+    lastSent = nullptr;
+    fb.flush();
+    check(lastSent == nullptr, "framebuffer", "empty flush sends nothing");
+    fb.fillRect(0, 0, 32, 16, 0x001F);
+    fb.flush();
+    check(lastSent != nullptr && lastSent != first, "framebuffer",
+          "empty flush keeps drawing off the buffer in flight");
+    fb.end();
+}
+
+int main(int argc, char** argv) {
+    Config config;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-c")) {
+            config.spiMhz = atof(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-k")) {
+            config.callUs = atof(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-s")) {
+            config.csUs = atof(argv[i + 1]);
+        } else {
+            fprintf(stderr, "usage: %s [-c spi_mhz] [-k call_overhead_us] [-s cs_overhead_us]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (config.spiMhz <= 0) {
+        fprintf(stderr, "SPI clock must be positive\n");
+        return 2;
+    }
+
+    printf("SPI %.0f MHz, %.2f us per core call, %.2f us per CS cycle (modelled time)\n\n",
+           config.spiMhz, config.callUs, config.csUs);
+    runPanel<ILI9341Driver>("ILI9341", config);
+    runPanel<ST7789Driver>("ST7789", config);
+    runPanel<ST7735Driver>("ST7735", config);
+    checkDoubleBuffer();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
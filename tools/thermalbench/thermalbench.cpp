@@ -0,0 +1,163 @@
+/*
+ * thermalbench - thermal view benchmark (host tool)
+ *
+ * Renders synthetic MLX90640 frames through ThermalView
+ * (src/pocketos/drivers/thermal_view.h) into a 320x240 GfxMemorySurface
+ * and reports frames per second per scale. Each scale is also checked
+ * against a floating-point bilinear reference (palette index error).
+ *
+ * Build (from the repository root):
+ *   g++ -O2 -std=c++17 -Isrc -o thermalbench tools/thermalbench/thermalbench.cpp \
+ *       src/pocketos/drivers/thermal_view.cpp src/pocketos/drivers/gfx_surface.cpp
+ *
+ * Usage:
+ *   thermalbench [-n frames] [-p iron|rainbow|grey] [-o frame.ppm] [scale...]
+ *
+ * Scales default to 4 and 8. -o writes the last frame of the last scale.
+ * The SPI column is the panel-side bound at 40 MHz (16 bits per pixel).
+ */
+
+#include "pocketos/drivers/thermal_view.h"
+#include "pocketos/drivers/gfx_surface.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace PocketOS;
+
+static size_t writeFile(void* context, const uint8_t* data, size_t len) {
+    return fwrite(data, 1, len, (FILE*)context);
+}
+
+// Largest palette index difference between the view and a float bilinear
+// reference over one frame (same range, same palette)
+static int referenceError(const ThermalView& view, const GfxMemorySurface& surface,
+                          const int16_t* image, uint8_t scale) {
+    const uint16_t* lut = view.lut();
+    const float lo = view.rangeMin();
+    const float span = (float)view.rangeMax() - lo;
+    const int w = MLX90640_COLUMNS * scale;
+    const int h = MLX90640_ROWS * scale;
+
+    auto level = [&](int r, int c) {
+        float v = (image[r * MLX90640_COLUMNS + c] - lo) / span;
+        return v < 0 ? 0.0f : (v > 1 ? 255.0f : v * 255.0f);
+    };
+    auto axis = [&](int o, int n, int* i, float* f) {
+        float p = (o + 0.5f) / scale - 0.5f;
+        if (p < 0) p = 0;
+        if (p > n - 1) p = (float)(n - 1);
+        *i = (int)p;
+        if (*i > n - 2) *i = n - 2;
+        *f = p - *i;
+    };
+
+    int worst = 0;
+    for (int oy = 0; oy < h; oy++) {
+        int yi;
+        float fy;
+        axis(oy, MLX90640_ROWS, &yi, &fy);
+        for (int ox = 0; ox < w; ox++) {
+            int xi;
+            float fx;
+            axis(ox, MLX90640_COLUMNS, &xi, &fx);
+            float top = level(yi, xi) + (level(yi, xi + 1) - level(yi, xi)) * fx;
+            float bottom = level(yi + 1, xi) + (level(yi + 1, xi + 1) - level(yi + 1, xi)) * fx;
+            int expect = (int)(top + (bottom - top) * fy);
+
+            uint16_t got = surface.getPixel((uint16_t)ox, (uint16_t)oy);
+            int best = 256;
+            for (int k = 0; k < 256; k++) {
+                if (lut[k] == got) {
+                    int d = std::abs(k - expect);
+                    if (d < best) best = d;
+                }
+            }
+            if (best > worst) worst = best;
+        }
+    }
+    return worst;
+}
+
+int main(int argc, char** argv) {
+    int frames = 500;
+    ThermalPalette palette = THERMAL_PALETTE_IRON;
+    const char* ppmPath = nullptr;
+    std::vector<int> scales;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-p") && i + 1 < argc) {
+            const char* p = argv[++i];
+            if (!strcmp(p, "rainbow")) palette = THERMAL_PALETTE_RAINBOW;
+            else if (!strcmp(p, "grey")) palette = THERMAL_PALETTE_GREY;
+            else palette = THERMAL_PALETTE_IRON;
+        } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            ppmPath = argv[++i];
+        } else {
+            int s = atoi(argv[i]);
+            if (s < 1 || s > THERMAL_MAX_SCALE) {
+                fprintf(stderr, "thermalbench: scale must be 1-%d\n", THERMAL_MAX_SCALE);
+                return 1;
+            }
+            scales.push_back(s);
+        }
+    }
+    if (scales.empty()) {
+        scales.push_back(4);
+        scales.push_back(8);
+    }
+    if (frames < 1) frames = 1;
+
+    GfxMemorySurface surface;
+    if (!surface.begin(320, 240)) {
+        fprintf(stderr, "thermalbench: out of memory\n");
+        return 1;
+    }
+
+    int16_t image[MLX90640_PIXELS];
+    printf("scale  output    bands  us/frame      fps   SPI@40MHz  max index error\n");
+    for (int scale : scales) {
+        ThermalView view;
+        view.setPalette(palette);
+        const uint16_t w = (uint16_t)(MLX90640_COLUMNS * scale);
+        const uint16_t h = (uint16_t)(MLX90640_ROWS * scale);
+        if (w > surface.width() || h > surface.height()) {
+            printf("%4dx  %3ux%-3u   does not fit 320x240\n", scale, w, h);
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; f++) {
+            thermalTestImage(image, (uint16_t)f);
+            view.render(image, surface, 0, 0, (uint8_t)scale);
+        }
+        auto end = std::chrono::steady_clock::now();
+        double us = std::chrono::duration<double, std::micro>(end - start).count() / frames;
+
+        // Re-render the last frame with the final range for the reference check
+        view.setRange(view.rangeMin(), view.rangeMax());
+        view.render(image, surface, 0, 0, (uint8_t)scale);
+        int err = referenceError(view, surface, image, (uint8_t)scale);
+
+        double spiFps = 40e6 / ((double)w * h * 16);
+        printf("%4dx  %3ux%-3u  %5u  %8.1f  %7.0f  %8.1f   %d\n",
+               scale, w, h, view.lastBands(), us, 1e6 / us, spiFps, err);
+    }
+
+    if (ppmPath) {
+        FILE* f = fopen(ppmPath, "wb");
+        if (!f || !surface.writePPM(writeFile, f)) {
+            fprintf(stderr, "thermalbench: cannot write %s\n", ppmPath);
+            if (f) fclose(f);
+            return 1;
+        }
+        fclose(f);
+    }
+    return 0;
+}
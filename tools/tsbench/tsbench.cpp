@@ -0,0 +1,319 @@
+/*
+ * tsbench - time-series codec and store checks (host tool)
+ *
+ * Runs src/pocketos/core/ts_codec.h and timeseries_store.h against a
+ * directory-backed file image (default ./ts_image; wiped first):
+ *
+ *   codec      round trip of 1 Hz sensor traces (drifting and steady,
+ *              jittered and exact clock), special values, large gaps;
+ *              bits per point, block header included
+ *   store      appends through the pending/flush path of the writer
+ *              service, raw and aggregate range queries against a
+ *              brute-force copy, segment rotation, reboot (re-init on the
+ *              same image, time resumes), torn trailing write
+ *
+ * Build (from the repository root):
+ *   g++ -O2 -std=c++11 -Isrc -o tsbench tools/tsbench/tsbench.cpp \
+ *       src/pocketos/core/ts_codec.cpp src/pocketos/core/timeseries_store.cpp \
+ *       src/pocketos/core/crc.cpp
+ *
+ * Usage: tsbench [image_dir]
+ */
+
+#include "pocketos/core/timeseries_store.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+using namespace PocketOS;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+// File image: one host file per store path under `root`
+class DirFileSystem : public TsFileSystem {
+public:
+    explicit DirFileSystem(const std::string& root) : root(root) {
+        mkdir(root.c_str(), 0755);
+        mkdir((root + "/ts").c_str(), 0755);
+    }
+
+    uint32_t size(const char* path) override {
+        struct stat st;
+        return stat(full(path).c_str(), &st) == 0 ? (uint32_t)st.st_size : 0;
+    }
+
+    bool read(const char* path, uint32_t offset, uint8_t* buf, size_t len) override {
+        FILE* f = fopen(full(path).c_str(), "rb");
+        if (!f) return false;
+        bool ok = fseek(f, offset, SEEK_SET) == 0 && fread(buf, 1, len, f) == len;
+        fclose(f);
+        return ok;
+    }
+
+    bool append(const char* path, const uint8_t* buf, size_t len) override {
+        FILE* f = fopen(full(path).c_str(), "ab");
+        if (!f) return false;
+        bool ok = fwrite(buf, 1, len, f) == len;
+        fclose(f);
+        writes++;
+        return ok;
+    }
+
+    bool remove(const char* path) override {
+        return ::remove(full(path).c_str()) == 0;
+    }
+
+    bool rename(const char* from, const char* to) override {
+        return ::rename(full(from).c_str(), full(to).c_str()) == 0;
+    }
+
+    std::string full(const char* path) const { return root + path; }
+
+    uint32_t writes = 0;
+
+private:
+    std::string root;
+};
+
+static uint64_t fakeNow = 0;
+static uint64_t fakeClock() { return fakeNow; }
+
+struct Point {
+    uint64_t t;
+    float v;
+};
+
+static void collect(void* ctx, uint64_t t, float v) {
+    static_cast<std::vector<Point>*>(ctx)->push_back(Point{ t, v });
+}
+
+// 1 Hz with up to +/-jitterMs of scheduling jitter; the value drifts
+// slowly unless drift is false
+static std::vector<Point> makeTrace(size_t n, uint64_t t0, unsigned seed, float quantum,
+                                    int jitterMs = 3, bool drift = true) {
+    std::vector<Point> p(n);
+    srand(seed);
+    double level = 21.0;
+    uint64_t t = t0;
+    for (size_t i = 0; i < n; i++) {
+        t += 1000 + (rand() % (2 * jitterMs + 1)) - jitterMs;
+        if (drift) {
+            level += ((rand() % 2001) - 1000) * 2e-5;
+        }
+        p[i].t = t;
+        p[i].v = (float)(std::round(level / quantum) * quantum);
+    }
+    return p;
+}
+
+static void codecChecks() {
+    uint8_t block[TS_BLOCK_SIZE];
+    const struct {
+        const char* name;
+        float quantum;
+        int jitterMs;
+        bool drift;
+    } traces[] = { { "temp 0.01 C", 0.01f, 3, true }, { "temp float", 1e-6f, 3, true },
+                   { "steady, exact clock", 0.01f, 0, false }, { "steady, +/-3 ms", 0.01f, 3, false } };
+
+    printf("%-22s %8s %10s\n", "codec", "pts/blk", "bits/pt");
+    for (const auto& tr : traces) {
+        std::vector<Point> p = makeTrace(5000, 1700000000000ULL, 7, tr.quantum, tr.jitterMs, tr.drift);
+        size_t i = 0;
+        size_t blocks = 0;
+        bool same = true;
+        while (i < p.size()) {
+            TsBlockWriter w;
+            w.begin(block);
+            size_t start = i;
+            while (i < p.size() && w.append(p[i].t, p[i].v)) i++;
+            w.finish();
+            blocks++;
+            TsBlockReader r;
+            same = same && r.open(block) && r.header().count == i - start;
+            uint64_t t;
+            float v;
+            for (size_t k = start; k < i; k++) {
+                same = same && r.next(t, v) && t == p[k].t && v == p[k].v;
+            }
+            same = same && !r.next(t, v);
+        }
+        check(same, tr.name);
+        printf("%-22s %8.1f %10.2f\n", tr.name, (double)p.size() / blocks,
+               8.0 * blocks * TS_BLOCK_SIZE / p.size());
+    }
+
+    // Special values, big gaps, equal timestamps
+    std::vector<Point> odd = { { 0, 0.0f }, { 0, -0.0f }, { 5, INFINITY }, { 5, -INFINITY },
+                               { 70000, 1e30f }, { 2000000000ULL, -1e-30f },
+                               { 2000000001ULL, 3.5f }, { 2100000000ULL, 3.5f } };
+    TsBlockWriter w;
+    w.begin(block);
+    for (const Point& p : odd) check(w.append(p.t, p.v), "odd append");
+    check(!w.append(1, 1.0f), "backwards time rejected");
+    check(!w.append(2100000000ULL + 5000000000ULL, 1.0f), "dod overflow rejected");
+    w.finish();
+    TsBlockReader r;
+    check(r.open(block), "odd open");
+    for (const Point& p : odd) {
+        uint64_t t;
+        float v;
+        check(r.next(t, v) && t == p.t && memcmp(&v, &p.v, sizeof(v)) == 0, "odd round trip");
+    }
+    block[100] ^= 0x10;
+    check(!r.open(block), "CRC catches corruption");
+}
+
+static std::vector<Point> inRange(const std::vector<Point>& all, uint64_t from, uint64_t to) {
+    std::vector<Point> out;
+    for (const Point& p : all) {
+        if (p.t >= from && p.t <= to) out.push_back(p);
+    }
+    return out;
+}
+
+static void storeChecks(const std::string& dir) {
+    std::string cmd = "rm -rf '" + dir + "'";
+    if (system(cmd.c_str()) != 0) return;
+    DirFileSystem fs(dir);
+    fakeNow = 0;
+    TimeSeriesStore::init(&fs, fakeClock);
+
+    char temp[TS_SERIES_NAME_MAX];
+    char hum[TS_SERIES_NAME_MAX];
+    check(TimeSeriesStore::seriesName("i2c0:0x76", "temperature", temp, sizeof(temp)), "series name");
+    check(strcmp(temp, "i2c0_0x76_temperature") == 0, "series name form");
+    TimeSeriesStore::seriesName("i2c0:0x76", "humidity", hum, sizeof(hum));
+    check(!TimeSeriesStore::seriesName("i2c0:0x76", "averyveryverylongsignal", temp + 0, 8), "name too long");
+    TimeSeriesStore::seriesName("i2c0:0x76", "temperature", temp, sizeof(temp));
+
+    // One sample per second for 6 hours; the writer service runs every second
+    const size_t n = 6 * 3600;
+    std::vector<Point> tp, hp;
+    for (size_t i = 0; i < n; i++) {
+        fakeNow += 1000;
+        float t = (float)(std::round((21.0 + 2.0 * std::sin(i / 3000.0)) * 100) / 100);
+        float h = (float)(std::round((45.0 + 5.0 * std::cos(i / 2000.0)) * 10) / 10);
+        TimeSeriesStore::append(temp, t);
+        TimeSeriesStore::append(hum, h);
+        tp.push_back(Point{ TimeSeriesStore::now(), t });
+        hp.push_back(Point{ TimeSeriesStore::now(), h });
+        TimeSeriesStore::flush(false);
+    }
+
+    const TsStats& st = TimeSeriesStore::getStats();
+    printf("\nstore: %u samples, %u blocks (%u bytes) in %u file writes, %.1f samples/write\n",
+           st.samples, st.blocksWritten, st.bytesWritten, fs.writes, (double)st.samples / fs.writes);
+    check(st.writeErrors == 0 && st.forcedWrites == 0, "no forced writes or errors");
+
+    // Rotation keeps 1-2 segments: the newest data is complete, the oldest gone
+    std::vector<Point> got;
+    TsQuery all;
+    int32_t pts = TimeSeriesStore::query(temp, all, collect, &got);
+    check(pts == (int32_t)got.size() && got.size() < n && got.size() > 0, "rotation bounded history");
+    std::vector<Point> tail(tp.end() - got.size(), tp.end());
+    bool same = true;
+    for (size_t i = 0; i < got.size(); i++) same = same && got[i].t == tail[i].t && got[i].v == tail[i].v;
+    check(same, "history is the newest suffix");
+    printf("history kept: %zu of %zu points (%.1f h)\n", got.size(), n, got.size() / 3600.0);
+
+    // Range queries over flash, pending and open blocks
+    uint64_t from = tp[n - 1500].t + 1;
+    uint64_t to = tp[n - 3].t;
+    TsQuery q;
+    q.fromMs = from;
+    q.toMs = to;
+    got.clear();
+    TimeSeriesStore::query(temp, q, collect, &got);
+    std::vector<Point> want = inRange(tp, from, to);
+    same = got.size() == want.size();
+    for (size_t i = 0; same && i < got.size(); i++) same = got[i].t == want[i].t && got[i].v == want[i].v;
+    check(same, "raw range");
+
+    double sum = 0;
+    float mn = want[0].v, mx = want[0].v;
+    for (const Point& p : want) {
+        sum += p.v;
+        mn = std::min(mn, p.v);
+        mx = std::max(mx, p.v);
+    }
+    const struct {
+        const char* spec;
+        double expect;
+    } aggs[] = { { "avg", sum / want.size() }, { "min", mn }, { "max", mx },
+                 { "count", (double)want.size() }, { "last", want.back().v } };
+    for (const auto& a : aggs) {
+        TimeSeriesStore::parseAggregate(a.spec, q.agg, q.bucketMs);
+        got.clear();
+        TimeSeriesStore::query(temp, q, collect, &got);
+        check(got.size() == 1 && std::fabs(got[0].v - a.expect) < 1e-3 * std::max(1.0, std::fabs(a.expect)),
+              a.spec);
+    }
+
+    check(TimeSeriesStore::parseAggregate("avg:60", q.agg, q.bucketMs) && q.bucketMs == 60000, "parse avg:60");
+    check(!TimeSeriesStore::parseAggregate("raw:60", q.agg, q.bucketMs), "raw buckets rejected");
+    check(!TimeSeriesStore::parseAggregate("median", q.agg, q.bucketMs), "unknown agg rejected");
+    TimeSeriesStore::parseAggregate("count:60", q.agg, q.bucketMs);
+    got.clear();
+    TimeSeriesStore::query(temp, q, collect, &got);
+    uint32_t total = 0;
+    for (const Point& p : got) total += (uint32_t)p.v;
+    check(total == want.size() && got.size() >= 24 && got.size() <= 26, "count per minute");
+
+    // Reboot: same image, clock restarts at 0
+    TimeSeriesStore::flush(true);
+    fakeNow = 0;
+    TimeSeriesStore::init(&fs, fakeClock);
+    q = TsQuery();
+    got.clear();
+    TimeSeriesStore::query(hum, q, collect, &got);
+    check(!got.empty() && got.back().t == hp.back().t && got.back().v == hp.back().v, "reboot keeps data");
+    check(TimeSeriesStore::now() > hp.back().t, "store time resumes after newest sample");
+    TimeSeriesStore::append(hum, 50.0f);
+    got.clear();
+    TimeSeriesStore::query(hum, q, collect, &got);
+    check(got.back().v == 50.0f && got[got.size() - 2].t == hp.back().t, "append after reboot");
+
+    // Torn trailing write: half a block at the end of the current segment
+    TimeSeriesStore::flush(true);
+    std::string seg = fs.full("/ts/") + hum + ".1";
+    FILE* f = fopen(seg.c_str(), "ab");
+    if (f) {
+        uint8_t junk[TS_BLOCK_SIZE / 2];
+        memset(junk, 0xA5, sizeof(junk));
+        fwrite(junk, 1, sizeof(junk), f);
+        fclose(f);
+    }
+    TimeSeriesStore::init(&fs, fakeClock);
+    size_t before = 0;
+    got.clear();
+    TimeSeriesStore::query(hum, q, collect, &got);
+    before = got.size();
+    TimeSeriesStore::append(hum, 51.0f);
+    TimeSeriesStore::flush(true);
+    got.clear();
+    TimeSeriesStore::query(hum, q, collect, &got);
+    check(before > 0 && got.size() == before + 1 && got.back().v == 51.0f, "torn write recovered");
+
+    check(TimeSeriesStore::query("i2c0_0x77_pressure", q, collect, &got) == -1, "unknown series");
+}
+
+int main(int argc, char** argv) {
+    std::string dir = argc > 1 ? argv[1] : "ts_image";
+    codecChecks();
+    storeChecks(dir);
+    printf("\ncorrectness: %s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
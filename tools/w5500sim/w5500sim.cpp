@@ -0,0 +1,977 @@
+/*
+ * w5500sim - W5500 socket buffer throughput model (host tool)
+ *
+ * Runs the socket code W5500Driver uses (src/pocketos/drivers/w5500_socket.h)
+ * against a register-level W5500 model. Every readFrame()/writeFrame() is
+ * charged as one SPI frame: a fixed per-frame overhead (chip select,
+ * transaction setup) plus 3 header bytes and the data at the SPI clock.
+ *
+ * The chip model keeps the socket registers and 16-bit ring pointers, and
+ * maps buffer addresses to (address & (size - 1)) as the W5500 does, so a
+ * burst that crosses the end of a buffer wraps. It has a 100 Mbit/s
+ * full-duplex link to a peer:
+ *
+ *   udp-tx   one datagram per SEND; SEND_OK once the frame has left
+ *   udp-rx   the peer sends datagrams back to back at line rate; those
+ *            that do not fit in the RX buffer are dropped
+ *   tcp-tx   SEND segments the committed data (MSS 1460); each segment is
+ *            acked one round trip after it leaves, which frees TX buffer
+ *   tcp-rx   the peer sends within the window the chip advertised (the
+ *            RX buffer space after the last RECV), learned one way later
+ *
+ * Each scenario runs twice on the host side:
+ *
+ *   legacy   the register sequence of the previous driver calls, one
+ *            message per call, made safe (free size and SEND_OK checks).
+ *            UDP header and payload are joined in a buffer first
+ *   window   W5500Sockets: ring windows, several messages per window,
+ *            one Sn_RX_RD/RECV or Sn_TX_WR/SEND per batch. UDP datagrams
+ *            are written while the previous one is being sent
+ *
+ * All data is checked: the model verifies what leaves the TX rings and
+ * the host verifies what it reads from the RX rings. Host CPU time other
+ * than the memcpy in the legacy UDP path is not modelled. The chip is
+ * assumed to process commands instantly.
+ *
+ * Build (from the repository root):
+ *   g++ -O2 -std=c++11 -Isrc -o w5500sim tools/w5500sim/w5500sim.cpp \
+ *       src/pocketos/drivers/w5500_socket.cpp
+ *
+ * Usage:
+ *   w5500sim [-c spi_mhz] [-o frame_overhead_us] [-b buffer_kb] [-p udp_payload]
+ *            [-m tcp_record] [-r rtt_us] [-t ms]
+ */
+
+#include "pocketos/drivers/w5500_socket.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+using namespace PocketOS;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+struct Config {
+    double spiMhz;
+    double frameOverheadUs;
+    uint16_t bufferKb;
+    uint16_t udpPayload;
+    uint16_t tcpRecord;
+    double rttUs;
+    double durationMs;
+    double copyNsPerByte;   // Legacy UDP join
+
+    Config()
+        : spiMhz(30), frameOverheadUs(1.5), bufferKb(16), udpPayload(512), tcpRecord(256),
+          rttUs(300), durationMs(1000), copyNsPerByte(2) {}
+};
+
+static const double LINK_MBPS = 100.0;
+static const uint16_t TCP_MSS = 1460;
+static const double INF = 1e300;
+
+// Preamble, MAC header, FCS and inter-frame gap around an IP packet
+static double wireUs(uint32_t ipBytes) {
+    uint32_t payload = std::max<uint32_t>(ipBytes, 46);
+    return (payload + 8 + 14 + 4 + 12) * 8.0 / LINK_MBPS;
+}
+
+// Stream and datagram contents, so both ends can check every byte
+static uint8_t streamByte(uint64_t pos) {
+    return (uint8_t)(pos * 7 + (pos >> 11));
+}
+
+static uint8_t datagramByte(uint32_t seq, uint32_t i) {
+    return (uint8_t)(seq * 13 + i * 3 + 1);
+}
+
+// ---------------------------------------------------------------------------
+// Chip model
+
+struct SimSocket {
+    uint8_t regs[0x30];     // As last written by the host
+    uint8_t ir;
+    uint8_t sr;
+    uint16_t rxSize;
+    uint16_t txSize;
+    uint8_t rx[16384];
+    uint8_t tx[16384];
+
+    uint16_t txRd;          // Freed (UDP: sent; TCP: acked)
+    uint16_t txWr;          // Committed by SEND
+    uint16_t rxRd;          // Released by RECV
+    uint16_t rxWr;
+
+    // UDP TX
+    bool udpSending;
+    double udpDoneAt;
+    uint32_t udpExpectSeq;
+
+    // TCP TX
+    uint64_t sndNxt;        // Stream position of the next byte to segment
+    double sendOkAt;
+    struct Ack { double t; uint16_t ptr; };
+    std::deque<Ack> acks;
+
+    // UDP RX generator
+    bool udpRxOn;
+    double nextArrival;
+    uint32_t rxSeq;
+    uint32_t rxDropped;
+
+    // TCP RX peer
+    bool tcpRxOn;
+    uint64_t peerNxt;
+    uint64_t edgeKnown;     // Right edge of the window the peer knows
+    uint64_t consumed;      // Released by RECV since open
+    double peerWireFree;
+    double peerReadyAt;
+    struct Segment { double t; uint16_t len; uint64_t pos; };
+    std::deque<Segment> arrivals;
+    struct Update { double t; uint64_t edge; };
+    std::deque<Update> updates;
+};
+
+class W5500Model : public W5500Bus {
+public:
+    W5500Model(const Config& config) : config_(config), now(0), frames(0), spiUs(0), txBytesOut(0), txErrors(0) {
+        memset(common_, 0, sizeof(common_));
+        common_[0x39] = 0x04;   // VERSIONR
+        for (int i = 0; i < W5500_SOCKETS; i++) {
+            SimSocket& s = sockets_[i];
+            memset(s.regs, 0, sizeof(s.regs));
+            s.regs[W5500_Sn_RXBUF_SIZE] = 2;
+            s.regs[W5500_Sn_TXBUF_SIZE] = 2;
+            s.rxSize = 2048;
+            s.txSize = 2048;
+            resetSocket(s);
+        }
+    }
+
+    bool readFrame(uint8_t block, uint16_t addr, uint8_t* data, uint16_t len) override {
+        startFrame(len);
+        for (uint16_t i = 0; i < len; i++) {
+            data[i] = readByte(block, (uint16_t)(addr + i));
+        }
+        return true;
+    }
+
+    bool writeFrame(uint8_t block, uint16_t addr, const uint8_t* data, uint16_t len) override {
+        startFrame(len);
+        for (uint16_t i = 0; i < len; i++) {
+            writeByte(block, (uint16_t)(addr + i), data[i]);
+        }
+        return true;
+    }
+
+    // Bring the link and the peer up to the current time
+    void advance() {
+        for (int i = 0; i < W5500_SOCKETS; i++) {
+            advanceSocket(sockets_[i]);
+        }
+    }
+
+    SimSocket& socket(int n) { return sockets_[n]; }
+
+    void startUdpRx(int n) {
+        SimSocket& s = sockets_[n];
+        s.udpRxOn = true;
+        s.nextArrival = now;
+    }
+
+    void startTcpRx(int n) {
+        SimSocket& s = sockets_[n];
+        s.tcpRxOn = true;
+        s.edgeKnown = s.rxSize;
+        s.peerReadyAt = now;
+        s.peerWireFree = now;
+    }
+
+    void chargeUs(double us) { now += us; }
+
+    const Config& config_;
+    double now;             // Simulated time, us
+    uint64_t frames;
+    double spiUs;
+    uint64_t txBytesOut;    // Payload bytes that left (UDP) or were acked (TCP)
+    uint32_t txErrors;
+
+private:
+    uint8_t common_[0x40];
+    SimSocket sockets_[W5500_SOCKETS];
+
+    void startFrame(uint16_t len) {
+        advance();
+        double us = config_.frameOverheadUs + (3.0 + len) * 8.0 / config_.spiMhz;
+        now += us;
+        spiUs += us;
+        frames++;
+    }
+
+    static void resetSocket(SimSocket& s) {
+        s.ir = 0;
+        s.sr = W5500_SOCK_CLOSED;
+        s.txRd = s.txWr = s.rxRd = s.rxWr = 0;
+        s.udpSending = false;
+        s.udpDoneAt = 0;
+        s.udpExpectSeq = 0;
+        s.sndNxt = 0;
+        s.sendOkAt = INF;
+        s.acks.clear();
+        s.udpRxOn = false;
+        s.nextArrival = INF;
+        s.rxSeq = 0;
+        s.rxDropped = 0;
+        s.tcpRxOn = false;
+        s.peerNxt = 0;
+        s.edgeKnown = 0;
+        s.consumed = 0;
+        s.peerWireFree = 0;
+        s.peerReadyAt = 0;
+        s.arrivals.clear();
+        s.updates.clear();
+    }
+
+    static uint16_t reg16(const SimSocket& s, uint16_t addr) {
+        return ((uint16_t)s.regs[addr] << 8) | s.regs[addr + 1];
+    }
+
+    static void setReg16(SimSocket& s, uint16_t addr, uint16_t value) {
+        s.regs[addr] = (uint8_t)(value >> 8);
+        s.regs[addr + 1] = (uint8_t)(value & 0xFF);
+    }
+
+    uint8_t readByte(uint8_t block, uint16_t addr) {
+        if (block == W5500_BSB_COMMON_REG) {
+            return addr < sizeof(common_) ? common_[addr] : 0;
+        }
+        SimSocket& s = sockets_[(block - 1) / 4];
+        switch ((block - 1) % 4) {
+            case 1: return s.tx[addr & (s.txSize - 1)];
+            case 2: return s.rx[addr & (s.rxSize - 1)];
+            default: break;
+        }
+        uint16_t value;
+        switch (addr) {
+            case W5500_Sn_IR: return s.ir;
+            case W5500_Sn_SR: return s.sr;
+            case W5500_Sn_CR: return 0;   // Commands complete at once
+            case W5500_Sn_TX_FSR:
+            case W5500_Sn_TX_FSR + 1:
+                value = (uint16_t)(s.txSize - (uint16_t)(s.txWr - s.txRd));
+                return addr == W5500_Sn_TX_FSR ? value >> 8 : value & 0xFF;
+            case W5500_Sn_TX_RD:
+            case W5500_Sn_TX_RD + 1:
+                return addr == W5500_Sn_TX_RD ? s.txRd >> 8 : s.txRd & 0xFF;
+            case W5500_Sn_RX_RSR:
+            case W5500_Sn_RX_RSR + 1:
+                value = (uint16_t)(s.rxWr - s.rxRd);
+                return addr == W5500_Sn_RX_RSR ? value >> 8 : value & 0xFF;
+            case W5500_Sn_RX_WR:
+            case W5500_Sn_RX_WR + 1:
+                return addr == W5500_Sn_RX_WR ? s.rxWr >> 8 : s.rxWr & 0xFF;
+            default:
+                return addr < sizeof(s.regs) ? s.regs[addr] : 0;
+        }
+    }
+
+    void writeByte(uint8_t block, uint16_t addr, uint8_t value) {
+        if (block == W5500_BSB_COMMON_REG) {
+            if (addr < sizeof(common_)) {
+                common_[addr] = value;
+            }
+            return;
+        }
+        SimSocket& s = sockets_[(block - 1) / 4];
+        switch ((block - 1) % 4) {
+            case 1: s.tx[addr & (s.txSize - 1)] = value; return;
+            case 2: s.rx[addr & (s.rxSize - 1)] = value; return;
+            default: break;
+        }
+        if (addr >= sizeof(s.regs)) {
+            return;
+        }
+        if (addr == W5500_Sn_IR) {
+            s.ir &= ~value;
+        } else if (addr == W5500_Sn_CR) {
+            command(s, value);
+        } else {
+            s.regs[addr] = value;
+            if (addr == W5500_Sn_RXBUF_SIZE) {
+                s.rxSize = (uint16_t)(value * 1024);
+            } else if (addr == W5500_Sn_TXBUF_SIZE) {
+                s.txSize = (uint16_t)(value * 1024);
+            }
+        }
+    }
+
+    void command(SimSocket& s, uint8_t cmd) {
+        switch (cmd) {
+            case W5500_CMD_OPEN:
+                resetSocket(s);
+                s.sr = (s.regs[W5500_Sn_MR] & 0x0F) == W5500_PROTO_UDP ? W5500_SOCK_UDP : W5500_SOCK_INIT;
+                setReg16(s, W5500_Sn_TX_WR, 0);
+                setReg16(s, W5500_Sn_RX_RD, 0);
+                break;
+            case W5500_CMD_CONNECT:
+                s.sr = W5500_SOCK_ESTABLISHED;
+                s.ir |= W5500_IR_CON;
+                break;
+            case W5500_CMD_CLOSE:
+                resetSocket(s);
+                break;
+            case W5500_CMD_SEND:
+                send(s);
+                break;
+            case W5500_CMD_RECV:
+                recv(s);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void send(SimSocket& s) {
+        uint16_t wr = reg16(s, W5500_Sn_TX_WR);
+        uint16_t len = (uint16_t)(wr - s.txWr);
+        if (len == 0 || len > s.txSize - (uint16_t)(s.txWr - s.txRd)) {
+            txErrors++;
+            return;
+        }
+        uint16_t start = s.txWr;
+        s.txWr = wr;
+
+        if (s.sr == W5500_SOCK_UDP) {
+            // One datagram: 8-byte sequence header, then the pattern
+            if (s.udpSending) {
+                txErrors++;   // SEND before SEND_OK
+            }
+            uint32_t seq = 0;
+            for (int i = 0; i < 4; i++) {
+                seq = (seq << 8) | s.tx[(uint16_t)(start + i) & (s.txSize - 1)];
+            }
+            bool ok = len >= 8 && seq == s.udpExpectSeq;
+            for (uint16_t i = 8; ok && i < len; i++) {
+                ok = s.tx[(uint16_t)(start + i) & (s.txSize - 1)] == datagramByte(seq, i - 8);
+            }
+            if (!ok) {
+                txErrors++;
+            }
+            s.udpExpectSeq = seq + 1;
+            s.udpSending = true;
+            s.udpDoneAt = std::max(now, s.udpDoneAt) + wireUs(len + 28);
+            txBytesOut += len;
+            return;
+        }
+
+        // TCP: check the stream, then put it on the wire in MSS segments
+        for (uint16_t i = 0; i < len; i++) {
+            if (s.tx[(uint16_t)(start + i) & (s.txSize - 1)] != streamByte(s.sndNxt + i)) {
+                txErrors++;
+                break;
+            }
+        }
+        double wireFree = s.acks.empty() ? now : std::max(now, s.sendOkAt == INF ? now : s.sendOkAt);
+        uint16_t done = 0;
+        while (done < len) {
+            uint16_t seg = (uint16_t)std::min<uint32_t>(TCP_MSS, len - done);
+            wireFree = std::max(wireFree, now) + wireUs(seg + 40);
+            done += seg;
+            SimSocket::Ack ack = { wireFree + config_.rttUs, (uint16_t)(start + done) };
+            s.acks.push_back(ack);
+        }
+        s.sndNxt += len;
+        s.sendOkAt = wireFree;
+    }
+
+    void recv(SimSocket& s) {
+        uint16_t rd = reg16(s, W5500_Sn_RX_RD);
+        uint16_t released = (uint16_t)(rd - s.rxRd);
+        if (released > (uint16_t)(s.rxWr - s.rxRd)) {
+            txErrors++;   // Released more than was received
+            return;
+        }
+        s.rxRd = rd;
+        s.consumed += released;
+        if (s.tcpRxOn) {
+            SimSocket::Update update = { now + config_.rttUs / 2, s.consumed + s.rxSize };
+            s.updates.push_back(update);
+        }
+    }
+
+    void writeRx(SimSocket& s, const uint8_t* data, uint16_t len) {
+        for (uint16_t i = 0; i < len; i++) {
+            s.rx[(uint16_t)(s.rxWr + i) & (s.rxSize - 1)] = data[i];
+        }
+        s.rxWr += len;
+    }
+
+    void advanceSocket(SimSocket& s) {
+        if (s.udpSending && s.udpDoneAt <= now) {
+            s.udpSending = false;
+            s.txRd = s.txWr;
+            s.ir |= W5500_IR_SEND_OK;
+        }
+        while (!s.acks.empty() && s.acks.front().t <= now) {
+            uint16_t freed = (uint16_t)(s.acks.front().ptr - s.txRd);
+            txBytesOut += freed;
+            s.txRd = s.acks.front().ptr;
+            s.acks.pop_front();
+        }
+        if (s.sendOkAt <= now) {
+            s.ir |= W5500_IR_SEND_OK;
+            s.sendOkAt = INF;
+        }
+
+        // Datagrams at line rate: header (IP, port, length), then payload
+        while (s.udpRxOn && s.nextArrival <= now) {
+            uint16_t len = config_.udpPayload;
+            if ((uint32_t)(uint16_t)(s.rxWr - s.rxRd) + W5500_UDP_HEADER_SIZE + len <= s.rxSize) {
+                uint8_t packet[W5500_UDP_HEADER_SIZE + 1472];
+                const uint8_t header[W5500_UDP_HEADER_SIZE] = {
+                    10, 0, 0, 2, 0x13, 0x88, (uint8_t)(len >> 8), (uint8_t)(len & 0xFF)
+                };
+                memcpy(packet, header, sizeof(header));
+                for (uint16_t i = 0; i < len; i++) {
+                    packet[W5500_UDP_HEADER_SIZE + i] = datagramByte(s.rxSeq, i);
+                }
+                writeRx(s, packet, W5500_UDP_HEADER_SIZE + len);
+                s.ir |= W5500_IR_RECV;
+            } else {
+                s.rxDropped++;
+            }
+            s.rxSeq++;
+            s.nextArrival += wireUs(len + 28);
+        }
+
+        while (s.tcpRxOn) {
+            uint64_t avail = s.edgeKnown > s.peerNxt ? s.edgeKnown - s.peerNxt : 0;
+            double tSend = INF;
+            if (avail >= TCP_MSS || avail >= s.rxSize / 2) {
+                tSend = std::max(s.peerWireFree, s.peerReadyAt);
+            }
+            double tArrive = s.arrivals.empty() ? INF : s.arrivals.front().t;
+            double tUpdate = s.updates.empty() ? INF : s.updates.front().t;
+            double t = std::min(tSend, std::min(tArrive, tUpdate));
+            if (t > now) {
+                break;
+            }
+            if (t == tArrive) {
+                SimSocket::Segment seg = s.arrivals.front();
+                s.arrivals.pop_front();
+                uint8_t data[TCP_MSS];
+                for (uint16_t i = 0; i < seg.len; i++) {
+                    data[i] = streamByte(seg.pos + i);
+                }
+                writeRx(s, data, seg.len);
+                s.ir |= W5500_IR_RECV;
+                SimSocket::Update update = { t + config_.rttUs / 2, s.consumed + s.rxSize };
+                s.updates.push_back(update);
+            } else if (t == tUpdate) {
+                s.edgeKnown = std::max(s.edgeKnown, s.updates.front().edge);
+                s.peerReadyAt = std::max(s.peerReadyAt, t);
+                s.updates.pop_front();
+            } else {
+                uint16_t len = (uint16_t)std::min<uint64_t>(TCP_MSS, avail);
+                s.peerWireFree = t + wireUs(len + 40);
+                SimSocket::Segment seg = { s.peerWireFree + config_.rttUs / 2, len, s.peerNxt };
+                s.arrivals.push_back(seg);
+                s.peerNxt += len;
+            }
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Legacy host path: the previous driver's register sequence per call
+
+struct Legacy {
+    W5500Bus& bus;
+    bool sendPending;
+
+    explicit Legacy(W5500Bus& b) : bus(b), sendPending(false) {}
+
+    uint16_t readWord(uint8_t block, uint16_t addr) {
+        uint8_t d[2];
+        bus.readFrame(block, addr, d, 2);
+        return ((uint16_t)d[0] << 8) | d[1];
+    }
+
+    void writeWord(uint8_t block, uint16_t addr, uint16_t value) {
+        uint8_t d[2] = { (uint8_t)(value >> 8), (uint8_t)(value & 0xFF) };
+        bus.writeFrame(block, addr, d, 2);
+    }
+
+    void writeByte(uint8_t block, uint16_t addr, uint8_t value) {
+        bus.writeFrame(block, addr, &value, 1);
+    }
+
+    // SEND_OK from the previous SEND (the old driver did not wait)
+    bool ready() {
+        if (!sendPending) {
+            return true;
+        }
+        uint8_t ir;
+        bus.readFrame(W5500_BSB_SOCKET_REG(0), W5500_Sn_IR, &ir, 1);
+        if (!(ir & W5500_IR_SEND_OK)) {
+            return false;
+        }
+        writeByte(W5500_BSB_SOCKET_REG(0), W5500_Sn_IR, W5500_IR_SEND_OK);
+        sendPending = false;
+        return true;
+    }
+
+    bool send(const uint8_t* data, uint16_t len) {
+        uint8_t reg = W5500_BSB_SOCKET_REG(0);
+        if (!ready() || readWord(reg, W5500_Sn_TX_FSR) < len) {
+            return false;
+        }
+        uint16_t ptr = readWord(reg, W5500_Sn_TX_WR);
+        bus.writeFrame(W5500_BSB_SOCKET_TX(0), ptr, data, len);
+        writeWord(reg, W5500_Sn_TX_WR, (uint16_t)(ptr + len));
+        writeByte(reg, W5500_Sn_CR, W5500_CMD_SEND);
+        sendPending = true;
+        return true;
+    }
+
+    bool sendTo(const uint8_t* data, uint16_t len, const uint8_t* ip, uint16_t port) {
+        uint8_t reg = W5500_BSB_SOCKET_REG(0);
+        if (!ready() || readWord(reg, W5500_Sn_TX_FSR) < len) {
+            return false;
+        }
+        bus.writeFrame(reg, W5500_Sn_DIPR, ip, 4);
+        writeWord(reg, W5500_Sn_DPORT, port);
+        uint16_t ptr = readWord(reg, W5500_Sn_TX_WR);
+        bus.writeFrame(W5500_BSB_SOCKET_TX(0), ptr, data, len);
+        writeWord(reg, W5500_Sn_TX_WR, (uint16_t)(ptr + len));
+        writeByte(reg, W5500_Sn_CR, W5500_CMD_SEND);
+        sendPending = true;
+        return true;
+    }
+
+    int32_t recv(uint8_t* data, uint16_t len) {
+        uint8_t reg = W5500_BSB_SOCKET_REG(0);
+        if (readWord(reg, W5500_Sn_RX_RSR) < len) {
+            return 0;
+        }
+        uint16_t ptr = readWord(reg, W5500_Sn_RX_RD);
+        bus.readFrame(W5500_BSB_SOCKET_RX(0), ptr, data, len);
+        writeWord(reg, W5500_Sn_RX_RD, (uint16_t)(ptr + len));
+        writeByte(reg, W5500_Sn_CR, W5500_CMD_RECV);
+        return len;
+    }
+
+    int32_t recvFrom(uint8_t* data, uint16_t len) {
+        uint8_t reg = W5500_BSB_SOCKET_REG(0);
+        if (readWord(reg, W5500_Sn_RX_RSR) < W5500_UDP_HEADER_SIZE) {
+            return 0;
+        }
+        uint16_t ptr = readWord(reg, W5500_Sn_RX_RD);
+        uint8_t header[W5500_UDP_HEADER_SIZE];
+        bus.readFrame(W5500_BSB_SOCKET_RX(0), ptr, header, W5500_UDP_HEADER_SIZE);
+        uint16_t size = ((uint16_t)header[6] << 8) | header[7];
+        uint16_t n = std::min(size, len);
+        bus.readFrame(W5500_BSB_SOCKET_RX(0), (uint16_t)(ptr + W5500_UDP_HEADER_SIZE), data, n);
+        writeWord(reg, W5500_Sn_RX_RD, (uint16_t)(ptr + W5500_UDP_HEADER_SIZE + size));
+        writeByte(reg, W5500_Sn_CR, W5500_CMD_RECV);
+        return n;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Scenarios
+
+enum class Path { LEGACY, WINDOW };
+
+struct Result {
+    double mbps;
+    double framesPerMessage;
+    double spiBusy;
+    uint64_t messages;
+    uint32_t drops;
+};
+
+static void openSocket(W5500Model& chip, uint8_t proto, const Config& config) {
+    uint8_t reg = W5500_BSB_SOCKET_REG(0);
+    uint8_t sizes[2] = { (uint8_t)config.bufferKb, (uint8_t)config.bufferKb };
+    chip.writeFrame(reg, W5500_Sn_RXBUF_SIZE, sizes, 2);
+    chip.writeFrame(reg, W5500_Sn_MR, &proto, 1);
+    uint8_t cmd = W5500_CMD_OPEN;
+    chip.writeFrame(reg, W5500_Sn_CR, &cmd, 1);
+    if (proto == W5500_PROTO_TCP) {
+        cmd = W5500_CMD_CONNECT;
+        chip.writeFrame(reg, W5500_Sn_CR, &cmd, 1);
+    }
+}
+
+static Result finish(W5500Model& chip, double startUs, double startSpiUs, uint64_t startFrames,
+                     uint64_t bytes, uint64_t messages, uint32_t drops) {
+    double elapsed = chip.now - startUs;
+    Result r;
+    r.mbps = bytes * 8.0 / elapsed;
+    r.framesPerMessage = messages ? (double)(chip.frames - startFrames) / messages : 0;
+    r.spiBusy = (chip.spiUs - startSpiUs) / elapsed;
+    r.messages = messages;
+    r.drops = drops;
+    return r;
+}
+
+static Result runUdpTx(const Config& config, Path path) {
+    W5500Model chip(config);
+    W5500Sockets sockets;
+    sockets.setBus(&chip);
+    Legacy legacy(chip);
+    openSocket(chip, W5500_PROTO_UDP, config);
+    sockets.configure(0);
+
+    const uint8_t ip[4] = { 10, 0, 0, 2 };
+    uint16_t len = config.udpPayload;
+    std::vector<uint8_t> payload(len), joined(len);
+    uint32_t seq = 0;
+    double start = chip.now, startSpi = chip.spiUs;
+    uint64_t startFrames = chip.frames;
+    double end = start + config.durationMs * 1000;
+
+    W5500Window window;
+    window.len = 0;
+    bool staged = false;
+    while (chip.now < end) {
+        uint8_t head[8] = { (uint8_t)(seq >> 24), (uint8_t)(seq >> 16), (uint8_t)(seq >> 8), (uint8_t)seq, 0, 0, 0, 0 };
+        for (uint16_t i = 0; i < len - 8; i++) {
+            payload[i] = datagramByte(seq, i);
+        }
+        bool sent;
+        if (path == Path::WINDOW) {
+            // The next datagram goes into the ring while the previous one
+            // is still on the wire; SEND_OK then only costs the commit
+            if (!staged) {
+                if (window.len < len) {
+                    sockets.txWindow(0, window);
+                    continue;
+                }
+                sockets.txWrite(0, window, 0, head, 8);
+                sockets.txWrite(0, window, 8, payload.data(), len - 8);
+                staged = true;
+            }
+            sent = sockets.txCommitTo(0, window, len, ip, 5000);
+            staged = !sent;
+        } else {
+            // The old call takes one buffer: join header and payload first
+            memcpy(joined.data(), head, 8);
+            memcpy(joined.data() + 8, payload.data(), len - 8);
+            chip.chargeUs(len * config.copyNsPerByte / 1000.0);
+            sent = legacy.sendTo(joined.data(), len, ip, 5000);
+        }
+        if (sent) {
+            seq++;
+        }
+    }
+    chip.advance();
+    check(chip.txErrors == 0, "udp-tx: datagrams left the ring intact and in order");
+    return finish(chip, start, startSpi, startFrames, chip.txBytesOut, seq, 0);
+}
+
+static Result runUdpRx(const Config& config, Path path) {
+    W5500Model chip(config);
+    W5500Sockets sockets;
+    sockets.setBus(&chip);
+    Legacy legacy(chip);
+    openSocket(chip, W5500_PROTO_UDP, config);
+    sockets.configure(0);
+    chip.startUdpRx(0);
+
+    uint16_t len = config.udpPayload;
+    std::vector<uint8_t> buf(len);
+    uint32_t seq = 0;
+    uint64_t bytes = 0;
+    bool intact = true;
+    double start = chip.now, startSpi = chip.spiUs;
+    uint64_t startFrames = chip.frames;
+    double end = start + config.durationMs * 1000;
+    SimSocket& s = chip.socket(0);
+
+    // Drops make gaps in the sequence; datagrams carry it in their contents
+    auto verify = [&](const uint8_t* data, uint16_t n) {
+        if (n != len) {
+            intact = false;
+            return;
+        }
+        uint32_t expect = seq;
+        while (expect < s.rxSeq && data[0] != datagramByte(expect, 0)) {
+            expect++;
+        }
+        for (uint16_t i = 0; i < n; i++) {
+            if (data[i] != datagramByte(expect, i)) {
+                intact = false;
+                return;
+            }
+        }
+        seq = expect + 1;
+        bytes += n;
+    };
+
+    uint64_t messages = 0;
+    while (chip.now < end) {
+        if (path == Path::WINDOW) {
+            W5500Window window;
+            sockets.rxWindow(0, window);
+            uint16_t offset = 0;
+            W5500Datagram datagram;
+            while (offset < window.len && sockets.rxDatagram(0, window, offset, datagram)) {
+                uint16_t n = std::min(datagram.len, len);
+                sockets.rxRead(0, window, datagram.offset, buf.data(), n);
+                verify(buf.data(), n);
+                messages++;
+            }
+            sockets.rxConsume(0, window, offset);
+        } else {
+            int32_t n = legacy.recvFrom(buf.data(), len);
+            if (n > 0) {
+                verify(buf.data(), (uint16_t)n);
+                messages++;
+            }
+        }
+    }
+    check(intact, "udp-rx: every datagram read back intact");
+    return finish(chip, start, startSpi, startFrames, bytes, messages, s.rxDropped);
+}
+
+static Result runTcpTx(const Config& config, Path path) {
+    W5500Model chip(config);
+    W5500Sockets sockets;
+    sockets.setBus(&chip);
+    Legacy legacy(chip);
+    openSocket(chip, W5500_PROTO_TCP, config);
+    sockets.configure(0);
+
+    uint16_t m = config.tcpRecord;
+    std::vector<uint8_t> record(m);
+    uint64_t pos = 0;          // Stream position of the next record
+    uint64_t records = 0;
+    double start = chip.now, startSpi = chip.spiUs;
+    uint64_t startFrames = chip.frames;
+    double end = start + config.durationMs * 1000;
+
+    W5500Window window;
+    window.len = 0;
+    uint16_t written = 0;      // In the window, not yet committed
+    while (chip.now < end) {
+        for (uint16_t i = 0; i < m; i++) {
+            record[i] = streamByte(pos + i);
+        }
+        if (path == Path::LEGACY) {
+            if (legacy.send(record.data(), m)) {
+                pos += m;
+                records++;
+            }
+            continue;
+        }
+        // Records go straight into the ring as they are produced; the
+        // batch is published whenever the previous SEND has finished
+        if (written + m <= window.len) {
+            sockets.txWrite(0, window, written, record.data(), m);
+            written += m;
+            pos += m;
+            records++;
+        } else if (written == 0) {
+            sockets.txWindow(0, window);
+        }
+        if (written > 0 && (written + m > window.len || sockets.txReady(0))) {
+            if (sockets.txCommit(0, window, written)) {
+                written = 0;
+            }
+        }
+    }
+    chip.advance();
+    check(chip.txErrors == 0, "tcp-tx: stream left the ring intact");
+    return finish(chip, start, startSpi, startFrames, chip.txBytesOut, records, 0);
+}
+
+static Result runTcpRx(const Config& config, Path path) {
+    W5500Model chip(config);
+    W5500Sockets sockets;
+    sockets.setBus(&chip);
+    Legacy legacy(chip);
+    openSocket(chip, W5500_PROTO_TCP, config);
+    sockets.configure(0);
+    chip.startTcpRx(0);
+
+    uint16_t m = config.tcpRecord;
+    std::vector<uint8_t> record(m);
+    uint64_t pos = 0;
+    uint64_t records = 0;
+    bool intact = true;
+    double start = chip.now, startSpi = chip.spiUs;
+    uint64_t startFrames = chip.frames;
+    double end = start + config.durationMs * 1000;
+
+    auto verify = [&]() {
+        for (uint16_t i = 0; i < m; i++) {
+            if (record[i] != streamByte(pos + i)) {
+                intact = false;
+                break;
+            }
+        }
+        pos += m;
+        records++;
+    };
+
+    while (chip.now < end) {
+        if (path == Path::WINDOW) {
+            W5500Window window;
+            sockets.rxWindow(0, window);
+            // Release every eighth of the buffer: with small buffers the peer is
+            // waiting for the window update
+            uint16_t release = sockets.rxBufferSize(0) / 8;
+            uint16_t offset = 0;
+            while (offset + m <= window.len) {
+                sockets.rxRead(0, window, offset, record.data(), m);
+                offset += m;
+                verify();
+                if (offset >= release) {
+                    sockets.rxConsume(0, window, offset);
+                    offset = 0;
+                }
+            }
+            sockets.rxConsume(0, window, offset);
+        } else if (legacy.recv(record.data(), m) > 0) {
+            verify();
+        }
+    }
+    check(intact, "tcp-rx: stream read back intact");
+    return finish(chip, start, startSpi, startFrames, pos, records, 0);
+}
+
+// ---------------------------------------------------------------------------
+// Window checks
+
+static void checkWindows() {
+    W5500Window w;
+    w.ptr = 0xFFF0;
+    w.len = 100;
+    W5500Sockets::setSpans(w, 2048);
+    check(w.spans[0].offset == 2032 && w.spans[0].len == 16 && w.spans[1].offset == 0 && w.spans[1].len == 84,
+          "spans split at the end of the buffer");
+    w.ptr = 0x0100;
+    W5500Sockets::setSpans(w, 2048);
+    check(w.spans[0].offset == 0x100 && w.spans[0].len == 100 && w.spans[1].len == 0, "unwrapped window is one span");
+    w.ptr = 0x1000;
+    w.len = 16384;
+    W5500Sockets::setSpans(w, 16384);
+    check(w.spans[0].offset == 0x1000 && w.spans[0].len == 12288 && w.spans[1].len == 4096, "full 16 KB window");
+
+    // A write across the wrap is one frame and lands on both ends
+    Config config;
+    W5500Model chip(config);
+    W5500Sockets sockets;
+    sockets.setBus(&chip);
+    openSocket(chip, W5500_PROTO_TCP, config);
+    sockets.configure(0);
+    SimSocket& s = chip.socket(0);
+    uint16_t size = sockets.txBufferSize(0);
+    s.txWr = s.txRd = (uint16_t)(size - 10);
+    s.regs[W5500_Sn_TX_WR] = (uint8_t)(s.txWr >> 8);
+    s.regs[W5500_Sn_TX_WR + 1] = (uint8_t)(s.txWr & 0xFF);
+    W5500Window tx;
+    check(sockets.txWindow(0, tx) && tx.len == size && tx.spans[0].len == 10, "TX window at the wrap");
+    uint8_t data[100];
+    for (int i = 0; i < 100; i++) {
+        data[i] = (uint8_t)(i + 1);
+    }
+    uint64_t frames = chip.frames;
+    check(sockets.txWrite(0, tx, 0, data, 100) && chip.frames == frames + 1, "wrapping write is one frame");
+    check(s.tx[size - 10] == 1 && s.tx[size - 1] == 10 && s.tx[0] == 11 && s.tx[89] == 100,
+          "wrapping write lands at both ends of the buffer");
+    check(!sockets.txWrite(0, tx, (uint16_t)(tx.len - 10), data, 11), "write past the window refused");
+
+    // Datagram header straddling the wrap
+    s.rxRd = s.rxWr = (uint16_t)(size - 3);
+    s.regs[W5500_Sn_RX_RD] = (uint8_t)(s.rxRd >> 8);
+    s.regs[W5500_Sn_RX_RD + 1] = (uint8_t)(s.rxRd & 0xFF);
+    const uint8_t dgram[12] = { 192, 168, 1, 9, 0x1F, 0x90, 0, 4, 0xDE, 0xAD, 0xBE, 0xEF };
+    for (int i = 0; i < 12; i++) {
+        s.rx[(uint16_t)(s.rxWr + i) & (size - 1)] = dgram[i];
+    }
+    s.rxWr += 12;
+    W5500Window rx;
+    uint16_t offset = 0;
+    W5500Datagram d;
+    uint8_t payload[4];
+    check(sockets.rxWindow(0, rx) && rx.len == 12 && rx.spans[1].len == 9, "RX window at the wrap");
+    check(sockets.rxDatagram(0, rx, offset, d) && d.port == 8080 && d.len == 4 && d.ip[3] == 9 && offset == 12,
+          "datagram header across the wrap");
+    check(sockets.rxRead(0, rx, d.offset, payload, 4) && payload[0] == 0xDE && payload[3] == 0xEF,
+          "datagram payload after the wrap");
+    check(sockets.rxConsume(0, rx, offset) && rx.len == 0 && s.rxRd == s.rxWr, "consume releases the datagram");
+}
+
+int main(int argc, char** argv) {
+    Config config;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-c")) {
+            config.spiMhz = atof(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-o")) {
+            config.frameOverheadUs = atof(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-b")) {
+            config.bufferKb = (uint16_t)atoi(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-p")) {
+            config.udpPayload = (uint16_t)atoi(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-m")) {
+            config.tcpRecord = (uint16_t)atoi(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-r")) {
+            config.rttUs = atof(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-t")) {
+            config.durationMs = atof(argv[i + 1]);
+        } else {
+            fprintf(stderr, "usage: %s [-c spi_mhz] [-o frame_overhead_us] [-b buffer_kb] [-p udp_payload] "
+                            "[-m tcp_record] [-r rtt_us] [-t ms]\n", argv[0]);
+            return 2;
+        }
+    }
+    uint16_t kb = config.bufferKb;
+    if ((kb != 1 && kb != 2 && kb != 4 && kb != 8 && kb != 16) || config.udpPayload < 16 ||
+        config.udpPayload > 1472 || config.tcpRecord < 1 || config.tcpRecord > kb * 1024) {
+        fprintf(stderr, "buffer 1/2/4/8/16 KB, UDP payload 16-1472, TCP record up to the buffer size\n");
+        return 2;
+    }
+
+    checkWindows();
+
+    printf("SPI %.0f MHz, %.1f us per frame, %u KB buffers, UDP %u bytes, TCP records %u bytes, RTT %.0f us\n\n",
+           config.spiMhz, config.frameOverheadUs, kb, config.udpPayload, config.tcpRecord, config.rttUs);
+    printf("%-8s %-7s %10s %12s %9s %10s %8s\n", "scenario", "path", "Mbit/s", "frames/msg", "spi_busy", "messages", "drops");
+
+    typedef Result (*Scenario)(const Config&, Path);
+    const struct { const char* name; Scenario run; } scenarios[] = {
+        { "udp-tx", runUdpTx }, { "udp-rx", runUdpRx }, { "tcp-tx", runTcpTx }, { "tcp-rx", runTcpRx },
+    };
+    for (const auto& scenario : scenarios) {
+        Result legacy = scenario.run(config, Path::LEGACY);
+        Result window = scenario.run(config, Path::WINDOW);
+        const Result* results[2] = { &legacy, &window };
+        const char* names[2] = { "legacy", "window" };
+        for (int i = 0; i < 2; i++) {
+            printf("%-8s %-7s %10.2f %12.2f %8.0f%% %10llu %8u\n", scenario.name, names[i], results[i]->mbps,
+                   results[i]->framesPerMessage, results[i]->spiBusy * 100, (unsigned long long)results[i]->messages,
+                   results[i]->drops);
+        }
+    }
+
+    if (failures) {
+        printf("\n%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("\nAll checks passed\n");
+    return 0;
+}